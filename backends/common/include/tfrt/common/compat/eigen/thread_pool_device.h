@@ -170,6 +170,17 @@ AsyncValueRef<Chain> AsyncAssign(const EigenHostContext& ctx, Output out,
   return chain;
 }
 
+// Evaluates Eigen expression `expr` and assigns the result to the output `out`
+// using all available worker threads, blocking the caller until the assignment
+// has completed. This is for kernels with a synchronous contract: the output
+// must be fully computed when the kernel returns, but the expression is large
+// enough to benefit from parallel evaluation. No lifetime extension is needed
+// because the caller keeps all operands alive across the call.
+template <typename Output, typename Expr>
+void SyncAssign(const EigenHostContext& ctx, Output out, Expr expr) {
+  out.device(ctx.Device()) = expr;
+}
+
 }  // namespace compat
 }  // namespace tfrt
 
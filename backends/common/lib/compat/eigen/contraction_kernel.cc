@@ -41,11 +41,26 @@
 namespace Eigen {
 namespace internal {
 
+// Returns true if the host CPU is a generation the MKL-DNN JIT emits
+// vectorized kernels for. MKL-DNN picks among its avx/avx2/avx512 code paths
+// at runtime from CPUID, so one binary gets the widest kernel each host
+// supports; but on CPUs older than AVX it falls back to a slow reference
+// gemm, where Eigen's gebp compiled for the baseline ISA is the better
+// choice.
+static bool HostSupportsCustomContractionKernels() {
+#if defined(__x86_64__) && (defined(__clang__) || defined(__GNUC__))
+  return __builtin_cpu_supports("avx");
+#else
+  return true;
+#endif
+}
+
 bool UseCustomContractionKernelsTFRT() {
   static bool use_custom_contraction_kernel = true;
 
   static std::once_flag initialized;
   std::call_once(initialized, [&] {
+    use_custom_contraction_kernel = HostSupportsCustomContractionKernels();
     char* flag = std::getenv("TFRT_DISABLE_EIGEN_MKLDNN_CONTRACTION_KERNEL");
     if (flag && (strcmp(flag, "true") == 0 || strcmp(flag, "1") == 0)) {
       use_custom_contraction_kernel = false;
@@ -24,7 +24,10 @@
 //    Use MKL-DNN single threaded sgemm for float, and Eigen for everything
 //    else. The MKL-DNN kernels are generated at runtime and use
 //    avx/avx2/fma/avx512 based on cpu status registers
-//    (https://en.wikipedia.org/wiki/CPUID).
+//    (https://en.wikipedia.org/wiki/CPUID), so a single binary runs the
+//    widest kernel each host supports. On hosts older than AVX the runtime
+//    check below selects the default Eigen gebp_kernel instead, which is
+//    compiled for the baseline ISA.
 //
 // 2) No MKL-DNN: --define disable_eigen_mkldnn_contraction_kernel=true.
 //    This header will not define any custom contraction kernels, and Eigen will
@@ -54,7 +57,8 @@ namespace internal {
 #if defined(TFRT_EIGEN_USE_CUSTOM_CONTRACTION_KERNEL)
 
 // Returns `true` iff we can use custom contraction kernels. This is a runtime
-// check that uses environment variables.
+// check, resolved once at first use, that combines host CPU feature detection
+// with environment variables.
 // TODO(b/152346987): Rename this back to UseCustomContractionKernels when TFRT
 // is open sourced.
 bool UseCustomContractionKernelsTFRT();
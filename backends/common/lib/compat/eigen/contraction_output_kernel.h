@@ -100,6 +100,28 @@ struct Relu {
   };
 };
 
+// Applies `Relu6` to the passed input expression.
+struct Relu6 {
+  template <typename XprType>
+  static auto apply(XprType expr) {
+    using Scalar = typename XprType::Scalar;
+    return expr.cwiseMax(static_cast<Scalar>(0))
+        .cwiseMin(static_cast<Scalar>(6));
+  };
+};
+
+// Applies `Elu` to the passed input expression. Uses the identity
+//   elu(x) = exp(min(x, 0)) - 1 + max(x, 0)
+// which stays a single vectorizable cwise expression instead of a select.
+struct Elu {
+  template <typename XprType>
+  static auto apply(XprType expr) {
+    using Scalar = typename XprType::Scalar;
+    return expr.cwiseMin(static_cast<Scalar>(0)).exp() -
+           static_cast<Scalar>(1) + expr.cwiseMax(static_cast<Scalar>(0));
+  };
+};
+
 // Adds bias to the output block inner dimension. Optionally applies activation
 // function specified by `Activation` type parameter.
 template <typename T, typename Activation = Identity>
@@ -140,6 +162,53 @@ class BiasAddOutputKernel {
   const Index bias_size_;
 };
 
+// Adds bias to the output block inner dimension, then applies LeakyRelu with
+// the given negative-slope coefficient. A separate kernel rather than an
+// `Activation` parameter of BiasAddOutputKernel because the coefficient is a
+// runtime attribute, while the activations above are stateless types. Uses
+// the identity
+//   leaky_relu(x) = max(x, 0) + alpha * min(x, 0)
+// which stays a single vectorizable cwise expression instead of a select.
+template <typename T>
+class BiasAddLeakyReluOutputKernel {
+  using Index = Eigen::Index;
+  using Vec = Eigen::Tensor<T, 1, Eigen::RowMajor, Index>;
+
+ public:
+  BiasAddLeakyReluOutputKernel(const EigenConstTensor<T, 1>& bias, T alpha)
+      : bias_data_(bias.data()), bias_size_(bias.size()), alpha_(alpha) {}
+
+  EIGEN_ALWAYS_INLINE void operator()(
+      const internal::ContractionOutputMapper<T>& output_mapper,
+      const Eigen::TensorContractionParams& params, Index i, Index j,
+      Index num_rows, Index num_cols) const {
+    // There is no guarantee that `bias + offset` will be properly aligned.
+    using Bias = Eigen::TensorMap<const Vec, Eigen::Unaligned>;
+    using OutputChannels = Eigen::TensorMap<Vec, Eigen::Unaligned>;
+
+    assert(params.swapped_arguments &&
+           "Unexpected contraction output kernel parameters");
+    assert(i + num_rows <= bias_size_ &&
+           "Output block inner dimension is larger than the bias vector");
+
+    const T* bias_base = bias_data_ + i;
+    const Bias bias(bias_base, num_rows);
+
+    for (Index col = 0; col < num_cols; ++col) {
+      T* output_base = &output_mapper(0, col);
+      OutputChannels output(output_base, num_rows);
+      const auto expr = output + bias;
+      output = expr.cwiseMax(static_cast<T>(0)) +
+               expr.cwiseMin(static_cast<T>(0)) * alpha_;
+    }
+  }
+
+ private:
+  const T* bias_data_;
+  const Index bias_size_;
+  const T alpha_;
+};
+
 template <typename T, typename Activation = Identity>
 class BatchNormOutputKernel {
   using Index = Eigen::Index;
@@ -205,6 +274,60 @@ class BatchNormOutputKernel {
   Eigen::Tensor<T, 1, Eigen::RowMajor> scaling_factor_;
 };
 
+// Multiplies the output block inner dimension by `scale` and adds `shift`.
+// This is the epilogue of an inference-time batch normalization folded into
+// the preceding contraction, with the coefficients precomputed ahead of time:
+//   scale = gamma / sqrt(estimated_variance + epsilon)
+//   shift = beta - estimated_mean * scale
+// Unlike BatchNormOutputKernel it does not need the mean/variance statistics
+// at run time. Optionally applies activation function specified by
+// `Activation` type parameter.
+template <typename T, typename Activation = Identity>
+class ScaleAndShiftOutputKernel {
+  using Index = Eigen::Index;
+  using Vec = Eigen::Tensor<T, 1, Eigen::RowMajor, Index>;
+
+ public:
+  ScaleAndShiftOutputKernel(const EigenConstTensor<T, 1>& scale,
+                            const EigenConstTensor<T, 1>& shift)
+      : scale_data_(scale.data()),
+        shift_data_(shift.data()),
+        size_(scale.size()) {
+    assert(scale.size() == shift.size() &&
+           "Scale and shift vectors must have the same size");
+  }
+
+  EIGEN_ALWAYS_INLINE void operator()(
+      const internal::ContractionOutputMapper<T>& output_mapper,
+      const Eigen::TensorContractionParams& params, Index i, Index j,
+      Index num_rows, Index num_cols) const {
+    // There is no guarantee that `scale/shift + offset` will be properly
+    // aligned.
+    using Coefficients = Eigen::TensorMap<const Vec, Eigen::Unaligned>;
+    using OutputChannels = Eigen::TensorMap<Vec, Eigen::Unaligned>;
+
+    assert(params.swapped_arguments &&
+           "Unexpected contraction output kernel parameters");
+    assert(i + num_rows <= size_ &&
+           "Output block inner dimension is larger than the scale vector");
+
+    const Coefficients scale(scale_data_ + i, num_rows);
+    const Coefficients shift(shift_data_ + i, num_rows);
+
+    for (Index col = 0; col < num_cols; ++col) {
+      T* output_base = &output_mapper(0, col);
+      OutputChannels output(output_base, num_rows);
+      const auto expr = output * scale + shift;
+      output = Activation::template apply<decltype(expr)>(expr);
+    }
+  }
+
+ private:
+  const T* scale_data_;
+  const T* shift_data_;
+  const Index size_;
+};
+
 }  // namespace compat
 }  // namespace tfrt
 
@@ -0,0 +1,197 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- depthwise_conv2d.cc ---------------------------------------*- C++-*-===//
+//
+// Depthwise 2D convolution implemented with Eigen.
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+
+#include "conv2d_shape_functions.h"
+#include "tfrt/common/compat/eigen/eigen_kernel.h"
+#include "tfrt/common/compat/eigen/tensor_types.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/host_context/parallel_for.h"
+#include "tfrt/tensor/dense_host_tensor_view.h"
+
+namespace tfrt {
+namespace compat {
+
+// Depthwise convolution applies a separate 2D filter to every input channel,
+// so unlike regular convolution it never mixes channels and degenerates to
+// many tiny contractions when expressed through SpatialConvolution. Instead
+// we keep the NHWC channels dimension as the vectorization axis: for every
+// output coordinate the inner expression is a multiply-accumulate of two
+// channel vectors, which Eigen evaluates with packets over the contiguous
+// innermost dimension.
+//
+// Input must be a 4 dimensional tensor in NHWC data format:
+//   [batch_size, height, width, channels]
+//
+// Kernel must be a 4 dimensional tensor in HWCM data format:
+//   [filter_height, filter_width, channels, channel_multiplier]
+//
+// Only channel_multiplier == 1 is supported: a multiplier would interleave
+// the output channels and break the contiguous channel vectorization.
+template <typename T>
+static void DepthwiseConv2D(ArgumentView<DHTIndexableView<T, 4>> input,
+                            ArgumentView<DHTIndexableView<T, 4>> kernel,
+                            ArgumentView<MutableDHTIndexableView<T, 4>> output,
+                            Argument<Chain> chain_in, Result<Chain> chain_out,
+                            StringAttribute padding,
+                            ArrayAttribute<ssize_t> strides,
+                            KernelErrorHandler handler, HostContext* host,
+                            KernelFrame* frame) {
+  // shape_input has format (batch_size, height, width, channels).
+  const auto& shape_input = input->FixedShape();
+  // shape_kernel has format (height, width, channels, channel_multiplier).
+  const auto& shape_kernel = kernel->FixedShape();
+  // shape_output has format (batch_size, height, width, channels).
+  const auto& shape_output = output->FixedShape();
+
+  if (strides.size() != 2) {
+    handler.ReportError("DepthwiseConv2D expects strides to have 2 elements");
+    return;
+  }
+
+  auto padding_type = ParsePaddingType(padding.get());
+  TFRT_RETURN_IF_ERROR(handler, padding_type.takeError());
+
+  TFRT_RETURN_IF_ERROR(
+      handler, CheckDimensionMatch("input channels", shape_input[3],
+                                   "kernel channels", shape_kernel[2]));
+
+  if (shape_kernel[3] != 1) {
+    handler.ReportError("DepthwiseConv2D expects channel multiplier 1, got ",
+                        shape_kernel[3]);
+    return;
+  }
+
+  auto output_height = ComputeWindowedOutputDimension(
+      shape_input[1], shape_kernel[0], strides[0], /*dilation=*/1,
+      *padding_type, /*explicit_padding=*/llvm::None);
+  TFRT_RETURN_IF_ERROR(handler, output_height.takeError());
+
+  auto output_width = ComputeWindowedOutputDimension(
+      shape_input[2], shape_kernel[1], strides[1], /*dilation=*/1,
+      *padding_type, /*explicit_padding=*/llvm::None);
+  TFRT_RETURN_IF_ERROR(handler, output_width.takeError());
+
+  const FixedRankShape<4> expected_output_shape(
+      {shape_input[0],               // batch
+       output_height->output_size,   // height
+       output_width->output_size,    // width
+       shape_input[3]});             // channels
+
+  TFRT_RETURN_IF_ERROR(
+      handler, CheckShapeMatch("output tensor shape", shape_output,
+                               "computed output shape", expected_output_shape));
+
+  const std::array<ssize_t, 2> paddings = {
+      output_height->padding.padding_before,  // padding top
+      output_width->padding.padding_before};  // padding left
+
+  // In the following code we treat every channels vector (innermost
+  // dimension) as a single unit, and pretend that we are working with a
+  // tensor of size: [batch, height, width].
+  using ChannelVector = Eigen::Tensor<T, 1, Eigen::RowMajor, ssize_t>;
+  using ConstChannels = Eigen::TensorMap<const ChannelVector, Eigen::Unaligned>;
+  using OutputChannels = Eigen::TensorMap<ChannelVector, Eigen::Unaligned>;
+
+  // At every 3 dimensional coordinate we have a vector of size [num_channels].
+  const ssize_t num_channels = shape_input[3];
+
+  const auto input_channels = [input, num_channels](ssize_t batch, ssize_t row,
+                                                    ssize_t col) {
+    const T* data = &input->ElementAt(batch, row, col, 0);
+    return ConstChannels(data, num_channels);
+  };
+
+  const auto kernel_channels = [kernel, num_channels](ssize_t row,
+                                                      ssize_t col) {
+    const T* data = &kernel->ElementAt(row, col, 0, 0);
+    return ConstChannels(data, num_channels);
+  };
+
+  const auto output_channels = [output, num_channels](ssize_t batch,
+                                                      ssize_t row,
+                                                      ssize_t col) {
+    T* data = &output->ElementAt(batch, row, col, 0);
+    return OutputChannels(data, num_channels);
+  };
+
+  // Parallelize over [batch, output row] pairs: rows of the output write
+  // disjoint memory and reuse the whole filter, so they need no
+  // synchronization and keep the filter resident in cache.
+  const ssize_t num_output_rows = shape_output[0] * shape_output[1];
+
+  // Computes all outputs for the [start, end) range of [batch, output row]
+  // pairs. All the state captured by value explicitly, because this function
+  // will be executed asynchonously.
+  auto compute = [strides, paddings, shape_input, shape_kernel, shape_output,
+                  input_channels, kernel_channels,
+                  output_channels](size_t start, size_t end) -> void {
+    for (ssize_t index = start; index < static_cast<ssize_t>(end); ++index) {
+      const ssize_t batch = index / shape_output[1];
+      const ssize_t out_r = index % shape_output[1];
+
+      for (ssize_t out_c = 0; out_c < shape_output[2]; ++out_c) {
+        auto out = output_channels(batch, out_r, out_c);
+        out.setZero();
+
+        // Iterate over the spatial filter window, skipping coordinates that
+        // fall into the padded space.
+        for (ssize_t x = 0; x < shape_kernel[0]; ++x) {
+          const ssize_t in_r = out_r * strides[0] + x - paddings[0];
+          if (in_r < 0 || in_r >= shape_input[1]) continue;
+
+          for (ssize_t y = 0; y < shape_kernel[1]; ++y) {
+            const ssize_t in_c = out_c * strides[1] + y - paddings[1];
+            if (in_c < 0 || in_c >= shape_input[2]) continue;
+
+            // A single vectorized multiply-accumulate over the channels.
+            out += input_channels(batch, in_r, in_c) * kernel_channels(x, y);
+          }
+        }
+      }
+    }
+  };
+
+  // Compute minimum parallel for block size, to make sure that we do not
+  // create too many small tasks if output rows are tiny.
+  static constexpr size_t kMinRowCost = 1000;
+  const size_t row_cost =
+      shape_output[2] * shape_kernel[0] * shape_kernel[1] * num_channels;
+  const size_t min_block_size =
+      std::max(static_cast<size_t>(1), kMinRowCost / row_cost);
+
+  ParallelFor(host).Execute(
+      num_output_rows, ParallelFor::BlockSizes::Min(min_block_size),
+      std::move(compute),
+      [chain = chain_out.Allocate(), frame = RAIIKernelFrame(*frame)]() {
+        chain.emplace();
+      });
+}
+
+}  // namespace compat
+
+void RegisterDepthwiseConv2DKernels(KernelRegistry* registry) {
+  registry->AddKernel("eigen.depthwise_conv2d.f32",
+                      TFRT_KERNEL(compat::DepthwiseConv2D<float>));
+}
+
+}  // namespace tfrt
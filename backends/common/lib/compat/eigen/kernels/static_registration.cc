@@ -32,20 +32,27 @@ void RegisterConv2DBatchNormReluKernels(KernelRegistry* registry);
 void RegisterConv2DBiasKernels(KernelRegistry* registry);
 void RegisterConv2DGradFilterKernels(KernelRegistry* registry);
 void RegisterConv2DGradInputKernels(KernelRegistry* registry);
+void RegisterDepthwiseConv2DKernels(KernelRegistry* registry);
 void RegisterMatMulKernels(KernelRegistry* registry);
 void RegisterMaxPoolingKernels(KernelRegistry* registry);
 void RegisterZeroPaddingKernels(KernelRegistry* registry);
 
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterBatchNormKernels);
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterBatchNormGradKernels);
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterConv2DKernels);
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterConv2DBatchNormKernels);
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterConv2DBatchNormReluKernels);
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterConv2DBiasKernels);
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterConv2DGradFilterKernels);
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterConv2DGradInputKernels);
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterMatMulKernels);
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterMaxPoolingKernels);
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterZeroPaddingKernels);
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterBatchNormKernels, "eigen");
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterBatchNormGradKernels, "eigen");
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterConv2DKernels, "eigen");
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterConv2DBatchNormKernels,
+                                         "eigen");
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterConv2DBatchNormReluKernels,
+                                         "eigen");
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterConv2DBiasKernels, "eigen");
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterConv2DGradFilterKernels,
+                                         "eigen");
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterConv2DGradInputKernels,
+                                         "eigen");
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterDepthwiseConv2DKernels,
+                                         "eigen");
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterMatMulKernels, "eigen");
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterMaxPoolingKernels, "eigen");
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterZeroPaddingKernels, "eigen");
 
 }  // namespace tfrt
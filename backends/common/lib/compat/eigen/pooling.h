@@ -0,0 +1,163 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- pooling.h ------------------------------------------------*- C++ -*-===//
+//
+// 2D max and average pooling implemented with Eigen expressions.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_BACKENDS_COMMON_LIB_COMPAT_EIGEN_POOLING_H_
+#define TFRT_BACKENDS_COMMON_LIB_COMPAT_EIGEN_POOLING_H_
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#include "tfrt/common/compat/eigen/tensor_types.h"
+#include "tfrt/host_context/parallel_for.h"
+#include "tfrt/tensor/tensor_shape.h"
+
+namespace tfrt {
+namespace compat {
+
+// Parameters of a 2D pooling operation over an NHWC input.
+struct Pooling2DParams {
+  FixedRankShape<4> input_shape;   // [batch, height, width, channels]
+  FixedRankShape<4> output_shape;  // [batch, height, width, channels]
+  std::array<Eigen::Index, 2> window;    // [height, width]
+  std::array<Eigen::Index, 2> strides;   // [height, width]
+  std::array<Eigen::Index, 4> paddings;  // [top, bottom, left, right]
+};
+
+namespace internal {
+
+template <typename T>
+using PoolChannelVector = Eigen::Tensor<T, 1, Eigen::RowMajor, ssize_t>;
+template <typename T>
+using PoolInputChannels =
+    Eigen::TensorMap<const PoolChannelVector<T>, Eigen::Unaligned>;
+template <typename T>
+using PoolOutputChannels =
+    Eigen::TensorMap<PoolChannelVector<T>, Eigen::Unaligned>;
+
+// Computes one output row of pooled channel vectors: for every output
+// column, scans the in-bounds part of the pooling window and reduces whole
+// channel vectors with Eigen expressions, so the reduction vectorizes across
+// the innermost (channels) dimension. Average pooling divides by the number
+// of in-bounds window positions, matching the TensorFlow convention for
+// padded windows.
+template <typename T, bool kAverage>
+void PoolOutputRow(const T* input, T* output, const Pooling2DParams& params,
+                   ssize_t batch, ssize_t out_row) {
+  const ssize_t in_height = params.input_shape[1];
+  const ssize_t in_width = params.input_shape[2];
+  const ssize_t channels = params.input_shape[3];
+  const ssize_t out_width = params.output_shape[2];
+
+  const T* batch_in = input + batch * in_height * in_width * channels;
+  T* row_out =
+      output +
+      (batch * params.output_shape[1] + out_row) * out_width * channels;
+
+  const ssize_t win_row_begin =
+      out_row * params.strides[0] - params.paddings[0];
+  const ssize_t row_begin = std::max<ssize_t>(win_row_begin, 0);
+  const ssize_t row_end =
+      std::min(win_row_begin + params.window[0], in_height);
+
+  for (ssize_t out_col = 0; out_col < out_width; ++out_col) {
+    const ssize_t win_col_begin =
+        out_col * params.strides[1] - params.paddings[2];
+    const ssize_t col_begin = std::max<ssize_t>(win_col_begin, 0);
+    const ssize_t col_end =
+        std::min(win_col_begin + params.window[1], in_width);
+
+    PoolOutputChannels<T> out(row_out + out_col * channels, channels);
+    out = out.constant(kAverage ? T(0) : std::numeric_limits<T>::lowest());
+
+    for (ssize_t row = row_begin; row < row_end; ++row) {
+      for (ssize_t col = col_begin; col < col_end; ++col) {
+        PoolInputChannels<T> in(batch_in + (row * in_width + col) * channels,
+                                channels);
+        if (kAverage) {
+          out += in;
+        } else {
+          out = out.cwiseMax(in);
+        }
+      }
+    }
+
+    if (kAverage) {
+      const ssize_t count = (row_end - row_begin) * (col_end - col_begin);
+      assert(count > 0 && "pooling window does not overlap the input");
+      out = out * out.constant(T(1) / static_cast<T>(count));
+    }
+  }
+}
+
+template <typename T, bool kAverage>
+void Pooling2D(const T* input, T* output, const Pooling2DParams& params,
+               HostContext* host, llvm::unique_function<void()> on_done) {
+  // One parallel work item is a (batch, output row) pair.
+  const ssize_t num_rows = params.output_shape[0] * params.output_shape[1];
+
+  // Keep at least ~1000 scalars of window work per task, so tiny spatial
+  // dimensions do not produce a flood of small tasks.
+  static constexpr size_t kMinWorkSize = 1000;
+  const size_t row_work = params.output_shape[2] * params.input_shape[3] *
+                          params.window[0] * params.window[1];
+  const size_t min_block_size =
+      std::max<size_t>(1, kMinWorkSize / std::max<size_t>(1, row_work));
+
+  ParallelFor(host).Execute(
+      num_rows, ParallelFor::BlockSizes::Min(min_block_size),
+      [input, output, params](size_t begin, size_t end) {
+        const ssize_t out_height = params.output_shape[1];
+        for (size_t i = begin; i < end; ++i) {
+          PoolOutputRow<T, kAverage>(input, output, params, i / out_height,
+                                     i % out_height);
+        }
+      },
+      std::move(on_done));
+}
+
+}  // namespace internal
+
+// MaxPooling2D() / AveragePooling2D() pool a 4 dimensional NHWC input tensor
+// into a preallocated output tensor, parallel over batch x output rows.
+// `on_done` is called when all parallel blocks have completed; it must keep
+// the input and output buffers alive.
+
+template <typename T>
+void MaxPooling2D(const T* input, T* output, const Pooling2DParams& params,
+                  HostContext* host, llvm::unique_function<void()> on_done) {
+  internal::Pooling2D<T, false>(input, output, params, host,
+                                std::move(on_done));
+}
+
+template <typename T>
+void AveragePooling2D(const T* input, T* output,
+                      const Pooling2DParams& params, HostContext* host,
+                      llvm::unique_function<void()> on_done) {
+  internal::Pooling2D<T, true>(input, output, params, host,
+                               std::move(on_done));
+}
+
+}  // namespace compat
+}  // namespace tfrt
+
+#endif  // TFRT_BACKENDS_COMMON_LIB_COMPAT_EIGEN_POOLING_H_
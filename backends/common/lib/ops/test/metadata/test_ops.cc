@@ -18,6 +18,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <tuple>
+
 #include "tfrt/common/ops/test/metadata_functions.h"
 #include "tfrt/core_runtime/op_utils.h"
 #include "tfrt/support/error_util.h"
@@ -146,6 +149,22 @@ static Expected<TensorMetadata> ArgmaxMD(const TensorMetadata& arg,
   return ReduceOpShape(arg, axis, GetDType<int32_t>());
 }
 
+// (values, indices) = test.top_k(input, k=K): the K largest elements of a
+// rank-1 input and their indices.
+static Expected<std::tuple<TensorMetadata, TensorMetadata>> TopKMD(
+    const TensorMetadata& arg, const OpAttrsRef& attrs) {
+  int32_t k;
+  if (!attrs.Get("k", &k)) return MakeStringError("missing 'k' attribute");
+
+  if (arg.shape.GetRank() != 1)
+    return MakeStringError("tfrt_test.top_k expects a rank-1 input");
+  if (k < 0 || k > arg.shape.GetDimensionSize(0))
+    return MakeStringError("'k' must be between 0 and the input size");
+
+  return std::make_tuple(TensorMetadata(arg.dtype, {k}),
+                         TensorMetadata(GetDType<int32_t>(), {k}));
+}
+
 static Expected<TensorMetadata> ReduceMeanMD(const TensorMetadata& arg,
                                              const OpAttrsRef& attrs) {
   int32_t axis;
@@ -195,6 +214,43 @@ Expected<TensorMetadata> TestAddMD(const TensorMetadata& lhs,
   return lhs;
 }
 
+// Elementwise binary operation with NumPy-style broadcasting between the
+// operands. The result shape must match the shape of one of the operands:
+// the CPU kernels implement broadcasting with shape-specialized loops that
+// stream the larger operand, and do not materialize results larger than both
+// operands (e.g. [m, 1] combined with [1, n]).
+static Expected<TensorMetadata> BroadcastableElementwiseOpMD(
+    const TensorMetadata& lhs, const TensorMetadata& rhs) {
+  if (lhs.dtype != rhs.dtype)
+    return MakeStringError("incompatible dtypes for element-wise op");
+
+  if (lhs.shape == rhs.shape) return lhs;
+
+  // Align the shapes on their trailing dimensions; each pair of dimensions
+  // must match or one of them must be 1.
+  const int lhs_rank = lhs.shape.GetRank();
+  const int rhs_rank = rhs.shape.GetRank();
+  const int rank = std::max(lhs_rank, rhs_rank);
+  SmallVector<ssize_t, 4> result_dims(rank);
+  for (int i = 0; i < rank; ++i) {
+    const ssize_t l =
+        i < lhs_rank ? lhs.shape.GetDimensionSize(lhs_rank - 1 - i) : 1;
+    const ssize_t r =
+        i < rhs_rank ? rhs.shape.GetDimensionSize(rhs_rank - 1 - i) : 1;
+    if (l != r && l != 1 && r != 1)
+      return MakeStringError("shapes ", lhs.shape, " and ", rhs.shape,
+                             " are not broadcast-compatible");
+    result_dims[rank - 1 - i] = std::max(l, r);
+  }
+
+  TensorMetadata result(lhs.dtype, result_dims);
+  if (result.shape != lhs.shape && result.shape != rhs.shape)
+    return MakeStringError("unsupported broadcast of shapes ", lhs.shape,
+                           " and ", rhs.shape,
+                           ": the result must have the shape of one operand");
+  return result;
+}
+
 // result = unaryop(source).  Result and source have same metadata.
 static TensorMetadata UnaryIdentityMD(const TensorMetadata& input) {
   return input;
@@ -252,10 +308,14 @@ GetAllTestMetadataFunctions() {
     result->emplace_back("tfrt_test.cast", TFRT_METADATA(CastMD));
     result->emplace_back("tfrt_test.broadcast", TFRT_METADATA(BroadcastMD));
     result->emplace_back("tfrt_test.argmax", TFRT_METADATA(ArgmaxMD));
+    result->emplace_back("tfrt_test.top_k", TFRT_METADATA(TopKMD));
     result->emplace_back("tfrt_test.reduce_mean", TFRT_METADATA(ReduceMeanMD));
     result->emplace_back("tfrt_test.create_dense_tensor",
                          TFRT_METADATA(CreateDenseTensorMD));
-    result->emplace_back("tfrt_test.add", TFRT_METADATA(TestAddMD));
+    result->emplace_back("tfrt_test.add",
+                         TFRT_METADATA(BroadcastableElementwiseOpMD));
+    result->emplace_back("tfrt_test.multiply",
+                         TFRT_METADATA(BroadcastableElementwiseOpMD));
     result->emplace_back("tfrt_test.add.denseonly", TFRT_METADATA(TestAddMD));
     result->emplace_back("tfrt_test.add.denseonly2", TFRT_METADATA(TestAddMD));
     result->emplace_back("tfrt_test.add.denseonly3", TFRT_METADATA(TestAddMD));
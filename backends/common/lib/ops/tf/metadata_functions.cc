@@ -37,6 +37,10 @@ static DType OpAttrTypeToDType(OpAttrType type) {
   switch (type) {
     default:
       return DType(DType::Invalid);
+    // BF16 is not a numeric dtype in core TFRT, so it is not covered by the
+    // macro expansion below.
+    case OpAttrType::BF16:
+      return DType(DType::BF16);
 #define DTYPE_NUMERIC(ENUM) \
   case OpAttrType::ENUM:    \
     return DType(DType::ENUM);
@@ -155,6 +159,162 @@ static Expected<TensorMetadata> MatMulMd(const TensorMetadata& a,
                                   b.shape.GetDimensionSize(b_remaining_dim)});
 }
 
+// Metadata function for tf._FusedMatMul: the result metadata is that of the
+// underlying matmul; the variadic operands only feed the fused epilogue.
+static Expected<TensorMetadata> FusedMatMulMd(
+    const TensorMetadata& a, const TensorMetadata& b,
+    VariadicOpArg<TensorMetadata> fusion_inputs, const OpAttrsRef& attrs) {
+  return MatMulMd(a, b, attrs);
+}
+
+// Metadata function for tf.Gather: rows of a rank-2 table selected by a
+// rank-1 index vector.
+static Expected<TensorMetadata> TfGatherOpMd(const TensorMetadata& params,
+                                             const TensorMetadata& indices,
+                                             const OpAttrsRef& attrs) {
+  if (params.shape.GetRank() != 2)
+    return MakeStringError("tf.Gather expects a rank-2 table, got rank ",
+                           params.shape.GetRank());
+  if (indices.shape.GetRank() != 1)
+    return MakeStringError("tf.Gather expects rank-1 indices, got rank ",
+                           indices.shape.GetRank());
+  if (indices.dtype.kind() != DType::I32 && indices.dtype.kind() != DType::I64)
+    return MakeStringError("tf.Gather indices must be i32 or i64, got ",
+                           indices.dtype);
+  return TensorMetadata(params.dtype, {indices.shape.GetDimensionSize(0),
+                                       params.shape.GetDimensionSize(1)});
+}
+
+// Metadata function for tf.ScatterAdd: the result is the updated table.
+static Expected<TensorMetadata> TfScatterAddOpMd(const TensorMetadata& params,
+                                                 const TensorMetadata& indices,
+                                                 const TensorMetadata& updates,
+                                                 const OpAttrsRef& attrs) {
+  if (params.shape.GetRank() != 2)
+    return MakeStringError("tf.ScatterAdd expects a rank-2 table, got rank ",
+                           params.shape.GetRank());
+  if (indices.shape.GetRank() != 1)
+    return MakeStringError("tf.ScatterAdd expects rank-1 indices, got rank ",
+                           indices.shape.GetRank());
+  if (indices.dtype.kind() != DType::I32 && indices.dtype.kind() != DType::I64)
+    return MakeStringError("tf.ScatterAdd indices must be i32 or i64, got ",
+                           indices.dtype);
+  if (updates.dtype != params.dtype)
+    return MakeStringError("incompatible dtypes for tf.ScatterAdd: In[0]: ",
+                           params.dtype, ", In[2]: ", updates.dtype);
+  if (updates.shape.GetRank() != 2 ||
+      updates.shape.GetDimensionSize(0) !=
+          indices.shape.GetDimensionSize(0) ||
+      updates.shape.GetDimensionSize(1) != params.shape.GetDimensionSize(1))
+    return MakeStringError(
+        "tf.ScatterAdd updates shape must be [num_indices, row_length]");
+  return params;
+}
+
+// Metadata function for tf._FusedLayerNorm: normalization over the last
+// dimension with a scale and shift vector of that length; the result keeps
+// the input metadata.
+static Expected<TensorMetadata> TfFusedLayerNormOpMd(
+    const TensorMetadata& input, const TensorMetadata& scale,
+    const TensorMetadata& shift, const OpAttrsRef& attrs) {
+  if (input.shape.GetRank() < 1)
+    return MakeStringError("tf._FusedLayerNorm input must have rank >= 1");
+  if (scale.dtype != input.dtype || shift.dtype != input.dtype)
+    return MakeStringError(
+        "incompatible dtypes for tf._FusedLayerNorm: In[0]: ", input.dtype,
+        ", In[1]: ", scale.dtype, ", In[2]: ", shift.dtype);
+  const ssize_t inner =
+      input.shape.GetDimensionSize(input.shape.GetRank() - 1);
+  if (scale.shape.GetRank() != 1 ||
+      scale.shape.GetDimensionSize(0) != inner ||
+      shift.shape.GetRank() != 1 || shift.shape.GetDimensionSize(0) != inner)
+    return MakeStringError(
+        "tf._FusedLayerNorm scale and shift must be rank-1 of the input's "
+        "last dimension");
+  return input;
+}
+
+// Metadata function for _tf.ConcatV2 (tf.ConcatV2 with the constant axis
+// operand folded into the axis attribute): inputs match in every dimension
+// except the concatenated axis, which sums.
+static Expected<TensorMetadata> TfConcatOpMd(
+    VariadicOpArg<TensorMetadata> inputs, const OpAttrsRef& attrs) {
+  if (inputs.size() == 0)
+    return MakeStringError("tf.ConcatV2 needs at least one input");
+
+  const TensorMetadata& first = inputs[0];
+  const int rank = first.shape.GetRank();
+  int32_t axis = attrs.GetAsserting<int32_t>("axis");
+  if (axis < 0) axis += rank;
+  if (axis < 0 || axis >= rank)
+    return MakeStringError("tf.ConcatV2 axis out of range for rank ", rank);
+
+  SmallVector<ssize_t, 8> result_dims;
+  for (int d = 0; d < rank; ++d)
+    result_dims.push_back(first.shape.GetDimensionSize(d));
+
+  for (size_t i = 1; i < inputs.size(); ++i) {
+    const TensorMetadata& input = inputs[i];
+    if (input.dtype != first.dtype)
+      return MakeStringError("incompatible dtypes for tf.ConcatV2: In[0]: ",
+                             first.dtype, ", In[", i, "]: ", input.dtype);
+    if (input.shape.GetRank() != rank)
+      return MakeStringError("tf.ConcatV2 inputs must have the same rank");
+    for (int d = 0; d < rank; ++d) {
+      if (d == axis) {
+        result_dims[d] += input.shape.GetDimensionSize(d);
+      } else if (input.shape.GetDimensionSize(d) !=
+                 first.shape.GetDimensionSize(d)) {
+        return MakeStringError(
+            "tf.ConcatV2 inputs must match in all dimensions except the "
+            "concatenated axis");
+      }
+    }
+  }
+
+  return TensorMetadata(first.dtype, result_dims);
+}
+
+// Metadata function for _tf.Split (tf.Split with the constant axis operand
+// folded into the axis attribute). It uses the raw signature because the
+// number of results is not fixed at compile time: the input is split into
+// results.size() equal parts along the axis.
+static RCReference<AsyncValue> TfSplitOpMd(
+    const ExecutionContext& exec_ctx, ArrayRef<TensorMetadata> inputs,
+    const OpAttrsRef& attrs, MutableArrayRef<TensorMetadata> results) {
+  const TensorMetadata& input = inputs[0];
+  const int rank = input.shape.GetRank();
+  int32_t axis = attrs.GetAsserting<int32_t>("axis");
+  if (axis < 0) axis += rank;
+  if (axis < 0 || axis >= rank)
+    return EmitErrorAsync(exec_ctx, "tf.Split axis out of range");
+
+  const ssize_t axis_size = input.shape.GetDimensionSize(axis);
+  const ssize_t num_split = results.size();
+  if (num_split == 0 || axis_size % num_split != 0)
+    return EmitErrorAsync(
+        exec_ctx, "tf.Split axis dimension not divisible by num_split");
+
+  SmallVector<ssize_t, 8> part_dims;
+  for (int d = 0; d < rank; ++d)
+    part_dims.push_back(d == axis ? axis_size / num_split
+                                  : input.shape.GetDimensionSize(d));
+
+  TensorMetadata part_md(input.dtype, part_dims);
+  for (auto& result : results) result = part_md;
+  return {};
+}
+
+// Metadata function for _tf.RandomUniform and _tf.RandomStandardNormal: the
+// result shape comes from the folded shape attribute, and only f32 is
+// generated.
+static Expected<TensorMetadata> TfRandomOpMd(const OpAttrsRef& attrs) {
+  ArrayRef<ssize_t> shape;
+  if (!attrs.GetArray("shape", &shape))
+    return MakeStringError("random ops need a 'shape' array attribute");
+  return TensorMetadata(DType(DType::F32), shape);
+}
+
 static Expected<TensorMetadata> TfConvOpMd(const TensorMetadata& input,
                                            const TensorMetadata& filter,
                                            const OpAttrsRef& attrs) {
@@ -190,7 +350,9 @@ static Expected<TensorMetadata> TfConvOpMd(const TensorMetadata& input,
   return TensorMetadata(input.dtype, output_dims_nchw);
 }
 
-static Expected<TensorMetadata> TfMaxPoolOpMd(const TensorMetadata& input,
+// Shared by tf.MaxPool and tf.AvgPool: both produce the windowed output
+// shape of the input.
+static Expected<TensorMetadata> TfPoolingOpMd(const TensorMetadata& input,
                                               const OpAttrsRef& attrs) {
   auto padding = attrs.GetStringAsserting("padding");
   auto explicit_paddings = attrs.GetArrayOptional<int>("explicit_paddings");
@@ -495,9 +657,11 @@ GetAllTFMetadataFunctions() {
     result->emplace_back("tf.AddV2", TFRT_METADATA(TfBinaryOpMd));
     result->emplace_back("tf.Tanh", TFRT_METADATA(UnaryIdentityMd));
     result->emplace_back("tf.MatMul", TFRT_METADATA(MatMulMd));
+    result->emplace_back("tf._FusedMatMul", TFRT_METADATA(FusedMatMulMd));
     result->emplace_back("tf.Relu", TFRT_METADATA(UnaryIdentityMd));
     result->emplace_back("tf.Conv2D", TFRT_METADATA(TfConvOpMd));
-    result->emplace_back("tf.MaxPool", TFRT_METADATA(TfMaxPoolOpMd));
+    result->emplace_back("tf.MaxPool", TFRT_METADATA(TfPoolingOpMd));
+    result->emplace_back("tf.AvgPool", TFRT_METADATA(TfPoolingOpMd));
     result->emplace_back("tf.Mean", TFRT_METADATA(TfMeanOpMd));
     result->emplace_back("_tf.Mean", TFRT_METADATA(TfMeanOpFoldedMd));
     result->emplace_back("tf.Softmax", TFRT_METADATA(UnaryIdentityMd));
@@ -510,6 +674,15 @@ GetAllTFMetadataFunctions() {
     result->emplace_back("tf.Transpose", TFRT_METADATA(TfTransposeOpMd));
     result->emplace_back("_tf.Transpose", TFRT_METADATA(TfTransposeOpFoldedMd));
     result->emplace_back("tf.Cast", TFRT_METADATA(TfCastOpMd));
+    result->emplace_back("tf.Gather", TFRT_METADATA(TfGatherOpMd));
+    result->emplace_back("tf.ScatterAdd", TFRT_METADATA(TfScatterAddOpMd));
+    result->emplace_back("_tf.ConcatV2", TFRT_METADATA(TfConcatOpMd));
+    result->emplace_back("_tf.Split", TfSplitOpMd);
+    result->emplace_back("_tf.RandomUniform", TFRT_METADATA(TfRandomOpMd));
+    result->emplace_back("_tf.RandomStandardNormal",
+                         TFRT_METADATA(TfRandomOpMd));
+    result->emplace_back("tf._FusedLayerNorm",
+                         TFRT_METADATA(TfFusedLayerNormOpMd));
     return result;
   }();
 
@@ -0,0 +1,93 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RUN: tfrt_translate -mlir-to-bef %s | bef_executor | FileCheck %s --dump-input=always
+// RUN: tfrt_translate -mlir-to-bef %s | bef_executor --work_queue_type=mstd:4 | FileCheck %s --dump-input=always
+
+// With a constant input and a constant filter every "valid" output element is
+// the full-window sum: filter_height * filter_width * input * filter.
+
+// CHECK-LABEL: --- Running 'test_depthwise_conv2d_in_1x4x4x8_f_3x3_padding_valid_s_1x1'
+func @test_depthwise_conv2d_in_1x4x4x8_f_3x3_padding_valid_s_1x1() {
+  %ch0 = hex.new.chain
+
+  %input = "dht.create_uninitialized_tensor.f32.4"()
+    { shape = [1 : i64, 4 : i64, 4 : i64, 8 : i64] }
+    : () -> !t.tensor
+  %ch1 = dht.fill_tensor_with_constant.f32 %input, %ch0 1.0 : f32
+
+  %filter = "dht.create_uninitialized_tensor.f32.4"()
+    { shape = [3 : i64, 3 : i64, 8 : i64, 1 : i64] }
+    : () -> !t.tensor
+  %ch2 = dht.fill_tensor_with_constant.f32 %filter, %ch1 0.5 : f32
+
+  %output = "dht.create_uninitialized_tensor.f32.4"()
+    { shape = [1 : i64, 2 : i64, 2 : i64, 8 : i64] }
+    : () -> !t.tensor
+
+  // Every output element is 3 * 3 * 1.0 * 0.5 = 4.5.
+  %expected = "dht.create_uninitialized_tensor.f32.4"()
+    { shape = [1 : i64, 2 : i64, 2 : i64, 8 : i64] }
+    : () -> !t.tensor
+  %ch3 = dht.fill_tensor_with_constant.f32 %expected, %ch2 4.5 : f32
+
+  %ch4 = "eigen.depthwise_conv2d.f32"(%input, %filter, %output, %ch3)
+    { padding = "valid",  strides = [1 : i64, 1 : i64] }
+    : (!t.tensor, !t.tensor, !t.tensor, !hex.chain) -> !hex.chain
+
+  %cmp, %ch5 = "dht.tensor_allclose.f32"(%expected, %output, %ch4)
+    : (!t.tensor, !t.tensor, !hex.chain) -> (i1, !hex.chain)
+
+  // CHECK: int1 = 1
+  hex.print.i1 %cmp, %ch5
+
+  hex.return
+}
+
+// CHECK-LABEL: --- Running 'test_depthwise_conv2d_in_1x5x5x8_f_3x3_padding_valid_s_2x2'
+func @test_depthwise_conv2d_in_1x5x5x8_f_3x3_padding_valid_s_2x2() {
+  %ch0 = hex.new.chain
+
+  %input = "dht.create_uninitialized_tensor.f32.4"()
+    { shape = [1 : i64, 5 : i64, 5 : i64, 8 : i64] }
+    : () -> !t.tensor
+  %ch1 = dht.fill_tensor_with_constant.f32 %input, %ch0 2.0 : f32
+
+  %filter = "dht.create_uninitialized_tensor.f32.4"()
+    { shape = [3 : i64, 3 : i64, 8 : i64, 1 : i64] }
+    : () -> !t.tensor
+  %ch2 = dht.fill_tensor_with_constant.f32 %filter, %ch1 0.25 : f32
+
+  %output = "dht.create_uninitialized_tensor.f32.4"()
+    { shape = [1 : i64, 2 : i64, 2 : i64, 8 : i64] }
+    : () -> !t.tensor
+
+  // Every output element is 3 * 3 * 2.0 * 0.25 = 4.5.
+  %expected = "dht.create_uninitialized_tensor.f32.4"()
+    { shape = [1 : i64, 2 : i64, 2 : i64, 8 : i64] }
+    : () -> !t.tensor
+  %ch3 = dht.fill_tensor_with_constant.f32 %expected, %ch2 4.5 : f32
+
+  %ch4 = "eigen.depthwise_conv2d.f32"(%input, %filter, %output, %ch3)
+    { padding = "valid",  strides = [2 : i64, 2 : i64] }
+    : (!t.tensor, !t.tensor, !t.tensor, !hex.chain) -> !hex.chain
+
+  %cmp, %ch5 = "dht.tensor_allclose.f32"(%expected, %output, %ch4)
+    : (!t.tensor, !t.tensor, !hex.chain) -> (i1, !hex.chain)
+
+  // CHECK: int1 = 1
+  hex.print.i1 %cmp, %ch5
+
+  hex.return
+}
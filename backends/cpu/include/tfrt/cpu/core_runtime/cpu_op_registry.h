@@ -28,7 +28,9 @@
 #include <memory>
 
 #include "tfrt/core_runtime/op_metadata_function.h"
+#include "tfrt/host_context/async_value.h"
 #include "tfrt/support/forward_decls.h"
+#include "tfrt/tensor/tensor.h"
 
 namespace tfrt {
 
@@ -63,6 +65,45 @@ using CpuDispatchFn = void (*)(const ExecutionContext& exec_ctx,
                                MutableArrayRef<RCReference<AsyncValue>> results,
                                AsyncValueRef<Chain>* chain);
 
+// Guard for a specialized op variant (see CpuOpRegistry::AddOpVariant). The
+// predicate runs at dispatch time against the resolved input tensors and the
+// result metadata; returning true selects the variant's dispatch function.
+// Predicates must be cheap - they run on every invocation of the op.
+using CpuVariantPredicate = bool (*)(ArrayRef<AsyncValue*> inputs,
+                                     ArrayRef<TensorMetadata> result_mds);
+
+// Prebuilt predicates for the common specialization axes: element type and
+// rank. (DenseHostTensor is always contiguous, so those two are what changes
+// how an op's loops compile.) Use them as AddOpVariant predicates directly,
+// e.g. AllDenseInputsHaveDTypeAndRank<DType::F32, 2>.
+template <DType::Kind kind>
+bool AllDenseInputsHaveDType(ArrayRef<AsyncValue*> inputs,
+                             ArrayRef<TensorMetadata> result_mds) {
+  for (AsyncValue* input : inputs) {
+    if (input->get<Tensor>().dtype().kind() != kind) return false;
+  }
+  return true;
+}
+
+template <int rank>
+bool AllDenseInputsHaveRank(ArrayRef<AsyncValue*> inputs,
+                            ArrayRef<TensorMetadata> result_mds) {
+  for (AsyncValue* input : inputs) {
+    if (input->get<Tensor>().shape().GetRank() != rank) return false;
+  }
+  return true;
+}
+
+template <DType::Kind kind, int rank>
+bool AllDenseInputsHaveDTypeAndRank(ArrayRef<AsyncValue*> inputs,
+                                    ArrayRef<TensorMetadata> result_mds) {
+  for (AsyncValue* input : inputs) {
+    const Tensor& t = input->get<Tensor>();
+    if (t.dtype().kind() != kind || t.shape().GetRank() != rank) return false;
+  }
+  return true;
+}
+
 // CpuOpFlags allows customization points for ops that want to support
 // more exotic features.  The defaults are set to conservatively correct
 // behavior:
@@ -131,6 +172,16 @@ class CpuOpRegistry {
   void AddOp(string_view op_name, CpuDispatchFn dispatch_fn, CpuOpFlags flags,
              ArrayRef<string_view> attr_names);
 
+  // Add a specialized variant of an op registered with AddOp. At dispatch
+  // time the variants are tried in registration order and the first one
+  // whose predicate matches the invocation runs instead of the generic
+  // dispatch function; if none matches, the generic implementation runs.
+  // This lets hot ops ship e.g. dtype- or rank-specialized loop nests
+  // without hand-written per-op dispatch. Variants share the op's flags,
+  // attribute names and metadata function.
+  void AddOpVariant(string_view op_name, CpuDispatchFn dispatch_fn,
+                    CpuVariantPredicate predicate);
+
   // Set a metadata function for the specified op_name.  All metadata functions
   // are required to be semantically equal, so multiple registrations for the
   // same op are allowed (making static initialization easier).
@@ -34,6 +34,7 @@
 #include "tfrt/host_context/chain.h"
 #include "tfrt/host_context/host_context.h"
 #include "tfrt/host_context/location.h"
+#include "tfrt/tensor/conversion_registry.h"
 #include "tfrt/tensor/dense_host_tensor.h"
 #include "tfrt/tensor/host_tensor.h"
 
@@ -76,8 +77,11 @@ struct CpuOpHandlerTraits {
                                  const ExecutionContext& exec_ctx,
                                  RCReference<AsyncValue>* converted) {
     if (auto allowed_formats = TensorNeedsConversion(arg_tensor, op_entry)) {
-      *converted =
-          arg_tensor.ConvertToHostTensor(exec_ctx.host(), allowed_formats);
+      // Dispatch only reads converted arguments, so go through the conversion
+      // registry, which may return a result aliasing the argument's buffer
+      // instead of copying it.
+      *converted = ConvertTensorToHostTensor(arg_tensor, exec_ctx.host(),
+                                             allowed_formats);
       return true;
     }
     return false;
@@ -89,6 +93,15 @@ struct CpuOpHandlerTraits {
                        MutableArrayRef<RCReference<AsyncValue>> results,
                        AsyncValueRef<Chain>* chain,
                        const ExecutionContext& exec_ctx) {
+    // Specialized variants get first crack: the first one whose predicate
+    // matches this invocation runs instead of the generic implementation.
+    for (const auto& variant : op_entry.variants) {
+      if (variant.predicate(inputs, result_mds)) {
+        variant.dispatch_fn(exec_ctx, inputs, attrs, result_mds, results,
+                            chain);
+        return;
+      }
+    }
     op_entry.dispatch_fn(exec_ctx, inputs, attrs, result_mds, results, chain);
   }
 };
@@ -149,12 +162,21 @@ Expected<CoreRuntimeOp> CpuOpHandler::MakeOp(string_view op_name) {
   // fallback device.
   if (op_entry->dispatch_fn == nullptr) return GetFallback()->MakeOp(op_name);
 
+  // Ops with a metadata function get a per-op cache of its results: the
+  // metadata functions are pure, so invocations that repeat an argument shape
+  // signature skip shape inference entirely.
+  RCReference<internal::MetadataFnCache> metadata_cache;
+  if (op_entry->metadata_fn)
+    metadata_cache = TakeRef(new internal::MetadataFnCache());
+
   // NOTE(fishx): To avoid introducing an extra heap allocation, we need to
   // ensure that the size of captured variable is smaller than 3 pointers.
-  return CoreRuntimeOp([op_entry](const OpInvocation& invocation) {
+  return CoreRuntimeOp([op_entry, metadata_cache = std::move(metadata_cache)](
+                           const OpInvocation& invocation) {
     bool update_chain = !(op_entry->flags & CpuOpFlags::NoSideEffects);
     // TODO(fishx): ExecuteOnOpHandler should return void.
-    ExecuteOnOpHandler<CpuOpHandlerTraits>(update_chain, invocation, *op_entry);
+    ExecuteOnOpHandler<CpuOpHandlerTraits>(update_chain, invocation, *op_entry,
+                                           metadata_cache.get());
   });
 }
 
@@ -44,6 +44,13 @@ void CpuOpRegistry::AddOp(string_view op_name, CpuDispatchFn dispatch_fn,
   impl_->AddOp(op_name, dispatch_fn, flags, {});
 }
 
+// Add a specialized variant of an op; the first variant whose predicate
+// matches an invocation runs instead of the generic dispatch function.
+void CpuOpRegistry::AddOpVariant(string_view op_name, CpuDispatchFn dispatch_fn,
+                                 CpuVariantPredicate predicate) {
+  impl_->AddOpVariant(op_name, dispatch_fn, predicate);
+}
+
 // Set a metadata function for the specified op_name.  All metadata functions
 // are required to be semantically equal, so multiple registrations for the
 // same op are allowed (making static initialization easier).
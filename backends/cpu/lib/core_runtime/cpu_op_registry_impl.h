@@ -31,10 +31,11 @@ namespace tfrt {
 
 // This is the pImpl implementation details for CpuOpRegistry.
 struct CpuOpRegistry::Impl final
-    : OpRegistryImpl<OpMetadataFn, CpuDispatchFn, CpuOpFlags> {};
+    : OpRegistryImpl<OpMetadataFn, CpuDispatchFn, CpuOpFlags,
+                     CpuVariantPredicate> {};
 
-using CpuOpEntry =
-    OpRegistryImpl<OpMetadataFn, CpuDispatchFn, CpuOpFlags>::OpEntry;
+using CpuOpEntry = OpRegistryImpl<OpMetadataFn, CpuDispatchFn, CpuOpFlags,
+                                  CpuVariantPredicate>::OpEntry;
 }  // namespace tfrt
 
 #endif  // TFRT_BACKENDS_CPU_LIB_CORE_RUNTIME_CPU_OP_REGISTRY_IMPL_H_
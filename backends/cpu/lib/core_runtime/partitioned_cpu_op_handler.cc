@@ -0,0 +1,249 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- partitioned_cpu_op_handler.cc --------------------------------------===//
+//
+// This file implements the PartitionedCpuOpHandler.
+//
+//===----------------------------------------------------------------------===//
+
+#include "partitioned_cpu_op_handler.h"  // NOLINT
+
+#include <cstdlib>
+
+#include "cpu_op_handler.h"  // NOLINT
+#include "llvm/Support/Casting.h"
+#include "tfrt/core_runtime/core_runtime.h"
+#include "tfrt/core_runtime/op_attrs.h"
+#include "tfrt/core_runtime/op_invocation.h"
+#include "tfrt/core_runtime/tensor_handle.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+#define DEBUG_TYPE "tfrt-partitioned-cpu-op-handler"
+
+namespace tfrt {
+
+static const char kTransferOpName[] = "partitioned_cpu.transfer";
+
+llvm::Expected<std::unique_ptr<PartitionedCpuOpHandler>>
+PartitionedCpuOpHandler::Create(CoreRuntime* runtime, OpHandler* fallback) {
+  // The partition count matches the number of memory domains the deployment
+  // wants to split the model across, typically the NUMA node count.
+  size_t num_partitions = 1;
+  if (const char* env = getenv("CPU_PARTITION_COUNT")) {
+    size_t value;
+    if (!string_view(env).getAsInteger(/*Radix=*/10, value) && value > 0)
+      num_partitions = value;
+  }
+
+  std::vector<std::unique_ptr<CpuOpHandler>> partitions;
+  partitions.reserve(num_partitions);
+  for (size_t i = 0; i != num_partitions; ++i) {
+    auto partition = CpuOpHandler::Create(runtime, fallback);
+    if (!partition) return partition.takeError();
+    partitions.push_back(std::move(*partition));
+  }
+
+  return std::make_unique<PartitionedCpuOpHandler>(runtime, fallback,
+                                                   std::move(partitions));
+}
+
+PartitionedCpuOpHandler::PartitionedCpuOpHandler(
+    CoreRuntime* runtime, OpHandler* fallback,
+    std::vector<std::unique_ptr<CpuOpHandler>> partitions)
+    : OpHandler("partitioned_cpu", runtime, fallback),
+      partitions_(std::move(partitions)) {
+  assert(!partitions_.empty() && "need at least one partition");
+}
+
+PartitionedCpuOpHandler::~PartitionedCpuOpHandler() {}
+
+AsyncValueRef<DenseHostTensor> PartitionedCpuOpHandler::CopyDeviceTensorToHost(
+    const Tensor& tensor) {
+  return partitions_[0]->CopyDeviceTensorToHost(tensor);
+}
+
+AsyncValueRef<Tensor> PartitionedCpuOpHandler::CopyHostTensorToDevice(
+    const DenseHostTensor& tensor) {
+  return partitions_[0]->CopyHostTensorToDevice(tensor);
+}
+
+uint32_t PartitionedCpuOpHandler::GetPartitionForArguments(
+    ArrayRef<TensorHandle> arguments) {
+  if (partitions_.size() == 1) return 0;
+
+  // Route to the partition owning the first argument with a recorded
+  // placement.  Unavailable or non-dense arguments don't contribute: routing
+  // is a locality hint and must not block on async inputs.
+  for (const TensorHandle& argument : arguments) {
+    if (!argument.IsValid()) continue;
+    AsyncValue* tensor_av = argument.GetAsyncTensor();
+    if (!tensor_av->IsConcrete()) continue;
+    const auto* dht =
+        llvm::dyn_cast<DenseHostTensor>(&tensor_av->get<Tensor>());
+    if (!dht) continue;
+
+    mutex_lock lock(mu_);
+    auto it = placements_.find(dht->data());
+    if (it != placements_.end()) return it->second;
+  }
+
+  // No argument has a known placement (e.g. model inputs): spread such ops
+  // across the partitions round-robin.
+  return next_partition_.fetch_add(1, std::memory_order_relaxed) %
+         partitions_.size();
+}
+
+void PartitionedCpuOpHandler::RecordPlacement(const void* data,
+                                              uint32_t partition) {
+  mutex_lock lock(mu_);
+  if (placements_.size() >= kMaxPlacementEntries) placements_.clear();
+  placements_[data] = partition;
+}
+
+void PartitionedCpuOpHandler::RecordResultPlacements(
+    MutableArrayRef<TensorHandle> results, uint32_t partition) {
+  if (partitions_.size() == 1) return;
+
+  for (const TensorHandle& result : results) {
+    if (!result.IsValid()) continue;
+    AsyncValue* tensor_av = result.GetAsyncTensor();
+    auto record = [this, partition](AsyncValue* av) {
+      if (!av->IsConcrete()) return;
+      if (const auto* dht = llvm::dyn_cast<DenseHostTensor>(&av->get<Tensor>()))
+        RecordPlacement(dht->data(), partition);
+    };
+    if (tensor_av->IsAvailable()) {
+      record(tensor_av);
+    } else {
+      tensor_av->AndThen([record, tensor_ref = FormRef(tensor_av)] {
+        record(tensor_ref.get());
+      });
+    }
+  }
+}
+
+CoreRuntimeOp PartitionedCpuOpHandler::MakeTransferOp() {
+  return CoreRuntimeOp([this](const OpInvocation& invocation) {
+    auto propagate_error = [&](RCReference<AsyncValue> error) {
+      for (auto& result : invocation.results)
+        result = TensorHandle::CreateError(error.CopyRef());
+    };
+
+    auto target_attr = invocation.attrs.GetOptional<int64_t>("partition");
+    if (!target_attr || *target_attr < 0 ||
+        static_cast<size_t>(*target_attr) >= partitions_.size()) {
+      propagate_error(EmitErrorAsync(
+          invocation.exec_ctx,
+          "partitioned_cpu.transfer requires a 'partition' i64 attribute "
+          "naming a partition"));
+      return;
+    }
+    if (invocation.arguments.size() != 1 || invocation.results.size() != 1) {
+      propagate_error(EmitErrorAsync(
+          invocation.exec_ctx,
+          "partitioned_cpu.transfer takes one argument and one result"));
+      return;
+    }
+    auto target = static_cast<uint32_t>(*target_attr);
+
+    TensorHandle& argument = invocation.arguments[0];
+    HostContext* host = invocation.exec_ctx.host();
+    AsyncValue* tensor_av = argument.GetAsyncTensor();
+
+    // The result shares the argument's metadata: a transfer copies bytes, it
+    // never changes shape or dtype.
+    auto indirect = host->MakeIndirectAsyncValue();
+    if (argument.IsMetadataAvailable()) {
+      invocation.results[0] =
+          TensorHandle(argument.GetAvailableMetadata(),
+                       AsyncValueRef<Tensor>(indirect.CopyRef()));
+    } else {
+      invocation.results[0] =
+          TensorHandle(argument.GetAsyncMetadata().CopyRef(),
+                       AsyncValueRef<Tensor>(indirect.CopyRef()));
+    }
+
+    // Copy into a fresh buffer and record the copy as owned by the target
+    // partition.  Once partitions bind node-local allocators, this copy is
+    // the allocation that lands on the target node.
+    auto do_transfer = [this, host, target](
+                           AsyncValue* av,
+                           RCReference<IndirectAsyncValue> indirect) {
+      if (av->IsError()) {
+        indirect->ForwardTo(FormRef(av));
+        return;
+      }
+      uint32_t allowed_formats =
+          1 << static_cast<uint32_t>(Tensor::Subclass::DenseHost);
+      auto copy = av->get<Tensor>().ConvertToHostTensor(host, allowed_formats);
+      auto copy_ref = copy.ReleaseRCRef();
+      AsyncValue* copy_av = copy_ref.get();
+      auto record = [this, target](AsyncValue* av) {
+        if (!av->IsConcrete()) return;
+        if (const auto* dht =
+                llvm::dyn_cast<DenseHostTensor>(&av->get<Tensor>()))
+          RecordPlacement(dht->data(), target);
+      };
+      if (copy_av->IsAvailable()) {
+        record(copy_av);
+      } else {
+        copy_av->AndThen(
+            [record, copy = FormRef(copy_av)] { record(copy.get()); });
+      }
+      indirect->ForwardTo(std::move(copy_ref));
+    };
+
+    if (tensor_av->IsAvailable()) {
+      do_transfer(tensor_av, std::move(indirect));
+    } else {
+      tensor_av->AndThen([do_transfer, tensor_ref = FormRef(tensor_av),
+                          indirect = std::move(indirect)]() mutable {
+        do_transfer(tensor_ref.get(), std::move(indirect));
+      });
+    }
+  });
+}
+
+//===----------------------------------------------------------------------===//
+// Op Dispatch Implementation
+//===----------------------------------------------------------------------===//
+
+Expected<CoreRuntimeOp> PartitionedCpuOpHandler::MakeOp(string_view op_name) {
+  if (op_name == kTransferOpName) return MakeTransferOp();
+
+  // Resolve the op on every partition up front so invocation-time routing is
+  // just an index into the resolved ops.
+  auto partition_ops = std::make_shared<std::vector<CoreRuntimeOp>>();
+  partition_ops->reserve(partitions_.size());
+  for (auto& partition : partitions_) {
+    auto op = partition->MakeOp(op_name);
+    if (!op) return op.takeError();
+    partition_ops->push_back(std::move(*op));
+  }
+
+  bool is_fallback = (*partition_ops)[0].IsFallback();
+  return CoreRuntimeOp(
+      [this, partition_ops = std::move(partition_ops)](
+          const OpInvocation& invocation) mutable {
+        uint32_t partition = GetPartitionForArguments(invocation.arguments);
+        (*partition_ops)[partition](invocation);
+        RecordResultPlacements(invocation.results, partition);
+      },
+      is_fallback);
+}
+
+}  // namespace tfrt
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- partitioned_cpu_op_handler.h -----------------------------*- C++ -*-===//
+//
+// This file declares PartitionedCpuOpHandler, which runs ops on one of
+// several CPU partition instances with locality-aware routing.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_BACKENDS_CPU_LIB_CORE_RUNTIME_PARTITIONED_CPU_OP_HANDLER_H_
+#define TFRT_BACKENDS_CPU_LIB_CORE_RUNTIME_PARTITIONED_CPU_OP_HANDLER_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "llvm/ADT/DenseMap.h"
+#include "tfrt/core_runtime/op_handler.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+
+class CpuOpHandler;
+class Tensor;
+class TensorHandle;
+
+// PartitionedCpuOpHandler maintains several CpuOpHandler instances (one per
+// memory partition, e.g. per NUMA node) and routes each op invocation to the
+// partition that owns the op's input tensors, so a model spread across
+// sockets keeps its working set node-local.  Ownership is tracked as a hint
+// table keyed by tensor buffer address: the results of an op executed on
+// partition P are recorded as owned by P, and later invocations consuming
+// those buffers are routed back to P.  The hint only affects locality, never
+// correctness, so a stale entry after buffer reuse is harmless.
+//
+// The rare cross-partition edge is made explicit with the
+// "partitioned_cpu.transfer" op, which takes one tensor and an i64
+// "partition" attribute, copies the tensor into a fresh buffer, and records
+// the copy as owned by the target partition.
+//
+// The per-partition CpuOpHandler instances are the attachment point for
+// node-local allocators and work queues; in the current runtime all
+// partitions share the HostContext allocator and work queue, so this handler
+// provides the routing structure and transfer semantics that those bindings
+// plug into.
+class PartitionedCpuOpHandler : public OpHandler {
+ public:
+  // The number of partitions is read from the CPU_PARTITION_COUNT environment
+  // variable, defaulting to 1.
+  static llvm::Expected<std::unique_ptr<PartitionedCpuOpHandler>> Create(
+      CoreRuntime* runtime, OpHandler* fallback);
+
+  PartitionedCpuOpHandler(
+      CoreRuntime* runtime, OpHandler* fallback,
+      std::vector<std::unique_ptr<CpuOpHandler>> partitions);
+
+  ~PartitionedCpuOpHandler() override;
+
+  Expected<CoreRuntimeOp> MakeOp(string_view op_name) override;
+
+  AsyncValueRef<DenseHostTensor> CopyDeviceTensorToHost(
+      const Tensor& tensor) override;
+
+  AsyncValueRef<Tensor> CopyHostTensorToDevice(
+      const DenseHostTensor& tensor) override;
+
+  size_t GetNumPartitions() const { return partitions_.size(); }
+
+ private:
+  // Return the partition owning the first argument tensor with a recorded
+  // placement, or the next partition in round-robin order if none of the
+  // arguments have one.
+  uint32_t GetPartitionForArguments(ArrayRef<TensorHandle> arguments);
+
+  // Record the result tensors of an op executed on `partition` as owned by
+  // that partition, once each tensor becomes available.
+  void RecordResultPlacements(MutableArrayRef<TensorHandle> results,
+                              uint32_t partition);
+
+  void RecordPlacement(const void* data, uint32_t partition);
+
+  CoreRuntimeOp MakeTransferOp();
+
+  // The placement table is a bounded hint cache: when it fills up it is
+  // cleared and repopulated by subsequent executions.
+  static constexpr size_t kMaxPlacementEntries = 4096;
+
+  const std::vector<std::unique_ptr<CpuOpHandler>> partitions_;
+  std::atomic<uint32_t> next_partition_{0};
+
+  mutable mutex mu_;
+  llvm::DenseMap<const void*, uint32_t> placements_ TFRT_GUARDED_BY(mu_);
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_BACKENDS_CPU_LIB_CORE_RUNTIME_PARTITIONED_CPU_OP_HANDLER_H_
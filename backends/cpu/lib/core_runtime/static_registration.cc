@@ -22,11 +22,14 @@
 
 #include "./cpu_op_handler.h"
 #include "./null_op_handler.h"
+#include "./partitioned_cpu_op_handler.h"
 #include "tfrt/core_runtime/op_handler_factory.h"
 
 namespace tfrt {
 
 static OpHandlerRegistration register_null("null", NullOpHandler::Create);
 static OpHandlerRegistration register_cpu("cpu", CpuOpHandler::Create);
+static OpHandlerRegistration register_partitioned_cpu(
+    "partitioned_cpu", PartitionedCpuOpHandler::Create);
 
 }  // namespace tfrt
@@ -23,10 +23,16 @@
 #ifndef TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_CPU_KERNELS_H_
 #define TFRT_BACKENDS_CPU_LIB_KERNELS_CPU_CPU_KERNELS_H_
 
+#include <algorithm>
+#include <cassert>
+
 #include "mkldnn.h"  // from @mkl_dnn
 #include "tfrt/common/compat/eigen/eigen_kernel.h"
+#include "tfrt/common/compat/eigen/tensor_types.h"
+#include "tfrt/common/compat/eigen/thread_pool_device.h"
 #include "tfrt/host_context/async_value_ref.h"
 #include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/execution_context.h"
 #include "tfrt/host_context/kernel_utils.h"
 #include "tfrt/support/msan.h"
 #include "tfrt/tensor/dense_host_tensor_view.h"
@@ -35,11 +41,169 @@
 namespace tfrt {
 namespace cpu {
 
+//===----------------------------------------------------------------------===//
+// Elementwise kernel helpers
+//===----------------------------------------------------------------------===//
+
+// Run elementwise kernels single-threaded below this number of elements.
+// These kernels are memory bound, so the fixed cost of dispatching blocks to
+// worker threads is only recovered once the operands stop fitting in the
+// caller's cache.
+static constexpr int64_t kParallelElementwiseMinElements = 64 * 1024;
+
+// Evaluates `dest = expr` over the flattened views: single-threaded for small
+// outputs, on the HostContext worker threads for large ones. Blocks until the
+// assignment has completed, preserving the synchronous contract of the
+// elementwise kernels below.
+template <typename T, typename Expr>
+void ElementwiseAssign(MutableDHTArrayView<T> dest, Expr expr,
+                       HostContext* host) {
+  auto dest_t = compat::AsEigenTensor(dest);
+  if (static_cast<int64_t>(dest.NumElements()) <
+      kParallelElementwiseMinElements) {
+    dest_t = expr;
+  } else {
+    compat::SyncAssign(
+        host->GetOrCreateSharedContext<compat::EigenHostContext>(),
+        std::move(dest_t), std::move(expr));
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Parallel reduction helpers
+//===----------------------------------------------------------------------===//
+
+// Minimum number of elements worth dispatching as one reduction block to a
+// worker thread. Reductions read each element once, so like the elementwise
+// kernels they are memory bound, but each block produces a single value, so
+// smaller blocks still amortize their scheduling cost.
+static constexpr size_t kParallelReduceMinBlockSize = 16 * 1024;
+
+// Sums the contiguous range [begin, end). The four independent accumulators
+// break the loop-carried dependence so the compiler can vectorize the
+// floating point sum without reassociating a single serial chain.
+template <typename T>
+T SumRange(const T* begin, const T* end) {
+  T acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+  for (; begin + 4 <= end; begin += 4) {
+    acc0 += begin[0];
+    acc1 += begin[1];
+    acc2 += begin[2];
+    acc3 += begin[3];
+  }
+  for (; begin != end; ++begin) acc0 += *begin;
+  return (acc0 + acc1) + (acc2 + acc3);
+}
+
+// Returns the maximum of the contiguous range [begin, end), which must not be
+// empty.
+template <typename T>
+T MaxRange(const T* begin, const T* end) {
+  assert(begin != end);
+  T result = *begin++;
+  for (; begin != end; ++begin) result = std::max(result, *begin);
+  return result;
+}
+
+//===----------------------------------------------------------------------===//
+// Shape-specialized broadcasting for binary kernels
+//===----------------------------------------------------------------------===//
+
+// The broadcast patterns with specialized inner loops. The pattern is chosen
+// once from the operand shapes, outside the loops, so the loop over the
+// contiguous innermost dimension stays free of per-element shape arithmetic
+// and vectorizes like the dense same-shape loop.
+enum class BroadcastPattern {
+  // The smaller operand has a single element.
+  kScalar,
+  // The smaller operand is a vector matching the innermost dimension of the
+  // larger one, e.g. a per-channel bias combined with an NHWC activation.
+  kInnerDim,
+  // The larger operand is [rows, cols] and the smaller one [rows, 1]: one
+  // value of the smaller operand per contiguous output row.
+  kPerRow,
+  kUnsupported,
+};
+
+// Classifies how `small` broadcasts against `big`; `big` is the operand whose
+// shape is the result shape.
+inline BroadcastPattern ClassifyBroadcastPattern(const TensorShape& big,
+                                                 const TensorShape& small) {
+  const ssize_t small_elements = small.GetNumElements();
+  if (small_elements == 1) return BroadcastPattern::kScalar;
+  const ssize_t small_inner = small.GetDimensionSize(small.GetRank() - 1);
+  if (small_inner == small_elements &&
+      small_inner == big.GetDimensionSize(big.GetRank() - 1))
+    return BroadcastPattern::kInnerDim;
+  if (big.GetRank() == 2 && small.GetRank() == 2 &&
+      small.GetDimensionSize(0) == big.GetDimensionSize(0) &&
+      small.GetDimensionSize(1) == 1)
+    return BroadcastPattern::kPerRow;
+  return BroadcastPattern::kUnsupported;
+}
+
+// Evaluates dest = fn(lhs, rhs) where the smaller dense operand broadcasts
+// against the larger one. `fn` is a scalar functor, called with its arguments
+// in the original (lhs, rhs) order. `dest` must have the shape of the larger
+// operand.
+template <typename T, typename Fn>
+Expected<Chain> BroadcastBinaryKernel(const DenseHostTensor& lhs,
+                                      const DenseHostTensor& rhs,
+                                      DenseHostTensor* dest, Fn fn) {
+  const bool rhs_is_small = rhs.NumElements() <= lhs.NumElements();
+  const DenseHostTensor& big = rhs_is_small ? lhs : rhs;
+  const DenseHostTensor& small = rhs_is_small ? rhs : lhs;
+  assert(dest->shape() == big.shape());
+
+  const T* big_data = static_cast<const T*>(big.data());
+  const T* small_data = static_cast<const T*>(small.data());
+  T* dest_data = static_cast<T*>(dest->data());
+  const ssize_t num_elements = big.NumElements();
+
+  // `rhs_is_small` is loop invariant, so the branch is hoisted out of the
+  // vectorized loops below.
+  auto apply = [fn, rhs_is_small](T big_value, T small_value) {
+    return rhs_is_small ? fn(big_value, small_value)
+                        : fn(small_value, big_value);
+  };
+
+  switch (ClassifyBroadcastPattern(big.shape(), small.shape())) {
+    case BroadcastPattern::kScalar: {
+      const T scalar = small_data[0];
+      for (ssize_t i = 0; i < num_elements; ++i)
+        dest_data[i] = apply(big_data[i], scalar);
+      return Chain();
+    }
+    case BroadcastPattern::kInnerDim: {
+      const ssize_t inner = small.NumElements();
+      for (ssize_t base = 0; base < num_elements; base += inner)
+        for (ssize_t j = 0; j < inner; ++j)
+          dest_data[base + j] = apply(big_data[base + j], small_data[j]);
+      return Chain();
+    }
+    case BroadcastPattern::kPerRow: {
+      const ssize_t rows = big.shape().GetDimensionSize(0);
+      const ssize_t cols = big.shape().GetDimensionSize(1);
+      for (ssize_t i = 0; i < rows; ++i) {
+        const T row_value = small_data[i];
+        const T* big_row = big_data + i * cols;
+        T* dest_row = dest_data + i * cols;
+        for (ssize_t j = 0; j < cols; ++j)
+          dest_row[j] = apply(big_row[j], row_value);
+      }
+      return Chain();
+    }
+    case BroadcastPattern::kUnsupported:
+      break;
+  }
+  return MakeStringError("unsupported broadcast of shape ", small.shape(),
+                         " against shape ", big.shape());
+}
+
 //===----------------------------------------------------------------------===//
 // CPU Add kernels
 //===----------------------------------------------------------------------===//
 
-// TODO(tf-runtime-team): Add should be implemented using eigen kernels.
 // TODO(fishx): Let this kernel support fp16.
 template <typename T>
 AsyncValueRef<HostTensor> Add(const HostTensor& lhs_ref,
@@ -60,7 +224,14 @@ AsyncValueRef<HostTensor> Add(const HostTensor& lhs_ref,
         slhs->metadata(), result);
   }
 
-  auto dest = DenseHostTensor::CreateUninitialized(lhs->metadata(), host);
+  // The result takes the shape of the larger operand; for the supported
+  // broadcast patterns that is the broadcasted shape.
+  const HostTensor* dest_like = rhs;
+  if (auto* dlhs = dyn_cast<DenseHostTensor>(lhs)) {
+    if (dlhs->NumElements() > cast<DenseHostTensor>(rhs)->NumElements())
+      dest_like = lhs;
+  }
+  auto dest = DenseHostTensor::CreateUninitialized(dest_like->metadata(), host);
   if (!dest)
     return host->MakeErrorAsyncValueRef("out of memory allocating result");
 
@@ -68,16 +239,90 @@ AsyncValueRef<HostTensor> Add(const HostTensor& lhs_ref,
 
   // Handle scalar+dense.
   DHTArrayView<T> rhs_view(cast<DenseHostTensor>(rhs));
+  auto rhs_t = compat::AsEigenConstTensor(rhs_view);
   if (auto* slhs = dyn_cast<ScalarHostTensor<T>>(lhs)) {
     // Add a scalar to a dense tensor.
-    auto lhs = slhs->GetValue();
-    for (size_t i = 0, e = dest_view.NumElements(); i != e; ++i)
-      dest_view[i] = lhs + rhs_view[i];
+    ElementwiseAssign<T>(dest_view, rhs_t + rhs_t.constant(slhs->GetValue()),
+                         host);
+  } else if (lhs->shape() == rhs->shape()) {
+    // Add two dense tensors of the same shape.
+    DHTArrayView<T> lhs_view(cast<DenseHostTensor>(lhs));
+    auto lhs_t = compat::AsEigenConstTensor(lhs_view);
+    ElementwiseAssign<T>(dest_view, lhs_t + rhs_t, host);
   } else {
-    // Add two dense tensors.
+    // Add two dense tensors through the shape-specialized broadcast loops.
+    auto result = BroadcastBinaryKernel<T>(
+        *cast<DenseHostTensor>(lhs), *cast<DenseHostTensor>(rhs),
+        dest.getPointer(), [](T a, T b) { return a + b; });
+    if (!result)
+      return host->MakeErrorAsyncValueRef(toString(result.takeError()));
+  }
+  return host->MakeAvailableAsyncValueRef<DenseHostTensor>(
+      std::move(dest.getValue()));
+}
+
+//===----------------------------------------------------------------------===//
+// CPU Multiply kernels
+//===----------------------------------------------------------------------===//
+
+// Like Add above, this keeps ScalarHostTensor operands symbolic instead of
+// materializing them: Scalar*Scalar produces another ScalarHostTensor, and
+// Scalar*Dense keeps the scalar in a register while streaming over the dense
+// operand. Broadcasting a scale factor thus never allocates an N-element
+// tensor.
+template <typename T>
+AsyncValueRef<HostTensor> Multiply(const HostTensor& lhs_ref,
+                                   const HostTensor& rhs_ref,
+                                   HostContext* host) {
+  auto* lhs = &lhs_ref;
+  auto* rhs = &rhs_ref;
+
+  // We handle Scalar*Scalar, Scalar*Dense, Dense*Dense below. Swap
+  // Dense*Scalar to simplify the logic since multiply is commutative.
+  if (isa<DenseHostTensor>(lhs) && isa<AnyScalarHostTensor>(rhs))
+    std::swap(lhs, rhs);
+
+  // Handle scalar*scalar.
+  if (auto* srhs = dyn_cast<ScalarHostTensor<T>>(rhs)) {
+    auto* slhs = cast<ScalarHostTensor<T>>(lhs);
+    auto result = slhs->GetValue() * srhs->GetValue();
+    return host->template MakeAvailableAsyncValueRef<ScalarHostTensor<T>>(
+        slhs->metadata(), result);
+  }
+
+  // The result takes the shape of the larger operand; for the supported
+  // broadcast patterns that is the broadcasted shape.
+  const HostTensor* dest_like = rhs;
+  if (auto* dlhs = dyn_cast<DenseHostTensor>(lhs)) {
+    if (dlhs->NumElements() > cast<DenseHostTensor>(rhs)->NumElements())
+      dest_like = lhs;
+  }
+  auto dest = DenseHostTensor::CreateUninitialized(dest_like->metadata(), host);
+  if (!dest)
+    return host->MakeErrorAsyncValueRef("out of memory allocating result");
+
+  MutableDHTArrayView<T> dest_view(dest.getPointer());
+
+  // Handle scalar*dense.
+  DHTArrayView<T> rhs_view(cast<DenseHostTensor>(rhs));
+  auto rhs_t = compat::AsEigenConstTensor(rhs_view);
+  if (auto* slhs = dyn_cast<ScalarHostTensor<T>>(lhs)) {
+    // Multiply a dense tensor by a scalar.
+    ElementwiseAssign<T>(dest_view, rhs_t * rhs_t.constant(slhs->GetValue()),
+                         host);
+  } else if (lhs->shape() == rhs->shape()) {
+    // Multiply two dense tensors of the same shape.
     DHTArrayView<T> lhs_view(cast<DenseHostTensor>(lhs));
-    for (size_t i = 0, e = dest_view.NumElements(); i != e; ++i)
-      dest_view[i] = lhs_view[i] + rhs_view[i];
+    auto lhs_t = compat::AsEigenConstTensor(lhs_view);
+    ElementwiseAssign<T>(dest_view, lhs_t * rhs_t, host);
+  } else {
+    // Multiply two dense tensors through the shape-specialized broadcast
+    // loops.
+    auto result = BroadcastBinaryKernel<T>(
+        *cast<DenseHostTensor>(lhs), *cast<DenseHostTensor>(rhs),
+        dest.getPointer(), [](T a, T b) { return a * b; });
+    if (!result)
+      return host->MakeErrorAsyncValueRef(toString(result.takeError()));
   }
   return host->MakeAvailableAsyncValueRef<DenseHostTensor>(
       std::move(dest.getValue()));
@@ -87,38 +332,60 @@ AsyncValueRef<HostTensor> Add(const HostTensor& lhs_ref,
 // CPU Matmul kernels
 //===----------------------------------------------------------------------===//
 
+// Run the contraction single-threaded below this number of multiply-add
+// operations. For small matrices the fixed cost of partitioning the loop nest
+// across worker threads exceeds the compute itself.
+static constexpr int64_t kParallelMatMulMinOps = 256 * 1024;
+
 template <typename T>
 void MatMul2DKernel(T alpha, DHTIndexableView<T, 2> A, DHTIndexableView<T, 2> B,
                     T beta, MutableDHTIndexableView<T, 2>& C, bool transpose_a,
-                    bool transpose_b) {
+                    bool transpose_b, const ExecutionContext& exec_ctx) {
+  // Evaluate the matmul as an Eigen contraction: Eigen packs panels of A and
+  // B into cache-sized blocks and runs a vectorized inner kernel, so this is
+  // cache-blocked for every dtype, not just float.
+  auto a = compat::AsEigenConstTensor(A);
+  auto b = compat::AsEigenConstTensor(B);
+  auto c = compat::AsEigenTensor(C);
+
+  // Contracting over the transposed dimension of an operand computes
+  // op(A) @ op(B) without materializing the transpose.
+  Eigen::array<Eigen::IndexPair<Eigen::Index>, 1> contract_dim;
+  contract_dim[0] = Eigen::IndexPair<Eigen::Index>(transpose_a ? 0 : 1,
+                                                   transpose_b ? 1 : 0);
+
   T zero = static_cast<T>(0);
-  // TODO(zhangqiaorjc): Handle transpose.
-  assert(transpose_a == false);
-  assert(transpose_b == false);
-  size_t rows = C.FixedShape()[0];
-  size_t cols = C.FixedShape()[1];
-  size_t inner_dim = A.FixedShape()[1];
-  for (size_t i = 0; i < rows; ++i) {
-    for (size_t j = 0; j < cols; ++j) {
-      T sum = zero;
-      for (size_t k = 0; k < inner_dim; ++k) {
-        sum += A.ElementAt(i, k) * B.ElementAt(k, j);
-      }
-      // We need to handle beta=0 without using C as input since C is
-      // uninitialized to avoid msan errors.
-      if (beta == zero)
-        C.ElementAt(i, j) = alpha * sum;
-      else
-        C.ElementAt(i, j) = alpha * sum + beta * C.ElementAt(i, j);
-    }
+  const Eigen::Index inner_dim = a.dimension(transpose_a ? 0 : 1);
+  const int64_t num_ops = c.dimension(0) * c.dimension(1) * inner_dim;
+  if (num_ops < kParallelMatMulMinOps) {
+    // We need to handle beta=0 without using C as input since C is
+    // uninitialized to avoid msan errors.
+    if (beta == zero)
+      c = a.contract(b, contract_dim) * alpha;
+    else
+      c = a.contract(b, contract_dim) * alpha + c * beta;
+    return;
   }
+
+  // Large matrices: evaluate the contraction on the HostContext worker
+  // threads. Assignment through the device blocks until all blocks have been
+  // computed, preserving the synchronous contract of this kernel.
+  const Eigen::ThreadPoolDevice& device =
+      exec_ctx.host()
+          ->GetOrCreateSharedContext<compat::EigenHostContext>()
+          .Device();
+  if (beta == zero)
+    c.device(device) = a.contract(b, contract_dim) * alpha;
+  else
+    c.device(device) = a.contract(b, contract_dim) * alpha + c * beta;
 }
 
 template <>
 inline void MatMul2DKernel<float>(float alpha, DHTIndexableView<float, 2> A,
                                   DHTIndexableView<float, 2> B, float beta,
                                   MutableDHTIndexableView<float, 2>& C,
-                                  bool transpose_a, bool transpose_b) {
+                                  bool transpose_a, bool transpose_b,
+                                  const ExecutionContext& exec_ctx) {
   // MKL-DNN sgemm computes C = alpha * A @ B + beta * C, assuming all matrices
   // are column-major. MLIR tensors are row-major. We compute,
   //   C_rowmajor = C_colmajor^T = B_colmajor^T * A_colmajor^T,
@@ -190,13 +457,15 @@ inline void MatMul2DKernel<float>(float alpha, DHTIndexableView<float, 2> A,
 template <typename T>
 void CallMatMulKernel(const DenseHostTensor& lhs_dht,
                       const DenseHostTensor& rhs_dht, DenseHostTensor* dest_dht,
-                      bool transpose_a, bool transpose_b) {
+                      bool transpose_a, bool transpose_b,
+                      const ExecutionContext& exec_ctx) {
   DHTIndexableView<T, 2> lhs(&lhs_dht);
   DHTIndexableView<T, 2> rhs(&rhs_dht);
   MutableDHTIndexableView<T, 2> dest(dest_dht);
 
   MatMul2DKernel<T>(/*alpha=*/static_cast<T>(1), lhs, rhs,
-                    /*beta=*/static_cast<T>(0), dest, transpose_a, transpose_b);
+                    /*beta=*/static_cast<T>(0), dest, transpose_a, transpose_b,
+                    exec_ctx);
 }
 
 // This is the MatMul kernel interface.
@@ -204,14 +473,51 @@ void CallMatMulKernel(const DenseHostTensor& lhs_dht,
 template <typename T>
 Expected<Chain> MatMul2D(T alpha, DHTIndexableView<T, 2> A,
                          DHTIndexableView<T, 2> B, T beta,
-                         MutableDHTIndexableView<T, 2> C) {
+                         MutableDHTIndexableView<T, 2> C,
+                         const ExecutionContext& exec_ctx) {
   // TODO(rmlarsen): Add support for transposition and conjugation.
   bool transpose_a = false;
   bool transpose_b = false;
-  MatMul2DKernel<T>(alpha, A, B, beta, C, transpose_a, transpose_b);
+  MatMul2DKernel<T>(alpha, A, B, beta, C, transpose_a, transpose_b, exec_ctx);
   return Chain();
 }
 
+//===----------------------------------------------------------------------===//
+// CPU sparse-dense matmul (SpMM) kernels
+//===----------------------------------------------------------------------===//
+
+// Computes C[row_begin:row_end, :] = A[row_begin:row_end, :] @ B, where A is
+// a sparse matrix in CSR layout given by row_offsets, col_indices and values
+// (see CsrHostTensor), and B and C are dense row-major matrices.
+//
+// The loops are ordered so that for every stored element of A the inner loop
+// runs over one contiguous row of B and of C, which the compiler can
+// vectorize; iterating over the stored elements of one row of C in the inner
+// loop instead would gather from strided locations of B.
+//
+// Taking a row range rather than the whole matrix lets callers parallelize
+// over row blocks: blocks write disjoint rows of C, so they need no
+// synchronization.
+template <typename T>
+void SparseDenseMatMul2DKernel(ArrayRef<int64_t> row_offsets,
+                               ArrayRef<int64_t> col_indices,
+                               ArrayRef<T> values, DHTIndexableView<T, 2> B,
+                               MutableDHTIndexableView<T, 2> C,
+                               size_t row_begin, size_t row_end) {
+  const size_t cols = C.FixedShape()[1];
+  const T* b_data = B.data();
+  T* c_data = C.data();
+  for (size_t i = row_begin; i < row_end; ++i) {
+    T* c_row = c_data + i * cols;
+    std::fill(c_row, c_row + cols, static_cast<T>(0));
+    for (int64_t p = row_offsets[i], e = row_offsets[i + 1]; p < e; ++p) {
+      const T a_value = values[p];
+      const T* b_row = b_data + col_indices[p] * cols;
+      for (size_t j = 0; j < cols; ++j) c_row[j] += a_value * b_row[j];
+    }
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // CPU Relu kernels
 //===----------------------------------------------------------------------===//
@@ -225,6 +531,87 @@ static AsyncValueRef<Chain> Relu(const DenseHostTensor& A, DenseHostTensor* B,
                                                      exec_ctx);
 }
 
+//===----------------------------------------------------------------------===//
+// CPU quantization kernels
+//===----------------------------------------------------------------------===//
+
+// Quantizes the float tensor `A` into the int8 tensor `B` with the affine
+// mapping B = clamp(round(A / scale) + zero_point, -128, 127).
+inline AsyncValueRef<Chain> Quantize(const DenseHostTensor& A, float scale,
+                                     int32_t zero_point, DenseHostTensor* B,
+                                     const ExecutionContext& exec_ctx) {
+  auto fn = [inv_scale = 1.0f / scale,
+             zero_point = static_cast<float>(zero_point)](auto& a, auto& b) {
+    return ((a * inv_scale).round() + zero_point)
+        .cwiseMin(127.0f)
+        .cwiseMax(-128.0f)
+        .template cast<int8_t>();
+  };
+  return ::tfrt::compat::UnaryEigenKernelAsync<float, int8_t>(
+      A, B, std::move(fn), exec_ctx);
+}
+
+// Dequantizes the int8 tensor `A` into the float tensor `B`:
+// B = (A - zero_point) * scale.
+inline AsyncValueRef<Chain> Dequantize(const DenseHostTensor& A, float scale,
+                                       int32_t zero_point, DenseHostTensor* B,
+                                       const ExecutionContext& exec_ctx) {
+  auto fn = [scale, zero_point = static_cast<float>(zero_point)](auto& a,
+                                                                 auto& b) {
+    return (a.template cast<float>() - zero_point) * scale;
+  };
+  return ::tfrt::compat::UnaryEigenKernelAsync<int8_t, float>(
+      A, B, std::move(fn), exec_ctx);
+}
+
+// Computes C = dequantize(A @ B) for int8 operands: the operands are
+// contracted with int32 accumulation, and the per-output-channel `scales`
+// (the product of the activation and weight scales for each column of C)
+// requantize the accumulators back to float inside the same fused Eigen
+// expression, so the int32 intermediate is never materialized.
+//
+// `zero_point` is the zero point of the activations `A`. The weights `B`
+// must be symmetrically quantized (zero point 0), which is how weight
+// quantizers produce them and what lets the contraction skip a per-element
+// correction on the weight side.
+//
+// The contraction runs through the Eigen contraction layer. The MKL-DNN
+// kernel in compat/eigen/contraction_kernel.h currently accelerates floats
+// only, so int8/int32 contractions use the generic Eigen kernels; a
+// VNNI-based int8 kernel can be slotted in there via GemmKernelProvider
+// without changing this code.
+inline AsyncValueRef<Chain> QuantizedMatMul2D(
+    const DenseHostTensor& lhs, const DenseHostTensor& rhs,
+    const DenseHostTensor& scales, int32_t zero_point, DenseHostTensor* dest,
+    const ExecutionContext& exec_ctx) {
+  DHTIndexableView<int8_t, 2> a(&lhs);
+  DHTIndexableView<int8_t, 2> b(&rhs);
+  DHTArrayView<float> scales_view(&scales);
+  MutableDHTIndexableView<float, 2> c(dest);
+  const auto& shape_c = c.FixedShape();
+
+  auto a_t = compat::AsEigenConstTensor(a);
+  auto b_t = compat::AsEigenConstTensor(b);
+  auto scales_t = compat::AsEigenConstTensor(scales_view);
+  auto c_t = compat::AsEigenTensor(c);
+
+  Eigen::array<Eigen::IndexPair<Eigen::Index>, 1> contraction{
+      Eigen::IndexPair<Eigen::Index>(1, 0)};
+  Eigen::array<Eigen::Index, 2> reshape_dims{1, shape_c[1]};
+  Eigen::array<Eigen::Index, 2> broadcast_dims{shape_c[0], 1};
+
+  auto a_i32 = a_t.cast<int32_t>();
+  auto acc =
+      (a_i32 - a_i32.constant(zero_point)).contract(b_t.cast<int32_t>(),
+                                                    contraction);
+  auto expr = acc.cast<float>() *
+              scales_t.reshape(reshape_dims).broadcast(broadcast_dims);
+  return compat::AsyncAssign(
+      exec_ctx.host()->GetOrCreateSharedContext<compat::EigenHostContext>(),
+      std::move(c_t), std::move(expr),
+      compat::KeepBuffers::alive(&lhs, &rhs, &scales, dest));
+}
+
 }  // namespace cpu
 }  // namespace tfrt
 
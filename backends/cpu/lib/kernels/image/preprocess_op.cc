@@ -0,0 +1,133 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- preprocess_op.cc ---------------------------------------------------===//
+//
+// This file implements the fused image preprocessing function.
+//
+//===----------------------------------------------------------------------===//
+
+#include "preprocess_op.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "llvm/ADT/SmallVector.h"
+
+namespace tfrt {
+namespace image {
+namespace {
+
+// Same 1-D interpolation cache as resize_bilinear_op.cc, with the source
+// coordinate offset and clamped to a crop window instead of the full image.
+struct CachedInterpolation {
+  ssize_t lower;  // Lower source index used in the interpolation
+  ssize_t upper;  // Upper source index used in the interpolation
+  float lerp;
+};
+
+void compute_crop_interpolation_weights(const ssize_t out_size,
+                                        const ssize_t crop_begin,
+                                        const ssize_t crop_size,
+                                        CachedInterpolation* interpolation) {
+  const float scale = crop_size / static_cast<float>(out_size);
+  for (ssize_t i = 0; i < out_size; ++i) {
+    const float in = static_cast<float>(i) * scale;
+    const float in_f = std::floor(in);
+    interpolation[i].lower =
+        crop_begin + std::max(static_cast<ssize_t>(in_f), ssize_t(0));
+    interpolation[i].upper =
+        crop_begin +
+        std::min(static_cast<ssize_t>(std::ceil(in)), crop_size - 1);
+    interpolation[i].lerp = in - in_f;
+  }
+}
+
+float compute_lerp(const float top_left, const float top_right,
+                   const float bottom_left, const float bottom_right,
+                   const float x_lerp, const float y_lerp) {
+  const float top = top_left + (top_right - top_left) * x_lerp;
+  const float bottom = bottom_left + (bottom_right - bottom_left) * x_lerp;
+  return top + (bottom - top) * y_lerp;
+}
+
+}  // namespace
+
+void preprocess_image(const uint8_t* input, ssize_t in_height,
+                      ssize_t in_width, ssize_t channels, ssize_t crop_x,
+                      ssize_t crop_y, ssize_t crop_width, ssize_t crop_height,
+                      ArrayRef<float> mean, ArrayRef<float> std,
+                      ssize_t out_height, ssize_t out_width, float* output) {
+  assert(crop_x >= 0 && crop_y >= 0 && crop_width > 0 && crop_height > 0);
+  assert(crop_x + crop_width <= in_width);
+  assert(crop_y + crop_height <= in_height);
+  assert(mean.size() == static_cast<size_t>(channels));
+  assert(std.size() == static_cast<size_t>(channels));
+  (void)in_height;
+
+  std::vector<CachedInterpolation> ys(out_height);
+  std::vector<CachedInterpolation> xs(out_width);
+  compute_crop_interpolation_weights(out_height, crop_y, crop_height,
+                                     ys.data());
+  compute_crop_interpolation_weights(out_width, crop_x, crop_width,
+                                     xs.data());
+
+  // Scale x interpolation indices to element offsets within a row.
+  for (ssize_t i = 0; i < out_width; ++i) {
+    xs[i].lower *= channels;
+    xs[i].upper *= channels;
+  }
+
+  // Fold (value - mean) / std into value * scale + bias, one fused
+  // multiply-add after the interpolation.
+  llvm::SmallVector<float, 4> scale;
+  llvm::SmallVector<float, 4> bias;
+  for (ssize_t c = 0; c < channels; ++c) {
+    scale.push_back(1.0f / std[c]);
+    bias.push_back(-mean[c] / std[c]);
+  }
+
+  const ssize_t in_row_size = in_width * channels;
+  float* output_y_ptr = output;
+
+  for (ssize_t y = 0; y < out_height; ++y) {
+    const uint8_t* ys_input_lower_ptr = input + ys[y].lower * in_row_size;
+    const uint8_t* ys_input_upper_ptr = input + ys[y].upper * in_row_size;
+    const float ys_lerp = ys[y].lerp;
+    for (ssize_t x = 0; x < out_width; ++x) {
+      const ssize_t xs_lower = xs[x].lower;
+      const ssize_t xs_upper = xs[x].upper;
+      const float xs_lerp = xs[x].lerp;
+
+      // The channel loop body is four loads, the bilinear lerp, and one
+      // multiply-add; for the common 3-channel images the compiler fully
+      // unrolls and vectorizes it.
+      for (ssize_t c = 0; c < channels; ++c) {
+        const float top_left(ys_input_lower_ptr[xs_lower + c]);
+        const float top_right(ys_input_lower_ptr[xs_upper + c]);
+        const float bottom_left(ys_input_upper_ptr[xs_lower + c]);
+        const float bottom_right(ys_input_upper_ptr[xs_upper + c]);
+        const float value = compute_lerp(top_left, top_right, bottom_left,
+                                         bottom_right, xs_lerp, ys_lerp);
+        output_y_ptr[x * channels + c] = value * scale[c] + bias[c];
+      }
+    }
+    output_y_ptr += out_width * channels;
+  }
+}
+
+}  // namespace image
+}  // namespace tfrt
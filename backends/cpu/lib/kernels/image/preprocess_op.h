@@ -0,0 +1,54 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- preprocess_op.h ------------------------------------------*- C++ -*-===//
+//
+// This file declares the fused image preprocessing function: crop, bilinear
+// resize and per-channel normalize in one pass.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_BACKENDS_CPU_LIB_KERNELS_IMAGE_PREPROCESS_OP_H_
+#define TFRT_BACKENDS_CPU_LIB_KERNELS_IMAGE_PREPROCESS_OP_H_
+
+#include <cstdint>
+
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+namespace image {
+
+// Crops, bilinearly resizes, and normalizes one decoded HWC uint8 image into
+// HWC float in a single pass over the input. `input` points to an
+// [in_height, in_width, channels] uint8 image; `output` receives
+// [out_height, out_width, channels] floats. The crop window
+// [crop_x, crop_y, crop_width, crop_height] must lie inside the input, and
+// the resize samples only inside it.
+//
+// The per-channel normalization (value - mean[c]) / std[c] is linear, so it
+// folds into the interpolation result as a single multiply-add instead of an
+// extra pass over the output. `mean` and `std` must each have `channels`
+// elements.
+void preprocess_image(const uint8_t* input, ssize_t in_height,
+                      ssize_t in_width, ssize_t channels, ssize_t crop_x,
+                      ssize_t crop_y, ssize_t crop_width, ssize_t crop_height,
+                      ArrayRef<float> mean, ArrayRef<float> std,
+                      ssize_t out_height, ssize_t out_width, float* output);
+
+}  // namespace image
+}  // namespace tfrt
+
+#endif  // TFRT_BACKENDS_CPU_LIB_KERNELS_IMAGE_PREPROCESS_OP_H_
@@ -27,7 +27,7 @@ namespace image {
 
 void RegisterImageKernels(KernelRegistry* registry);
 
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterImageKernels);
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterImageKernels, "image");
 
 }  // namespace image
 }  // namespace tfrt
@@ -27,7 +27,7 @@ namespace proto {
 
 void RegisterProtoKernels(KernelRegistry* registry);
 
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterProtoKernels);
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterProtoKernels, "proto");
 
 }  // namespace proto
 }  // namespace tfrt
@@ -22,9 +22,55 @@
 #include "tfrt/host_context/kernel_registry.h"
 #include "tfrt/host_context/kernel_utils.h"
 #include "tfrt/tensor/btf_reader_util.h"
+#include "tfrt/tensor/btf_streaming_reader.h"
+#include "tfrt/tensor/btf_writer.h"
 
 namespace tfrt {
 
+//===----------------------------------------------------------------------===//
+// Mapped readers
+//===----------------------------------------------------------------------===//
+
+namespace {
+// Like ReadTensorFromBTF, but reads through BtfStreamingReader: the returned
+// tensor aliases the memory mapped file instead of copying its data and must
+// be treated as read-only.
+template <typename DType, size_t Rank>
+AsyncValueRef<DenseHostTensor> ReadDenseTensorViewFromBTF(std::string path,
+                                                          int32_t index,
+                                                          HostContext* host) {
+  return host->EnqueueBlockingWork(
+      [path = std::move(path), index, host]() -> Expected<DenseHostTensor> {
+        auto reader = BtfStreamingReader::Open(path);
+        if (!reader) return reader.takeError();
+        auto dht = reader->ReadDenseTensor(index, host);
+        if (!dht) return dht.takeError();
+        if (dht->dtype() != GetDType<DType>()) {
+          return MakeStringError("unexpected tensor dtype ", dht->dtype());
+        }
+        if (dht->shape().GetRank() != Rank) {
+          return MakeStringError("unexpected tensor rank ",
+                                 dht->shape().GetRank(), ". Expected rank is ",
+                                 Rank);
+        }
+        return std::move(*dht);
+      });
+}
+
+// Writes all argument tensors, in order, into a BTF file at `path`.
+void WriteDenseTensorsToBTF(Argument<std::string> path, Argument<Chain> chain,
+                            RemainingArguments tensors, Result<Chain> out,
+                            KernelFrame* frame) {
+  std::vector<DenseHostTensor> dhts;
+  dhts.reserve(tensors.size());
+  for (AsyncValue* tensor : tensors.values()) {
+    dhts.push_back(tensor->get<DenseHostTensor>().CopyRef());
+  }
+  out.Set(
+      WriteTensorsToBTF(std::move(dhts), *path, frame->GetHostContext()));
+}
+}  // namespace
+
 //===----------------------------------------------------------------------===//
 // Registration
 //===----------------------------------------------------------------------===//
@@ -59,6 +105,18 @@ void RegisterDenseTensorReaders(KernelRegistry* registry) {
       TFRT_KERNEL(
           ReadTensorFromBTF<ParseDenseHostTensorTraits<uint8_t, Rank>>));
 }
+
+template <size_t Rank>
+void RegisterDenseTensorViewReaders(KernelRegistry* registry) {
+  registry->AddKernel("btf.read_dense_tensor_view.f32." + std::to_string(Rank),
+                      TFRT_KERNEL(ReadDenseTensorViewFromBTF<float, Rank>));
+  registry->AddKernel("btf.read_dense_tensor_view.i32." + std::to_string(Rank),
+                      TFRT_KERNEL(ReadDenseTensorViewFromBTF<int32_t, Rank>));
+  registry->AddKernel("btf.read_dense_tensor_view.i8." + std::to_string(Rank),
+                      TFRT_KERNEL(ReadDenseTensorViewFromBTF<int8_t, Rank>));
+  registry->AddKernel("btf.read_dense_tensor_view.ui8." + std::to_string(Rank),
+                      TFRT_KERNEL(ReadDenseTensorViewFromBTF<uint8_t, Rank>));
+}
 }  // namespace
 
 void RegisterBTFIOKernels(KernelRegistry* registry) {
@@ -67,6 +125,13 @@ void RegisterBTFIOKernels(KernelRegistry* registry) {
   RegisterDenseTensorReaders<2>(registry);
   RegisterDenseTensorReaders<3>(registry);
   RegisterDenseTensorReaders<4>(registry);
+  RegisterDenseTensorViewReaders<0>(registry);
+  RegisterDenseTensorViewReaders<1>(registry);
+  RegisterDenseTensorViewReaders<2>(registry);
+  RegisterDenseTensorViewReaders<3>(registry);
+  RegisterDenseTensorViewReaders<4>(registry);
+  registry->AddKernel("btf.write_dense_tensors",
+                      TFRT_KERNEL(WriteDenseTensorsToBTF));
 }
 
 }  // namespace tfrt
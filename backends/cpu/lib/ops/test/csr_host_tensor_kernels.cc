@@ -0,0 +1,84 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- csr_host_tensor_kernels.cc -----------------------------------------===//
+//
+// This file implements kernels for handling CSR host tensors.
+//
+//===----------------------------------------------------------------------===//
+
+#include "../../kernels/cpu_kernels.h"
+#include "tfrt/cpu/ops/test/cpu_ops_and_kernels.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/kernel_registry.h"
+#include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/host_context/parallel_for.h"
+#include "tfrt/tensor/csr_host_tensor.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/tensor/dense_host_tensor_view.h"
+
+namespace tfrt {
+
+// Computes c = a @ b, where a is a CsrHostTensor and b and c are rank-2
+// DenseHostTensors. The multiplication is parallelized over blocks of rows of
+// c via ParallelFor; blocks write disjoint rows, so they run without
+// synchronization.
+template <typename T>
+static void CsrMatMul(Argument<CsrHostTensor> a, Argument<DenseHostTensor> b,
+                      Argument<DenseHostTensor> c, Argument<Chain> chain_in,
+                      Result<Chain> chain_out, KernelErrorHandler handler,
+                      KernelFrame* frame) {
+  const ssize_t rows = a->shape().GetDimensionSize(0);
+  const ssize_t inner_dim = a->shape().GetDimensionSize(1);
+  if (b->shape().GetRank() != 2 || c->shape().GetRank() != 2 ||
+      b->shape().GetDimensionSize(0) != inner_dim ||
+      c->shape().GetDimensionSize(0) != rows ||
+      c->shape().GetDimensionSize(1) != b->shape().GetDimensionSize(1)) {
+    handler.ReportError("csr_matmul arguments have incompatible shapes");
+    return;
+  }
+
+  HostContext* host = frame->GetHostContext();
+  auto chain = host->MakeUnconstructedAsyncValueRef<Chain>();
+
+  // The captured DenseHostTensor copies share the underlying buffers of the
+  // arguments and keep them alive until the last block completes.
+  auto compute = [row_offsets = a->RowOffsets()->CopyRef(),
+                  col_indices = a->ColIndices()->CopyRef(),
+                  values = a->Values()->CopyRef(), b = b->CopyRef(),
+                  c = c->CopyRef()](size_t row_begin, size_t row_end) mutable {
+    cpu::SparseDenseMatMul2DKernel<T>(
+        DHTArrayView<int64_t>(&row_offsets).Elements(),
+        DHTArrayView<int64_t>(&col_indices).Elements(),
+        DHTArrayView<T>(&values).Elements(), DHTIndexableView<T, 2>(&b),
+        MutableDHTIndexableView<T, 2>(&c), row_begin, row_end);
+  };
+
+  // A single row is usually too little work to be worth a task, so ask for
+  // blocks of at least 16 rows.
+  ParallelFor(host).Execute(
+      rows, ParallelFor::BlockSizes::Min(16), std::move(compute),
+      [chain = chain.CopyRef()]() mutable { chain.emplace(); });
+
+  chain_out.Set(std::move(chain));
+}
+
+void RegisterCsrKernels(KernelRegistry* registry) {
+  registry->AddKernel("tfrt_test.csr_matmul.f32.2",
+                      TFRT_KERNEL(CsrMatMul<float>));
+  registry->AddKernel("tfrt_test.csr_matmul.i32.2",
+                      TFRT_KERNEL(CsrMatMul<int32_t>));
+}
+
+}  // namespace tfrt
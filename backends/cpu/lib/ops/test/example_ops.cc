@@ -118,6 +118,28 @@ static AsyncValueRef<HostTensor> TestAddOp(const HostTensor& lhs,
   }
 }
 
+//===----------------------------------------------------------------------===//
+// test.multiply op
+//===----------------------------------------------------------------------===//
+
+// This implements the test.multiply op. Like test.add it is scalar-aware:
+// ScalarHostTensor operands are read from a register rather than being
+// broadcast into a dense tensor first.
+//
+static AsyncValueRef<HostTensor> TestMultiplyOp(const HostTensor& lhs,
+                                                const HostTensor& rhs,
+                                                HostContext* host) {
+  switch (lhs.dtype().kind()) {
+    default:
+      assert(0 && "shape function failure");
+      return {};
+#define DTYPE_TRIVIAL(ENUM) \
+  case DType::ENUM:         \
+    return cpu::Multiply<TypeForDTypeKind<DType::ENUM>>(lhs, rhs, host);
+#include "tfrt/tensor/dtype.def"
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // test.add.denseonly op
 //===----------------------------------------------------------------------===//
@@ -289,6 +311,8 @@ void RegisterTestCpuOps(CpuOpRegistry* op_registry) {
                      CpuOpFlags::NoSideEffects, {"value"});
   op_registry->AddOp("tfrt_test.add", TFRT_CPU_OP(TestAddOp),
                      CpuOpFlags::NoSideEffects | CpuOpFlags::AllowsScalar);
+  op_registry->AddOp("tfrt_test.multiply", TFRT_CPU_OP(TestMultiplyOp),
+                     CpuOpFlags::NoSideEffects | CpuOpFlags::AllowsScalar);
   op_registry->AddOp("tfrt_test.add.denseonly", TFRT_CPU_OP(TestAddDenseOnlyOp),
                      CpuOpFlags::NoSideEffects);
   op_registry->AddOp("tfrt_test.add.denseonly2",
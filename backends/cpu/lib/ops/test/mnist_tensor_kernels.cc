@@ -18,8 +18,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <memory>
+#include <vector>
 
 #include "../../kernels/cpu_kernels.h"
 #include "tfrt/common/compat/eigen/eigen_dtype.h"
@@ -32,6 +35,8 @@
 #include "tfrt/host_context/async_value_ref.h"
 #include "tfrt/host_context/chain.h"
 #include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/host_context/parallel_for.h"
+#include "tfrt/support/string_util.h"
 #include "tfrt/tensor/btf.h"
 #include "tfrt/tensor/dense_host_tensor_view.h"
 
@@ -41,6 +46,7 @@ using ::tfrt::compat::BinaryEigenKernelAsync;
 using ::tfrt::compat::EigenHostContext;
 using ::tfrt::compat::KeepBuffers;
 using ::tfrt::compat::NullaryEigenKernelAsync;
+using ::tfrt::compat::SyncAssign;
 using ::tfrt::compat::UnaryEigenKernelAsync;
 
 namespace tfrt {
@@ -72,10 +78,10 @@ static void MatMulOp(const DenseHostTensor& lhs, const DenseHostTensor& rhs,
     default:
       *dest = EmitErrorAsync(exec_ctx, "unsupported dtype for matmul");
       return;
-#define DTYPE_TRIVIAL(ENUM)                                \
-  case DType::ENUM:                                        \
-    cpu::CallMatMulKernel<TypeForDTypeKind<DType::ENUM>>(  \
-        lhs, rhs, &dest_tensor, transpose_a, transpose_b); \
+#define DTYPE_TRIVIAL(ENUM)                                          \
+  case DType::ENUM:                                                  \
+    cpu::CallMatMulKernel<TypeForDTypeKind<DType::ENUM>>(            \
+        lhs, rhs, &dest_tensor, transpose_a, transpose_b, exec_ctx); \
     break;
 #include "tfrt/tensor/dtype.def"
   }
@@ -331,7 +337,8 @@ static void CastOp(const DenseHostTensor& A, const TensorMetadata& B_md,
 // to broadcast the 1-D channel mean vector to the shape of an image of NCHW
 // format.
 template <typename T, int N>
-void Broadcast1DKernel(const DenseHostTensor& A, DenseHostTensor* B) {
+void Broadcast1DKernel(const DenseHostTensor& A, DenseHostTensor* B,
+                       HostContext* host) {
   assert(A.shape().GetRank() == 1 && "only 1-D tensor is supported");
   DHTIndexableView<T, 1> A_view(&A);
   MutableDHTIndexableView<T, N> B_view(B);
@@ -350,7 +357,13 @@ void Broadcast1DKernel(const DenseHostTensor& A, DenseHostTensor* B) {
 
   auto in = AsEigenConstTensor(A_view);
   auto out = AsEigenTensor(B_view);
-  out = in.reshape(reshape_dims).broadcast(broadcast_dims);
+  auto expr = in.reshape(reshape_dims).broadcast(broadcast_dims);
+  if (B->NumElements() < cpu::kParallelElementwiseMinElements) {
+    out = expr;
+  } else {
+    SyncAssign(host->GetOrCreateSharedContext<EigenHostContext>(),
+               std::move(out), std::move(expr));
+  }
 }
 
 // Returns tf.broadcast_to(A, target_shape)
@@ -376,7 +389,7 @@ static Expected<DenseHostTensor> Broadcast1D(const DenseHostTensor& A,
   if (!tensor.hasValue())
     return MakeStringError("cannot allocate result tensor");
 
-  Broadcast1DKernel<T, N>(A, tensor.getPointer());
+  Broadcast1DKernel<T, N>(A, tensor.getPointer(), host);
 
   return std::move(*tensor);
 }
@@ -402,10 +415,10 @@ static void Broadcast1DOp(const DenseHostTensor& src,
     default:
       *dest = EmitErrorAsync(exec_ctx, "unsupported dtype for broadcast");
       return;
-#define DTYPE_NUMERIC(ENUM)                                                 \
-  case DType::ENUM:                                                         \
-    Broadcast1DKernel<EigenTypeForDTypeKind<DType::ENUM>, 2>(src,           \
-                                                             &dest_tensor); \
+#define DTYPE_NUMERIC(ENUM)                                   \
+  case DType::ENUM:                                           \
+    Broadcast1DKernel<EigenTypeForDTypeKind<DType::ENUM>, 2>( \
+        src, &dest_tensor, host);                             \
     break;
 #include "tfrt/tensor/dtype.def"
   }
@@ -420,13 +433,21 @@ static void Broadcast1DOp(const DenseHostTensor& src,
 // Take argmax along axis = Axis.
 // Argmax result tensor must be int32, not float.
 template <typename T, size_t Rank, size_t Axis>
-static void ArgmaxKernel(const DenseHostTensor& A, DenseHostTensor* B) {
+static void ArgmaxKernel(const DenseHostTensor& A, DenseHostTensor* B,
+                         HostContext* host) {
   DHTIndexableView<T, Rank> A_view(&A);
   MutableDHTIndexableView<int32_t, Rank - 1> B_view(B);
 
   auto in = AsEigenConstTensor(A_view);
   auto out = AsEigenTensor(B_view);
-  out = in.argmax(Axis).template cast<int32_t>();
+  auto expr = in.argmax(Axis).template cast<int32_t>();
+  // The work is proportional to the input size, not the (reduced) output.
+  if (A.NumElements() < cpu::kParallelElementwiseMinElements) {
+    out = expr;
+  } else {
+    SyncAssign(host->GetOrCreateSharedContext<EigenHostContext>(),
+               std::move(out), std::move(expr));
+  }
 }
 
 template <typename T, size_t Rank, size_t Axis = 1>
@@ -450,31 +471,34 @@ static Expected<DenseHostTensor> Argmax(const DenseHostTensor& A,
     return MakeStringError("Cannot allocate result tensor.");
   }
 
-  ArgmaxKernel<T, Rank, Axis>(A, tensor.getPointer());
+  ArgmaxKernel<T, Rank, Axis>(A, tensor.getPointer(), host);
 
   return std::move(*tensor);
 }
 
 template <size_t Rank, size_t Axis>
-static void ArgmaxForAxisRank(const DenseHostTensor& A, DenseHostTensor* B) {
+static void ArgmaxForAxisRank(const DenseHostTensor& A, DenseHostTensor* B,
+                              HostContext* host) {
   switch (A.dtype().kind()) {
     default:
       assert(0 && "shape function mismatch");
-#define DTYPE_NUMERIC(ENUM)                                             \
-  case DType::ENUM:                                                     \
-    ArgmaxKernel<EigenTypeForDTypeKind<DType::ENUM>, Rank, Axis>(A, B); \
+#define DTYPE_NUMERIC(ENUM)                                         \
+  case DType::ENUM:                                                 \
+    ArgmaxKernel<EigenTypeForDTypeKind<DType::ENUM>, Rank, Axis>(   \
+        A, B, host);                                                \
     break;
 #include "tfrt/tensor/dtype.def"
   }
 }
 
 template <size_t Axis>
-static void ArgmaxForAxis(const DenseHostTensor& A, DenseHostTensor* B) {
+static void ArgmaxForAxis(const DenseHostTensor& A, DenseHostTensor* B,
+                          HostContext* host) {
   switch (A.shape().GetRank()) {
     case Axis + 1:
-      return ArgmaxForAxisRank<Axis + 1, Axis>(A, B);
+      return ArgmaxForAxisRank<Axis + 1, Axis>(A, B, host);
     case Axis + 2:
-      return ArgmaxForAxisRank<Axis + 2, Axis>(A, B);
+      return ArgmaxForAxisRank<Axis + 2, Axis>(A, B, host);
     default:
       assert(0 && "shape function mismatch");
   }
@@ -496,7 +520,7 @@ static void ArgmaxOp(const DenseHostTensor& src, const OpAttrsRef& attrs,
 
   switch (attrs.GetAsserting<int32_t>("axis")) {
     case 1:
-      ArgmaxForAxis<1>(src, &dest_tensor);
+      ArgmaxForAxis<1>(src, &dest_tensor, host);
       break;
     default:
       *dest = EmitErrorAsync(exec_ctx, "unsupported axis for argmax");
@@ -507,19 +531,159 @@ static void ArgmaxOp(const DenseHostTensor& src, const OpAttrsRef& attrs,
       host->MakeAvailableAsyncValueRef<DenseHostTensor>(std::move(dest_tensor));
 }
 
+//===----------------------------------------------------------------------===//
+// mnist.top_k op and kernels
+//===----------------------------------------------------------------------===//
+
+// A surviving element of a block-local top-k scan. Only candidates reach the
+// serial merge, so the merge cost is num_blocks * k rather than the input
+// size.
+template <typename T>
+struct TopKCandidate {
+  T value;
+  int32_t index;
+};
+
+// Overwrites candidates[0, k) with the k largest elements of
+// input[begin, end), maintained as a min-heap keyed on value. An element only
+// touches the heap when it beats the smallest surviving candidate, so the
+// common case is a single compare per element. Ranges shorter than k pad with
+// sentinels that lose every merge comparison.
+template <typename T>
+static void TopKBlockScan(const T* input, size_t begin, size_t end, size_t k,
+                          TopKCandidate<T>* candidates) {
+  const auto min_heap_order = [](const TopKCandidate<T>& a,
+                                 const TopKCandidate<T>& b) {
+    return a.value > b.value;
+  };
+
+  const size_t fill = std::min(k, end - begin);
+  for (size_t i = 0; i < fill; ++i)
+    candidates[i] = {input[begin + i], static_cast<int32_t>(begin + i)};
+  for (size_t i = fill; i < k; ++i)
+    candidates[i] = {std::numeric_limits<T>::lowest(),
+                     std::numeric_limits<int32_t>::max()};
+  std::make_heap(candidates, candidates + k, min_heap_order);
+
+  for (size_t i = begin + fill; i < end; ++i) {
+    if (input[i] <= candidates[0].value) continue;
+    std::pop_heap(candidates, candidates + k, min_heap_order);
+    candidates[k - 1] = {input[i], static_cast<int32_t>(i)};
+    std::push_heap(candidates, candidates + k, min_heap_order);
+  }
+}
+
+// Top-k over a rank-1 input: block-local scans produce up to k candidates
+// each in parallel, and a serial merge over the candidates selects the final
+// k values and their indices, ordered by descending value with ties broken
+// towards the lower index.
+static void TopKOp(const DenseHostTensor& input, const OpAttrsRef& attrs,
+                   const TensorMetadata& values_md,
+                   const TensorMetadata& indices_md,
+                   RCReference<AsyncValue>* values,
+                   RCReference<AsyncValue>* indices,
+                   const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+
+  if (input.dtype().kind() != DType::F32) {
+    *values = EmitErrorAsync(exec_ctx, "unsupported dtype for top_k");
+    *indices = values->CopyRef();
+    return;
+  }
+
+  auto values_alloc = DenseHostTensor::CreateUninitialized(values_md, host);
+  auto indices_alloc = DenseHostTensor::CreateUninitialized(indices_md, host);
+  if (!values_alloc || !indices_alloc) {
+    *values = EmitErrorAsync(exec_ctx, "out of memory allocating result");
+    *indices = values->CopyRef();
+    return;
+  }
+
+  const size_t k = attrs.GetAsserting<int32_t>("k");
+  const size_t n = input.NumElements();
+
+  if (k == 0) {
+    *values = host->MakeAvailableAsyncValueRef<DenseHostTensor>(
+        std::move(values_alloc.getValue()));
+    *indices = host->MakeAvailableAsyncValueRef<DenseHostTensor>(
+        std::move(indices_alloc.getValue()));
+    return;
+  }
+
+  // Size blocks so that each one is worth a task and contributes a full
+  // complement of k candidates. Below the threshold a serial scan beats any
+  // task scheduling overhead.
+  static constexpr size_t kMinParallelTopKElements = 16 * 1024;
+  size_t num_blocks = std::min<size_t>(
+      4 * static_cast<size_t>(host->GetNumWorkerThreads()), n / k);
+  if (n < kMinParallelTopKElements || num_blocks == 0) num_blocks = 1;
+  const size_t block_size = (n + num_blocks - 1) / num_blocks;
+  num_blocks = (n + block_size - 1) / block_size;
+
+  const auto* in = static_cast<const float*>(input.data());
+  auto candidates =
+      std::make_unique<std::vector<TopKCandidate<float>>>(num_blocks * k);
+
+  auto values_av = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+  auto indices_av = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+  *values = values_av.CopyRCRef();
+  *indices = indices_av.CopyRCRef();
+
+  auto* candidate_data = candidates->data();
+  ParallelFor(host).Execute(
+      n, ParallelFor::BlockSizes::Fixed(block_size),
+      [in, k, block_size, candidate_data](size_t begin, size_t end) {
+        TopKBlockScan(in, begin, end, k,
+                      candidate_data + (begin / block_size) * k);
+      },
+      [candidates = std::move(candidates), k,
+       values_tensor = std::move(values_alloc.getValue()),
+       indices_tensor = std::move(indices_alloc.getValue()),
+       values_av = std::move(values_av), indices_av = std::move(indices_av),
+       keep = KeepBuffers::alive(&input)]() mutable {
+        // Orders by descending value, breaking ties towards the lower index;
+        // this also sorts the short-block padding sentinels last.
+        const auto better = [](const TopKCandidate<float>& a,
+                               const TopKCandidate<float>& b) {
+          if (a.value != b.value) return a.value > b.value;
+          return a.index < b.index;
+        };
+        std::partial_sort(candidates->begin(), candidates->begin() + k,
+                          candidates->end(), better);
+
+        auto* out_values = static_cast<float*>(values_tensor.data());
+        auto* out_indices = static_cast<int32_t*>(indices_tensor.data());
+        for (size_t i = 0; i < k; ++i) {
+          out_values[i] = (*candidates)[i].value;
+          out_indices[i] = (*candidates)[i].index;
+        }
+
+        values_av.emplace(std::move(values_tensor));
+        indices_av.emplace(std::move(indices_tensor));
+      });
+}
+
 //===----------------------------------------------------------------------===//
 // mnist.reduce_mean op and kernels
 //===----------------------------------------------------------------------===//
 
 template <typename T, size_t Rank, size_t Axis>
-static void ReduceMeanKernel(const DenseHostTensor& A, DenseHostTensor* B) {
+static void ReduceMeanKernel(const DenseHostTensor& A, DenseHostTensor* B,
+                             HostContext* host) {
   DHTIndexableView<T, Rank> A_view(&A);
   MutableDHTIndexableView<T, Rank - 1> B_view(B);
 
   Eigen::IndexList<Eigen::type2index<Axis>> reduction_dims;
   auto in = AsEigenConstTensor(A_view);
   auto out = AsEigenTensor(B_view);
-  out = in.mean(reduction_dims);
+  auto expr = in.mean(reduction_dims);
+  // The work is proportional to the input size, not the (reduced) output.
+  if (A.NumElements() < cpu::kParallelElementwiseMinElements) {
+    out = expr;
+  } else {
+    SyncAssign(host->GetOrCreateSharedContext<EigenHostContext>(),
+               std::move(out), std::move(expr));
+  }
 }
 
 template <typename T, size_t Rank, size_t Axis = 0>
@@ -542,32 +706,33 @@ static Expected<DenseHostTensor> ReduceMean(const DenseHostTensor& A,
   if (!tensor.hasValue())
     return MakeStringError("cannot allocate result tensor");
 
-  ReduceMeanKernel<T, Rank, Axis>(A, tensor.getPointer());
+  ReduceMeanKernel<T, Rank, Axis>(A, tensor.getPointer(), host);
 
   return std::move(*tensor);
 }
 
 template <size_t Rank, size_t Axis>
-static void ReduceMeanForAxisRank(const DenseHostTensor& A,
-                                  DenseHostTensor* B) {
+static void ReduceMeanForAxisRank(const DenseHostTensor& A, DenseHostTensor* B,
+                                  HostContext* host) {
   switch (A.dtype().kind()) {
     default:
       assert(0 && "shape function mismatch");
 #define DTYPE_NUMERIC(ENUM)                                                  \
   case DType::ENUM:                                                          \
     return ReduceMeanKernel<EigenTypeForDTypeKind<DType::ENUM>, Rank, Axis>( \
-        A, B);
+        A, B, host);
 #include "tfrt/tensor/dtype.def"
   }
 }
 
 template <size_t Axis>
-static void ReduceMeanForAxis(const DenseHostTensor& A, DenseHostTensor* B) {
+static void ReduceMeanForAxis(const DenseHostTensor& A, DenseHostTensor* B,
+                              HostContext* host) {
   switch (A.shape().GetRank()) {
     case Axis + 1:
-      return ReduceMeanForAxisRank<Axis + 1, Axis>(A, B);
+      return ReduceMeanForAxisRank<Axis + 1, Axis>(A, B, host);
     case Axis + 2:
-      return ReduceMeanForAxisRank<Axis + 2, Axis>(A, B);
+      return ReduceMeanForAxisRank<Axis + 2, Axis>(A, B, host);
     default:
       assert(0 && "shape function mismatch");
   }
@@ -589,7 +754,7 @@ static void ReduceMeanOp(const DenseHostTensor& src, const OpAttrsRef& attrs,
 
   switch (attrs.GetAsserting<int32_t>("axis")) {
     case 0:
-      ReduceMeanForAxis<0>(src, &dest_tensor);
+      ReduceMeanForAxis<0>(src, &dest_tensor, host);
       break;
     default:
       *dest = EmitErrorAsync(exec_ctx, "unsupported axis for reduce_mean");
@@ -600,6 +765,154 @@ static void ReduceMeanOp(const DenseHostTensor& src, const OpAttrsRef& attrs,
       host->MakeAvailableAsyncValueRef<DenseHostTensor>(std::move(dest_tensor));
 }
 
+//===----------------------------------------------------------------------===//
+// tfrt_test.sum/max/mean full reduction kernels
+//===----------------------------------------------------------------------===//
+
+// Reduces all elements of `A` into the single-element tensor `output`.
+// `reduce_block` reduces one contiguous block of elements to a partial value,
+// the partial values are combined in a tree by `combine` on the worker
+// threads, and `finalize` maps the combined value and the element count to
+// the stored result (used by mean to divide by the count).
+template <typename T, typename BlockFn, typename CombineFn, typename FinalizeFn>
+static AsyncValueRef<Chain> FullReduction(Argument<DenseHostTensor> A,
+                                          Argument<DenseHostTensor> output,
+                                          BlockFn reduce_block,
+                                          CombineFn combine,
+                                          FinalizeFn finalize,
+                                          const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+  if (output->NumElements() != 1) {
+    return EmitErrorAsync(exec_ctx, "reduction output must have one element");
+  }
+  DHTArrayView<T> A_view(&A.get());
+  if (A_view.NumElements() == 0) {
+    return EmitErrorAsync(exec_ctx, "cannot reduce an empty tensor");
+  }
+  const T* data = A_view.Elements().data();
+  const size_t num_elements = A_view.NumElements();
+
+  auto reduced = ParallelFor(host).Reduce<T>(
+      num_elements,
+      ParallelFor::BlockSizes::Min(cpu::kParallelReduceMinBlockSize),
+      [data, reduce_block](size_t begin, size_t end) -> T {
+        return reduce_block(data + begin, data + end);
+      },
+      [combine](T a, T b) -> T { return combine(a, b); });
+
+  auto out_chain = host->MakeUnconstructedAsyncValueRef<Chain>();
+  auto* reduced_av = reduced.GetAsyncValue();
+  reduced_av->AndThen([reduced = std::move(reduced),
+                       out_chain = out_chain.CopyRef(), a_ref = A.ValueRef(),
+                       output_ref = output.ValueRef(), finalize,
+                       num_elements]() mutable {
+    if (reduced.IsError()) {
+      out_chain.SetError(reduced.GetError());
+      return;
+    }
+    MutableDHTArrayView<T> out_view(&output_ref.get());
+    out_view.Elements()[0] = finalize(reduced.get(), num_elements);
+    out_chain.emplace();
+  });
+  return out_chain;
+}
+
+// Computes output = sum of all elements of A.
+template <typename T>
+static AsyncValueRef<Chain> Sum(Argument<DenseHostTensor> A,
+                                Argument<DenseHostTensor> output,
+                                Argument<Chain> chain_in,
+                                const ExecutionContext& exec_ctx) {
+  return FullReduction<T>(
+      A, output,
+      [](const T* begin, const T* end) { return cpu::SumRange(begin, end); },
+      [](T a, T b) { return a + b; }, [](T value, size_t) { return value; },
+      exec_ctx);
+}
+
+// Computes output = maximum of all elements of A.
+template <typename T>
+static AsyncValueRef<Chain> Max(Argument<DenseHostTensor> A,
+                                Argument<DenseHostTensor> output,
+                                Argument<Chain> chain_in,
+                                const ExecutionContext& exec_ctx) {
+  return FullReduction<T>(
+      A, output,
+      [](const T* begin, const T* end) { return cpu::MaxRange(begin, end); },
+      [](T a, T b) { return std::max(a, b); },
+      [](T value, size_t) { return value; }, exec_ctx);
+}
+
+// Computes output = mean of all elements of A. For integer element types the
+// mean truncates like integer division.
+template <typename T>
+static AsyncValueRef<Chain> Mean(Argument<DenseHostTensor> A,
+                                 Argument<DenseHostTensor> output,
+                                 Argument<Chain> chain_in,
+                                 const ExecutionContext& exec_ctx) {
+  return FullReduction<T>(
+      A, output,
+      [](const T* begin, const T* end) { return cpu::SumRange(begin, end); },
+      [](T a, T b) { return a + b; },
+      [](T value, size_t n) { return value / static_cast<T>(n); }, exec_ctx);
+}
+
+//===----------------------------------------------------------------------===//
+// tfrt_test quantization kernels
+//===----------------------------------------------------------------------===//
+
+// Computes B = quantize(A): int8 affine quantization of a float tensor.
+static AsyncValueRef<Chain> QuantizeKernel(Argument<DenseHostTensor> A,
+                                           Argument<DenseHostTensor> B,
+                                           Argument<Chain> chain_in,
+                                           Attribute<float> scale,
+                                           Attribute<int32_t> zero_point,
+                                           const ExecutionContext& exec_ctx) {
+  if (*scale == 0.0f) {
+    return EmitErrorAsync(exec_ctx, "quantize scale must be non-zero");
+  }
+  return cpu::Quantize(A.get(), *scale, *zero_point, &B.get(), exec_ctx);
+}
+
+// Computes B = dequantize(A): maps an int8 tensor back to float.
+static AsyncValueRef<Chain> DequantizeKernel(Argument<DenseHostTensor> A,
+                                             Argument<DenseHostTensor> B,
+                                             Argument<Chain> chain_in,
+                                             Attribute<float> scale,
+                                             Attribute<int32_t> zero_point,
+                                             const ExecutionContext& exec_ctx) {
+  return cpu::Dequantize(A.get(), *scale, *zero_point, &B.get(), exec_ctx);
+}
+
+// Computes C = dequantize(A @ B) for int8 A and B with int32 accumulation.
+// `scales` holds one combined scale per output channel (column of C), and
+// `zero_point` is the zero point of the activations A; the weights B must be
+// symmetrically quantized.
+static AsyncValueRef<Chain> QuantizedMatMulKernel(
+    Argument<DenseHostTensor> A, Argument<DenseHostTensor> B,
+    Argument<DenseHostTensor> scales, Argument<DenseHostTensor> C,
+    Argument<Chain> chain_in, Attribute<int32_t> zero_point,
+    const ExecutionContext& exec_ctx) {
+  const TensorShape& shape_a = A->shape();
+  const TensorShape& shape_b = B->shape();
+  const TensorShape& shape_c = C->shape();
+  if (shape_a.GetRank() != 2 || shape_b.GetRank() != 2 ||
+      shape_c.GetRank() != 2 ||
+      shape_a.GetDimensionSize(1) != shape_b.GetDimensionSize(0) ||
+      shape_c.GetDimensionSize(0) != shape_a.GetDimensionSize(0) ||
+      shape_c.GetDimensionSize(1) != shape_b.GetDimensionSize(1)) {
+    return EmitErrorAsync(
+        exec_ctx, StrCat("quantized matmul shape mismatch: ", shape_a, " @ ",
+                         shape_b, " -> ", shape_c));
+  }
+  if (scales->NumElements() != shape_c.GetDimensionSize(1)) {
+    return EmitErrorAsync(
+        exec_ctx, "quantized matmul needs one scale per output channel");
+  }
+  return cpu::QuantizedMatMul2D(A.get(), B.get(), scales.get(), *zero_point,
+                                &C.get(), exec_ctx);
+}
+
 //===----------------------------------------------------------------------===//
 // mnist.create_dense_tensor op and kernels
 //===----------------------------------------------------------------------===//
@@ -724,6 +1037,9 @@ static void RegisterMNISTTensorKernelsForType(KernelRegistry* registry,
                       TFRT_KERNEL(Broadcast1D<T, 3>));
   registry->AddKernel("tfrt_test.reduce_mean." + suffix + ".1",
                       TFRT_KERNEL(ReduceMean<T, 1>));
+  registry->AddKernel("tfrt_test.sum." + suffix, TFRT_KERNEL(Sum<T>));
+  registry->AddKernel("tfrt_test.max." + suffix, TFRT_KERNEL(Max<T>));
+  registry->AddKernel("tfrt_test.mean." + suffix, TFRT_KERNEL(Mean<T>));
   registry->AddKernel("tfrt_test.argmax." + suffix + ".2",
                       TFRT_KERNEL(Argmax<T, 2>));
   registry->AddKernel("tfrt_test.relu_grad_inplace." + suffix,
@@ -737,6 +1053,12 @@ void RegisterMNISTTensorKernels(KernelRegistry* registry) {
   RegisterMNISTTensorKernelsForType<int32_t>(registry, "i32");
   registry->AddKernel("tfrt_test.cast.i32_to_f32",
                       TFRT_KERNEL(Cast<int32_t, float>));
+  registry->AddKernel("tfrt_test.quantize.f32_to_i8",
+                      TFRT_KERNEL(QuantizeKernel));
+  registry->AddKernel("tfrt_test.dequantize.i8_to_f32",
+                      TFRT_KERNEL(DequantizeKernel));
+  registry->AddKernel("tfrt_test.quantized_matmul.i8",
+                      TFRT_KERNEL(QuantizedMatMulKernel));
 }
 
 void RegisterTestMnistCpuOps(CpuOpRegistry* op_registry) {
@@ -752,6 +1074,8 @@ void RegisterTestMnistCpuOps(CpuOpRegistry* op_registry) {
                      CpuOpFlags::NoSideEffects);
   op_registry->AddOp("tfrt_test.argmax", TFRT_CPU_OP(ArgmaxOp),
                      CpuOpFlags::NoSideEffects, {"axis"});
+  op_registry->AddOp("tfrt_test.top_k", TFRT_CPU_OP(TopKOp),
+                     CpuOpFlags::NoSideEffects, {"k"});
   op_registry->AddOp("tfrt_test.reduce_mean", TFRT_CPU_OP(ReduceMeanOp),
                      CpuOpFlags::NoSideEffects, {"axis"});
   op_registry->AddOp("tfrt_test.create_dense_tensor",
@@ -20,12 +20,19 @@
 
 #include <cmath>
 
+#include "../../kernels/cpu_kernels.h"
 #include "tfrt/common/compat/eigen/eigen_kernel.h"
 #include "tfrt/cpu/ops/test/cpu_ops_and_kernels.h"
 #include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/host_context/parallel_for.h"
 #include "tfrt/support/string_util.h"
 #include "tfrt/tensor/dense_host_tensor_view.h"
 
+using ::tfrt::compat::AsEigenConstTensor;
+using ::tfrt::compat::AsEigenTensor;
+using ::tfrt::compat::BinaryEigenKernelAsync;
+using ::tfrt::compat::EigenHostContext;
+using ::tfrt::compat::KeepBuffers;
 using ::tfrt::compat::UnaryEigenKernelAsync;
 
 namespace tfrt {
@@ -226,25 +233,67 @@ static void ZeroPadding(ArgumentView<MutableDHTIndexableView<T, 4>> input,
   chain_out.Set(chain_in);
 }
 
-static void SoftMaxInPlace(ArgumentView<MutableDHTArrayView<float>> A,
-                           Argument<Chain> in_chain, Result<Chain> out_chain,
-                           KernelErrorHandler handler, HostContext* host) {
-  float max_value = std::numeric_limits<float>::min();
-  for (const auto value : A->Elements()) {
-    max_value = std::max(max_value, value);
+// Computes softmax(A) in place: A = exp(A - max(A)) / sum(exp(A - max(A))).
+// Subtracting the maximum keeps exp() in range for large logits. Each of the
+// three passes - max reduction, exponentiation with sum reduction, and
+// normalization - runs in parallel over blocks of the input, with the two
+// reductions combining per-block partial results in a tree.
+static AsyncValueRef<Chain> SoftMaxInPlace(Argument<DenseHostTensor> A,
+                                           Argument<Chain> chain_in,
+                                           const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+  MutableDHTArrayView<float> A_view(&A.get());
+  if (A_view.NumElements() == 0) {
+    return EmitErrorAsync(exec_ctx, "cannot softmax an empty tensor");
   }
-
-  float sum = 0;
-  for (auto& value : A->Elements()) {
-    value = exp(value);
-    sum += value;
-  }
-
-  for (auto& value : A->Elements()) {
-    value /= sum;
-  }
-
-  out_chain.Set(in_chain);
+  float* data = A_view.Elements().data();
+  const size_t num_elements = A_view.NumElements();
+
+  auto block_sizes = []() {
+    return ParallelFor::BlockSizes::Min(cpu::kParallelReduceMinBlockSize);
+  };
+  auto out_chain = host->MakeUnconstructedAsyncValueRef<Chain>();
+
+  auto max = ParallelFor(host).Reduce<float>(
+      num_elements, block_sizes(),
+      [data](size_t begin, size_t end) {
+        return cpu::MaxRange(data + begin, data + end);
+      },
+      [](float a, float b) { return std::max(a, b); });
+
+  auto* max_av = max.GetAsyncValue();
+  max_av->AndThen([max = std::move(max), out_chain = out_chain.CopyRef(),
+                   a_ref = A.ValueRef(), data, num_elements, block_sizes,
+                   host]() mutable {
+    const float max_value = max.get();
+    auto sum = ParallelFor(host).Reduce<float>(
+        num_elements, block_sizes(),
+        [data, max_value](size_t begin, size_t end) {
+          float sum = 0;
+          for (size_t i = begin; i < end; ++i) {
+            data[i] = std::exp(data[i] - max_value);
+            sum += data[i];
+          }
+          return sum;
+        },
+        [](float a, float b) { return a + b; });
+
+    auto* sum_av = sum.GetAsyncValue();
+    sum_av->AndThen([sum = std::move(sum), out_chain = std::move(out_chain),
+                     a_ref = std::move(a_ref), data, num_elements, block_sizes,
+                     host]() mutable {
+      const float scale = 1.0f / sum.get();
+      ParallelFor(host).Execute(
+          num_elements, block_sizes(),
+          [data, scale](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) data[i] *= scale;
+          },
+          [out_chain = std::move(out_chain),
+           a_ref = std::move(a_ref)]() mutable { out_chain.emplace(); });
+    });
+  });
+
+  return out_chain;
 }
 
 // Computes output = output - gradient * lr.
@@ -274,6 +323,68 @@ static AsyncValueRef<Chain> ElementwiseSubtractInPlace(
                                      exec_ctx);
 }
 
+// Computes C = relu(A + B), the fused epilogue of a ResNet residual
+// connection. Fusing the add and the relu traverses the output once instead
+// of twice.
+template <typename T>
+static AsyncValueRef<Chain> AddRelu(const DenseHostTensor& A,
+                                    const DenseHostTensor& B,
+                                    // `C` supplies the output buffer
+                                    DenseHostTensor* C,
+                                    const ExecutionContext& exec_ctx) {
+  auto fn = [](auto& a, auto& b, auto& c) {
+    return (a + b).cwiseMax(static_cast<T>(0));
+  };
+  return BinaryEigenKernelAsync<DHTArrayView<T>, MutableDHTArrayView<T>>(
+      A, B, C, std::move(fn), exec_ctx);
+}
+
+// Computes B = relu(A + B).
+template <typename T>
+static AsyncValueRef<Chain> AddReluInPlace(Argument<DenseHostTensor> A,
+                                           Argument<DenseHostTensor> B,
+                                           const ExecutionContext& exec_ctx) {
+  auto fn = [](auto& a, auto& b) {
+    return (a + b).cwiseMax(static_cast<T>(0));
+  };
+  return UnaryEigenKernelAsync<T, T>(A.get(), &B.get(), std::move(fn),
+                                     exec_ctx);
+}
+
+// Computes output = relu(output + bias), broadcasting the rank-1 bias over
+// the channel (innermost) dimension of the rank-4 NHWC output.
+template <typename T>
+static AsyncValueRef<Chain> BiasAddReluInPlace(
+    Argument<DenseHostTensor> bias, Argument<DenseHostTensor> output,
+    const ExecutionContext& exec_ctx) {
+  DHTIndexableView<T, 1> bias_view(&bias.get());
+  MutableDHTIndexableView<T, 4> output_view(&output.get());
+  const auto& shape_bias = bias_view.FixedShape();
+  const auto& shape_output = output_view.FixedShape();
+
+  if (shape_bias[0] != shape_output[3]) {
+    return EmitErrorAsync(
+        exec_ctx, StrCat("BiasAddRelu bias shape ", shape_bias,
+                         " does not match the output channel dimension of ",
+                         shape_output));
+  }
+
+  Eigen::array<Eigen::Index, 4> reshape_dims{1, 1, 1, shape_bias[0]};
+  Eigen::array<Eigen::Index, 4> broadcast_dims{shape_output[0],
+                                               shape_output[1],
+                                               shape_output[2], 1};
+
+  auto bias_t = AsEigenConstTensor(bias_view);
+  auto output_t = AsEigenTensor(output_view);
+  auto expr =
+      (output_t + bias_t.reshape(reshape_dims).broadcast(broadcast_dims))
+          .cwiseMax(static_cast<T>(0));
+  return AsyncAssign(
+      exec_ctx.host()->GetOrCreateSharedContext<EigenHostContext>(),
+      std::move(output_t), std::move(expr),
+      KeepBuffers::alive(&bias.get(), &output.get()));
+}
+
 template <typename T>
 static void TensorTranspose(ArgumentView<MutableDHTIndexableView<T, 2>> input,
                             ArgumentView<MutableDHTIndexableView<T, 2>> output,
@@ -361,6 +472,11 @@ void RegisterResNetTensorKernels(KernelRegistry* registry) {
                       TFRT_KERNEL(GradientDescent));
   registry->AddKernel("tfrt_test.subtract_inplace.f32",
                       TFRT_KERNEL(ElementwiseSubtractInPlace<float>));
+  registry->AddKernel("tfrt_test.add_relu.f32", TFRT_KERNEL(AddRelu<float>));
+  registry->AddKernel("tfrt_test.add_relu_inplace.f32",
+                      TFRT_KERNEL(AddReluInPlace<float>));
+  registry->AddKernel("tfrt_test.bias_add_relu_inplace.f32",
+                      TFRT_KERNEL(BiasAddReluInPlace<float>));
   registry->AddKernel("tfrt_test.tensor_transpose.f32",
                       TFRT_KERNEL(TensorTranspose<float>));
   registry->AddKernel("tfrt_test.mean_axis_zero.f32",
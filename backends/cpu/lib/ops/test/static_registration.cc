@@ -31,6 +31,7 @@ namespace tfrt {
 static void RegisterKernels(KernelRegistry* registry) {
   RegisterBTFIOKernels(registry);
   RegisterCooKernels(registry);
+  RegisterCsrKernels(registry);
   RegisterMNISTTensorKernels(registry);
   RegisterResNetTensorKernels(registry);
 }
@@ -52,7 +53,7 @@ static void RegisterDispatchFn(CpuOpRegistry* registry) {
   RegisterTestCpuOps(registry);
 }
 
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterKernels);
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterKernels, "tfrt_test,btf");
 TFRT_STATIC_CPU_OP_REGISTRATION(RegisterMetadataFn);
 TFRT_STATIC_CPU_OP_REGISTRATION(RegisterDispatchFn);
 
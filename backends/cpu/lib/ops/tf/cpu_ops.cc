@@ -20,8 +20,20 @@
 
 #include "tfrt/cpu/ops/tf/cpu_ops.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
 #include "../../kernels/cpu_kernels.h"
+#include "backends/common/lib/compat/eigen/contraction_kernel.h"
+#include "backends/common/lib/compat/eigen/contraction_output_kernel.h"
+#include "backends/common/lib/compat/eigen/pooling.h"
 #include "tfrt/common/compat/eigen/eigen_dtype.h"
+#include "tfrt/common/compat/eigen/tensor_types.h"
+#include "tfrt/common/compat/eigen/thread_pool_device.h"
 #include "tfrt/common/ops/tf/metadata_functions.h"
 #include "tfrt/core_runtime/op_attrs.h"
 #include "tfrt/core_runtime/op_utils.h"
@@ -29,6 +41,7 @@
 #include "tfrt/host_context/async_value_ref.h"
 #include "tfrt/host_context/chain.h"
 #include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/host_context/parallel_for.h"
 #include "tfrt/tensor/dense_host_tensor.h"
 #include "tfrt/tensor/dense_host_tensor_view.h"
 #include "tfrt/tensor/tensor_serialize_utils.h"
@@ -76,6 +89,15 @@ static AsyncValueRef<HostTensor> TfAddOp(const HostTensor& lhs,
   }
 }
 
+// Specialized variant for all-f32 invocations, selected at dispatch by its
+// registered predicate; it reaches the typed kernel without the dtype
+// switch above.
+static AsyncValueRef<HostTensor> TfAddF32Op(const HostTensor& lhs,
+                                            const HostTensor& rhs,
+                                            HostContext* host) {
+  return cpu::Add<float>(lhs, rhs, host);
+}
+
 //===----------------------------------------------------------------------===//
 // tf.Matmul op
 //===----------------------------------------------------------------------===//
@@ -103,10 +125,10 @@ static void TfMatMulOp(const DenseHostTensor& lhs, const DenseHostTensor& rhs,
     default:
       *dest = EmitErrorAsync(exec_ctx, "unsupported dtype for matmul");
       return;
-#define DTYPE_NUMERIC(ENUM)                                    \
-  case DType::ENUM:                                            \
-    cpu::CallMatMulKernel<EigenTypeForDTypeKind<DType::ENUM>>( \
-        lhs, rhs, &dest_tensor, transpose_a, transpose_b);     \
+#define DTYPE_NUMERIC(ENUM)                                          \
+  case DType::ENUM:                                                  \
+    cpu::CallMatMulKernel<EigenTypeForDTypeKind<DType::ENUM>>(       \
+        lhs, rhs, &dest_tensor, transpose_a, transpose_b, exec_ctx); \
     break;
 #include "tfrt/tensor/dtype.def"  // NOLINT
   }
@@ -115,6 +137,154 @@ static void TfMatMulOp(const DenseHostTensor& lhs, const DenseHostTensor& rhs,
       host->MakeAvailableAsyncValueRef<DenseHostTensor>(std::move(dest_tensor));
 }
 
+//===----------------------------------------------------------------------===//
+// tf._FusedMatMul op
+//===----------------------------------------------------------------------===//
+
+// Evaluates a matmul as an Eigen contraction with `output_kernel` fused as
+// the contraction epilogue, so the epilogue runs on output blocks while they
+// are still resident in L1 cache instead of re-streaming the output tensor.
+template <typename OutputKernel, typename KeepAlive>
+static AsyncValueRef<Chain> FusedMatMul(const DenseHostTensor& lhs,
+                                        const DenseHostTensor& rhs,
+                                        DenseHostTensor* dest,
+                                        OutputKernel output_kernel,
+                                        bool transpose_a, bool transpose_b,
+                                        KeepAlive keep_alive,
+                                        const ExecutionContext& exec_ctx) {
+  auto lhs_t = compat::AsEigenConstTensor(DHTIndexableView<float, 2>(&lhs));
+  auto rhs_t = compat::AsEigenConstTensor(DHTIndexableView<float, 2>(&rhs));
+  auto dest_t = compat::AsEigenTensor(MutableDHTIndexableView<float, 2>(dest));
+
+  // Contracting over the transposed dimension of an operand computes
+  // op(A) @ op(B) without materializing the transpose.
+  Eigen::array<Eigen::IndexPair<Eigen::Index>, 1> contract_dim;
+  contract_dim[0] =
+      Eigen::IndexPair<Eigen::Index>(transpose_a ? 0 : 1, transpose_b ? 1 : 0);
+
+  auto expr = lhs_t.contract(rhs_t, contract_dim, std::move(output_kernel));
+
+  return compat::AsyncAssign(
+      exec_ctx.host()->GetOrCreateSharedContext<compat::EigenHostContext>(),
+      std::move(dest_t), std::move(expr), std::move(keep_alive));
+}
+
+// Computes matmul(a, b) with an epilogue fused into the contraction. The
+// epilogue is selected by the `fusion` attribute:
+//   "BiasAdd", "BiasAddRelu", "BiasAddRelu6", "BiasAddElu":
+//       one extra operand, the per-output-channel bias vector.
+//   "BiasAddLeakyRelu":
+//       as above, with the negative slope in the `leakyrelu_alpha` attribute.
+//   "ScaleAndShift":
+//       two extra operands, the per-output-channel scale and shift vectors of
+//       an inference-time folded batch normalization.
+static void TfFusedMatMulOp(const DenseHostTensor& lhs,
+                            const DenseHostTensor& rhs,
+                            RepeatedArguments<DenseHostTensor> fusion_inputs,
+                            const OpAttrsRef& attrs,
+                            const TensorMetadata& dest_md,
+                            RCReference<AsyncValue>* dest,
+                            const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+
+  if (lhs.dtype().kind() != DType::F32) {
+    *dest = EmitErrorAsync(exec_ctx, "tf._FusedMatMul supports only f32");
+    return;
+  }
+
+  auto dest_alloc = DenseHostTensor::CreateUninitialized(dest_md, host);
+  if (!dest_alloc) {
+    *dest = EmitErrorAsync(exec_ctx, "out of memory allocating result");
+    return;
+  }
+
+  auto& dest_tensor = dest_alloc.getValue();
+
+  // Handle attributes.
+  bool transpose_a = attrs.GetAsserting<bool>("transpose_a");
+  bool transpose_b = attrs.GetAsserting<bool>("transpose_b");
+  string_view fusion = attrs.GetStringAsserting("fusion");
+
+  AsyncValueRef<Chain> chain;
+
+  if (fusion == "ScaleAndShift") {
+    // Inference-time batch normalization folded to per-channel coefficients.
+    if (fusion_inputs.size() != 2) {
+      *dest = EmitErrorAsync(
+          exec_ctx, "ScaleAndShift fusion expects scale and shift operands");
+      return;
+    }
+    const DenseHostTensor& scale = fusion_inputs[0];
+    const DenseHostTensor& shift = fusion_inputs[1];
+
+    compat::ScaleAndShiftOutputKernel<float> output_kernel(
+        compat::AsEigenConstTensor(DHTArrayView<float>(&scale)),
+        compat::AsEigenConstTensor(DHTArrayView<float>(&shift)));
+    chain = FusedMatMul(
+        lhs, rhs, &dest_tensor, std::move(output_kernel), transpose_a,
+        transpose_b,
+        compat::KeepBuffers::alive(&lhs, &rhs, &scale, &shift, &dest_tensor),
+        exec_ctx);
+  } else {
+    // The remaining fusions are a bias add with an optional activation.
+    if (fusion_inputs.size() != 1) {
+      *dest = EmitErrorAsync(exec_ctx,
+                             "BiasAdd fusion expects a single bias operand");
+      return;
+    }
+    const DenseHostTensor& bias = fusion_inputs[0];
+    auto bias_t = compat::AsEigenConstTensor(DHTArrayView<float>(&bias));
+    auto keep_alive =
+        compat::KeepBuffers::alive(&lhs, &rhs, &bias, &dest_tensor);
+
+    if (fusion == "BiasAdd") {
+      chain = FusedMatMul(lhs, rhs, &dest_tensor,
+                          compat::BiasAddOutputKernel<float>(bias_t),
+                          transpose_a, transpose_b, std::move(keep_alive),
+                          exec_ctx);
+    } else if (fusion == "BiasAddRelu") {
+      chain = FusedMatMul(
+          lhs, rhs, &dest_tensor,
+          compat::BiasAddOutputKernel<float, compat::Relu>(bias_t), transpose_a,
+          transpose_b, std::move(keep_alive), exec_ctx);
+    } else if (fusion == "BiasAddRelu6") {
+      chain = FusedMatMul(
+          lhs, rhs, &dest_tensor,
+          compat::BiasAddOutputKernel<float, compat::Relu6>(bias_t),
+          transpose_a, transpose_b, std::move(keep_alive), exec_ctx);
+    } else if (fusion == "BiasAddLeakyRelu") {
+      float alpha = attrs.GetAsserting<float>("leakyrelu_alpha");
+      chain = FusedMatMul(
+          lhs, rhs, &dest_tensor,
+          compat::BiasAddLeakyReluOutputKernel<float>(bias_t, alpha),
+          transpose_a, transpose_b, std::move(keep_alive), exec_ctx);
+    } else if (fusion == "BiasAddElu") {
+      chain = FusedMatMul(
+          lhs, rhs, &dest_tensor,
+          compat::BiasAddOutputKernel<float, compat::Elu>(bias_t), transpose_a,
+          transpose_b, std::move(keep_alive), exec_ctx);
+    } else {
+      *dest = EmitErrorAsync(
+          exec_ctx, StrCat("tf._FusedMatMul unsupported fusion: ", fusion));
+      return;
+    }
+  }
+
+  // The result tensor becomes available when the contraction completes.
+  auto dest_av = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+  auto* chain_av = chain.GetAsyncValue();
+  chain_av->AndThen([dest_tensor = std::move(dest_tensor),
+                     chain = std::move(chain),
+                     dest_av = dest_av.CopyRef()]() mutable {
+    if (chain.IsError()) {
+      dest_av.SetError(chain.GetError());
+    } else {
+      dest_av.emplace(std::move(dest_tensor));
+    }
+  });
+  *dest = dest_av.ReleaseRCRef();
+}
+
 //===----------------------------------------------------------------------===//
 // tf.Relu op
 //===----------------------------------------------------------------------===//
@@ -156,6 +326,1259 @@ static AsyncValueRef<DenseHostTensor> TfReluOp(
   return B_tensor;
 }
 
+//===----------------------------------------------------------------------===//
+// tf.Gather and tf.ScatterAdd ops
+//===----------------------------------------------------------------------===//
+
+// Number of indices the gather/scatter loops look ahead of the row they are
+// working on. The lookups are a random access pattern over tables far larger
+// than any cache, so upcoming rows are prefetched while the current row
+// streams; at less distance the prefetch does not complete in time, at much
+// more it competes with the rows still being copied.
+static constexpr size_t kEmbeddingPrefetchDistance = 8;
+
+// Leading bytes of each upcoming row to prefetch. Long rows stream well once
+// their head is resident; prefetching whole rows would thrash the lines the
+// current row is using.
+static constexpr size_t kEmbeddingPrefetchBytes = 256;
+
+static constexpr size_t kCacheLineBytes = 64;
+
+// Prefetch the leading cache lines of the row at `row`. The write flag must
+// be a compile time constant for __builtin_prefetch.
+template <bool kForWrite>
+static void PrefetchRow(const char* row, size_t row_bytes) {
+#if defined(__GNUC__) || defined(__clang__)
+  const size_t bytes = std::min(row_bytes, kEmbeddingPrefetchBytes);
+  for (size_t offset = 0; offset < bytes; offset += kCacheLineBytes)
+    __builtin_prefetch(row + offset, kForWrite ? 1 : 0, /*locality=*/1);
+#else
+  (void)row;
+  (void)row_bytes;
+#endif
+}
+
+// Returns true iff every index is a valid row number for a table with
+// `table_rows` rows. Validated up front so the parallel blocks below can run
+// without a per-row error path.
+template <typename IndexT>
+static bool IndicesInRange(const IndexT* indices, size_t num_indices,
+                           ssize_t table_rows) {
+  for (size_t i = 0; i < num_indices; ++i)
+    if (indices[i] < 0 || indices[i] >= table_rows) return false;
+  return true;
+}
+
+// Copies table rows selected by `indices[begin, end)` into consecutive rows
+// of `dest`, prefetching the rows of upcoming indices.
+template <typename IndexT>
+static void GatherBlock(const float* table, const IndexT* indices, float* dest,
+                        size_t row_len, size_t begin, size_t end) {
+  const size_t row_bytes = row_len * sizeof(float);
+  for (size_t i = begin; i < end; ++i) {
+    if (i + kEmbeddingPrefetchDistance < end) {
+      const size_t ahead =
+          static_cast<size_t>(indices[i + kEmbeddingPrefetchDistance]);
+      PrefetchRow<false>(
+          reinterpret_cast<const char*>(table + ahead * row_len), row_bytes);
+    }
+    const size_t index = static_cast<size_t>(indices[i]);
+    std::memcpy(dest + i * row_len, table + index * row_len, row_bytes);
+  }
+}
+
+// Gathers rows of a rank-2 f32 table along axis 0, parallelized over index
+// ranges.
+template <typename IndexT>
+static AsyncValueRef<DenseHostTensor> TfGatherImpl(
+    const DenseHostTensor& params, const DenseHostTensor& indices,
+    const TensorMetadata& dest_md, const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+
+  auto dest_alloc = DenseHostTensor::CreateUninitialized(dest_md, host);
+  if (!dest_alloc)
+    return EmitErrorAsync(exec_ctx, "out of memory allocating result");
+  auto& dest_tensor = dest_alloc.getValue();
+
+  const ssize_t table_rows = params.shape().GetDimensionSize(0);
+  const size_t row_len = params.shape().GetDimensionSize(1);
+  const size_t num_indices = indices.NumElements();
+
+  const auto* table = static_cast<const float*>(params.data());
+  const auto* index_data = static_cast<const IndexT*>(indices.data());
+  auto* dest_data = static_cast<float*>(dest_tensor.data());
+
+  if (!IndicesInRange(index_data, num_indices, table_rows))
+    return EmitErrorAsync(exec_ctx, "tf.Gather index out of range");
+
+  auto dest_av = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+  ParallelFor(host).Execute(
+      num_indices, ParallelFor::BlockSizes::Min(256),
+      [table, index_data, dest_data, row_len](size_t begin, size_t end) {
+        GatherBlock(table, index_data, dest_data, row_len, begin, end);
+      },
+      [dest_av = dest_av.CopyRef(), dest_tensor = std::move(dest_tensor),
+       keep = compat::KeepBuffers::alive(&params, &indices)]() mutable {
+        dest_av.emplace(std::move(dest_tensor));
+      });
+  return dest_av;
+}
+
+static AsyncValueRef<DenseHostTensor> TfGatherOp(
+    const DenseHostTensor& params, const DenseHostTensor& indices,
+    const TensorMetadata& dest_md, const ExecutionContext& exec_ctx) {
+  if (params.dtype().kind() != DType::F32)
+    return EmitErrorAsync(exec_ctx, "tf.Gather supports only f32 tables");
+  switch (indices.dtype().kind()) {
+    case DType::I32:
+      return TfGatherImpl<int32_t>(params, indices, dest_md, exec_ctx);
+    case DType::I64:
+      return TfGatherImpl<int64_t>(params, indices, dest_md, exec_ctx);
+    default:
+      return EmitErrorAsync(exec_ctx, "tf.Gather indices must be i32 or i64");
+  }
+}
+
+// One scatter-add block owns the dest rows [row_begin, row_end): it copies
+// them from the table, then applies every update whose index falls into the
+// range. Each block scans the full index list, but an ownership test is a
+// compare per index while an update is a row of arithmetic, so the scan is
+// noise - and it makes the blocks race free with no atomics, since duplicate
+// indices land in the same block.
+template <typename IndexT>
+static void ScatterAddBlock(const float* table, const IndexT* indices,
+                            const float* updates, float* dest, size_t row_len,
+                            size_t num_indices, size_t row_begin,
+                            size_t row_end) {
+  const size_t row_bytes = row_len * sizeof(float);
+  std::memcpy(dest + row_begin * row_len, table + row_begin * row_len,
+              (row_end - row_begin) * row_bytes);
+
+  for (size_t i = 0; i < num_indices; ++i) {
+    if (i + kEmbeddingPrefetchDistance < num_indices) {
+      const size_t ahead =
+          static_cast<size_t>(indices[i + kEmbeddingPrefetchDistance]);
+      if (ahead >= row_begin && ahead < row_end)
+        PrefetchRow<true>(reinterpret_cast<char*>(dest + ahead * row_len),
+                          row_bytes);
+    }
+    const size_t index = static_cast<size_t>(indices[i]);
+    if (index < row_begin || index >= row_end) continue;
+    float* dest_row = dest + index * row_len;
+    const float* update_row = updates + i * row_len;
+    for (size_t k = 0; k < row_len; ++k) dest_row[k] += update_row[k];
+  }
+}
+
+// Functional scatter-add: the result is the table with `updates` rows added
+// at `indices`, parallelized over ranges of table rows.
+template <typename IndexT>
+static AsyncValueRef<DenseHostTensor> TfScatterAddImpl(
+    const DenseHostTensor& params, const DenseHostTensor& indices,
+    const DenseHostTensor& updates, const TensorMetadata& dest_md,
+    const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+
+  auto dest_alloc = DenseHostTensor::CreateUninitialized(dest_md, host);
+  if (!dest_alloc)
+    return EmitErrorAsync(exec_ctx, "out of memory allocating result");
+  auto& dest_tensor = dest_alloc.getValue();
+
+  const ssize_t table_rows = params.shape().GetDimensionSize(0);
+  const size_t row_len = params.shape().GetDimensionSize(1);
+  const size_t num_indices = indices.NumElements();
+
+  const auto* table = static_cast<const float*>(params.data());
+  const auto* index_data = static_cast<const IndexT*>(indices.data());
+  const auto* update_data = static_cast<const float*>(updates.data());
+  auto* dest_data = static_cast<float*>(dest_tensor.data());
+
+  if (!IndicesInRange(index_data, num_indices, table_rows))
+    return EmitErrorAsync(exec_ctx, "tf.ScatterAdd index out of range");
+
+  auto dest_av = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+  ParallelFor(host).Execute(
+      table_rows, ParallelFor::BlockSizes::Min(256),
+      [table, index_data, update_data, dest_data, row_len,
+       num_indices](size_t begin, size_t end) {
+        ScatterAddBlock(table, index_data, update_data, dest_data, row_len,
+                        num_indices, begin, end);
+      },
+      [dest_av = dest_av.CopyRef(), dest_tensor = std::move(dest_tensor),
+       keep = compat::KeepBuffers::alive(&params, &indices,
+                                         &updates)]() mutable {
+        dest_av.emplace(std::move(dest_tensor));
+      });
+  return dest_av;
+}
+
+static AsyncValueRef<DenseHostTensor> TfScatterAddOp(
+    const DenseHostTensor& params, const DenseHostTensor& indices,
+    const DenseHostTensor& updates, const TensorMetadata& dest_md,
+    const ExecutionContext& exec_ctx) {
+  if (params.dtype().kind() != DType::F32)
+    return EmitErrorAsync(exec_ctx, "tf.ScatterAdd supports only f32 tables");
+  switch (indices.dtype().kind()) {
+    case DType::I32:
+      return TfScatterAddImpl<int32_t>(params, indices, updates, dest_md,
+                                       exec_ctx);
+    case DType::I64:
+      return TfScatterAddImpl<int64_t>(params, indices, updates, dest_md,
+                                       exec_ctx);
+    default:
+      return EmitErrorAsync(exec_ctx,
+                            "tf.ScatterAdd indices must be i32 or i64");
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// tf.ConcatV2, tf.Split and tf.Pad ops
+//===----------------------------------------------------------------------===//
+
+// The tensor assembly ops below are byte copies once the destination layout
+// is known: the layout is computed up front and the copies are spread over
+// the work queue with ParallelFor, in blocks of at least this many bytes so
+// a task is always worth its scheduling overhead.
+static constexpr size_t kMinAssemblyBlockBytes = 1 << 20;
+
+// Byte-level layout shared by concat and split: along the concatenated axis,
+// every outer step of the packed tensor holds one row from each part, back
+// to back. part_offset is the prefix sum of the part row sizes, with a
+// trailing total, so a byte offset within a packed row maps to its part with
+// one binary search.
+struct PackedRowLayout {
+  size_t packed_row_bytes;
+  SmallVector<size_t, 8> part_offset;
+};
+
+// Copies the packed byte range [begin, end) between the packed tensor and
+// the per-part tensors; kPack gathers the parts into the packed tensor
+// (concat) and !kPack scatters it out to them (split). Ranges from different
+// blocks never overlap, so the blocks run concurrently without
+// synchronization.
+template <bool kPack>
+static void CopyPackedRange(char* packed, ArrayRef<char*> parts,
+                            const PackedRowLayout& layout, size_t begin,
+                            size_t end) {
+  size_t pos = begin;
+  while (pos < end) {
+    const size_t outer = pos / layout.packed_row_bytes;
+    const size_t row_pos = pos - outer * layout.packed_row_bytes;
+    const auto it = std::upper_bound(layout.part_offset.begin(),
+                                     layout.part_offset.end(), row_pos) -
+                    1;
+    const size_t part = it - layout.part_offset.begin();
+    const size_t part_row_bytes =
+        layout.part_offset[part + 1] - layout.part_offset[part];
+    const size_t within = row_pos - layout.part_offset[part];
+    const size_t len = std::min(end - pos, part_row_bytes - within);
+
+    char* packed_ptr = packed + pos;
+    char* part_ptr = parts[part] + outer * part_row_bytes + within;
+    if (kPack) {
+      std::memcpy(packed_ptr, part_ptr, len);
+    } else {
+      std::memcpy(part_ptr, packed_ptr, len);
+    }
+    pos += len;
+  }
+}
+
+// Concatenates the inputs along the axis attribute. The constant axis
+// operand is folded away by the compiler, hence the underscore-prefixed op
+// name (like _tf.Pad and _tf.Mean).
+static void TfConcatOp(RepeatedArguments<DenseHostTensor> inputs,
+                       const OpAttrsRef& attrs, const TensorMetadata& dest_md,
+                       RCReference<AsyncValue>* dest,
+                       const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+
+  auto dest_alloc = DenseHostTensor::CreateUninitialized(dest_md, host);
+  if (!dest_alloc) {
+    *dest = EmitErrorAsync(exec_ctx, "out of memory allocating result");
+    return;
+  }
+  auto& dest_tensor = dest_alloc.getValue();
+
+  const int rank = dest_md.shape.GetRank();
+  int32_t axis = attrs.GetAsserting<int32_t>("axis");
+  if (axis < 0) axis += rank;
+
+  const size_t elem_size = dest_md.dtype.GetHostSize();
+  size_t inner_bytes = elem_size;
+  for (int d = axis + 1; d < rank; ++d)
+    inner_bytes *= dest_md.shape.GetDimensionSize(d);
+
+  PackedRowLayout layout;
+  layout.part_offset.push_back(0);
+  SmallVector<char*, 8> parts;
+  SmallVector<RCReference<HostBuffer>, 8> keep_alive;
+  for (auto& input : inputs) {
+    const size_t row_bytes =
+        input.shape().GetDimensionSize(axis) * inner_bytes;
+    layout.part_offset.push_back(layout.part_offset.back() + row_bytes);
+    parts.push_back(const_cast<char*>(static_cast<const char*>(input.data())));
+    keep_alive.push_back(input.buffer().CopyRef());
+  }
+  layout.packed_row_bytes = layout.part_offset.back();
+
+  const size_t total_bytes = dest_md.GetHostSizeInBytes();
+  if (total_bytes == 0) {
+    *dest = host->MakeAvailableAsyncValueRef<DenseHostTensor>(
+        std::move(dest_tensor));
+    return;
+  }
+
+  auto* dest_data = static_cast<char*>(dest_tensor.data());
+  auto dest_av = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+  *dest = dest_av.CopyRCRef();
+
+  ParallelFor(host).Execute(
+      total_bytes, ParallelFor::BlockSizes::Min(kMinAssemblyBlockBytes),
+      [dest_data, parts = std::move(parts),
+       layout = std::move(layout)](size_t begin, size_t end) {
+        CopyPackedRange<true>(dest_data, parts, layout, begin, end);
+      },
+      [dest_av = std::move(dest_av), dest_tensor = std::move(dest_tensor),
+       keep_alive = std::move(keep_alive)]() mutable {
+        dest_av.emplace(std::move(dest_tensor));
+      });
+}
+
+// Splits the input into results.size() equal parts along the axis attribute.
+// This uses the raw dispatch signature because the number of results is not
+// fixed at compile time.
+static void TfSplitOp(const ExecutionContext& exec_ctx,
+                      ArrayRef<AsyncValue*> inputs, const OpAttrsRef& attrs,
+                      ArrayRef<TensorMetadata> result_mds,
+                      MutableArrayRef<RCReference<AsyncValue>> results,
+                      AsyncValueRef<Chain>* chain) {
+  auto* host = exec_ctx.host();
+  auto& input = inputs[0]->get<DenseHostTensor>();
+
+  auto emit_error = [&](string_view message) {
+    auto error = EmitErrorAsync(exec_ctx, message);
+    for (auto& result : results) result = error.CopyRef();
+  };
+
+  const int rank = input.shape().GetRank();
+  int32_t axis = attrs.GetAsserting<int32_t>("axis");
+  if (axis < 0) axis += rank;
+
+  const size_t elem_size = input.dtype().GetHostSize();
+  size_t inner_bytes = elem_size;
+  for (int d = axis + 1; d < rank; ++d)
+    inner_bytes *= input.shape().GetDimensionSize(d);
+
+  PackedRowLayout layout;
+  layout.part_offset.push_back(0);
+  SmallVector<char*, 8> parts;
+  std::vector<DenseHostTensor> part_tensors;
+  part_tensors.reserve(results.size());
+  for (const auto& result_md : result_mds) {
+    auto alloc = DenseHostTensor::CreateUninitialized(result_md, host);
+    if (!alloc) return emit_error("out of memory allocating result");
+    const size_t row_bytes =
+        result_md.shape.GetDimensionSize(axis) * inner_bytes;
+    layout.part_offset.push_back(layout.part_offset.back() + row_bytes);
+    parts.push_back(static_cast<char*>(alloc.getValue().data()));
+    part_tensors.push_back(std::move(alloc.getValue()));
+  }
+  layout.packed_row_bytes = layout.part_offset.back();
+
+  const size_t total_bytes = input.metadata().GetHostSizeInBytes();
+  if (total_bytes == 0) {
+    for (size_t i = 0; i < results.size(); ++i)
+      results[i] = host->MakeAvailableAsyncValueRef<DenseHostTensor>(
+          std::move(part_tensors[i]));
+    return;
+  }
+
+  SmallVector<AsyncValueRef<DenseHostTensor>, 8> result_avs;
+  for (auto& result : results) {
+    result_avs.push_back(
+        host->MakeUnconstructedAsyncValueRef<DenseHostTensor>());
+    result = result_avs.back().CopyRCRef();
+  }
+
+  auto* input_data =
+      const_cast<char*>(static_cast<const char*>(input.data()));
+  ParallelFor(host).Execute(
+      total_bytes, ParallelFor::BlockSizes::Min(kMinAssemblyBlockBytes),
+      [input_data, parts = std::move(parts),
+       layout = std::move(layout)](size_t begin, size_t end) {
+        CopyPackedRange<false>(input_data, parts, layout, begin, end);
+      },
+      [result_avs = std::move(result_avs),
+       part_tensors = std::move(part_tensors),
+       keep = input.buffer().CopyRef()]() mutable {
+        for (size_t i = 0; i < result_avs.size(); ++i)
+          result_avs[i].emplace(std::move(part_tensors[i]));
+      });
+}
+
+// Pads the input with zeros per the paddings attribute (folded from the
+// constant paddings operand). Trailing unpadded dimensions are contiguous in
+// both the input and the result, so they merge with the innermost padded
+// dimension into one copy run per outer coordinate.
+template <typename PadT>
+static AsyncValueRef<DenseHostTensor> TfPadImpl(
+    const DenseHostTensor& input, ArrayRef<PadT> paddings,
+    const TensorMetadata& dest_md, const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+
+  auto dest_alloc = DenseHostTensor::CreateUninitialized(dest_md, host);
+  if (!dest_alloc)
+    return EmitErrorAsync(exec_ctx, "out of memory allocating result");
+  auto& dest_tensor = dest_alloc.getValue();
+
+  const int rank = input.shape().GetRank();
+  const size_t elem_size = input.dtype().GetHostSize();
+
+  // The last dimension with any padding; everything inside it forms the
+  // contiguous copy run.
+  int last_padded = -1;
+  for (int d = 0; d < rank; ++d)
+    if (paddings[2 * d] != 0 || paddings[2 * d + 1] != 0) last_padded = d;
+
+  size_t run_bytes = elem_size;
+  for (int d = std::max(last_padded, 0); d < rank; ++d)
+    run_bytes *= input.shape().GetDimensionSize(d);
+
+  // Row-major strides of the destination, and the fixed offset contributed
+  // by the pad-before amounts, both in bytes.
+  SmallVector<size_t, 8> dest_stride(rank, elem_size);
+  for (int d = rank - 2; d >= 0; --d)
+    dest_stride[d] =
+        dest_stride[d + 1] * dest_md.shape.GetDimensionSize(d + 1);
+  size_t pad_offset_bytes = 0;
+  for (int d = 0; d < rank; ++d)
+    pad_offset_bytes += static_cast<size_t>(paddings[2 * d]) * dest_stride[d];
+
+  const int num_outer_dims = std::max(last_padded, 0);
+  size_t num_runs = 1;
+  for (int d = 0; d < num_outer_dims; ++d)
+    num_runs *= input.shape().GetDimensionSize(d);
+
+  const auto* input_data = static_cast<const char*>(input.data());
+  auto* dest_data = static_cast<char*>(dest_tensor.data());
+  const TensorShape& input_shape = input.shape();
+  SmallVector<size_t, 8> outer_stride(dest_stride.begin(),
+                                      dest_stride.begin() + num_outer_dims);
+
+  auto copy_runs = [input_data, dest_data, run_bytes, pad_offset_bytes,
+                    num_outer_dims, input_shape,
+                    outer_stride](size_t begin, size_t end) {
+    for (size_t run = begin; run < end; ++run) {
+      // Unravel the run index over the outer input dimensions to find the
+      // destination offset of this run.
+      size_t remaining = run;
+      size_t dest_offset = pad_offset_bytes;
+      for (int d = num_outer_dims - 1; d >= 0; --d) {
+        const size_t extent = input_shape.GetDimensionSize(d);
+        dest_offset += (remaining % extent) * outer_stride[d];
+        remaining /= extent;
+      }
+      std::memcpy(dest_data + dest_offset, input_data + run * run_bytes,
+                  run_bytes);
+    }
+  };
+
+  auto dest_av = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+
+  // Keep at least kMinAssemblyBlockBytes worth of runs per task.
+  const size_t min_runs_per_block = kMinAssemblyBlockBytes / run_bytes + 1;
+
+  if (last_padded == -1) {
+    // No padding at all: a plain parallel copy.
+    ParallelFor(host).Execute(
+        num_runs, ParallelFor::BlockSizes::Min(min_runs_per_block), copy_runs,
+        [dest_av = dest_av.CopyRef(), dest_tensor = std::move(dest_tensor),
+         keep = compat::KeepBuffers::alive(&input)]() mutable {
+          dest_av.emplace(std::move(dest_tensor));
+        });
+    return dest_av;
+  }
+
+  // Zero the whole destination in parallel first, then copy the interior
+  // runs in parallel. Re-zeroing the interior is cheaper than planning exact
+  // padding regions for every row, and the phases are serialized so the
+  // copies never race with the fill.
+  const size_t total_bytes = dest_md.GetHostSizeInBytes();
+  ParallelFor(host).Execute(
+      total_bytes, ParallelFor::BlockSizes::Min(kMinAssemblyBlockBytes),
+      [dest_data](size_t begin, size_t end) {
+        std::memset(dest_data + begin, 0, end - begin);
+      },
+      [host, num_runs, min_runs_per_block, copy_runs = std::move(copy_runs),
+       dest_av = dest_av.CopyRef(), dest_tensor = std::move(dest_tensor),
+       keep = compat::KeepBuffers::alive(&input)]() mutable {
+        ParallelFor(host).Execute(
+            num_runs, ParallelFor::BlockSizes::Min(min_runs_per_block),
+            std::move(copy_runs),
+            [dest_av = std::move(dest_av),
+             dest_tensor = std::move(dest_tensor),
+             keep = std::move(keep)]() mutable {
+              dest_av.emplace(std::move(dest_tensor));
+            });
+      });
+  return dest_av;
+}
+
+static AsyncValueRef<DenseHostTensor> TfPadOp(
+    const DenseHostTensor& input, const OpAttrsRef& attrs,
+    const TensorMetadata& dest_md, const ExecutionContext& exec_ctx) {
+  DenseAttr dense_attr = attrs.GetAsserting<DenseAttr>("paddings");
+  DenseView paddings = CreateDenseView(dense_attr);
+  switch (paddings.dtype().kind()) {
+    case DType::I32:
+      return TfPadImpl<int32_t>(input, paddings.GetFlat<int32_t>(), dest_md,
+                                exec_ctx);
+    case DType::I64:
+      return TfPadImpl<int64_t>(input, paddings.GetFlat<int64_t>(), dest_md,
+                                exec_ctx);
+    default:
+      return EmitErrorAsync(exec_ctx, "tf.Pad paddings must be i32 or i64");
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// tf.Transpose op
+//===----------------------------------------------------------------------===//
+
+// Tile edge for the blocked transpose path. A tile touches kTransposeTileDim
+// cache lines on the strided side, which stays within L1 for every element
+// size, and the contiguous side of the tile auto-vectorizes.
+static constexpr size_t kTransposeTileDim = 32;
+
+// Transposes the 2-D plane spanned by the output's innermost dimension (A,
+// contiguous in the destination) and the input's innermost dimension (B,
+// contiguous in the source), for the tile columns b_tile_begin to b_tile_end.
+// Walking the plane in square tiles keeps both the source rows and the
+// destination rows resident while they are reused, instead of streaming the
+// whole strided side through the cache once per row.
+template <typename T>
+static void TransposePlaneTiles(const T* src, T* dst, size_t src_a_stride,
+                                size_t dst_b_stride, size_t num_a,
+                                size_t num_b, size_t b_tile_begin,
+                                size_t b_tile_end) {
+  for (size_t bt = b_tile_begin; bt < b_tile_end; ++bt) {
+    const size_t b_begin = bt * kTransposeTileDim;
+    const size_t b_end = std::min(num_b, b_begin + kTransposeTileDim);
+    for (size_t a0 = 0; a0 < num_a; a0 += kTransposeTileDim) {
+      const size_t a_end = std::min(num_a, a0 + kTransposeTileDim);
+      for (size_t b = b_begin; b < b_end; ++b) {
+        // The inner loop stores contiguously and loads with a fixed stride,
+        // which the compiler turns into SIMD stores.
+        for (size_t a = a0; a < a_end; ++a) {
+          dst[b * dst_b_stride + a] = src[a * src_a_stride + b];
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+static AsyncValueRef<DenseHostTensor> TfTransposeImpl(
+    const DenseHostTensor& input, ArrayRef<ssize_t> perm,
+    const TensorMetadata& dest_md, const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+
+  auto dest_alloc = DenseHostTensor::CreateUninitialized(dest_md, host);
+  if (!dest_alloc)
+    return EmitErrorAsync(exec_ctx, "out of memory allocating result");
+  auto& dest_tensor = dest_alloc.getValue();
+
+  const int rank = perm.size();
+  SmallVector<size_t, 8> in_stride(rank, 1);
+  for (int d = rank - 2; d >= 0; --d)
+    in_stride[d] = in_stride[d + 1] * input.shape().GetDimensionSize(d + 1);
+  SmallVector<size_t, 8> out_stride(rank, 1);
+  SmallVector<size_t, 8> out_dims(rank);
+  for (int d = 0; d < rank; ++d)
+    out_dims[d] = dest_md.shape.GetDimensionSize(d);
+  for (int d = rank - 2; d >= 0; --d)
+    out_stride[d] = out_stride[d + 1] * out_dims[d + 1];
+
+  const auto* src = static_cast<const T*>(input.data());
+  auto* dst = static_cast<T*>(dest_tensor.data());
+  auto dest_av = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+  auto emplace_dest = [dest_av = dest_av.CopyRef(),
+                       dest_tensor = std::move(dest_tensor),
+                       keep = compat::KeepBuffers::alive(&input)]() mutable {
+    dest_av.emplace(std::move(dest_tensor));
+  };
+
+  if (input.NumElements() == 0) {
+    emplace_dest();
+    return dest_av;
+  }
+
+  if (perm[rank - 1] == rank - 1) {
+    // The innermost dimension is untouched, so every output row is a
+    // contiguous run of the input: a parallel strided row copy, no tiling
+    // needed.
+    const size_t row_elems = out_dims[rank - 1];
+    size_t num_rows = 1;
+    for (int d = 0; d < rank - 1; ++d) num_rows *= out_dims[d];
+    const size_t min_rows =
+        kMinAssemblyBlockBytes / (row_elems * sizeof(T)) + 1;
+
+    ParallelFor(host).Execute(
+        num_rows, ParallelFor::BlockSizes::Min(min_rows),
+        [src, dst, row_elems, rank, out_dims, in_stride,
+         perm = SmallVector<ssize_t, 8>(perm.begin(), perm.end())](
+            size_t begin, size_t end) {
+          for (size_t row = begin; row < end; ++row) {
+            size_t remaining = row;
+            size_t src_offset = 0;
+            for (int d = rank - 2; d >= 0; --d) {
+              src_offset += (remaining % out_dims[d]) * in_stride[perm[d]];
+              remaining /= out_dims[d];
+            }
+            std::memcpy(dst + row * row_elems, src + src_offset,
+                        row_elems * sizeof(T));
+          }
+        },
+        std::move(emplace_dest));
+    return dest_av;
+  }
+
+  // General case: the output's innermost dimension comes from input
+  // dimension p, and some output dimension q comes from the input's
+  // innermost dimension. Their plane is transposed in tiles; the remaining
+  // dimensions are the outer loop. Work items are (outer, tile column)
+  // pairs, so a 2-D transpose still fans out across the queue.
+  const int p = perm[rank - 1];
+  int q = 0;
+  while (perm[q] != rank - 1) ++q;
+
+  const size_t num_a = out_dims[rank - 1];
+  const size_t num_b = out_dims[q];
+  const size_t src_a_stride = in_stride[p];
+  const size_t dst_b_stride = out_stride[q];
+
+  SmallVector<int, 8> outer_dims;
+  for (int d = 0; d < rank - 1; ++d)
+    if (d != q) outer_dims.push_back(d);
+  size_t num_outer = 1;
+  for (int d : outer_dims) num_outer *= out_dims[d];
+
+  const size_t num_b_tiles =
+      (num_b + kTransposeTileDim - 1) / kTransposeTileDim;
+  const size_t tile_col_bytes = num_a * kTransposeTileDim * sizeof(T);
+  const size_t min_units = kMinAssemblyBlockBytes / tile_col_bytes + 1;
+
+  ParallelFor(host).Execute(
+      num_outer * num_b_tiles, ParallelFor::BlockSizes::Min(min_units),
+      [src, dst, src_a_stride, dst_b_stride, num_a, num_b, num_b_tiles,
+       out_dims, in_stride, out_stride, outer_dims,
+       perm = SmallVector<ssize_t, 8>(perm.begin(), perm.end())](
+          size_t begin, size_t end) {
+        for (size_t unit = begin; unit < end; ++unit) {
+          const size_t outer = unit / num_b_tiles;
+          const size_t b_tile = unit - outer * num_b_tiles;
+
+          size_t remaining = outer;
+          size_t src_base = 0;
+          size_t dst_base = 0;
+          for (int i = static_cast<int>(outer_dims.size()) - 1; i >= 0; --i) {
+            const int d = outer_dims[i];
+            const size_t coord = remaining % out_dims[d];
+            remaining /= out_dims[d];
+            src_base += coord * in_stride[perm[d]];
+            dst_base += coord * out_stride[d];
+          }
+
+          TransposePlaneTiles(src + src_base, dst + dst_base, src_a_stride,
+                              dst_b_stride, num_a, num_b, b_tile, b_tile + 1);
+        }
+      },
+      std::move(emplace_dest));
+  return dest_av;
+}
+
+// Transposes the input per the perm attribute (folded from the constant perm
+// operand). The tiling only moves bytes, so element types dispatch on size.
+static AsyncValueRef<DenseHostTensor> TfTransposeOp(
+    const DenseHostTensor& input, const OpAttrsRef& attrs,
+    const TensorMetadata& dest_md, const ExecutionContext& exec_ctx) {
+  DenseAttr perm_attr = attrs.GetAsserting<DenseAttr>("perm");
+  DenseView perm_view = CreateDenseView(perm_attr);
+
+  SmallVector<ssize_t, 8> perm;
+  switch (perm_view.dtype().kind()) {
+    case DType::I32: {
+      auto value = perm_view.GetFlat<int32_t>();
+      perm.assign(value.begin(), value.end());
+      break;
+    }
+    case DType::I64: {
+      auto value = perm_view.GetFlat<int64_t>();
+      perm.assign(value.begin(), value.end());
+      break;
+    }
+    default:
+      return EmitErrorAsync(exec_ctx, "tf.Transpose perm must be i32 or i64");
+  }
+
+  switch (input.dtype().GetHostSize()) {
+    case 1:
+      return TfTransposeImpl<uint8_t>(input, perm, dest_md, exec_ctx);
+    case 2:
+      return TfTransposeImpl<uint16_t>(input, perm, dest_md, exec_ctx);
+    case 4:
+      return TfTransposeImpl<uint32_t>(input, perm, dest_md, exec_ctx);
+    case 8:
+      return TfTransposeImpl<uint64_t>(input, perm, dest_md, exec_ctx);
+    default:
+      return EmitErrorAsync(exec_ctx,
+                            "unsupported element size for tf.Transpose");
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// tf.RandomUniform and tf.RandomStandardNormal ops
+//===----------------------------------------------------------------------===//
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel Random
+// Numbers: As Easy as 1, 2, 3"). Every 128-bit output block is a pure
+// function of (counter, key), so blocks of the output tensor are filled in
+// parallel by jumping the counter - no sequential generator state to split.
+static std::array<uint32_t, 4> Philox4x32(uint64_t counter, uint64_t key) {
+  uint32_t c0 = static_cast<uint32_t>(counter);
+  uint32_t c1 = static_cast<uint32_t>(counter >> 32);
+  uint32_t c2 = 0;
+  uint32_t c3 = 0;
+  uint32_t k0 = static_cast<uint32_t>(key);
+  uint32_t k1 = static_cast<uint32_t>(key >> 32);
+
+  for (int round = 0; round < 10; ++round) {
+    const uint64_t p0 = uint64_t{0xD2511F53} * c0;
+    const uint64_t p1 = uint64_t{0xCD9E8D57} * c2;
+    const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+    const uint32_t n1 = static_cast<uint32_t>(p1);
+    const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+    const uint32_t n3 = static_cast<uint32_t>(p0);
+    c0 = n0;
+    c1 = n1;
+    c2 = n2;
+    c3 = n3;
+    k0 += 0x9E3779B9;  // Round keys advance by the golden ratio constants.
+    k1 += 0xBB67AE85;
+  }
+  return {{c0, c1, c2, c3}};
+}
+
+// Maps 23 random mantissa bits onto [1, 2) and shifts down to [0, 1).
+static float PhiloxUint32ToFloat(uint32_t x) {
+  const uint32_t bits = (x >> 9) | 0x3f800000u;
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result - 1.0f;
+}
+
+// Fills data[begin, end) with uniform [0, 1) or standard normal floats.
+// Element i belongs to counter block i / 4; a block straddling two
+// ParallelFor ranges is generated by both, and each writes only its own
+// disjoint elements.
+template <bool kNormal>
+static void FillPhiloxBlock(float* data, size_t begin, size_t end,
+                            uint64_t key) {
+  const size_t group_begin = begin / 4;
+  const size_t group_end = (end + 3) / 4;
+  for (size_t group = group_begin; group < group_end; ++group) {
+    const auto bits = Philox4x32(group, key);
+    float values[4];
+    if (kNormal) {
+      // Box-Muller on two pairs of uniforms; 1 - u moves the log argument
+      // to (0, 1].
+      for (int pair = 0; pair < 2; ++pair) {
+        const float u0 = 1.0f - PhiloxUint32ToFloat(bits[2 * pair]);
+        const float u1 = PhiloxUint32ToFloat(bits[2 * pair + 1]);
+        const float radius = std::sqrt(-2.0f * std::log(u0));
+        const float theta = 2.0f * static_cast<float>(M_PI) * u1;
+        values[2 * pair] = radius * std::cos(theta);
+        values[2 * pair + 1] = radius * std::sin(theta);
+      }
+    } else {
+      for (int i = 0; i < 4; ++i) values[i] = PhiloxUint32ToFloat(bits[i]);
+    }
+
+    const size_t base = group * 4;
+    const size_t lo = std::max(begin, base);
+    const size_t hi = std::min(end, base + 4);
+    for (size_t i = lo; i < hi; ++i) data[i] = values[i - base];
+  }
+}
+
+template <bool kNormal>
+static AsyncValueRef<DenseHostTensor> TfRandomOpImpl(
+    const OpAttrsRef& attrs, const TensorMetadata& dest_md,
+    const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+
+  if (dest_md.dtype.kind() != DType::F32)
+    return EmitErrorAsync(exec_ctx, "random ops support only f32");
+
+  auto dest_alloc = DenseHostTensor::CreateUninitialized(dest_md, host);
+  if (!dest_alloc)
+    return EmitErrorAsync(exec_ctx, "out of memory allocating result");
+  auto& dest_tensor = dest_alloc.getValue();
+
+  // The generator is deterministic in (seed, seed2): equal seeds reproduce
+  // the tensor, different seeds select independent streams.
+  int64_t seed = 0;
+  int64_t seed2 = 0;
+  attrs.Get("seed", &seed);
+  attrs.Get("seed2", &seed2);
+  const uint64_t key = static_cast<uint64_t>(seed) ^
+                       (static_cast<uint64_t>(seed2) * 0x9E3779B97F4A7C15ull);
+
+  const size_t n = dest_md.shape.GetNumElements();
+  if (n == 0) {
+    return host->MakeAvailableAsyncValueRef<DenseHostTensor>(
+        std::move(dest_tensor));
+  }
+
+  auto* data = static_cast<float*>(dest_tensor.data());
+  auto dest_av = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+
+  static constexpr size_t kMinRandomBlockElements = 64 * 1024;
+  ParallelFor(host).Execute(
+      n, ParallelFor::BlockSizes::Min(kMinRandomBlockElements),
+      [data, key](size_t begin, size_t end) {
+        FillPhiloxBlock<kNormal>(data, begin, end, key);
+      },
+      [dest_av = dest_av.CopyRef(),
+       dest_tensor = std::move(dest_tensor)]() mutable {
+        dest_av.emplace(std::move(dest_tensor));
+      });
+  return dest_av;
+}
+
+// The underscore-prefixed names take the shape as an attribute, folded from
+// the constant shape operand like the other assembly ops above.
+static AsyncValueRef<DenseHostTensor> TfRandomUniformOp(
+    const OpAttrsRef& attrs, const TensorMetadata& dest_md,
+    const ExecutionContext& exec_ctx) {
+  return TfRandomOpImpl<false>(attrs, dest_md, exec_ctx);
+}
+
+static AsyncValueRef<DenseHostTensor> TfRandomStandardNormalOp(
+    const OpAttrsRef& attrs, const TensorMetadata& dest_md,
+    const ExecutionContext& exec_ctx) {
+  return TfRandomOpImpl<true>(attrs, dest_md, exec_ctx);
+}
+
+//===----------------------------------------------------------------------===//
+// tf.Cast op
+//===----------------------------------------------------------------------===//
+
+// The half formats are handled as their uint16_t storage representation; the
+// conversions below are the plain shift-and-round recipes, written as
+// branch-light element loops that the compiler vectorizes.
+
+// Converts f32 to IEEE fp16 with round-to-nearest-even, including overflow
+// to infinity and subnormal results.
+static uint16_t FloatToHalf(float value) {
+  uint32_t f;
+  std::memcpy(&f, &value, sizeof(f));
+  const auto sign = static_cast<uint16_t>((f >> 16) & 0x8000u);
+  f &= 0x7fffffffu;
+
+  if (f > 0x7f800000u) return sign | 0x7e00u;   // NaN -> quiet half NaN.
+  if (f >= 0x47800000u) return sign | 0x7c00u;  // Too large -> infinity.
+
+  if (f >= 0x38800000u) {
+    // Normal half: rebias the exponent and round the mantissa at bit 13. A
+    // carry out of the mantissa bumps the exponent, which is exactly the
+    // required rounding behavior.
+    const uint32_t rebiased = f - 0x38000000u;
+    uint32_t h = rebiased >> 13;
+    const uint32_t rest = rebiased & 0x1fffu;
+    h += (rest > 0x1000u) || (rest == 0x1000u && (h & 1));
+    return sign | static_cast<uint16_t>(h);
+  }
+
+  // Anything below half of the smallest subnormal rounds to zero.
+  if (f < 0x33000000u) return sign;
+
+  // Subnormal half: shift the mantissa with its explicit leading 1 into
+  // place and round at the shifted-out bits.
+  const uint32_t mant = (f & 0x7fffffu) | 0x800000u;
+  const uint32_t shift = 126u - (f >> 23);
+  uint32_t h = mant >> shift;
+  const uint32_t rest = mant & ((1u << shift) - 1);
+  const uint32_t halfway = 1u << (shift - 1);
+  h += (rest > halfway) || (rest == halfway && (h & 1));
+  return sign | static_cast<uint16_t>(h);
+}
+
+static float HalfToFloat(uint16_t h) {
+  const uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+  uint32_t exponent = (h >> 10) & 0x1fu;
+  uint32_t mantissa = h & 0x3ffu;
+
+  uint32_t f;
+  if (exponent == 0x1fu) {
+    f = sign | 0x7f800000u | (mantissa << 13);  // Infinity or NaN.
+  } else if (exponent != 0) {
+    f = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+  } else if (mantissa != 0) {
+    // Subnormal half: every subnormal is a normal f32; renormalize.
+    uint32_t shift = 0;
+    while ((mantissa & 0x400u) == 0) {
+      mantissa <<= 1;
+      ++shift;
+    }
+    f = sign | ((113u - shift) << 23) | ((mantissa & 0x3ffu) << 13);
+  } else {
+    f = sign;  // Zero.
+  }
+  float result;
+  std::memcpy(&result, &f, sizeof(result));
+  return result;
+}
+
+// bf16 is the upper half of the f32 bit pattern, so packing is a single
+// rounding shift (round-to-nearest-even).
+static uint16_t FloatToBfloat16(float value) {
+  uint32_t f;
+  std::memcpy(&f, &value, sizeof(f));
+  // Quiet NaNs explicitly; rounding a NaN payload could carry it to
+  // infinity.
+  if ((f & 0x7fffffffu) > 0x7f800000u)
+    return static_cast<uint16_t>((f >> 16) | 0x0040u);
+  f += 0x7fffu + ((f >> 16) & 1u);
+  return static_cast<uint16_t>(f >> 16);
+}
+
+static float Bfloat16ToFloat(uint16_t h) {
+  const uint32_t f = static_cast<uint32_t>(h) << 16;
+  float result;
+  std::memcpy(&result, &f, sizeof(result));
+  return result;
+}
+
+template <typename SrcT, typename DstT, DstT (*Convert)(SrcT)>
+static void CastBlock(const SrcT* src, DstT* dst, size_t begin, size_t end) {
+  for (size_t i = begin; i < end; ++i) dst[i] = Convert(src[i]);
+}
+
+static AsyncValueRef<DenseHostTensor> TfCastOp(const DenseHostTensor& input,
+                                               const OpAttrsRef& attrs,
+                                               const TensorMetadata& dest_md,
+                                               const ExecutionContext&
+                                                   exec_ctx) {
+  auto* host = exec_ctx.host();
+  const DType::Kind src_kind = input.dtype().kind();
+  const DType::Kind dst_kind = dest_md.dtype.kind();
+
+  const bool supported =
+      src_kind == dst_kind ||
+      (src_kind == DType::F32 &&
+       (dst_kind == DType::F16 || dst_kind == DType::BF16)) ||
+      ((src_kind == DType::F16 || src_kind == DType::BF16) &&
+       dst_kind == DType::F32);
+  if (!supported) {
+    return EmitErrorAsync(exec_ctx,
+                          "tf.Cast supports only f32 <-> f16/bf16 casts");
+  }
+
+  auto dest_alloc = DenseHostTensor::CreateUninitialized(dest_md, host);
+  if (!dest_alloc)
+    return EmitErrorAsync(exec_ctx, "out of memory allocating result");
+  auto& dest_tensor = dest_alloc.getValue();
+
+  const size_t n = input.NumElements();
+  if (n == 0) {
+    return host->MakeAvailableAsyncValueRef<DenseHostTensor>(
+        std::move(dest_tensor));
+  }
+
+  const void* src_data = input.data();
+  void* dst_data = dest_tensor.data();
+  auto dest_av = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+
+  static constexpr size_t kMinCastBlockElements = 64 * 1024;
+  auto execute = [&](auto compute) {
+    ParallelFor(host).Execute(
+        n, ParallelFor::BlockSizes::Min(kMinCastBlockElements),
+        std::move(compute),
+        [dest_av = dest_av.CopyRef(), dest_tensor = std::move(dest_tensor),
+         buffer = input.buffer().CopyRef()]() mutable {
+          dest_av.emplace(std::move(dest_tensor));
+        });
+  };
+
+  if (src_kind == dst_kind) {
+    const size_t elem_size = input.dtype().GetHostSize();
+    execute([src = static_cast<const char*>(src_data),
+             dst = static_cast<char*>(dst_data),
+             elem_size](size_t begin, size_t end) {
+      std::memcpy(dst + begin * elem_size, src + begin * elem_size,
+                  (end - begin) * elem_size);
+    });
+  } else if (dst_kind == DType::F16) {
+    execute([src = static_cast<const float*>(src_data),
+             dst = static_cast<uint16_t*>(dst_data)](size_t begin,
+                                                     size_t end) {
+      CastBlock<float, uint16_t, FloatToHalf>(src, dst, begin, end);
+    });
+  } else if (dst_kind == DType::BF16) {
+    execute([src = static_cast<const float*>(src_data),
+             dst = static_cast<uint16_t*>(dst_data)](size_t begin,
+                                                     size_t end) {
+      CastBlock<float, uint16_t, FloatToBfloat16>(src, dst, begin, end);
+    });
+  } else if (src_kind == DType::F16) {
+    execute([src = static_cast<const uint16_t*>(src_data),
+             dst = static_cast<float*>(dst_data)](size_t begin, size_t end) {
+      CastBlock<uint16_t, float, HalfToFloat>(src, dst, begin, end);
+    });
+  } else {
+    execute([src = static_cast<const uint16_t*>(src_data),
+             dst = static_cast<float*>(dst_data)](size_t begin, size_t end) {
+      CastBlock<uint16_t, float, Bfloat16ToFloat>(src, dst, begin, end);
+    });
+  }
+  return dest_av;
+}
+
+//===----------------------------------------------------------------------===//
+// tf._FusedLayerNorm op
+//===----------------------------------------------------------------------===//
+
+// Fuses the mean / variance / normalize / scale / shift chain into two
+// passes over each row: a single-pass mean and variance, then one combined
+// normalize-scale-shift pass. The unfused graph form reads the activation
+// five times.
+
+// Number of interleaved Welford accumulators per row. A single Welford
+// recurrence is a serial dependence chain; splitting the row over kNormLanes
+// independent strided streams lets the compiler vectorize the update as one
+// kNormLanes-wide step.
+static constexpr size_t kNormLanes = 8;
+
+// Merges (count_b, mean_b, m2_b) into (count_a, mean_a, m2_a) with Chan's
+// pairwise combination formula.
+static void MergeMeanM2(float* mean_a, float* m2_a, size_t* count_a,
+                        float mean_b, float m2_b, size_t count_b) {
+  if (count_b == 0) return;
+  const size_t count = *count_a + count_b;
+  const float delta = mean_b - *mean_a;
+  const float b_fraction =
+      static_cast<float>(count_b) / static_cast<float>(count);
+  *mean_a += delta * b_fraction;
+  *m2_a += m2_b + delta * delta * static_cast<float>(*count_a) * b_fraction;
+  *count_a = count;
+}
+
+// Computes mean and (population) variance of row[0, n) in one pass.
+static void RowMeanVariance(const float* row, size_t n, float* mean_out,
+                            float* variance_out) {
+  float mean[kNormLanes] = {0.0f};
+  float m2[kNormLanes] = {0.0f};
+
+  const size_t steps = n / kNormLanes;
+  for (size_t step = 0; step < steps; ++step) {
+    // All lanes share the same element count, so the Welford divisor is one
+    // broadcast reciprocal per step.
+    const float inv_count = 1.0f / static_cast<float>(step + 1);
+    for (size_t lane = 0; lane < kNormLanes; ++lane) {
+      const float x = row[step * kNormLanes + lane];
+      const float delta = x - mean[lane];
+      mean[lane] += delta * inv_count;
+      m2[lane] += delta * (x - mean[lane]);
+    }
+  }
+
+  float total_mean = 0.0f;
+  float total_m2 = 0.0f;
+  size_t total_count = 0;
+  for (size_t lane = 0; lane < kNormLanes; ++lane)
+    MergeMeanM2(&total_mean, &total_m2, &total_count, mean[lane], m2[lane],
+                steps);
+  // The remaining n % kNormLanes elements fold in as single-element streams.
+  for (size_t i = steps * kNormLanes; i < n; ++i)
+    MergeMeanM2(&total_mean, &total_m2, &total_count, row[i], 0.0f, 1);
+
+  *mean_out = total_mean;
+  *variance_out = n > 0 ? total_m2 / static_cast<float>(n) : 0.0f;
+}
+
+static void LayerNormRows(const float* input, const float* gamma,
+                          const float* beta, float* dest, size_t inner,
+                          float epsilon, size_t row_begin, size_t row_end) {
+  for (size_t row = row_begin; row < row_end; ++row) {
+    const float* src = input + row * inner;
+    float* dst = dest + row * inner;
+
+    float mean, variance;
+    RowMeanVariance(src, inner, &mean, &variance);
+
+    const float inv_std = 1.0f / std::sqrt(variance + epsilon);
+    for (size_t i = 0; i < inner; ++i)
+      dst[i] = (src[i] - mean) * inv_std * gamma[i] + beta[i];
+  }
+}
+
+static AsyncValueRef<DenseHostTensor> TfFusedLayerNormOp(
+    const DenseHostTensor& input, const DenseHostTensor& gamma,
+    const DenseHostTensor& beta, const OpAttrsRef& attrs,
+    const TensorMetadata& dest_md, const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+
+  if (input.dtype().kind() != DType::F32 ||
+      gamma.dtype().kind() != DType::F32 ||
+      beta.dtype().kind() != DType::F32) {
+    return EmitErrorAsync(exec_ctx,
+                          "tf._FusedLayerNorm supports only f32 operands");
+  }
+
+  const int rank = input.shape().GetRank();
+  if (rank < 1)
+    return EmitErrorAsync(exec_ctx,
+                          "tf._FusedLayerNorm input must have rank >= 1");
+  const size_t inner = input.shape().GetDimensionSize(rank - 1);
+  if (gamma.NumElements() != inner || beta.NumElements() != inner) {
+    return EmitErrorAsync(
+        exec_ctx, "tf._FusedLayerNorm scale and shift must match last dim");
+  }
+
+  float epsilon = 1e-6f;
+  attrs.Get("epsilon", &epsilon);
+
+  auto dest_alloc = DenseHostTensor::CreateUninitialized(dest_md, host);
+  if (!dest_alloc)
+    return EmitErrorAsync(exec_ctx, "out of memory allocating result");
+  auto& dest_tensor = dest_alloc.getValue();
+
+  const size_t n = input.NumElements();
+  if (n == 0) {
+    return host->MakeAvailableAsyncValueRef<DenseHostTensor>(
+        std::move(dest_tensor));
+  }
+  const size_t outer = n / inner;
+
+  const auto* input_data = static_cast<const float*>(input.data());
+  const auto* gamma_data = static_cast<const float*>(gamma.data());
+  const auto* beta_data = static_cast<const float*>(beta.data());
+  auto* dest_data = static_cast<float*>(dest_tensor.data());
+  auto dest_av = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+
+  static constexpr size_t kMinNormBlockElements = 64 * 1024;
+  const size_t min_rows = kMinNormBlockElements / inner + 1;
+  ParallelFor(host).Execute(
+      outer, ParallelFor::BlockSizes::Min(min_rows),
+      [input_data, gamma_data, beta_data, dest_data, inner,
+       epsilon](size_t begin, size_t end) {
+        LayerNormRows(input_data, gamma_data, beta_data, dest_data, inner,
+                      epsilon, begin, end);
+      },
+      [dest_av = dest_av.CopyRef(), dest_tensor = std::move(dest_tensor),
+       keep = compat::KeepBuffers::alive(&input, &gamma, &beta)]() mutable {
+        dest_av.emplace(std::move(dest_tensor));
+      });
+  return dest_av;
+}
+
+//===----------------------------------------------------------------------===//
+// tf.MaxPool and tf.AvgPool ops
+//===----------------------------------------------------------------------===//
+
+template <bool kAverage>
+static AsyncValueRef<DenseHostTensor> TfPoolingOpImpl(
+    const DenseHostTensor& input, const OpAttrsRef& attrs,
+    const TensorMetadata& dest_md, const ExecutionContext& exec_ctx) {
+  auto* host = exec_ctx.host();
+
+  if (input.dtype().kind() != DType::F32)
+    return EmitErrorAsync(exec_ctx, "pooling ops support only f32 inputs");
+  if (input.shape().GetRank() != 4 || dest_md.shape.GetRank() != 4)
+    return EmitErrorAsync(exec_ctx, "pooling ops expect rank-4 NHWC tensors");
+
+  auto data_format = attrs.GetStringOptional("data_format");
+  if (data_format.hasValue() && data_format.getValue() != "NHWC")
+    return EmitErrorAsync(exec_ctx, "pooling ops support only NHWC layout");
+
+  auto ksize = attrs.GetArrayOptional<ssize_t>("ksize");
+  auto strides = attrs.GetArrayOptional<ssize_t>("strides");
+  if (ksize.size() != 4 || strides.size() != 4) {
+    return EmitErrorAsync(exec_ctx,
+                          "pooling ksize and strides must have 4 elements");
+  }
+  if (ksize[0] != 1 || ksize[3] != 1 || strides[0] != 1 || strides[3] != 1) {
+    return EmitErrorAsync(
+        exec_ctx, "pooling over the batch or channels dimension is not "
+                  "supported");
+  }
+
+  compat::Pooling2DParams params;
+  params.input_shape = FixedRankShape<4>(input.shape());
+  params.output_shape = FixedRankShape<4>(dest_md.shape);
+  params.window = {ksize[1], ksize[2]};
+  params.strides = {strides[1], strides[2]};
+
+  if (params.output_shape[0] != params.input_shape[0] ||
+      params.output_shape[3] != params.input_shape[3]) {
+    return EmitErrorAsync(
+        exec_ctx, "pooling must preserve the batch and channels dimensions");
+  }
+
+  // The metadata function already resolved SAME/VALID into the output
+  // extents, so the total padding per spatial dimension is implied by the
+  // shapes. Split it with the excess at the bottom/right, the TF convention.
+  for (int d = 0; d < 2; ++d) {
+    const Eigen::Index total = std::max<Eigen::Index>(
+        0, (params.output_shape[d + 1] - 1) * params.strides[d] +
+               params.window[d] - params.input_shape[d + 1]);
+    params.paddings[2 * d] = total / 2;
+    params.paddings[2 * d + 1] = total - total / 2;
+  }
+
+  auto dest_alloc = DenseHostTensor::CreateUninitialized(dest_md, host);
+  if (!dest_alloc)
+    return EmitErrorAsync(exec_ctx, "out of memory allocating result");
+  auto& dest_tensor = dest_alloc.getValue();
+
+  if (dest_md.shape.GetNumElements() == 0) {
+    return host->MakeAvailableAsyncValueRef<DenseHostTensor>(
+        std::move(dest_tensor));
+  }
+
+  const auto* input_data = static_cast<const float*>(input.data());
+  auto* dest_data = static_cast<float*>(dest_tensor.data());
+  auto dest_av = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+
+  auto on_done = [dest_av = dest_av.CopyRef(),
+                  dest_tensor = std::move(dest_tensor),
+                  keep = compat::KeepBuffers::alive(&input)]() mutable {
+    dest_av.emplace(std::move(dest_tensor));
+  };
+  if (kAverage) {
+    compat::AveragePooling2D(input_data, dest_data, params, host,
+                             std::move(on_done));
+  } else {
+    compat::MaxPooling2D(input_data, dest_data, params, host,
+                         std::move(on_done));
+  }
+  return dest_av;
+}
+
+static AsyncValueRef<DenseHostTensor> TfMaxPoolOp(
+    const DenseHostTensor& input, const OpAttrsRef& attrs,
+    const TensorMetadata& dest_md, const ExecutionContext& exec_ctx) {
+  return TfPoolingOpImpl<false>(input, attrs, dest_md, exec_ctx);
+}
+
+static AsyncValueRef<DenseHostTensor> TfAvgPoolOp(
+    const DenseHostTensor& input, const OpAttrsRef& attrs,
+    const TensorMetadata& dest_md, const ExecutionContext& exec_ctx) {
+  return TfPoolingOpImpl<true>(input, attrs, dest_md, exec_ctx);
+}
+
 }  // namespace
 
 void RegisterTfCpuOps(CpuOpRegistry* op_registry) {
@@ -167,10 +1590,42 @@ void RegisterTfCpuOps(CpuOpRegistry* op_registry) {
                      CpuOpFlags::NoSideEffects, {"value"});
   op_registry->AddOp("tf.AddV2", TFRT_CPU_OP(TfAddOp),
                      CpuOpFlags::NoSideEffects | CpuOpFlags::AllowsScalar);
+  op_registry->AddOpVariant("tf.AddV2", TFRT_CPU_OP(TfAddF32Op),
+                            AllDenseInputsHaveDType<DType::F32>);
   op_registry->AddOp("tf.MatMul", TFRT_CPU_OP(TfMatMulOp),
                      CpuOpFlags::NoSideEffects, {"transpose_a", "transpose_b"});
+  op_registry->AddOp("tf._FusedMatMul", TFRT_CPU_OP(TfFusedMatMulOp),
+                     CpuOpFlags::NoSideEffects,
+                     {"transpose_a", "transpose_b", "fusion"});
   op_registry->AddOp("tf.Relu", TFRT_CPU_OP(TfReluOp),
                      CpuOpFlags::NoSideEffects);
+  op_registry->AddOp("tf.Gather", TFRT_CPU_OP(TfGatherOp),
+                     CpuOpFlags::NoSideEffects);
+  op_registry->AddOp("tf.ScatterAdd", TFRT_CPU_OP(TfScatterAddOp),
+                     CpuOpFlags::NoSideEffects);
+  op_registry->AddOp("_tf.ConcatV2", TFRT_CPU_OP(TfConcatOp),
+                     CpuOpFlags::NoSideEffects, {"axis"});
+  op_registry->AddOp("_tf.Split", TfSplitOp, CpuOpFlags::NoSideEffects,
+                     {"axis"});
+  op_registry->AddOp("_tf.Pad", TFRT_CPU_OP(TfPadOp),
+                     CpuOpFlags::NoSideEffects, {"paddings"});
+  op_registry->AddOp("_tf.Transpose", TFRT_CPU_OP(TfTransposeOp),
+                     CpuOpFlags::NoSideEffects, {"perm"});
+  op_registry->AddOp("_tf.RandomUniform", TFRT_CPU_OP(TfRandomUniformOp),
+                     CpuOpFlags::NoSideEffects, {"shape", "seed", "seed2"});
+  op_registry->AddOp("_tf.RandomStandardNormal",
+                     TFRT_CPU_OP(TfRandomStandardNormalOp),
+                     CpuOpFlags::NoSideEffects, {"shape", "seed", "seed2"});
+  op_registry->AddOp("tf.Cast", TFRT_CPU_OP(TfCastOp),
+                     CpuOpFlags::NoSideEffects, {"DstT"});
+  op_registry->AddOp("tf._FusedLayerNorm", TFRT_CPU_OP(TfFusedLayerNormOp),
+                     CpuOpFlags::NoSideEffects, {"epsilon"});
+  op_registry->AddOp("tf.MaxPool", TFRT_CPU_OP(TfMaxPoolOp),
+                     CpuOpFlags::NoSideEffects,
+                     {"padding", "ksize", "strides", "data_format"});
+  op_registry->AddOp("tf.AvgPool", TFRT_CPU_OP(TfAvgPoolOp),
+                     CpuOpFlags::NoSideEffects,
+                     {"padding", "ksize", "strides", "data_format"});
 }
 
 }  // namespace tfrt
@@ -207,3 +207,26 @@ func @test_coo_scalar_mixed() -> !hex.chain {
 
 
 
+// CHECK-LABEL: --- Running 'test_scalar_multiply'
+func @test_scalar_multiply() -> !hex.chain {
+  %ch0 = hex.new.chain
+  %cpu = corert.get_device "cpu"
+
+  %a_handle = corert.executeop(%cpu)
+    "tfrt_test.create_from_scalar"() { shape = [2, 3], value = 3 : i32 } : 1
+
+  %b_handle = corert.executeop(%cpu) "tfrt_test.multiply"(%a_handle, %a_handle) : 1
+
+  // CHECK: ScalarHostTensor dtype = I32, shape = [2, 3], value = 9
+  %ch1 = "corert.print_tensorhandle"(%b_handle, %ch0) : (!corert.tensorhandle, !hex.chain) -> !hex.chain
+
+  %c_handle = corert.executeop(%cpu)
+    "tfrt_test.create_dense_tensor"() { shape = [2, 3], values = [1 : i32, 2 : i32, 3 : i32, 4 : i32, 5 : i32, 6 : i32] } : 1
+
+  %d_handle = corert.executeop(%cpu) "tfrt_test.multiply"(%c_handle, %a_handle) : 1
+
+  // CHECK: DenseHostTensor dtype = I32, shape = [2, 3], values = [3, 6, 9, 12, 15, 18]
+  %ch2 = "corert.print_tensorhandle"(%d_handle, %ch1) : (!corert.tensorhandle, !hex.chain) -> !hex.chain
+
+  hex.return %ch2 : !hex.chain
+}
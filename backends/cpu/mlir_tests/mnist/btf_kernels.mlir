@@ -59,3 +59,67 @@ func @tensor_io_invalid_path() -> !t.tensor {
   // CHECK-NEXT: 'tensor_io_invalid_path' returned
   hex.return %t0 : !t.tensor
 }
+
+// CHECK-LABEL: --- Running 'tensor_io_view'
+func @tensor_io_view() {
+  // Reads the same tensors as 'tensor_io' above, but through the mmap backed
+  // reader, so the results alias the file mapping instead of copying it.
+  %c0 = hex.new.chain
+  %path = "tfrt_test.get_string"() { value = "backends/cpu/mlir_tests/mnist/test_data/test_tensor.btf" } : () -> !hex.string
+
+  %zero = hex.constant.i32 0
+  %one = hex.constant.i32 1
+  %two = hex.constant.i32 2
+
+  %t0 = "btf.read_dense_tensor_view.i32.2"(%path, %zero) : (!hex.string, i32) -> (!t.tensor)
+  // CHECK: shape = [2, 2], values = [1, 2, 3, 4]
+  %c1 = dht.print_tensor %t0, %c0
+
+  %t1 = "btf.read_dense_tensor_view.i32.1"(%path, %one) : (!hex.string, i32) -> (!t.tensor)
+  // CHECK: shape = [5], values = [0, 1, 2, 3, 4]
+  %c2 = dht.print_tensor %t1, %c1
+
+  %t2 = "btf.read_dense_tensor_view.i32.1"(%path, %two) : (!hex.string, i32) -> (!t.tensor)
+  // CHECK: shape = [0], values = []
+  %c3 = dht.print_tensor %t2, %c2
+
+  hex.return
+}
+
+// CHECK-LABEL: --- Running 'btf_writer_write'
+func @btf_writer_write() -> !hex.chain {
+  %c0 = hex.new.chain
+
+  %a = dht.create_uninitialized_tensor.i32.2 [2 : i64, 2 : i64]
+  %c1 = dht.set_tensor_with_constant_values.i32 %a, %c0 [1 : i32, 2 : i32, 3 : i32, 4 : i32]
+
+  %b = dht.create_uninitialized_tensor.i32.1 [3 : i64]
+  %c2 = dht.set_tensor_with_constant_values.i32 %b, %c1 [5 : i32, 6 : i32, 7 : i32]
+
+  %path = "tfrt_test.get_string"() { value = "/tmp/btf_writer_test.btf" } : () -> !hex.string
+  %c3 = "btf.write_dense_tensors"(%path, %c2, %a, %b) : (!hex.string, !hex.chain, !t.tensor, !t.tensor) -> !hex.chain
+
+  // The executor waits for the returned chain, so the read back below runs
+  // after the file is fully written.
+  // CHECK: 'btf_writer_write' returned
+  hex.return %c3 : !hex.chain
+}
+
+// CHECK-LABEL: --- Running 'btf_writer_read_back'
+func @btf_writer_read_back() {
+  %c0 = hex.new.chain
+  %path = "tfrt_test.get_string"() { value = "/tmp/btf_writer_test.btf" } : () -> !hex.string
+
+  %zero = hex.constant.i32 0
+  %one = hex.constant.i32 1
+
+  %t0 = "btf.read_dense_tensor.i32.2"(%path, %zero) : (!hex.string, i32) -> (!t.tensor)
+  // CHECK: shape = [2, 2], values = [1, 2, 3, 4]
+  %c1 = dht.print_tensor %t0, %c0
+
+  %t1 = "btf.read_dense_tensor.i32.1"(%path, %one) : (!hex.string, i32) -> (!t.tensor)
+  // CHECK: shape = [3], values = [5, 6, 7]
+  %c2 = dht.print_tensor %t1, %c1
+
+  hex.return
+}
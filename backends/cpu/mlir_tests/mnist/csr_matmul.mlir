@@ -0,0 +1,87 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RUN: tfrt_translate -mlir-to-bef %s | bef_executor | FileCheck %s --dump-input=fail
+
+// CHECK-LABEL: --- Running 'test_csr_matmul_i32'
+func @test_csr_matmul_i32() {
+  %ch0 = hex.new.chain
+  %zero = hex.constant.i32 0
+  %one = hex.constant.i32 1
+
+  // Shape: [2, 3], mostly zero.
+  %a = dht.create_uninitialized_tensor.i32.2 [2 : i64, 3 : i64]
+  %ch1 = dht.set_tensor_with_constant_values.i32 %a, %ch0
+    [0 : i32, 5 : i32, 0 : i32, 7 : i32, 0 : i32, 8 : i32]
+  // Shape: [3, 2].
+  %b = dht.create_uninitialized_tensor.i32.2 [3 : i64, 2 : i64]
+  %ch2 = dht.set_tensor_with_constant_values.i32 %b, %ch1
+    [1 : i32, 2 : i32, 3 : i32, 4 : i32, 5 : i32, 6 : i32]
+
+  %coo, %ch3 = coo.convert_dht_to_coo.i32.2 %a, %ch2
+  %csr, %ch4 = csr.convert_coo_to_csr.i32.2 %coo, %ch3
+
+  // Shape: [2, 2].
+  %c = dht.create_uninitialized_tensor.i32.2 [2 : i64, 2 : i64]
+  %ch5 = "tfrt_test.csr_matmul.i32.2"(%csr, %b, %c, %ch4) :
+    (!t.tensor, !t.tensor, !t.tensor, !hex.chain) -> !hex.chain
+
+  // Compare against the dense matmul of the same operands.
+  %sol = dht.create_uninitialized_tensor.i32.2 [2 : i64, 2 : i64]
+  %ch6 = "tfrt_test.matmul.i32.2"(%one, %a, %b, %zero, %sol, %ch5) :
+    (i32, !t.tensor, !t.tensor, i32,
+    !t.tensor, !hex.chain) -> !hex.chain
+  %cmp, %ch7 = dht.tensor_equal.i32 %sol, %c, %ch6
+
+  // CHECK: int1 = 1
+  hex.print.i1 %cmp, %ch7
+
+  hex.return
+}
+
+// CHECK-LABEL: --- Running 'test_csr_matmul_f32'
+func @test_csr_matmul_f32() {
+  %ch0 = hex.new.chain
+  %zero = hex.constant.f32 0.0
+  %one = hex.constant.f32 1.0
+
+  // Shape: [3, 2], mostly zero.
+  %a = dht.create_uninitialized_tensor.f32.2 [3 : i64, 2 : i64]
+  %ch1 = dht.set_tensor_with_constant_values.f32 %a, %ch0
+    [0.0 : f32, 2.0 : f32, 0.0 : f32, 0.0 : f32, 3.0 : f32, 0.0 : f32]
+  // Shape: [2, 3].
+  %b = dht.create_uninitialized_tensor.f32.2 [2 : i64, 3 : i64]
+  %ch2 = dht.set_tensor_with_constant_values.f32 %b, %ch1
+    [1.0 : f32, 2.0 : f32, 3.0 : f32, 4.0 : f32, 5.0 : f32, 6.0 : f32]
+
+  %coo, %ch3 = coo.convert_dht_to_coo.f32.2 %a, %ch2
+  %csr, %ch4 = csr.convert_coo_to_csr.f32.2 %coo, %ch3
+
+  // Shape: [3, 3].
+  %c = dht.create_uninitialized_tensor.f32.2 [3 : i64, 3 : i64]
+  %ch5 = "tfrt_test.csr_matmul.f32.2"(%csr, %b, %c, %ch4) :
+    (!t.tensor, !t.tensor, !t.tensor, !hex.chain) -> !hex.chain
+
+  %sol = dht.create_uninitialized_tensor.f32.2 [3 : i64, 3 : i64]
+  %ch6 = "tfrt_test.matmul.f32.2"(%one, %a, %b, %zero, %sol, %ch5) :
+    (f32, !t.tensor, !t.tensor, f32,
+    !t.tensor, !hex.chain) -> !hex.chain
+  %cmp, %ch7 = "dht.tensor_allclose.f32"(%sol, %c, %ch6) :
+    (!t.tensor, !t.tensor, !hex.chain) -> (i1, !hex.chain)
+
+  // CHECK: int1 = 1
+  hex.print.i1 %cmp, %ch7
+
+  hex.return
+}
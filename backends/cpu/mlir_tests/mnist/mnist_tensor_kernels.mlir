@@ -90,3 +90,97 @@ func @test_tensor_kernels() {
 
   hex.return
 }
+
+// CHECK-LABEL: --- Running 'test_full_reductions'
+func @test_full_reductions() {
+  %ch0 = hex.new.chain
+
+  %a = "dht.create_uninitialized_tensor.f32.2"() { shape = [2 : i64, 3 : i64] } :
+    () -> !t.tensor
+  %ch1 = "dht.set_tensor_with_constant_values.f32"(%a, %ch0)
+    { values = [1. : f32, 2. : f32, 3. : f32, 4. : f32, 5. : f32, 6. : f32] } :
+    (!t.tensor, !hex.chain) -> !hex.chain
+
+  %sum = "dht.create_uninitialized_tensor.f32.1"() { shape = [1 : i64] } :
+    () -> !t.tensor
+  %ch2 = "tfrt_test.sum.f32"(%a, %sum, %ch1) :
+    (!t.tensor, !t.tensor, !hex.chain) -> !hex.chain
+
+  // CHECK: shape = [1], values = [2.100000e+01]
+  %ch3 = dht.print_tensor %sum, %ch2
+
+  %max = "dht.create_uninitialized_tensor.f32.1"() { shape = [1 : i64] } :
+    () -> !t.tensor
+  %ch4 = "tfrt_test.max.f32"(%a, %max, %ch3) :
+    (!t.tensor, !t.tensor, !hex.chain) -> !hex.chain
+
+  // CHECK: shape = [1], values = [6.000000e+00]
+  %ch5 = dht.print_tensor %max, %ch4
+
+  %mean = "dht.create_uninitialized_tensor.f32.1"() { shape = [1 : i64] } :
+    () -> !t.tensor
+  %ch6 = "tfrt_test.mean.f32"(%a, %mean, %ch5) :
+    (!t.tensor, !t.tensor, !hex.chain) -> !hex.chain
+
+  // CHECK: shape = [1], values = [3.500000e+00]
+  %ch7 = dht.print_tensor %mean, %ch6
+
+  hex.return
+}
+
+// CHECK-LABEL: --- Running 'test_quantized_kernels'
+func @test_quantized_kernels() {
+  %ch0 = hex.new.chain
+
+  %a = "dht.create_uninitialized_tensor.f32.2"() { shape = [2 : i64, 2 : i64] } :
+    () -> !t.tensor
+  %ch1 = "dht.set_tensor_with_constant_values.f32"(%a, %ch0)
+    { values = [1. : f32, 2. : f32, 3. : f32, 4. : f32] } :
+    (!t.tensor, !hex.chain) -> !hex.chain
+
+  %a_q = "dht.create_uninitialized_tensor.i8.2"() { shape = [2 : i64, 2 : i64] } :
+    () -> !t.tensor
+  %ch2 = "tfrt_test.quantize.f32_to_i8"(%a, %a_q, %ch1)
+    { scale = 0.5 : f32, zero_point = 0 : i32 } :
+    (!t.tensor, !t.tensor, !hex.chain) -> !hex.chain
+
+  // Round trip back to float.
+  %a_dq = "dht.create_uninitialized_tensor.f32.2"() { shape = [2 : i64, 2 : i64] } :
+    () -> !t.tensor
+  %ch3 = "tfrt_test.dequantize.i8_to_f32"(%a_q, %a_dq, %ch2)
+    { scale = 0.5 : f32, zero_point = 0 : i32 } :
+    (!t.tensor, !t.tensor, !hex.chain) -> !hex.chain
+
+  // CHECK: shape = [2, 2], values = [1.000000e+00, 2.000000e+00, 3.000000e+00, 4.000000e+00]
+  %ch4 = dht.print_tensor %a_dq, %ch3
+
+  // Identity weights quantized with scale 1.
+  %w = "dht.create_uninitialized_tensor.f32.2"() { shape = [2 : i64, 2 : i64] } :
+    () -> !t.tensor
+  %ch5 = "dht.set_tensor_with_constant_values.f32"(%w, %ch4)
+    { values = [1. : f32, 0. : f32, 0. : f32, 1. : f32] } :
+    (!t.tensor, !hex.chain) -> !hex.chain
+  %w_q = "dht.create_uninitialized_tensor.i8.2"() { shape = [2 : i64, 2 : i64] } :
+    () -> !t.tensor
+  %ch6 = "tfrt_test.quantize.f32_to_i8"(%w, %w_q, %ch5)
+    { scale = 1.0 : f32, zero_point = 0 : i32 } :
+    (!t.tensor, !t.tensor, !hex.chain) -> !hex.chain
+
+  // Combined activation and weight scale for each output channel.
+  %scales = "dht.create_uninitialized_tensor.f32.1"() { shape = [2 : i64] } :
+    () -> !t.tensor
+  %ch7 = "dht.set_tensor_with_constant_values.f32"(%scales, %ch6)
+    { values = [0.5 : f32, 0.5 : f32] } :
+    (!t.tensor, !hex.chain) -> !hex.chain
+
+  %c = "dht.create_uninitialized_tensor.f32.2"() { shape = [2 : i64, 2 : i64] } :
+    () -> !t.tensor
+  %ch8 = "tfrt_test.quantized_matmul.i8"(%a_q, %w_q, %scales, %c, %ch7)
+    { zero_point = 0 : i32 } :
+    (!t.tensor, !t.tensor, !t.tensor, !t.tensor, !hex.chain) -> !hex.chain
+
+  // CHECK: shape = [2, 2], values = [1.000000e+00, 2.000000e+00, 3.000000e+00, 4.000000e+00]
+  %ch9 = dht.print_tensor %c, %ch8
+
+  hex.return
+}
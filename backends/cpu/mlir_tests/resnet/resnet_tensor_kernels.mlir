@@ -74,3 +74,58 @@ func @test_max_pool_2d_f32_shape_error() {
 
   hex.return
 }
+
+// CHECK-LABEL: --- Running 'test_add_relu_f32'
+func @test_add_relu_f32() {
+  %ch0 = hex.new.chain
+
+  %a = "dht.create_uninitialized_tensor.f32.2"()
+    { shape = [1 : i64, 4 : i64] }
+    : () -> !t.tensor
+  %ch1 = "dht.set_tensor_with_constant_values.f32"(%a, %ch0)
+    { values = [-1.0 : f32, 2.0 : f32, -3.0 : f32, 4.0 : f32] }
+    : (!t.tensor, !hex.chain) -> !hex.chain
+
+  %b = "dht.create_uninitialized_tensor.f32.2"()
+    { shape = [1 : i64, 4 : i64] }
+    : () -> !t.tensor
+  %ch2 = "dht.set_tensor_with_constant_values.f32"(%b, %ch1)
+    { values = [-1.0 : f32, 1.0 : f32, 4.0 : f32, -5.0 : f32] }
+    : (!t.tensor, !hex.chain) -> !hex.chain
+
+  %c = "dht.create_uninitialized_tensor.f32.2"()
+    { shape = [1 : i64, 4 : i64] }
+    : () -> !t.tensor
+  %ch3 = "tfrt_test.add_relu.f32"(%a, %b, %c, %ch2)
+    : (!t.tensor, !t.tensor, !t.tensor, !hex.chain) -> !hex.chain
+
+  // CHECK: shape = [1, 4], values = [0.000000e+00, 3.000000e+00, 1.000000e+00, 0.000000e+00]
+  dht.print_tensor %c, %ch3
+  hex.return
+}
+
+// CHECK-LABEL: --- Running 'test_bias_add_relu_inplace_f32'
+func @test_bias_add_relu_inplace_f32() {
+  %ch0 = hex.new.chain
+
+  %bias = "dht.create_uninitialized_tensor.f32.1"()
+    { shape = [2 : i64] }
+    : () -> !t.tensor
+  %ch1 = "dht.set_tensor_with_constant_values.f32"(%bias, %ch0)
+    { values = [1.0 : f32, -2.0 : f32] }
+    : (!t.tensor, !hex.chain) -> !hex.chain
+
+  %out = "dht.create_uninitialized_tensor.f32.4"()
+    { shape = [1 : i64, 2 : i64, 1 : i64, 2 : i64] }
+    : () -> !t.tensor
+  %ch2 = "dht.set_tensor_with_constant_values.f32"(%out, %ch1)
+    { values = [-2.0 : f32, 1.0 : f32, 3.0 : f32, 4.0 : f32] }
+    : (!t.tensor, !hex.chain) -> !hex.chain
+
+  %ch3 = "tfrt_test.bias_add_relu_inplace.f32"(%bias, %out, %ch2)
+    : (!t.tensor, !t.tensor, !hex.chain) -> !hex.chain
+
+  // CHECK: shape = [1, 2, 1, 2], values = [0.000000e+00, 0.000000e+00, 4.000000e+00, 2.000000e+00]
+  dht.print_tensor %out, %ch3
+  hex.return
+}
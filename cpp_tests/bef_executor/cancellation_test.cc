@@ -0,0 +1,207 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- cancellation_test.cc -----------------------------------------------===//
+//
+// Tests for per-execution cancellation: a CancellationToken attached to the
+// ExecutionContext cancels the BEF executions it was passed to - remaining
+// kernels are skipped and the cancellation error propagates through their
+// result registers - without affecting other executions on the same host.
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Module.h"
+#include "mlir/Parser.h"
+#include "tfrt/bef_converter/mlir_to_bef.h"
+#include "tfrt/bef_executor/bef_file.h"
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/function.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/kernel_registry.h"
+#include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+namespace {
+
+// The gate kernel parks the execution: its result only becomes available
+// once the test opens `gate`. This gives the test a window in which the
+// execution is in flight and can be cancelled.
+AsyncValueRef<Chain> gate;
+
+// Counts invocations of the counted add kernel, to verify that kernels
+// downstream of a cancellation point are skipped, not run-and-discarded.
+std::atomic<int32_t> counted_invocations;
+
+static void TestGateI32(Argument<int32_t> in, Result<int32_t> out) {
+  auto result = out.Allocate();
+  int32_t value = *in;
+  gate.AndThen([result = result.CopyRef(), value] { result.emplace(value); });
+}
+
+static int32_t TestCountedAddOneI32(int32_t in) {
+  counted_invocations.fetch_add(1, std::memory_order_relaxed);
+  return in + 1;
+}
+
+// The gate kernel keeps @gated_add_one in flight until the test decides its
+// fate; the counted kernel records whether execution proceeded past the gate.
+constexpr const char* kTestProgram = R"mlir(
+  func @gated_add_one(%x: i32) -> i32 {
+    %g = "hex.test_gate.i32"(%x) : (i32) -> i32
+    %y = "hex.test_counted_add_one.i32"(%g) : (i32) -> i32
+    hex.return %y : i32
+  }
+)mlir";
+
+std::unique_ptr<HostContext> CreateTestHostContext() {
+  auto host = std::make_unique<HostContext>(
+      [](const DecodedDiagnostic&) {}, CreateMallocAllocator(),
+      CreateMultiThreadedWorkQueue(/*num_threads=*/4,
+                                   /*max_num_pending_blocking_tasks=*/4));
+  RegisterStaticKernels(host->GetRegistry());
+  host->GetRegistry()->AddKernel("hex.test_gate.i32",
+                                 TFRT_KERNEL(TestGateI32));
+  host->GetRegistry()->AddKernel("hex.test_counted_add_one.i32",
+                                 TFRT_KERNEL(TestCountedAddOneI32));
+  return host;
+}
+
+class CancellationTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    host_ = CreateTestHostContext();
+    gate = host_->MakeUnconstructedAsyncValueRef<Chain>();
+    counted_invocations.store(0, std::memory_order_relaxed);
+
+    mlir::OwningModuleRef module =
+        mlir::parseSourceString(kTestProgram, &context_);
+    ASSERT_TRUE(module);
+    bef_ = ConvertMLIRToBEF(module.get(), /*disable_optional_sections=*/false);
+    ASSERT_FALSE(bef_.empty());
+    bef_file_ = BEFFile::Open(bef_, host_->GetRegistry(),
+                              [](DecodedDiagnostic) { abort(); },
+                              host_->allocator());
+    ASSERT_TRUE(bef_file_);
+    fn_ = bef_file_->GetFunction("gated_add_one");
+    ASSERT_NE(fn_, nullptr);
+  }
+
+  void TearDown() override {
+    host_->Quiesce();
+    gate.reset();
+  }
+
+  // Start one execution of @gated_add_one with the given token (which may be
+  // null) and return its pending result.
+  RCReference<AsyncValue> StartExecution(
+      int32_t x, RCReference<CancellationToken> token) {
+    auto arg = host_->MakeAvailableAsyncValueRef<int32_t>(x);
+    AsyncValue* arg_ptr = arg.GetAsyncValue();
+    SmallVector<RCReference<AsyncValue>, 1> results;
+    results.resize(1);
+    ExecutionContext exec_ctx(host_.get());
+    exec_ctx.set_cancellation_token(std::move(token));
+    fn_->Execute(exec_ctx, arg_ptr, results);
+    return std::move(results[0]);
+  }
+
+  mlir::MLIRContext context_;
+  std::unique_ptr<HostContext> host_;
+  std::vector<uint8_t> bef_;
+  RCReference<BEFFile> bef_file_;
+  const Function* fn_ = nullptr;
+};
+
+TEST_F(CancellationTest, TokenStateTransitions) {
+  auto token = TakeRef(new CancellationToken(host_.get()));
+  EXPECT_FALSE(token->IsCancelled());
+  EXPECT_EQ(token->GetCancelAsyncValue(), nullptr);
+
+  token->Cancel("first");
+  ASSERT_TRUE(token->IsCancelled());
+  AsyncValue* cancel_value = token->GetCancelAsyncValue();
+  ASSERT_NE(cancel_value, nullptr);
+  EXPECT_TRUE(cancel_value->IsError());
+  EXPECT_EQ(cancel_value->GetError().message, "first");
+
+  // The first Cancel wins; later messages are dropped.
+  token->Cancel("second");
+  EXPECT_EQ(token->GetCancelAsyncValue(), cancel_value);
+  EXPECT_EQ(cancel_value->GetError().message, "first");
+}
+
+TEST_F(CancellationTest, CancelSkipsRemainingKernels) {
+  auto token = TakeRef(new CancellationToken(host_.get()));
+  auto result = StartExecution(7, token.CopyRef());
+  EXPECT_FALSE(result->IsAvailable());
+
+  // Cancel while the execution is parked on the gate, then open the gate.
+  // The kernel downstream of the gate must not run; its result registers
+  // carry the cancellation error instead.
+  token->Cancel("cancelled by client");
+  gate.emplace();
+  host_->Await(result);
+
+  ASSERT_TRUE(result->IsError());
+  EXPECT_EQ(result->GetError().message, "cancelled by client");
+  EXPECT_EQ(counted_invocations.load(std::memory_order_relaxed), 0);
+}
+
+TEST_F(CancellationTest, UncancelledTokenDoesNotInterfere) {
+  auto token = TakeRef(new CancellationToken(host_.get()));
+  auto result = StartExecution(7, token.CopyRef());
+  EXPECT_FALSE(result->IsAvailable());
+
+  gate.emplace();
+  host_->Await(result);
+
+  ASSERT_TRUE(result->IsAvailable());
+  ASSERT_FALSE(result->IsError());
+  EXPECT_EQ(result->get<int32_t>(), 8);
+  EXPECT_EQ(counted_invocations.load(std::memory_order_relaxed), 1);
+}
+
+TEST_F(CancellationTest, CancellationIsScopedToTheTokensExecutions) {
+  // Two concurrent executions; only the first carries the token. Unlike
+  // HostContext::CancelExecution, cancelling the token must leave the other
+  // execution untouched.
+  auto token = TakeRef(new CancellationToken(host_.get()));
+  auto cancelled_result = StartExecution(7, token.CopyRef());
+  auto live_result = StartExecution(10, /*token=*/{});
+
+  token->Cancel("cancelled by client");
+  gate.emplace();
+  host_->Await(cancelled_result);
+  host_->Await(live_result);
+
+  ASSERT_TRUE(cancelled_result->IsError());
+  ASSERT_FALSE(live_result->IsError());
+  EXPECT_EQ(live_result->get<int32_t>(), 11);
+  EXPECT_EQ(counted_invocations.load(std::memory_order_relaxed), 1);
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,192 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- concurrent_execution_test.cc ---------------------------------------===//
+//
+// Stress tests for the concurrent-execution contract of BEFFile: any number
+// of threads may execute the same or different functions of one BEFFile at
+// the same time (see the class comment in bef_file.h). The tests pass
+// trivially on a race; they are primarily meaningful under tsan, which they
+// drive through the shared decode cache, the execution-state pool, the
+// parked-executor slot and the lazy function table.
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Module.h"
+#include "mlir/Parser.h"
+#include "tfrt/bef_converter/mlir_to_bef.h"
+#include "tfrt/bef_executor/bef_file.h"
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/function.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/kernel_registry.h"
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+namespace {
+
+// One function with asynchronous kernels, which takes the general executor
+// path (state pool, parked executor), and one tiny all-synchronous function,
+// which takes the inline execution path. Both add 4 to their argument.
+constexpr const char* kTestProgram = R"mlir(
+  func @async_add_four(%x: i32) -> i32 {
+    %one = hex.constant.i32 1
+    %a = "hex.async_add.i32"(%x, %one) : (i32, i32) -> i32
+    %b = "hex.async_add.i32"(%a, %one) : (i32, i32) -> i32
+    %c = hex.add.i32 %b, %one
+    %d = hex.add.i32 %c, %one
+    hex.return %d : i32
+  }
+
+  func @sync_add_four(%x: i32) -> i32 {
+    %one = hex.constant.i32 1
+    %a = hex.add.i32 %x, %one
+    %b = hex.add.i32 %a, %one
+    %c = hex.add.i32 %b, %one
+    %d = hex.add.i32 %c, %one
+    hex.return %d : i32
+  }
+)mlir";
+
+std::unique_ptr<HostContext> CreateTestHostContext() {
+  auto host = std::make_unique<HostContext>(
+      [](const DecodedDiagnostic&) { abort(); }, CreateMallocAllocator(),
+      CreateMultiThreadedWorkQueue(/*num_threads=*/4,
+                                   /*max_num_pending_blocking_tasks=*/4));
+  RegisterStaticKernels(host->GetRegistry());
+  return host;
+}
+
+std::vector<uint8_t> CompileTestProgram() {
+  mlir::MLIRContext context;
+  mlir::OwningModuleRef module =
+      mlir::parseSourceString(kTestProgram, &context);
+  if (!module) return {};
+  return ConvertMLIRToBEF(module.get(), /*disable_optional_sections=*/false);
+}
+
+RCReference<BEFFile> OpenTestProgram(const std::vector<uint8_t>& bef,
+                                     HostContext* host) {
+  return BEFFile::Open(bef, host->GetRegistry(),
+                       [](DecodedDiagnostic) { abort(); }, host->allocator());
+}
+
+// Execute `fn` with the single argument `x` and return its i32 result.
+int32_t Run(const Function* fn, HostContext* host, int32_t x) {
+  auto arg = host->MakeAvailableAsyncValueRef<int32_t>(x);
+  AsyncValue* arg_ptr = arg.GetAsyncValue();
+  SmallVector<RCReference<AsyncValue>, 1> results;
+  results.resize(1);
+  fn->Execute(arg_ptr, results, host);
+  host->Await(results);
+  if (results[0]->IsError()) {
+    ADD_FAILURE() << "function returned an error";
+    return -1;
+  }
+  return results[0]->get<int32_t>();
+}
+
+TEST(ConcurrentExecutionTest, OneFunctionFromManyThreads) {
+  auto host = CreateTestHostContext();
+  auto bef = CompileTestProgram();
+  ASSERT_FALSE(bef.empty());
+  auto bef_file = OpenTestProgram(bef, host.get());
+  ASSERT_TRUE(bef_file);
+  const Function* fn = bef_file->GetFunction("async_add_four");
+  ASSERT_NE(fn, nullptr);
+
+  constexpr int kNumThreads = 8;
+  constexpr int kIterations = 100;
+  std::atomic<int> mismatches{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kIterations; ++i) {
+        int32_t x = t * kIterations + i;
+        if (Run(fn, host.get(), x) != x + 4) mismatches.fetch_add(1);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(mismatches.load(), 0);
+  host->Quiesce();
+}
+
+TEST(ConcurrentExecutionTest, FirstExecutionRaces) {
+  // All threads look up and execute the function on a freshly opened file,
+  // racing the one-time work: the function decode, the per-function info
+  // cache fill and the lazy Function materialization.
+  auto host = CreateTestHostContext();
+  auto bef = CompileTestProgram();
+  ASSERT_FALSE(bef.empty());
+  auto bef_file = OpenTestProgram(bef, host.get());
+  ASSERT_TRUE(bef_file);
+
+  constexpr int kNumThreads = 8;
+  std::atomic<int> mismatches{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t] {
+      const Function* fn = bef_file->GetFunction("async_add_four");
+      if (fn == nullptr || Run(fn, host.get(), t) != t + 4)
+        mismatches.fetch_add(1);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(mismatches.load(), 0);
+  host->Quiesce();
+}
+
+TEST(ConcurrentExecutionTest, MixedFunctionsShareTheFile) {
+  auto host = CreateTestHostContext();
+  auto bef = CompileTestProgram();
+  ASSERT_FALSE(bef.empty());
+  auto bef_file = OpenTestProgram(bef, host.get());
+  ASSERT_TRUE(bef_file);
+  const Function* async_fn = bef_file->GetFunction("async_add_four");
+  const Function* sync_fn = bef_file->GetFunction("sync_add_four");
+  ASSERT_NE(async_fn, nullptr);
+  ASSERT_NE(sync_fn, nullptr);
+
+  constexpr int kNumThreads = 8;
+  constexpr int kIterations = 100;
+  std::atomic<int> mismatches{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t] {
+      // Half the threads exercise the executor path, half the inline path.
+      const Function* fn = (t % 2 == 0) ? async_fn : sync_fn;
+      for (int i = 0; i < kIterations; ++i) {
+        int32_t x = t * kIterations + i;
+        if (Run(fn, host.get(), x) != x + 4) mismatches.fetch_add(1);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(mismatches.load(), 0);
+  host->Quiesce();
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,129 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- critical_path_analysis_test.cc -------------------------------------===//
+//
+// Unit tests for the critical path recorder and its backward walk.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/bef_executor/critical_path_analysis.h"
+
+#include "gtest/gtest.h"
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/cpp_tests/test_util.h"
+#include "tfrt/host_context/host_context.h"
+
+namespace tfrt {
+namespace {
+
+// Builds a recorder for a two-kernel chain: register 0 is a function
+// argument, kernel 0 reads it and produces register 1, kernel 1 reads that
+// and produces register 2, the function result.
+std::shared_ptr<CriticalPathRecorder> RecordChain(HostContext* host) {
+  auto recorder = std::make_shared<CriticalPathRecorder>(
+      /*num_registers=*/3, /*num_kernels=*/2);
+  size_t result_regs[] = {2};
+  recorder->SetResultRegs(result_regs);
+
+  auto v1 = host->MakeAvailableAsyncValueRef<int32_t>(1);
+  auto v2 = host->MakeAvailableAsyncValueRef<int32_t>(2);
+
+  uint32_t args0[] = {0};
+  uint64_t t0 = CriticalPathNowNs();
+  recorder->RecordKernelDispatch(0, "test.producer", args0, t0, t0 + 100);
+  CriticalPathRecorder::RecordResult(recorder, 1, 0, v1.GetAsyncValue());
+
+  uint32_t args1[] = {1};
+  uint64_t t1 = CriticalPathNowNs();
+  recorder->RecordKernelDispatch(1, "test.consumer", args1, t1, t1 + 100);
+  CriticalPathRecorder::RecordResult(recorder, 2, 1, v2.GetAsyncValue());
+  return recorder;
+}
+
+TEST(CriticalPathAnalysisTest, WalksBackwardFromResults) {
+  auto host = CreateHostContext();
+  auto recorder = RecordChain(host.get());
+
+  std::vector<CriticalPathStep> path = recorder->ComputeCriticalPath();
+  ASSERT_EQ(path.size(), 2);
+  // Producer-to-result order, with monotone timestamps per step.
+  EXPECT_EQ(path[0].kernel_name, "test.producer");
+  EXPECT_EQ(path[1].kernel_name, "test.consumer");
+  for (const CriticalPathStep& step : path) {
+    EXPECT_LE(step.ready_ns, step.start_ns);
+    EXPECT_LE(step.start_ns, step.available_ns);
+  }
+  // The consumer became ready when the producer's result resolved.
+  EXPECT_EQ(path[1].ready_ns, path[0].available_ns);
+}
+
+TEST(CriticalPathAnalysisTest, PendingResultDoesNotBlockTheWalk) {
+  auto host = CreateHostContext();
+  auto recorder = std::make_shared<CriticalPathRecorder>(
+      /*num_registers=*/2, /*num_kernels=*/1);
+  size_t result_regs[] = {1};
+  recorder->SetResultRegs(result_regs);
+
+  // An asynchronous kernel whose result has not resolved yet.
+  auto pending = host->MakeUnconstructedAsyncValueRef<int32_t>();
+  uint32_t args[] = {0};
+  uint64_t t0 = CriticalPathNowNs();
+  recorder->RecordKernelDispatch(0, "test.async", args, t0, t0 + 100);
+  CriticalPathRecorder::RecordResult(recorder, 1, 0, pending.GetAsyncValue());
+
+  // The pending result is treated as available "now", so the path already
+  // points at the slow kernel.
+  std::vector<CriticalPathStep> path = recorder->ComputeCriticalPath();
+  ASSERT_EQ(path.size(), 1);
+  EXPECT_EQ(path[0].kernel_name, "test.async");
+  EXPECT_GE(path[0].available_ns, t0 + 100);
+
+  pending.emplace(1);
+}
+
+TEST(CriticalPathAnalysisTest, WritesTextAndTraceFormats) {
+  auto host = CreateHostContext();
+  auto recorder = RecordChain(host.get());
+  std::vector<CriticalPathStep> path = recorder->ComputeCriticalPath();
+
+  std::string text;
+  llvm::raw_string_ostream text_os(text);
+  PrintCriticalPath(path, text_os);
+  text_os.flush();
+  EXPECT_NE(text.find("test.producer"), std::string::npos);
+  EXPECT_NE(text.find("total"), std::string::npos);
+
+  std::string trace;
+  llvm::raw_string_ostream trace_os(trace);
+  WriteCriticalPathTrace(path, trace_os);
+  trace_os.flush();
+  EXPECT_EQ(trace.front(), '[');
+  EXPECT_NE(trace.find("\"ph\":\"X\""), std::string::npos);
+  EXPECT_NE(trace.find("\"name\":\"test.consumer\""), std::string::npos);
+}
+
+TEST(CriticalPathAnalysisTest, LastRecorderSlotRoundTrip) {
+  auto host = CreateHostContext();
+  PublishCriticalPathRecorder(nullptr);
+  EXPECT_TRUE(ComputeLastCriticalPath().empty());
+
+  auto recorder = RecordChain(host.get());
+  PublishCriticalPathRecorder(recorder);
+  EXPECT_EQ(ComputeLastCriticalPath().size(), 2);
+  PublishCriticalPathRecorder(nullptr);
+}
+
+}  // namespace
+}  // namespace tfrt
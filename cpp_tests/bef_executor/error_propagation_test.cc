@@ -0,0 +1,212 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- error_propagation_test.cc ------------------------------------------===//
+//
+// Tests for the executor's error sweep: when a kernel fails, every
+// transitively dependent register is errored in one pass over the static
+// dependency structure, and none of the skipped kernels are dispatched.
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Module.h"
+#include "mlir/Parser.h"
+#include "tfrt/bef_converter/mlir_to_bef.h"
+#include "tfrt/bef_executor/bef_file.h"
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/function.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/kernel_registry.h"
+#include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+namespace {
+
+// The gate keeps the gated fail kernel's result pending until the test opens
+// it, so errors can be injected while downstream kernels are already waiting.
+AsyncValueRef<Chain> gate;
+
+// Counts invocations of the counted add kernel, to verify that kernels
+// downstream of an error are skipped by the sweep, not run-and-discarded.
+std::atomic<int32_t> counted_invocations;
+
+static void TestFailI32(Argument<int32_t> in, Result<int32_t> out,
+                        KernelErrorHandler handler) {
+  handler.ReportError("failed on purpose");
+}
+
+static void TestGatedFailI32(Argument<int32_t> in, Result<int32_t> out) {
+  auto result = out.Allocate();
+  gate.AndThen([result = result.CopyRef()] {
+    result.SetError(DecodedDiagnostic{"gated failure"});
+  });
+}
+
+static int32_t TestCountedAddOneI32(int32_t in) {
+  counted_invocations.fetch_add(1, std::memory_order_relaxed);
+  return in + 1;
+}
+
+// @sync_chain fails at its head; the whole chain of counted kernels must be
+// swept without any of them running. @async_chain fails only when the gate
+// opens, with the chain already enqueued on the error register. @diamond
+// joins a failed branch with a healthy one at a two-argument kernel.
+constexpr const char* kTestProgram = R"mlir(
+  func @sync_chain(%x: i32) -> i32 {
+    %e = "hex.test_fail.i32"(%x) : (i32) -> i32
+    %1 = "hex.test_counted_add_one.i32"(%e) : (i32) -> i32
+    %2 = "hex.test_counted_add_one.i32"(%1) : (i32) -> i32
+    %3 = "hex.test_counted_add_one.i32"(%2) : (i32) -> i32
+    %4 = "hex.test_counted_add_one.i32"(%3) : (i32) -> i32
+    hex.return %4 : i32
+  }
+
+  func @async_chain(%x: i32) -> i32 {
+    %e = "hex.test_gated_fail.i32"(%x) : (i32) -> i32
+    %1 = "hex.test_counted_add_one.i32"(%e) : (i32) -> i32
+    %2 = "hex.test_counted_add_one.i32"(%1) : (i32) -> i32
+    %3 = "hex.test_counted_add_one.i32"(%2) : (i32) -> i32
+    hex.return %3 : i32
+  }
+
+  func @diamond(%x: i32) -> i32 {
+    %e = "hex.test_fail.i32"(%x) : (i32) -> i32
+    %a = "hex.test_counted_add_one.i32"(%e) : (i32) -> i32
+    %b = "hex.test_counted_add_one.i32"(%x) : (i32) -> i32
+    %r = hex.add.i32 %a, %b
+    hex.return %r : i32
+  }
+
+  func @healthy_chain(%x: i32) -> i32 {
+    %1 = "hex.test_counted_add_one.i32"(%x) : (i32) -> i32
+    %2 = "hex.test_counted_add_one.i32"(%1) : (i32) -> i32
+    %3 = "hex.test_counted_add_one.i32"(%2) : (i32) -> i32
+    hex.return %3 : i32
+  }
+)mlir";
+
+std::unique_ptr<HostContext> CreateTestHostContext() {
+  auto host = std::make_unique<HostContext>(
+      [](const DecodedDiagnostic&) {}, CreateMallocAllocator(),
+      CreateMultiThreadedWorkQueue(/*num_threads=*/4,
+                                   /*max_num_pending_blocking_tasks=*/4));
+  RegisterStaticKernels(host->GetRegistry());
+  host->GetRegistry()->AddKernel("hex.test_fail.i32",
+                                 TFRT_KERNEL(TestFailI32));
+  host->GetRegistry()->AddKernel("hex.test_gated_fail.i32",
+                                 TFRT_KERNEL(TestGatedFailI32));
+  host->GetRegistry()->AddKernel("hex.test_counted_add_one.i32",
+                                 TFRT_KERNEL(TestCountedAddOneI32));
+  return host;
+}
+
+class ErrorPropagationTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    host_ = CreateTestHostContext();
+    gate = host_->MakeUnconstructedAsyncValueRef<Chain>();
+    counted_invocations.store(0, std::memory_order_relaxed);
+
+    mlir::OwningModuleRef module =
+        mlir::parseSourceString(kTestProgram, &context_);
+    ASSERT_TRUE(module);
+    bef_ = ConvertMLIRToBEF(module.get(), /*disable_optional_sections=*/false);
+    ASSERT_FALSE(bef_.empty());
+    bef_file_ = BEFFile::Open(bef_, host_->GetRegistry(),
+                              [](DecodedDiagnostic) { abort(); },
+                              host_->allocator());
+    ASSERT_TRUE(bef_file_);
+  }
+
+  void TearDown() override {
+    host_->Quiesce();
+    gate.reset();
+  }
+
+  // Run the named function on one i32 argument and return its result after
+  // waiting for it to resolve.
+  RCReference<AsyncValue> Run(const char* fn_name, int32_t x) {
+    const Function* fn = bef_file_->GetFunction(fn_name);
+    EXPECT_NE(fn, nullptr);
+    auto arg = host_->MakeAvailableAsyncValueRef<int32_t>(x);
+    AsyncValue* arg_ptr = arg.GetAsyncValue();
+    SmallVector<RCReference<AsyncValue>, 1> results;
+    results.resize(1);
+    fn->Execute(arg_ptr, results, host_.get());
+    host_->Await(results[0]);
+    return std::move(results[0]);
+  }
+
+  mlir::MLIRContext context_;
+  std::unique_ptr<HostContext> host_;
+  std::vector<uint8_t> bef_;
+  RCReference<BEFFile> bef_file_;
+};
+
+TEST_F(ErrorPropagationTest, SyncErrorSweepsChainWithoutDispatch) {
+  auto result = Run("sync_chain", 7);
+  ASSERT_TRUE(result->IsError());
+  EXPECT_EQ(result->GetError().message, "failed on purpose");
+  EXPECT_EQ(counted_invocations.load(std::memory_order_relaxed), 0);
+}
+
+TEST_F(ErrorPropagationTest, AsyncErrorSweepsWaitingChain) {
+  const Function* fn = bef_file_->GetFunction("async_chain");
+  ASSERT_NE(fn, nullptr);
+  auto arg = host_->MakeAvailableAsyncValueRef<int32_t>(7);
+  AsyncValue* arg_ptr = arg.GetAsyncValue();
+  SmallVector<RCReference<AsyncValue>, 1> results;
+  results.resize(1);
+  fn->Execute(arg_ptr, results, host_.get());
+  EXPECT_FALSE(results[0]->IsAvailable());
+
+  // Fail the head of the chain while its users are already enqueued.
+  gate.emplace();
+  host_->Await(results[0]);
+
+  ASSERT_TRUE(results[0]->IsError());
+  EXPECT_EQ(results[0]->GetError().message, "gated failure");
+  EXPECT_EQ(counted_invocations.load(std::memory_order_relaxed), 0);
+}
+
+TEST_F(ErrorPropagationTest, DiamondJoinPropagatesErrorPastHealthyBranch) {
+  auto result = Run("diamond", 7);
+  ASSERT_TRUE(result->IsError());
+  EXPECT_EQ(result->GetError().message, "failed on purpose");
+  // The healthy branch runs; the errored branch and the join are swept.
+  EXPECT_EQ(counted_invocations.load(std::memory_order_relaxed), 1);
+}
+
+TEST_F(ErrorPropagationTest, HealthyChainIsUnaffected) {
+  auto result = Run("healthy_chain", 7);
+  ASSERT_FALSE(result->IsError());
+  EXPECT_EQ(result->get<int32_t>(), 10);
+  EXPECT_EQ(counted_invocations.load(std::memory_order_relaxed), 3);
+}
+
+}  // namespace
+}  // namespace tfrt
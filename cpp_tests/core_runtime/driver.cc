@@ -36,14 +36,14 @@ namespace tfrt {
 namespace example {
 
 static std::unique_ptr<CoreRuntime> CreateCoreRuntime(
-    ArrayRef<std::string> op_handlers) {
+    ArrayRef<std::string> op_handlers, int num_threads = 4) {
   auto diag_handler = [](const DecodedDiagnostic& diag) {
     llvm::errs() << "Encountered runtime error: " << diag.message << "\n";
   };
   auto corert = CoreRuntime::Create(
       diag_handler, tfrt::CreateMallocAllocator(),
       tfrt::CreateMultiThreadedWorkQueue(
-          /*num_threads=*/4, /*max_num_pending_blocking_tasks=*/64),
+          num_threads, /*max_num_pending_blocking_tasks=*/64),
       op_handlers);
 
   assert(corert);
@@ -53,6 +53,11 @@ static std::unique_ptr<CoreRuntime> CreateCoreRuntime(
 CoreRuntimeDriver::CoreRuntimeDriver(const std::string& op_handler)
     : CoreRuntimeDriver(CreateCoreRuntime(op_handler), op_handler) {}
 
+CoreRuntimeDriver::CoreRuntimeDriver(const std::string& op_handler,
+                                     int num_threads)
+    : CoreRuntimeDriver(CreateCoreRuntime(op_handler, num_threads),
+                        op_handler) {}
+
 CoreRuntimeDriver::CoreRuntimeDriver(std::unique_ptr<CoreRuntime> corert,
                                      const std::string& op_handler)
     : corert_(std::move(corert)),
@@ -41,6 +41,10 @@ class CoreRuntimeDriver final : public LocationHandler {
  public:
   explicit CoreRuntimeDriver(const std::string& op_handlers);
 
+  // Like above, but with an explicit worker thread count instead of the
+  // default of 4. Used by benchmarks that sweep over pool sizes.
+  CoreRuntimeDriver(const std::string& op_handlers, int num_threads);
+
   // Eagerly execute the op.
   void Execute(string_view op_name, Location loc,
                MutableArrayRef<TensorHandle> args, const OpAttrsRef& attrs,
@@ -48,6 +52,8 @@ class CoreRuntimeDriver final : public LocationHandler {
 
   CoreRuntimeOp MakeOp(string_view op_name);
   HostContext* GetHostContext() const { return corert_->GetHostContext(); }
+  CoreRuntime* GetCoreRuntime() const { return corert_.get(); }
+  OpHandler* GetOpHandler() const { return op_handler_; }
 
   // Create a encoded Location object.
   Location CreateLocation(const char* filename, int line_number);
@@ -0,0 +1,221 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- mnist_benchmark.cc -------------------------------------------------===//
+//
+// End-to-end throughput benchmarks for the MNIST op mix executed through
+// CoreRuntime: two dense layers (matmul + bias add) with a relu in between,
+// the same per-image work as integrationtest/mnist/mnist.mlir. The model
+// benchmark sweeps batch size and worker thread count and reports images/sec;
+// the per-layer benchmarks time each op in isolation at a fixed batch so a
+// regression can be pinned to one layer. Run with --benchmark_format=json for
+// machine-readable output that CI can diff against recorded baselines.
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "driver.h"
+#include "tfrt/core_runtime/op_attrs.h"
+#include "tfrt/core_runtime/tensor_handle.h"
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/ref_count.h"
+
+namespace tfrt {
+namespace {
+
+constexpr ssize_t kImageSize = 784;
+constexpr ssize_t kHiddenSize = 512;
+constexpr ssize_t kNumClasses = 10;
+
+// Creates a [num_rows, num_cols] f32 tensor filled with a fixed value.
+TensorHandle CreateTensor(example::CoreRuntimeDriver* driver, ssize_t num_rows,
+                          ssize_t num_cols, float value) {
+  OpAttrs attrs;
+  attrs.SetArray("shape", ArrayRef<ssize_t>{num_rows, num_cols});
+  std::vector<float> values(num_rows * num_cols, value);
+  attrs.SetArray("values", ArrayRef<float>(values.data(), values.size()));
+  TensorHandle result;
+  driver->Execute("tfrt_test.create_dense_tensor",
+                  driver->CreateLocation(__FILE__, __LINE__), {},
+                  attrs.freeze(), result);
+  return result;
+}
+
+// Blocks until `handle`'s tensor is fully resolved.
+void AwaitTensor(example::CoreRuntimeDriver* driver, const TensorHandle& th) {
+  llvm::SmallVector<RCReference<AsyncValue>, 1> values;
+  values.push_back(FormRef(th.GetAsyncTensor()));
+  driver->GetHostContext()->Await(values);
+}
+
+// Weights, biases (pre-broadcast to the batch), and input for one batch size.
+struct MnistParams {
+  TensorHandle input;    // [batch, 784]
+  TensorHandle weights1;  // [784, 512]
+  TensorHandle bias1;     // [batch, 512]
+  TensorHandle weights2;  // [512, 10]
+  TensorHandle bias2;     // [batch, 10]
+};
+
+MnistParams CreateMnistParams(example::CoreRuntimeDriver* driver,
+                              ssize_t batch) {
+  MnistParams params;
+  params.input = CreateTensor(driver, batch, kImageSize, 0.5f);
+  params.weights1 = CreateTensor(driver, kImageSize, kHiddenSize, 0.01f);
+  params.bias1 = CreateTensor(driver, batch, kHiddenSize, 0.1f);
+  params.weights2 = CreateTensor(driver, kHiddenSize, kNumClasses, 0.01f);
+  params.bias2 = CreateTensor(driver, batch, kNumClasses, 0.1f);
+  return params;
+}
+
+// Runs one forward pass and returns the logits handle.
+TensorHandle MnistForward(example::CoreRuntimeDriver* driver,
+                          MnistParams* params, const OpAttrsRef& matmul_attrs) {
+  auto loc = driver->CreateLocation(__FILE__, __LINE__);
+
+  TensorHandle hidden;
+  {
+    TensorHandle args[2] = {params->input.CopyRef(),
+                            params->weights1.CopyRef()};
+    driver->Execute("tfrt_test.matmul", loc, args, matmul_attrs, hidden);
+  }
+  TensorHandle hidden_biased;
+  {
+    TensorHandle args[2] = {std::move(hidden), params->bias1.CopyRef()};
+    driver->Execute("tfrt_test.add", loc, args, OpAttrsRef(), hidden_biased);
+  }
+  TensorHandle activated;
+  {
+    TensorHandle args[1] = {std::move(hidden_biased)};
+    driver->Execute("tfrt_test.relu", loc, args, OpAttrsRef(), activated);
+  }
+  TensorHandle logits;
+  {
+    TensorHandle args[2] = {std::move(activated), params->weights2.CopyRef()};
+    driver->Execute("tfrt_test.matmul", loc, args, matmul_attrs, logits);
+  }
+  TensorHandle logits_biased;
+  {
+    TensorHandle args[2] = {std::move(logits), params->bias2.CopyRef()};
+    driver->Execute("tfrt_test.add", loc, args, OpAttrsRef(), logits_biased);
+  }
+  return logits_biased;
+}
+
+OpAttrsRef MakeMatmulAttrs(OpAttrs* attrs) {
+  attrs->Set<bool>("transpose_a", false);
+  attrs->Set<bool>("transpose_b", false);
+  return attrs->freeze();
+}
+
+// Full model at varying batch size (first argument) and worker thread count
+// (second argument).
+void BM_MnistForward(benchmark::State& state) {
+  const ssize_t batch = state.range(0);
+  example::CoreRuntimeDriver driver("cpu", state.range(1));
+  MnistParams params = CreateMnistParams(&driver, batch);
+  OpAttrs matmul_attrs;
+  OpAttrsRef matmul_attrs_ref = MakeMatmulAttrs(&matmul_attrs);
+
+  for (auto _ : state) {
+    TensorHandle logits = MnistForward(&driver, &params, matmul_attrs_ref);
+    AwaitTensor(&driver, logits);
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+  state.counters["images_per_sec"] = benchmark::Counter(
+      state.iterations() * batch, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_MnistForward)
+    ->Args({1, 4})
+    ->Args({16, 4})
+    ->Args({64, 1})
+    ->Args({64, 4})
+    ->Args({64, 8})
+    ->Args({256, 4});
+
+// Per-layer benchmarks at a fixed batch of 64 on 4 threads: the time split
+// across these accounts for the full forward pass above.
+constexpr ssize_t kLayerBatch = 64;
+
+void BM_MnistLayerMatMul1(benchmark::State& state) {
+  example::CoreRuntimeDriver driver("cpu", 4);
+  MnistParams params = CreateMnistParams(&driver, kLayerBatch);
+  OpAttrs matmul_attrs;
+  OpAttrsRef matmul_attrs_ref = MakeMatmulAttrs(&matmul_attrs);
+  auto loc = driver.CreateLocation(__FILE__, __LINE__);
+
+  for (auto _ : state) {
+    TensorHandle args[2] = {params.input.CopyRef(), params.weights1.CopyRef()};
+    TensorHandle result;
+    driver.Execute("tfrt_test.matmul", loc, args, matmul_attrs_ref, result);
+    AwaitTensor(&driver, result);
+  }
+  state.SetItemsProcessed(state.iterations() * kLayerBatch);
+}
+BENCHMARK(BM_MnistLayerMatMul1);
+
+void BM_MnistLayerBiasAdd(benchmark::State& state) {
+  example::CoreRuntimeDriver driver("cpu", 4);
+  MnistParams params = CreateMnistParams(&driver, kLayerBatch);
+  TensorHandle hidden = CreateTensor(&driver, kLayerBatch, kHiddenSize, 1.0f);
+  auto loc = driver.CreateLocation(__FILE__, __LINE__);
+
+  for (auto _ : state) {
+    TensorHandle args[2] = {hidden.CopyRef(), params.bias1.CopyRef()};
+    TensorHandle result;
+    driver.Execute("tfrt_test.add", loc, args, OpAttrsRef(), result);
+    AwaitTensor(&driver, result);
+  }
+  state.SetItemsProcessed(state.iterations() * kLayerBatch);
+}
+BENCHMARK(BM_MnistLayerBiasAdd);
+
+void BM_MnistLayerRelu(benchmark::State& state) {
+  example::CoreRuntimeDriver driver("cpu", 4);
+  TensorHandle hidden = CreateTensor(&driver, kLayerBatch, kHiddenSize, -0.5f);
+  auto loc = driver.CreateLocation(__FILE__, __LINE__);
+
+  for (auto _ : state) {
+    TensorHandle args[1] = {hidden.CopyRef()};
+    TensorHandle result;
+    driver.Execute("tfrt_test.relu", loc, args, OpAttrsRef(), result);
+    AwaitTensor(&driver, result);
+  }
+  state.SetItemsProcessed(state.iterations() * kLayerBatch);
+}
+BENCHMARK(BM_MnistLayerRelu);
+
+void BM_MnistLayerMatMul2(benchmark::State& state) {
+  example::CoreRuntimeDriver driver("cpu", 4);
+  MnistParams params = CreateMnistParams(&driver, kLayerBatch);
+  TensorHandle hidden = CreateTensor(&driver, kLayerBatch, kHiddenSize, 1.0f);
+  OpAttrs matmul_attrs;
+  OpAttrsRef matmul_attrs_ref = MakeMatmulAttrs(&matmul_attrs);
+  auto loc = driver.CreateLocation(__FILE__, __LINE__);
+
+  for (auto _ : state) {
+    TensorHandle args[2] = {hidden.CopyRef(), params.weights2.CopyRef()};
+    TensorHandle result;
+    driver.Execute("tfrt_test.matmul", loc, args, matmul_attrs_ref, result);
+    AwaitTensor(&driver, result);
+  }
+  state.SetItemsProcessed(state.iterations() * kLayerBatch);
+}
+BENCHMARK(BM_MnistLayerMatMul2);
+
+}  // namespace
+}  // namespace tfrt
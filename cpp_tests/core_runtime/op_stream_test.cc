@@ -0,0 +1,141 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- op_stream_test.cc --------------------------------------------------===//
+//
+// Unit tests for OpStream, the ordered op submission queue on CoreRuntime.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/core_runtime/op_stream.h"
+
+#include "driver.h"
+#include "gtest/gtest.h"
+#include "tfrt/core_runtime/op_attrs.h"
+#include "tfrt/core_runtime/tensor_handle.h"
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/tensor/dense_host_tensor_view.h"
+#include "tfrt/tensor/tensor_metadata.h"
+
+namespace tfrt {
+namespace {
+
+class OpStreamTest : public testing::Test {
+ protected:
+  OpStream* GetStream(string_view name) {
+    return driver_.GetCoreRuntime()->GetStream(name, driver_.GetOpHandler());
+  }
+
+  example::CoreRuntimeDriver driver_{"cpu"};
+};
+
+TEST_F(OpStreamTest, SameNameReturnsSameStream) {
+  EXPECT_EQ(GetStream("preprocess"), GetStream("preprocess"));
+  EXPECT_NE(GetStream("preprocess"), GetStream("inference"));
+}
+
+TEST_F(OpStreamTest, OpsOnOneStreamProduceOrderedResults) {
+  OpStream* stream = GetStream("main");
+
+  tfrt::OpAttrs attrs;
+  attrs.SetArray("shape", tfrt::ArrayRef<ssize_t>{2, 2});
+  attrs.SetArray("values", tfrt::ArrayRef<float>{2.0});
+  tfrt::TensorHandle a1;
+  stream->Execute("tfrt_test.create_dense_tensor",
+                  driver_.CreateLocation(__FILE__, __LINE__), {},
+                  attrs.freeze(), a1);
+
+  tfrt::OpAttrs matmul_attrs;
+  matmul_attrs.Set<bool>("transpose_a", false);
+  matmul_attrs.Set<bool>("transpose_b", false);
+  tfrt::TensorHandle matmul_args[2] = {a1.CopyRef(), a1.CopyRef()};
+  tfrt::TensorHandle a2;
+  stream->Execute("tfrt_test.matmul",
+                  driver_.CreateLocation(__FILE__, __LINE__), matmul_args,
+                  matmul_attrs.freeze(), a2);
+
+  driver_.WaitForHostContextQuiesce();
+
+  auto a2_metadata = a2.GetAvailableMetadata();
+  ASSERT_EQ(a2_metadata.shape.GetRank(), 2);
+  auto a2_view =
+      DHTArrayView<float>(&a2.GetAsyncTensor()->get<DenseHostTensor>());
+  ASSERT_EQ(a2_view.Elements()[0], 8.0);
+}
+
+TEST_F(OpStreamTest, RecordedEventCompletesAfterEnqueuedWork) {
+  OpStream* stream = GetStream("main");
+
+  tfrt::OpAttrs attrs;
+  attrs.SetArray("shape", tfrt::ArrayRef<ssize_t>{2, 2});
+  attrs.SetArray("values", tfrt::ArrayRef<float>{2.0});
+  tfrt::TensorHandle a1;
+  stream->Execute("tfrt_test.create_dense_tensor",
+                  driver_.CreateLocation(__FILE__, __LINE__), {},
+                  attrs.freeze(), a1);
+
+  auto event = stream->RecordEvent();
+  driver_.GetHostContext()->Await({event.CopyRCRef()});
+  // The event only completes once the op's results are available.
+  ASSERT_TRUE(a1.GetAsyncTensor()->IsAvailable());
+}
+
+TEST_F(OpStreamTest, EventOrdersWorkAcrossStreams) {
+  OpStream* producer = GetStream("preprocess");
+  OpStream* consumer = GetStream("inference");
+
+  tfrt::OpAttrs attrs;
+  attrs.SetArray("shape", tfrt::ArrayRef<ssize_t>{2, 2});
+  attrs.SetArray("values", tfrt::ArrayRef<float>{2.0});
+  tfrt::TensorHandle a1;
+  producer->Execute("tfrt_test.create_dense_tensor",
+                    driver_.CreateLocation(__FILE__, __LINE__), {},
+                    attrs.freeze(), a1);
+
+  // The consumer stream starts its ops only after the producer's enqueued
+  // work has completed.
+  consumer->WaitFor(producer->RecordEvent());
+
+  tfrt::OpAttrs matmul_attrs;
+  matmul_attrs.Set<bool>("transpose_a", false);
+  matmul_attrs.Set<bool>("transpose_b", false);
+  tfrt::TensorHandle matmul_args[2] = {a1.CopyRef(), a1.CopyRef()};
+  tfrt::TensorHandle a2;
+  consumer->Execute("tfrt_test.matmul",
+                    driver_.CreateLocation(__FILE__, __LINE__), matmul_args,
+                    matmul_attrs.freeze(), a2);
+
+  driver_.WaitForHostContextQuiesce();
+
+  auto a2_view =
+      DHTArrayView<float>(&a2.GetAsyncTensor()->get<DenseHostTensor>());
+  ASSERT_EQ(a2_view.Elements()[0], 8.0);
+}
+
+TEST_F(OpStreamTest, UnknownOpFailsItsResults) {
+  OpStream* stream = GetStream("main");
+
+  tfrt::OpAttrs attrs;
+  tfrt::TensorHandle result;
+  stream->Execute("tfrt_test.does_not_exist", Location(), {}, attrs.freeze(),
+                  result);
+
+  driver_.WaitForHostContextQuiesce();
+  ASSERT_TRUE(result.GetAsyncTensor()->IsError());
+}
+
+}  // namespace
+}  // namespace tfrt
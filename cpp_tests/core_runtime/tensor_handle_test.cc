@@ -0,0 +1,106 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- tensor_handle_test.cc ----------------------------------------------===//
+//
+// Unit tests for cross-HostContext TensorHandle transfer.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/core_runtime/tensor_handle.h"
+
+#include "gtest/gtest.h"
+#include "tfrt/host_context/host_context_pool.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/tensor/dense_host_tensor_view.h"
+#include "tfrt/tensor/tensor_shape.h"
+
+namespace tfrt {
+namespace {
+
+HostContextPool::Options TestPoolOptions() {
+  HostContextPool::Options options;
+  options.num_contexts = 2;
+  options.num_threads_per_context = 1;
+  options.num_blocking_threads_per_context = 1;
+  options.diag_handler = [](const DecodedDiagnostic&) { abort(); };
+  return options;
+}
+
+TensorHandle MakeTestTensor(HostContext* host) {
+  TensorMetadata metadata(GetDType<float>(), TensorShape({2, 2}));
+  auto dht = DenseHostTensor::CreateUninitialized(metadata, host);
+  MutableDHTArrayView<float> view(&dht.getValue());
+  view.Fill(1.0f);
+  return TensorHandle(
+      metadata, host->MakeAvailableAsyncValueRef<DenseHostTensor>(
+                    std::move(*dht)));
+}
+
+TEST(TensorHandleTest, TransferSharesDenseHostBuffer) {
+  HostContextPool pool(TestPoolOptions());
+  HostContext* src = pool.GetContext(0);
+  HostContext* dst = pool.GetContext(1);
+  ASSERT_NE(src, dst);
+
+  TensorHandle handle = MakeTestTensor(src);
+  const void* data =
+      handle.GetAsyncTensor()->get<DenseHostTensor>().data();
+
+  TensorHandle transferred = handle.TransferTo(dst);
+  ASSERT_TRUE(transferred.IsValid());
+  ASSERT_TRUE(transferred.GetAsyncTensor()->IsConcrete());
+
+  // Same bytes, no copy: the destination handle aliases the source buffer.
+  auto& dht = transferred.GetAsyncTensor()->get<DenseHostTensor>();
+  EXPECT_EQ(dht.data(), data);
+  EXPECT_TRUE(transferred.IsMetadataAvailable());
+  EXPECT_EQ(transferred.GetAvailableMetadata().shape.GetNumElements(), 4);
+}
+
+TEST(TensorHandleTest, TransferForwardsUnresolvedTensor) {
+  HostContextPool pool(TestPoolOptions());
+  HostContext* src = pool.GetContext(0);
+  HostContext* dst = pool.GetContext(1);
+
+  TensorMetadata metadata(GetDType<float>(), TensorShape({2, 2}));
+  auto pending = src->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+  TensorHandle handle(metadata, AsyncValueRef<Tensor>(pending.CopyRCRef()));
+
+  TensorHandle transferred = handle.TransferTo(dst);
+  ASSERT_TRUE(transferred.IsValid());
+  EXPECT_FALSE(transferred.GetAsyncTensor()->IsAvailable());
+
+  // Resolve on the source; the transferred handle follows.
+  auto dht = DenseHostTensor::CreateUninitialized(metadata, src);
+  MutableDHTArrayView<float> view(&dht.getValue());
+  view.Fill(2.0f);
+  const void* data = dht->data();
+  pending.emplace(std::move(*dht));
+
+  AsyncValue* tensor = transferred.GetAsyncTensor();
+  ASSERT_TRUE(tensor->IsAvailable());
+  EXPECT_EQ(tensor->get<DenseHostTensor>().data(), data);
+}
+
+TEST(TensorHandleTest, PoolRoundRobin) {
+  HostContextPool pool(TestPoolOptions());
+  HostContext* first = pool.NextContext();
+  HostContext* second = pool.NextContext();
+  EXPECT_NE(first, second);
+  EXPECT_EQ(pool.NextContext(), first);
+}
+
+}  // namespace
+}  // namespace tfrt
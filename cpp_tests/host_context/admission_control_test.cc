@@ -0,0 +1,126 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- admission_control_test.cc ------------------------------------------===//
+//
+// Unit tests for bounded work admission on HostContext.
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/latch.h"
+
+namespace tfrt {
+namespace {
+
+std::unique_ptr<HostContext> CreateMultiThreadedHostContext() {
+  return std::make_unique<HostContext>(
+      [](const DecodedDiagnostic&) { abort(); }, CreateMallocAllocator(),
+      CreateMultiThreadedWorkQueue(/*num_threads=*/4,
+                                   /*max_num_pending_blocking_tasks=*/4));
+}
+
+TEST(AdmissionControlTest, AdmitsEverythingByDefault) {
+  auto host = CreateMultiThreadedHostContext();
+  std::atomic<int> done{0};
+  for (int i = 0; i < 100; ++i)
+    ASSERT_TRUE(host->TryEnqueueWork([&] { done.fetch_add(1); },
+                                     TaskPriority::kDefault));
+  host->Quiesce();
+  EXPECT_EQ(done.load(), 100);
+}
+
+TEST(AdmissionControlTest, RejectsWhenLaneFull) {
+  auto host = CreateMultiThreadedHostContext();
+  host->SetWorkAdmissionBudget(TaskPriority::kDefault, 1);
+
+  latch started(1);
+  latch release(1);
+  ASSERT_TRUE(host->TryEnqueueWork(
+      [&] {
+        started.count_down();
+        release.wait();
+      },
+      TaskPriority::kDefault));
+  started.wait();
+
+  // The lane slot is held until the admitted task finishes running.
+  EXPECT_FALSE(host->TryEnqueueWork([] {}, TaskPriority::kDefault));
+  release.count_down();
+  host->Quiesce();
+  EXPECT_TRUE(host->TryEnqueueWork([] {}, TaskPriority::kDefault));
+  host->Quiesce();
+}
+
+TEST(AdmissionControlTest, LanesHaveIndependentBudgets) {
+  auto host = CreateMultiThreadedHostContext();
+  host->SetWorkAdmissionBudget(TaskPriority::kDefault, 1);
+
+  latch started(1);
+  latch release(1);
+  ASSERT_TRUE(host->TryEnqueueWork(
+      [&] {
+        started.count_down();
+        release.wait();
+      },
+      TaskPriority::kDefault));
+  started.wait();
+
+  // The default lane is full; the high priority lane is not affected.
+  EXPECT_FALSE(host->TryEnqueueWork([] {}, TaskPriority::kDefault));
+  EXPECT_TRUE(host->TryEnqueueWork([] {}, TaskPriority::kHigh));
+  release.count_down();
+  host->Quiesce();
+}
+
+TEST(AdmissionControlTest, BackpressureBlocksUntilSlotFrees) {
+  auto host = CreateMultiThreadedHostContext();
+  host->SetWorkAdmissionBudget(TaskPriority::kDefault, 1);
+
+  latch started(1);
+  latch release(1);
+  ASSERT_TRUE(host->TryEnqueueWork(
+      [&] {
+        started.count_down();
+        release.wait();
+      },
+      TaskPriority::kDefault));
+  started.wait();
+
+  std::atomic<bool> admitted{false};
+  std::atomic<bool> ran{false};
+  std::thread submitter([&] {
+    host->EnqueueWorkWithBackpressure([&] { ran.store(true); },
+                                      TaskPriority::kDefault);
+    admitted.store(true);
+  });
+
+  // The submitter is blocked while the lane is full.
+  EXPECT_FALSE(admitted.load());
+  release.count_down();
+  submitter.join();
+  EXPECT_TRUE(admitted.load());
+  host->Quiesce();
+  EXPECT_TRUE(ran.load());
+}
+
+}  // namespace
+}  // namespace tfrt
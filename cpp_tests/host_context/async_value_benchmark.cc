@@ -0,0 +1,109 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- async_value_benchmark.cc -------------------------------------------===//
+//
+// Microbenchmarks for the AsyncValue hot paths: creation, state transition,
+// waiter registration, and teardown. These are the per-edge costs of every
+// dataflow graph the runtime executes, so per-op nanoseconds here are tracked
+// release over release.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+
+namespace tfrt {
+namespace {
+
+std::unique_ptr<HostContext> CreateBenchmarkHostContext() {
+  return std::make_unique<HostContext>([](const DecodedDiagnostic&) {},
+                                       CreateMallocAllocator(),
+                                       CreateSingleThreadedWorkQueue());
+}
+
+// Creation and teardown of an available value: the cost of returning a
+// synchronously computed result.
+void BM_MakeAvailableAsyncValue(benchmark::State& state) {
+  auto host = CreateBenchmarkHostContext();
+  for (auto _ : state) {
+    AsyncValueRef<int32_t> value = host->MakeAvailableAsyncValueRef<int32_t>(1);
+    benchmark::DoNotOptimize(value.get());
+  }
+}
+BENCHMARK(BM_MakeAvailableAsyncValue);
+
+// Creation, concretization, and teardown of an initially unconstructed value:
+// the full lifecycle of an asynchronously produced result.
+void BM_MakeUnconstructedAndEmplace(benchmark::State& state) {
+  auto host = CreateBenchmarkHostContext();
+  for (auto _ : state) {
+    AsyncValueRef<int32_t> value =
+        host->MakeUnconstructedAsyncValueRef<int32_t>();
+    value.emplace(1);
+    benchmark::DoNotOptimize(value.get());
+  }
+}
+BENCHMARK(BM_MakeUnconstructedAndEmplace);
+
+// AndThen on an unavailable value: allocates a NotifierListNode, links it
+// into the waiter list, and runs it on emplace.
+void BM_AndThenBeforeAvailable(benchmark::State& state) {
+  auto host = CreateBenchmarkHostContext();
+  for (auto _ : state) {
+    AsyncValueRef<int32_t> value =
+        host->MakeUnconstructedAsyncValueRef<int32_t>();
+    int32_t result = 0;
+    value.AndThen([&result, &value]() { result = value.get(); });
+    value.emplace(1);
+    benchmark::DoNotOptimize(result);
+  }
+}
+BENCHMARK(BM_AndThenBeforeAvailable);
+
+// AndThen on an already available value: no waiter node is allocated and the
+// closure runs inline.
+void BM_AndThenAfterAvailable(benchmark::State& state) {
+  auto host = CreateBenchmarkHostContext();
+  AsyncValueRef<int32_t> value = host->MakeAvailableAsyncValueRef<int32_t>(1);
+  for (auto _ : state) {
+    int32_t result = 0;
+    value.AndThen([&result, &value]() { result = value.get(); });
+    benchmark::DoNotOptimize(result);
+  }
+}
+BENCHMARK(BM_AndThenAfterAvailable);
+
+// IndirectAsyncValue creation and forwarding to an available value: the path
+// taken by non-strict kernels and unresolved result registers.
+void BM_IndirectForward(benchmark::State& state) {
+  auto host = CreateBenchmarkHostContext();
+  AsyncValueRef<int32_t> concrete =
+      host->MakeAvailableAsyncValueRef<int32_t>(1);
+  for (auto _ : state) {
+    RCReference<IndirectAsyncValue> indirect =
+        host->MakeIndirectAsyncValue();
+    indirect->ForwardTo(concrete.CopyRef());
+    benchmark::DoNotOptimize(indirect->get<int32_t>());
+  }
+}
+BENCHMARK(BM_IndirectForward);
+
+}  // namespace
+}  // namespace tfrt
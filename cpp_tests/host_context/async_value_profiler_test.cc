@@ -0,0 +1,87 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- async_value_profiler_test.cc ---------------------------------------===//
+//
+// Unit tests for the AsyncValue lifetime profiler.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/async_value_profiler.h"
+
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "tfrt/cpp_tests/test_util.h"
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/host_context.h"
+
+namespace tfrt {
+namespace {
+
+TEST(AsyncValueProfilerTest, RecordsStalls) {
+  std::unique_ptr<HostContext> host = CreateHostContext();
+
+  SetAsyncValueProfilingEnabled(true);
+  // Drop records left behind by other tests.
+  TakeTopAsyncValueStalls(-1);
+
+  static const char* const kKernelName = "test.slow_producer";
+  {
+    SetCurrentKernelForAsyncValueProfiling(kKernelName);
+    AsyncValueRef<int32_t> slow =
+        host->MakeUnconstructedAsyncValueRef<int32_t>();
+    SetCurrentKernelForAsyncValueProfiling(nullptr);
+
+    // A value that becomes available immediately: its stall should rank
+    // below the slow one.
+    AsyncValueRef<int32_t> fast = host->MakeAvailableAsyncValueRef<int32_t>(1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    slow.emplace(2);
+  }  // Both values are destroyed here; only then are they reported.
+
+  SetAsyncValueProfilingEnabled(false);
+
+  std::vector<AsyncValueLifetime> stalls = TakeTopAsyncValueStalls(10);
+  ASSERT_GE(stalls.size(), 2);
+
+  // The slow value has the largest created-to-available gap and carries the
+  // kernel attribution that was active when it was created.
+  const AsyncValueLifetime& worst = stalls[0];
+  EXPECT_EQ(worst.kernel_name, kKernelName);
+  EXPECT_GE(worst.StallNs(), uint64_t{10} * 1000 * 1000);
+  EXPECT_LE(worst.created_ns, worst.available_ns);
+  EXPECT_LE(worst.available_ns, worst.destroyed_ns);
+  EXPECT_GE(worst.StallNs(), stalls[1].StallNs());
+
+  // Draining leaves the profiler empty.
+  EXPECT_TRUE(TakeTopAsyncValueStalls(-1).empty());
+}
+
+TEST(AsyncValueProfilerTest, IgnoresValuesWhenDisabled) {
+  std::unique_ptr<HostContext> host = CreateHostContext();
+
+  SetAsyncValueProfilingEnabled(false);
+  TakeTopAsyncValueStalls(-1);
+
+  { auto value = host->MakeAvailableAsyncValueRef<int32_t>(1); }
+
+  EXPECT_TRUE(TakeTopAsyncValueStalls(-1).empty());
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,145 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- fair_scheduling_test.cc --------------------------------------------===//
+//
+// Unit tests for weighted fair scheduling between tenants on HostContext.
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/latch.h"
+#include "tfrt/support/mutex.h"
+
+namespace tfrt {
+namespace {
+
+// A single worker thread makes the dispatch order deterministic once the
+// worker is blocked and all tenant tasks are queued up.
+std::unique_ptr<HostContext> CreateSingleWorkerHostContext() {
+  return std::make_unique<HostContext>(
+      [](const DecodedDiagnostic&) { abort(); }, CreateMallocAllocator(),
+      CreateMultiThreadedWorkQueue(/*num_threads=*/1,
+                                   /*max_num_pending_blocking_tasks=*/1));
+}
+
+TEST(FairSchedulingTest, AllTenantWorkRuns) {
+  auto host = CreateSingleWorkerHostContext();
+  std::atomic<int> done{0};
+  for (int i = 0; i < 100; ++i)
+    host->EnqueueWorkForTenant(i % 3, [&] { done.fetch_add(1); });
+  host->Quiesce();
+  EXPECT_EQ(done.load(), 100);
+}
+
+TEST(FairSchedulingTest, DispatchesProportionallyToWeights) {
+  auto host = CreateSingleWorkerHostContext();
+  host->SetTenantWeight(/*tenant_id=*/1, /*weight=*/1);
+  host->SetTenantWeight(/*tenant_id=*/2, /*weight=*/4);
+
+  // Park the only worker so both tenants are fully backlogged before any
+  // tenant task is dispatched.
+  latch started(1);
+  latch release(1);
+  host->EnqueueWork([&] {
+    started.count_down();
+    release.wait();
+  });
+  started.wait();
+
+  mutex mu;
+  std::vector<int> order;
+  for (int i = 0; i < 10; ++i) {
+    host->EnqueueWorkForTenant(1, [&] {
+      mutex_lock lock(mu);
+      order.push_back(1);
+    });
+    host->EnqueueWorkForTenant(2, [&] {
+      mutex_lock lock(mu);
+      order.push_back(2);
+    });
+  }
+  release.count_down();
+  host->Quiesce();
+
+  ASSERT_EQ(order.size(), 20);
+  // With a 1:4 weight ratio, tenant 2 should receive about 8 of the first
+  // 10 dispatches. Leave a little slack for the dispatch right after the
+  // worker unblocks.
+  int tenant2_early = 0;
+  for (int i = 0; i < 10; ++i)
+    if (order[i] == 2) ++tenant2_early;
+  EXPECT_GE(tenant2_early, 7);
+}
+
+TEST(FairSchedulingTest, EqualWeightTenantsAlternate) {
+  auto host = CreateSingleWorkerHostContext();
+
+  latch started(1);
+  latch release(1);
+  host->EnqueueWork([&] {
+    started.count_down();
+    release.wait();
+  });
+  started.wait();
+
+  mutex mu;
+  std::vector<int> order;
+  for (int i = 0; i < 8; ++i) {
+    host->EnqueueWorkForTenant(1, [&] {
+      mutex_lock lock(mu);
+      order.push_back(1);
+    });
+  }
+  for (int i = 0; i < 8; ++i) {
+    host->EnqueueWorkForTenant(2, [&] {
+      mutex_lock lock(mu);
+      order.push_back(2);
+    });
+  }
+  release.count_down();
+  host->Quiesce();
+
+  // Default weights are equal, so neither tenant gets to run its whole
+  // backlog first: the first half of the dispatches includes both tenants.
+  ASSERT_EQ(order.size(), 16);
+  int tenant1_early = 0;
+  for (int i = 0; i < 8; ++i)
+    if (order[i] == 1) ++tenant1_early;
+  EXPECT_GT(tenant1_early, 0);
+  EXPECT_LT(tenant1_early, 8);
+}
+
+TEST(FairSchedulingTest, ExecutionContextCarriesTenantId) {
+  auto host = CreateSingleWorkerHostContext();
+  ExecutionContext exec_ctx(host.get());
+  EXPECT_EQ(exec_ctx.tenant_id(), 0);
+  exec_ctx.set_tenant_id(7);
+
+  std::atomic<bool> ran{false};
+  host->EnqueueWorkForTenant(exec_ctx, [&] { ran.store(true); });
+  host->Quiesce();
+  EXPECT_TRUE(ran.load());
+}
+
+}  // namespace
+}  // namespace tfrt
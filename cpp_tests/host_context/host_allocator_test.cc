@@ -0,0 +1,100 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- host_allocator_test.cc -----------------------------------*- C++ -*-===//
+//
+// Unit test for HostAllocator watermark backpressure.
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+
+#include "gtest/gtest.h"
+#include "tfrt/host_context/host_allocator.h"
+
+namespace tfrt {
+
+TEST(HostAllocatorWatermarkTest, FiresOnCrossings) {
+  auto allocator = CreateMallocAllocator();
+
+  std::atomic<bool> paused{false};
+  int id = allocator->RegisterWatermark(
+      /*low_bytes=*/1000, /*high_bytes=*/2000,
+      [&] { paused.store(true); },
+      [&] { paused.store(false); });
+
+  void* a = allocator->AllocateBytes(1500, 8);
+  EXPECT_FALSE(paused.load());
+  EXPECT_EQ(allocator->BytesInUse(), 1500u);
+
+  // Crossing above the high watermark fires on_high.
+  void* b = allocator->AllocateBytes(600, 8);
+  EXPECT_TRUE(paused.load());
+
+  // Dropping below the high watermark but not below the low one does not
+  // resume.
+  allocator->DeallocateBytes(b, 600);
+  EXPECT_TRUE(paused.load());
+
+  // Draining below the low watermark fires on_low.
+  allocator->DeallocateBytes(a, 1500);
+  EXPECT_FALSE(paused.load());
+
+  allocator->UnregisterWatermark(id);
+  EXPECT_EQ(allocator->BytesInUse(), 0u);
+}
+
+TEST(HostAllocatorWatermarkTest, ResumesOnlyBelowLow) {
+  auto allocator = CreateMallocAllocator();
+
+  std::atomic<int> high_count{0};
+  std::atomic<int> low_count{0};
+  int id = allocator->RegisterWatermark(
+      /*low_bytes=*/100, /*high_bytes=*/1000, [&] { ++high_count; },
+      [&] { ++low_count; });
+
+  void* a = allocator->AllocateBytes(600, 8);
+  void* b = allocator->AllocateBytes(600, 8);
+  EXPECT_EQ(high_count.load(), 1);
+
+  // Usage of 600 bytes is between the watermarks: still paused.
+  allocator->DeallocateBytes(b, 600);
+  EXPECT_EQ(low_count.load(), 0);
+
+  allocator->DeallocateBytes(a, 600);
+  EXPECT_EQ(low_count.load(), 1);
+
+  allocator->UnregisterWatermark(id);
+}
+
+TEST(HostAllocatorWatermarkTest, DecoratorsPropagateUsage) {
+  // The decorators track usage on the outermost allocator the client holds.
+  auto allocator = CreateSizeClassAllocator(CreateMallocAllocator());
+
+  std::atomic<bool> paused{false};
+  int id = allocator->RegisterWatermark(
+      /*low_bytes=*/1 << 10, /*high_bytes=*/1 << 20,
+      [&] { paused.store(true); }, [&] { paused.store(false); });
+
+  void* large = allocator->AllocateBytes(2 << 20, 8);
+  EXPECT_TRUE(paused.load());
+  allocator->DeallocateBytes(large, 2 << 20);
+  EXPECT_FALSE(paused.load());
+
+  allocator->UnregisterWatermark(id);
+}
+
+}  // namespace tfrt
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- host_buffer_test.cc --------------------------------------*- C++ -*-===//
+//
+// Unit test for HostBuffer, in particular the freelist pooling of
+// CreateUninitialized buffers.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/host_buffer.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "tfrt/host_context/host_allocator.h"
+
+namespace tfrt {
+
+TEST(HostBufferTest, PoolRecyclesSameSize) {
+  auto allocator = CreateMallocAllocator();
+
+  auto buffer = HostBuffer::CreateUninitialized(1000, 8, allocator.get());
+  ASSERT_TRUE(buffer);
+  void* data = buffer->data();
+  memset(data, 0xAB, 1000);
+  buffer.reset();
+
+  // The final deref put the block on the pool freelist, so a new buffer of
+  // the same size must reuse it.
+  auto recycled = HostBuffer::CreateUninitialized(1000, 8, allocator.get());
+  ASSERT_TRUE(recycled);
+  EXPECT_EQ(recycled->data(), data);
+  recycled.reset();
+
+  HostBuffer::FlushPool(allocator.get());
+}
+
+TEST(HostBufferTest, PoolKeyedByExactSize) {
+  auto allocator = CreateMallocAllocator();
+
+  auto buffer = HostBuffer::CreateUninitialized(1000, 8, allocator.get());
+  ASSERT_TRUE(buffer);
+  void* data = buffer->data();
+  buffer.reset();
+
+  // A different size must not be served from the freed block.
+  auto other = HostBuffer::CreateUninitialized(999, 8, allocator.get());
+  ASSERT_TRUE(other);
+  EXPECT_NE(other->data(), data);
+  other.reset();
+
+  HostBuffer::FlushPool(allocator.get());
+}
+
+TEST(HostBufferTest, NumaTargetedCreation) {
+  auto allocator = CreateMallocAllocator();
+
+  // The hint is best effort, so the observable contract is just a usable
+  // buffer, whether or not this machine exposes a NUMA topology.
+  int node = GetCurrentNumaNode();
+  auto buffer =
+      HostBuffer::CreateUninitialized(1 << 20, 8, allocator.get(), node);
+  ASSERT_TRUE(buffer);
+  memset(buffer->data(), 0xEF, 1 << 20);
+  buffer.reset();
+
+  HostBuffer::FlushPool(allocator.get());
+}
+
+TEST(HostBufferTest, FlushReturnsEverything) {
+  // A leak-checking allocator exits the process if any bytes are alive at
+  // destruction, so this test passing at all proves FlushPool returned the
+  // pooled blocks.
+  auto allocator = CreateLeakCheckAllocator(CreateMallocAllocator());
+
+  for (int i = 0; i < 10; ++i) {
+    auto buffer = HostBuffer::CreateUninitialized(4096, 8, allocator.get());
+    ASSERT_TRUE(buffer);
+    memset(buffer->data(), i, 4096);
+  }
+
+  HostBuffer::FlushPool(allocator.get());
+}
+
+}  // namespace tfrt
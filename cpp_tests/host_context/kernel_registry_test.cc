@@ -0,0 +1,169 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- kernel_registry_test.cc --------------------------------------------===//
+//
+// Unit tests for lazy, prefix-keyed kernel registration.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/kernel_registry.h"
+
+#include <atomic>
+
+#include "gtest/gtest.h"
+#include "tfrt/cpp_tests/test_util.h"
+#include "tfrt/host_context/host_context.h"
+
+namespace tfrt {
+namespace {
+
+std::atomic<int> aaa_registrations{0};
+std::atomic<int> bbb_registrations{0};
+
+void DummyKernel(KernelFrame* frame) {}
+
+void RegisterAaaKernels(KernelRegistry* registry) {
+  aaa_registrations.fetch_add(1);
+  registry->AddKernel("aaa.one", DummyKernel);
+  registry->AddSyncKernel("aaa.two", DummyKernel);
+}
+
+void RegisterBbbKernels(KernelRegistry* registry) {
+  bbb_registrations.fetch_add(1);
+  registry->AddKernel("bbb.one", DummyKernel);
+}
+
+class KernelRegistryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    aaa_registrations.store(0);
+    bbb_registrations.store(0);
+    host_ = CreateHostContext();
+    registry_ = host_->GetRegistry();
+  }
+
+  std::unique_ptr<HostContext> host_;
+  KernelRegistry* registry_ = nullptr;
+};
+
+TEST_F(KernelRegistryTest, LookupRunsOnlyMatchingRegistrations) {
+  registry_->AddKernelRegistration(RegisterAaaKernels, "aaa");
+  registry_->AddKernelRegistration(RegisterBbbKernels, "bbb");
+  EXPECT_EQ(aaa_registrations.load(), 0);
+  EXPECT_EQ(bbb_registrations.load(), 0);
+
+  EXPECT_NE(registry_->GetKernel("aaa.one"), KernelImplementation());
+  EXPECT_EQ(aaa_registrations.load(), 1);
+  EXPECT_EQ(bbb_registrations.load(), 0);
+
+  // Repeat lookups hit the materialized entries; nothing runs again.
+  EXPECT_TRUE(registry_->IsSyncKernel("aaa.two"));
+  EXPECT_FALSE(registry_->IsSyncKernel("aaa.one"));
+  EXPECT_EQ(aaa_registrations.load(), 1);
+
+  EXPECT_NE(registry_->GetKernel("bbb.one"), KernelImplementation());
+  EXPECT_EQ(bbb_registrations.load(), 1);
+}
+
+TEST_F(KernelRegistryTest, UntaggedRegistrationRunsOnAnyLookup) {
+  registry_->AddKernelRegistration(RegisterAaaKernels, "");
+  EXPECT_EQ(registry_->GetKernel("unrelated.kernel"), KernelImplementation());
+  EXPECT_EQ(aaa_registrations.load(), 1);
+  EXPECT_NE(registry_->GetKernel("aaa.one"), KernelImplementation());
+}
+
+TEST_F(KernelRegistryTest, MultiPrefixTagMatchesEveryListedPrefix) {
+  registry_->AddKernelRegistration(RegisterAaaKernels, "other,aaa");
+  EXPECT_EQ(registry_->GetKernel("zzz.kernel"), KernelImplementation());
+  EXPECT_EQ(aaa_registrations.load(), 0);
+  EXPECT_NE(registry_->GetKernel("aaa.one"), KernelImplementation());
+  EXPECT_EQ(aaa_registrations.load(), 1);
+}
+
+TEST_F(KernelRegistryTest, FingerprintMaterializesEverything) {
+  registry_->AddKernelRegistration(RegisterAaaKernels, "aaa");
+  registry_->AddKernelRegistration(RegisterBbbKernels, "bbb");
+
+  uint64_t fingerprint = registry_->GetFingerprint();
+  EXPECT_EQ(aaa_registrations.load(), 1);
+  EXPECT_EQ(bbb_registrations.load(), 1);
+  // A second call covers the same, now materialized, set.
+  EXPECT_EQ(registry_->GetFingerprint(), fingerprint);
+}
+
+TEST_F(KernelRegistryTest, IdsAssignedInMaterializationOrder) {
+  registry_->AddKernelRegistration(RegisterAaaKernels, "aaa");
+  registry_->AddKernelRegistration(RegisterBbbKernels, "bbb");
+
+  // bbb materializes first because it is looked up first.
+  ssize_t bbb_id = registry_->GetKernelId("bbb.one");
+  ssize_t aaa_id = registry_->GetKernelId("aaa.one");
+  ASSERT_GE(bbb_id, 0);
+  ASSERT_GE(aaa_id, 0);
+  EXPECT_LT(bbb_id, aaa_id);
+  EXPECT_EQ(registry_->GetKernelById(bbb_id), registry_->GetKernel("bbb.one"));
+  EXPECT_TRUE(registry_->IsSyncKernelById(registry_->GetKernelId("aaa.two")));
+}
+
+TEST_F(KernelRegistryTest, FreezeMaterializesAndKeepsLookupsWorking) {
+  registry_->AddKernelRegistration(RegisterAaaKernels, "aaa");
+  registry_->AddKernelRegistration(RegisterBbbKernels, "bbb");
+
+  EXPECT_FALSE(registry_->IsFrozen());
+  registry_->Freeze();
+  EXPECT_TRUE(registry_->IsFrozen());
+
+  // Freezing runs the pending registrations.
+  EXPECT_EQ(aaa_registrations.load(), 1);
+  EXPECT_EQ(bbb_registrations.load(), 1);
+
+  // Post-freeze lookups resolve through the sorted flat table.
+  ssize_t id = registry_->GetKernelId("aaa.one");
+  ASSERT_GE(id, 0);
+  EXPECT_NE(registry_->GetKernel("aaa.one"), KernelImplementation());
+  EXPECT_EQ(registry_->GetKernelById(id), registry_->GetKernel("aaa.one"));
+  EXPECT_TRUE(registry_->IsSyncKernel("aaa.two"));
+  EXPECT_EQ(registry_->GetKernelId("not.registered"), -1);
+
+  // Ids and fingerprint are unchanged by freezing again.
+  uint64_t fingerprint = registry_->GetFingerprint();
+  registry_->Freeze();
+  EXPECT_EQ(registry_->GetFingerprint(), fingerprint);
+  EXPECT_EQ(registry_->GetKernelId("aaa.one"), id);
+}
+
+TEST_F(KernelRegistryTest, EffectAnnotationsRoundTrip) {
+  registry_->AddKernel("eff.pure", DummyKernel, KernelEffect::kPure);
+  registry_->AddSyncKernel("eff.read", DummyKernel, KernelEffect::kReadsState);
+  registry_->AddKernel("eff.default", DummyKernel);
+
+  EXPECT_EQ(registry_->GetKernelEffect("eff.pure"), KernelEffect::kPure);
+  EXPECT_EQ(registry_->GetKernelEffect("eff.read"), KernelEffect::kReadsState);
+  // Unannotated registrations and unknown names report the conservative kIO.
+  EXPECT_EQ(registry_->GetKernelEffect("eff.default"), KernelEffect::kIO);
+  EXPECT_EQ(registry_->GetKernelEffect("eff.unknown"), KernelEffect::kIO);
+  EXPECT_EQ(registry_->GetKernelEffectById(registry_->GetKernelId("eff.pure")),
+            KernelEffect::kPure);
+
+  EXPECT_FALSE(KernelEffectsConflict(KernelEffect::kPure, KernelEffect::kIO));
+  EXPECT_FALSE(KernelEffectsConflict(KernelEffect::kReadsState,
+                                     KernelEffect::kReadsState));
+  EXPECT_TRUE(KernelEffectsConflict(KernelEffect::kReadsState,
+                                    KernelEffect::kWritesState));
+  EXPECT_TRUE(KernelEffectsConflict(KernelEffect::kIO, KernelEffect::kIO));
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,104 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- kernel_utils_benchmark.cc ------------------------------------------===//
+//
+// Microbenchmarks for kernel dispatch through the TFRT_KERNEL wrappers: the
+// per-kernel cost of unpacking arguments from a KernelFrame, invoking the
+// C++ function, and packing results back into AsyncValues.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/kernel_frame.h"
+#include "tfrt/host_context/kernel_utils.h"
+
+namespace tfrt {
+namespace {
+
+std::unique_ptr<HostContext> CreateBenchmarkHostContext() {
+  return std::make_unique<HostContext>([](const DecodedDiagnostic&) {},
+                                       CreateMallocAllocator(),
+                                       CreateSingleThreadedWorkQueue());
+}
+
+int32_t BenchmarkConstant() { return 42; }
+
+int32_t BenchmarkAdd(Argument<int32_t> a, Argument<int32_t> b) {
+  return *a + *b;
+}
+
+// Dispatch of a zero-argument kernel: measures the fixed wrapper overhead
+// plus result AsyncValue allocation.
+void BM_KernelDispatchNoArgs(benchmark::State& state) {
+  auto host = CreateBenchmarkHostContext();
+  KernelFrameBuilder frame(host.get());
+  for (auto _ : state) {
+    frame.Reset();
+    frame.SetNumResults(1);
+    TFRT_KERNEL(BenchmarkConstant).fn(&frame);
+    AsyncValue* result = frame.GetResultAt(0);
+    benchmark::DoNotOptimize(result->get<int32_t>());
+    result->DropRef();
+  }
+}
+BENCHMARK(BM_KernelDispatchNoArgs);
+
+// Dispatch of a two-argument kernel: adds per-argument unpacking through
+// Argument<T> to the fixed overhead above.
+void BM_KernelDispatchAdd(benchmark::State& state) {
+  auto host = CreateBenchmarkHostContext();
+  AsyncValueRef<int32_t> a = host->MakeAvailableAsyncValueRef<int32_t>(1);
+  AsyncValueRef<int32_t> b = host->MakeAvailableAsyncValueRef<int32_t>(2);
+  KernelFrameBuilder frame(host.get());
+  for (auto _ : state) {
+    frame.Reset();
+    frame.AddArg(a.GetAsyncValue());
+    frame.AddArg(b.GetAsyncValue());
+    frame.SetNumResults(1);
+    TFRT_KERNEL(BenchmarkAdd).fn(&frame);
+    AsyncValue* result = frame.GetResultAt(0);
+    benchmark::DoNotOptimize(result->get<int32_t>());
+    result->DropRef();
+  }
+}
+BENCHMARK(BM_KernelDispatchAdd);
+
+// Direct-call dispatch of the same two-argument kernel through the variant
+// emitted by TFRT_SYNC_KERNEL: no KernelFrame, just pointer arrays in and
+// result AsyncValues out.
+void BM_DirectKernelDispatchAdd(benchmark::State& state) {
+  auto host = CreateBenchmarkHostContext();
+  AsyncValueRef<int32_t> a = host->MakeAvailableAsyncValueRef<int32_t>(1);
+  AsyncValueRef<int32_t> b = host->MakeAvailableAsyncValueRef<int32_t>(2);
+  AsyncValue* args[] = {a.GetAsyncValue(), b.GetAsyncValue()};
+  SyncKernelImplementation direct_fn =
+      TfrtKernelImpl<decltype(&BenchmarkAdd), &BenchmarkAdd>::DirectInvoke;
+  for (auto _ : state) {
+    RCReference<AsyncValue> result;
+    SyncKernelInvocation inv{args, nullptr, &result, host.get()};
+    direct_fn(inv);
+    benchmark::DoNotOptimize(result->get<int32_t>());
+  }
+}
+BENCHMARK(BM_DirectKernelDispatchAdd);
+
+}  // namespace
+}  // namespace tfrt
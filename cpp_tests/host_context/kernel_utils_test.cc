@@ -0,0 +1,261 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- kernel_utils_test.cc -----------------------------------------------===//
+//
+// Unit tests for the direct-call variant emitted by TFRT_SYNC_KERNEL and
+// the kernel signature derived by TFRT_KERNEL.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/kernel_utils.h"
+
+#include "gtest/gtest.h"
+#include "tfrt/cpp_tests/test_util.h"
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/kernel_registry.h"
+
+namespace tfrt {
+namespace {
+
+int32_t TestAdd(int32_t a, int32_t b) { return a + b; }
+
+float TestAddViaArgument(Argument<float> a, Argument<float> b) {
+  return *a + *b;
+}
+
+int32_t TestConstant(Attribute<int32_t> value) { return *value; }
+
+std::pair<int32_t, int32_t> TestMinMax(int32_t a, int32_t b) {
+  return {std::min(a, b), std::max(a, b)};
+}
+
+Chain TestSideEffect(int32_t a) { return Chain(); }
+
+void TestCopy(RemainingArguments args, RemainingResults results) {
+  for (size_t i = 0, e = results.size(); i != e; ++i)
+    results[i] = FormRef(args[i]);
+}
+
+void TestRawKernel(KernelFrame* frame) {}
+
+// A task kernel: multiplies its input by the gate value, suspending until
+// the gate becomes available.
+AsyncValueRef<int32_t> task_gate;
+
+KernelTask TestTaskMultiply(Argument<int32_t> in, Result<int32_t> out) {
+  auto result = out.Allocate();
+  int32_t value = *in;
+  return KernelTask([result = result.CopyRef(), value]() mutable {
+    if (!task_gate.IsAvailable()) return TaskResumption::AwaitOn(task_gate);
+    result.emplace(value * task_gate.get());
+    return TaskResumption::Done();
+  });
+}
+
+class KernelUtilsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    host_ = CreateHostContext();
+    registry_ = host_->GetRegistry();
+  }
+
+  // Invoke the direct-call variant of the named kernel with the given
+  // available arguments and attributes, returning its results.
+  SmallVector<RCReference<AsyncValue>, 4> DirectInvoke(
+      string_view name, ArrayRef<AsyncValue*> args,
+      ArrayRef<const void*> attrs, size_t num_results) {
+    SyncKernelImplementation direct_fn = registry_->GetDirectSyncKernel(name);
+    EXPECT_NE(direct_fn, nullptr);
+    SmallVector<RCReference<AsyncValue>, 4> results;
+    results.resize(num_results);
+    SyncKernelInvocation inv{args.data(), attrs.data(), results.data(),
+                             host_.get()};
+    direct_fn(inv);
+    return results;
+  }
+
+  std::unique_ptr<HostContext> host_;
+  KernelRegistry* registry_ = nullptr;
+};
+
+TEST_F(KernelUtilsTest, RegistersDirectVariant) {
+  registry_->AddSyncKernel("test.add", TFRT_SYNC_KERNEL(TestAdd));
+  registry_->AddSyncKernel("test.add.frame_only", TFRT_KERNEL(TestAdd));
+
+  EXPECT_NE(registry_->GetDirectSyncKernel("test.add"), nullptr);
+  EXPECT_EQ(registry_->GetDirectSyncKernel("test.add"),
+            registry_->GetDirectSyncKernelById(
+                registry_->GetKernelId("test.add")));
+
+  // Kernels registered without a direct variant report none.
+  EXPECT_EQ(registry_->GetDirectSyncKernel("test.add.frame_only"), nullptr);
+  EXPECT_EQ(registry_->GetDirectSyncKernel("test.unregistered"), nullptr);
+}
+
+TEST_F(KernelUtilsTest, DirectCallPlainValues) {
+  registry_->AddSyncKernel("test.add", TFRT_SYNC_KERNEL(TestAdd));
+
+  auto a = host_->MakeAvailableAsyncValueRef<int32_t>(2);
+  auto b = host_->MakeAvailableAsyncValueRef<int32_t>(3);
+  AsyncValue* args[] = {a.GetAsyncValue(), b.GetAsyncValue()};
+
+  auto results = DirectInvoke("test.add", args, {}, 1);
+  ASSERT_TRUE(results[0]->IsAvailable());
+  EXPECT_EQ(results[0]->get<int32_t>(), 5);
+}
+
+TEST_F(KernelUtilsTest, DirectCallArgumentWrapper) {
+  registry_->AddSyncKernel("test.addf", TFRT_SYNC_KERNEL(TestAddViaArgument));
+
+  auto a = host_->MakeAvailableAsyncValueRef<float>(1.5f);
+  auto b = host_->MakeAvailableAsyncValueRef<float>(2.5f);
+  AsyncValue* args[] = {a.GetAsyncValue(), b.GetAsyncValue()};
+
+  auto results = DirectInvoke("test.addf", args, {}, 1);
+  ASSERT_TRUE(results[0]->IsAvailable());
+  EXPECT_EQ(results[0]->get<float>(), 4.0f);
+}
+
+TEST_F(KernelUtilsTest, DirectCallAttribute) {
+  registry_->AddSyncKernel("test.constant", TFRT_SYNC_KERNEL(TestConstant));
+
+  int32_t value = 42;
+  const void* attrs[] = {&value};
+
+  auto results = DirectInvoke("test.constant", {}, attrs, 1);
+  ASSERT_TRUE(results[0]->IsAvailable());
+  EXPECT_EQ(results[0]->get<int32_t>(), 42);
+}
+
+TEST_F(KernelUtilsTest, DirectCallPairResult) {
+  registry_->AddSyncKernel("test.minmax", TFRT_SYNC_KERNEL(TestMinMax));
+
+  auto a = host_->MakeAvailableAsyncValueRef<int32_t>(7);
+  auto b = host_->MakeAvailableAsyncValueRef<int32_t>(4);
+  AsyncValue* args[] = {a.GetAsyncValue(), b.GetAsyncValue()};
+
+  auto results = DirectInvoke("test.minmax", args, {}, 2);
+  ASSERT_TRUE(results[0]->IsAvailable());
+  ASSERT_TRUE(results[1]->IsAvailable());
+  EXPECT_EQ(results[0]->get<int32_t>(), 4);
+  EXPECT_EQ(results[1]->get<int32_t>(), 7);
+}
+
+TEST_F(KernelUtilsTest, DirectCallChainResultReusesReadyChain) {
+  registry_->AddSyncKernel("test.side_effect",
+                           TFRT_SYNC_KERNEL(TestSideEffect));
+
+  auto a = host_->MakeAvailableAsyncValueRef<int32_t>(1);
+  AsyncValue* args[] = {a.GetAsyncValue()};
+
+  auto results = DirectInvoke("test.side_effect", args, {}, 1);
+  ASSERT_TRUE(results[0]->IsAvailable());
+  // Chain results reuse the ready chain cached in the HostContext instead of
+  // allocating a new AsyncValue.
+  EXPECT_EQ(results[0].get(), host_->GetReadyChain().GetAsyncValue());
+}
+
+TEST_F(KernelUtilsTest, RemainingResultsWriteFrameInPlace) {
+  KernelFrameBuilder frame(host_.get());
+  auto a = host_->MakeAvailableAsyncValueRef<int32_t>(5);
+  auto b = host_->MakeAvailableAsyncValueRef<int32_t>(6);
+  frame.AddArg(a.GetAsyncValue());
+  frame.AddArg(b.GetAsyncValue());
+  frame.SetNumResults(2);
+
+  TFRT_KERNEL(TestCopy).fn(&frame);
+
+  // The variadic result span aliases the frame's result slots, so the
+  // forwarded arguments land in the frame with no copy-out step.
+  EXPECT_EQ(frame.GetResultAt(0), a.GetAsyncValue());
+  EXPECT_EQ(frame.GetResultAt(1), b.GetAsyncValue());
+  frame.GetResultAt(0)->DropRef();
+  frame.GetResultAt(1)->DropRef();
+}
+
+TEST_F(KernelUtilsTest, TaskKernelSuspendsUntilAwaitedValue) {
+  task_gate = host_->MakeUnconstructedAsyncValueRef<int32_t>();
+
+  KernelFrameBuilder frame(host_.get());
+  auto in = host_->MakeAvailableAsyncValueRef<int32_t>(21);
+  frame.AddArg(in.GetAsyncValue());
+  frame.SetNumResults(1);
+
+  TFRT_KERNEL(TestTaskMultiply).fn(&frame);
+
+  // The kernel returned with its result allocated but not yet available:
+  // the task is suspended on the gate without holding a thread.
+  AsyncValue* result = frame.GetResultAt(0);
+  EXPECT_FALSE(result->IsAvailable());
+
+  task_gate.emplace(2);
+  host_->Quiesce();
+  ASSERT_TRUE(result->IsAvailable());
+  EXPECT_EQ(result->get<int32_t>(), 42);
+  result->DropRef();
+  task_gate.reset();
+
+  // The returned task is not a result; the Result<> parameter is.
+  KernelSignature signature = TFRT_KERNEL(TestTaskMultiply).signature;
+  EXPECT_EQ(signature.num_arguments, 1);
+  EXPECT_EQ(signature.num_results, 1);
+}
+
+TEST_F(KernelUtilsTest, SignatureDerivation) {
+  KernelSignature add = TFRT_KERNEL(TestAdd).signature;
+  EXPECT_EQ(add.num_arguments, 2);
+  EXPECT_EQ(add.num_attributes, 0);
+  EXPECT_EQ(add.num_results, 1);
+
+  // Attribute<T> parameters count as attributes, not arguments.
+  KernelSignature constant = TFRT_KERNEL(TestConstant).signature;
+  EXPECT_EQ(constant.num_arguments, 0);
+  EXPECT_EQ(constant.num_attributes, 1);
+  EXPECT_EQ(constant.num_results, 1);
+
+  // A pair return produces two results.
+  KernelSignature minmax = TFRT_KERNEL(TestMinMax).signature;
+  EXPECT_EQ(minmax.num_arguments, 2);
+  EXPECT_EQ(minmax.num_results, 2);
+}
+
+TEST_F(KernelUtilsTest, SignatureVariadicIsUnchecked) {
+  KernelSignature copy = TFRT_KERNEL(TestCopy).signature;
+  EXPECT_EQ(copy.num_arguments, KernelSignature::kUnchecked);
+  EXPECT_EQ(copy.num_attributes, 0);
+  EXPECT_EQ(copy.num_results, KernelSignature::kUnchecked);
+}
+
+TEST_F(KernelUtilsTest, SignatureRegistryRoundTrip) {
+  registry_->AddSyncKernel("test.add", TFRT_SYNC_KERNEL(TestAdd));
+  // A bare KernelImplementation converts to an unchecked descriptor.
+  registry_->AddKernel("test.raw", TestRawKernel);
+
+  KernelSignature add = registry_->GetKernelSignature("test.add");
+  EXPECT_EQ(add.num_arguments, 2);
+  EXPECT_EQ(add.num_attributes, 0);
+  EXPECT_EQ(add.num_results, 1);
+
+  KernelSignature raw = registry_->GetKernelSignature("test.raw");
+  EXPECT_EQ(raw.num_arguments, KernelSignature::kUnchecked);
+  EXPECT_EQ(raw.num_attributes, KernelSignature::kUnchecked);
+  EXPECT_EQ(raw.num_results, KernelSignature::kUnchecked);
+}
+
+}  // namespace
+}  // namespace tfrt
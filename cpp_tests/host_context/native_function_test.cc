@@ -0,0 +1,85 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- native_function_test.cc --------------------------------------------===//
+//
+// Unit tests for the TFRT_NATIVE_FUNCTION trampoline and NativeFunction
+// inline execution.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/native_function.h"
+
+#include "gtest/gtest.h"
+#include "tfrt/cpp_tests/test_util.h"
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/host_context.h"
+
+namespace tfrt {
+namespace {
+
+int32_t TestAdd(int32_t a, int32_t b) { return a + b; }
+
+std::pair<int32_t, int32_t> TestDivMod(int32_t a, int32_t b) {
+  return {a / b, a % b};
+}
+
+TEST(NativeFunctionTest, TrampolineUnpacksAndBoxes) {
+  auto host = CreateHostContext();
+  auto a = host->MakeAvailableAsyncValueRef<int32_t>(2);
+  auto b = host->MakeAvailableAsyncValueRef<int32_t>(3);
+  AsyncValue* args[] = {a.GetAsyncValue(), b.GetAsyncValue()};
+
+  RCReference<AsyncValue> result;
+  TFRT_NATIVE_FUNCTION(TestAdd)(args, 2, &result, 1, host.get());
+
+  ASSERT_TRUE(result->IsAvailable());
+  EXPECT_EQ(result->get<int32_t>(), 5);
+}
+
+TEST(NativeFunctionTest, TrampolinePairResult) {
+  auto host = CreateHostContext();
+  auto a = host->MakeAvailableAsyncValueRef<int32_t>(7);
+  auto b = host->MakeAvailableAsyncValueRef<int32_t>(3);
+  AsyncValue* args[] = {a.GetAsyncValue(), b.GetAsyncValue()};
+
+  RCReference<AsyncValue> results[2];
+  TFRT_NATIVE_FUNCTION(TestDivMod)(args, 2, results, 2, host.get());
+
+  ASSERT_TRUE(results[0]->IsAvailable());
+  ASSERT_TRUE(results[1]->IsAvailable());
+  EXPECT_EQ(results[0]->get<int32_t>(), 2);
+  EXPECT_EQ(results[1]->get<int32_t>(), 1);
+}
+
+TEST(NativeFunctionTest, ExecuteRunsInlineWhenArgumentsAvailable) {
+  auto host = CreateHostContext();
+  NativeFunction fn("test_add", /*argument_types=*/{}, /*result_types=*/{},
+                    TFRT_NATIVE_FUNCTION(TestAdd));
+
+  auto a = host->MakeAvailableAsyncValueRef<int32_t>(4);
+  auto b = host->MakeAvailableAsyncValueRef<int32_t>(5);
+  AsyncValue* args[] = {a.GetAsyncValue(), b.GetAsyncValue()};
+
+  RCReference<AsyncValue> result;
+  fn.Execute(args, llvm::makeMutableArrayRef(&result, 1), host.get());
+
+  // All arguments were available, so the call completed on this thread.
+  ASSERT_TRUE(result->IsAvailable());
+  EXPECT_EQ(result->get<int32_t>(), 9);
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,94 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- parallel_for_benchmark.cc ------------------------------------------===//
+//
+// Microbenchmarks for ParallelFor: block dispatch overhead and scaling with
+// the worker pool size. The compute function does a fixed amount of trivial
+// arithmetic per element, so the numbers isolate the runtime's splitting and
+// scheduling cost rather than memory bandwidth.
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+
+#include "benchmark/benchmark.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/parallel_for.h"
+#include "tfrt/support/latch.h"
+
+namespace tfrt {
+namespace {
+
+using BlockSizes = ParallelFor::BlockSizes;
+
+std::unique_ptr<HostContext> CreateBenchmarkHostContext(int num_threads) {
+  return std::make_unique<HostContext>(
+      [](const DecodedDiagnostic&) {}, CreateMallocAllocator(),
+      CreateMultiThreadedWorkQueue(num_threads, num_threads));
+}
+
+constexpr size_t kTotalSize = 100 * 1000;
+
+// Fixed block size over a fixed range: the block count (and thus dispatch
+// overhead) is constant while the argument varies the worker pool size.
+void BM_ParallelForFixedBlocks(benchmark::State& state) {
+  auto host = CreateBenchmarkHostContext(state.range(0));
+  ParallelFor pfor(host.get());
+  for (auto _ : state) {
+    std::atomic<size_t> sum{0};
+    latch done(1);
+    pfor.Execute(
+        kTotalSize, BlockSizes::Fixed(1000),
+        [&](size_t begin, size_t end) {
+          size_t local = 0;
+          for (size_t i = begin; i < end; ++i) local += i;
+          sum.fetch_add(local, std::memory_order_relaxed);
+        },
+        [&]() { done.count_down(); });
+    done.wait();
+    benchmark::DoNotOptimize(sum.load());
+  }
+  state.SetItemsProcessed(state.iterations() * kTotalSize);
+}
+BENCHMARK(BM_ParallelForFixedBlocks)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+
+// Minimum block size: lets ParallelFor pick the block count from the range
+// and pool, which is how most callers use it.
+void BM_ParallelForMinBlockSize(benchmark::State& state) {
+  auto host = CreateBenchmarkHostContext(state.range(0));
+  ParallelFor pfor(host.get());
+  for (auto _ : state) {
+    std::atomic<size_t> sum{0};
+    latch done(1);
+    pfor.Execute(
+        kTotalSize, BlockSizes::Min(100),
+        [&](size_t begin, size_t end) {
+          size_t local = 0;
+          for (size_t i = begin; i < end; ++i) local += i;
+          sum.fetch_add(local, std::memory_order_relaxed);
+        },
+        [&]() { done.count_down(); });
+    done.wait();
+    benchmark::DoNotOptimize(sum.load());
+  }
+  state.SetItemsProcessed(state.iterations() * kTotalSize);
+}
+BENCHMARK(BM_ParallelForMinBlockSize)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+
+}  // namespace
+}  // namespace tfrt
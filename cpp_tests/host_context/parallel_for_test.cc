@@ -22,6 +22,7 @@
 
 #include "tfrt/host_context/parallel_for.h"
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include <utility>
@@ -130,4 +131,40 @@ TEST(ParallelForTest, ExecuteNestedParallelism) {
   ASSERT_EQ(ranges, expected);
 }
 
+TEST(ParallelForTest, ReduceSum) {
+  auto host = CreateTestHostContext(4);
+  ParallelFor pfor(host.get());
+
+  auto result = pfor.Reduce<size_t>(
+      100, BlockSizes::Fixed(10),
+      [](size_t begin, size_t end) -> size_t {
+        size_t sum = 0;
+        for (size_t i = begin; i < end; ++i) sum += i;
+        return sum;
+      },
+      [](size_t a, size_t b) -> size_t { return a + b; });
+
+  latch barrier(1);
+  result.AndThen([&]() { barrier.count_down(); });
+  barrier.wait();
+
+  ASSERT_EQ(result.get(), 4950);
+}
+
+TEST(ParallelForTest, ReduceMax) {
+  auto host = CreateTestHostContext(4);
+  ParallelFor pfor(host.get());
+
+  auto result = pfor.Reduce<size_t>(
+      100, BlockSizes::Min(30),
+      [](size_t begin, size_t end) -> size_t { return end - 1; },
+      [](size_t a, size_t b) -> size_t { return std::max(a, b); });
+
+  latch barrier(1);
+  result.AndThen([&]() { barrier.count_down(); });
+  barrier.wait();
+
+  ASSERT_EQ(result.get(), 99);
+}
+
 }  // namespace tfrt
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- run_to_completion_work_queue_test.cc ---------------------*- C++ -*-===//
+//
+// Unit tests for the inline run-to-completion work queue.
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+
+namespace tfrt {
+namespace {
+
+std::unique_ptr<HostContext> CreateTestHostContext() {
+  return std::make_unique<HostContext>([](const DecodedDiagnostic&) {},
+                                       CreateMallocAllocator(),
+                                       CreateRunToCompletionWorkQueue());
+}
+
+TEST(RunToCompletionWorkQueueTest, EnqueueWorkRunsInline) {
+  auto host = CreateTestHostContext();
+
+  bool ran = false;
+  host->EnqueueWork([&] { ran = true; });
+  EXPECT_TRUE(ran);
+
+  bool blocking_ran = false;
+  EXPECT_TRUE(host->EnqueueBlockingWork([&] { blocking_ran = true; }));
+  EXPECT_TRUE(blocking_ran);
+}
+
+TEST(RunToCompletionWorkQueueTest, DeepChainRunsToCompletion) {
+  auto host = CreateTestHostContext();
+
+  // A continuation chain far deeper than any sane stack: the depth bound
+  // must defer instead of recursing, and everything must still complete
+  // before the outermost EnqueueWork returns.
+  constexpr int kChainLength = 100000;
+  int count = 0;
+  std::function<void()> step = [&] {
+    if (++count < kChainLength) host->EnqueueWork([&] { step(); });
+  };
+
+  host->EnqueueWork([&] { step(); });
+  EXPECT_EQ(count, kChainLength);
+
+  // Nothing can be left pending.
+  host->Quiesce();
+  EXPECT_EQ(count, kChainLength);
+}
+
+TEST(RunToCompletionWorkQueueTest, AwaitExternallyResolvedValue) {
+  auto host = CreateTestHostContext();
+
+  auto value = host->MakeUnconstructedAsyncValueRef<int>();
+  std::thread setter([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    value.emplace(42);
+  });
+
+  host->Await({FormRef(value.GetAsyncValue())});
+  EXPECT_EQ(value.get(), 42);
+  setter.join();
+}
+
+}  // namespace
+}  // namespace tfrt
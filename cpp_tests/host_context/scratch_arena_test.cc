@@ -0,0 +1,97 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- scratch_arena_test.cc ------------------------------------*- C++ -*-===//
+//
+// Unit test for the kernel-scoped scratch arena.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/scratch_arena.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace tfrt {
+
+TEST(ScratchArenaTest, BumpAllocationIsContiguous) {
+  ScratchArena arena;
+
+  char* first = arena.Allocate<char>(100);
+  ASSERT_NE(first, nullptr);
+  char* second = arena.Allocate<char>(100);
+  // Successive allocations bump through the same slab.
+  EXPECT_EQ(second, first + 100);
+  memset(first, 0xAB, 200);
+}
+
+TEST(ScratchArenaTest, ResetReusesCachedSlab) {
+  ScratchArena arena;
+
+  void* first = arena.Allocate(1000, 8);
+  ASSERT_NE(first, nullptr);
+  arena.Reset();
+
+  // The slab went to the thread-local cache, so the next allocation on this
+  // thread must land in the same slab.
+  void* second = arena.Allocate(1000, 8);
+  EXPECT_EQ(first, second);
+}
+
+TEST(ScratchArenaTest, RespectsAlignment) {
+  ScratchArena arena;
+
+  for (size_t alignment : {8, 16, 64, 256, 4096}) {
+    // An odd-sized allocation first, to leave the bump pointer misaligned.
+    arena.Allocate(13, 1);
+    void* ptr = arena.Allocate(100, alignment);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignment, 0);
+  }
+}
+
+TEST(ScratchArenaTest, OversizedAllocations) {
+  ScratchArena arena;
+
+  void* small = arena.Allocate(64, 8);
+  // Much larger than a slab: gets a dedicated block.
+  constexpr size_t kLarge = 1 << 20;
+  void* large = arena.Allocate(kLarge, 64);
+  ASSERT_NE(large, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % 64, 0);
+  memset(large, 0xCD, kLarge);
+
+  // The dedicated block must not have displaced the bump region.
+  void* next_small = arena.Allocate(64, 8);
+  EXPECT_EQ(next_small, static_cast<char*>(small) + 64);
+}
+
+TEST(ScratchArenaTest, ManySlabs) {
+  ScratchArena arena;
+
+  // Force the arena through multiple slabs and make sure every allocation
+  // stays writable.
+  for (int i = 0; i < 100; ++i) {
+    void* ptr = arena.Allocate(10000, 8);
+    ASSERT_NE(ptr, nullptr);
+    memset(ptr, i, 10000);
+  }
+  arena.Reset();
+}
+
+}  // namespace tfrt
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- size_class_allocator_test.cc -----------------------------*- C++ -*-===//
+//
+// Unit test for the size-class caching allocator.
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "tfrt/host_context/host_allocator.h"
+
+namespace tfrt {
+
+TEST(SizeClassAllocatorTest, ReusesFreedBlocks) {
+  auto allocator = CreateSizeClassAllocator(CreateMallocAllocator());
+
+  void* first = allocator->AllocateBytes(1000, 8);
+  ASSERT_NE(first, nullptr);
+  memset(first, 0xAB, 1000);
+  allocator->DeallocateBytes(first, 1000);
+
+  // Freed blocks go to the thread cache, so an allocation in the same size
+  // class must be served from it.
+  void* second = allocator->AllocateBytes(1024, 8);
+  EXPECT_EQ(first, second);
+  allocator->DeallocateBytes(second, 1024);
+}
+
+TEST(SizeClassAllocatorTest, RespectsAlignment) {
+  auto allocator = CreateSizeClassAllocator(CreateMallocAllocator());
+
+  for (size_t alignment : {16, 64, 256, 4096}) {
+    void* ptr = allocator->AllocateBytes(100, alignment);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignment, 0);
+    allocator->DeallocateBytes(ptr, 100);
+  }
+}
+
+TEST(SizeClassAllocatorTest, LargeAllocationsPassThrough) {
+  auto allocator = CreateSizeClassAllocator(CreateMallocAllocator());
+
+  constexpr size_t kLarge = 8 << 20;
+  void* ptr = allocator->AllocateBytes(kLarge, 8);
+  ASSERT_NE(ptr, nullptr);
+  memset(ptr, 0xCD, kLarge);
+  allocator->DeallocateBytes(ptr, kLarge);
+}
+
+TEST(SizeClassAllocatorTest, ConcurrentChurn) {
+  auto allocator = CreateSizeClassAllocator(CreateMallocAllocator());
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&allocator, t] {
+      std::vector<std::pair<void*, size_t>> live;
+      for (int i = 0; i < 1000; ++i) {
+        const size_t size = 64 << (i % 8);
+        void* ptr = allocator->AllocateBytes(size, 8);
+        ASSERT_NE(ptr, nullptr);
+        memset(ptr, t, size);
+        live.push_back({ptr, size});
+        if (live.size() > 16) {
+          allocator->DeallocateBytes(live.back().first, live.back().second);
+          live.pop_back();
+          allocator->DeallocateBytes(live.front().first, live.front().second);
+          live.erase(live.begin());
+        }
+      }
+      for (auto& allocation : live) {
+        allocator->DeallocateBytes(allocation.first, allocation.second);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+}
+
+}  // namespace tfrt
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- task_function_test.cc ------------------------------------*- C++ -*-===//
+//
+// Unit tests for TaskFunction, including the allocation-count guarantees of
+// its inline buffer.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/task_function.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+// Replace the global allocator for this test binary so the tests can count
+// heap allocations made while constructing and moving tasks.
+static std::atomic<size_t> global_new_count{0};
+
+void* operator new(size_t size) {
+  global_new_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = malloc(size)) return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+namespace tfrt {
+namespace {
+
+size_t AllocationCount() {
+  return global_new_count.load(std::memory_order_relaxed);
+}
+
+TEST(TaskFunctionTest, InlineCaptureDoesNotAllocate) {
+  int counter = 0;
+  // Six captured words: a typical continuation (a result AsyncValueRef plus
+  // a few pointers) and well above llvm::unique_function's inline buffer.
+  void* pointers[5] = {&counter, &counter, &counter, &counter, &counter};
+
+  const size_t before = AllocationCount();
+  {
+    TaskFunction task([pointers, &counter] {
+      ++counter;
+      (void)pointers;
+    });
+    TaskFunction moved(std::move(task));
+    EXPECT_FALSE(static_cast<bool>(task));  // NOLINT(bugprone-use-after-move)
+    moved();
+
+    TaskFunction assigned;
+    assigned = std::move(moved);
+    assigned();
+  }
+  EXPECT_EQ(AllocationCount() - before, 0);
+  EXPECT_EQ(counter, 2);
+}
+
+TEST(TaskFunctionTest, OversizedCaptureSpillsToOneAllocation) {
+  int counter = 0;
+  char big[2 * TaskFunction::kInlineFunctionSize] = {0};
+
+  const size_t before = AllocationCount();
+  {
+    TaskFunction task([big, &counter] {
+      ++counter;
+      (void)big;
+    });
+    EXPECT_EQ(AllocationCount() - before, 1);
+
+    // Moves hand over the heap pointer without reallocating.
+    TaskFunction moved(std::move(task));
+    moved();
+  }
+  EXPECT_EQ(AllocationCount() - before, 1);
+  EXPECT_EQ(counter, 1);
+}
+
+TEST(TaskFunctionTest, ResetReleasesCallable) {
+  auto owned = std::make_shared<int>(42);
+  std::weak_ptr<int> observer = owned;
+
+  TaskFunction task([owned = std::move(owned)] { (void)owned; });
+  EXPECT_TRUE(static_cast<bool>(task));
+  EXPECT_FALSE(observer.expired());
+
+  task.reset();
+  EXPECT_FALSE(static_cast<bool>(task));
+  EXPECT_TRUE(observer.expired());
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,79 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- work_queue_benchmark.cc --------------------------------------------===//
+//
+// Microbenchmarks for the concurrent work queue: task submission and
+// execution throughput across pool sizes. Submission from a non-worker
+// thread lands in one worker's deque, so the other workers drain it by
+// stealing; the per-task cost reported here includes that steal traffic.
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+
+#include "benchmark/benchmark.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+
+namespace tfrt {
+namespace {
+
+std::unique_ptr<HostContext> CreateBenchmarkHostContext(int num_threads) {
+  return std::make_unique<HostContext>(
+      [](const DecodedDiagnostic&) {}, CreateMallocAllocator(),
+      CreateMultiThreadedWorkQueue(num_threads, num_threads));
+}
+
+constexpr int64_t kTasksPerIteration = 1000;
+
+// Enqueue a batch of trivial tasks from the caller thread and wait for the
+// pool to drain them. The argument is the number of worker threads.
+void BM_EnqueueWorkThroughput(benchmark::State& state) {
+  auto host = CreateBenchmarkHostContext(state.range(0));
+  for (auto _ : state) {
+    std::atomic<int64_t> executed{0};
+    for (int64_t i = 0; i < kTasksPerIteration; ++i) {
+      host->EnqueueWork([&]() { executed++; });
+    }
+    host->Quiesce();
+    if (executed != kTasksPerIteration) state.SkipWithError("lost tasks");
+  }
+  state.SetItemsProcessed(state.iterations() * kTasksPerIteration);
+}
+BENCHMARK(BM_EnqueueWorkThroughput)->Arg(1)->Arg(4)->Arg(8);
+
+// Tasks that each enqueue a follow-up task from a worker thread: follow-ups
+// go to the producing worker's own deque, so other workers only make
+// progress by stealing. The argument is the number of worker threads.
+void BM_WorkerToWorkerThroughput(benchmark::State& state) {
+  auto host = CreateBenchmarkHostContext(state.range(0));
+  for (auto _ : state) {
+    std::atomic<int64_t> executed{0};
+    for (int64_t i = 0; i < kTasksPerIteration; ++i) {
+      host->EnqueueWork([&]() {
+        host->EnqueueWork([&]() { executed++; });
+      });
+    }
+    host->Quiesce();
+    if (executed != kTasksPerIteration) state.SkipWithError("lost tasks");
+  }
+  state.SetItemsProcessed(state.iterations() * kTasksPerIteration * 2);
+}
+BENCHMARK(BM_WorkerToWorkerThroughput)->Arg(1)->Arg(4)->Arg(8);
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,118 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- async_value_combinators_test.cc ------------------------------------===//
+//
+// This file contains unit tests for WhenAll, Map and FlatMap.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/async_value_combinators.h"
+
+#include "gtest/gtest.h"
+#include "tfrt/cpp_tests/test_util.h"
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/support/ref_count.h"
+
+namespace tfrt {
+namespace {
+
+TEST(AsyncValueCombinators, MapAvailable) {
+  std::unique_ptr<HostContext> host = CreateHostContext();
+
+  auto value = host->MakeAvailableAsyncValueRef<int32_t>(42);
+  auto result = Map(host.get(), value, [](int32_t& v) { return v + 1; });
+
+  ASSERT_TRUE(result.IsConcrete());
+  EXPECT_EQ(result.get(), 43);
+}
+
+TEST(AsyncValueCombinators, MapUnavailable) {
+  std::unique_ptr<HostContext> host = CreateHostContext();
+
+  auto value = host->MakeUnconstructedAsyncValueRef<int32_t>();
+  auto result = Map(host.get(), value, [](int32_t& v) { return v * 2; });
+
+  EXPECT_TRUE(result.IsUnavailable());
+  value.emplace(21);
+
+  ASSERT_TRUE(result.IsConcrete());
+  EXPECT_EQ(result.get(), 42);
+}
+
+TEST(AsyncValueCombinators, MapError) {
+  std::unique_ptr<HostContext> host = CreateHostContext();
+
+  AsyncValueRef<int32_t> value = host->MakeErrorAsyncValueRef("test error");
+  auto result = Map(host.get(), value, [](int32_t& v) { return v + 1; });
+
+  EXPECT_TRUE(result.IsError());
+}
+
+TEST(AsyncValueCombinators, FlatMap) {
+  std::unique_ptr<HostContext> host = CreateHostContext();
+
+  auto value = host->MakeUnconstructedAsyncValueRef<int32_t>();
+  auto result = FlatMap(host.get(), value, [&](int32_t& v) {
+    return host->MakeAvailableAsyncValueRef<int32_t>(v + 1);
+  });
+
+  EXPECT_TRUE(result.IsUnavailable());
+  value.emplace(41);
+
+  ASSERT_TRUE(result.IsConcrete());
+  EXPECT_EQ(result.get(), 42);
+}
+
+TEST(AsyncValueCombinators, WhenAll) {
+  std::unique_ptr<HostContext> host = CreateHostContext();
+
+  auto a = host->MakeUnconstructedAsyncValueRef<int32_t>();
+  auto b = host->MakeUnconstructedAsyncValueRef<int32_t>();
+
+  RCReference<AsyncValue> values[2] = {a.CopyRCRef(), b.CopyRCRef()};
+  auto chain = WhenAll(host.get(), values);
+
+  EXPECT_TRUE(chain.IsUnavailable());
+  a.emplace(1);
+  EXPECT_TRUE(chain.IsUnavailable());
+  b.emplace(2);
+  EXPECT_TRUE(chain.IsConcrete());
+}
+
+TEST(AsyncValueCombinators, WhenAllReady) {
+  std::unique_ptr<HostContext> host = CreateHostContext();
+
+  auto a = host->MakeAvailableAsyncValueRef<int32_t>(1);
+  RCReference<AsyncValue> values[1] = {a.CopyRCRef()};
+
+  auto chain = WhenAll(host.get(), values);
+  EXPECT_TRUE(chain.IsConcrete());
+}
+
+TEST(AsyncValueCombinators, WhenAllError) {
+  std::unique_ptr<HostContext> host = CreateHostContext();
+
+  auto a = host->MakeUnconstructedAsyncValueRef<int32_t>();
+  RCReference<AsyncValue> values[1] = {a.CopyRCRef()};
+
+  auto chain = WhenAll(host.get(), values);
+  EXPECT_TRUE(chain.IsUnavailable());
+
+  a.SetError("test error");
+  EXPECT_TRUE(chain.IsError());
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- metrics_api_test.cc --------------------------------------*- C++ -*-===//
+//
+// Unit test for the default metrics implementation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/metrics/metrics_api.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace tfrt {
+namespace metrics {
+
+// The registry is process-global, so each test uses uniquely named metrics
+// and finds them by name in the snapshot.
+const MetricSnapshot* FindMetric(const std::vector<MetricSnapshot>& snapshots,
+                                 const std::string& name) {
+  for (const MetricSnapshot& snapshot : snapshots) {
+    if (snapshot.name == name) return &snapshot;
+  }
+  return nullptr;
+}
+
+TEST(MetricsApiTest, CounterSumsShards) {
+  Counter<int64_t>* counter = NewCounter<int64_t>("test_counter");
+
+  // Increment from several threads so multiple shards get populated.
+  constexpr int kNumThreads = 4;
+  constexpr int kAddsPerThread = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < kAddsPerThread; ++i) counter->Add(2);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  const auto* snapshot = FindMetric(SnapshotMetrics(), "test_counter");
+  ASSERT_NE(snapshot, nullptr);
+  EXPECT_EQ(snapshot->kind, MetricSnapshot::Kind::kCounter);
+  EXPECT_EQ(snapshot->int_value, 2 * kNumThreads * kAddsPerThread);
+}
+
+TEST(MetricsApiTest, HistogramBucketsByPowerOfTwo) {
+  Histogram* histogram = NewHistogram("test_histogram");
+  histogram->Record(1);    // bucket 0
+  histogram->Record(2);    // bucket 1
+  histogram->Record(3);    // bucket 2
+  histogram->Record(100);  // bucket 7
+
+  const auto* snapshot = FindMetric(SnapshotMetrics(), "test_histogram");
+  ASSERT_NE(snapshot, nullptr);
+  EXPECT_EQ(snapshot->kind, MetricSnapshot::Kind::kHistogram);
+  EXPECT_EQ(snapshot->histogram_buckets[0], 1);
+  EXPECT_EQ(snapshot->histogram_buckets[1], 1);
+  EXPECT_EQ(snapshot->histogram_buckets[2], 1);
+  EXPECT_EQ(snapshot->histogram_buckets[7], 1);
+}
+
+TEST(MetricsApiTest, GaugeKeepsLastValue) {
+  Gauge<std::string>* gauge = NewGauge<std::string>("test_gauge");
+  gauge->SetValue("first");
+  gauge->SetValue("second");
+
+  const auto* snapshot = FindMetric(SnapshotMetrics(), "test_gauge");
+  ASSERT_NE(snapshot, nullptr);
+  EXPECT_EQ(snapshot->kind, MetricSnapshot::Kind::kGauge);
+  EXPECT_EQ(snapshot->string_value, "second");
+}
+
+}  // namespace metrics
+}  // namespace tfrt
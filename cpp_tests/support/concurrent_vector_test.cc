@@ -41,6 +41,21 @@ TEST(ConcurrentVectorTest, SingleThreaded) {
   }
 }
 
+TEST(ConcurrentVectorTest, ReferencesStableAcrossGrowth) {
+  tfrt::ConcurrentVector<int> vec(1);
+
+  constexpr int kCount = 1000;
+
+  // Elements live in fixed segments, so a reference taken before many rounds
+  // of growth still points at the element afterwards.
+  vec.emplace_back(42);
+  const int* first = &vec[0];
+  for (int i = 1; i < kCount; ++i) vec.emplace_back(i);
+
+  EXPECT_EQ(first, &vec[0]);
+  EXPECT_EQ(42, *first);
+}
+
 TEST(ConcurrentVectorTest, OneWriterOneReader) {
   tfrt::ConcurrentVector<int> vec(1);
 
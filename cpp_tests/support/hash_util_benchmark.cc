@@ -0,0 +1,65 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- hash_util_benchmark.cc ---------------------------------------------===//
+//
+// Microbenchmarks for Hash64 across the key sizes that matter for name
+// interning: kernel, op and attribute names are mostly 8-32 bytes, with the
+// occasional long mangled name exercising the wide path.
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "tfrt/support/hash_util.h"
+
+namespace tfrt {
+namespace {
+
+std::string MakeKey(size_t size) {
+  std::string key(size, 'x');
+  for (size_t i = 0; i < size; ++i) key[i] = 'a' + (i * 13 + 7) % 26;
+  return key;
+}
+
+void BM_Hash64(benchmark::State& state) {
+  const std::string key = MakeKey(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Hash64(key.data(), key.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * key.size());
+}
+// 8-32 bytes covers typical names ("tfrt.add.i32", "data.tf_record_dataset");
+// the larger sizes exercise the mid-range and striped wide paths.
+BENCHMARK(BM_Hash64)
+    ->Arg(8)
+    ->Arg(16)
+    ->Arg(32)
+    ->Arg(64)
+    ->Arg(128)
+    ->Arg(1 << 10)
+    ->Arg(64 << 10);
+
+void BM_Hash32(benchmark::State& state) {
+  const std::string key = MakeKey(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Hash32(key.data(), key.size(), 0));
+  }
+  state.SetBytesProcessed(state.iterations() * key.size());
+}
+BENCHMARK(BM_Hash32)->Arg(8)->Arg(16)->Arg(32)->Arg(1 << 10);
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,122 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- hash_util_test.cc --------------------------------------------------===//
+//
+// Unit tests for Hash64, covering every length-class boundary of its
+// dispatch (empty, 1-3, 4-7, 8-16, 17-32, 33-128, and the long striped
+// loop) and checking the runtime-dispatched long-input path against the
+// scalar reference implementation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/support/hash_util.h"
+
+#include <cstring>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace tfrt {
+namespace {
+
+// Lengths on and around every dispatch boundary of Hash64, plus a long
+// input well into the striped loop.
+constexpr size_t kBoundaryLengths[] = {0,  1,  2,   3,   4,   5,   7,    8,
+                                       9,  15, 16,  17,  31,  32,  33,   63,
+                                       64, 65, 127, 128, 129, 192, 1024, 8192};
+
+std::string TestBuffer(size_t n) {
+  std::string buffer(n, '\0');
+  // A fixed pseudo-random fill so every byte differs from its neighbors.
+  uint32_t state = 0x2545F491u + static_cast<uint32_t>(n);
+  for (size_t i = 0; i < n; ++i) {
+    state = state * 1664525u + 1013904223u;
+    buffer[i] = static_cast<char>(state >> 24);
+  }
+  return buffer;
+}
+
+TEST(Hash64Test, DeterministicAndLengthSensitive) {
+  std::set<uint64_t> seen;
+  const std::string buffer = TestBuffer(8192);
+  for (size_t n : kBoundaryLengths) {
+    uint64_t h = Hash64(buffer.data(), n, 0);
+    EXPECT_EQ(h, Hash64(buffer.data(), n, 0)) << "n=" << n;
+    // Prefixes of the same buffer must hash differently.
+    EXPECT_TRUE(seen.insert(h).second) << "n=" << n;
+  }
+}
+
+TEST(Hash64Test, SeedChangesHash) {
+  for (size_t n : kBoundaryLengths) {
+    const std::string buffer = TestBuffer(n);
+    EXPECT_NE(Hash64(buffer.data(), n, 0), Hash64(buffer.data(), n, 1))
+        << "n=" << n;
+  }
+}
+
+TEST(Hash64Test, EveryByteAffectsHash) {
+  for (size_t n : kBoundaryLengths) {
+    std::string buffer = TestBuffer(n);
+    const uint64_t h = Hash64(buffer.data(), n, 0);
+    for (size_t i = 0; i < n; ++i) {
+      buffer[i] ^= 0x40;
+      EXPECT_NE(Hash64(buffer.data(), n, 0), h) << "n=" << n << " i=" << i;
+      buffer[i] ^= 0x40;
+    }
+  }
+}
+
+TEST(Hash64Test, AlignmentDoesNotAffectHash) {
+  const std::string buffer = TestBuffer(192);
+  for (size_t n : kBoundaryLengths) {
+    if (n > buffer.size()) continue;
+    const uint64_t h = Hash64(buffer.data(), n, 0);
+    std::vector<char> shifted(n + 16);
+    for (size_t offset = 1; offset <= 8; ++offset) {
+      std::memcpy(shifted.data() + offset, buffer.data(), n);
+      EXPECT_EQ(Hash64(shifted.data() + offset, n, 0), h)
+          << "n=" << n << " offset=" << offset;
+    }
+  }
+}
+
+// The long-input loop is dispatched at runtime (AVX2 on x86-64 hosts that
+// support it, scalar otherwise); all variants must produce identical
+// values. On an AVX2 host this compares the AVX2 loop against the scalar
+// reference byte for byte; elsewhere it is trivially scalar vs scalar.
+TEST(Hash64Test, DispatchedLongPathMatchesScalar) {
+  std::mt19937 rng(42);
+  std::vector<size_t> lengths;
+  // Every stripe-tail phase right above the dispatch boundary, then a
+  // spread of longer inputs.
+  for (size_t n = 129; n <= 260; ++n) lengths.push_back(n);
+  for (int i = 0; i < 64; ++i) lengths.push_back(261 + rng() % 16384);
+
+  for (size_t n : lengths) {
+    std::string buffer(n, '\0');
+    for (char& c : buffer) c = static_cast<char>(rng());
+    const uint64_t seed = (static_cast<uint64_t>(rng()) << 32) | rng();
+    EXPECT_EQ(Hash64(buffer.data(), n, seed),
+              internal::Hash64LongScalar(buffer.data(), n, seed))
+        << "n=" << n << " avx2=" << internal::Hash64LongUsesAvx2();
+  }
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,89 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- ref_count_test.cc ----------------------------------------*- C++ -*-===//
+//
+// Tests for reference counting utilities.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/support/ref_count.h"
+
+#include "gtest/gtest.h"
+
+namespace tfrt {
+namespace {
+
+class Counted : public ReferenceCounted<Counted> {
+ public:
+  explicit Counted(bool* destroyed) : destroyed_(destroyed) {}
+
+ private:
+  friend class ReferenceCounted<Counted>;
+  void Destroy() {
+    *destroyed_ = true;
+    delete this;
+  }
+
+  bool* destroyed_;
+};
+
+TEST(RefCountTest, BatchedAddAndDropRef) {
+  bool destroyed = false;
+  auto* counted = new Counted(&destroyed);
+
+  counted->AddRef(3);
+  counted->DropRef(2);
+  ASSERT_FALSE(destroyed);
+
+  counted->DropRef(2);  // drops the batched ref and the constructor ref
+  ASSERT_TRUE(destroyed);
+}
+
+TEST(RefCountTest, BatchTakeAllReferences) {
+  bool destroyed = false;
+  auto* counted = new Counted(&destroyed);
+
+  {
+    RCReferenceBatch<Counted> batch(counted, 2);
+    ASSERT_EQ(batch.remaining(), 2);
+
+    RCReference<Counted> a = batch.TakeRef();
+    RCReference<Counted> b = batch.TakeRef();
+    ASSERT_EQ(batch.remaining(), 0);
+
+    counted->DropRef();  // drop the constructor ref
+    ASSERT_FALSE(destroyed);
+  }
+
+  ASSERT_TRUE(destroyed);
+}
+
+TEST(RefCountTest, BatchReturnsUnusedReferences) {
+  bool destroyed = false;
+  auto* counted = new Counted(&destroyed);
+
+  {
+    RCReferenceBatch<Counted> batch(counted, 4);
+    RCReference<Counted> a = batch.TakeRef();
+    ASSERT_EQ(batch.remaining(), 3);
+  }  // unused references are dropped in a single decrement
+
+  ASSERT_FALSE(destroyed);
+  counted->DropRef();  // drop the constructor ref
+  ASSERT_TRUE(destroyed);
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,74 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- string_interner_test.cc --------------------------------------------===//
+//
+// Unit tests for the process-wide name intern table.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/support/string_interner.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace tfrt {
+namespace {
+
+// The global interner is shared by the whole test binary, so all tests use
+// unique names and relative size checks.
+
+TEST(StringInternerTest, SameStringProducesSameHandle) {
+  auto& interner = StringInterner::Global();
+
+  InternedName a = interner.Intern("string_interner_test.matmul");
+  InternedName b =
+      interner.Intern(std::string("string_interner_test.matmul"));
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(a.c_str(), b.c_str());
+  EXPECT_EQ(a.id(), b.id());
+  EXPECT_EQ(a.str(), "string_interner_test.matmul");
+  EXPECT_STREQ(a.c_str(), "string_interner_test.matmul");
+
+  InternedName c = interner.Intern("string_interner_test.relu");
+  EXPECT_NE(a, c);
+  EXPECT_NE(a.id(), c.id());
+}
+
+TEST(StringInternerTest, FindDoesNotInsert) {
+  auto& interner = StringInterner::Global();
+
+  const size_t size_before = interner.size();
+  EXPECT_FALSE(interner.Find("string_interner_test.never_interned"));
+  EXPECT_EQ(interner.size(), size_before);
+
+  InternedName name = interner.Intern("string_interner_test.transpose");
+  EXPECT_EQ(interner.Find("string_interner_test.transpose"), name);
+}
+
+TEST(StringInternerTest, IdsAreDenseAndRoundTrip) {
+  auto& interner = StringInterner::Global();
+
+  InternedName a = interner.Intern("string_interner_test.dense_a");
+  InternedName b = interner.Intern("string_interner_test.dense_b");
+  EXPECT_EQ(b.id(), a.id() + 1);
+
+  EXPECT_EQ(interner.FromId(a.id()), a);
+  EXPECT_EQ(interner.FromId(b.id()), b);
+  EXPECT_LT(a.id(), interner.size());
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- checkpoint_test.cc ---------------------------------------*- C++ -*-===//
+//
+// Unit test for parallel multi-file checkpoint save and restore.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/checkpoint.h"
+
+#include <cstdint>
+#include <cstdio>
+
+#include "gtest/gtest.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/tensor/tensor_metadata.h"
+#include "tfrt/tensor/tensor_shape.h"
+
+namespace tfrt {
+namespace {
+
+std::unique_ptr<HostContext> CreateTestHostContext() {
+  return std::make_unique<HostContext>([](const DecodedDiagnostic&) {},
+                                       CreateMallocAllocator(),
+                                       CreateMultiThreadedWorkQueue(4, 4));
+}
+
+DenseHostTensor MakeTestTensor(int32_t seed, ssize_t num_elements,
+                               HostContext* host) {
+  TensorMetadata metadata(GetDType<int32_t>(), TensorShape({num_elements}));
+  auto dht = DenseHostTensor::CreateUninitialized(metadata, host);
+  auto* data = static_cast<int32_t*>(dht->data());
+  for (ssize_t i = 0; i < num_elements; ++i) data[i] = seed + i;
+  return std::move(*dht);
+}
+
+void RemoveCheckpointFiles(const std::string& prefix, int num_shards) {
+  std::remove(CheckpointManifestPath(prefix).c_str());
+  for (int shard = 0; shard != num_shards; ++shard) {
+    std::remove(CheckpointShardPath(prefix, shard, num_shards).c_str());
+  }
+}
+
+TEST(CheckpointTest, SaveRestoreRoundTrip) {
+  auto host = CreateTestHostContext();
+  const std::string prefix = "/tmp/tfrt_checkpoint_test";
+  const int num_shards = 3;
+
+  // Mixed sizes, so the byte-balancing shard assignment is exercised.
+  std::vector<DenseHostTensor> tensors;
+  const ssize_t sizes[] = {1000, 10, 300, 1, 64, 7};
+  for (int i = 0; i < 6; ++i) {
+    tensors.push_back(MakeTestTensor(/*seed=*/100 * i, sizes[i], host.get()));
+  }
+
+  auto chain = SaveCheckpoint(std::move(tensors), prefix, num_shards,
+                              host.get());
+  host->Await({chain.CopyRCRef()});
+  ASSERT_FALSE(chain.IsError()) << chain.GetError().message;
+
+  auto restored = RestoreCheckpoint(prefix, host.get());
+  host->Await({restored.CopyRCRef()});
+  ASSERT_FALSE(restored.IsError()) << restored.GetError().message;
+
+  auto& result = restored.get();
+  ASSERT_EQ(result.size(), 6);
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_EQ(result[i].NumElements(), sizes[i]);
+    auto* data = static_cast<const int32_t*>(result[i].data());
+    for (ssize_t j = 0; j < sizes[i]; ++j) {
+      ASSERT_EQ(data[j], 100 * i + j);
+    }
+  }
+  RemoveCheckpointFiles(prefix, num_shards);
+}
+
+TEST(CheckpointTest, RestoreMissingManifestFails) {
+  auto host = CreateTestHostContext();
+  auto restored =
+      RestoreCheckpoint("/tmp/tfrt_checkpoint_test_missing", host.get());
+  host->Await({restored.CopyRCRef()});
+  EXPECT_TRUE(restored.IsError());
+}
+
+TEST(CheckpointTest, MoreShardsThanTensorsClampsShardCount) {
+  auto host = CreateTestHostContext();
+  const std::string prefix = "/tmp/tfrt_checkpoint_test_clamp";
+
+  std::vector<DenseHostTensor> tensors;
+  tensors.push_back(MakeTestTensor(/*seed=*/7, 5, host.get()));
+  auto chain = SaveCheckpoint(std::move(tensors), prefix, /*num_shards=*/8,
+                              host.get());
+  host->Await({chain.CopyRCRef()});
+  ASSERT_FALSE(chain.IsError()) << chain.GetError().message;
+
+  auto restored = RestoreCheckpoint(prefix, host.get());
+  host->Await({restored.CopyRCRef()});
+  ASSERT_FALSE(restored.IsError()) << restored.GetError().message;
+  ASSERT_EQ(restored.get().size(), 1);
+  EXPECT_EQ(static_cast<const int32_t*>(restored.get()[0].data())[4], 11);
+  RemoveCheckpointFiles(prefix, /*num_shards=*/1);
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- dense_constant_pool_test.cc ------------------------------*- C++ -*-===//
+//
+// Unit test for content-hash-based constant deduplication.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/dense_constant_pool.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/tensor/tensor_shape.h"
+
+namespace tfrt {
+namespace {
+
+std::unique_ptr<HostContext> CreateTestHostContext() {
+  return std::make_unique<HostContext>([](const DecodedDiagnostic&) {},
+                                       CreateMallocAllocator(),
+                                       CreateSingleThreadedWorkQueue());
+}
+
+TEST(DenseConstantPoolTest, IdenticalConstantsShareOneBuffer) {
+  auto host = CreateTestHostContext();
+  auto& pool = host->GetOrCreateSharedContext<DenseConstantPool>();
+
+  TensorMetadata metadata(GetDType<int32_t>(), TensorShape({4}));
+  const int32_t weights[] = {1, 2, 3, 4};
+
+  // As if the same weights appeared in two concurrently loaded BEF files.
+  auto a = pool.GetOrCreateConstant(metadata, weights);
+  auto b = pool.GetOrCreateConstant(metadata, weights);
+  ASSERT_FALSE(!a);
+  ASSERT_FALSE(!b);
+  EXPECT_EQ(a->data(), b->data());
+
+  // The pooled copy does not alias the source.
+  EXPECT_NE(a->data(), static_cast<const void*>(weights));
+  EXPECT_EQ(0, std::memcmp(a->data(), weights, sizeof(weights)));
+}
+
+TEST(DenseConstantPoolTest, DifferentMetadataDoesNotCollide) {
+  auto host = CreateTestHostContext();
+  auto& pool = host->GetOrCreateSharedContext<DenseConstantPool>();
+
+  // Same bytes viewed as different shapes must stay distinct constants.
+  const int32_t weights[] = {1, 2, 3, 4};
+  auto flat = pool.GetOrCreateConstant(
+      TensorMetadata(GetDType<int32_t>(), TensorShape({4})), weights);
+  auto square = pool.GetOrCreateConstant(
+      TensorMetadata(GetDType<int32_t>(), TensorShape({2, 2})), weights);
+  ASSERT_FALSE(!flat);
+  ASSERT_FALSE(!square);
+  EXPECT_NE(flat->data(), square->data());
+}
+
+TEST(DenseConstantPoolTest, DropUnusedConstantsReleasesDeadEntries) {
+  auto host = CreateTestHostContext();
+  auto& pool = host->GetOrCreateSharedContext<DenseConstantPool>();
+
+  TensorMetadata metadata(GetDType<int32_t>(), TensorShape({4}));
+  const int32_t live_weights[] = {1, 2, 3, 4};
+  const int32_t dead_weights[] = {5, 6, 7, 8};
+
+  auto live = pool.GetOrCreateConstant(metadata, live_weights);
+  ASSERT_FALSE(!live);
+  {
+    auto dead = pool.GetOrCreateConstant(metadata, dead_weights);
+    ASSERT_FALSE(!dead);
+  }
+
+  // Only the entry whose last tensor was destroyed is dropped.
+  EXPECT_EQ(pool.DropUnusedConstants(), 1);
+  EXPECT_EQ(pool.DropUnusedConstants(), 0);
+
+  // A re-sighting after the drop repopulates the pool.
+  auto revived = pool.GetOrCreateConstant(metadata, dead_weights);
+  ASSERT_FALSE(!revived);
+  EXPECT_EQ(0, std::memcmp(revived->data(), dead_weights,
+                           sizeof(dead_weights)));
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- dense_host_tensor_test.cc --------------------------------*- C++ -*-===//
+//
+// Unit test for DenseHostTensor copy-on-write semantics.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/dense_host_tensor.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/tensor/tensor_metadata.h"
+#include "tfrt/tensor/tensor_shape.h"
+
+namespace tfrt {
+
+TEST(DenseHostTensorTest, CopyRefSharesBuffer) {
+  auto allocator = CreateMallocAllocator();
+  TensorMetadata metadata(GetDType<int32_t>(), TensorShape({4}));
+
+  auto tensor = DenseHostTensor::CreateUninitialized(metadata, allocator.get());
+  ASSERT_TRUE(tensor.hasValue());
+  EXPECT_TRUE(tensor->IsUnique());
+
+  DenseHostTensor copy = tensor->CopyRef();
+  EXPECT_EQ(copy.data(), tensor->data());
+  EXPECT_FALSE(tensor->IsUnique());
+  EXPECT_FALSE(copy.IsUnique());
+}
+
+TEST(DenseHostTensorTest, MutableDataClonesSharedBuffer) {
+  auto allocator = CreateMallocAllocator();
+  TensorMetadata metadata(GetDType<int32_t>(), TensorShape({4}));
+
+  auto tensor = DenseHostTensor::CreateUninitialized(metadata, allocator.get());
+  ASSERT_TRUE(tensor.hasValue());
+  auto* data = static_cast<int32_t*>(tensor->data());
+  for (int i = 0; i < 4; ++i) data[i] = i;
+
+  DenseHostTensor copy = tensor->CopyRef();
+  auto* copy_data =
+      static_cast<int32_t*>(copy.MutableData(allocator.get()));
+  ASSERT_NE(copy_data, nullptr);
+
+  // The write barrier cloned the shared buffer and both tensors are unique
+  // owners again.
+  EXPECT_NE(copy_data, tensor->data());
+  EXPECT_TRUE(tensor->IsUnique());
+  EXPECT_TRUE(copy.IsUnique());
+
+  // The clone preserved the element data, and writes through it are not
+  // observed by the original tensor.
+  EXPECT_EQ(copy_data[3], 3);
+  copy_data[3] = 42;
+  EXPECT_EQ(static_cast<const int32_t*>(tensor->data())[3], 3);
+}
+
+TEST(DenseHostTensorTest, MutableDataIsInPlaceOnUniqueBuffer) {
+  auto allocator = CreateMallocAllocator();
+  TensorMetadata metadata(GetDType<int32_t>(), TensorShape({4}));
+
+  auto tensor = DenseHostTensor::CreateUninitialized(metadata, allocator.get());
+  ASSERT_TRUE(tensor.hasValue());
+
+  // No sharing, so the barrier hands out the existing buffer.
+  EXPECT_EQ(tensor->MutableData(allocator.get()), tensor->data());
+
+  // Dropping the only copy re-uniquifies the original.
+  {
+    DenseHostTensor copy = tensor->CopyRef();
+    EXPECT_FALSE(tensor->IsUnique());
+  }
+  EXPECT_TRUE(tensor->IsUnique());
+  EXPECT_EQ(tensor->MutableData(allocator.get()), tensor->data());
+}
+
+}  // namespace tfrt
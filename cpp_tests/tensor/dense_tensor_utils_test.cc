@@ -0,0 +1,139 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- dense_tensor_utils_test.cc -------------------------------*- C++ -*-===//
+//
+// Unit tests for the parallel DenseHostTensor comparison utilities.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/dense_tensor_utils.h"
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/diagnostic.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/latch.h"
+#include "tfrt/tensor/dense_host_tensor_view.h"
+
+namespace tfrt {
+namespace {
+
+std::unique_ptr<HostContext> CreateTestHostContext(int num_threads) {
+  return std::make_unique<HostContext>(
+      [](const DecodedDiagnostic&) {}, CreateMallocAllocator(),
+      CreateMultiThreadedWorkQueue(num_threads, num_threads));
+}
+
+DenseHostTensor CreateIotaTensor(HostContext* host, ssize_t num_elements) {
+  auto dht = DenseHostTensor::CreateUninitialized<float>(
+      TensorShape({num_elements}), host);
+  assert(dht.hasValue());
+  MutableDHTArrayView<float> view(dht.getPointer());
+  for (ssize_t i = 0; i < num_elements; ++i) view[i] = i * 0.5f;
+  return std::move(*dht);
+}
+
+template <typename T>
+T AwaitResult(const AsyncValueRef<T>& result) {
+  latch done(1);
+  result.AndThen([&]() { done.count_down(); });
+  done.wait();
+  return result.get();
+}
+
+TEST(DenseTensorUtilsTest, BitwiseEqual) {
+  auto host = CreateTestHostContext(4);
+
+  auto a = CreateIotaTensor(host.get(), 1024);
+  auto b = CreateIotaTensor(host.get(), 1024);
+  EXPECT_TRUE(TensorsBitwiseEqual(a, b));
+
+  MutableDHTArrayView<float>(&b)[1000] += 1.0f;
+  EXPECT_FALSE(TensorsBitwiseEqual(a, b));
+
+  // Same bytes but a different shape must not compare equal.
+  auto c = DenseHostTensor::CreateUninitialized<float>(TensorShape({2, 512}),
+                                                       host.get());
+  ASSERT_TRUE(c.hasValue());
+  std::memcpy(c->data(), a.data(), a.DataSizeInBytes());
+  EXPECT_FALSE(TensorsBitwiseEqual(a, *c));
+}
+
+TEST(DenseTensorUtilsTest, FindFirstMismatchReportsSmallestIndex) {
+  auto host = CreateTestHostContext(4);
+
+  // Large enough to split into multiple parallel blocks.
+  constexpr ssize_t kNumElements = 1 << 20;
+  auto a = CreateIotaTensor(host.get(), kNumElements);
+  auto b = CreateIotaTensor(host.get(), kNumElements);
+
+  auto equal = [](float x, float y) { return x == y; };
+  DHTArrayView<float> va(&a);
+  DHTArrayView<float> vb(&b);
+
+  EXPECT_EQ(AwaitResult(FindFirstMismatch<float>(va, vb, equal, host.get())),
+            kNoElementMismatch);
+
+  // Plant mismatches in two different blocks; the smaller index wins.
+  MutableDHTArrayView<float> mb(&b);
+  mb[kNumElements - 1] = -1.0f;
+  mb[123456] = -1.0f;
+  EXPECT_EQ(AwaitResult(FindFirstMismatch<float>(va, vb, equal, host.get())),
+            123456);
+}
+
+TEST(DenseTensorUtilsTest, AllElementsCloseAsync) {
+  auto host = CreateTestHostContext(4);
+
+  constexpr ssize_t kNumElements = 1 << 18;
+  auto a = CreateIotaTensor(host.get(), kNumElements);
+  auto b = CreateIotaTensor(host.get(), kNumElements);
+  DHTArrayView<float> va(&a);
+  DHTArrayView<float> vb(&b);
+
+  EXPECT_TRUE(AwaitResult(AllElementsCloseAsync<float>(va, vb, host.get())));
+
+  // A one-ULP perturbation stays within the default tolerance.
+  MutableDHTArrayView<float> mb(&b);
+  mb[7777] = std::nextafter(mb[7777], 1e30f);
+  EXPECT_TRUE(AwaitResult(AllElementsCloseAsync<float>(va, vb, host.get())));
+
+  mb[7777] += 1.0f;
+  EXPECT_FALSE(AwaitResult(AllElementsCloseAsync<float>(va, vb, host.get())));
+}
+
+TEST(DenseTensorUtilsTest, ShapeMismatchIsNotClose) {
+  auto host = CreateTestHostContext(4);
+
+  auto a = CreateIotaTensor(host.get(), 16);
+  auto b = DenseHostTensor::CreateUninitialized<float>(TensorShape({4, 4}),
+                                                       host.get());
+  ASSERT_TRUE(b.hasValue());
+  std::memcpy(b->data(), a.data(), a.DataSizeInBytes());
+
+  EXPECT_FALSE(AwaitResult(AllElementsCloseAsync<float>(
+      DHTArrayView<float>(&a), DHTArrayView<float>(b.getPointer()),
+      host.get())));
+}
+
+}  // namespace
+}  // namespace tfrt
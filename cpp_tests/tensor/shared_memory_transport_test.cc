@@ -0,0 +1,116 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- shared_memory_transport_test.cc ------------------------------------===//
+//
+// Unit tests for SharedMemoryRegion and the shm tensor messages. The peer is
+// simulated by opening the creator's region a second time, which maps the
+// same pages at a different address just like a separate process would.
+//
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+#include "tfrt/host_context/host_buffer.h"
+#include "tfrt/host_context/shared_memory_region.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/tensor/dense_host_tensor_view.h"
+#include "tfrt/tensor/tensor_serialize_utils.h"
+
+namespace tfrt {
+namespace {
+
+constexpr size_t kRegionSize = 1 << 20;
+
+DenseHostTensor MakeRegionTensor(SharedMemoryRegion* region, float value) {
+  TensorMetadata metadata(GetDType<float>(), TensorShape({2, 2}));
+  auto buffer = region->AllocateBuffer(metadata.GetHostSizeInBytes(),
+                                       metadata.dtype.GetHostAlignment());
+  assert(buffer);
+  DenseHostTensor dht(metadata, std::move(buffer));
+  MutableDHTArrayView<float>(&dht).Fill(value);
+  return dht;
+}
+
+TEST(SharedMemoryTransportTest, MessageRoundTripAliasesPages) {
+  auto region = SharedMemoryRegion::Create(kRegionSize);
+  ASSERT_TRUE(!!region);
+  auto peer = SharedMemoryRegion::Open((*region)->name(), kRegionSize);
+  ASSERT_TRUE(!!peer);
+
+  DenseHostTensor dht = MakeRegionTensor(region->get(), 3.0f);
+  auto message = SerializeDenseHostTensorToShmMessage(dht, region->get());
+  ASSERT_TRUE(!!message);
+  // Only metadata and an offset cross the wire, never the payload.
+  EXPECT_LT(message->size(), 64u);
+
+  auto received =
+      DeserializeDenseHostTensorFromShmMessage(*message, peer->CopyRef());
+  ASSERT_TRUE(!!received);
+  EXPECT_EQ(received->metadata(), dht.metadata());
+  DHTArrayView<float> view(&received.get());
+  for (float element : view.Elements()) EXPECT_EQ(element, 3.0f);
+
+  // Same pages: a write through the sender's mapping is visible through the
+  // receiver's.
+  MutableDHTArrayView<float>(&dht).Fill(7.0f);
+  for (float element : view.Elements()) EXPECT_EQ(element, 7.0f);
+}
+
+TEST(SharedMemoryTransportTest, ArenaRewindsWhenDrained) {
+  auto region = SharedMemoryRegion::Create(kRegionSize);
+  ASSERT_TRUE(!!region);
+
+  // More than half the region: two live blocks of this size cannot coexist.
+  size_t block_size = kRegionSize / 2 + 1024;
+  auto first = (*region)->AllocateBuffer(block_size, 8);
+  ASSERT_TRUE(first);
+  EXPECT_FALSE((*region)->AllocateBuffer(block_size, 8));
+
+  // Releasing the only live block rewinds the arena and makes the space
+  // allocatable again.
+  first.reset();
+  EXPECT_TRUE((*region)->AllocateBuffer(block_size, 8));
+}
+
+TEST(SharedMemoryTransportTest, DroppedExportReleasesBlock) {
+  auto region = SharedMemoryRegion::Create(kRegionSize);
+  ASSERT_TRUE(!!region);
+
+  size_t block_size = kRegionSize / 2 + 1024;
+  auto buffer = (*region)->AllocateBuffer(block_size, 8);
+  ASSERT_TRUE(buffer);
+  auto offset = (*region)->ExportBuffer(*buffer);
+  ASSERT_TRUE(!!offset);
+
+  // The in-flight reference keeps the block alive past the local buffer.
+  buffer.reset();
+  EXPECT_FALSE((*region)->AllocateBuffer(block_size, 8));
+  (*region)->DropExported(*offset);
+  EXPECT_TRUE((*region)->AllocateBuffer(block_size, 8));
+}
+
+TEST(SharedMemoryTransportTest, ExportRejectsForeignBuffer) {
+  auto region = SharedMemoryRegion::Create(kRegionSize);
+  ASSERT_TRUE(!!region);
+
+  alignas(8) static char bytes[32];
+  auto foreign = HostBuffer::CreateFromExternal(bytes, sizeof(bytes),
+                                                [](void*, size_t) {});
+  auto offset = (*region)->ExportBuffer(*foreign);
+  EXPECT_FALSE(!!offset);
+  if (!offset) consumeError(offset.takeError());
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- kernel_latency_stats_test.cc -----------------------------*- C++ -*-===//
+//
+// Unit test for per-kernel latency aggregation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tracing/kernel_latency_stats.h"
+
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace tfrt {
+namespace tracing {
+
+// The aggregate is process-global, so one test exercises the whole flow.
+TEST(KernelLatencyStatsTest, AggregatesAcrossThreads) {
+  // 100 cheap executions of one kernel from two threads, plus one expensive
+  // kernel, plus a slow outlier of the cheap kernel to pull up its p99.
+  auto record_cheap = [] {
+    for (int i = 0; i < 50; ++i) RecordKernelLatency("cheap_kernel", 100);
+  };
+  std::thread other_thread(record_cheap);
+  record_cheap();
+  other_thread.join();
+  RecordKernelLatency("cheap_kernel", 100000);
+  RecordKernelLatency("expensive_kernel", 1 << 20);
+
+  MergeKernelLatencyStats();
+
+  auto top = TopKernelsByTotalCycles(2);
+  ASSERT_EQ(top.size(), 2u);
+
+  // 100 * 100 cycles plus the outlier is still less than one 2^20 execution.
+  EXPECT_EQ(top[0].name, "expensive_kernel");
+  EXPECT_EQ(top[0].invocations, 1u);
+  EXPECT_EQ(top[0].total_cycles, uint64_t{1} << 20);
+
+  EXPECT_EQ(top[1].name, "cheap_kernel");
+  EXPECT_EQ(top[1].invocations, 101u);
+  EXPECT_EQ(top[1].total_cycles, 100u * 100 + 100000);
+
+  // The p99 invocation is one of the 100-cycle ones (rank 100 of 101); the
+  // estimate is the upper bound of its power-of-two bucket.
+  EXPECT_GE(top[1].p99_cycles, 100u);
+  EXPECT_LT(top[1].p99_cycles, 1000u);
+
+  // Merging again without new records must not change totals.
+  MergeKernelLatencyStats();
+  auto top_again = TopKernelsByTotalCycles(2);
+  ASSERT_EQ(top_again.size(), 2u);
+  EXPECT_EQ(top_again[1].total_cycles, top[1].total_cycles);
+
+  // Requesting fewer kernels truncates the ordered list.
+  EXPECT_EQ(TopKernelsByTotalCycles(1).size(), 1u);
+}
+
+}  // namespace tracing
+}  // namespace tfrt
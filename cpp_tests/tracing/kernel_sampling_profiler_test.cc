@@ -0,0 +1,78 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- kernel_sampling_profiler_test.cc -----------------------------------===//
+//
+// Unit tests for the kernel-tagged CPU sampling profiler.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tracing/kernel_sampling_profiler.h"
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace tfrt {
+namespace tracing {
+namespace {
+
+TEST(KernelSamplingProfilerTest, CurrentKernelSlotRoundTrip) {
+  EXPECT_EQ(GetCurrentKernelForSampling(), nullptr);
+  static const char* const kName = "sampling_test.slot";
+  SetCurrentKernelForSampling(kName);
+  EXPECT_EQ(GetCurrentKernelForSampling(), kName);
+  SetCurrentKernelForSampling(nullptr);
+  EXPECT_EQ(GetCurrentKernelForSampling(), nullptr);
+}
+
+TEST(KernelSamplingProfilerTest, CollectsAndFoldsSamples) {
+  ASSERT_TRUE(StartKernelSampler(/*samples_per_second=*/1000));
+  // A second concurrent sampler is rejected.
+  EXPECT_FALSE(StartKernelSampler(1000));
+
+  static const char* const kName = "sampling_test.busy_kernel";
+  SetCurrentKernelForSampling(kName);
+
+  // Burn cpu long enough for the process CPU-time timer to fire several
+  // times; ITIMER_PROF only advances while the process is actually running.
+  volatile uint64_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start <
+         std::chrono::milliseconds(200)) {
+    for (int i = 0; i < 1000; ++i) sink += i;
+  }
+
+  SetCurrentKernelForSampling(nullptr);
+  StopKernelSampler();
+
+  std::string folded;
+  llvm::raw_string_ostream os(folded);
+  WriteFoldedKernelSamples(os);
+  os.flush();
+  EXPECT_NE(folded.find("bef_executor;sampling_test.busy_kernel "),
+            std::string::npos);
+
+  // Writing resets the counts, so a second write has no line for the kernel.
+  std::string empty;
+  llvm::raw_string_ostream os2(empty);
+  WriteFoldedKernelSamples(os2);
+  os2.flush();
+  EXPECT_EQ(empty.find("sampling_test.busy_kernel"), std::string::npos);
+}
+
+}  // namespace
+}  // namespace tracing
+}  // namespace tfrt
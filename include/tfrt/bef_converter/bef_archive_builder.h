@@ -0,0 +1,79 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- bef_archive_builder.h ------------------------------------*- C++ -*-===//
+//
+// This file declares BEFArchiveBuilder, which packs multiple BEF modules
+// into one BEF archive with a shared, content-deduplicated attribute pool.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_BEF_CONVERTER_BEF_ARCHIVE_BUILDER_H_
+#define TFRT_BEF_CONVERTER_BEF_ARCHIVE_BUILDER_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/StringMap.h"
+#include "tfrt/support/aligned_buffer.h"
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+
+// Builds a BEF archive: a single mmap-able container holding multiple BEF
+// modules whose attributes all live in one shared pool. Byte-identical
+// attributes are stored once, no matter how many modules reference them, so
+// model variants that share most of their weights share the bytes (and,
+// once mapped, the physical pages) too.
+//
+// Each added module is rewritten: its kernels' attribute references are
+// redirected into the shared pool and its private Attributes section is
+// dropped. Archived modules are therefore only loadable through
+// BEFArchive::OpenModule, which patches the shared pool back in; they are
+// not standalone BEF files anymore.
+class BEFArchiveBuilder {
+ public:
+  // Add one BEF module to the archive under `name`. The module bytes are
+  // consumed immediately and need not outlive the call. Returns false if
+  // the module cannot be decoded.
+  bool AddModule(string_view name, ArrayRef<uint8_t> module);
+
+  // Serialize the archive, leaving the builder empty. See
+  // bef_executor/bef_archive.h for the container layout.
+  AlignedBuffer<8> TakeResult();
+
+ private:
+  // Return the pool offset of the attribute span `data`, whose offset in
+  // its original Attributes section was congruent to `phase` modulo
+  // kAttributeTensorAlignment, appending it to the pool if it is new.
+  size_t InternAttributeSpan(ArrayRef<uint8_t> data, size_t phase);
+
+  struct Module {
+    std::string name;
+    std::vector<uint8_t> bytes;
+  };
+  std::vector<Module> modules_;
+
+  // The shared pool, and a map from (alignment phase, span content) to the
+  // pool offset where that span is stored.
+  std::vector<uint8_t> attribute_pool_;
+  llvm::StringMap<size_t> attribute_pool_index_;
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_BEF_CONVERTER_BEF_ARCHIVE_BUILDER_H_
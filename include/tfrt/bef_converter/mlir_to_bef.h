@@ -36,10 +36,17 @@ namespace tfrt {
 // compatible program to the BinaryExecutableFormat (BEF) format, which is the
 // low level format that the executor takes.
 //
+// When `fixed_width_function_tables` is set, the function header tables are
+// emitted as fixed-width uint32 entries instead of VBR integers (a BEF
+// version 1 file). This grows the file by a few percent but removes the
+// byte-at-a-time VBR decoding from function loading, which is worthwhile for
+// production models that are loaded much more often than they are shipped.
+//
 // On error, this emits the error message through the MLIR error handler, and
 // returns an empty std:vector.
 std::vector<uint8_t> ConvertMLIRToBEF(mlir::ModuleOp module,
-                                      bool disable_optional_sections);
+                                      bool disable_optional_sections,
+                                      bool fixed_width_function_tables = false);
 
 }  // namespace tfrt
 
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- bef_archive.h --------------------------------------------*- C++ -*-===//
+//
+// This file declares BEFArchive, which loads BEF archives: containers
+// holding multiple BEF modules plus one shared, content-deduplicated
+// attribute pool.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_BEF_EXECUTOR_BEF_ARCHIVE_H_
+#define TFRT_BEF_EXECUTOR_BEF_ARCHIVE_H_
+
+#include <memory>
+
+#include "tfrt/bef_executor/bef_file.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/ref_count.h"
+
+namespace llvm {
+class MemoryBuffer;
+}
+
+namespace tfrt {
+
+// An opened BEF archive (see bef_encoding.h for the container layout and
+// BEFArchiveBuilder for how archives are built). Modules inside an archive
+// share one attribute pool, so model variants that share constants share
+// the bytes - and, when the archive is mmapped, the physical pages - across
+// every module loaded from it.
+class BEFArchive : public ReferenceCounted<BEFArchive> {
+ public:
+  // Open an archive over the given bytes, which must stay alive (and keep
+  // their alignment) for the lifetime of the archive and every module
+  // opened from it. On failure an error is emitted to the error_handler
+  // and nullptr is returned.
+  static RCReference<BEFArchive> Open(ArrayRef<uint8_t> archive,
+                                      BEFFile::ErrorHandler error_handler);
+
+  // Open the archive at `path` by memory mapping it: modules and the pool
+  // are page aligned in the container, so only the parts that are touched
+  // are ever paged in, and the pool pages are shared between processes
+  // serving the same archive.
+  static RCReference<BEFArchive> OpenFromFile(
+      string_view path, BEFFile::ErrorHandler error_handler);
+
+  // Append the names of the contained modules to `result`.
+  void GetModuleList(SmallVectorImpl<string_view>* result) const;
+
+  // Open the named module. The returned BEFFile resolves its attribute
+  // references in the archive's shared pool and holds a reference that
+  // keeps the archive alive. Returns nullptr (with an error emitted to the
+  // error_handler) if the module is not found or fails to load.
+  RCReference<BEFFile> OpenModule(
+      string_view name, KernelRegistry* registry,
+      BEFFile::ErrorHandler error_handler, HostAllocator* host_allocator,
+      BEFFile::LoadMode load_mode = BEFFile::LoadMode::kVerified);
+
+  ~BEFArchive();
+
+ private:
+  BEFArchive() = default;
+
+  struct ModuleRecord {
+    string_view name;
+    ArrayRef<uint8_t> bytes;
+  };
+
+  ArrayRef<uint8_t> attribute_pool_;
+  SmallVector<ModuleRecord, 4> modules_;
+
+  // Set by OpenFromFile: the mapping every internal ArrayRef aliases.
+  std::unique_ptr<llvm::MemoryBuffer> file_buffer_;
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_BEF_EXECUTOR_BEF_ARCHIVE_H_
@@ -40,10 +40,24 @@ class KernelRegistry;
 // Instances of this class represent a BEF file in memory.  The in-memory
 // representation of BEF files is HostContext independent, allowing reuse across
 // multiple contexts if desired.
+//
+// A BEFFile and the Functions it hands out are safe to use concurrently
+// from any number of threads without external synchronization: looking up
+// functions and executing the same or different functions at the same time
+// are both supported. Concurrent executions share only the immutable
+// decoded program and internally synchronized caches; all per-invocation
+// state is private to the invocation.
 class BEFFile : public ReferenceCounted<BEFFile> {
  public:
   typedef std::function<void(DecodedDiagnostic)> ErrorHandler;
 
+  // Controls how much checking Open performs. kVerified validates the file
+  // structure while loading. kTrusted assumes the file was produced by our
+  // own converter and already validated (e.g. with Validate in CI), and
+  // skips validation-only work on the load path; opening a malformed file
+  // in this mode is undefined behavior.
+  enum class LoadMode { kVerified, kTrusted };
+
   // Open and read a BEF file, setting up our internal state and returning a
   // pointer to our initialized object on success.  On failure, an error
   // message is emitted to the error_handler and nullptr is returned.
@@ -54,7 +68,40 @@ class BEFFile : public ReferenceCounted<BEFFile> {
   static RCReference<BEFFile> Open(ArrayRef<uint8_t> file,
                                    KernelRegistry* registry,
                                    ErrorHandler error_handler,
-                                   HostAllocator* host_allocator);
+                                   HostAllocator* host_allocator,
+                                   LoadMode load_mode = LoadMode::kVerified);
+
+  // Open and read the BEF file at `path`, memory mapping it when profitable
+  // instead of copying it into an allocated buffer. The mapping is owned by
+  // the returned BEFFile and all internal section references alias it, so
+  // sections that are never touched are never paged in. On failure, an error
+  // message is emitted to the error_handler and nullptr is returned.
+  //
+  // When use_kernel_id_cache is set, kernel resolution is additionally cached
+  // in a `<path>.kernel_ids` sidecar file: the first load resolves every
+  // kernel name through the registry's string map and writes the resulting
+  // registry ids next to the BEF file, and subsequent loads in processes
+  // running the same binary validate the cache with two fingerprint
+  // comparisons and then resolve kernels with indexed loads, skipping string
+  // hashing entirely. A stale or damaged cache is ignored (and rewritten),
+  // never trusted, so enabling this is always safe; it only requires `path`'s
+  // directory to be writable.
+  static RCReference<BEFFile> OpenFromFile(string_view path,
+                                           KernelRegistry* registry,
+                                           ErrorHandler error_handler,
+                                           HostAllocator* host_allocator,
+                                           LoadMode load_mode =
+                                               LoadMode::kVerified,
+                                           bool use_kernel_id_cache = false);
+
+  // Fully validate a BEF file: open it in kVerified mode and eagerly decode
+  // every function body, so problems that Open defers to first execution
+  // are diagnosed as well. Intended for CI and tools; production loads can
+  // then use LoadMode::kTrusted. Returns true if the file is valid. Errors
+  // are emitted to the error_handler.
+  static bool Validate(ArrayRef<uint8_t> file, KernelRegistry* registry,
+                       ErrorHandler error_handler,
+                       HostAllocator* host_allocator);
 
   // Get a list of functions out of the BEF file.
   void GetFunctionList(SmallVectorImpl<const Function*>* result) const;
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- critical_path_analysis.h - Post-execution critical path --*- C++ -*-===//
+//
+// After a slow request, the question is which dependency chain determined its
+// latency. This file declares an opt-in mode where the executor records, per
+// register, the availability timestamp and producing kernel, and per kernel,
+// its dispatch window and argument registers. After execution, the recording
+// is walked backward from the function results, at each kernel following the
+// argument that became available last, yielding the critical path with
+// per-step wait and execute durations.
+//
+// The mode is off by default; when off the executor does not touch any of
+// this. When on, each dispatched kernel pays one small allocation for its
+// record, so it is a diagnosis mode rather than an always-on one.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_BEF_EXECUTOR_CRITICAL_PATH_ANALYSIS_H_
+#define TFRT_BEF_EXECUTOR_CRITICAL_PATH_ANALYSIS_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/SmallVector.h"
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+
+class AsyncValue;
+
+// Enables or disables critical path recording for subsequently created
+// executions. Enable before invoking the function under diagnosis.
+void SetCriticalPathAnalysisEnabled(bool enabled);
+bool IsCriticalPathAnalysisEnabled();
+
+// One kernel on the critical path, in producer-to-result order. Timestamps
+// are steady-clock nanoseconds on a common base.
+struct CriticalPathStep {
+  std::string kernel_name;
+  // When the last argument of this kernel became available (the previous
+  // step's available_ns), or the execution start for source kernels.
+  uint64_t ready_ns;
+  // When the dispatch loop invoked the kernel. start_ns - ready_ns is
+  // scheduling wait: time the runnable kernel spent queued.
+  uint64_t start_ns;
+  // When the kernel's result on the path became available. For synchronous
+  // kernels this is the dispatch return; for asynchronous kernels it is when
+  // the result AsyncValue resolved. available_ns - start_ns is execution.
+  uint64_t available_ns;
+};
+
+// Computes the critical path of the most recently recorded execution by
+// walking backward from its results. Returns an empty vector if nothing was
+// recorded. Safe to call while asynchronous work is still finishing: values
+// that have not resolved yet are treated as available "now".
+std::vector<CriticalPathStep> ComputeLastCriticalPath();
+
+// Writes the path as readable text: one line per step with wait and execute
+// durations and a total.
+void PrintCriticalPath(ArrayRef<CriticalPathStep> path, raw_ostream& os);
+
+// Writes the path in the Chrome trace-viewer JSON format also used by the
+// ring buffer tracing sink, with one wait slice and one execute slice per
+// step, loadable in chrome://tracing, Perfetto, or speedscope.
+void WriteCriticalPathTrace(ArrayRef<CriticalPathStep> path, raw_ostream& os);
+
+// The clock the recorder timestamps with: steady-clock nanoseconds. The
+// executor uses this for dispatch windows so they are comparable with the
+// availability timestamps the recorder takes itself.
+uint64_t CriticalPathNowNs();
+
+// Recording state for one execution, filled in by BEFExecutor when the mode
+// is enabled. Register availability callbacks can outlive the executor (an
+// asynchronous kernel's result may resolve after the executor retired), so
+// the executor and the callbacks share ownership.
+class CriticalPathRecorder {
+ public:
+  CriticalPathRecorder(size_t num_registers, size_t num_kernels);
+
+  void SetResultRegs(ArrayRef<size_t> result_regs);
+
+  // Called by the dispatch loop after invoking `kernel_id`. Copies the name
+  // and the argument register indices so the walk does not need the BEF file.
+  void RecordKernelDispatch(unsigned kernel_id, const char* name,
+                            ArrayRef<uint32_t> arg_regs, uint64_t start_ns,
+                            uint64_t end_ns);
+
+  // Called when `kernel_id` produced `value` into register `reg_index`.
+  // Stamps the register now if the value is available, otherwise arranges
+  // for it to be stamped when the value resolves.
+  static void RecordResult(std::shared_ptr<CriticalPathRecorder> recorder,
+                           uint32_t reg_index, unsigned kernel_id,
+                           AsyncValue* value);
+
+  // Walks backward from the result registers (see ComputeLastCriticalPath).
+  std::vector<CriticalPathStep> ComputeCriticalPath() const;
+
+ private:
+  struct KernelRecord {
+    std::string name;
+    uint64_t start_ns = 0;
+    uint64_t end_ns = 0;
+    llvm::SmallVector<uint32_t, 4> arg_regs;
+  };
+
+  struct RegisterRecord {
+    std::atomic<uint64_t> available_ns{0};
+    std::atomic<int> producer{-1};
+  };
+
+  uint64_t execution_start_ns_;
+  // Indexed by kernel id / register number. Dispatch threads write disjoint
+  // kernel records; register records are stamped through atomics because a
+  // result may resolve on any thread.
+  std::vector<KernelRecord> kernels_;
+  std::vector<RegisterRecord> registers_;
+  llvm::SmallVector<size_t, 4> result_regs_;
+};
+
+// Publishes `recorder` as the most recent execution for
+// ComputeLastCriticalPath. Called by the executor at creation, so the path
+// can be queried even while asynchronous work is still completing.
+void PublishCriticalPathRecorder(
+    std::shared_ptr<CriticalPathRecorder> recorder);
+
+}  // namespace tfrt
+
+#endif  // TFRT_BEF_EXECUTOR_CRITICAL_PATH_ANALYSIS_H_
@@ -57,6 +57,13 @@ struct RunBefConfig {
   ArrayRef<std::string> functions;
   std::string work_queue_type;
   tfrt::HostAllocatorType host_allocator_type;
+
+  // When benchmark_num_iterations is non-zero, each function is additionally
+  // run benchmark_num_warmup_iterations untimed times (to populate caches and
+  // fault in pages) followed by benchmark_num_iterations timed times, and
+  // per-function mean/p50/p99 wall and cpu times are printed.
+  int benchmark_num_warmup_iterations = 0;
+  int benchmark_num_iterations = 0;
 };
 
 int RunBefExecutor(const RunBefConfig& run_config);
@@ -25,6 +25,7 @@
 
 #include <functional>
 
+#include "tfrt/host_context/location.h"
 #include "tfrt/support/forward_decls.h"
 
 namespace tfrt {
@@ -40,6 +41,7 @@ class HostContext;
 class OpAttrsRef;
 class CoreRuntimeOp;
 class OpHandler;
+class OpStream;
 class TensorHandle;
 
 class CoreRuntime final {
@@ -100,6 +102,40 @@ class CoreRuntime final {
   // directly, or an error if it cannot find the op in the op registry.
   Expected<CoreRuntimeOp> MakeOp(string_view op_name, OpHandler* op_handler);
 
+  // [Experimental]
+  // One entry of an ExecuteBatch call. Each entry has the same contract as
+  // the corresponding Execute arguments; the op handler and the chain are
+  // shared by the whole batch.
+  struct BatchEntry {
+    string_view op_name;
+    Location loc;
+    MutableArrayRef<TensorHandle> arguments;
+    // The attributes for this op. Must be non-null and outlive the
+    // ExecuteBatch call.
+    const OpAttrsRef* attrs = nullptr;
+    MutableArrayRef<TensorHandle> results;
+  };
+
+  // [Experimental]
+  // Execute a sequence of ops back to back on `op_handler`. This amortizes
+  // the fixed per-op overhead of Execute for fine grained op streams: each
+  // distinct op name is resolved through the op handler chain only once, one
+  // execution context is shared by the whole batch, and `chain` is threaded
+  // through the side effecting ops in sequence instead of being updated by
+  // each call. The entries are dispatched in order, though as with Execute
+  // the op executions themselves are generally asynchronous.
+  void ExecuteBatch(OpHandler* op_handler, MutableArrayRef<BatchEntry> batch,
+                    AsyncValueRef<Chain>* chain);
+
+  // [Experimental]
+  // Return the stream with the given name, creating it bound to `op_handler`
+  // on first use; later calls with the same name return the existing stream
+  // and ignore `op_handler`. Ops submitted to a stream execute in submission
+  // order, distinct streams overlap freely, and cross-stream dependencies are
+  // expressed with events - see OpStream in op_stream.h. Streams live as long
+  // as the CoreRuntime.
+  OpStream* GetStream(string_view name, OpHandler* op_handler);
+
  private:
   friend class OpHandler;
   class Impl;
@@ -30,11 +30,17 @@
 #include "tfrt/core_runtime/tensor_handle.h"
 #include "tfrt/host_context/chain.h"
 #include "tfrt/host_context/host_context.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/ref_count.h"
 #include "tfrt/tensor/tensor.h"
 #include "tfrt/tracing/tracing.h"
 
 namespace tfrt {
 
+namespace internal {
+class MetadataFnCache;
+}  // namespace internal
+
 // Executes `invocation` in a op_handler agnostic manner.  This is the public
 // entry point into this header.
 //
@@ -85,17 +91,23 @@ namespace tfrt {
 //                        const ExecutionContext& exec_ctx);
 // };
 //
+// When `metadata_cache` is non-null, the results of the op's metadata
+// function are cached in it keyed by the argument metadata (see
+// internal::MetadataFnCache for when this is sound).
+//
 // This overload will be SFINAE'ed out if OpHandlerTraits::OpHandlerInfoTy
 // doesn't exist.
 template <typename OpHandlerTraits>
 bool ExecuteOnOpHandler(
     bool update_chain, const OpInvocation& invocation,
     typename OpHandlerTraits::OpEntryTy op_entry,
-    typename OpHandlerTraits::OpHandlerInfoTy op_handler_info);
+    typename OpHandlerTraits::OpHandlerInfoTy op_handler_info,
+    internal::MetadataFnCache* metadata_cache = nullptr);
 
 template <typename OpHandlerTraits>
 bool ExecuteOnOpHandler(bool update_chain, const OpInvocation& invocation,
-                        typename OpHandlerTraits::OpEntryTy op_entry);
+                        typename OpHandlerTraits::OpEntryTy op_entry,
+                        internal::MetadataFnCache* metadata_cache = nullptr);
 
 namespace internal {
 // Internal implementaion details, please do not depend on things inside this
@@ -107,6 +119,41 @@ enum class MDFunctionExecResult {
   kSuccess,
 };
 
+// A per-CoreRuntimeOp cache of metadata function results, keyed by the
+// metadata of the op's arguments. Metadata functions are pure, so an op that
+// is repeatedly invoked with the same argument shapes - the steady state of
+// a fixed-shape serving workload - skips shape inference entirely after the
+// first execution.
+//
+// The cache is only sound if every invocation that shares it passes the same
+// attributes, which holds for a prepared CoreRuntimeOp executed from a
+// compiled program. Op handlers that cannot guarantee this must not install
+// a cache.
+class MetadataFnCache : public ReferenceCounted<MetadataFnCache> {
+ public:
+  // If there is an entry for `argument_mds`, fill `result_mds` and return
+  // true.
+  bool Lookup(ArrayRef<TensorMetadata> argument_mds,
+              SmallVectorImpl<TensorMetadata>& result_mds) const;
+
+  // Record `result_mds` as the metadata function results for `argument_mds`.
+  void Insert(ArrayRef<TensorMetadata> argument_mds,
+              ArrayRef<TensorMetadata> result_mds);
+
+ private:
+  // Bound the cache so ops seeing many distinct input shapes cannot grow it
+  // without limit; fixed-shape serving needs a single entry.
+  static constexpr size_t kMaxEntries = 8;
+
+  struct Entry {
+    SmallVector<TensorMetadata, 4> argument_mds;
+    SmallVector<TensorMetadata, 4> result_mds;
+  };
+
+  mutable mutex mu_;
+  SmallVector<Entry, 1> entries_ TFRT_GUARDED_BY(mu_);
+};
+
 // Executes `metadata_fn` for the op invocation designated by `invocation`.
 //
 // The three possible values of `MDFunctionExecResult` denote the three possible
@@ -125,7 +172,8 @@ enum class MDFunctionExecResult {
 //    the op results have been added to `result_mds`.
 MDFunctionExecResult ExecuteMetadataFunction(
     const OpMetadataFn& metadata_fn, const OpInvocation& invocation,
-    SmallVectorImpl<TensorMetadata>& result_mds);
+    SmallVectorImpl<TensorMetadata>& result_mds,
+    MetadataFnCache* cache = nullptr);
 
 using MetadataIsReadyCallback = llvm::unique_function<void(
     const ExecutionContext& exec_ctx, MutableArrayRef<TensorHandle> arguments,
@@ -551,11 +599,95 @@ LLVM_ATTRIBUTE_NOINLINE void ExecuteWithMetadataAsync(
       });
 }
 
+template <typename InputTensorTy>
+InputTensorTy* GetSyncInputTensor(AsyncValue* arg) {
+  return &arg->get<InputTensorTy>();
+}
+
+template <>
+inline AsyncValue* GetSyncInputTensor<AsyncValue>(AsyncValue* arg) {
+  return arg;
+}
+
+// Attempts to run `invocation` completely synchronously: the result metadata
+// in `result_mds` was already produced by the op's metadata function, and if
+// every argument tensor is available in a supported format the dispatch
+// function runs inline - no AndThen chains and no extra AsyncValue
+// allocations. Returns false without doing anything visible when any input
+// is pending, a tensor conversion is asynchronous or fails, or the in-chain
+// is not ready; the caller then falls back to the general machinery, which
+// handles all of those.
+template <typename OpHandlerTraits>
+bool TryExecuteSynchronously(
+    bool update_chain, const OpInvocation& invocation,
+    typename OpHandlerTraits::OpEntryTy& op_entry,
+    typename OpHandlerTraits::OpHandlerInfoTy& op_handler_info,
+    ArrayRef<TensorMetadata> result_mds) {
+  using InputTensorTy = typename OpHandlerTraits::InputTensorTy;
+
+  const ExecutionContext& exec_ctx = invocation.exec_ctx;
+
+  // Cancellation and pending or errored in-chains take the general path,
+  // which knows how to propagate them.
+  if (exec_ctx.host()->GetCancelAsyncValue()) return false;
+  if (invocation.chain && *invocation.chain && !invocation.chain->IsConcrete())
+    return false;
+
+  // Every argument tensor must be available. Conversions to a supported
+  // format happen inline, but a conversion that is itself asynchronous or
+  // produced an error falls back.
+  SmallVector<RCReference<AsyncValue>, 4> converted_args;
+  SmallVector<InputTensorTy*, 4> arg_tensors;
+  arg_tensors.reserve(invocation.arguments.size());
+  for (auto& argument : invocation.arguments) {
+    AsyncValue* async_tensor = argument.GetAsyncTensor();
+    if (!async_tensor->IsConcrete()) return false;
+
+    RCReference<AsyncValue> converted;
+    if (OpHandlerTraits::MaybeConvertTensor(op_entry, op_handler_info,
+                                            async_tensor->get<Tensor>(),
+                                            exec_ctx, &converted)) {
+      if (!converted->IsConcrete()) return false;
+      converted_args.push_back(std::move(converted));
+      async_tensor = converted_args.back().get();
+    }
+    arg_tensors.push_back(GetSyncInputTensor<InputTensorTy>(async_tensor));
+  }
+
+  size_t num_results = invocation.results.size();
+  SmallVector<RCReference<AsyncValue>, 4> result_tensors;
+  result_tensors.resize(num_results);
+
+  AsyncValueRef<Chain> op_chain;
+  {
+    TFRT_TRACE_SCOPE("RunDispatchFunction");
+    OpHandlerTraits::Dispatch(op_entry, op_handler_info, arg_tensors,
+                              invocation.attrs, result_mds, result_tensors,
+                              &op_chain, exec_ctx);
+  }
+
+  // The out chain of the op becomes the invocation's chain directly instead
+  // of being forwarded through a preallocated AsyncValue.
+  if (update_chain) {
+    assert(op_chain && "the op does not produce a required out chain.");
+    *invocation.chain = std::move(op_chain);
+  }
+
+  // The result metadata is known, so the result TensorHandles are built with
+  // inline metadata around whatever the dispatch function produced.
+  for (size_t i = 0; i != num_results; ++i)
+    invocation.results[i] = TensorHandle(
+        result_mds[i], AsyncValueRef<Tensor>(std::move(result_tensors[i])));
+
+  return true;
+}
+
 template <typename OpHandlerTraits>
 bool ExecuteOnOpHandlerImpl(
     bool update_chain, const OpInvocation& invocation,
     typename OpHandlerTraits::OpEntryTy op_entry,
-    typename OpHandlerTraits::OpHandlerInfoTy op_handler_info) {
+    typename OpHandlerTraits::OpHandlerInfoTy op_handler_info,
+    internal::MetadataFnCache* metadata_cache) {
   using internal::ExecuteMetadataFunction;
   using internal::MDFunctionExecResult;
 
@@ -572,8 +704,8 @@ bool ExecuteOnOpHandlerImpl(
   // or async - but we want to propagate the shape synchronously whenever
   // possible.
   if (op_entry.metadata_fn) {
-    auto md_exec_result =
-        ExecuteMetadataFunction(op_entry.metadata_fn, invocation, result_mds);
+    auto md_exec_result = ExecuteMetadataFunction(
+        op_entry.metadata_fn, invocation, result_mds, metadata_cache);
     if (md_exec_result == MDFunctionExecResult::kError) {
       return true;
     }
@@ -589,6 +721,16 @@ bool ExecuteOnOpHandlerImpl(
   // Okay, now that the metadata function returned successfully, we can run our
   // op.
 
+  // Fast path: the result metadata is known synchronously, so when every
+  // input tensor is also available the dispatch function runs inline and the
+  // result TensorHandles are built directly, with no AndThen chains and no
+  // indirect or unconstructed AsyncValue allocations. For CPU inference this
+  // is the common case.
+  if (op_entry.metadata_fn &&
+      internal::TryExecuteSynchronously<OpHandlerTraits>(
+          update_chain, invocation, op_entry, op_handler_info, result_mds))
+    return true;
+
   SmallVector<AsyncValueRef<TensorMetadata>, 8> result_md_avs;
   SmallVector<AsyncValueRef<Tensor>, 8> result_tensor_avs;
 
@@ -619,14 +761,16 @@ template <typename OpHandlerTraits>
 bool ExecuteOnOpHandler(
     bool update_chain, const OpInvocation& invocation,
     typename OpHandlerTraits::OpEntryTy op_entry,
-    typename OpHandlerTraits::OpHandlerInfoTy op_handler_info) {
+    typename OpHandlerTraits::OpHandlerInfoTy op_handler_info,
+    internal::MetadataFnCache* metadata_cache) {
   return internal::ExecuteOnOpHandlerImpl<OpHandlerTraits>(
-      update_chain, invocation, op_entry, op_handler_info);
+      update_chain, invocation, op_entry, op_handler_info, metadata_cache);
 }
 
 template <typename OpHandlerTraits>
 bool ExecuteOnOpHandler(bool update_chain, const OpInvocation& invocation,
-                        typename OpHandlerTraits::OpEntryTy op_entry) {
+                        typename OpHandlerTraits::OpEntryTy op_entry,
+                        internal::MetadataFnCache* metadata_cache) {
   // For now implement the non-OpHandlerInfoTy overload by faking a
   // OpHandlerInfoTy using an `int`.
   struct InnerOpHandlerTraits {
@@ -656,7 +800,7 @@ bool ExecuteOnOpHandler(bool update_chain, const OpInvocation& invocation,
 
   return internal::ExecuteOnOpHandlerImpl<InnerOpHandlerTraits>(
       update_chain, invocation, std::move(op_entry),
-      /*op_handler_info=*/0);
+      /*op_handler_info=*/0, metadata_cache);
 }
 
 }  // namespace tfrt
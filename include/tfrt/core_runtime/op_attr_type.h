@@ -27,6 +27,7 @@
 #include <utility>
 
 #include "tfrt/support/bef_encoding.h"
+#include "tfrt/support/bf16.h"
 #include "tfrt/support/fp16.h"
 
 namespace tfrt {
@@ -41,6 +42,7 @@ enum class OpAttrType : uint8_t {
   DENSE,
   SHAPE,
   F16,
+  BF16,
 #define OP_ATTR_TYPE(ENUM, CPP_TYPE) ENUM,
 #include "tfrt/core_runtime/op_attr_type.def"
 };
@@ -75,6 +77,11 @@ constexpr OpAttrType GetOpAttrType<fp16>() {
   return OpAttrType::F16;
 }
 
+template <>
+constexpr OpAttrType GetOpAttrType<bf16>() {
+  return OpAttrType::BF16;
+}
+
 #define OP_ATTR_TYPE(ENUM, CPP_TYPE)               \
   template <>                                      \
   constexpr OpAttrType GetOpAttrType<CPP_TYPE>() { \
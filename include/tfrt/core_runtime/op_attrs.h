@@ -47,7 +47,9 @@ class ImmutableOpAttrs;
 // This describes a single attribute entry maintained by OpAttrs. It is a 'raw'
 // attribute, meaning that it is type erased and may or may not be an array.
 struct OpAttrsRawEntry final {
-  // Pointer to a null terminated string for the attribute name.
+  // Pointer to a null terminated string for the attribute name. This is the
+  // canonical pointer produced by StringInterner, so two entries (in any
+  // attribute sets) name the same attribute iff their pointers are equal.
   const char* name;
 
   union {
@@ -288,8 +290,9 @@ class OpAttrs final {
   friend class OutOfLineRepresentation;
 
   // Most op invocations have a small number of attributes, and we want them to
-  // be formed without an allocation.  This array holds the string and value
-  // data and is sized to be large enough to handle the common cases.
+  // be formed without an allocation.  This array holds the value data (names
+  // live in the process-wide intern table) and is sized to be large enough to
+  // handle the common cases.
   //
   // Note that all of the inline state is undefined if OpAttrs has grown to use
   // an out-of-line representation.
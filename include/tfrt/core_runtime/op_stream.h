@@ -0,0 +1,98 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- op_stream.h ----------------------------------------------*- C++ -*-===//
+//
+// This file declares OpStream, an ordered op submission queue on CoreRuntime.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_CORE_RUNTIME_OP_STREAM_H_
+#define TFRT_CORE_RUNTIME_OP_STREAM_H_
+
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/location.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+
+class CoreRuntime;
+class OpAttrsRef;
+class OpHandler;
+class TensorHandle;
+
+// An OpStream is an ordered submission queue for ops: each op enqueued on a
+// stream starts executing only after every previously enqueued op on the same
+// stream has completed. Distinct streams are independent, so phases of
+// successive requests (e.g. preprocessing, inference and postprocessing on
+// their own streams) pipeline across cores without hand-built async plumbing.
+//
+// Cross-stream dependencies are expressed with events: RecordEvent() captures
+// all work enqueued on a stream so far, and WaitFor() makes another stream's
+// later ops wait for that event.
+//
+// Streams are created and owned by CoreRuntime, see CoreRuntime::GetStream().
+// Submitting to one stream from multiple threads is safe, though the order of
+// racing submissions is then unspecified.
+class OpStream {
+ public:
+  ~OpStream();
+
+  OpStream(const OpStream&) = delete;
+  OpStream& operator=(const OpStream&) = delete;
+
+  // Enqueue the op specified by `op_name` behind all previously enqueued work
+  // on this stream. This has the same contract as CoreRuntime::Execute: the
+  // arguments may be destructively mutated, `results` is filled with
+  // TensorHandles synchronously, and failures (including an unknown op name)
+  // are reported through the results. The op itself runs asynchronously once
+  // the stream reaches it.
+  void Execute(string_view op_name, Location loc,
+               MutableArrayRef<TensorHandle> arguments, const OpAttrsRef& attrs,
+               MutableArrayRef<TensorHandle> results);
+
+  // Return an event that becomes available once all work enqueued on this
+  // stream so far has completed. The event carries any error from the
+  // stream's side effect chain.
+  AsyncValueRef<Chain> RecordEvent();
+
+  // Make all ops enqueued on this stream after this call wait for `event`
+  // (typically recorded on another stream) in addition to the stream's own
+  // order.
+  void WaitFor(AsyncValueRef<Chain> event);
+
+  // The op handler this stream dispatches its ops to.
+  OpHandler* op_handler() const { return op_handler_; }
+
+ private:
+  friend class CoreRuntime;
+
+  OpStream(CoreRuntime* runtime, OpHandler* op_handler);
+
+  CoreRuntime* runtime_;
+  OpHandler* op_handler_;
+
+  mutex mu_;
+  // Completion of the most recently enqueued work; the next op waits on it.
+  AsyncValueRef<Chain> last_event_ TFRT_GUARDED_BY(mu_);
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_CORE_RUNTIME_OP_STREAM_H_
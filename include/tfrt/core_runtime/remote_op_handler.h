@@ -0,0 +1,77 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- remote_op_handler.h --------------------------------------*- C++ -*-===//
+//
+// This file declares the remote op handler, which forwards op dispatches to
+// a peer process over a connected socket, and the server loop that executes
+// them on the peer. Attributes travel as their raw OpAttrs entries and
+// tensors as the dense-attr serialization from tensor_serialize_utils.
+// Dispatch is pipelined: invoking an op enqueues the request and returns
+// future TensorHandles immediately, so independent ops overlap their round
+// trips. Memory-heavy ops (e.g. embedding lookups) can thereby run on a
+// RAM-heavy peer without leaving the CoreRuntime programming model.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_CORE_RUNTIME_REMOTE_OP_HANDLER_H_
+#define TFRT_CORE_RUNTIME_REMOTE_OP_HANDLER_H_
+
+#include <memory>
+#include <thread>
+
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+
+class OpHandler;
+class CoreRuntime;
+
+// Creates an op handler whose ops execute on the peer at the other end of
+// `socket_fd` (an already-connected stream socket). The handler takes
+// ownership of the fd. Argument tensors must resolve to DenseHostTensors;
+// results are always DenseHostTensors. The returned handler is used directly
+// with CoreRuntime::Execute or MakeOp; it has no fallback - an op the peer
+// does not know fails with the peer's error.
+llvm::Expected<std::unique_ptr<OpHandler>> CreateRemoteOpHandler(
+    CoreRuntime* runtime, int socket_fd);
+
+// Serves op dispatches arriving on `socket_fd` by executing them with
+// `op_handler` (e.g. the peer's CPU op handler), writing results back.
+// Requests are executed in arrival order; a pipelining client overlaps its
+// round trips against this sequential execution. Takes ownership of the fd.
+class RemoteOpServer {
+ public:
+  RemoteOpServer(int socket_fd, CoreRuntime* runtime, OpHandler* op_handler);
+
+  // Closes the connection and joins the serving thread.
+  ~RemoteOpServer();
+
+  RemoteOpServer(const RemoteOpServer&) = delete;
+  RemoteOpServer& operator=(const RemoteOpServer&) = delete;
+
+ private:
+  void Serve();
+
+  int fd_;
+  CoreRuntime* runtime_;
+  OpHandler* op_handler_;
+  std::thread serving_thread_;
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_CORE_RUNTIME_REMOTE_OP_HANDLER_H_
@@ -89,6 +89,15 @@ class TensorHandle final {
   // underlying data.
   TensorHandle CopyRef() const;
 
+  // Return a handle to the same tensor whose AsyncValues live on `host`,
+  // for moving results between the HostContexts of a sharded pool (see
+  // host_context_pool.h). Host memory is shared between contexts, so dense
+  // host tensors transfer by sharing the underlying buffer - no data is
+  // copied; other tensor types fall back to ConvertToHostTensor on the
+  // destination. Both contexts must stay alive until the transferred handle
+  // and everything derived from it are dropped.
+  TensorHandle TransferTo(HostContext* host) const;
+
   // Return the tensor async value and drop this TensorHandle into its null
   // state.
   AsyncValueRef<Tensor> ReleaseTensorRef();
@@ -34,9 +34,11 @@
 #include <type_traits>
 
 #include "llvm/ADT/PointerIntPair.h"
+#include "tfrt/host_context/async_value_profiler.h"
 #include "tfrt/host_context/diagnostic.h"
 #include "tfrt/host_context/host_context_ptr.h"
 #include "tfrt/host_context/location.h"
+#include "tfrt/support/cache_line_audit.h"
 #include "tfrt/support/compiler_annotations.h"
 #include "tfrt/support/forward_decls.h"
 #include "tfrt/support/ref_count.h"
@@ -258,20 +260,27 @@ class AsyncValue {
       : host_context_(host),
         kind_(kind),
         has_vtable_(std::is_polymorphic<T>()),
+        trivial_destroy_(std::is_trivially_destructible<T>::value &&
+                         sizeof(T) + kDataOrErrorOffset <= kSlabBlockSize),
         type_id_(GetTypeId<T>()),
         waiters_and_state_(WaitersAndState(nullptr, state)) {
     if (AsyncValueAllocationTrackingEnabled())
       total_allocated_async_values_.fetch_add(1, std::memory_order_relaxed);
+    if (IsAsyncValueProfilingEnabled())
+      internal::ProfileAsyncValueCreated(this);
   }
 
   AsyncValue(HostContextPtr host, Kind kind, State state)
       : host_context_(host),
         kind_(kind),
         has_vtable_(false),
+        trivial_destroy_(false),
         type_id_(0),
         waiters_and_state_(WaitersAndState(nullptr, state)) {
     if (AsyncValueAllocationTrackingEnabled())
       total_allocated_async_values_.fetch_add(1, std::memory_order_relaxed);
+    if (IsAsyncValueProfilingEnabled())
+      internal::ProfileAsyncValueCreated(this);
   }
 
   AsyncValue(const AsyncValue&) = delete;
@@ -336,8 +345,14 @@ class AsyncValue {
   // has_vtable_ to a global vector<bool> indexed by type_id_.
   const bool has_vtable_ : 1;
 
+  // True if the payload type is trivially destructible and the value is small
+  // enough to be served by the slab allocator, in which case Destroy() skips
+  // the TypeInfo destructor dispatch entirely. Like has_vtable_, this has the
+  // same value for a given payload type T.
+  const bool trivial_destroy_ : 1;
+
   // Unused padding bits.
-  unsigned unused_ : 5;
+  unsigned unused_ : 4;
 
   // This is a 16-bit value that identifies the type.
   uint16_t type_id_ = 0;
@@ -373,6 +388,11 @@ class AsyncValue {
   /// ConcreteAsyncValue::error_.
   static constexpr int kDataOrErrorOffset = 16;
 
+  /// AsyncValues no larger than this are served from HostContext's per-thread
+  /// slab allocator, which hands out uniformly sized blocks of exactly this
+  /// size. See async_value_slab_allocator.cc.
+  static constexpr int kSlabBlockSize = 128;
+
  private:
   template <typename T>
   const T& GetConcreteValue() const;
@@ -591,6 +611,8 @@ inline AsyncValue::~AsyncValue() {
          "An async value with waiters should never have refcount of zero");
   if (AsyncValueAllocationTrackingEnabled())
     total_allocated_async_values_.fetch_sub(1, std::memory_order_relaxed);
+  if (IsAsyncValueProfilingEnabled())
+    internal::ProfileAsyncValueDestroyed(this);
 
   // Catch use-after-free errors more eagerly, by triggering the size assertion
   // in the 'get' accessor.
@@ -629,6 +651,7 @@ inline AsyncValue* AsyncValue::AddRef(uint32_t count) {
     // memory_order_relaxed: New references to an object can only be formed from
     // an existing reference, and passing an existing reference from one thread
     // to another must already provide any required synchronization.
+    TFRT_AUDIT_CACHE_LINE_WRITE(&refcount_, "AsyncValue::refcount_");
     refcount_.fetch_add(count, std::memory_order_relaxed);
   }
   return this;
@@ -645,6 +668,7 @@ inline void AsyncValue::DropRef(uint32_t count) {
     // If `count` != reference count, a release barrier is needed in
     // addition to an acquire barrier so that prior changes by this thread
     // cannot be seen to occur after this decrement.
+    TFRT_AUDIT_CACHE_LINE_WRITE(&refcount_, "AsyncValue::refcount_");
     is_last_ref =
         refcount_.fetch_sub(count, std::memory_order_acq_rel) == count;
   }
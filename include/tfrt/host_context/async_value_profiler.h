@@ -0,0 +1,104 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- async_value_profiler.h - AsyncValue lifetime profiler ----*- C++ -*-===//
+//
+// This file declares an opt-in profiling mode that timestamps AsyncValue
+// construction, availability, and destruction, attributed to the kernel that
+// produced the value. Latency problems are usually one AsyncValue that became
+// available late; the per-kernel latency stats say how long kernels ran, but
+// not what the graph was waiting on. This profiler answers that question by
+// reporting the values with the largest created-to-available gaps.
+//
+// The mode is off by default. When off, the hooks in AsyncValue cost one
+// relaxed atomic load each; when on, each AsyncValue event takes a short
+// critical section on one of a set of sharded maps, so it is meant for
+// diagnosis runs rather than steady-state production.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_HOST_CONTEXT_ASYNC_VALUE_PROFILER_H_
+#define TFRT_HOST_CONTEXT_ASYNC_VALUE_PROFILER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace tfrt {
+
+class AsyncValue;
+
+namespace internal {
+
+// Storage for the enabled flag. Use IsAsyncValueProfilingEnabled() instead of
+// reading this directly; it is only exposed here so the check inlines into
+// the AsyncValue constructor and destructor.
+extern std::atomic<bool> kAsyncValueProfilingEnabled;
+
+// Hooks called from AsyncValue. Callers must check
+// IsAsyncValueProfilingEnabled() first so the disabled path stays a single
+// relaxed load.
+void ProfileAsyncValueCreated(const AsyncValue* value);
+void ProfileAsyncValueAvailable(const AsyncValue* value);
+void ProfileAsyncValueDestroyed(const AsyncValue* value);
+
+}  // namespace internal
+
+// Completed lifetime of one profiled AsyncValue. Timestamps are
+// steady-clock nanoseconds on a common base, so gaps between the fields are
+// directly comparable across values and threads.
+struct AsyncValueLifetime {
+  // Name of the kernel whose execution created the value, pointing into the
+  // BEF file's string section; nullptr if the value was created outside of
+  // kernel dispatch (e.g. by client code or the executor itself).
+  const char* kernel_name;
+  uint64_t created_ns;
+  // Zero if the value was destroyed without ever becoming available.
+  uint64_t available_ns;
+  uint64_t destroyed_ns;
+
+  // The created-to-available gap: how long consumers could have been waiting.
+  uint64_t StallNs() const {
+    return available_ns == 0 ? 0 : available_ns - created_ns;
+  }
+};
+
+// Returns true if AsyncValue lifetime profiling is enabled.
+inline bool IsAsyncValueProfilingEnabled() {
+  return internal::kAsyncValueProfilingEnabled.load(std::memory_order_relaxed);
+}
+
+// Enables or disables AsyncValue lifetime profiling. Values created while the
+// mode was disabled are not tracked, so enable it before starting the
+// execution under diagnosis.
+void SetAsyncValueProfilingEnabled(bool enabled);
+
+// Sets the kernel name the calling thread attributes newly created
+// AsyncValues to, or nullptr to clear the attribution. The executor brackets
+// each kernel invocation with this; the name must outlive the profiled
+// values, which holds for kernel names in a loaded BEF file.
+void SetCurrentKernelForAsyncValueProfiling(const char* kernel_name);
+
+// Returns up to `n` completed lifetimes with the largest created-to-available
+// gaps, largest first, and drains them from the profiler. Only values that
+// have been destroyed are reported; call this after the execution under
+// diagnosis has quiesced. The profiler retains a bounded number of completed
+// records, keeping the largest stalls when the bound overflows.
+std::vector<AsyncValueLifetime> TakeTopAsyncValueStalls(int n);
+
+}  // namespace tfrt
+
+#endif  // TFRT_HOST_CONTEXT_ASYNC_VALUE_PROFILER_H_
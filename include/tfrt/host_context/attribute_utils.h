@@ -358,6 +358,50 @@ class AggregateAttr
   }
 };
 
+// A flattened homogeneous aggregate: every element is an equally sized
+// array of the same fixed-width scalar type, and all scalars are stored as
+// one contiguous typed payload. Reading the values is a pointer cast
+// instead of the per-element offset walk of AggregateAttr.
+class FlatAggregateAttr
+    : public internal::AttrHeaderBase<FlatAggregateAttr, BEFFlatAggregateAttr> {
+ public:
+  using Base::Base;
+
+  BEFAttributeType GetElementType() const {
+    return GetElementAttributeType(type());
+  }
+
+  // Number of sub-arrays.
+  size_t GetNumElements() const { return header().num_elements; }
+
+  // Number of scalars in each sub-array.
+  size_t GetElementSize() const { return header().element_size; }
+
+  const void* GetElements() const {
+    const auto* bytes = static_cast<const uint8_t*>(data());
+    return bytes + header().element_offset;
+  }
+
+  // All scalars of all sub-arrays, flattened in element order.
+  template <typename T>
+  ArrayRef<T> GetValue() const {
+    assert(GetBEFAttributeType<T>() == GetElementType());
+    return llvm::makeArrayRef(static_cast<const T*>(GetElements()),
+                              GetNumElements() * GetElementSize());
+  }
+
+  // The scalars of the index'th sub-array.
+  template <typename T>
+  ArrayRef<T> GetValue(int index) const {
+    assert(index < GetNumElements());
+    return GetValue<T>().slice(index * GetElementSize(), GetElementSize());
+  }
+
+  static bool classof(TypedAttrBase base) {
+    return IsFlatAggregateAttribute(base.type());
+  }
+};
+
 }  // namespace tfrt
 
 #endif  // TFRT_HOST_CONTEXT_ATTRIBUTE_UTILS_H_
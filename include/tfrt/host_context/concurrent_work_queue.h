@@ -24,6 +24,7 @@
 #ifndef TFRT_HOST_CONTEXT_CONCURRENT_WORK_QUEUE_H_
 #define TFRT_HOST_CONTEXT_CONCURRENT_WORK_QUEUE_H_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 
@@ -68,6 +69,12 @@ class AsyncValue;
 // This class and its subclasses are non-copyable and non-movable.  This may be
 // subclassed to provide domain specific implementations, but should not be used
 // directly - instead, you should interact with HostContext.
+// Priority lane for non-blocking tasks. High priority tasks are drained by
+// worker threads before default priority tasks, which isolates the tail
+// latency of small latency-critical graphs (e.g. online inference) from bulk
+// background work (e.g. dataset preprocessing) sharing the same queue.
+enum class TaskPriority : uint8_t { kDefault, kHigh };
+
 class ConcurrentWorkQueue {
  public:
   // Undefined what happens to pending work when destructor is called.
@@ -84,6 +91,25 @@ class ConcurrentWorkQueue {
   // thread.
   virtual void AddTask(TaskFunction work) = 0;
 
+  // Enqueue a block of work with an explicit priority lane. Thread-safe.
+  //
+  // Implementations without priority support may ignore `priority`; the
+  // default implementation forwards to AddTask.
+  virtual void AddTask(TaskFunction work, TaskPriority priority) {
+    AddTask(std::move(work));
+  }
+
+  // Enqueue a batch of work. Thread-safe.
+  //
+  // This is semantically equivalent to calling AddTask for each element of
+  // `tasks`, but allows the implementation to publish the whole batch with a
+  // single synchronization episode (e.g. one wake-up of parked worker
+  // threads). It is used on wide fan-out paths, such as notifying all waiters
+  // of an AsyncValue. `tasks` is consumed: all elements are moved out.
+  //
+  // The default implementation simply calls AddTask in a loop.
+  virtual void AddTasks(MutableArrayRef<TaskFunction> tasks);
+
   // Enqueue a blocking task. Thread-safe.
   //
   // If `allow_queuing` is false, implementation must guarantee that work will
@@ -129,6 +155,14 @@ class ConcurrentWorkQueue {
 // synchronization.
 std::unique_ptr<ConcurrentWorkQueue> CreateSingleThreadedWorkQueue();
 
+// Create a work queue that runs every task inline on the caller thread
+// before AddTask returns, with no queue at all. A HostContext configured
+// with it executes a BEF function as a depth-first interpretation on one
+// thread, which removes all queueing overhead for tiny latency-critical
+// graphs. Tasks must therefore not be enqueued while holding locks their
+// continuations may take, and blocking tasks block the caller.
+std::unique_ptr<ConcurrentWorkQueue> CreateRunToCompletionWorkQueue();
+
 // Create a multi-threaded non-blocking thread pool that supports both blocking
 // and non-blocking workloads.
 //
@@ -144,6 +178,26 @@ std::unique_ptr<ConcurrentWorkQueue> CreateSingleThreadedWorkQueue();
 std::unique_ptr<ConcurrentWorkQueue> CreateMultiThreadedWorkQueue(
     int num_threads, int num_blocking_threads);
 
+// Same as above, additionally configuring the spin/park policy of the
+// non-blocking workers.
+//
+// max_spin_count: upper bound on the number of steal iterations a worker may
+// spin before parking when it runs out of work. Workers adapt their actual
+// spin duration between zero and this bound based on how often spinning finds
+// work, so the bound trades CPU burned in idle phases for wakeup latency in
+// bursty phases. Non-positive values select the built-in default.
+std::unique_ptr<ConcurrentWorkQueue> CreateMultiThreadedWorkQueue(
+    int num_threads, int num_blocking_threads, int max_spin_count);
+
+// Same as above, additionally pinning all non-blocking worker threads to the
+// CPUs of NUMA node `numa_node` (blocking workers, which mostly sleep in IO,
+// are left unpinned). Used to build per-node execution shards (see
+// HostContextPool); a non-positive max_spin_count selects the built-in
+// default.
+std::unique_ptr<ConcurrentWorkQueue> CreateNumaPinnedWorkQueue(
+    int num_threads, int num_blocking_threads, int max_spin_count,
+    int numa_node);
+
 // A factory function for creating ConcurrentWorkQueue objects. The factory
 // function defines the semantics of the argument string.
 // TODO(pgavin): Consider using a configuration object or other data structure
@@ -23,18 +23,62 @@
 #ifndef TFRT_HOST_CONTEXT_EXECUTION_CONTEXT_H_
 #define TFRT_HOST_CONTEXT_EXECUTION_CONTEXT_H_
 
+#include <atomic>
+
 #include "tfrt/host_context/location.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/ref_count.h"
 
 namespace tfrt {
 
+class AsyncValue;
 class HostContext;
 
+// A shared cancellation flag for one logical execution, e.g. one client
+// request. The client side holds a reference and calls Cancel() when the
+// results are no longer wanted; the BEF executor checks the token before
+// dispatching each kernel, and long-running kernels may poll it through
+// their ExecutionContext. Unlike HostContext::CancelExecution, which cancels
+// everything running on the host, a token cancels only the executions it
+// was attached to.
+//
+// All methods are safe to call concurrently from any thread.
+class CancellationToken : public ReferenceCounted<CancellationToken> {
+ public:
+  explicit CancellationToken(HostContext* host) : host_(host) {}
+  ~CancellationToken();
+
+  // Move the token to the cancelled state, with `msg` as the diagnostic
+  // carried by the cancellation error. The first call wins; the messages of
+  // later calls are dropped. There is no way back: a token cancels at most
+  // one logical execution and is not reused.
+  void Cancel(string_view msg);
+
+  bool IsCancelled() const {
+    return cancel_value_.load(std::memory_order_acquire) != nullptr;
+  }
+
+  // Returns the error AsyncValue carrying the cancellation diagnostic once
+  // the token is cancelled, and nullptr before that. The value is owned by
+  // the token; callers that store it must FormRef it.
+  AsyncValue* GetCancelAsyncValue() const {
+    return cancel_value_.load(std::memory_order_acquire);
+  }
+
+ private:
+  HostContext* const host_;
+
+  // Set once by the winning Cancel() call, holding a reference to the error
+  // value that is dropped by the destructor.
+  std::atomic<AsyncValue*> cancel_value_{nullptr};
+};
+
 // ExecutionContext holds the context information for kernel and op execution,
 // which currently includes the memory allocator, thread pool (memory allocator
-// and thread pool are part of HostContext), and the location information. In
-// the future, we plan to include other contextual information, such as client
-// request id and request priority, and the request cancellation support, in the
-// ExecutionContext as well.
+// and thread pool are part of HostContext), the location information, and the
+// request cancellation support. In the future, we plan to include other
+// contextual information, such as client request id and request priority, in
+// the ExecutionContext as well.
 //
 // ExecutionContext is passed widely in the code base, as most code requires
 // some of the facilities provided by ExecutionContext, e.g. memory allocation,
@@ -44,14 +88,51 @@ class ExecutionContext {
  public:
   explicit ExecutionContext(HostContext* host) : host_{host} {}
 
+  ExecutionContext(const ExecutionContext& other)
+      : location_(other.location_),
+        host_(other.host_),
+        tenant_id_(other.tenant_id_),
+        cancellation_token_(other.cancellation_token_.CopyRef()) {}
+  ExecutionContext& operator=(const ExecutionContext& other) {
+    location_ = other.location_;
+    host_ = other.host_;
+    tenant_id_ = other.tenant_id_;
+    cancellation_token_ = other.cancellation_token_.CopyRef();
+    return *this;
+  }
+  ExecutionContext(ExecutionContext&&) = default;
+  ExecutionContext& operator=(ExecutionContext&&) = default;
+
   Location location() const { return location_; }
   HostContext* host() const { return host_; }
+  // Identifies the tenant (e.g. the model or client) this execution belongs
+  // to, for weighted fair scheduling via
+  // HostContext::EnqueueWorkForTenant(). Tenant 0 is the default tenant.
+  int tenant_id() const { return tenant_id_; }
+  // The cancellation token attached to this execution, or nullptr if the
+  // execution is not cancellable through a token.
+  CancellationToken* cancellation_token() const {
+    return cancellation_token_.get();
+  }
+
+  // Returns the cancellation error if this execution has been cancelled,
+  // either through its token or host-wide via HostContext::CancelExecution,
+  // and nullptr otherwise. Long-running kernels should poll this and
+  // propagate the returned error into their results when it fires.
+  AsyncValue* GetCancelAsyncValue() const;
+  bool IsCancelled() const { return GetCancelAsyncValue() != nullptr; }
 
   void set_location(Location location) { location_ = location; }
+  void set_tenant_id(int tenant_id) { tenant_id_ = tenant_id; }
+  void set_cancellation_token(RCReference<CancellationToken> token) {
+    cancellation_token_ = std::move(token);
+  }
 
  private:
   Location location_;
   HostContext* host_ = nullptr;
+  int tenant_id_ = 0;
+  RCReference<CancellationToken> cancellation_token_;
 };
 
 }  // namespace tfrt
@@ -26,6 +26,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "tfrt/host_context/execution_context.h"
 #include "tfrt/host_context/type_name.h"
 #include "tfrt/support/forward_decls.h"
 
@@ -56,6 +57,32 @@ class Function {
                        MutableArrayRef<RCReference<AsyncValue>> results,
                        HostContext* host) const = 0;
 
+  // Execute this function with the per-execution state carried in
+  // `exec_ctx`, currently the cancellation token (see execution_context.h).
+  // The base implementation drops the extra state and forwards to the
+  // HostContext overload; implementations that can honor it (currently
+  // BEFFunction) override this.
+  virtual void Execute(
+      const ExecutionContext& exec_ctx, ArrayRef<AsyncValue*> arguments,
+      MutableArrayRef<RCReference<AsyncValue>> results) const {
+    Execute(arguments, results, exec_ctx.host());
+  }
+
+  // One invocation in a batched execution: an argument set and the result
+  // values to populate for it.
+  struct BatchEntry {
+    ArrayRef<AsyncValue*> arguments;
+    MutableArrayRef<RCReference<AsyncValue>> results;
+  };
+
+  // Execute this function once for each entry in `entries`. All result
+  // AsyncValues are populated before this returns, as with Execute. The
+  // default implementation just calls Execute per entry; implementations may
+  // override it to amortize fixed per-invocation costs across the batch and
+  // to interleave the entries' kernels on the work queue.
+  virtual void ExecuteBatch(ArrayRef<BatchEntry> entries,
+                            HostContext* host) const;
+
   // Reference counting operations, used by async kernels to keep the underlying
   // storage for a function alive.
   virtual void AddRef() const = 0;
@@ -23,10 +23,16 @@
 #ifndef TFRT_HOST_CONTEXT_HOST_ALLOCATOR_H_
 #define TFRT_HOST_CONTEXT_HOST_ALLOCATOR_H_
 
+#include <atomic>
+#include <limits>
 #include <memory>
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/FunctionExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
 
 namespace tfrt {
 
@@ -57,30 +63,151 @@ class HostAllocator {
     DeallocateBytes(ptr, sizeof(T) * num_elements);
   }
 
+  // Sentinel NUMA node value meaning "no placement preference".
+  static constexpr int kAnyNumaNode = -1;
+
   // Allocate the specified number of bytes with the specified alignment.
   virtual void* AllocateBytes(size_t size, size_t alignment) = 0;
 
+  // Like AllocateBytes, but prefer placing the memory on the given NUMA
+  // node. Under work stealing, first touch lands buffers on whatever socket
+  // the producing thread happens to run on; with node-pinned worker threads
+  // this overload places a buffer on its consumers' node up front. The hint
+  // is best effort and the base implementation ignores it.
+  virtual void* AllocateBytes(size_t size, size_t alignment, int numa_node) {
+    return AllocateBytes(size, alignment);
+  }
+
   // Deallocate the specified pointer that has the specified size.
   virtual void DeallocateBytes(void* ptr, size_t size) = 0;
 
+  //===--------------------------------------------------------------------===//
+  // Watermark backpressure
+  //===--------------------------------------------------------------------===//
+  //
+  // Subsystems that produce into memory (e.g. prefetching input pipelines)
+  // can register bytes-in-use thresholds and throttle production instead of
+  // growing until the kernel OOM-kills the process. on_high fires when usage
+  // crosses above high_bytes, on_low when it falls back below low_bytes.
+  // Callbacks run synchronously on the thread doing the crossing allocation
+  // or deallocation; they must be cheap and must not allocate through this
+  // allocator.
+
+  // Registers a watermark pair; returns an id for UnregisterWatermark.
+  int RegisterWatermark(size_t low_bytes, size_t high_bytes,
+                        llvm::unique_function<void()> on_high,
+                        llvm::unique_function<void()> on_low);
+
+  // Unregisters a watermark. Blocks until any in-flight callback of this
+  // watermark has returned, so the callback's state may be destroyed after
+  // this call.
+  void UnregisterWatermark(int id);
+
+  // Current bytes in use as reported by the allocator implementation.
+  size_t BytesInUse() const {
+    return bytes_in_use_.load(std::memory_order_relaxed);
+  }
+
  protected:
+  // Allocator implementations report their logical bytes in use through
+  // these; the common case (no armed watermark near the current usage) is a
+  // relaxed atomic add and one load.
+  void TrackAllocation(size_t size) {
+    size_t bytes =
+        bytes_in_use_.fetch_add(size, std::memory_order_relaxed) + size;
+    if (bytes >= armed_high_.load(std::memory_order_relaxed))
+      CheckWatermarksSlow(bytes);
+  }
+
+  void TrackDeallocation(size_t size) {
+    size_t bytes =
+        bytes_in_use_.fetch_sub(size, std::memory_order_relaxed) - size;
+    if (bytes <= armed_low_.load(std::memory_order_relaxed))
+      CheckWatermarksSlow(bytes);
+  }
   friend class HostContext;
   friend class FixedSizeAllocator;
   friend class ProfiledAllocator;
+  friend class SizeClassAllocator;
   HostAllocator() = default;
   HostAllocator(const HostAllocator&) = delete;
   HostAllocator& operator=(const HostAllocator&) = delete;
 
  private:
+  struct Watermark {
+    int id;
+    size_t low_bytes;
+    size_t high_bytes;
+    // Whether usage last crossed above high_bytes without coming back below
+    // low_bytes yet.
+    bool above;
+    llvm::unique_function<void()> on_high;
+    llvm::unique_function<void()> on_low;
+  };
+
+  // Walks the registered watermarks, fires the callbacks for the crossings
+  // `bytes` implies, and re-arms the fast path thresholds.
+  void CheckWatermarksSlow(size_t bytes);
+
+  // Recomputes armed_high_/armed_low_ as the nearest thresholds whose
+  // crossing would change some watermark's state.
+  void RearmLocked() TFRT_REQUIRES(watermarks_mu_);
+
+  std::atomic<size_t> bytes_in_use_{0};
+  std::atomic<size_t> armed_high_{std::numeric_limits<size_t>::max()};
+  std::atomic<size_t> armed_low_{0};
+
+  mutex watermarks_mu_;
+  int next_watermark_id_ TFRT_GUARDED_BY(watermarks_mu_) = 0;
+  llvm::SmallVector<Watermark, 1> watermarks_ TFRT_GUARDED_BY(watermarks_mu_);
+
   virtual void VtableAnchor();
 };
 
-// Create an allocator that just calls malloc/free.
-std::unique_ptr<HostAllocator> CreateMallocAllocator();
+// Policy for backing large allocations with huge pages. Weight tensors are
+// hundreds of MB; backing them with 2MB pages instead of 4KB pages removes
+// most dTLB misses during GEMM. Only effective on Linux; elsewhere every
+// policy behaves like kNone.
+enum class HugePagePolicy {
+  // Always use 4KB pages.
+  kNone,
+  // Give large allocations their own huge-page-aligned anonymous mapping and
+  // madvise(MADV_HUGEPAGE) it. Purely advisory, so this is safe everywhere
+  // and is the default.
+  kTransparent,
+  // Like kTransparent, but try an explicit MAP_HUGETLB mapping first, which
+  // needs a reserved hugetlb pool; falls back to a transparent mapping.
+  kHugeTLB,
+};
+
+// Create an allocator that just calls malloc/free. Allocations large enough
+// to be weight tensors are backed by huge pages per `huge_page_policy`; a
+// NUMA node hint is honored on the same large-allocation mapping path (so a
+// policy of kNone also disables explicit NUMA placement), while small hinted
+// allocations rely on first touch by the node-pinned calling thread.
+std::unique_ptr<HostAllocator> CreateMallocAllocator(
+    HugePagePolicy huge_page_policy = HugePagePolicy::kTransparent);
+
+// Returns the NUMA node the calling thread is currently running on, or
+// HostAllocator::kAnyNumaNode if the topology cannot be determined. On a
+// work queue with node-pinned worker threads this is the natural allocation
+// hint for buffers the current task produces.
+int GetCurrentNumaNode();
+
+// Returns the number of NUMA nodes on this machine, or 1 if the topology
+// cannot be determined.
+int GetNumNumaNodes();
 
 // Create an allocator of fixed size for testing.
 std::unique_ptr<HostAllocator> CreateFixedSizeAllocator(size_t capacity = 1024);
 
+// Create a size-class caching allocator on top of `underlying`: freed blocks
+// are kept in per-thread caches backed by central per-class freelists and
+// reused for later allocations of the same size class, so high-churn tensor
+// workloads stop contending on the process-global heap.
+std::unique_ptr<HostAllocator> CreateSizeClassAllocator(
+    std::unique_ptr<HostAllocator> underlying);
+
 // Decorate an allocator with memory usage profiling.
 std::unique_ptr<HostAllocator> CreateProfiledAllocator(
     std::unique_ptr<HostAllocator> allocator);
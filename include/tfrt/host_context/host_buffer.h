@@ -23,10 +23,16 @@
 #ifndef TFRT_HOST_CONTEXT_HOST_BUFFER_H_
 #define TFRT_HOST_CONTEXT_HOST_BUFFER_H_
 
+#include <memory>
+
 #include "llvm/ADT/FunctionExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include "tfrt/support/ref_count.h"
 
+namespace llvm {
+class MemoryBuffer;
+}
+
 namespace tfrt {
 class HostAllocator;
 
@@ -42,6 +48,15 @@ class HostBuffer : public ReferenceCounted<HostBuffer> {
                                                      size_t alignment,
                                                      HostAllocator *allocator);
 
+  // Like the above, but prefer placing the buffer's memory on the given NUMA
+  // node (see HostAllocator::kAnyNumaNode and GetCurrentNumaNode()).
+  // NUMA-targeted buffers skip the freelist pool on creation so a recycled
+  // block from another node is never handed out.
+  static RCReference<HostBuffer> CreateUninitialized(size_t size,
+                                                     size_t alignment,
+                                                     HostAllocator *allocator,
+                                                     int numa_node);
+
   using Deallocator = llvm::unique_function<void(void *ptr, size_t size)>;
   // Create a HostBuffer by taking ownership of an externally allocated buffer.
   // `deallocator` is called with `ptr` and `size` as arguments when we destroy
@@ -49,6 +64,28 @@ class HostBuffer : public ReferenceCounted<HostBuffer> {
   static RCReference<HostBuffer> CreateFromExternal(void *ptr, size_t size,
                                                     Deallocator deallocator);
 
+  // Create a HostBuffer over the [offset, offset+size) window of `parent`,
+  // sharing ownership: the parent is kept alive until the child is destroyed,
+  // and no data is copied. This is the zero-copy path for splitting a large
+  // buffer (e.g. a batched inference result) into per-consumer pieces.
+  static RCReference<HostBuffer> CreateFromParent(
+      RCReference<HostBuffer> parent, size_t offset, size_t size);
+
+  // Create a HostBuffer view over the contents of an llvm::MemoryBuffer
+  // without copying them. llvm::MemoryBuffer memory-maps large files, so this
+  // is the zero-copy path for backing tensors directly by file contents. The
+  // MemoryBuffer (and thus the mapping) is kept alive until the returned
+  // buffer is destroyed.
+  static RCReference<HostBuffer> CreateFromExternal(
+      std::unique_ptr<llvm::MemoryBuffer> buffer);
+
+  // Return all pooled buffer memory obtained from `allocator` back to it.
+  // Destroyed buffers created by CreateUninitialized are recycled through
+  // bounded per-size freelists rather than deallocated, so this must be
+  // called before `allocator` is destroyed. HostContext does this for its
+  // own allocator.
+  static void FlushPool(HostAllocator *allocator);
+
   void *data() {
     if (is_inlined_) return &inlined_.data[0];
     return out_of_line_.ptr;
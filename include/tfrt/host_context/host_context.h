@@ -23,11 +23,16 @@
 #ifndef TFRT_HOST_CONTEXT_HOST_CONTEXT_H_
 #define TFRT_HOST_CONTEXT_HOST_CONTEXT_H_
 
+#include <cstdint>
 #include <type_traits>
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/Compiler.h"
 #include "tfrt/host_context/async_value_ref.h"
 #include "tfrt/host_context/kernel_registry.h"
+#include "tfrt/host_context/task_function.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
 
 namespace tfrt {
 
@@ -35,6 +40,8 @@ class DecodedDiagnostic;
 
 class Chain;
 class ConcurrentWorkQueue;
+class ExecutionContext;
+enum class TaskPriority : uint8_t;
 class HostAllocator;
 class TypeDescriptor;
 class IndirectAsyncValue;
@@ -92,6 +99,11 @@ class HostContext {
     return diag_handler_;
   }
 
+  // Return true if a diagnostic handler is installed. Callers can use this to
+  // skip constructing expensive diagnostics (e.g. decoding locations) that
+  // nobody would observe.
+  bool HasDiagHandler() const { return static_cast<bool>(diag_handler_); }
+
   //===--------------------------------------------------------------------===//
   // Cancel the current execution
   //===--------------------------------------------------------------------===//
@@ -151,6 +163,38 @@ class HostContext {
     Deallocate(t);
   }
 
+  // Allocate memory for an AsyncValue out of a per-thread slab of fixed-size
+  // blocks. AsyncValues are small and allocated at a very high rate, so the
+  // slab allocator recycles blocks across executor invocations without going
+  // to the HostAllocator. Oversized values fall back to AllocateBytes.
+  void* AllocateAsyncValueBytes(size_t size, size_t alignment);
+
+  // Return memory obtained from AllocateAsyncValueBytes to the current
+  // thread's freelist (or to DeallocateBytes for oversized values).
+  void DeallocateAsyncValueBytes(void* ptr, size_t size);
+
+  // Counters for the AsyncValue slab allocator, for verifying hit rates in
+  // production. The hit rate is freelist_hits over the sum of the first
+  // three counters; fallbacks count oversized values that bypassed the slab
+  // entirely. Counters are process wide (the slab state is per thread, not
+  // per HostContext) and the hit counter is flushed in batches off the fast
+  // path, so a snapshot can trail the true totals slightly.
+  struct AsyncValueSlabStats {
+    int64_t freelist_hits = 0;  // served from a thread-local freelist
+    int64_t depot_refills = 0;  // magazines fetched from the shared depot
+    int64_t slab_carves = 0;    // blocks carved from fresh slabs
+    int64_t fallbacks = 0;      // oversized values sent to AllocateBytes
+  };
+  static AsyncValueSlabStats GetAsyncValueSlabStats();
+
+  // Allocate and initialize an AsyncValue subclass of type T through the
+  // per-thread slab allocator.
+  template <typename T, typename... Args>
+  T* ConstructAsyncValue(Args&&... args) {
+    void* buf = AllocateAsyncValueBytes(sizeof(T), alignof(T));
+    return new (buf) T(std::forward<Args>(args)...);
+  }
+
   // Allocate an unconstructed AsyncValueRef. The AsyncValueRef should be made
   // available later by invoking AsyncValueRef::emplace or
   // AsyncValueRef::SetError.
@@ -190,7 +234,61 @@ class HostContext {
   void Quiesce();
 
   // Add some non-blocking work to the work_queue managed by this CPU device.
-  void EnqueueWork(llvm::unique_function<void()> work);
+  // Taking TaskFunction (rather than llvm::unique_function) lets closures at
+  // the call site move straight into the task's cache-line-sized inline
+  // buffer, so enqueueing does not allocate for common continuation shapes.
+  void EnqueueWork(TaskFunction work);
+
+  // Add some non-blocking work to the work_queue managed by this CPU device
+  // with an explicit priority lane. High priority work is drained before
+  // default priority work, isolating latency-critical graphs from background
+  // batch work sharing this HostContext.
+  void EnqueueWork(TaskFunction work, TaskPriority priority);
+
+  // Add a batch of non-blocking work to the work_queue managed by this CPU
+  // device, publishing the whole batch with a single synchronization episode.
+  // `works` is consumed: all elements are moved out. This is the preferred
+  // API for wide fan-out call sites (e.g. one AsyncValue feeding many
+  // downstream kernels).
+  void EnqueueWork(MutableArrayRef<TaskFunction> works);
+
+  // Bound the number of admission-controlled tasks in flight on a priority
+  // lane. A task submitted through TryEnqueueWork or
+  // EnqueueWorkWithBackpressure counts against its lane's budget from
+  // admission until it finishes running. EnqueueWork is unaffected, so
+  // runtime-internal continuations can never be rejected - only new
+  // request-level work is. A budget of 0 (the default) admits everything.
+  void SetWorkAdmissionBudget(TaskPriority priority, size_t max_pending);
+
+  // Admit `work` on `priority`'s lane if it is under budget. Returns false
+  // without enqueueing when the lane is full: shedding a request at
+  // admission keeps it from queueing up only to time out later (congestive
+  // collapse under traffic spikes).
+  LLVM_NODISCARD bool TryEnqueueWork(TaskFunction work, TaskPriority priority);
+
+  // Like TryEnqueueWork, but blocks the calling thread until the lane has
+  // room: backpressure instead of load shedding. Must not be called from a
+  // thread managed by the work queue.
+  void EnqueueWorkWithBackpressure(TaskFunction work, TaskPriority priority);
+
+  // Set the weight of a tenant for weighted fair scheduling (see
+  // EnqueueWorkForTenant). Worker time is shared between backlogged tenants
+  // in proportion to their weights. Unconfigured tenants have weight 1;
+  // weights below 1 are clamped to 1.
+  void SetTenantWeight(int tenant_id, int weight);
+
+  // Add some non-blocking work on behalf of a tenant. When several models
+  // share this HostContext, per-tenant submission queues and a stride
+  // scheduler ensure each tenant's work is dispatched to the underlying
+  // work queue in proportion to its weight, so one tenant's burst cannot
+  // starve the others. Plain EnqueueWork bypasses tenant scheduling, so
+  // runtime-internal continuations are never delayed. The tenant id
+  // typically comes from ExecutionContext::tenant_id().
+  void EnqueueWorkForTenant(int tenant_id, TaskFunction work);
+
+  // Convenience overload taking the tenant id from `exec_ctx`.
+  void EnqueueWorkForTenant(const ExecutionContext& exec_ctx,
+                            TaskFunction work);
 
   // Add some non-blocking work to the work_queue managed by this CPU device.
   // Return AsyncValueRef<R> for work that returns R. R cannot be void.
@@ -203,7 +301,7 @@ class HostContext {
   LLVM_NODISCARD AsyncValueRef<R> EnqueueWork(F&& work);
 
   // Add some blocking work to the work_queue managed by this CPU device.
-  LLVM_NODISCARD bool EnqueueBlockingWork(llvm::unique_function<void()> work);
+  LLVM_NODISCARD bool EnqueueBlockingWork(TaskFunction work);
 
   // Add some blocking work to the work_queue managed by this CPU device.
   template <typename F, typename R = ResultTypeT<F>,
@@ -264,6 +362,26 @@ class HostContext {
   SharedContext& GetOrCreateSharedContext(int shared_context_id,
                                           SharedContextFactory factory);
 
+  // Wrap admitted work so its completion releases the lane slot.
+  void EnqueueAdmittedWork(TaskFunction work, TaskPriority priority);
+
+  // One admission lane per TaskPriority value.
+  static constexpr size_t kNumAdmissionLanes = 2;
+
+  // Per-tenant submission queue for weighted fair scheduling; defined in
+  // host_context.cc.
+  struct TenantQueue;
+
+  // Dispatch one task from the tenant with the smallest virtual finish
+  // time, then hand the worker back to the queue (re-enqueueing itself when
+  // backlog remains) so tenant work interleaves with other queued work.
+  void RunOneTenantTask();
+
+  // Upper bound on concurrently dispatched tenant runners; matching the
+  // queue's parallelism keeps all workers busy without flooding the queue
+  // with tasks whose relative order the scheduler can no longer control.
+  int MaxTenantRunners() const;
+
   std::atomic<AsyncValue*> cancel_value_{nullptr};
   // Store a ready chain in HostContext to avoid repeated creations of ready
   // chains on the heap.
@@ -273,31 +391,50 @@ class HostContext {
   std::unique_ptr<HostAllocator> allocator_;
   std::unique_ptr<ConcurrentWorkQueue> work_queue_;
 
+  mutex admission_mu_;
+  condition_variable admission_cv_;
+  size_t admission_budget_[kNumAdmissionLanes] TFRT_GUARDED_BY(admission_mu_) =
+      {0, 0};
+  size_t admission_pending_[kNumAdmissionLanes] TFRT_GUARDED_BY(
+      admission_mu_) = {0, 0};
+
+  mutex tenant_mu_;
+  llvm::DenseMap<int, std::unique_ptr<TenantQueue>> tenant_queues_
+      TFRT_GUARDED_BY(tenant_mu_);
+  // Number of tenant runner tasks currently circulating in the work queue.
+  int tenant_runners_ TFRT_GUARDED_BY(tenant_mu_) = 0;
+  // Virtual time of the last dispatch: the pass of the tenant it was taken
+  // from. Newly backlogged tenants start here so idle time earns no credit.
+  uint64_t tenant_virtual_time_ TFRT_GUARDED_BY(tenant_mu_) = 0;
+
   std::unique_ptr<SharedContextManager> shared_context_mgr_;
   const HostContextPtr instance_ptr_;
 };
 
 template <typename T, typename... Args>
 AsyncValueRef<T> HostContext::MakeConstructedAsyncValueRef(Args&&... args) {
-  return AsyncValueRef<T>(TakeRef(Construct<internal::ConcreteAsyncValue<T>>(
-      instance_ptr_,
-      typename internal::ConcreteAsyncValue<T>::ConstructedPayload{},
-      std::forward<Args>(args)...)));
+  return AsyncValueRef<T>(
+      TakeRef(ConstructAsyncValue<internal::ConcreteAsyncValue<T>>(
+          instance_ptr_,
+          typename internal::ConcreteAsyncValue<T>::ConstructedPayload{},
+          std::forward<Args>(args)...)));
 }
 
 template <typename T, typename... Args>
 AsyncValueRef<T> HostContext::MakeAvailableAsyncValueRef(Args&&... args) {
-  return AsyncValueRef<T>(TakeRef(Construct<internal::ConcreteAsyncValue<T>>(
-      instance_ptr_,
-      typename internal::ConcreteAsyncValue<T>::ConcretePayload{},
-      std::forward<Args>(args)...)));
+  return AsyncValueRef<T>(
+      TakeRef(ConstructAsyncValue<internal::ConcreteAsyncValue<T>>(
+          instance_ptr_,
+          typename internal::ConcreteAsyncValue<T>::ConcretePayload{},
+          std::forward<Args>(args)...)));
 }
 
 template <typename T>
 AsyncValueRef<T> HostContext::MakeUnconstructedAsyncValueRef() {
-  return AsyncValueRef<T>(TakeRef(Construct<internal::ConcreteAsyncValue<T>>(
-      instance_ptr_,
-      typename internal::ConcreteAsyncValue<T>::UnconstructedPayload{})));
+  return AsyncValueRef<T>(
+      TakeRef(ConstructAsyncValue<internal::ConcreteAsyncValue<T>>(
+          instance_ptr_,
+          typename internal::ConcreteAsyncValue<T>::UnconstructedPayload{})));
 }
 
 template <typename SharedContextType>
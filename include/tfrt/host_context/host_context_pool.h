@@ -0,0 +1,88 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- host_context_pool.h - Sharded HostContext pool -----------*- C++ -*-===//
+//
+// A single HostContext with one work queue stops scaling somewhere around 48
+// cores: queue and allocator contention flattens the curve. This file
+// declares HostContextPool, which runs N HostContexts - each with its own
+// allocator and its own work queue whose workers are pinned to one NUMA node
+// - so that request streams can be sharded across contexts with no shared
+// mutable state between shards. Results produced on one shard move to
+// another with TensorHandle::TransferTo, which shares the underlying host
+// buffer rather than copying.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_HOST_CONTEXT_HOST_CONTEXT_POOL_H_
+#define TFRT_HOST_CONTEXT_HOST_CONTEXT_POOL_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tfrt/host_context/host_context.h"
+
+namespace tfrt {
+
+class HostContextPool {
+ public:
+  struct Options {
+    // Number of contexts (shards). 0 means one per NUMA node.
+    int num_contexts = 0;
+
+    // Non-blocking worker threads per context. 0 divides the hardware
+    // concurrency evenly among the contexts.
+    int num_threads_per_context = 0;
+
+    // Blocking (IO) worker threads per context.
+    int num_blocking_threads_per_context = 4;
+
+    // Diagnostic handler shared by all contexts. Must be thread-safe; errors
+    // from all shards funnel through it concurrently.
+    std::function<void(const DecodedDiagnostic&)> diag_handler;
+  };
+
+  explicit HostContextPool(const Options& options);
+
+  HostContextPool(const HostContextPool&) = delete;
+  HostContextPool& operator=(const HostContextPool&) = delete;
+
+  size_t size() const { return contexts_.size(); }
+
+  HostContext* GetContext(size_t index) const {
+    assert(index < contexts_.size());
+    return contexts_[index].get();
+  }
+
+  // Returns contexts round-robin. The intended pattern is one call per
+  // request (or request stream), so consecutive requests land on different
+  // shards.
+  HostContext* NextContext() {
+    return contexts_[next_.fetch_add(1, std::memory_order_relaxed) %
+                     contexts_.size()]
+        .get();
+  }
+
+ private:
+  std::vector<std::unique_ptr<HostContext>> contexts_;
+  std::atomic<size_t> next_{0};
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_HOST_CONTEXT_HOST_CONTEXT_POOL_H_
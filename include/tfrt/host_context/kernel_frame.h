@@ -35,6 +35,7 @@
 #include "tfrt/host_context/execution_context.h"
 #include "tfrt/host_context/host_context.h"
 #include "tfrt/host_context/location.h"
+#include "tfrt/host_context/scratch_arena.h"
 #include "tfrt/support/forward_decls.h"
 #include "tfrt/support/string_util.h"
 
@@ -187,6 +188,24 @@ class KernelFrame {
     return GetMutableAsyncValues(num_arguments_, num_results_);
   }
 
+  // Get all results as RCReferences aliasing the frame's result slots. A
+  // result slot holds a +1 reference once it is set, which is exactly the
+  // invariant RCReference maintains, so writing through this view transfers
+  // ownership straight into the frame: no side buffer and no copy-out step.
+  // Replacing an already-set slot (e.g. an error stored by ReportError)
+  // drops the old reference like any RCReference assignment.
+  MutableArrayRef<RCReference<AsyncValue>> GetResultRefs() {
+    static_assert(sizeof(RCReference<AsyncValue>) == sizeof(AsyncValue*),
+                  "RCReference must be pointer-sized to alias result slots");
+    static_assert(alignof(RCReference<AsyncValue>) == alignof(AsyncValue*),
+                  "RCReference must be pointer-aligned to alias result slots");
+    MutableArrayRef<AsyncValue*> results =
+        GetMutableAsyncValues(num_arguments_, num_results_);
+    return llvm::makeMutableArrayRef(
+        reinterpret_cast<RCReference<AsyncValue>*>(results.data()),
+        results.size());
+  }
+
   // Example usage:
   //
   // kernel_handler.ReportError("This is an error message");
@@ -212,6 +231,17 @@ class KernelFrame {
     return EmitErrorAsync(exec_ctx_, msg);
   }
 
+  // Get the scratch arena for this kernel invocation. Scratch allocations
+  // cost a pointer increment and are reclaimed wholesale when the invocation
+  // completes, so this is the cheap way to get transient buffers (im2col
+  // scratch, sort temporaries, ...). The returned memory must not be
+  // referenced after the synchronous part of the kernel returns; in
+  // particular, async continuations must not use it.
+  ScratchArena* GetScratchArena() const {
+    assert(scratch_arena_ && "KernelFrame has no scratch arena");
+    return scratch_arena_;
+  }
+
   // Assert the size of arguments, attributes, and results are as expected.
   void AssertArity(int num_arguments, int num_attributes,
                    int num_results) const;
@@ -250,6 +280,10 @@ class KernelFrame {
   int num_results_ = -1;
   ArrayRef<uint8_t> attribute_section_;
   ExecutionContext exec_ctx_;
+  // Points at the arena owned by the KernelFrameBuilder this frame was built
+  // with; copies of the frame (e.g. RAIIKernelFrame) share the pointer but
+  // not the lifetime.
+  ScratchArena* scratch_arena_ = nullptr;
 };
 
 // KernelFrameBuilder is used by the kernel caller to construct a KernelFrame
@@ -263,7 +297,9 @@ class KernelFrame {
 // 3. Add the attributes (using AddAttribute())
 class KernelFrameBuilder : public KernelFrame {
  public:
-  explicit KernelFrameBuilder(HostContext* host) : KernelFrame{host} {}
+  explicit KernelFrameBuilder(HostContext* host) : KernelFrame{host} {
+    scratch_arena_ = &owned_scratch_arena_;
+  }
 
   // Get result AsyncValue at the given index.
   AsyncValue* GetResultAt(int index) const { return GetResults()[index]; }
@@ -304,12 +340,22 @@ class KernelFrameBuilder : public KernelFrame {
     exec_ctx_.set_location(location);
   }
 
-  // Clear all fields.
+  // Set the cancellation token kernels see through GetExecutionContext().
+  void SetCancellationToken(RCReference<CancellationToken> token) {
+    exec_ctx_.set_cancellation_token(std::move(token));
+  }
+
+  // Clear all fields and reclaim the scratch memory handed out to the
+  // previous kernel invocation.
   void Reset() {
     async_value_or_attrs_.clear();
     num_arguments_ = 0;
     num_results_ = -1;
+    owned_scratch_arena_.Reset();
   }
+
+ private:
+  ScratchArena owned_scratch_arena_;
 };
 
 // RAIIKernelFrame is like KernelFrame, but adds a ref to each contained value
@@ -23,6 +23,7 @@
 #ifndef TFRT_HOST_CONTEXT_KERNEL_REGISTRY_H_
 #define TFRT_HOST_CONTEXT_KERNEL_REGISTRY_H_
 
+#include <cstdint>
 #include <memory>
 
 #include "llvm/ADT/StringRef.h"
@@ -33,11 +34,84 @@ namespace tfrt {
 class TypeName;
 class KernelFrame;
 class HostContext;
+class AsyncValue;
 
 // Kernel implementations use this signature, synchronously or asynchronously
 // performing some computation and updating results.
 using KernelImplementation = void (*)(KernelFrame* frame);
 
+// The invocation record for the direct-call variant of a trivial synchronous
+// kernel. The executor fills in the argument AsyncValues (all available) and
+// the attribute pointers decoded from the BEF attribute section; the kernel
+// stores each result as an available AsyncValue into `results`. There is no
+// KernelFrame, no location and no error handler, so only kernels that cannot
+// fail qualify (see TFRT_SYNC_KERNEL in kernel_utils.h).
+struct SyncKernelInvocation {
+  AsyncValue* const* arguments;
+  const void* const* attributes;
+  RCReference<AsyncValue>* results;
+  HostContext* host;
+};
+
+// Direct-call implementations of trivial synchronous kernels use this
+// signature, bypassing the KernelFrame entirely.
+using SyncKernelImplementation = void (*)(const SyncKernelInvocation& inv);
+
+// A compact description of the call-site shape a kernel expects: how many
+// arguments, attributes (including function attributes) and results. It is
+// derived from the kernel's C++ signature by TFRT_KERNEL and validated
+// against every call site once at BEF load time, so dispatch never has to
+// check it again. A kUnchecked count means the dimension cannot be
+// validated: hand-written frame functions, variadic kernels, and kernels
+// that take the KernelFrame directly.
+struct KernelSignature {
+  static constexpr int8_t kUnchecked = -1;
+  int8_t num_arguments = kUnchecked;
+  int8_t num_attributes = kUnchecked;
+  int8_t num_results = kUnchecked;
+};
+
+// How a kernel interacts with state outside of its own arguments and
+// results. Registration may annotate each kernel with the strongest effect
+// it can have; the default is kIO, the most conservative. Tools that order
+// side effects (the chain-threading in generated programs, and optimizers
+// that prune ordering edges) may only relax ordering between kernels whose
+// declared effects cannot conflict.
+enum class KernelEffect : uint8_t {
+  // Reads nothing but its arguments and writes nothing but its results.
+  kPure,
+  // Reads state outside its arguments (e.g. a resource or variable) but
+  // does not modify it.
+  kReadsState,
+  // Modifies state outside its results.
+  kWritesState,
+  // Performs externally visible I/O (printing, files, network). This is
+  // the conservative default for unannotated kernels.
+  kIO,
+};
+
+// Return true if kernels with the two effects must stay ordered relative
+// to each other. Pure kernels never conflict, and two readers of state do
+// not conflict; every other combination does.
+inline bool KernelEffectsConflict(KernelEffect a, KernelEffect b) {
+  if (a == KernelEffect::kPure || b == KernelEffect::kPure) return false;
+  if (a == KernelEffect::kReadsState && b == KernelEffect::kReadsState)
+    return false;
+  return true;
+}
+
+// Bundles a kernel implementation with its signature. TFRT_KERNEL expands
+// to one of these; a bare KernelImplementation converts implicitly, with an
+// unchecked signature.
+struct KernelDescriptor {
+  KernelDescriptor(KernelImplementation fn) : fn(fn) {}
+  KernelDescriptor(KernelImplementation fn, KernelSignature signature)
+      : fn(fn), signature(signature) {}
+
+  KernelImplementation fn;
+  KernelSignature signature;
+};
+
 namespace internal {
 
 template <typename TraitT>
@@ -45,22 +119,127 @@ KernelImplementation AsBEFKernel();
 
 }  // namespace internal
 
+class KernelRegistry;
+
+// The type for kernel registration functions. This is the same as the
+// prototype for the entry point function for dynamic plugins.
+using KernelRegistration = void (*)(KernelRegistry*);
+
 // This represents a mapping between the names of the MLIR opcodes to the
-// implementations of those functions, along with type mappings.
+// implementations of those functions, along with type mappings. All methods
+// are individually thread-safe; name lookups may run pending lazy
+// registrations (see AddKernelRegistration).
 class KernelRegistry {
  public:
   ~KernelRegistry();
   KernelRegistry(const KernelRegistry&) = delete;
   KernelRegistry& operator=(const KernelRegistry&) = delete;
 
-  void AddKernel(string_view name, KernelImplementation fn);
+  void AddKernel(string_view name, KernelDescriptor kernel,
+                 KernelEffect effect = KernelEffect::kIO);
   template <typename KernelTraitT>
   void AddKernel(string_view name) {
     AddKernel(name, internal::AsBEFKernel<KernelTraitT>());
   }
 
+  // Attach a registration function to run lazily. `prefixes` is a
+  // comma-separated list of the kernel name prefixes (the part before the
+  // first '.') that `fn` registers; `fn` runs the first time a kernel with
+  // one of those prefixes is looked up by name. An empty `prefixes` runs
+  // `fn` on the first name lookup of any kernel. Attaching is cheap, so a
+  // registry whose kernels are never looked up costs almost nothing to
+  // build. `prefixes` must outlive the registry (string literals do).
+  void AddKernelRegistration(KernelRegistration fn, const char* prefixes);
+
+  // Register a kernel that is guaranteed to complete all of its results
+  // before returning (it never produces an unavailable AsyncValue). The BEF
+  // executor uses this to execute the kernel fully inline: results are
+  // written into registers as available values and their users are enqueued
+  // directly, with none of the waiter-list machinery needed for
+  // asynchronous results.
+  //
+  // `direct_fn`, if supplied, is a direct-call variant of the same kernel
+  // (see SyncKernelInvocation) that the executor's inline fast path invokes
+  // without building a KernelFrame. TFRT_SYNC_KERNEL in kernel_utils.h
+  // expands to the (fn, direct_fn) pair.
+  void AddSyncKernel(string_view name, KernelDescriptor kernel,
+                     SyncKernelImplementation direct_fn = nullptr,
+                     KernelEffect effect = KernelEffect::kIO);
+  void AddSyncKernel(string_view name, KernelDescriptor kernel,
+                     KernelEffect effect) {
+    AddSyncKernel(name, kernel, nullptr, effect);
+  }
+
   KernelImplementation GetKernel(string_view name) const;
 
+  // Return the signature the kernel was registered with. Kernels registered
+  // from a bare KernelImplementation (and unregistered names) report an
+  // unchecked signature.
+  KernelSignature GetKernelSignature(string_view name) const;
+
+  // Return the effect the kernel was registered with. Kernels registered
+  // without an annotation (and unregistered names) report KernelEffect::kIO,
+  // the conservative answer.
+  KernelEffect GetKernelEffect(string_view name) const;
+
+  // Return true if the kernel was registered with AddSyncKernel.
+  bool IsSyncKernel(string_view name) const;
+
+  // Return the direct-call variant of the kernel, or null if the kernel was
+  // registered without one (or is not registered at all).
+  SyncKernelImplementation GetDirectSyncKernel(string_view name) const;
+
+  // Each kernel is also assigned a dense id in registration order. For a
+  // fixed binary resolving the same programs in the same order, lazy
+  // registrations materialize in the same order too, so ids are stable
+  // across restarts, which allows load-time kernel resolution to be cached
+  // persistently; see BEFFile::OpenFromFile. Callers must validate such
+  // caches against GetFingerprint() before trusting cached ids.
+
+  // Return the dense id of the kernel, or -1 if it is not registered.
+  ssize_t GetKernelId(string_view name) const;
+
+  // Return the kernel with the given dense id, or null if the id is out of
+  // range.
+  KernelImplementation GetKernelById(size_t id) const;
+
+  // Return true if the kernel with the given dense id was registered with
+  // AddSyncKernel.
+  bool IsSyncKernelById(size_t id) const;
+
+  // Return the direct-call variant of the kernel with the given dense id,
+  // or null if there is none.
+  SyncKernelImplementation GetDirectSyncKernelById(size_t id) const;
+
+  // Return the signature of the kernel with the given dense id, or an
+  // unchecked signature if the id is out of range.
+  KernelSignature GetKernelSignatureById(size_t id) const;
+
+  // Return the effect of the kernel with the given dense id, or
+  // KernelEffect::kIO if the id is out of range.
+  KernelEffect GetKernelEffectById(size_t id) const;
+
+  // Freeze the registry: run all pending lazy registrations, then publish
+  // the registration tables as immutable. Registering into a frozen
+  // registry is a programming error. After freezing, every lookup is
+  // lock-free - id-based lookups index the flat tables directly and
+  // by-name lookups binary-search a sorted name table instead of hashing -
+  // and kernel ids and KernelImplementation pointers are stable for the
+  // registry's remaining lifetime, so loaded BEF files can keep referring
+  // to them directly. Call it once startup registration is complete.
+  // Thread-safe; freezing an already-frozen registry is a no-op.
+  void Freeze();
+
+  // Return true if Freeze() has been called.
+  bool IsFrozen() const;
+
+  // Return a fingerprint of the registered kernel names in registration
+  // order. The fingerprint is stable across processes (unlike
+  // llvm::hash_value) and changes whenever the set or order of
+  // registrations changes. The fingerprint describes the full registration
+  // set, so this runs any still-pending lazy registrations first.
+  uint64_t GetFingerprint() const;
+
   TypeName GetType(string_view type) const;
 
  private:
@@ -72,28 +251,40 @@ class KernelRegistry {
 
 // Use this macro to add a function that will register kernels that are
 // statically linked in the binary. FUNC should be a function pointer with the
-// prototype given by the tfrt::KernelRegistration alias.
+// prototype given by the tfrt::KernelRegistration alias. The function runs
+// lazily, on the first name lookup of any kernel; prefer the _PREFIXED
+// variant below so it only runs when its own kernels are looked up.
 #define TFRT_STATIC_KERNEL_REGISTRATION(FUNC) \
-  TFRT_STATIC_KERNEL_REGISTRATION_(FUNC, __COUNTER__)
-#define TFRT_STATIC_KERNEL_REGISTRATION_(FUNC, N) \
-  TFRT_STATIC_KERNEL_REGISTRATION__(FUNC, N)
-#define TFRT_STATIC_KERNEL_REGISTRATION__(FUNC, N)          \
-  static bool tfrt_static_kernel_##N##_registered_ = []() { \
-    ::tfrt::AddStaticKernelRegistration(FUNC);              \
-    return true;                                            \
-  }()
+  TFRT_STATIC_KERNEL_REGISTRATION_(FUNC, "", __COUNTER__)
 
-// The type for kernel registration functions. This is the same as the
-// prototype for the entry point function for dynamic plugins.
-using KernelRegistration = void (*)(KernelRegistry*);
+// Like TFRT_STATIC_KERNEL_REGISTRATION, with FUNC tagged by the
+// comma-separated list of kernel name prefixes (the part before the first
+// '.') it registers, e.g. "dht,coo". FUNC then runs only when a kernel with
+// one of those prefixes is first looked up, so binaries that never touch
+// this library's kernels never pay for building its registry entries.
+#define TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(FUNC, PREFIXES) \
+  TFRT_STATIC_KERNEL_REGISTRATION_(FUNC, PREFIXES, __COUNTER__)
+
+#define TFRT_STATIC_KERNEL_REGISTRATION_(FUNC, PREFIXES, N) \
+  TFRT_STATIC_KERNEL_REGISTRATION__(FUNC, PREFIXES, N)
+#define TFRT_STATIC_KERNEL_REGISTRATION__(FUNC, PREFIXES, N) \
+  static bool tfrt_static_kernel_##N##_registered_ = []() {  \
+    ::tfrt::AddStaticKernelRegistration(FUNC, PREFIXES);     \
+    return true;                                             \
+  }()
 
-// This is called to register all the statically linked kernels in the given
-// registry.
+// This is called to attach all the statically linked kernel registrations to
+// the given registry. Attaching is cheap: the registration functions are
+// recorded and run lazily, on the first lookup of a kernel with a matching
+// name prefix (see AddKernelRegistration), so short-lived tools do not pay
+// for building registry entries they never use.
 void RegisterStaticKernels(KernelRegistry* kernel_reg);
 
-// Adds a kernel to the registry. This should not be used directly; use
-// TFRT_STATIC_KERNEL_REGISTRATION instead.
-void AddStaticKernelRegistration(KernelRegistration func);
+// Adds a kernel registration to the static list. This should not be used
+// directly; use TFRT_STATIC_KERNEL_REGISTRATION instead. `prefixes` has the
+// same meaning as in KernelRegistry::AddKernelRegistration.
+void AddStaticKernelRegistration(KernelRegistration func,
+                                 const char* prefixes = "");
 
 }  // namespace tfrt
 
@@ -36,6 +36,7 @@
 #include "tfrt/host_context/kernel_frame.h"
 #include "tfrt/host_context/kernel_registry.h"
 #include "tfrt/host_context/location.h"
+#include "tfrt/host_context/resumable_task.h"
 #include "tfrt/support/bef_encoding.h"
 #include "tfrt/support/rc_array.h"
 #include "tfrt/support/type_traits.h"
@@ -123,14 +124,67 @@ namespace tfrt {
 // WARNING: KernelErrorHandler can't be used asynchronously because it holds a
 // pointer to the KernelFrame, which is destroyed when the kernel returns.
 //
+// Long-running kernels that need to wait for async values mid-execution can
+// be written as resumable tasks instead of nesting AndThen continuations:
+// allocate the results through Result<>, then return a KernelTask wrapping
+// the step function that completes them. Each `return
+// TaskResumption::AwaitOn(v)` suspends the task - the analogue of a
+// co_await - and the work queue resumes the step once `v` is available,
+// without holding a thread in between (see resumable_task.h):
+//
+//   KernelTask ReadFile(Argument<std::string> path,
+//                       Result<std::string> bytes, HostContext* host) {
+//     auto out = bytes.Allocate();
+//     auto pending = StartRead(*path);
+//     return KernelTask([out = out.CopyRef(),
+//                        pending = std::move(pending)]() mutable {
+//       if (!pending.IsAvailable()) return TaskResumption::AwaitOn(pending);
+//       out.emplace(pending.get());
+//       return TaskResumption::Done();
+//     });
+//   }
+//
 // Kernels can also take the KernelFrame if they need access to the HostContext
 // or anything else the above wrapper types don't provide.
 //
 // See the definitions of the wrapper types below for more details.
 //
+// TFRT_KERNEL expands to a KernelDescriptor carrying both the kernel entry
+// point and the call-site shape implied by the C++ signature. The shape is
+// validated against every BEF call site once at load time, so dispatch runs
+// without per-invocation signature checks (see KernelSignature in
+// kernel_registry.h).
+//
 // TODO(b/141203112): Switch to template when we can use C++17.
-#define TFRT_KERNEL(...) \
-  ::tfrt::TfrtKernelImpl<decltype(&__VA_ARGS__), &__VA_ARGS__>::Invoke
+#define TFRT_KERNEL(...)                                        \
+  ::tfrt::KernelDescriptor(                                     \
+      ::tfrt::TfrtKernelImpl<decltype(&__VA_ARGS__),            \
+                             &__VA_ARGS__>::Invoke,             \
+      ::tfrt::TfrtKernelImpl<decltype(&__VA_ARGS__),            \
+                             &__VA_ARGS__>::Signature())
+
+// TFRT_SYNC_KERNEL is a variant of TFRT_KERNEL for trivial synchronous
+// kernels registered with KernelRegistry::AddSyncKernel. It expands to two
+// implementations: the KernelFrame-based one above, and a direct-call
+// variant that the executor's inline fast path invokes with raw argument
+// and attribute pointer arrays, with no KernelFrame in between (see
+// SyncKernelInvocation in kernel_registry.h). For kernels like hex.add.i32
+// the frame setup costs more than the kernel itself; the direct call
+// removes it entirely:
+//
+//   registry->AddSyncKernel("hex.add.i32",
+//                           TFRT_SYNC_KERNEL(HexAdd<int32_t>));
+//
+// Only signatures made up of plain value arguments, Argument<> and
+// Attribute<>, with results returned by value (including std::pair and
+// std::tuple) qualify. Anything that needs the frame - Result<>, variadic
+// arguments or results, string or typed attributes, KernelErrorHandler,
+// Expected<> returns - is rejected at compile time and must use
+// TFRT_KERNEL.
+#define TFRT_SYNC_KERNEL(...)                                \
+  TFRT_KERNEL(__VA_ARGS__),                                  \
+      ::tfrt::TfrtKernelImpl<decltype(&__VA_ARGS__),         \
+                             &__VA_ARGS__>::DirectInvoke
 
 // Kernels should use this so we know the kernel has an argument.
 template <typename T>
@@ -422,6 +476,28 @@ struct TfrtKernelImpl<Return (*)(Args...), impl_fn> {
         frame);
   }
 
+  // The direct-call entry point for the executor's inline fast path: raw
+  // argument and attribute pointer arrays in, available result AsyncValues
+  // out, no KernelFrame (see TFRT_SYNC_KERNEL above).
+  static void DirectInvoke(const SyncKernelInvocation& inv) {
+    DirectCallHelper<Args...>::template Invoke<0, 0>(inv);
+  }
+
+  // The call-site shape implied by the C++ signature, validated against BEF
+  // call sites once at load time (see KernelSignature).
+  static KernelSignature Signature() {
+    using Counter = SignatureCounter<Args...>;
+    KernelSignature signature;
+    if (!Counter::kUncheckedArguments)
+      signature.num_arguments = Counter::kArguments;
+    if (!Counter::kUncheckedAttributes)
+      signature.num_attributes = Counter::kAttributes;
+    if (!Counter::kUncheckedResults)
+      signature.num_results =
+          Counter::kResults + SignatureResultCounter<Return>::kResults;
+    return signature;
+  }
+
  private:
   // Check whether a type T has an internal UnderlyingT type.
   template <typename T>
@@ -485,6 +561,14 @@ struct TfrtKernelImpl<Return (*)(Args...), impl_fn> {
     StoreResultAt(frame, 0, std::forward<T>(t));
   }
 
+  // Kernels written as resumable tasks allocate their results through
+  // Result<> and return the step function that completes them; the task
+  // runs on the work queue and the returned KernelTask consumes no result
+  // slot itself (see resumable_task.h).
+  static void HandleReturn(KernelFrame* frame, KernelTask&& task) {
+    RunResumableTask(frame->GetHostContext(), task.TakeStep());
+  }
+
   // For kernel functions that return std::pair<>, store the result as the first
   // and second output AsyncValue in the KernelFrame.
   template <typename T1, typename T2>
@@ -670,8 +754,12 @@ struct TfrtKernelImpl<Return (*)(Args...), impl_fn> {
     }
   };
 
-  // RemainingResults provides an MutableArrayRef<AsyncValue*> containing all
-  // remaining results. Useful for variadic kernels.
+  // RemainingResults writes results directly into the frame's result slots
+  // (see KernelFrame::GetResultRefs), so variadic kernels pay no
+  // per-invocation allocation or copy-out. The kernel and ReportError() see
+  // the same slots: a kernel that stores a result after reporting an error
+  // replaces the error in place, with normal RCReference reference
+  // counting.
   template <typename... Tail>
   struct SyncKernelCallHelper<RemainingResults, Tail...> {
     template <int in_idx, int out_idx, int const_idx, bool has_kernel_error,
@@ -681,50 +769,12 @@ struct TfrtKernelImpl<Return (*)(Args...), impl_fn> {
       static_assert(const_idx == 0,
                     "Arguments and results should appear before attributes.");
 
-      MutableArrayRef<AsyncValue*> returned_results =
-          frame->GetResults().drop_front(out_idx);
+      RemainingResults remaining_results(
+          frame->GetHostContext(), frame->GetResultRefs().drop_front(out_idx));
 
-      SmallVector<RCReference<AsyncValue>, 4> result_values;
-      result_values.resize(returned_results.size());
-
-      RemainingResults remaining_results(frame->GetHostContext(),
-                                         result_values);
       SyncKernelCallHelper<Tail...>::template Invoke<
           in_idx, -1, const_idx, has_kernel_error, has_in_chain>(
           frame, pargs..., remaining_results);
-
-      bool overwrote_result = false;
-      for (size_t i = 0, e = result_values.size(); i != e; ++i) {
-        // In error cases, ReportError() may have filled in the kernel frame's
-        // results already with errors.  We only want to overwrite these if
-        // returned_results has valid results.
-        if (auto* result = result_values[i].release()) {
-          if (returned_results[i]) {
-            assert(returned_results[i]->IsError() &&
-                   "shouldn't overwrite a normal value result");
-            returned_results[i]->DropRef();
-            overwrote_result = true;
-          }
-          returned_results[i] = result;
-        }
-      }
-
-      // If we overwrote a result an error result, make sure there is at least
-      // one error result left - otherwise this will have masked the error
-      // entirely.
-#ifndef NDEBUG
-      if (overwrote_result) {
-        bool had_error = false;
-        for (auto& result : frame->GetResults())
-          if (result->IsError()) {
-            had_error = true;
-            break;
-          }
-        assert(had_error &&
-               "RemainingResults kernel overwrote all the errors with "
-               "normal results");
-      }
-#endif
     }
   };
 
@@ -815,6 +865,11 @@ struct TfrtKernelImpl<Return (*)(Args...), impl_fn> {
   struct SyncKernelCallHelper<AggregateAttr, Tail...>
       : SyncKernelCallTypedAttrHelper<AggregateAttr, Tail...> {};
 
+  // Like the above, but for FlatAggregateAttr.
+  template <typename... Tail>
+  struct SyncKernelCallHelper<FlatAggregateAttr, Tail...>
+      : SyncKernelCallTypedAttrHelper<FlatAggregateAttr, Tail...> {};
+
   template <typename... Tail>
   struct SyncKernelCallHelper<RemainingAttributes, Tail...> {
     template <int in_idx, int out_idx, int const_idx, bool has_kernel_error,
@@ -954,6 +1009,16 @@ struct TfrtKernelImpl<Return (*)(Args...), impl_fn> {
       }
     };
 
+    // Task kernels set their results through Result<> and return only the
+    // step function, so they follow the void rules.
+    template <int out_idx>
+    struct AssertIndex<KernelTask, out_idx> {
+      static void Verify(KernelFrame* frame) {
+        assert((out_idx == frame->GetNumResults() || out_idx == -1) &&
+               "Extra results passed to kernel.");
+      }
+    };
+
     template <int in_idx, int out_idx, int const_idx, bool has_kernel_error,
               bool has_in_chain, typename... PreviousArgs>
     static void Invoke(KernelFrame* frame, const PreviousArgs&... pargs) {
@@ -968,6 +1033,293 @@ struct TfrtKernelImpl<Return (*)(Args...), impl_fn> {
       SyncKernelReturnHelper<has_kernel_error, Return>::Invoke(frame, pargs...);
     }
   };
+
+  //===--------------------------------------------------------------------===//
+  // Direct-call machinery for TFRT_SYNC_KERNEL.
+  //===--------------------------------------------------------------------===//
+
+  // Counterpart of SyncKernelCallHelper for DirectInvoke. Only plain value
+  // arguments, Argument<> and Attribute<> are supported; the wrapper types
+  // that need the KernelFrame are rejected at compile time below, steering
+  // the kernel back to TFRT_KERNEL.
+  template <typename... RemainingArgs>
+  struct DirectCallHelper;
+
+  // Store one direct-call result as an available AsyncValue.
+  template <typename T>
+  static void StoreDirectResultAt(const SyncKernelInvocation& inv, int index,
+                                  T&& t) {
+    inv.results[index] = inv.host
+                             ->MakeAvailableAsyncValueRef<std::decay_t<T>>(
+                                 std::forward<T>(t))
+                             .ReleaseRCRef();
+  }
+
+  // Chains reuse the ready chain cached in HostContext, as in StoreResultAt.
+  static void StoreDirectResultAt(const SyncKernelInvocation& inv, int index,
+                                  Chain t) {
+    inv.results[index] = inv.host->GetReadyChain().ReleaseRCRef();
+  }
+
+  // Store an already created AsyncValue as a direct-call result. The
+  // AddSyncKernel contract requires it to be available.
+  template <typename T>
+  static void StoreDirectResultAt(const SyncKernelInvocation& inv, int index,
+                                  AsyncValueRef<T> t) {
+    inv.results[index] = t.ReleaseRCRef();
+  }
+
+  template <typename T>
+  static void HandleDirectReturn(const SyncKernelInvocation& inv, T&& t) {
+    StoreDirectResultAt(inv, 0, std::forward<T>(t));
+  }
+
+  template <typename T1, typename T2>
+  static void HandleDirectReturn(const SyncKernelInvocation& inv,
+                                 std::pair<T1, T2>&& t) {
+    StoreDirectResultAt(inv, 0, std::move(t.first));
+    StoreDirectResultAt(inv, 1, std::move(t.second));
+  }
+
+  template <typename... T>
+  static void HandleDirectReturn(const SyncKernelInvocation& inv,
+                                 std::tuple<T...>&& t) {
+    EmplaceTupleDirectResult(inv, std::move(t),
+                             std::make_index_sequence<sizeof...(T)>{});
+  }
+
+  // Expected<> returns report their errors through the frame; kernels that
+  // can fail have no direct-call variant.
+  template <typename T>
+  static void HandleDirectReturn(const SyncKernelInvocation& inv,
+                                 llvm::Expected<T>&& t) = delete;
+
+  template <typename TupleT, size_t... I>
+  static void EmplaceTupleDirectResult(const SyncKernelInvocation& inv,
+                                       TupleT&& result,
+                                       std::index_sequence<I...>) {
+    std::ignore = std::initializer_list<int>{
+        (StoreDirectResultAt(inv, I,
+                             std::get<I>(std::forward<TupleT>(result))),
+         0)...};
+  }
+
+  // Specialization to cast a single input argument (Head).
+  template <typename Head, typename... Tail>
+  struct DirectCallHelper<Argument<Head>, Tail...> {
+    template <int in_idx, int const_idx, typename... PreviousArgs>
+    static void Invoke(const SyncKernelInvocation& inv,
+                       const PreviousArgs&... pargs) {
+      Argument<Head> arg(inv.arguments[in_idx]);
+      DirectCallHelper<Tail...>::template Invoke<in_idx + 1, const_idx>(
+          inv, pargs..., arg);
+    }
+  };
+
+  // Specialization to cast a single attribute (Head).
+  template <typename Head, typename... Tail>
+  struct DirectCallHelper<Attribute<Head>, Tail...> {
+    template <int in_idx, int const_idx, typename... PreviousArgs>
+    static void Invoke(const SyncKernelInvocation& inv,
+                       const PreviousArgs&... pargs) {
+      Attribute<Head> arg(inv.attributes[const_idx]);
+      DirectCallHelper<Tail...>::template Invoke<in_idx, const_idx + 1>(
+          inv, pargs..., arg);
+    }
+  };
+
+  // These wrapper types require the KernelFrame and have no direct-call
+  // representation. Declared but not defined, so using one in a
+  // TFRT_SYNC_KERNEL kernel fails to compile instead of silently
+  // misinterpreting the argument.
+  template <typename Head, typename... Tail>
+  struct DirectCallHelper<Result<Head>, Tail...>;
+  template <typename... Tail>
+  struct DirectCallHelper<RemainingArguments, Tail...>;
+  template <typename Head, typename... Tail>
+  struct DirectCallHelper<RepeatedArguments<Head>, Tail...>;
+  template <typename... Tail>
+  struct DirectCallHelper<RemainingResults, Tail...>;
+  template <typename Head, typename... Tail>
+  struct DirectCallHelper<ArrayAttribute<Head>, Tail...>;
+  template <typename... Tail>
+  struct DirectCallHelper<StringAttribute, Tail...>;
+  template <typename... Tail>
+  struct DirectCallHelper<RemainingAttributes, Tail...>;
+  template <typename... Tail>
+  struct DirectCallHelper<KernelErrorHandler, Tail...>;
+
+  // Treat any other type as a plain value argument.
+  template <typename Head, typename... Tail>
+  struct DirectCallHelper<Head, Tail...> {
+    using ArgT = std::decay_t<Head>;
+    static_assert(!std::is_pointer<Head>::value &&
+                      !std::is_reference<Head>::value && !IsViewT<ArgT>() &&
+                      !std::is_base_of<TypedAttrBase, ArgT>::value,
+                  "Only plain values, Argument<> and Attribute<> can be "
+                  "passed to a TFRT_SYNC_KERNEL kernel.");
+
+    template <int in_idx, int const_idx, typename... PreviousArgs>
+    static void Invoke(const SyncKernelInvocation& inv,
+                       const PreviousArgs&... pargs) {
+      DirectCallHelper<Tail...>::template Invoke<in_idx + 1, const_idx>(
+          inv, pargs..., inv.arguments[in_idx]->template get<ArgT>());
+    }
+  };
+
+  // Base case: no arguments left; invoke the kernel and store its results.
+  template <>
+  struct DirectCallHelper<> {
+    template <int in_idx, int const_idx, typename... PreviousArgs>
+    static void Invoke(const SyncKernelInvocation& inv,
+                       const PreviousArgs&... pargs) {
+      static_assert(
+          !std::is_void<Return>::value,
+          "TFRT_SYNC_KERNEL kernels must return their results by value.");
+      HandleDirectReturn(inv, impl_fn(pargs...));
+    }
+  };
+
+  //===--------------------------------------------------------------------===//
+  // Signature derivation for TFRT_KERNEL.
+  //===--------------------------------------------------------------------===//
+
+  // Counts how many argument, attribute and result slots the parameter list
+  // consumes, mirroring the SyncKernelCallHelper cases above. A dimension
+  // that contains a variadic wrapper cannot be counted and is marked
+  // unchecked; KernelFrame* gives the kernel access to everything, so it
+  // makes the whole signature unchecked.
+  template <typename... RemainingArgs>
+  struct SignatureCounter;
+
+  // Adds the slots consumed by one parameter to the counts of the rest.
+  template <int arguments, int attributes, int results, typename... Tail>
+  struct SignatureCounterHelper {
+    using Rest = SignatureCounter<Tail...>;
+    static constexpr int kArguments = Rest::kArguments + arguments;
+    static constexpr int kAttributes = Rest::kAttributes + attributes;
+    static constexpr int kResults = Rest::kResults + results;
+    static constexpr bool kUncheckedArguments = Rest::kUncheckedArguments;
+    static constexpr bool kUncheckedAttributes = Rest::kUncheckedAttributes;
+    static constexpr bool kUncheckedResults = Rest::kUncheckedResults;
+  };
+
+  // Marks dimensions consumed by a variadic parameter as unchecked.
+  template <bool arguments, bool attributes, bool results, typename... Tail>
+  struct SignatureCounterUnchecked {
+    using Rest = SignatureCounter<Tail...>;
+    static constexpr int kArguments = Rest::kArguments;
+    static constexpr int kAttributes = Rest::kAttributes;
+    static constexpr int kResults = Rest::kResults;
+    static constexpr bool kUncheckedArguments =
+        arguments || Rest::kUncheckedArguments;
+    static constexpr bool kUncheckedAttributes =
+        attributes || Rest::kUncheckedAttributes;
+    static constexpr bool kUncheckedResults =
+        results || Rest::kUncheckedResults;
+  };
+
+  // Plain values are arguments, except the typed attribute classes.
+  template <typename Head, typename... Tail>
+  struct SignatureCounter<Head, Tail...>
+      : SignatureCounterHelper<
+            std::is_base_of<TypedAttrBase, std::decay_t<Head>>::value ? 0 : 1,
+            std::is_base_of<TypedAttrBase, std::decay_t<Head>>::value ? 1 : 0,
+            0, Tail...> {};
+
+  template <typename Head, typename... Tail>
+  struct SignatureCounter<Argument<Head>, Tail...>
+      : SignatureCounterHelper<1, 0, 0, Tail...> {};
+  template <typename Head, typename... Tail>
+  struct SignatureCounter<ArgumentView<Head>, Tail...>
+      : SignatureCounterHelper<1, 0, 0, Tail...> {};
+  template <typename Head, typename... Tail>
+  struct SignatureCounter<Head*, Tail...>
+      : SignatureCounterHelper<1, 0, 0, Tail...> {};
+
+  template <typename Head, typename... Tail>
+  struct SignatureCounter<Attribute<Head>, Tail...>
+      : SignatureCounterHelper<0, 1, 0, Tail...> {};
+  template <typename Head, typename... Tail>
+  struct SignatureCounter<ArrayAttribute<Head>, Tail...>
+      : SignatureCounterHelper<0, 1, 0, Tail...> {};
+  template <typename... Tail>
+  struct SignatureCounter<StringAttribute, Tail...>
+      : SignatureCounterHelper<0, 1, 0, Tail...> {};
+
+  template <typename Head, typename... Tail>
+  struct SignatureCounter<Result<Head>, Tail...>
+      : SignatureCounterHelper<0, 0, 1, Tail...> {};
+
+  // Contextual parameters consume no slots.
+  template <typename... Tail>
+  struct SignatureCounter<HostContext*, Tail...>
+      : SignatureCounterHelper<0, 0, 0, Tail...> {};
+  template <typename... Tail>
+  struct SignatureCounter<const ExecutionContext&, Tail...>
+      : SignatureCounterHelper<0, 0, 0, Tail...> {};
+  template <typename... Tail>
+  struct SignatureCounter<KernelErrorHandler, Tail...>
+      : SignatureCounterHelper<0, 0, 0, Tail...> {};
+
+  // Variadic wrappers make their dimension uncountable.
+  template <typename... Tail>
+  struct SignatureCounter<RemainingArguments, Tail...>
+      : SignatureCounterUnchecked<true, false, false, Tail...> {};
+  template <typename Head, typename... Tail>
+  struct SignatureCounter<RepeatedArguments<Head>, Tail...>
+      : SignatureCounterUnchecked<true, false, false, Tail...> {};
+  template <typename... Tail>
+  struct SignatureCounter<RemainingResults, Tail...>
+      : SignatureCounterUnchecked<false, false, true, Tail...> {};
+  template <typename... Tail>
+  struct SignatureCounter<RemainingAttributes, Tail...>
+      : SignatureCounterUnchecked<false, true, false, Tail...> {};
+  template <typename... Tail>
+  struct SignatureCounter<KernelFrame*, Tail...>
+      : SignatureCounterUnchecked<true, true, true, Tail...> {};
+
+  // Base case: no parameters left.
+  template <>
+  struct SignatureCounter<> {
+    static constexpr int kArguments = 0;
+    static constexpr int kAttributes = 0;
+    static constexpr int kResults = 0;
+    static constexpr bool kUncheckedArguments = false;
+    static constexpr bool kUncheckedAttributes = false;
+    static constexpr bool kUncheckedResults = false;
+  };
+
+  // Counts the results produced by the kernel's return type.
+  template <typename T>
+  struct SignatureResultCounter {
+    static constexpr int kResults = 1;
+  };
+  template <>
+  struct SignatureResultCounter<void> {
+    static constexpr int kResults = 0;
+  };
+  // Task kernels declare their results through Result<>; the returned step
+  // function is not a result.
+  template <>
+  struct SignatureResultCounter<KernelTask> {
+    static constexpr int kResults = 0;
+  };
+  template <typename T1, typename T2>
+  struct SignatureResultCounter<std::pair<T1, T2>> {
+    static constexpr int kResults = 2;
+  };
+  template <typename... T>
+  struct SignatureResultCounter<std::tuple<T...>> {
+    static constexpr int kResults = sizeof...(T);
+  };
+  template <typename T>
+  struct SignatureResultCounter<llvm::Expected<T>>
+      : SignatureResultCounter<T> {};
+  template <typename... T>
+  struct SignatureResultCounter<AsyncValueRef<std::tuple<T...>>> {
+    static constexpr int kResults = sizeof...(T);
+  };
 };
 
 }  // namespace tfrt
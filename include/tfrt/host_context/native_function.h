@@ -23,8 +23,12 @@
 #ifndef TFRT_HOST_CONTEXT_NATIVE_FUNCTION_H_
 #define TFRT_HOST_CONTEXT_NATIVE_FUNCTION_H_
 
+#include <utility>
+
 #include "llvm/ADT/StringMap.h"
+#include "tfrt/host_context/async_value.h"
 #include "tfrt/host_context/function.h"
+#include "tfrt/host_context/host_context.h"
 #include "tfrt/support/mutex.h"
 
 namespace tfrt {
@@ -39,6 +43,73 @@ using NativeCallable = void (*)(AsyncValue* const* arguments, int num_arguments,
                                 RCReference<AsyncValue>* results,
                                 int num_results, HostContext* host);
 
+// Adapts an ordinary C++ function into a NativeCallable, so native functions
+// can be written with their arguments passed in registers instead of
+// hand-unpacking the AsyncValue array:
+//
+//   int32_t NativeAdd(int32_t a, int32_t b) { return a + b; }
+//   registry->Add("native_add", TFRT_NATIVE_FUNCTION(NativeAdd));
+//
+// The caller (NativeFunction::Execute) guarantees every argument is
+// available when the callable runs - it executes inline on the calling
+// thread when all arguments are ready and defers the call under asynchrony -
+// so the trampoline is a plain unpack, call, and result boxing that the
+// compiler can flatten into the function body. Parameters must be payload
+// value types; the return value (a single value or a std::pair for two
+// results) is boxed as available AsyncValues. Functions that need the
+// HostContext, produce errors, or complete results asynchronously should
+// implement NativeCallable directly.
+template <typename F, F impl_fn>
+struct NativeFunctionImpl;
+
+template <typename Return, typename... Args, Return (*impl_fn)(Args...)>
+struct NativeFunctionImpl<Return (*)(Args...), impl_fn> {
+  static void Invoke(AsyncValue* const* arguments, int num_arguments,
+                     RCReference<AsyncValue>* results, int num_results,
+                     HostContext* host) {
+    static_assert(!std::is_void<Return>::value,
+                  "native functions must return their results by value");
+    assert(num_arguments == static_cast<int>(sizeof...(Args)));
+    StoreResults(results, num_results, host,
+                 InvokeImpl(arguments, host,
+                            std::make_index_sequence<sizeof...(Args)>()));
+  }
+
+ private:
+  template <size_t... I>
+  static Return InvokeImpl(AsyncValue* const* arguments, HostContext* host,
+                           std::index_sequence<I...>) {
+    return impl_fn(arguments[I]->template get<std::decay_t<Args>>()...);
+  }
+
+  template <typename T>
+  static void StoreResults(RCReference<AsyncValue>* results, int num_results,
+                           HostContext* host, T&& value) {
+    assert(num_results == 1);
+    results[0] = host->MakeAvailableAsyncValueRef<std::decay_t<T>>(
+                         std::forward<T>(value))
+                     .ReleaseRCRef();
+  }
+
+  template <typename T1, typename T2>
+  static void StoreResults(RCReference<AsyncValue>* results, int num_results,
+                           HostContext* host, std::pair<T1, T2>&& value) {
+    assert(num_results == 2);
+    results[0] =
+        host->MakeAvailableAsyncValueRef<T1>(std::move(value.first))
+            .ReleaseRCRef();
+    results[1] =
+        host->MakeAvailableAsyncValueRef<T2>(std::move(value.second))
+            .ReleaseRCRef();
+  }
+};
+
+// The macro evaluates to the NativeCallable trampoline for an ordinary C++
+// function; see NativeFunctionImpl above.
+#define TFRT_NATIVE_FUNCTION(...)                          \
+  ::tfrt::NativeFunctionImpl<decltype(&__VA_ARGS__),       \
+                             &__VA_ARGS__>::Invoke
+
 class NativeFunctionRegistry {
  public:
   static NativeFunctionRegistry& GetGlobalRegistry() {
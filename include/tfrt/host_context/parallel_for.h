@@ -23,9 +23,11 @@
 #ifndef TFRT_SUPPORT_PARALLEL_FOR_H_
 #define TFRT_SUPPORT_PARALLEL_FOR_H_
 
+#include <chrono>
 #include <cstddef>
 
 #include "llvm/ADT/FunctionExtras.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
 #include "tfrt/host_context/host_context.h"
 #include "tfrt/support/forward_decls.h"
@@ -48,6 +50,13 @@ class ParallelFor {
     static BlockSizes Fixed(size_t n);
     // Splits range into a block sizes not smaller than `min`.
     static BlockSizes Min(size_t min);
+    // Measures the execution time of the first block at run time, and
+    // re-splits the remaining work so that each block runs for roughly
+    // `min_task_duration`. Use it when the per-element cost of `compute` is
+    // not known in advance: the duration target amortizes task scheduling
+    // overheads without oversharding cheap ranges or undersharding expensive
+    // ones.
+    static BlockSizes Adaptive(std::chrono::nanoseconds min_task_duration);
 
    private:
     friend class ParallelFor;
@@ -59,11 +68,22 @@ class ParallelFor {
     // specified number of worker threads.
     size_t GetBlockSize(size_t num_worker_threads, size_t total_size) const;
 
+    // Returns true if the block size must be re-computed from the measured
+    // execution time of the first block (see ParallelFor::Execute).
+    bool IsAdaptive() const { return min_task_duration_.hasValue(); }
+    std::chrono::nanoseconds min_task_duration() const {
+      return *min_task_duration_;
+    }
+
     // Block sizes computation internally represented as a function from the
     // parallel for parameters to the block size. This is an internal detail,
     // a contract between ParallelFor and BlockSizes. Users of ParallelFor
     // must rely only on public static methods to choose block sizes policy.
     mutable llvm::unique_function<size_t(size_t)> impl_;
+
+    // Target duration of a single block for the adaptive policy. When set,
+    // `impl_` only configures the size of the calibration block.
+    llvm::Optional<std::chrono::nanoseconds> min_task_duration_;
   };
 
   //===--------------------------------------------------------------------===//
@@ -92,6 +112,19 @@ class ParallelFor {
       llvm::unique_function<AsyncValueRef<T>(size_t, size_t)> compute,
       llvm::unique_function<R(ArrayRef<AsyncValueRef<T>>)> on_done) const;
 
+  // Reduces the [0, total_size) range in parallel: `reduce_block` computes a
+  // partial result for each block, and the partial results are combined
+  // pairwise in a tree with `combine` until a single value remains. Block
+  // results complete in an unspecified order, so `combine` must be
+  // associative and commutative. The tree combine keeps the number of
+  // `combine` applications on any path from a block to the final result
+  // logarithmic in the number of blocks, which bounds the growth of floating
+  // point rounding error. `total_size` must not be zero.
+  template <typename T>
+  AsyncValueRef<T> Reduce(size_t total_size, const BlockSizes& block_sizes,
+                          llvm::unique_function<T(size_t, size_t)> reduce_block,
+                          llvm::unique_function<T(T, T)> combine) const;
+
  private:
   HostContext* host_;  // must outlive all parallel operations in flight
 };
@@ -161,6 +194,41 @@ AsyncValueRef<R> ParallelFor::Execute(
   return result;
 }
 
+template <typename T>
+AsyncValueRef<T> ParallelFor::Reduce(
+    size_t total_size, const BlockSizes& block_sizes,
+    llvm::unique_function<T(size_t, size_t)> reduce_block,
+    llvm::unique_function<T(T, T)> combine) const {
+  assert(total_size > 0 && "can't reduce an empty range");
+
+  // Block results are computed synchronously inside the parallel tasks, so
+  // they are immediately available to the asynchronous Execute.
+  auto compute = [host = host_, reduce_block = std::move(reduce_block)](
+                     size_t begin, size_t end) mutable -> AsyncValueRef<T> {
+    return host->MakeAvailableAsyncValueRef<T>(reduce_block(begin, end));
+  };
+
+  auto tree_combine = [combine = std::move(combine)](
+                          ArrayRef<AsyncValueRef<T>> blocks) mutable -> T {
+    llvm::SmallVector<T, 32> partials;
+    partials.reserve(blocks.size());
+    for (auto& block : blocks) partials.push_back(std::move(block.get()));
+
+    // Combine adjacent pairs of partial results until one value remains.
+    for (size_t n = partials.size(); n > 1; n = (n + 1) / 2) {
+      for (size_t i = 0; i + 1 < n; i += 2) {
+        partials[i / 2] =
+            combine(std::move(partials[i]), std::move(partials[i + 1]));
+      }
+      if (n % 2 == 1) partials[(n - 1) / 2] = std::move(partials[n - 1]);
+    }
+    return std::move(partials[0]);
+  };
+
+  return Execute<T, T>(total_size, block_sizes, std::move(compute),
+                       std::move(tree_combine));
+}
+
 }  // namespace tfrt
 
 #endif  // TFRT_SUPPORT_PARALLEL_FOR_H_
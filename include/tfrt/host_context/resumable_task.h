@@ -0,0 +1,112 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- resumable_task.h - Suspension-capable work queue tasks ---*- C++ -*-===//
+//
+// This file declares a suspension-capable task abstraction for the
+// ConcurrentWorkQueue. A resumable task is a step function that is invoked as
+// a regular non-blocking work queue task; each invocation either completes
+// the task or suspends it on an AsyncValue. When the awaited value becomes
+// available, the task is re-enqueued on the work queue instead of resuming
+// inline on the thread that completed the value. This lets IO-heavy kernels
+// keep thousands of logical operations in flight without dedicating a
+// blocking work queue thread to each one, and without hand-rolling nested
+// AsyncValue::AndThen continuation chains.
+//
+// This is the C++14 analogue of a stackless coroutine: the step function
+// plays the role of the coroutine body with its state hoisted into captures,
+// and TaskResumption::AwaitOn plays the role of co_await. If the toolchain
+// moves to C++20, this is the natural seam for a real coroutine adapter.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_HOST_CONTEXT_RESUMABLE_TASK_H_
+#define TFRT_HOST_CONTEXT_RESUMABLE_TASK_H_
+
+#include "llvm/ADT/FunctionExtras.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/ref_count.h"
+
+namespace tfrt {
+class HostContext;
+
+// The result of a single resumption step: either the task has completed, or
+// it suspends until the awaited value becomes available.
+class TaskResumption {
+ public:
+  // The task has run to completion.
+  static TaskResumption Done() { return TaskResumption(nullptr); }
+
+  // Suspend the task until `awaited` becomes available (with a value or an
+  // error - the step function is resumed either way and must check for
+  // errors itself).
+  static TaskResumption AwaitOn(RCReference<AsyncValue> awaited) {
+    assert(awaited && "Awaited async value must not be null");
+    return TaskResumption(std::move(awaited));
+  }
+
+  template <typename T>
+  static TaskResumption AwaitOn(const AsyncValueRef<T>& awaited) {
+    return AwaitOn(awaited.CopyRCRef());
+  }
+
+  bool IsSuspended() const { return static_cast<bool>(awaited_); }
+
+  RCReference<AsyncValue> TakeAwaited() { return std::move(awaited_); }
+
+ private:
+  explicit TaskResumption(RCReference<AsyncValue> awaited)
+      : awaited_(std::move(awaited)) {}
+
+  RCReference<AsyncValue> awaited_;
+};
+
+// The return type for kernels written as resumable tasks (see the task
+// kernel support in kernel_utils.h). The kernel body runs once on the
+// executor thread to allocate its results and build the step function; the
+// kernel machinery hands the returned step function to RunResumableTask.
+class KernelTask {
+ public:
+  /*implicit*/ KernelTask(llvm::unique_function<TaskResumption()> step)
+      : step_(std::move(step)) {}
+
+  llvm::unique_function<TaskResumption()> TakeStep() {
+    return std::move(step_);
+  }
+
+ private:
+  llvm::unique_function<TaskResumption()> step_;
+};
+
+// Run `step` as a resumable task on the non-blocking work queue of `host`.
+//
+// `step` is first invoked as a regular work queue task. Whenever it returns
+// TaskResumption::AwaitOn(v), the task is suspended, and re-enqueued on the
+// work queue once `v` is available; no thread is blocked while the task is
+// suspended. Whenever it returns TaskResumption::Done(), the task retires and
+// the returned chain becomes available.
+//
+// The step function must follow the non-blocking work queue task
+// requirements (see ConcurrentWorkQueue): any potentially blocking wait must
+// be expressed as a suspension on an AsyncValue instead.
+AsyncValueRef<Chain> RunResumableTask(
+    HostContext* host, llvm::unique_function<TaskResumption()> step);
+
+}  // namespace tfrt
+
+#endif  // TFRT_HOST_CONTEXT_RESUMABLE_TASK_H_
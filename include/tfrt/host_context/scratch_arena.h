@@ -0,0 +1,96 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- scratch_arena.h - Kernel-Scoped Scratch Arena ------------*- C++ -*-===//
+//
+// This file declares ScratchArena, a bump allocator for transient scratch
+// memory used inside a single kernel invocation.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_HOST_CONTEXT_SCRATCH_ARENA_H_
+#define TFRT_HOST_CONTEXT_SCRATCH_ARENA_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace tfrt {
+
+// A bump allocator for kernel-scoped scratch memory such as im2col buffers
+// and sort temporaries. Allocation is a pointer increment into the current
+// backing slab and there is no per-allocation free: the arena is reset
+// wholesale when the owning kernel invocation completes. Freed standard
+// slabs are parked in a thread-local cache, so back-to-back kernels on the
+// same thread reuse warm memory without touching the process heap.
+//
+// ScratchArena is not thread safe. It is owned by one kernel invocation and
+// must only be used from the thread running that kernel, and memory obtained
+// from it must not outlive the synchronous part of the invocation.
+class ScratchArena {
+ public:
+  ScratchArena() = default;
+  ~ScratchArena() { Reset(); }
+
+  ScratchArena(const ScratchArena&) = delete;
+  ScratchArena& operator=(const ScratchArena&) = delete;
+
+  // Return `size` bytes of uninitialized memory aligned to `alignment`, which
+  // must be a power of two. The memory is valid until the next Reset().
+  void* Allocate(size_t size, size_t alignment) {
+    assert(alignment != 0 && (alignment & (alignment - 1)) == 0 &&
+           "alignment must be a power of two");
+    uintptr_t aligned = (next_ + alignment - 1) & ~uintptr_t{alignment - 1};
+    if (aligned + size <= end_ && aligned + size >= aligned) {
+      next_ = aligned + size;
+      return reinterpret_cast<void*>(aligned);
+    }
+    return AllocateSlow(size, alignment);
+  }
+
+  // Return scratch space for `num_elements` objects of type T. No
+  // constructors or destructors run: T must be trivially destructible.
+  template <typename T>
+  T* Allocate(size_t num_elements = 1) {
+    return static_cast<T*>(Allocate(sizeof(T) * num_elements, alignof(T)));
+  }
+
+  // Discard all allocations at once: standard slabs go back to the
+  // thread-local slab cache and oversized blocks are freed.
+  void Reset();
+
+ private:
+  // Standard backing slab size. Requests too big for a slab get a dedicated
+  // block that is freed (not cached) on Reset().
+  static constexpr size_t kSlabSize = 64 * 1024;
+
+  // Refills the arena from the thread-local slab cache (or the heap) and
+  // retries, or takes the dedicated-block path for oversized requests.
+  void* AllocateSlow(size_t size, size_t alignment);
+
+  // Bump region inside the current slab.
+  uintptr_t next_ = 0;
+  uintptr_t end_ = 0;
+
+  // Singly linked lists of owned blocks; the link is stored in the first
+  // word of each block.
+  void* slabs_ = nullptr;
+  void* large_blocks_ = nullptr;
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_HOST_CONTEXT_SCRATCH_ARENA_H_
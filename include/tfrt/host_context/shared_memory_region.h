@@ -0,0 +1,113 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- shared_memory_region.h -----------------------------------*- C++ -*-===//
+//
+// This file declares SharedMemoryRegion, a POSIX shared memory segment that
+// hands out HostBuffers visible to co-located processes. A buffer allocated
+// here can cross a process boundary as a plain offset: the peer opens the
+// same region by name and imports the offset as a HostBuffer aliasing the
+// same physical pages, so a 100MB handoff costs a message of a few bytes
+// instead of a memcpy. Reclamation is coordinated by per-block reference
+// counts living inside the region itself.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_HOST_CONTEXT_SHARED_MEMORY_REGION_H_
+#define TFRT_HOST_CONTEXT_SHARED_MEMORY_REGION_H_
+
+#include <string>
+
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/ref_count.h"
+
+namespace tfrt {
+
+class HostBuffer;
+
+// A named shared memory segment carved into reference counted blocks.
+//
+// One process creates the region and shares its name() out of band (e.g. in
+// a handshake message); any co-located process opens it by name. Blocks are
+// bump-allocated; each carries a reference count shared by every process
+// mapping the region, and the arena rewinds once every block has been
+// released everywhere. This suits the transient-handoff pattern the region
+// is built for (produce activations, ship them, drop them), not long-lived
+// mixed lifetimes.
+class SharedMemoryRegion : public ReferenceCounted<SharedMemoryRegion> {
+ public:
+  // Create a new region of `byte_size` bytes with a process-unique name.
+  // Returns an error if the shm segment cannot be created or mapped.
+  static Expected<RCReference<SharedMemoryRegion>> Create(size_t byte_size);
+
+  // Open a region created by another process. The name and size must match
+  // the creator's.
+  static Expected<RCReference<SharedMemoryRegion>> Open(string_view name,
+                                                        size_t byte_size);
+
+  // The shm name peers pass to Open(). Stable for the region's lifetime.
+  const std::string& name() const { return name_; }
+
+  size_t byte_size() const { return byte_size_; }
+
+  // Allocate a block of `size` bytes aligned to `alignment` and wrap it in a
+  // HostBuffer. Returns a null reference when the region is full. The block
+  // is released back to the region when the buffer (and every imported alias
+  // of it) is destroyed.
+  RCReference<HostBuffer> AllocateBuffer(size_t size, size_t alignment);
+
+  // Return the region offset of `buffer`, which must have been produced by
+  // AllocateBuffer or ImportBuffer on this region (in any process). The
+  // block's reference count is raised by one on behalf of the peer; the
+  // matching release happens when the peer destroys its imported buffer. If
+  // the peer never imports the offset, it must call DropExported.
+  Expected<uint64_t> ExportBuffer(const HostBuffer& buffer);
+
+  // Wrap the block at `offset` (as returned by ExportBuffer in a peer) in a
+  // HostBuffer aliasing the shared pages. Takes over the reference the
+  // exporter added.
+  Expected<RCReference<HostBuffer>> ImportBuffer(uint64_t offset);
+
+  // Release the reference added by ExportBuffer without importing, e.g. when
+  // the message carrying the offset could not be delivered.
+  void DropExported(uint64_t offset);
+
+ private:
+  friend class ReferenceCounted<SharedMemoryRegion>;
+
+  SharedMemoryRegion(std::string name, void* base, size_t byte_size,
+                     bool owns_name);
+  ~SharedMemoryRegion();
+
+  static Expected<RCReference<SharedMemoryRegion>> MapRegion(
+      const std::string& name, size_t byte_size, bool create);
+
+  // Decrement the block's shared count and rewind the arena when the region
+  // drains. Static so HostBuffer deallocators can hold the region by
+  // RCReference without aliasing `this`.
+  static void ReleaseBlock(RCReference<SharedMemoryRegion> region,
+                           uint64_t offset);
+
+  std::string name_;
+  char* base_;
+  size_t byte_size_;
+  // Only the creating process unlinks the shm name on destruction.
+  bool owns_name_;
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_HOST_CONTEXT_SHARED_MEMORY_REGION_H_
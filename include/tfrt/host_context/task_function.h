@@ -23,29 +23,127 @@
 #ifndef TFRT_HOST_CONTEXT_TASK_FUNCTION_H_
 #define TFRT_HOST_CONTEXT_TASK_FUNCTION_H_
 
-#include "llvm/ADT/FunctionExtras.h"
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace tfrt {
 
+// A move-only type-erased callable used for work queue tasks.
+//
+// Unlike llvm::unique_function, the inline buffer is sized for the closures
+// the runtime actually enqueues - an AsyncValueRef for the result plus a
+// handful of captured pointers - so scheduling a task does not heap-allocate
+// unless the closure exceeds kInlineFunctionSize bytes. One TaskFunction
+// occupies exactly one cache line.
 class TaskFunction {
  public:
+  // Callables of at most this size (with fundamental alignment and a
+  // noexcept move constructor) are stored inline; anything else spills to a
+  // single heap allocation.
+  static constexpr size_t kInlineFunctionSize = 56;
+
   TaskFunction() = default;
-  explicit TaskFunction(llvm::unique_function<void()> work)
-      : work_(std::move(work)) {}
+  ~TaskFunction() {
+    if (ops_) ops_->destroy(&storage_);
+  }
+
+  // Wraps any void() callable. Implicit so that lambdas convert directly at
+  // EnqueueWork call sites without an intermediate llvm::unique_function
+  // (whose smaller inline buffer would spill common continuations).
+  template <typename F,
+            typename = decltype(std::declval<std::decay_t<F>&>()()),
+            std::enable_if_t<
+                !std::is_same<std::decay_t<F>, TaskFunction>::value, int> = 0>
+  TaskFunction(F&& work) {  // NOLINT(google-explicit-constructor)
+    ops_ = Adapter<std::decay_t<F>>::Construct(&storage_,
+                                               std::forward<F>(work));
+  }
 
-  TaskFunction(TaskFunction&&) = default;
-  TaskFunction& operator=(TaskFunction&&) = default;
+  TaskFunction(TaskFunction&& other) : ops_(other.ops_) {
+    other.ops_ = nullptr;
+    if (ops_) ops_->relocate(&storage_, &other.storage_);
+  }
+  TaskFunction& operator=(TaskFunction&& other) {
+    if (this == &other) return *this;
+    reset();
+    ops_ = other.ops_;
+    other.ops_ = nullptr;
+    if (ops_) ops_->relocate(&storage_, &other.storage_);
+    return *this;
+  }
   TaskFunction(const TaskFunction&) = delete;
   TaskFunction& operator=(const TaskFunction&) = delete;
 
-  void operator()() { work_(); }
-  explicit operator bool() const { return static_cast<bool>(work_); }
-  void reset() { work_ = nullptr; }
+  void operator()() { ops_->invoke(&storage_); }
+  explicit operator bool() const { return ops_ != nullptr; }
+  void reset() {
+    if (ops_) {
+      ops_->destroy(&storage_);
+      ops_ = nullptr;
+    }
+  }
 
  private:
-  llvm::unique_function<void()> work_;
+  using Storage =
+      std::aligned_storage_t<kInlineFunctionSize, alignof(void*)>;
+
+  // Per-callable-type operations; `relocate` move-constructs dst from src
+  // and destroys src.
+  struct Operations {
+    void (*invoke)(void* storage);
+    void (*relocate)(void* dst, void* src);
+    void (*destroy)(void* storage);
+  };
+
+  template <typename Fn,
+            bool kInline = (sizeof(Fn) <= kInlineFunctionSize &&
+                            alignof(Fn) <= alignof(Storage) &&
+                            std::is_nothrow_move_constructible<Fn>::value)>
+  struct Adapter;
+
+  // The callable lives directly in the inline buffer.
+  template <typename Fn>
+  struct Adapter<Fn, true> {
+    template <typename F>
+    static const Operations* Construct(void* storage, F&& work) {
+      new (storage) Fn(std::forward<F>(work));
+      static const Operations ops = {
+          [](void* s) { (*static_cast<Fn*>(s))(); },
+          [](void* dst, void* src) {
+            Fn* from = static_cast<Fn*>(src);
+            new (dst) Fn(std::move(*from));
+            from->~Fn();
+          },
+          [](void* s) { static_cast<Fn*>(s)->~Fn(); },
+      };
+      return &ops;
+    }
+  };
+
+  // The callable spills to the heap; the buffer holds only the pointer.
+  template <typename Fn>
+  struct Adapter<Fn, false> {
+    template <typename F>
+    static const Operations* Construct(void* storage, F&& work) {
+      new (storage) Fn*(new Fn(std::forward<F>(work)));
+      static const Operations ops = {
+          [](void* s) { (**static_cast<Fn**>(s))(); },
+          [](void* dst, void* src) { new (dst) Fn*(*static_cast<Fn**>(src)); },
+          [](void* s) { delete *static_cast<Fn**>(s); },
+      };
+      return &ops;
+    }
+  };
+
+  const Operations* ops_ = nullptr;
+  Storage storage_;
 };
 
+static_assert(sizeof(TaskFunction) == 64,
+              "TaskFunction is expected to fill exactly one cache line");
+
 }  // namespace tfrt
 
 #endif  // TFRT_HOST_CONTEXT_TASK_FUNCTION_H_
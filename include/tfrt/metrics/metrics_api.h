@@ -23,6 +23,7 @@
 #ifndef TFRT_METRICS_METRICS_API_H_
 #define TFRT_METRICS_METRICS_API_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -40,6 +41,52 @@ class Gauge {
 template <typename T>
 Gauge<T>* NewGauge(std::string name);
 
+template <typename T>
+class Counter {
+ public:
+  virtual ~Counter() {}
+
+  virtual void Add(T value) = 0;
+
+  void Increment() { Add(1); }
+};
+
+template <typename T>
+Counter<T>* NewCounter(std::string name);
+
+class Histogram {
+ public:
+  virtual ~Histogram() {}
+
+  virtual void Record(int64_t value) = 0;
+};
+
+Histogram* NewHistogram(std::string name);
+
+// A point-in-time copy of one metric's state, safe to take from a background
+// export thread while other threads keep updating the metric.
+struct MetricSnapshot {
+  enum class Kind { kCounter, kGauge, kHistogram };
+
+  std::string name;
+  Kind kind;
+
+  // Counter total or numeric gauge value.
+  int64_t int_value = 0;
+
+  // Gauge<std::string> value.
+  std::string string_value;
+
+  // Histogram bucket occupancy: bucket i counts recorded values <= 2^i, with
+  // the last bucket absorbing everything larger.
+  std::vector<int64_t> histogram_buckets;
+};
+
+// Returns a snapshot of every metric created through the factories above, in
+// creation order. Callable from any thread; like the factories, this is
+// implemented by the metrics backend.
+std::vector<MetricSnapshot> SnapshotMetrics();
+
 }  // namespace metrics
 }  // namespace tfrt
 
@@ -38,9 +38,25 @@ enum : uint8_t {
   kBEFMagic1 = 0x0B,
   kBEFMagic2 = 0xEF,
 
-  // This is the only known version of BEF files at the moment, new numbers
-  // should be used when/if a format break is introduced.
+  // This is the original version of BEF files, new numbers should be used
+  // when/if a format break is introduced.
   kBEFVersion0 = 0,
+
+  // Version 1 files store the function header tables (location offset,
+  // register table, kernel table and result registers) as 4-byte aligned
+  // fixed-width uint32 entries instead of VBR integers. This costs a few
+  // percent of file size but lets readers decode the tables with aligned
+  // loads instead of the byte-at-a-time VBR loop.
+  kBEFVersion1 = 1,
+
+  // Magic numbers for a BEF archive: a container holding multiple BEF
+  // modules plus one shared, content-deduplicated attribute pool. See
+  // bef_executor/bef_archive.h for the layout and
+  // bef_converter/bef_archive_builder.h for how archives are built.
+  kBEFArchiveMagic1 = 0x0B,
+  kBEFArchiveMagic2 = 0xEA,
+
+  kBEFArchiveVersion0 = 0,
 };
 
 // These are the section ID's for the standard sections.  Each section is
@@ -102,14 +118,49 @@ enum class BEFSectionID : uint8_t {
   // It will be used for converting BEF back to mlir.
   kRegisterTypes = 11,
 
+  // An alignment padding section carries no information: its only purpose is
+  // to position the payload of the section that follows it at a file offset
+  // (e.g. a page boundary) that the one-byte alignment field in the section
+  // header cannot express. Readers skip it like any unknown section.
+  kAlignmentPadding = 12,
+
   // kNumSectionIDs is the number of section ids in a BEF file including
   // optional sections.
   kNumSectionIDs,
 };
 
+// BEF archive layout (all integers little-endian, all offsets relative to
+// the start of the archive):
+//   byte 0:      kBEFArchiveMagic1
+//   byte 1:      kBEFArchiveMagic2
+//   byte 2:      archive version
+//   byte 3:      zero padding
+//   bytes 4-7:   uint32_t num_modules
+//   bytes 8-15:  uint64_t pool_offset (page aligned)
+//   bytes 16-23: uint64_t pool_size
+//   bytes 24-..: num_modules module table entries:
+//     uint64_t module_offset (page aligned), uint64_t module_size,
+//     uint64_t name_offset, uint64_t name_size
+// followed by the name bytes, the modules, and the attribute pool.
+enum : size_t {
+  kBEFArchiveHeaderSize = 24,
+  kBEFArchiveModuleEntrySize = 32,
+
+  // Modules and the attribute pool are page aligned so an mmapped archive
+  // pages each in independently, and so the alignment guarantees of a
+  // standalone BEF file hold for every embedded module.
+  kBEFArchivePageAlignment = 4096,
+};
+
 enum : size_t {
   // Kernels in BEF are 4-byte aligned.
   kKernelEntryAlignment = 4,
+
+  // Dense attribute element payloads are aligned to at least this boundary,
+  // which meets DenseHostTensor's host alignment requirement for every
+  // dtype. This allows tensors to alias the payload in place instead of
+  // copying it.
+  kAttributeTensorAlignment = 8,
 };
 
 // SpecialAttribute describes the special BEF attributes of a kernel. It is a
@@ -229,6 +280,17 @@ enum class BEFAttributeType : uint16_t {
   kF64Dense = kF64 | kDenseAttributeType,
 
   kAggregate = kAggregateAttributeType,
+
+  // Flat aggregates are homogeneous aggregates - every element an equally
+  // sized array of the same fixed-width scalar type - stored as one header
+  // plus one contiguous typed payload (see BEFFlatAggregateAttr).
+  kBoolFlatAggregate = kBool | kAggregateAttributeType,
+  kI1FlatAggregate = kI1 | kAggregateAttributeType,
+  kI32FlatAggregate = kI32 | kAggregateAttributeType,
+  kI64FlatAggregate = kI64 | kAggregateAttributeType,
+  kF16FlatAggregate = kF16 | kAggregateAttributeType,
+  kF32FlatAggregate = kF32 | kAggregateAttributeType,
+  kF64FlatAggregate = kF64 | kAggregateAttributeType,
 };
 
 inline bool IsArrayAttribute(BEFAttributeType type) {
@@ -272,6 +334,20 @@ inline BEFAttributeType GetElementAttributeType(BEFAttributeType type) {
   return r;
 }
 
+// Flat aggregates set both the aggregate bit and a scalar data type, while
+// plain kAggregate has no scalar bits set.
+inline bool IsFlatAggregateAttribute(BEFAttributeType type) {
+  return (static_cast<uint16_t>(type) & kAggregateAttributeType) &&
+         IsDataTypeAttribute(GetElementAttributeType(type));
+}
+
+inline BEFAttributeType GetFlatAggregateAttributeType(
+    BEFAttributeType element_type) {
+  assert(IsDataTypeAttribute(element_type));
+  return static_cast<BEFAttributeType>(static_cast<uint16_t>(element_type) |
+                                       kAggregateAttributeType);
+}
+
 // Return the byte size of attributes in BEF. It will return 0 if the size is
 // not fixed.
 inline size_t GetBEFAttributeSize(BEFAttributeType type) {
@@ -444,6 +520,19 @@ struct BEFAggregateAttr {
   uint16_t offsets[1];
 };
 
+// A flattened homogeneous aggregate: `num_elements` sub-arrays of
+// `element_size` scalars each, stored back to back as one contiguous typed
+// payload instead of the per-element offset table of BEFAggregateAttr, so
+// readers cast a pointer instead of walking offsets.
+struct BEFFlatAggregateAttr {
+  BEFAttrBase base;
+  uint16_t num_elements;
+  uint16_t element_size;
+  // `element_offset` is the byte offset from &base for the scalar payload,
+  // aligned according to the scalar type.
+  uint16_t element_offset;
+};
+
 inline uint16_t AssertAttrFieldSize(size_t size) {
   assert(size <= ((1ul << 16) - 1));
   return static_cast<uint16_t>(size);
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- cache_line_audit.h - Cache Line Contention Audit ---------*- C++ -*-===//
+//
+// This file declares the opt-in cache line contention audit mode. Compile
+// with -DTFRT_CACHE_LINE_AUDIT to turn annotated write sites into probes
+// that count cross-thread write-write collisions per cache line; without the
+// define every annotation compiles to nothing.
+//
+// The audit report (printed at process exit, or on demand via
+// ReportCacheLineCollisions) lists one line per contended cache line:
+//
+//   TFRT_C2C line=<address> collisions=<count> sites=<site>-><site>
+//
+// The address column matches the "Data address" reported by `perf c2c`, so a
+// suspected line can be confirmed (or ruled out) against hardware HITM data,
+// and the site names say which annotated structures share the line.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_SUPPORT_CACHE_LINE_AUDIT_H_
+#define TFRT_SUPPORT_CACHE_LINE_AUDIT_H_
+
+#if defined(TFRT_CACHE_LINE_AUDIT)
+
+namespace tfrt {
+namespace audit {
+
+// Records a write by the calling thread to the cache line containing
+// `address`. `site` must be a string literal naming the annotated write site
+// (e.g. "AsyncValue::refcount_"); it is stored by pointer, not copied.
+void RecordWrite(const void* address, const char* site);
+
+// Prints the collision report for all contended cache lines observed so far.
+// Also installed as an atexit hook the first time a write is recorded.
+void ReportCacheLineCollisions();
+
+}  // namespace audit
+}  // namespace tfrt
+
+// Annotates a write to a potentially contended location. Place next to the
+// store (or read-modify-write) it describes.
+#define TFRT_AUDIT_CACHE_LINE_WRITE(address, site) \
+  ::tfrt::audit::RecordWrite(address, site)
+
+#else
+
+#define TFRT_AUDIT_CACHE_LINE_WRITE(address, site) \
+  do {                                             \
+  } while (0)
+
+#endif  // defined(TFRT_CACHE_LINE_AUDIT)
+
+#endif  // TFRT_SUPPORT_CACHE_LINE_AUDIT_H_
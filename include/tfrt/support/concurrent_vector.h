@@ -23,20 +23,29 @@
 #ifndef TFRT_SUPPORT_CONCURRENT_VECTOR_H_
 #define TFRT_SUPPORT_CONCURRENT_VECTOR_H_
 
+#include <array>
 #include <atomic>
 #include <cassert>
 #include <memory>
 #include <mutex>
 #include <vector>
 
+#include "llvm/Support/MathExtras.h"
+#include "tfrt/support/cache_line_audit.h"
+
 namespace tfrt {
 
 // A simple concurrent sequential container that allows concurrent reads and
 // writes and is optimized for read access. It is designed for the usage pattern
-// where objects are inserted once but are read many times. The key difference
-// between this data structure and std::vector is that when we re-allocate the
-// underlying buffer, we do not free the previous buffer. This allows us to
-// implement read access with a single atomic load.
+// where objects are inserted once but are read many times.
+//
+// Storage is a series of power-of-two sized segments, each twice the capacity
+// of the one before it. A segment is never moved or copied once allocated:
+// growth allocates the next segment and leaves every existing element where
+// readers already found it. Reads are therefore lock-free throughout -
+// locating an element is index arithmetic plus one atomic load of its segment
+// pointer - and growth never stalls concurrent readers on an element-copying
+// critical section or invalidates cache-warm data.
 //
 // Sample usage:
 //
@@ -52,41 +61,45 @@ namespace tfrt {
 // auto& t1 = vec[index1];
 // auto& t2 = vec[index1];
 //
-// Requirements:
-//
-// Type T needs to be copyable.
+// Elements are never moved, so references returned by operator[] stay valid
+// for the lifetime of the vector and T does not need to be copyable or
+// movable.
 
 template <typename T>
 class ConcurrentVector {
  public:
   // Initialize the vector with the given initial_capapcity
-  explicit ConcurrentVector(size_t initial_capacity) {
+  explicit ConcurrentVector(size_t initial_capacity)
+      : segment_zero_capacity_(
+            std::max<size_t>(llvm::PowerOf2Ceil(initial_capacity), 1)) {
     all_allocated_elements_.emplace_back();
-    auto& v = all_allocated_elements_.back();
-    v.reserve(initial_capacity);
-    elements_ = v.data();
+    auto& segment = all_allocated_elements_.back();
+    segment.reserve(segment_zero_capacity_);
+    segments_[0].store(segment.data(), std::memory_order_relaxed);
   }
 
   T& operator[](size_t index) {
     assert(index < size() && "invalid ConcurrentVector index");
-    // This acquire fence synchronizes with the release fence in emplace_back to
-    // ensure the reader sees consistent data.
-    T* elements = elements_.load(std::memory_order_relaxed);
+    const size_t segment = SegmentOfIndex(index);
+    T* elements = segments_[segment].load(std::memory_order_relaxed);
 
+    // This acquire fence synchronizes with the release fence in emplace_back
+    // to ensure the reader sees consistent data.
     std::atomic_thread_fence(std::memory_order_acquire);
 
-    return elements[index];
+    return elements[index - SegmentBaseIndex(segment)];
   }
 
   const T& operator[](size_t index) const {
     assert(index < size() && "invalid ConcurrentVector index");
-    T* elements = elements_.load(std::memory_order_relaxed);
+    const size_t segment = SegmentOfIndex(index);
+    T* elements = segments_[segment].load(std::memory_order_relaxed);
 
-    // This acquire fence synchronizes with the release fence in emplace_back to
-    // ensure the reader sees consistent data.
+    // This acquire fence synchronizes with the release fence in emplace_back
+    // to ensure the reader sees consistent data.
     std::atomic_thread_fence(std::memory_order_acquire);
 
-    return elements[index];
+    return elements[index - SegmentBaseIndex(segment)];
   }
 
   // Return the number of elements currently valid in this vector.  The vector
@@ -94,76 +107,89 @@ class ConcurrentVector {
   // thread.
   size_t size() const { return num_elements_; }
 
-  // Insert a new element at the end. If the current buffer is full, we allocate
-  // a new buffer with twice as much capacity and copy the items in the
-  // previous buffer over.
+  // Insert a new element at the end. If the current segment is full, the next
+  // (twice as large) segment is allocated; existing elements are never
+  // copied, so concurrent readers are unaffected by growth.
   //
   // Returns the index of the newly inserted item.
   template <typename... Args>
   size_t emplace_back(Args&&... args) {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    auto& last = all_allocated_elements_.back();
-
-    if (last.size() < last.capacity()) {
-      // There is still room in the current vector without reallocation. Just
-      // add the new element there.
-      last.emplace_back(std::forward<Args>(args)...);
-
-      // Increment the number of elements.
-      num_elements_.fetch_add(1);
-
-      // This release fence synchronizes with the acquire fence in operator[] to
-      // ensure the reader sees consistent data.
-      //
-      // We assume that the index returned here will be propagated to the
-      // reading thread using a relaxed atomic store/load or stronger.  This
-      // relaxed atomic load/store pair along with the the release/acquire fence
-      // will establish a synchronizes with relationship.
-      std::atomic_thread_fence(std::memory_order_release);
-
-      return last.size() - 1;
+    auto* last = &all_allocated_elements_.back();
+
+    size_t segment = all_allocated_elements_.size() - 1;
+    if (last->size() == last->capacity()) {
+      // The current segment is full. Allocate the next one; elements stay in
+      // the segments where readers already found them.
+      assert(segment + 1 < kMaxSegments && "ConcurrentVector overflow");
+      all_allocated_elements_.emplace_back();
+      last = &all_allocated_elements_.back();
+      last->reserve(SegmentCapacity(segment + 1));
+      segment += 1;
     }
 
-    // There is no more room in the current vector without reallocation.
-    // Allocate a new vector with twice as much capacity, copy the elements
-    // from the previous vector, and set elements_ to point to the data of the
-    // new vector.
-    all_allocated_elements_.emplace_back();
-    auto& new_last = all_allocated_elements_.back();
-    auto& prev = *(all_allocated_elements_.rbegin() + 1);
-    new_last.reserve(prev.capacity() * 2);
-    assert(prev.size() == prev.capacity());
-
-    // Copy over the previous vector to the new vector.
-    new_last.insert(new_last.begin(), prev.begin(), prev.end());
-
-    new_last.emplace_back(std::forward<Args>(args)...);
+    last->emplace_back(std::forward<Args>(args)...);
 
     // This release fence synchronizes with the acquire fence in operator[] to
     // ensure the reader sees consistent data.
     //
-    // The release fence should be before elements_.store() line below to ensure
-    // that if the reader sees the new value for elements_, they also see the
-    // store operations for the data.
+    // We assume that the index returned here will be propagated to the
+    // reading thread using a relaxed atomic store/load or stronger.  This
+    // relaxed atomic load/store pair along with the the release/acquire fence
+    // will establish a synchronizes with relationship.
+    //
+    // The fence must be before the segment pointer store below, so a reader
+    // that sees the new pointer also sees the element stores behind it.
     std::atomic_thread_fence(std::memory_order_release);
 
-    elements_.store(new_last.data(), std::memory_order_relaxed);
+    // The segment's data pointer never changes after this first publication:
+    // the segment is reserved to its full capacity up front.
+    if (last->size() == 1)
+      segments_[segment].store(last->data(), std::memory_order_relaxed);
 
     // Increment the number of elements.
+    TFRT_AUDIT_CACHE_LINE_WRITE(&num_elements_,
+                                "ConcurrentVector::num_elements_");
     num_elements_.fetch_add(1);
 
-    return new_last.size() - 1;
+    return SegmentBaseIndex(segment) + last->size() - 1;
   }
 
  private:
-  // pointing to the data of the last vector allocated.
-  std::atomic<T*> elements_{nullptr};
+  // Doubling segment sizes bound the number of segments a 64 bit index space
+  // can ever need.
+  static constexpr size_t kMaxSegments = 64;
+
+  // Segment k holds segment_zero_capacity_ * 2^k elements.
+  size_t SegmentCapacity(size_t segment) const {
+    return segment_zero_capacity_ << segment;
+  }
+
+  // Index of the first element stored in segment k. The segments before it
+  // hold segment_zero_capacity_ * (2^k - 1) elements in total.
+  size_t SegmentBaseIndex(size_t segment) const {
+    return segment_zero_capacity_ * ((size_t{1} << segment) - 1);
+  }
+
+  // Maps an element index to the segment holding it: the inverse of
+  // SegmentBaseIndex, one shift and one bit scan.
+  size_t SegmentOfIndex(size_t index) const {
+    return llvm::Log2_64(index / segment_zero_capacity_ + 1);
+  }
+
+  const size_t segment_zero_capacity_;
+
+  // Segment data pointers, published as each segment receives its first
+  // element. Readers locate elements through these without taking mutex_.
+  std::array<std::atomic<T*>, kMaxSegments> segments_{};
 
   // Return the current number of valid elements.
   std::atomic<size_t> num_elements_{0};
 
   std::mutex mutex_;
+  // Each inner vector is reserved to its full segment capacity when it is
+  // allocated, so its data pointer is stable for the container's lifetime.
   std::vector<std::vector<T>> all_allocated_elements_;
 };
 
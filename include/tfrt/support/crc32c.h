@@ -0,0 +1,58 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- crc32c.h - CRC32C checksums ------------------------------*- C++ -*-===//
+//
+// This file declares CRC32C (Castagnoli) checksum routines, including the
+// rotate-and-add masking used by the TFRecord file format. The implementation
+// uses the SSE4.2 or ARMv8 CRC instructions when the CPU supports them.
+//
+//===----------------------------------------------------------------------===//
+#ifndef TFRT_SUPPORT_CRC32C_H_
+#define TFRT_SUPPORT_CRC32C_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tfrt {
+namespace crc32c {
+
+// Return the crc32c of concat(A, data[0, n-1]) where init_crc is the crc32c
+// of some string A.
+uint32_t Extend(uint32_t init_crc, const char* data, size_t n);
+
+// Return the crc32c of data[0, n-1].
+inline uint32_t Value(const char* data, size_t n) { return Extend(0, data, n); }
+
+static constexpr uint32_t kMaskDelta = 0xa282ead8ul;
+
+// Return a masked representation of crc, as stored in TFRecord framing.
+// Storing the checksum of data that itself contains checksums raises the
+// chance of coincidental matches, so the stored value is rotated and offset.
+inline uint32_t Mask(uint32_t crc) {
+  return ((crc >> 15) | (crc << 17)) + kMaskDelta;
+}
+
+// Return the crc whose masked representation is masked_crc.
+inline uint32_t Unmask(uint32_t masked_crc) {
+  const uint32_t rot = masked_crc - kMaskDelta;
+  return ((rot >> 17) | (rot << 15));
+}
+
+}  // namespace crc32c
+}  // namespace tfrt
+
+#endif  // TFRT_SUPPORT_CRC32C_H_
@@ -28,6 +28,14 @@
 namespace tfrt {
 
 uint32_t Hash32(const char* data, size_t n, uint32_t seed);
+
+// An xxh3-class 64-bit hash, tuned for the short keys that dominate kernel,
+// op and attribute name lookups: keys up to 32 bytes take one or two folded
+// 128-bit multiplies with no per-byte loop, and longer keys go through a
+// striped accumulator loop with a runtime-detected AVX2 path on x86-64 (all
+// paths produce identical values). The output is not a stable on-disk
+// format; anything persisted must hash with an explicitly versioned
+// function instead.
 uint64_t Hash64(const char* data, size_t n, uint64_t seed);
 
 inline uint64_t Hash64(const char* data, size_t n) {
@@ -46,6 +54,26 @@ inline uint64_t Hash64Combine(uint64_t a, uint64_t b) {
   return a ^ (b + 0x9e3779b97f4a7800ULL + (a << 10) + (a >> 4));
 }
 
+// The standard hasher for string-keyed tables (registries, attribute name
+// tables): use as the Hasher / KeyInfoT parameter of hash containers
+// instead of their default string hash.
+struct StringHasher {
+  size_t operator()(string_view str) const { return Hash64(str); }
+};
+
+namespace internal {
+
+// Scalar reference implementation of Hash64's long-input (n > 128) striped
+// loop, exposed so tests can check the runtime-dispatched SIMD variants
+// against it. Not for direct use; call Hash64.
+uint64_t Hash64LongScalar(const char* data, size_t n, uint64_t seed);
+
+// True when Hash64's long-input path dispatches to the AVX2 loop on this
+// machine.
+bool Hash64LongUsesAvx2();
+
+}  // namespace internal
+
 }  // namespace tfrt
 
 #endif  // TFRT_SUPPORT_HASH_UTIL_H_
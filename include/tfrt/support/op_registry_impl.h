@@ -30,15 +30,26 @@
 #include "tfrt/support/forward_decls.h"
 
 namespace tfrt {
-template <typename OpMetadataFnTy, typename DispatchFnTy, typename OpFlagsTy>
+template <typename OpMetadataFnTy, typename DispatchFnTy, typename OpFlagsTy,
+          typename VariantPredicateTy>
 class OpRegistryImpl {
  public:
+  // A specialized implementation of an op, guarded by a predicate over the
+  // actual invocation (typically dtype and rank of the inputs). The op
+  // handler runs the first registered variant whose predicate matches and
+  // falls back to the generic dispatch_fn when none does.
+  struct OpVariant {
+    DispatchFnTy dispatch_fn;
+    VariantPredicateTy predicate;
+  };
+
   struct OpEntry {
     OpMetadataFnTy metadata_fn = nullptr;
     DispatchFnTy dispatch_fn = nullptr;
     OpFlagsTy flags;
 
     SmallVector<std::string, 4> attr_names;
+    SmallVector<OpVariant, 2> variants;
   };
 
   void AddOp(string_view op_name, DispatchFnTy dispatch_fn, OpFlagsTy flags,
@@ -51,6 +62,12 @@ class OpRegistryImpl {
     for (auto name : attr_names) entry.attr_names.emplace_back(name);
   }
 
+  void AddOpVariant(string_view op_name, DispatchFnTy dispatch_fn,
+                    VariantPredicateTy predicate) {
+    assert(!op_name.empty() && "op names cannot be empty");
+    op_mappings_[op_name].variants.push_back({dispatch_fn, predicate});
+  }
+
   void AddMetadataFn(string_view op_name, OpMetadataFnTy metadata_fn) {
     assert(!op_name.empty() && "op names cannot be empty");
     op_mappings_[op_name].metadata_fn = metadata_fn;
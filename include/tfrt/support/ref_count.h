@@ -65,11 +65,27 @@ class ReferenceCounted {
   ReferenceCounted& operator=(const ReferenceCounted&) = delete;
 
   // Add a new reference to this object.
-  void AddRef() { ref_count_.fetch_add(1); }
+  void AddRef() { AddRef(1); }
+
+  // Add `count` references to this object with a single atomic operation.
+  // Code that knows up front how many references it will hand out (e.g. an
+  // executor planning a dispatch) should prefer this over repeated AddRef
+  // calls: on shared objects the reference count cache line is contended,
+  // and batching cuts the atomic traffic to one operation per batch.
+  void AddRef(unsigned count) {
+    assert(count > 0 && "Must add a positive number of references");
+    ref_count_.fetch_add(count);
+  }
 
   // Drop a reference to this object, potentially deallocating it.
-  void DropRef() {
-    if (ref_count_.fetch_sub(1) == 1) static_cast<SubClass*>(this)->Destroy();
+  void DropRef() { DropRef(1); }
+
+  // Drop `count` references to this object with a single atomic operation,
+  // potentially deallocating it.
+  void DropRef(unsigned count) {
+    assert(count > 0 && "Must drop a positive number of references");
+    if (ref_count_.fetch_sub(count) == count)
+      static_cast<SubClass*>(this)->Destroy();
   }
 
   // Return true if reference count is 1.
@@ -182,6 +198,54 @@ RCReference<T> TakeRef(T* pointer) {
   return ref;
 }
 
+// A batch of references to a single reference counted object, acquired with
+// one atomic increment. This is for code that knows at planning time how
+// many consumers will need a reference to a shared object (e.g. a dispatch
+// loop handing a broadcast value to every consuming kernel): the owner takes
+// all the references up front and hands out the pre-acquired references one
+// at a time with no further atomic operations. Any references not handed out
+// are returned with a single atomic decrement when the batch is destroyed.
+//
+// The batched references are indistinguishable from individually acquired
+// ones: each RCReference returned by TakeRef drops its reference as usual.
+template <typename T>
+class RCReferenceBatch {
+ public:
+  RCReferenceBatch(T* object, unsigned count)
+      : object_(object), remaining_(count) {
+    if (count > 0) object_->AddRef(count);
+  }
+
+  RCReferenceBatch(RCReferenceBatch&& other)
+      : object_(other.object_), remaining_(other.remaining_) {
+    other.remaining_ = 0;
+  }
+
+  ~RCReferenceBatch() {
+    if (remaining_ > 0) object_->DropRef(remaining_);
+  }
+
+  // Hand out one of the pre-acquired references. Performs no atomic
+  // operations. It is a bug to take more references than the batch was
+  // constructed with.
+  RCReference<T> TakeRef() {
+    assert(remaining_ > 0 && "Exhausted the pre-acquired references");
+    --remaining_;
+    return tfrt::TakeRef(object_);
+  }
+
+  T* get() const { return object_; }
+  unsigned remaining() const { return remaining_; }
+
+  // Not copyable.
+  RCReferenceBatch(const RCReferenceBatch&) = delete;
+  RCReferenceBatch& operator=(const RCReferenceBatch&) = delete;
+
+ private:
+  T* object_;
+  unsigned remaining_;
+};
+
 template <typename T>
 RCReference<T> RCReference<T>::CopyRef() const {
   if (!pointer_) return RCReference();
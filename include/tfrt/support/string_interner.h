@@ -0,0 +1,113 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- string_interner.h - Name Interning -----------------------*- C++ -*-===//
+//
+// This file declares StringInterner, a process-wide intern table for op,
+// kernel and attribute names.
+//
+//===----------------------------------------------------------------------===//
+#ifndef TFRT_SUPPORT_STRING_INTERNER_H_
+#define TFRT_SUPPORT_STRING_INTERNER_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/Support/Allocator.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/hash_util.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+
+// A canonical name produced by StringInterner. It is a single pointer to a
+// null terminated copy of the name that lives for the rest of the process,
+// so two InternedNames compare equal iff their strings are equal - name
+// comparisons are pointer comparisons. Each name also carries a small dense
+// id assigned in interning order, suitable as an index into side tables.
+class InternedName {
+ public:
+  InternedName() : data_(nullptr) {}
+
+  explicit operator bool() const { return data_ != nullptr; }
+  const char* c_str() const { return data_; }
+  string_view str() const { return string_view(data_, size()); }
+  size_t size() const { return header()->size; }
+  uint32_t id() const { return header()->id; }
+
+  friend bool operator==(InternedName a, InternedName b) {
+    return a.data_ == b.data_;
+  }
+  friend bool operator!=(InternedName a, InternedName b) {
+    return a.data_ != b.data_;
+  }
+
+ private:
+  friend class StringInterner;
+
+  // The id and size live immediately before the characters, so an
+  // InternedName stays one pointer wide.
+  struct Header {
+    uint32_t id;
+    uint32_t size;
+  };
+
+  explicit InternedName(const char* data) : data_(data) {}
+  const Header* header() const {
+    return reinterpret_cast<const Header*>(data_) - 1;
+  }
+
+  const char* data_;
+};
+
+// A process-wide intern table mapping names to InternedNames. Interning is
+// intended for registration and load time; the steady state works with the
+// canonical pointers and dense ids, and strings appear only at the edges
+// (parsing, logging). Interned names are never freed.
+//
+// All methods are thread-safe.
+class StringInterner {
+ public:
+  // Returns the process-wide interner.
+  static StringInterner& Global();
+
+  // Returns the canonical name for `str`, interning it first if needed.
+  InternedName Intern(string_view str);
+
+  // Returns the canonical name for `str`, or a null InternedName if it was
+  // never interned. Lookups of unknown names do not grow the table, so this
+  // is the right call for answering negative lookups.
+  InternedName Find(string_view str) const;
+
+  // Returns the name with the given id, which must have been produced by
+  // this interner.
+  InternedName FromId(uint32_t id) const;
+
+  // Returns the number of interned names; ids are dense in [0, size()).
+  size_t size() const;
+
+ private:
+  mutable mutex mu_;
+  std::unordered_map<string_view, InternedName, StringHasher> names_
+      TFRT_GUARDED_BY(mu_);
+  std::vector<InternedName> by_id_ TFRT_GUARDED_BY(mu_);
+  llvm::BumpPtrAllocator allocator_ TFRT_GUARDED_BY(mu_);
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_SUPPORT_STRING_INTERNER_H_
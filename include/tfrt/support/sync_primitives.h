@@ -0,0 +1,250 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- sync_primitives.h ----------------------------------------*- C++ -*-===//
+//
+// Counting semaphore and reusable barrier for phase-structured parallel
+// kernels, complementing the single-use countdown in latch.h. Their APIs
+// follow std::counting_semaphore and std::barrier (C++20).
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_SUPPORT_SYNC_PRIMITIVES_H_
+#define TFRT_SUPPORT_SYNC_PRIMITIVES_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "mutex.h"
+#include "thread_annotations.h"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define TFRT_HAS_FUTEX 1
+#endif
+
+namespace tfrt {
+namespace internal {
+
+// Threads spin this many times on the fast path before parking; phase
+// transitions in blocked kernels are usually short enough that the flip
+// arrives while spinning, skipping the wake syscall latency entirely.
+constexpr int kSyncSpinCount = 64;
+
+#ifdef TFRT_HAS_FUTEX
+
+// Parks the calling thread until `word` is woken, provided it still holds
+// `expected` (the kernel re-checks under its own lock, so a flip between our
+// check and the syscall is never missed).
+inline void FutexWait(std::atomic<uint32_t>* word, uint32_t expected) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT_PRIVATE,
+          expected, nullptr, nullptr, 0);
+}
+
+// Wakes up to `count` threads parked on `word`.
+inline void FutexWake(std::atomic<uint32_t>* word, int count) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE_PRIVATE,
+          count, nullptr, nullptr, 0);
+}
+
+#endif  // TFRT_HAS_FUTEX
+
+}  // namespace internal
+
+// A counting semaphore: release() adds permits, acquire() blocks until one
+// is available and takes it. On Linux the uncontended paths are a single
+// atomic operation, and a blocked acquire parks on a futex; elsewhere
+// waiting falls back to mutex + condition variable.
+//
+// Reference: https://en.cppreference.com/w/cpp/thread/counting_semaphore
+class semaphore {
+ public:
+  explicit semaphore(ptrdiff_t initial) : count_(initial) {
+    assert(initial >= 0);
+    assert(static_cast<uint64_t>(initial) <= UINT32_MAX);
+  }
+
+  semaphore(const semaphore&) = delete;
+  semaphore& operator=(const semaphore&) = delete;
+
+  // Makes `n` permits available and wakes threads blocked in acquire().
+  void release(ptrdiff_t n = 1);
+
+  // Blocks until a permit is available, then takes it.
+  void acquire();
+
+  // Takes a permit if one is available without blocking. Returns true on
+  // success.
+  bool try_acquire();
+
+ private:
+  std::atomic<uint32_t> count_;
+  // Number of threads blocked (or about to block) in acquire(); release()
+  // only pays for a wake when this is non-zero.
+  std::atomic<uint32_t> waiters_{0};
+#ifndef TFRT_HAS_FUTEX
+  mutex mu_;
+  condition_variable cv_;
+#endif
+};
+
+// A reusable barrier for a fixed group of threads: the Nth arrival releases
+// the other N-1 and resets the barrier for the next phase. Reusability comes
+// from a phase word that flips on every completed phase (sense reversal
+// generalized to a counter), so a thread racing ahead into the next phase
+// can never confuse it with the previous one. On Linux late arrivals are a
+// single atomic operation and waiting parks on a futex; elsewhere waiting
+// falls back to mutex + condition variable.
+//
+// Reference: https://en.cppreference.com/w/cpp/thread/barrier
+class barrier {
+ public:
+  explicit barrier(ptrdiff_t num_threads) : num_threads_(num_threads) {
+    assert(num_threads > 0);
+    assert(static_cast<uint64_t>(num_threads) <= UINT32_MAX);
+  }
+
+  barrier(const barrier&) = delete;
+  barrier& operator=(const barrier&) = delete;
+
+  // Blocks until all num_threads threads have arrived, then resets the
+  // barrier for the next phase.
+  void arrive_and_wait();
+
+ private:
+  const uint32_t num_threads_;
+  std::atomic<uint32_t> arrived_{0};
+  // Incremented when a phase completes; doubles as the futex word waiters
+  // park on.
+  std::atomic<uint32_t> phase_{0};
+#ifndef TFRT_HAS_FUTEX
+  mutex mu_;
+  condition_variable cv_;
+#endif
+};
+
+#ifdef TFRT_HAS_FUTEX
+
+inline void semaphore::release(ptrdiff_t n) {
+  assert(n >= 0);
+  // The count_ increment here and the waiters_ increment in acquire() form
+  // a Dekker-style store/load pair (see event_count.h): each side stores to
+  // one word and then loads the other. Without a seq_cst fence between the
+  // two, release() can read a stale waiters_ == 0 while the acquirer reads
+  // a stale count_ == 0, and the wake is lost with the acquirer parked
+  // forever. The fences guarantee that at least one side observes the
+  // other's store.
+  count_.fetch_add(n, std::memory_order_release);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiters_.load(std::memory_order_relaxed) != 0)
+    internal::FutexWake(&count_,
+                        static_cast<int>(std::min<ptrdiff_t>(n, INT32_MAX)));
+}
+
+inline bool semaphore::try_acquire() {
+  uint32_t count = count_.load(std::memory_order_relaxed);
+  while (count != 0) {
+    if (count_.compare_exchange_weak(count, count - 1,
+                                     std::memory_order_acquire,
+                                     std::memory_order_relaxed))
+      return true;
+  }
+  return false;
+}
+
+inline void semaphore::acquire() {
+  for (int spin = 0; spin < internal::kSyncSpinCount; ++spin) {
+    if (try_acquire()) return;
+  }
+  waiters_.fetch_add(1, std::memory_order_relaxed);
+  // Pairs with the fence in release(); see the comment there. The waiters_
+  // increment must be ordered before the count_ re-check in try_acquire()
+  // below.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  while (!try_acquire()) {
+    internal::FutexWait(&count_, 0);
+  }
+  waiters_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+inline void barrier::arrive_and_wait() {
+  const uint32_t phase = phase_.load(std::memory_order_relaxed);
+  if (arrived_.fetch_add(1, std::memory_order_acq_rel) + 1 == num_threads_) {
+    // Last arrival: reset the count and flip the phase before waking, so a
+    // released thread re-entering the barrier finds it ready.
+    arrived_.store(0, std::memory_order_relaxed);
+    phase_.store(phase + 1, std::memory_order_release);
+    internal::FutexWake(&phase_, INT32_MAX);
+    return;
+  }
+  for (int spin = 0; spin < internal::kSyncSpinCount; ++spin) {
+    if (phase_.load(std::memory_order_acquire) != phase) return;
+  }
+  while (phase_.load(std::memory_order_acquire) == phase) {
+    internal::FutexWait(&phase_, phase);
+  }
+}
+
+#else  // !TFRT_HAS_FUTEX
+
+inline void semaphore::release(ptrdiff_t n) {
+  assert(n >= 0);
+  mutex_lock lock(mu_);
+  count_.fetch_add(n, std::memory_order_release);
+  cv_.notify_all();
+}
+
+inline bool semaphore::try_acquire() {
+  uint32_t count = count_.load(std::memory_order_relaxed);
+  while (count != 0) {
+    if (count_.compare_exchange_weak(count, count - 1,
+                                     std::memory_order_acquire,
+                                     std::memory_order_relaxed))
+      return true;
+  }
+  return false;
+}
+
+inline void semaphore::acquire() {
+  if (try_acquire()) return;
+  mutex_lock lock(mu_);
+  cv_.wait(lock, [this] { return try_acquire(); });
+}
+
+inline void barrier::arrive_and_wait() {
+  mutex_lock lock(mu_);
+  const uint32_t phase = phase_.load(std::memory_order_relaxed);
+  if (arrived_.fetch_add(1, std::memory_order_acq_rel) + 1 == num_threads_) {
+    arrived_.store(0, std::memory_order_relaxed);
+    phase_.store(phase + 1, std::memory_order_release);
+    cv_.notify_all();
+    return;
+  }
+  cv_.wait(lock, [this, phase] {
+    return phase_.load(std::memory_order_acquire) != phase;
+  });
+}
+
+#endif  // TFRT_HAS_FUTEX
+
+}  // namespace tfrt
+
+#endif  // TFRT_SUPPORT_SYNC_PRIMITIVES_H_
@@ -59,10 +59,32 @@ constexpr TensorDType GetTensorDType(uint8_t) { return TensorDType::kUInt8; }
 enum class TensorLayout : uint8_t {
   kRMD = 0,
   kCOO_EXPERIMENTAL = 1,
+  // Row-major dense data stored as independently deflate-compressed frames.
+  // The record payload after the dims is
+  //   <num_frames:u64><frame_bytes:u64><compressed_sizes:u64[num_frames]>
+  // followed by the frames back to back. `frame_bytes` is the uncompressed
+  // size of every frame but the last, which covers the remainder. Because
+  // frames compress independently, a reader can decompress them in parallel
+  // (see BtfStreamingReader).
+  kRMD_DEFLATE = 2,
 };
 
 raw_ostream& operator<<(raw_ostream& os, const TensorLayout& layout);
 
+// A BTF file normally begins with its index: <num_tensors><offsets...>.
+// Files produced in streaming append mode (see BtfStreamWriter) do not know
+// the tensor count up front, so they instead begin with this marker followed
+// by the absolute offset of the footer index, which has the standard
+// <num_tensors><offsets...> layout and follows the last tensor record.
+// Readers accept both layouts.
+constexpr uint64_t kFooterIndexMarker = ~uint64_t{0};
+
+// The uncompressed frame size used when writing kRMD_DEFLATE records. Large
+// enough to amortize per-frame codec setup, small enough that a tensor
+// splits into many frames and restore can keep every core decompressing.
+// Readers take the frame size from the record, not from this constant.
+constexpr uint64_t kCompressedFrameBytes = 1 << 20;
+
 // Tensor header in the Binary Tensor Format. This struct has to directly map to
 // the on-disk structure of BTF files.
 struct TensorHeader {
@@ -94,6 +94,24 @@ Expected<typename ParseTensorTraits::TensorTy> ReadTensorFromBTFHelper(
                            path);
   }
 
+  // Files written in streaming append mode keep their index in a footer and
+  // start with a marker pointing at it (see kFooterIndexMarker in btf.h).
+  uint64_t index_begin = sizeof(uint64_t);
+  if (num_tensors == btf::kFooterIndexMarker) {
+    uint64_t footer_offset;
+    if (!ReadStream(&stream, &footer_offset) ||
+        footer_offset < 2 * sizeof(uint64_t)) {
+      return MakeStringError("failed to read btf footer offset from path ",
+                             path);
+    }
+    stream.seekg(footer_offset);
+    if (!ReadStream(&stream, &num_tensors)) {
+      return MakeStringError("failed to read tensor num_tensors from path ",
+                             path);
+    }
+    index_begin = footer_offset + sizeof(uint64_t);
+  }
+
   if (index >= num_tensors) {
     return MakeStringError("invalid tensor index ", index,
                            " to read tensor from path ", path,
@@ -103,7 +121,7 @@ Expected<typename ParseTensorTraits::TensorTy> ReadTensorFromBTFHelper(
   // Read the offset from the target index from the file.
   uint64_t offset;
   // Seek to the position for the offset.
-  stream.seekg(sizeof(uint64_t) * (index + 1));
+  stream.seekg(index_begin + sizeof(uint64_t) * index);
   if (!ReadStream(&stream, &offset)) {
     return MakeStringError("failed to read tensor offset from ", path,
                            " for tensor index ", index);
@@ -151,6 +169,10 @@ Expected<typename ParseTensorTraits::TensorTy> ReadTensorFromBTFHelper(
 //
 // <rank:uint64_t><dtype:uint64_t><dims:uint64_t[rank]><tensor_data:dtype[]>
 //
+// Files written in streaming append mode instead start with
+// <kFooterIndexMarker:uint64_t><footer_offset:uint64_t> and keep the
+// <num_tensors><offsets> index at footer_offset, after the last record.
+//
 template <class ParseTensorTraits>
 AsyncValueRef<typename ParseTensorTraits::TensorTy> ReadTensorFromBTF(
     std::string path, int32_t index, HostContext* host) {
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- btf_streaming_reader.h -----------------------------------*- C++ -*-===//
+//
+// This file declares BtfStreamingReader, an mmap backed reader for BTF
+// (Binary Tensor Format) files.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TENSOR_BTF_STREAMING_READER_H_
+#define TFRT_TENSOR_BTF_STREAMING_READER_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tfrt/host_context/host_buffer.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+
+class HostContext;
+
+// BtfStreamingReader memory-maps a BTF file and materializes its tensors
+// lazily. Unlike ReadTensorFromBTF, which opens the file and copies tensor
+// data through a stream on every call, Open maps the file once and
+// ReadDenseTensor returns tensors whose buffers alias the mapping, so no
+// tensor data is copied and only the pages that are actually touched become
+// resident. This makes it practical to iterate over data set files much
+// larger than memory.
+//
+// ReadDenseTensor also issues madvise based readahead for the region
+// following the requested tensor and releases regions a full readahead
+// window behind it, so a sequential scan over the file keeps its resident
+// set bounded by the window size.
+//
+// Tensors returned by ReadDenseTensor share the read-only file mapping and
+// must not be mutated, the same contract as tensors created by
+// dht.const_tensor.
+class BtfStreamingReader {
+ public:
+  // Maps the file at `path` and parses the tensor offset index. Tensor
+  // records are not touched until ReadDenseTensor is called.
+  static Expected<BtfStreamingReader> Open(string_view path);
+
+  BtfStreamingReader(BtfStreamingReader&& other) = default;
+  BtfStreamingReader& operator=(BtfStreamingReader&& other);
+  ~BtfStreamingReader();
+
+  size_t NumTensors() const { return offsets_.size(); }
+
+  // Returns tensor `index` as a DenseHostTensor backed by the file mapping.
+  // If the record's data happens to be misaligned for its dtype (the BTF
+  // writer does not pad records), the data is copied into a buffer allocated
+  // from `host` instead.
+  //
+  // Records stored as deflate-compressed frames (see
+  // BtfStreamWriter::AppendTensorCompressed) are decompressed into a fresh
+  // buffer, fanning the frames out to `host`'s blocking work queue so the
+  // cores - not the caller thread - bound the restore rate. The call blocks
+  // until the tensor is complete, so call it from a blocking work queue
+  // task.
+  Expected<DenseHostTensor> ReadDenseTensor(size_t index, HostContext* host);
+
+  // Starts a background task on `host`'s blocking work queue that issues
+  // madvise(MADV_WILLNEED) for the records in `order` - the planned access
+  // order; pass 0..NumTensors()-1 for a sequential scan - ahead of the
+  // consumer. The task paces itself by the bytes ReadDenseTensor has
+  // actually handed out, keeping at most one readahead window of unconsumed
+  // records in flight, so a scan that follows the plan faults no pages on
+  // the critical path while a stalled consumer does not drag the whole file
+  // into memory.
+  //
+  // While a prefetcher is active, ReadDenseTensor's own synchronous
+  // readahead (and its trailing page release, which assumes a sequential
+  // scan) is disabled. Reads may deviate from `order`, but prefetch is only
+  // effective when they roughly follow it. The task retires when the plan
+  // is exhausted or the reader is destroyed. No-op on platforms without
+  // madvise.
+  void StartPrefetch(std::vector<size_t> order, HostContext* host);
+
+ private:
+  class PrefetchState;
+
+  BtfStreamingReader(RCReference<HostBuffer> file,
+                     std::vector<uint64_t> offsets, size_t records_end)
+      : file_(std::move(file)),
+        offsets_(std::move(offsets)),
+        records_end_(records_end) {}
+
+  // Asks the OS to fault in the window following the record at
+  // [record_begin, record_end) and to release pages more than a window
+  // behind it.
+  void IssueReadahead(size_t record_begin, size_t record_end);
+
+  // Materializes a kRMD_DEFLATE record whose frame index starts at
+  // `index_offset`, decompressing the frames in parallel.
+  Expected<DenseHostTensor> ReadDeflateRecord(size_t record_begin,
+                                              size_t index_offset,
+                                              const TensorMetadata& metadata,
+                                              HostContext* host);
+
+  RCReference<HostBuffer> file_;
+  std::vector<uint64_t> offsets_;
+  // End of the tensor record region: the file end, or the footer index for
+  // files written in streaming append mode.
+  size_t records_end_ = 0;
+  // End of the region already released back to the OS by IssueReadahead.
+  size_t released_end_ = 0;
+  // Shared with the background prefetch task, which holds its own reference
+  // to the file mapping. Null until StartPrefetch is called.
+  std::shared_ptr<PrefetchState> prefetch_state_;
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_TENSOR_BTF_STREAMING_READER_H_
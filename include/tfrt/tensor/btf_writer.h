@@ -0,0 +1,102 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- btf_writer.h ---------------------------------------------*- C++ -*-===//
+//
+// This file declares a parallel writer for BTF (Binary Tensor Format) files.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TENSOR_BTF_WRITER_H_
+#define TFRT_TENSOR_BTF_WRITER_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/Error.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+
+class HostContext;
+
+// Writes `tensors` to a BTF file at `path`, one record per tensor in the
+// given order. The file size and every record's position are computed up
+// front from tensor metadata alone, so each tensor's payload can be written
+// concurrently into its preassigned region on the blocking work queue, with
+// pwrite and no intermediate serialization buffers. This lets checkpoints
+// proceed at disk bandwidth instead of being serialized through one thread.
+//
+// The returned chain becomes available once the whole file has been written,
+// or carries the first error encountered.
+AsyncValueRef<Chain> WriteTensorsToBTF(std::vector<DenseHostTensor> tensors,
+                                       std::string path, HostContext* host);
+
+// BtfStreamWriter writes a BTF file in streaming append mode: tensors are
+// appended one at a time as they are produced, and the offset index is
+// accumulated in memory and written as a footer by Finish(), with the file
+// header pointing at it (see kFooterIndexMarker in btf.h). Unlike
+// WriteTensorsToBTF, which needs every tensor in memory at once, the
+// streaming writer's memory overhead is the index plus the one tensor being
+// appended, so saving a checkpoint does not hold a second copy of the model.
+//
+// Appends are sequential blocking writes; call the writer from a blocking
+// work queue task, not from a kernel thread. A file whose writer was
+// destroyed without a successful Finish() has no index and is rejected by
+// the readers.
+class BtfStreamWriter {
+ public:
+  // Creates the file at `path`, replacing any existing file.
+  static Expected<BtfStreamWriter> Create(std::string path);
+
+  BtfStreamWriter(BtfStreamWriter&& other) = default;
+  BtfStreamWriter& operator=(BtfStreamWriter&& other) = default;
+
+  size_t NumTensors() const { return offsets_.size(); }
+
+  // Appends one tensor record. The tensor may be released as soon as this
+  // returns.
+  llvm::Error AppendTensor(const DenseHostTensor& dht);
+
+  // Appends one tensor record with the payload stored as independently
+  // deflate-compressed frames (TensorLayout::kRMD_DEFLATE), trading save
+  // time CPU for roughly 3x less checkpoint storage. The frames compress
+  // one at a time through a frame-sized scratch buffer, so the memory
+  // overhead stays one frame regardless of tensor size, and readers can
+  // decompress frames in parallel (see BtfStreamingReader).
+  llvm::Error AppendTensorCompressed(const DenseHostTensor& dht);
+
+  // Writes the footer index, points the header at it and closes the file.
+  // No tensors can be appended afterwards.
+  llvm::Error Finish();
+
+ private:
+  BtfStreamWriter(std::ofstream out, std::string path)
+      : out_(std::move(out)), path_(std::move(path)) {}
+
+  std::ofstream out_;
+  std::string path_;
+  std::vector<uint64_t> offsets_;
+  bool finished_ = false;
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_TENSOR_BTF_WRITER_H_
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- checkpoint.h ---------------------------------------------*- C++ -*-===//
+//
+// This file declares parallel multi-file checkpoint save and restore.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TENSOR_CHECKPOINT_H_
+#define TFRT_TENSOR_CHECKPOINT_H_
+
+#include <string>
+#include <vector>
+
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+
+class HostContext;
+
+// Returns the path of shard `shard` of a checkpoint with `num_shards` shards
+// saved under `prefix`.
+std::string CheckpointShardPath(const std::string& prefix, int shard,
+                                int num_shards);
+
+// Returns the path of the manifest of a checkpoint saved under `prefix`.
+std::string CheckpointManifestPath(const std::string& prefix);
+
+// Saves `tensors` as a multi-file checkpoint under `prefix`: the tensors are
+// sharded across up to `num_shards` BTF files, each written concurrently
+// through the parallel BTF writer, plus a manifest recording which shard and
+// record every tensor landed in. A single-file save serializes on one
+// stream; with the shards spread over a disk array, this one moves at the
+// array's aggregate bandwidth. Tensors are balanced across shards by byte
+// size.
+//
+// The returned chain becomes available once the manifest and every shard
+// have been written, or carries the first error encountered.
+AsyncValueRef<Chain> SaveCheckpoint(std::vector<DenseHostTensor> tensors,
+                                    std::string prefix, int num_shards,
+                                    HostContext* host);
+
+// Restores a checkpoint saved by SaveCheckpoint. The shards are read by
+// concurrent blocking work queue tasks, and every record's payload is read
+// straight into the tensor's freshly allocated final buffer - there are no
+// staging copies. The result holds the tensors in the order they were
+// passed to SaveCheckpoint, or carries the first error encountered.
+AsyncValueRef<std::vector<DenseHostTensor>> RestoreCheckpoint(
+    std::string prefix, HostContext* host);
+
+}  // namespace tfrt
+
+#endif  // TFRT_TENSOR_CHECKPOINT_H_
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- conversion_registry.h ------------------------------------*- C++ -*-===//
+//
+// This file defines the tensor conversion function registry.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TENSOR_CONVERSION_REGISTRY_H_
+#define TFRT_TENSOR_CONVERSION_REGISTRY_H_
+
+#include "tfrt/tensor/tensor.h"
+
+namespace tfrt {
+
+// A registry of tensor conversion functions, keyed by the subclass of the
+// source tensor.
+//
+// Tensor::ConvertToHostTensor always copies, because its result is logically
+// independent of the source and may be mutated. Many callers don't need
+// that: op dispatch, for example, only ever reads converted arguments. For
+// such read-only consumers a registered conversion function may return a
+// result that shares the RCReference<HostBuffer> of the source instead of
+// copying, turning same-layout conversions into a refcount bump.
+//
+// Results obtained through this registry must therefore be treated as
+// read-only views of the source tensor (the same contract as
+// dht.const_tensor). Callers that mutate the result must keep using
+// Tensor::ConvertToHostTensor directly.
+class TensorConversionFnRegistry {
+ public:
+  using ConversionFn = AsyncValueRef<HostTensor> (*)(const Tensor& tensor,
+                                                     HostContext* host,
+                                                     uint32_t allowed_formats);
+
+  // Registers `fn` as the conversion function for source tensors of
+  // `subclass`, replacing any previously registered function.
+  void AddConversionFn(Tensor::Subclass subclass, ConversionFn fn);
+
+  // Returns the conversion function for `subclass`, or null if none is
+  // registered.
+  ConversionFn GetConversionFn(Tensor::Subclass subclass) const;
+};
+
+// Returns the process-wide conversion function registry. A buffer-aliasing
+// function for DenseHostTensor sources is pre-registered.
+TensorConversionFnRegistry* GetStaticTensorConversionFnRegistry();
+
+// Converts `tensor` to a host tensor in one of `allowed_formats` through the
+// registry, falling back to Tensor::ConvertToHostTensor for subclasses
+// without a registered conversion function. The result may alias the buffer
+// of `tensor` and must be treated as read-only.
+AsyncValueRef<HostTensor> ConvertTensorToHostTensor(const Tensor& tensor,
+                                                    HostContext* host,
+                                                    uint32_t allowed_formats);
+
+}  // namespace tfrt
+
+#endif  // TFRT_TENSOR_CONVERSION_REGISTRY_H_
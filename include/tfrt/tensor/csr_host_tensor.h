@@ -0,0 +1,86 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- csr_host_tensor.h ----------------------------------------*- C++ -*-===//
+//
+// This file defines the CsrHostTensor class.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TENSOR_CSR_HOST_TENSOR_H_
+#define TFRT_TENSOR_CSR_HOST_TENSOR_H_
+
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+
+void RegisterCsrHostTensorKernels(KernelRegistry* registry);
+
+// Represents a sparse matrix in compressed sparse row (CSR) layout.
+//
+// The stored elements are sorted by row: row_offsets is a rank-1 int64 tensor
+// of shape [rows + 1], and the column indices and values of row i occupy
+// positions [row_offsets[i], row_offsets[i+1]) of the rank-1 col_indices and
+// values tensors. Unlike the coordinate list layout of CooHostTensor, this
+// gives constant-time access to the elements of a row, which is what
+// row-oriented kernels like sparse-dense matmul want.
+//
+// CSR is a matrix format: the shape is always rank 2.
+class CsrHostTensor final : public HostTensor {
+ public:
+  // Empty and null by default.
+  CsrHostTensor() = default;
+
+  CsrHostTensor(const TensorShape& shape, DType dtype,
+                DenseHostTensor&& row_offsets, DenseHostTensor&& col_indices,
+                DenseHostTensor&& values)
+      : HostTensor(Subclass::CsrHost, TensorMetadata(dtype, shape)),
+        row_offsets_(std::move(row_offsets)),
+        col_indices_(std::move(col_indices)),
+        values_(std::move(values)) {
+    assert(shape.GetRank() == 2 && "CSR tensors must be matrices");
+    assert(row_offsets_.NumElements() == shape.GetDimensionSize(0) + 1);
+    assert(col_indices_.NumElements() == values_.NumElements());
+  }
+
+  // Raw access to data.
+  const DenseHostTensor* RowOffsets() const { return &row_offsets_; }
+  DenseHostTensor* RowOffsets() { return &row_offsets_; }
+  const DenseHostTensor* ColIndices() const { return &col_indices_; }
+  DenseHostTensor* ColIndices() { return &col_indices_; }
+  const DenseHostTensor* Values() const { return &values_; }
+  DenseHostTensor* Values() { return &values_; }
+
+  ssize_t NumNonZeroValues() const { return values_.NumElements(); }
+
+  void Print(raw_ostream& os) const override;
+
+  AsyncValueRef<HostTensor> ConvertToHostTensor(
+      HostContext* host, uint32_t allowed_formats) const override;
+
+  static bool classof(const Tensor* t) {
+    return t->subclass() == Subclass::CsrHost;
+  }
+
+ private:
+  DenseHostTensor row_offsets_;
+  DenseHostTensor col_indices_;
+  DenseHostTensor values_;
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_TENSOR_CSR_HOST_TENSOR_H_
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- dense_constant_pool.h ------------------------------------*- C++ -*-===//
+//
+// This file declares DenseConstantPool, a content-hash keyed pool of
+// constant tensor buffers.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TENSOR_DENSE_CONSTANT_POOL_H_
+#define TFRT_TENSOR_DENSE_CONSTANT_POOL_H_
+
+#include <unordered_map>
+
+#include "tfrt/host_context/shared_context.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/tensor/tensor_metadata.h"
+
+namespace tfrt {
+
+class HostBuffer;
+class HostContext;
+
+// DenseConstantPool deduplicates constant tensors by content across the BEF
+// files loaded into one HostContext. Constant materialization looks a
+// constant up by the hash of its metadata and payload; identical weights in
+// concurrently loaded programs (e.g. two model versions A/B serving a 2%
+// weight diff) then share one HostBuffer instead of each file carrying its
+// own copy.
+//
+// The pool owns its buffers: the first sighting of a constant copies the
+// payload out of the BEF file, so the file's constant pages stay clean and
+// later sightings - from any file - alias the pooled copy. Entries persist
+// until DropUnusedConstants() is called after unloading a program.
+class DenseConstantPool : public SharedContext {
+ public:
+  explicit DenseConstantPool(HostContext* host);
+  ~DenseConstantPool() override;
+
+  // Returns a tensor of the given metadata sharing the pooled buffer whose
+  // contents equal `data` (which spans metadata.GetHostSizeInBytes()
+  // bytes), copying the payload into the pool on first sighting. The
+  // returned tensor must be treated as read-only.
+  llvm::Expected<DenseHostTensor> GetOrCreateConstant(
+      const TensorMetadata& metadata, const void* data);
+
+  // Drops pooled constants no longer referenced by any live tensor. Call
+  // after unloading a program to release its share of the pool. Returns the
+  // number of entries dropped.
+  size_t DropUnusedConstants();
+
+ private:
+  struct Entry {
+    TensorMetadata metadata;
+    RCReference<HostBuffer> buffer;
+  };
+
+  HostContext* host_;
+  mutex mu_;
+  // Keyed by the content hash; same-hash entries with different contents
+  // (hash collisions) chain in the multimap and are told apart by comparing
+  // metadata and payload bytes.
+  std::unordered_multimap<uint64_t, Entry> constants_ TFRT_GUARDED_BY(mu_);
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_TENSOR_DENSE_CONSTANT_POOL_H_
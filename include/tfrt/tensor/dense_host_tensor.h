@@ -65,11 +65,31 @@ class DenseHostTensor final : public HostTensor {
     return data_->data();
   }
 
+  // Direct mutable access. The caller is responsible for knowing that the
+  // buffer is not shared (e.g. because this tensor was just allocated); for
+  // tensors produced by CopyRef() use MutableData() instead, which inserts
+  // the copy-on-write barrier.
   void* data() {
     assert(data_ && "dereferencing a null host tensor");
     return data_->data();
   }
 
+  // Copy-on-write barrier: returns a pointer to element data that is safe to
+  // mutate without being observed through other tensors. If the underlying
+  // buffer is shared (its refcount is not 1), it is first cloned into a
+  // buffer uniquely owned by this tensor; a unique buffer is handed out
+  // as is. Returns nullptr if cloning fails to allocate.
+  //
+  // Note that buffers aliasing memory they do not own (CreateFromParent and
+  // CreateFromExternal views) can alias other buffers at refcount 1; tensors
+  // over such views should not rely on this barrier for isolation.
+  void* MutableData(HostAllocator* allocator);
+  void* MutableData(HostContext* host);
+
+  // Returns true if this tensor is the only owner of its buffer, i.e.
+  // MutableData() would not copy.
+  bool IsUnique() const { return data_ && data_->IsUnique(); }
+
   const RCReference<HostBuffer>& buffer() const { return data_; }
 
   size_t DataSizeInBytes() const {
@@ -81,6 +101,10 @@ class DenseHostTensor final : public HostTensor {
 
   RCReference<HostBuffer> ReleaseBuffer() { return std::move(data_); }
 
+  // Buffer-sharing copy: the result references the same underlying buffer
+  // instead of duplicating it, so duplicating a tensor that is never written
+  // costs two refcount operations. Writers must go through MutableData(),
+  // which clones the buffer at first mutation while it is still shared.
   DenseHostTensor CopyRef() const {
     return DenseHostTensor(metadata(), data_.CopyRef());
   }
@@ -147,11 +147,16 @@ class DHTIndexableView : public DHTArrayView<DType> {
   using CoordType = std::array<size_t, Rank>;
 
   /*implicit*/ DHTIndexableView(const DenseHostTensor* dht)
-      : DHTArrayView<DType>(dht), fixed_shape_(dht->shape()) {}
+      : DHTArrayView<DType>(dht),
+        fixed_shape_(dht->shape()),
+        strides_(ComputeStrides(fixed_shape_)) {}
 
   // The fixed shape of this tensor.
   const FixedShapeType& FixedShape() const { return fixed_shape_; }
 
+  // The row-major strides of this tensor, in elements.
+  const CoordType& Strides() const { return strides_; }
+
   // Returns reference to element at the given coordinate.
   const DType& operator[](const CoordType& coord) const {
     return this->data()[OffsetOf(coord)];
@@ -166,19 +171,32 @@ class DHTIndexableView : public DHTArrayView<DType> {
   }
 
  private:
+  // Strides are computed once at view construction so that each element
+  // access is a plain dot product against a register-resident stride array.
+  // Rebuilding the strides from the dims on every access puts a serial
+  // multiply chain in the inner loop and blocks vectorization.
+  static CoordType ComputeStrides(const FixedShapeType& shape) {
+    CoordType strides;
+    size_t stride = 1;
+    for (int i = Rank - 1; i >= 0; --i) {
+      strides[i] = stride;
+      stride *= shape[i];
+    }
+    return strides;
+  }
+
   // Returns the offset of the given coordinate in the underlying storage.
   size_t OffsetOf(const CoordType& coord) const {
     size_t offset = 0;
-    size_t stride = 1;
-    for (int i = Rank - 1; i >= 0; --i) {
+    for (size_t i = 0; i != Rank; ++i) {
       assert(coord[i] < fixed_shape_[i]);
-      offset += stride * coord[i];
-      stride *= fixed_shape_[i];
+      offset += strides_[i] * coord[i];
     }
     return offset;
   }
 
   FixedShapeType fixed_shape_;
+  CoordType strides_;
 };
 
 // Mutable version of DHTIndexableView. The underlying DenseHostTensor may be
@@ -192,11 +210,16 @@ class MutableDHTIndexableView : public MutableDHTArrayView<DType> {
   using CoordType = std::array<size_t, Rank>;
 
   /*implicit*/ MutableDHTIndexableView(DenseHostTensor* dht)
-      : MutableDHTArrayView<DType>(dht), fixed_shape_(dht->shape()) {}
+      : MutableDHTArrayView<DType>(dht),
+        fixed_shape_(dht->shape()),
+        strides_(ComputeStrides(fixed_shape_)) {}
 
   // The fixed shape of this tensor.
   const FixedShapeType& FixedShape() const { return fixed_shape_; }
 
+  // The row-major strides of this tensor, in elements.
+  const CoordType& Strides() const { return strides_; }
+
   // Returns reference to element at the given coordinate.
   DType& operator[](const CoordType& coord) {
     return this->data()[OffsetOf(coord)];
@@ -219,19 +242,150 @@ class MutableDHTIndexableView : public MutableDHTArrayView<DType> {
   }
 
  private:
+  // See DHTIndexableView::ComputeStrides.
+  static CoordType ComputeStrides(const FixedShapeType& shape) {
+    CoordType strides;
+    size_t stride = 1;
+    for (int i = Rank - 1; i >= 0; --i) {
+      strides[i] = stride;
+      stride *= shape[i];
+    }
+    return strides;
+  }
+
   // Returns the offset of the given coordinate in the underlying storage.
   size_t OffsetOf(const CoordType& coord) const {
     size_t offset = 0;
+    for (size_t i = 0; i != Rank; ++i) {
+      assert(coord[i] < fixed_shape_[i]);
+      offset += strides_[i] * coord[i];
+    }
+    return offset;
+  }
+
+  FixedShapeType fixed_shape_;
+  CoordType strides_;
+};
+
+// StridedDHTIndexableView<DType, Rank> is a non-owning view over a
+// rectangular region of a DenseHostTensor with explicit element strides.  It
+// expresses slices and transposes of dense data without materializing a
+// copy: the view aliases the tensor's storage, and CopyTo materializes a
+// contiguous result only when a dense consumer requires one.
+//
+// Like the other view classes, the underlying DenseHostTensor must outlive
+// the view.
+template <typename DType, size_t Rank>
+class StridedDHTIndexableView {
+ public:
+  using FixedShapeType = FixedRankShape<Rank>;
+  using CoordType = std::array<size_t, Rank>;
+
+  StridedDHTIndexableView(const DType* data, const FixedShapeType& shape,
+                          const CoordType& strides)
+      : data_(data), fixed_shape_(shape), strides_(strides) {}
+
+  // View of the `sizes` region of `dht` starting at element coordinate
+  // `begins`.  The caller must ensure the region is in bounds.
+  static StridedDHTIndexableView Slice(const DenseHostTensor& dht,
+                                       const CoordType& begins,
+                                       const FixedShapeType& sizes) {
+    FixedShapeType dht_shape(dht.shape());
+    CoordType dense_strides = DenseStrides(dht_shape);
+    size_t offset = 0;
+    for (size_t i = 0; i != Rank; ++i) {
+      assert(begins[i] + sizes[i] <= dht_shape[i] && "slice out of bounds");
+      offset += begins[i] * dense_strides[i];
+    }
+    return StridedDHTIndexableView(
+        static_cast<const DType*>(dht.data()) + offset, sizes, dense_strides);
+  }
+
+  // View of `dht` with its dimensions reordered so that result dimension i
+  // is source dimension permutation[i].
+  static StridedDHTIndexableView Transpose(const DenseHostTensor& dht,
+                                           const CoordType& permutation) {
+    FixedShapeType dht_shape(dht.shape());
+    CoordType dense_strides = DenseStrides(dht_shape);
+    FixedShapeType shape;
+    CoordType strides;
+    for (size_t i = 0; i != Rank; ++i) {
+      assert(permutation[i] < Rank && "invalid permutation");
+      shape[i] = dht_shape[permutation[i]];
+      strides[i] = dense_strides[permutation[i]];
+    }
+    return StridedDHTIndexableView(static_cast<const DType*>(dht.data()),
+                                   shape, strides);
+  }
+
+  const FixedShapeType& FixedShape() const { return fixed_shape_; }
+  const CoordType& Strides() const { return strides_; }
+  const DType* data() const { return data_; }
+  size_t NumElements() const { return fixed_shape_.GetNumElements(); }
+
+  // True if the viewed elements are contiguous in row-major order, i.e. the
+  // view can alias dense storage without a copy.
+  bool IsContiguous() const {
+    size_t expected_stride = 1;
+    for (int i = Rank - 1; i >= 0; --i) {
+      if (fixed_shape_[i] != 1 && strides_[i] != expected_stride) return false;
+      expected_stride *= fixed_shape_[i];
+    }
+    return true;
+  }
+
+  // Returns reference to element at the given coordinate.
+  const DType& operator[](const CoordType& coord) const {
+    return data_[OffsetOf(coord)];
+  }
+
+  // Convenience wrapper around operator[]. Specify the Coord as a list of
+  // index arguments rather than a 'Coord'.
+  template <typename... Dims>
+  const DType& ElementAt(Dims... dims) const {
+    return (*this)[CoordFromDims<Rank, Dims...>(dims...)];
+  }
+
+  // Materialize the viewed region into contiguous row-major storage; used
+  // when a dense consumer requires a contiguous operand.
+  void CopyTo(MutableDHTIndexableView<DType, Rank> dest) const {
+    assert(dest.FixedShape() == fixed_shape_);
+    DType* out = dest.data();
+    CoordType coord{};
+    for (size_t e = NumElements(); e != 0; --e) {
+      *out++ = (*this)[coord];
+      // Advance the coordinate in row-major order.
+      for (int i = Rank - 1; i >= 0; --i) {
+        if (++coord[i] != static_cast<size_t>(fixed_shape_[i])) break;
+        coord[i] = 0;
+      }
+    }
+  }
+
+ private:
+  // The row-major strides of a contiguous tensor of the given shape.
+  static CoordType DenseStrides(const FixedShapeType& shape) {
+    CoordType strides;
     size_t stride = 1;
     for (int i = Rank - 1; i >= 0; --i) {
+      strides[i] = stride;
+      stride *= shape[i];
+    }
+    return strides;
+  }
+
+  size_t OffsetOf(const CoordType& coord) const {
+    size_t offset = 0;
+    for (size_t i = 0; i != Rank; ++i) {
       assert(coord[i] < fixed_shape_[i]);
-      offset += stride * coord[i];
-      stride *= fixed_shape_[i];
+      offset += strides_[i] * coord[i];
     }
     return offset;
   }
 
+  const DType* data_;
   FixedShapeType fixed_shape_;
+  CoordType strides_;
 };
 
 }  // namespace tfrt
@@ -22,9 +22,13 @@
 #ifndef TFRT_TENSOR_DENSE_TENSOR_UTILS_H_
 #define TFRT_TENSOR_DENSE_TENSOR_UTILS_H_
 
+#include <algorithm>
 #include <complex>
+#include <cstring>
+#include <limits>
 #include <type_traits>
 
+#include "tfrt/host_context/parallel_for.h"
 #include "tfrt/tensor/dense_host_tensor_view.h"
 
 namespace tfrt {
@@ -87,6 +91,89 @@ bool operator==(const DHTArrayView<T> lhs, const DHTArrayView<T> rhs) {
   return CompareTensors<T>(lhs, rhs, [](T x, T y) { return x == y; });
 }
 
+// Returns true if the two tensors have identical metadata and identical
+// payload bytes. This is the fastest possible comparison (a single memcmp
+// over the contiguous payload), but it distinguishes -0.0 from 0.0 and
+// never matches NaNs; use it for integer tensors and for byte-exact golden
+// outputs.
+inline bool TensorsBitwiseEqual(const DenseHostTensor& lhs,
+                                const DenseHostTensor& rhs) {
+  if (lhs.metadata() != rhs.metadata()) return false;
+  if (lhs.data() == rhs.data()) return true;
+  return std::memcmp(lhs.data(), rhs.data(), lhs.DataSizeInBytes()) == 0;
+}
+
+// Index reported by FindFirstMismatch when all element pairs satisfy the
+// predicate.
+static constexpr size_t kNoElementMismatch = std::numeric_limits<size_t>::max();
+
+namespace internal {
+
+// Scans [begin, end) and returns the smallest index whose element pair fails
+// `pred`, or kNoElementMismatch. The first pass accumulates a branch-free
+// conjunction that the compiler vectorizes; only a failing block pays for the
+// scalar rescan that recovers the index.
+template <typename T, typename Pred>
+size_t ScanBlockForMismatch(const T* lhs, const T* rhs, size_t begin,
+                            size_t end, Pred pred) {
+  bool all_match = true;
+  for (size_t i = begin; i < end; ++i) all_match &= pred(lhs[i], rhs[i]);
+  if (all_match) return kNoElementMismatch;
+  for (size_t i = begin; i < end; ++i) {
+    if (!pred(lhs[i], rhs[i])) return i;
+  }
+  return kNoElementMismatch;
+}
+
+}  // namespace internal
+
+// Compares two same-shaped tensors in parallel on `host` and asynchronously
+// returns the index of the first element pair for which `pred` returns
+// false, or kNoElementMismatch if the tensors match everywhere. Both tensors
+// must stay alive until the returned value is available.
+template <typename T, typename Pred>
+AsyncValueRef<size_t> FindFirstMismatch(DHTArrayView<T> lhs,
+                                        DHTArrayView<T> rhs, Pred pred,
+                                        HostContext* host) {
+  assert(lhs.Shape() == rhs.Shape() &&
+         "FindFirstMismatch requires same-shaped tensors");
+  const size_t num_elements = lhs.NumElements();
+  if (num_elements == 0)
+    return host->MakeAvailableAsyncValueRef<size_t>(kNoElementMismatch);
+
+  // Large blocks amortize task scheduling; a block is a few hundred
+  // microseconds of linear scanning even for wide element types.
+  return ParallelFor(host).Reduce<size_t>(
+      num_elements, ParallelFor::BlockSizes::Min(64 * 1024),
+      [lhs_data = lhs.data(), rhs_data = rhs.data(), pred](
+          size_t begin, size_t end) -> size_t {
+        return internal::ScanBlockForMismatch(lhs_data, rhs_data, begin, end,
+                                              pred);
+      },
+      [](size_t a, size_t b) -> size_t { return std::min(a, b); });
+}
+
+// Parallel variant of AllElementsClose for tensors large enough that a
+// single-threaded scan is too slow to run inline (e.g. validating
+// production-size outputs in canary replicas). Asynchronously returns false
+// on any shape or element mismatch. Both tensors must stay alive until the
+// returned value is available.
+template <typename T, int ULP = 2>
+AsyncValueRef<bool> AllElementsCloseAsync(DHTArrayView<T> lhs,
+                                          DHTArrayView<T> rhs,
+                                          HostContext* host) {
+  if (lhs.Shape() != rhs.Shape())
+    return host->MakeAvailableAsyncValueRef<bool>(false);
+  auto first_mismatch =
+      FindFirstMismatch<T>(lhs, rhs, TensorElementsClose<T, ULP>, host);
+  auto result = host->MakeUnconstructedAsyncValueRef<bool>();
+  first_mismatch.AndThen(
+      [first_mismatch = first_mismatch.CopyRef(), result = result.CopyRef()]() {
+        result.emplace(first_mismatch.get() == kNoElementMismatch);
+      });
+  return result;
+}
+
 template <typename T>
 bool operator!=(const DHTArrayView<T> lhs, const DHTArrayView<T> rhs) {
   return !(lhs == rhs);
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- dtype_dispatch.h -----------------------------------------*- C++ -*-===//
+//
+// This file defines utilities for dispatching over DType through constexpr
+// function pointer tables.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TENSOR_DTYPE_DISPATCH_H_
+#define TFRT_TENSOR_DTYPE_DISPATCH_H_
+
+#include <cassert>
+#include <cstddef>
+
+#include "tfrt/tensor/dtype.h"
+
+namespace tfrt {
+
+// Number of DType kinds, including Invalid. String is the last kind defined
+// in dtype.def; extend this if kinds are added after it.
+constexpr int kNumDTypeKinds = DType::String + 1;
+
+// A compile-time list of dtype kinds a kernel is instantiated for.
+template <DType::Kind... Kinds>
+struct DTypeList {};
+
+// The kind lists below mirror the DTYPE_* groups in dtype.def.
+using FloatDTypeList = DTypeList<DType::F32, DType::F64>;
+using IntDTypeList = DTypeList<DType::UI8, DType::I8, DType::I16, DType::I32,
+                               DType::I64>;
+using TrivialDTypeList =
+    DTypeList<DType::UI8, DType::I8, DType::I16, DType::I32, DType::I64,
+              DType::F32, DType::F64, DType::BOOL>;
+using NumericDTypeList =
+    DTypeList<DType::UI8, DType::I8, DType::I16, DType::I32, DType::I64,
+              DType::F16, DType::F32, DType::F64>;
+
+// The dtypes shipped kernels are pre-instantiated for. Dispatching over this
+// list instead of one of the full lists above lets a build drop the
+// instantiations of dtypes it does not serve: defining
+// TFRT_DTYPE_DISPATCH_FLOAT_ONLY narrows the set to the float dtypes, which
+// measurably shrinks kernel-heavy binaries (see code_size_test_driver).
+// Lookups for a filtered-out dtype return null and must be handled by the
+// caller.
+#ifdef TFRT_DTYPE_DISPATCH_FLOAT_ONLY
+using ShippedDTypeList = FloatDTypeList;
+#else
+using ShippedDTypeList = NumericDTypeList;
+#endif
+
+// DTypeDispatch maps a runtime DType to a pre-instantiated function pointer
+// through a table generated at compile time, replacing the hand-written
+// switch statements over dtype.def. `Kernel` is a class template whose
+// instantiation Kernel<T> provides a static member function `Invoke` with
+// signature Ret(Args...).
+//
+// Example:
+//   template <typename T>
+//   struct FillZero {
+//     static void Invoke(DenseHostTensor* t) {
+//       MutableDHTArrayView<T>(t).Fill(T(0));
+//     }
+//   };
+//   ...
+//   auto* fn = DTypeDispatch<FillZero, void, DenseHostTensor*>::Lookup(
+//       ShippedDTypeList(), dtype);
+//   if (!fn) return EmitUnsupportedDTypeError(...);
+//   fn(&tensor);
+//
+// Unlike a switch, only the dtypes in the list are instantiated, and dispatch
+// is one indexed load instead of a branch tree.
+template <template <typename> class Kernel, typename Ret, typename... Args>
+class DTypeDispatch {
+ public:
+  using FnPtr = Ret (*)(Args...);
+
+  // Returns the function for `dtype`, or null if `dtype` is not in the list.
+  template <DType::Kind... Kinds>
+  static FnPtr Lookup(DTypeList<Kinds...> list, DType dtype) {
+    static constexpr Table kTable = MakeTable(list);
+    assert(dtype.kind() >= 0 && dtype.kind() < kNumDTypeKinds);
+    return kTable.fns[dtype.kind()];
+  }
+
+ private:
+  // A wrapper so the table can be built element by element in a C++14
+  // constexpr function (std::array's operator[] cannot).
+  struct Table {
+    FnPtr fns[kNumDTypeKinds];
+  };
+
+  template <DType::Kind... Kinds>
+  static constexpr Table MakeTable(DTypeList<Kinds...>) {
+    Table table{};
+    const FnPtr fns[] = {&Kernel<TypeForDTypeKind<Kinds>>::Invoke...};
+    const DType::Kind kinds[] = {Kinds...};
+    for (size_t i = 0; i != sizeof...(Kinds); ++i) table.fns[kinds[i]] = fns[i];
+    return table;
+  }
+};
+
+}  // namespace tfrt
+
+#endif  // TFRT_TENSOR_DTYPE_DISPATCH_H_
@@ -30,12 +30,27 @@
 
 namespace tfrt {
 
-// Represents a tensor of strings. The metadata of strings (pointer and size)
-// are stored contiguously in row major format with no padding or stride.
+// Represents a tensor of strings. The characters of all elements are stored
+// in one contiguous byte arena, and the elements are exposed as string_views
+// into that arena, stored contiguously in row major format with no padding
+// or stride.  This makes a 10k-element string tensor two allocations instead
+// of 10k, keeps accesses cache-friendly, and allows the character data to be
+// serialized with a single memcpy.
+//
+// The flat layout is immutable: elements cannot be resized in place.
+// Kernels that need to mutate strings should copy them out with
+// CopyToStdStrings, modify them, and build a new tensor with
+// CreateFromStrings.
 class StringHostTensor final : public HostTensor {
  public:
-  // Allocate a StringHostTensor with uninitialized data. Return None on
-  // failure.
+  // Create a StringHostTensor whose elements are copies of `values`, which
+  // must have one entry per element of the shape. Return None on failure.
+  static llvm::Optional<StringHostTensor> CreateFromStrings(
+      const TensorMetadata& metadata, ArrayRef<string_view> values,
+      HostContext* host);
+
+  // Allocate a StringHostTensor whose elements are all empty strings. Return
+  // None on failure.
   static llvm::Optional<StringHostTensor> CreateUninitialized(
       const TensorMetadata& metadata, HostContext* host);
 
@@ -43,9 +58,10 @@ class StringHostTensor final : public HostTensor {
   static AsyncValueRef<StringHostTensor> MakeConstructedAsyncValueRef(
       const TensorMetadata& metadata, HostContext* host);
 
-  StringHostTensor(const TensorMetadata& metadata,
-                   HostArray<std::string> strings)
+  StringHostTensor(const TensorMetadata& metadata, HostArray<char> arena,
+                   HostArray<string_view> strings)
       : HostTensor(Subclass::StringHost, metadata),
+        arena_(std::move(arena)),
         strings_(std::move(strings)) {}
 
   StringHostTensor(StringHostTensor&& other);
@@ -54,8 +70,17 @@ class StringHostTensor final : public HostTensor {
   StringHostTensor(const StringHostTensor& other) = delete;
   StringHostTensor& operator=(const StringHostTensor& other) = delete;
 
-  ArrayRef<std::string> strings() const { return strings_.array(); }
-  MutableArrayRef<std::string> strings() { return strings_.mutable_array(); }
+  // The elements of the tensor, viewing the arena.  The views are valid as
+  // long as this tensor is alive.
+  ArrayRef<string_view> strings() const { return strings_.array(); }
+
+  // The character data of all elements, contiguous in element order.
+  ArrayRef<char> arena() const { return arena_.array(); }
+
+  // Copy the elements out into mutable std::strings; the mutation path for
+  // kernels that rewrite strings before building a new tensor with
+  // CreateFromStrings.
+  SmallVector<std::string, 8> CopyToStdStrings() const;
 
   void Print(raw_ostream& os) const override;
 
@@ -67,8 +92,8 @@ class StringHostTensor final : public HostTensor {
   }
 
  private:
-  // TODO(tf-runtime-team): Consider making it reference counted.
-  HostArray<std::string> strings_;
+  HostArray<char> arena_;
+  HostArray<string_view> strings_;
 };
 
 inline StringHostTensor::StringHostTensor(StringHostTensor&& other) = default;
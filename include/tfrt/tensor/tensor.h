@@ -43,6 +43,7 @@ class Tensor {
     DenseHost,   // This is a DenseHostTensor
     ScalarHost,  // This is a ScalarHostTensor
     CooHost,     // This is a CooHostTensor
+    CsrHost,     // This is a CsrHostTensor
     StringHost,  // This is a StringHostTensor
 
     DenseGpu,           // This is a DenseGpuTensor
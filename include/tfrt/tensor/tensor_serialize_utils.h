@@ -38,6 +38,7 @@ namespace tfrt {
 class DenseHostTensor;
 class HostContext;
 class DenseAttr;
+class SharedMemoryRegion;
 
 // DenseHostTensor to DenseAttr.
 std::vector<uint8_t> SerializeDenseHostTensorToDenseAttr(
@@ -47,10 +48,65 @@ std::vector<uint8_t> SerializeDenseHostTensorToDenseAttr(
 llvm::Expected<DenseHostTensor> DeserializeDenseHostTensorFromDenseAttr(
     DenseAttr attr, HostContext* host);
 
+// Create a DenseHostTensor that aliases the attribute's element payload in
+// place instead of copying it. The payload must meet the dtype's host
+// alignment requirement (BEF emitters align dense payloads to
+// kAttributeTensorAlignment). The caller must ensure the BEF file backing
+// `attr` outlives the returned tensor, and must not mutate the tensor's
+// contents.
+DenseHostTensor CreateDenseHostTensorAliasingDenseAttr(DenseAttr attr);
+
 TensorMetadata CreateTensorMetadata(const DenseAttr& attr);
 
 DenseView CreateDenseView(const DenseAttr& attr);
 
+// Shared-memory transport between co-located processes. The message carries
+// only the tensor metadata and the region offset of its buffer, which must
+// have been allocated from `region` (SharedMemoryRegion::AllocateBuffer);
+// the receiver maps the same region by name and reconstructs a tensor
+// aliasing the same pages, so no payload bytes ever cross the wire. If the
+// message is dropped instead of delivered, release the buffer's in-flight
+// reference with SharedMemoryRegion::DropExported.
+llvm::Expected<std::vector<uint8_t>> SerializeDenseHostTensorToShmMessage(
+    const DenseHostTensor& dht, SharedMemoryRegion* region);
+
+llvm::Expected<DenseHostTensor> DeserializeDenseHostTensorFromShmMessage(
+    llvm::ArrayRef<uint8_t> message, RCReference<SharedMemoryRegion> region);
+
+// One entry of a scatter-gather serialized tensor. The fields mirror struct
+// iovec (base pointer, then length), so a transport can copy the entries
+// straight into a writev/sendmsg call.
+struct TensorIoVec {
+  const void* data;
+  size_t size;
+};
+
+// Returns the number of header bytes SerializeDenseHostTensorScatterGather
+// writes for a tensor of rank `rank`.
+size_t SerializedTensorHeaderSize(int rank);
+
+// Scatter-gather serialization for transports: encodes the tensor's
+// metadata into the caller-provided `header` buffer (which must hold at
+// least SerializedTensorHeaderSize(rank) bytes) and appends iovec-style
+// entries to `iovs` covering the whole message - the header first, then the
+// tensor's payload memory referenced in place. Unlike the dense-attr path
+// above, no intermediate buffer is allocated and the payload is never
+// copied; the transport gathers it off the tensor's own pages. The caller
+// keeps the tensor and the header buffer alive until the send completes.
+// The encoding is host-endian, like the shared-memory path above.
+//
+// Returns the total number of bytes the entries span.
+llvm::Expected<size_t> SerializeDenseHostTensorScatterGather(
+    const DenseHostTensor& dht, llvm::MutableArrayRef<uint8_t> header,
+    SmallVectorImpl<TensorIoVec>* iovs);
+
+// Parses a header produced by SerializeDenseHostTensorScatterGather and
+// returns the tensor's metadata. The payload that follows the header on the
+// wire spans GetHostSizeInBytes() of the returned metadata; the receiver
+// can read it straight into the final tensor buffer.
+llvm::Expected<TensorMetadata> ParseSerializedTensorHeader(
+    llvm::ArrayRef<uint8_t> header);
+
 }  // namespace tfrt
 
 #endif  // TFRT_SUPPORT_BEF_SERIALIZE_H_
@@ -47,11 +47,6 @@ class TensorShape {
  public:
   /// Create a TensorShape with the specified dimensions.
   explicit TensorShape(ArrayRef<ssize_t> dims);
-  TensorShape(const TensorShape& rhs);
-  TensorShape(TensorShape&& rhs);
-  TensorShape& operator=(const TensorShape& rhs);
-  TensorShape& operator=(TensorShape&& rhs);
-  ~TensorShape();
 
   bool operator==(const TensorShape& other) const;
   bool operator!=(const TensorShape& other) const;
@@ -94,7 +89,12 @@ class TensorShape {
   // Important: Identical shapes must have the same representation kind. For
   // Rep16 and Rep32, the representation value is assumed to be deterministic.
   // This means for Rep16 and Rep32 it is sufficient to compare the memory
-  // blocks to determine if two shapes are identical.
+  // blocks to determine if two shapes are identical.  For RepExternal, the
+  // dimension array is interned in a process-wide table, so identical shapes
+  // share the same canonical array and comparison reduces to a pointer
+  // compare.  Because the interned arrays are immutable and live for the
+  // lifetime of the process, TensorShape itself owns no storage and is
+  // trivially copyable.
   enum class RepKind : uint8_t { kRep16, kRep32, kRepExternal };
 
   struct Rep16 {
@@ -110,7 +110,9 @@ class TensorShape {
   };
 
   struct RepExternal {
-    size_t* dims;
+    // Points to a canonical, immutable dimension array owned by the process
+    // wide interning table in tensor_shape.cc.
+    const size_t* dims;
 
     // FIXME: This isn't correct for big endian systems.  static_asserts should
     // catch this below.
@@ -204,56 +206,6 @@ inline int TensorShape::GetRank() const {
   return representation_.rep16.rank;
 }
 
-inline TensorShape::TensorShape(const TensorShape& rhs) {
-  memcpy(&representation_, &rhs.representation_, sizeof(representation_));
-  if (rhs.IsRepresentationExternal()) {
-    auto rank = GetRank();
-    representation_.rep_external.dims = new size_t[rank];
-    memcpy(representation_.rep_external.dims,
-           rhs.representation_.rep_external.dims, rank * sizeof(size_t));
-  }
-}
-
-inline TensorShape::TensorShape(TensorShape&& rhs) {
-  memcpy(&representation_, &rhs.representation_, sizeof(representation_));
-
-  // We're taking the memory from the RHS, reset it to something valid.
-  if (rhs.IsRepresentationExternal()) {
-    rhs.representation_.rep16.kind = RepKind::kRep16;
-    rhs.representation_.rep16.rank = 0;
-  }
-}
-
-inline TensorShape& TensorShape::operator=(const TensorShape& rhs) {
-  if (IsRepresentationExternal()) delete[] representation_.rep_external.dims;
-
-  memcpy(&representation_, &rhs.representation_, sizeof(representation_));
-  if (rhs.IsRepresentationExternal()) {
-    auto rank = GetRank();
-    representation_.rep_external.dims = new size_t[rank];
-    memcpy(representation_.rep_external.dims,
-           rhs.representation_.rep_external.dims, rank * sizeof(size_t));
-  }
-  return *this;
-}
-
-inline TensorShape& TensorShape::operator=(TensorShape&& rhs) {
-  if (IsRepresentationExternal()) delete[] representation_.rep_external.dims;
-
-  memcpy(&representation_, &rhs.representation_, sizeof(representation_));
-
-  // We're taking the memory from the RHS, reset it to something valid.
-  if (rhs.IsRepresentationExternal()) {
-    rhs.representation_.rep16.kind = RepKind::kRep16;
-    rhs.representation_.rep16.rank = 0;
-  }
-  return *this;
-}
-
-inline TensorShape::~TensorShape() {
-  if (IsRepresentationExternal()) delete[] representation_.rep_external.dims;
-}
-
 template <size_t Rank>
 size_t FixedRankShape<Rank>::GetNumElements() const {
   std::size_t result = 1;
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- kernel_cycle_tracing.h - Per-kernel cycle tracing --------*- C++ -*-===//
+//
+// This file declares a lightweight cycle-counter based trace of kernel
+// executions. Unlike the general tracing API in tracing.h, which pays an
+// enabled-check per activity even when tracing is off, this trace is meant
+// to be compiled into a dedicated instantiation of the executor's dispatch
+// loop: the untraced instantiation contains no tracing code at all, and the
+// traced one records raw timestamp-counter values into a per-thread buffer.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TRACING_KERNEL_CYCLE_TRACING_H_
+#define TFRT_TRACING_KERNEL_CYCLE_TRACING_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "llvm/ADT/STLExtras.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+namespace tracing {
+
+// One kernel execution, in raw cycle-counter units. The kernel name points
+// into the BEF file's string section and is valid as long as the file is
+// open.
+struct KernelCycleRecord {
+  const char* kernel_name;
+  uint64_t begin_cycles;
+  uint64_t end_cycles;
+};
+
+// Read the CPU timestamp counter. On x86 this is a single rdtsc; elsewhere
+// it falls back to the steady clock, which is more expensive but keeps the
+// records meaningful.
+inline uint64_t ReadCycleCounter() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<uint64_t>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// A per-thread, append-only buffer of KernelCycleRecords. Each thread
+// appends to its own buffer, so the buffer mutex is uncontended in steady
+// state; it exists only to synchronize with a consumer draining the records.
+class KernelCycleTraceBuffer {
+ public:
+  // Return the buffer for the calling thread, creating and registering it on
+  // first use.
+  static KernelCycleTraceBuffer* GetForCurrentThread();
+
+  void Record(const char* kernel_name, uint64_t begin_cycles,
+              uint64_t end_cycles) {
+    mutex_lock lock(mu_);
+    records_.push_back({kernel_name, begin_cycles, end_cycles});
+  }
+
+  // Drain the records of all threads' buffers, invoking `consumer` on each
+  // record. Intended for incident analysis, not the hot path.
+  static void ConsumeAll(
+      llvm::function_ref<void(const KernelCycleRecord&)> consumer);
+
+ private:
+  KernelCycleTraceBuffer() = default;
+
+  // The per-thread buffer is uncontended in steady state: the owning thread
+  // appends, and a consumer takes the lock only while draining.
+  mutex mu_;
+  std::vector<KernelCycleRecord> records_ TFRT_GUARDED_BY(mu_);
+};
+
+// Turn per-kernel cycle tracing on or off. The executor samples this flag
+// when it drains its ready-kernel worklist and selects the traced or
+// untraced instantiation of the dispatch loop accordingly.
+void SetKernelCycleTracingEnabled(bool enabled);
+
+namespace internal {
+extern std::atomic<bool> kKernelCycleTracingEnabled;
+}  // namespace internal
+
+inline bool IsKernelCycleTracingEnabled() {
+  return internal::kKernelCycleTracingEnabled.load(std::memory_order_relaxed);
+}
+
+}  // namespace tracing
+}  // namespace tfrt
+
+#endif  // TFRT_TRACING_KERNEL_CYCLE_TRACING_H_
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- kernel_latency_stats.h - Per-kernel latency aggregation --*- C++ -*-===//
+//
+// This file declares an aggregation mode on top of the per-kernel cycle
+// tracing in kernel_cycle_tracing.h. Instead of keeping one record per
+// kernel execution, the executor accumulates cycle totals and a
+// power-of-two latency histogram per kernel into per-thread tables; the
+// tables are merged when the runtime quiesces and the top kernels by total
+// and tail time are published through the metrics API. This trades the full
+// timeline of the cycle trace for bounded memory, so it can stay enabled on
+// live jobs.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TRACING_KERNEL_LATENCY_STATS_H_
+#define TFRT_TRACING_KERNEL_LATENCY_STATS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tfrt {
+namespace tracing {
+
+// Turn per-kernel latency aggregation on or off. Like cycle tracing, the
+// executor samples this when it drains its ready-kernel worklist and selects
+// the traced dispatch loop instantiation while it is set.
+void SetKernelLatencyAggregationEnabled(bool enabled);
+
+namespace internal {
+extern std::atomic<bool> kKernelLatencyAggregationEnabled;
+}  // namespace internal
+
+inline bool IsKernelLatencyAggregationEnabled() {
+  return internal::kKernelLatencyAggregationEnabled.load(
+      std::memory_order_relaxed);
+}
+
+// Account one execution of `kernel_name` taking `cycles` to the calling
+// thread's table. The kernel name must stay valid until the next merge (the
+// executor passes pointers into the BEF file's string section).
+void RecordKernelLatency(const char* kernel_name, uint64_t cycles);
+
+// Merge every thread's table into the global aggregate and refresh the
+// "bef_executor.top_kernels_by_cycles" metrics gauge. Call while the runtime
+// is quiesced, so no dispatch loop is mid-drain; HostContext::Quiesce
+// callers such as the BEF executor driver do this after quiescing.
+void MergeKernelLatencyStats();
+
+// Aggregated statistics of one kernel, in raw cycle-counter units.
+struct KernelLatencySummary {
+  std::string name;
+  uint64_t invocations;
+  uint64_t total_cycles;
+  // Upper bound of the power-of-two histogram bucket containing the 99th
+  // percentile invocation.
+  uint64_t p99_cycles;
+};
+
+// The top `n` kernels of the merged aggregate, ordered by total cycles.
+std::vector<KernelLatencySummary> TopKernelsByTotalCycles(int n);
+
+}  // namespace tracing
+}  // namespace tfrt
+
+#endif  // TFRT_TRACING_KERNEL_LATENCY_STATS_H_
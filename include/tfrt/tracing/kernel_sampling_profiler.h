@@ -0,0 +1,84 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- kernel_sampling_profiler.h - Kernel-tagged CPU sampling --*- C++ -*-===//
+//
+// CPU profiles of the executor attribute everything to the dispatch loop,
+// hiding which kernel was actually running. This file declares a per-thread
+// "current kernel" slot that the dispatch loop publishes with one relaxed
+// store per kernel, plus a SIGPROF-based sampler that reads the slot from its
+// signal handler and aggregates hit counts per kernel name. The result can
+// be written as folded stacks for flamegraph tooling.
+//
+// The slot is maintained unconditionally - it is a single store - so an
+// external signal-based profiler can also read it without any opt-in.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TRACING_KERNEL_SAMPLING_PROFILER_H_
+#define TFRT_TRACING_KERNEL_SAMPLING_PROFILER_H_
+
+#include <atomic>
+
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+namespace tracing {
+
+namespace internal {
+// The name of the kernel the thread is currently executing, or nullptr
+// between kernels. Atomic so a signal handler interrupting the store sees
+// either the old or the new pointer, never a torn value. The pointed-to
+// string must stay live for the process (kernel names in a loaded BEF file
+// are; see BEFFile ownership).
+extern thread_local std::atomic<const char*> kCurrentKernelName;
+}  // namespace internal
+
+// Publishes the kernel the calling thread is about to execute. Called by the
+// dispatch loop with the kernel name, and with nullptr afterwards so idle
+// time is not attributed to the last kernel that ran.
+inline void SetCurrentKernelForSampling(const char* kernel_name) {
+  internal::kCurrentKernelName.store(kernel_name, std::memory_order_relaxed);
+}
+
+// Returns the calling thread's current kernel, or nullptr. Async-signal-safe;
+// intended to be called from a profiler's signal handler.
+inline const char* GetCurrentKernelForSampling() {
+  return internal::kCurrentKernelName.load(std::memory_order_relaxed);
+}
+
+// Starts the built-in sampler: a SIGPROF handler plus a process CPU-time
+// interval timer firing `samples_per_second` times per second of consumed
+// CPU. Each sample charges one hit to the interrupted thread's current
+// kernel (or to idle). Returns false if a sampler is already running or the
+// timer could not be installed.
+bool StartKernelSampler(int samples_per_second);
+
+// Stops the sampler and restores the previous SIGPROF disposition.
+// Accumulated samples are retained until written.
+void StopKernelSampler();
+
+// Writes the accumulated samples as folded stacks, one line per kernel:
+//   bef_executor;<kernel name> <count>
+// which flamegraph.pl and speedscope consume directly. Samples taken while
+// no kernel was running are reported under "<no kernel>". Resets the
+// accumulated counts.
+void WriteFoldedKernelSamples(raw_ostream& os);
+
+}  // namespace tracing
+}  // namespace tfrt
+
+#endif  // TFRT_TRACING_KERNEL_SAMPLING_PROFILER_H_
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- ring_buffer_tracing_sink.h - Ring Buffer Tracing Sink ----*- C++ -*-===//
+//
+// This file declares a low-overhead tracing consumer that records fixed-size
+// binary events into per-thread ring buffers, and an exporter to Chrome
+// trace-event format.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_TRACING_RING_BUFFER_TRACING_SINK_H_
+#define TFRT_TRACING_RING_BUFFER_TRACING_SINK_H_
+
+#ifndef NO_TFRT_TRACING
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/tracing/tracing.h"
+
+namespace tfrt {
+namespace internal {
+namespace tracing {
+
+// Sink function: appends the activity as a fixed-size record (interned name
+// id plus timestamps) to the calling thread's ring buffer. Each ring keeps
+// the most recent events of its thread; older events are overwritten.
+void RingBufferRecordActivity(TracingActivity& activity);
+
+// Writes every buffered event as Chrome trace-event JSON, one timeline row
+// per recording thread. The output loads directly into chrome://tracing or
+// Perfetto. Safe to call from a background thread while recording continues;
+// events recorded during the export may or may not be included.
+void WriteChromeTrace(raw_ostream& os);
+
+}  // namespace tracing
+}  // namespace internal
+}  // namespace tfrt
+
+#endif  // NO_TFRT_TRACING
+#endif  // TFRT_TRACING_RING_BUFFER_TRACING_SINK_H_
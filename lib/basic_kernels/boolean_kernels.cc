@@ -44,10 +44,13 @@ bool HexAnd(bool arg0, bool arg1) { return arg0 && arg1; }
 //===----------------------------------------------------------------------===//
 
 void RegisterBooleanKernels(KernelRegistry* registry) {
-  registry->AddKernel("hex.constant.i1", TFRT_KERNEL(HexConstantI1));
-  registry->AddKernel("hex.constant.bool", TFRT_KERNEL(HexConstantI1));
+  registry->AddSyncKernel("hex.constant.i1", TFRT_KERNEL(HexConstantI1),
+                          KernelEffect::kPure);
+  registry->AddSyncKernel("hex.constant.bool", TFRT_KERNEL(HexConstantI1),
+                          KernelEffect::kPure);
 
-  registry->AddKernel("hex.and.i1", TFRT_KERNEL(HexAnd));
+  registry->AddSyncKernel("hex.and.i1", TFRT_KERNEL(HexAnd),
+                          KernelEffect::kPure);
 }
 
 }  // namespace tfrt
@@ -19,6 +19,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/execution_context.h"
 #include "tfrt/host_context/function.h"
 #include "tfrt/host_context/kernel_frame.h"
 #include "tfrt/host_context/kernel_utils.h"
@@ -37,13 +38,15 @@ static void HexMergeChains(Argument<Chain> chain_in,
 }
 
 static void HexCall(RemainingArguments args, RemainingResults results,
-                    Attribute<Function> fn, HostContext* host) {
+                    Attribute<Function> fn, const ExecutionContext& exec_ctx) {
   assert(fn->argument_types().size() == args.size() &&
          "argument count mismatch");
   assert(fn->result_types().size() == results.size() &&
          "result count mismatch");
 
-  fn->Execute(args.values(), results.values(), host);
+  // Pass the ExecutionContext through so the callee inherits the caller's
+  // cancellation token.
+  fn->Execute(exec_ctx, args.values(), results.values());
 }
 
 // hex.if dispatches to a 'true' or 'false' function based on a condition.
@@ -61,7 +64,8 @@ static void HexCall(RemainingArguments args, RemainingResults results,
 // hex.if to make an invocation non-strict.
 static void HexIf(RemainingArguments args, RemainingResults results,
                   Attribute<Function> true_fn_const,
-                  Attribute<Function> false_fn_const, HostContext* host) {
+                  Attribute<Function> false_fn_const,
+                  const ExecutionContext& exec_ctx) {
   assert(args.size() > 0);
 
   const Function* true_fn = &(*true_fn_const);
@@ -75,9 +79,9 @@ static void HexIf(RemainingArguments args, RemainingResults results,
          true_fn->result_types() == false_fn->result_types() &&
          "true and false function types need to line up");
 
-  auto if_impl = [host](const Function* true_fn, const Function* false_fn,
-                        ArrayRef<AsyncValue*> args,
-                        MutableArrayRef<RCReference<AsyncValue>> results) {
+  auto if_impl = [exec_ctx](const Function* true_fn, const Function* false_fn,
+                            ArrayRef<AsyncValue*> args,
+                            MutableArrayRef<RCReference<AsyncValue>> results) {
     AsyncValue* condition = args[0];
     // If we have an error, then we can force propagate errors to all the
     // results.
@@ -88,7 +92,7 @@ static void HexIf(RemainingArguments args, RemainingResults results,
 
     // Otherwise, we know which way to go.
     const Function* fn = condition->get<bool>() ? true_fn : false_fn;
-    fn->Execute(args.drop_front(), results, host);
+    fn->Execute(exec_ctx, args.drop_front(), results);
   };
 
   // If the condition is already available, we can immediately dispatch the
@@ -141,8 +145,9 @@ static void HexIf(RemainingArguments args, RemainingResults results,
 // This is a helper function that runs a block of iterations and sets up a
 // callback to run the next block at the end.
 static void HexRepeatI32Block(
-    int32_t start, int32_t block_size, int32_t count_value, HostContext* host,
-    RCReference<const Function> body_fn_ref, RCArray<AsyncValue> args,
+    int32_t start, int32_t block_size, int32_t count_value,
+    const ExecutionContext& exec_ctx, RCReference<const Function> body_fn_ref,
+    RCArray<AsyncValue> args,
     SmallVector<RCReference<IndirectAsyncValue>, 4>&& result_refs) {
   // Temporary buffers to store intermediate arguments and results.
   SmallVector<AsyncValue*, 8> passed_args(args.values().begin(),
@@ -155,7 +160,7 @@ static void HexRepeatI32Block(
   auto end = std::min(start + block_size, count_value);
 
   for (int i = start; i < end; ++i) {
-    if (auto cancel_av = host->GetCancelAsyncValue()) {
+    if (auto cancel_av = exec_ctx.GetCancelAsyncValue()) {
       // Cancellation detected. DropRef on args if needed, set results to
       // the cancel async value, and break out.
       for (int arg = 0; arg != num_fn_args; ++arg) {
@@ -171,7 +176,7 @@ static void HexRepeatI32Block(
       return;
     }
 
-    body_fn_ref->Execute(passed_args, results, host);
+    body_fn_ref->Execute(exec_ctx, passed_args, results);
 
     for (int arg = 0; arg != num_fn_args; ++arg) {
       // If this is not the first iteration, destroy the loop-carried
@@ -197,11 +202,11 @@ static void HexRepeatI32Block(
   } else {
     assert(num_fn_args > 0);
     passed_args[0]->AndThen(
-        [end, block_size, count_value, host,
+        [end, block_size, count_value, exec_ctx,
          body_fn_ref = std::move(body_fn_ref),
          arg_refs = RCArray<AsyncValue>(llvm::makeArrayRef(passed_args)),
          result_refs = std::move(result_refs)]() mutable {
-          HexRepeatI32Block(end, block_size, count_value, host,
+          HexRepeatI32Block(end, block_size, count_value, exec_ctx,
                             std::move(body_fn_ref), std::move(arg_refs),
                             std::move(result_refs));
         });
@@ -211,7 +216,8 @@ static void HexRepeatI32Block(
 // This takes a single i32 iteration count, plus arguments that are passed to
 // the body_fn and eventually returned.
 static void HexRepeatI32(RemainingArguments args, RemainingResults results,
-                         Attribute<Function> body_fn_const, HostContext* host) {
+                         Attribute<Function> body_fn_const,
+                         const ExecutionContext& exec_ctx) {
   assert(args.size() > 0 && args.size() - 1 == results.size());
 
   const Function* body_fn = &(*body_fn_const);
@@ -221,7 +227,7 @@ static void HexRepeatI32(RemainingArguments args, RemainingResults results,
          "Argument and result types of repeat body_fn must match");
 
   auto while_impl =
-      [host](
+      [exec_ctx](
           RCReference<const Function> body_fn_ref, RCArray<AsyncValue> arg_refs,
           SmallVector<RCReference<IndirectAsyncValue>, 4> result_refs) mutable {
         // TODO(xldrx,jingdong): Get the block_size from an optional attribute.
@@ -259,7 +265,7 @@ static void HexRepeatI32(RemainingArguments args, RemainingResults results,
         // Run 'body_fn' at least once.
         assert(count_value > 0);
 
-        HexRepeatI32Block(0, block_size, count_value, host,
+        HexRepeatI32Block(0, block_size, count_value, exec_ctx,
                           std::move(body_fn_ref), RCArray<AsyncValue>(args),
                           std::move(result_refs));
       };
@@ -311,9 +317,14 @@ static void HexAliasValue(Chain chain, RemainingArguments args,
 
 // This is the entrypoint to the library.
 void RegisterControlFlowKernels(KernelRegistry* registry) {
-  registry->AddKernel("hex.new.chain", TFRT_KERNEL(HexNewChain));
-  registry->AddKernel("hex.merge.chains", TFRT_KERNEL(HexMergeChains));
-  registry->AddKernel("hex.alias.value", TFRT_KERNEL(HexAliasValue));
+  registry->AddKernel("hex.new.chain", TFRT_KERNEL(HexNewChain),
+                      KernelEffect::kPure);
+  registry->AddKernel("hex.merge.chains", TFRT_KERNEL(HexMergeChains),
+                      KernelEffect::kPure);
+  registry->AddKernel("hex.alias.value", TFRT_KERNEL(HexAliasValue),
+                      KernelEffect::kPure);
+  // The repeat/call/if kernels run a nested function, so their effects are
+  // whatever the callee's are; they keep the conservative default.
   registry->AddKernel("hex.repeat.i32", TFRT_KERNEL(HexRepeatI32));
   registry->AddKernel("hex.call", TFRT_KERNEL(HexCall));
   registry->AddKernel("hex.if", TFRT_KERNEL(HexIf));
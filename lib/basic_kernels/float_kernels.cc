@@ -84,16 +84,27 @@ static T HexMultiply(T arg0, T arg1) {
 //===----------------------------------------------------------------------===//
 
 void RegisterFloatKernels(KernelRegistry* registry) {
-  registry->AddKernel("hex.constant.f32", TFRT_KERNEL(HexConstantF32));
-  registry->AddKernel("hex.add.f32", TFRT_KERNEL(HexAddF32));
-  registry->AddKernel("hex.print.f32", TFRT_KERNEL(HexPrintF32));
-
-  registry->AddKernel("hex.constant.f64", TFRT_KERNEL(HexConstantF64));
-  registry->AddKernel("hex.add.f64", TFRT_KERNEL(HexAddF64));
-  registry->AddKernel("hex.print.f64", TFRT_KERNEL(HexPrintF64));
-  registry->AddKernel("hex.minimum.f64", TFRT_KERNEL(HexMinimum<double>));
-  registry->AddKernel("hex.div.f64", TFRT_KERNEL(HexDiv<double>));
-  registry->AddKernel("hex.multiply.f64", TFRT_KERNEL(HexMultiply<double>));
+  registry->AddSyncKernel("hex.constant.f32", TFRT_SYNC_KERNEL(HexConstantF32),
+                          KernelEffect::kPure);
+  registry->AddSyncKernel("hex.add.f32", TFRT_SYNC_KERNEL(HexAddF32),
+                          KernelEffect::kPure);
+  registry->AddSyncKernel("hex.print.f32", TFRT_KERNEL(HexPrintF32),
+                          KernelEffect::kIO);
+
+  registry->AddSyncKernel("hex.constant.f64", TFRT_SYNC_KERNEL(HexConstantF64),
+                          KernelEffect::kPure);
+  registry->AddSyncKernel("hex.add.f64", TFRT_SYNC_KERNEL(HexAddF64),
+                          KernelEffect::kPure);
+  registry->AddSyncKernel("hex.print.f64", TFRT_KERNEL(HexPrintF64),
+                          KernelEffect::kIO);
+  registry->AddSyncKernel("hex.minimum.f64",
+                          TFRT_SYNC_KERNEL(HexMinimum<double>),
+                          KernelEffect::kPure);
+  registry->AddSyncKernel("hex.div.f64", TFRT_KERNEL(HexDiv<double>),
+                          KernelEffect::kPure);
+  registry->AddSyncKernel("hex.multiply.f64",
+                          TFRT_SYNC_KERNEL(HexMultiply<double>),
+                          KernelEffect::kPure);
 }
 
 }  // namespace tfrt
@@ -116,32 +116,55 @@ static Tout HexCast(Tin value) {
 //===----------------------------------------------------------------------===//
 
 void RegisterIntegerKernels(KernelRegistry* registry) {
-  registry->AddKernel("hex.constant.i32", TFRT_KERNEL(HexConstant<int32_t>));
-  registry->AddKernel("hex.constant.i64", TFRT_KERNEL(HexConstant<int64_t>));
-
-  registry->AddKernel("hex.add.i32", TFRT_KERNEL(HexAdd<int32_t>));
-  registry->AddKernel("hex.add.i64", TFRT_KERNEL(HexAdd<int64_t>));
-
-  registry->AddKernel("hex.minus.i32", TFRT_KERNEL(HexMinus<int32_t>));
-  registry->AddKernel("hex.minus.i64", TFRT_KERNEL(HexMinus<int64_t>));
-
-  registry->AddKernel("hex.equal.i32", TFRT_KERNEL(HexEqual<int32_t>));
-  registry->AddKernel("hex.equal.i64", TFRT_KERNEL(HexEqual<int64_t>));
-
-  registry->AddKernel("hex.lessequal.i32", TFRT_KERNEL(HexLessEqual<int32_t>));
-  registry->AddKernel("hex.lessequal.i64", TFRT_KERNEL(HexLessEqual<int64_t>));
-
-  registry->AddKernel("hex.div.i32", TFRT_KERNEL(HexDiv<int32_t>));
-  registry->AddKernel("hex.div.i64", TFRT_KERNEL(HexDiv<int64_t>));
-
-  registry->AddKernel("hex.print.i1", TFRT_KERNEL(HexPrintI1));
-  registry->AddKernel("hex.print.i32", TFRT_KERNEL(HexPrintI32));
-  registry->AddKernel("hex.print.i64", TFRT_KERNEL(HexPrintI64));
-
-  registry->AddKernel("hex.cast.i64_to_f64",
-                      TFRT_KERNEL(HexCast<int64_t, double>));
-  registry->AddKernel("hex.cast.f64_to_i64",
-                      TFRT_KERNEL(HexCast<double, int64_t>));
+  registry->AddSyncKernel("hex.constant.i32",
+                          TFRT_SYNC_KERNEL(HexConstant<int32_t>),
+                          KernelEffect::kPure);
+  registry->AddSyncKernel("hex.constant.i64",
+                          TFRT_SYNC_KERNEL(HexConstant<int64_t>),
+                          KernelEffect::kPure);
+
+  registry->AddSyncKernel("hex.add.i32", TFRT_SYNC_KERNEL(HexAdd<int32_t>),
+                          KernelEffect::kPure);
+  registry->AddSyncKernel("hex.add.i64", TFRT_SYNC_KERNEL(HexAdd<int64_t>),
+                          KernelEffect::kPure);
+
+  registry->AddSyncKernel("hex.minus.i32", TFRT_SYNC_KERNEL(HexMinus<int32_t>),
+                          KernelEffect::kPure);
+  registry->AddSyncKernel("hex.minus.i64", TFRT_SYNC_KERNEL(HexMinus<int64_t>),
+                          KernelEffect::kPure);
+
+  registry->AddSyncKernel("hex.equal.i32", TFRT_SYNC_KERNEL(HexEqual<int32_t>),
+                          KernelEffect::kPure);
+  registry->AddSyncKernel("hex.equal.i64", TFRT_SYNC_KERNEL(HexEqual<int64_t>),
+                          KernelEffect::kPure);
+
+  registry->AddSyncKernel("hex.lessequal.i32",
+                          TFRT_SYNC_KERNEL(HexLessEqual<int32_t>),
+                          KernelEffect::kPure);
+  registry->AddSyncKernel("hex.lessequal.i64",
+                          TFRT_SYNC_KERNEL(HexLessEqual<int64_t>),
+                          KernelEffect::kPure);
+
+  // Division reports divide-by-zero through its result AsyncValue, which is
+  // not a side effect.
+  registry->AddSyncKernel("hex.div.i32", TFRT_KERNEL(HexDiv<int32_t>),
+                          KernelEffect::kPure);
+  registry->AddSyncKernel("hex.div.i64", TFRT_KERNEL(HexDiv<int64_t>),
+                          KernelEffect::kPure);
+
+  registry->AddSyncKernel("hex.print.i1", TFRT_SYNC_KERNEL(HexPrintI1),
+                          KernelEffect::kIO);
+  registry->AddSyncKernel("hex.print.i32", TFRT_SYNC_KERNEL(HexPrintI32),
+                          KernelEffect::kIO);
+  registry->AddSyncKernel("hex.print.i64", TFRT_SYNC_KERNEL(HexPrintI64),
+                          KernelEffect::kIO);
+
+  registry->AddSyncKernel("hex.cast.i64_to_f64",
+                          TFRT_SYNC_KERNEL(HexCast<int64_t, double>),
+                          KernelEffect::kPure);
+  registry->AddSyncKernel("hex.cast.f64_to_i64",
+                          TFRT_SYNC_KERNEL(HexCast<double, int64_t>),
+                          KernelEffect::kPure);
 }
 
 }  // namespace tfrt
@@ -27,6 +27,7 @@
 #include "mlir/IR/Module.h"
 #include "mlir/IR/OpDefinition.h"
 #include "mlir/IR/OpImplementation.h"
+#include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/StandardTypes.h"
 #include "mlir/IR/TypeUtilities.h"
 #include "mlir/Support/LogicalResult.h"
@@ -405,6 +406,79 @@ void print(OpAsmPrinter &p, IfOp op) {
   p.printRegion(op.else_region(), /*printEntryBlockArgs=*/false);
 }
 
+//===----------------------------------------------------------------------===//
+// MergeChainsOp
+//===----------------------------------------------------------------------===//
+
+OpFoldResult MergeChainsOp::fold(ArrayRef<Attribute> operands) {
+  // Merging a single chain is an identity function.
+  if (chains().size() == 1) return chains()[0];
+  return nullptr;
+}
+
+namespace {
+
+// Return true if `type` is !hex.chain.
+bool IsChainType(Type type) {
+  return type == OpaqueType::get(Identifier::get("hex", type.getContext()),
+                                 "chain", type.getContext());
+}
+
+// Return true if the chain produced by `def` provably carries no ordering
+// obligation. Chains order side effects, so a chain produced by an op that
+// has no side effects and takes no chains itself (hex.new.chain, or any
+// side-effect-free op per its declared memory effects) orders nothing:
+// waiting on it only waits for value availability, which dataflow edges
+// already guarantee.
+bool ProducesOrderingFreeChain(Operation *def) {
+  if (isa<NewChainOp>(def)) return true;
+  auto effect_interface = dyn_cast<MemoryEffectOpInterface>(def);
+  if (!effect_interface || !effect_interface.hasNoEffect()) return false;
+  if (def->getNumRegions() != 0) return false;
+  // A chain operand may carry ordering from some effectful producer through
+  // this op, so its presence keeps the result conservative.
+  return llvm::none_of(def->getOperandTypes(), IsChainType);
+}
+
+// Drops merge.chains operands that carry no ordering information: chains
+// produced by side-effect-free ops (which conflict with nothing) and
+// duplicates of other operands. This statically eliminates redundant chain
+// edges so they are never materialized as async values at run time.
+struct SimplifyMergeChains : public OpRewritePattern<MergeChainsOp> {
+  using OpRewritePattern<MergeChainsOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(MergeChainsOp op,
+                                PatternRewriter &rewriter) const override {
+    SmallVector<Value, 4> kept_chains;
+    llvm::SmallDenseSet<Value, 4> seen_chains;
+    for (Value chain : op.chains()) {
+      Operation *def = chain.getDefiningOp();
+      if (def && ProducesOrderingFreeChain(def)) continue;
+      if (!seen_chains.insert(chain).second) continue;
+      kept_chains.push_back(chain);
+    }
+    if (kept_chains.size() == op.chains().size()) return failure();
+
+    if (kept_chains.empty()) {
+      // All inputs were fresh chains; the merge depends on nothing.
+      rewriter.replaceOpWithNewOp<NewChainOp>(op, op.getType());
+      return success();
+    }
+    if (kept_chains.size() == 1) {
+      rewriter.replaceOp(op, kept_chains[0]);
+      return success();
+    }
+    rewriter.replaceOpWithNewOp<MergeChainsOp>(op, op.getType(), kept_chains);
+    return success();
+  }
+};
+}  // namespace
+
+void MergeChainsOp::getCanonicalizationPatterns(
+    OwningRewritePatternList &results, MLIRContext *context) {
+  results.insert<SimplifyMergeChains>(context);
+}
+
 //===----------------------------------------------------------------------===//
 // RepeatI32Op
 //===----------------------------------------------------------------------===//
@@ -33,6 +33,6 @@ static void RegisterKernels(KernelRegistry* registry) {
   RegisterControlFlowKernels(registry);
 }
 
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterKernels);
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterKernels, "hex");
 
 }  // namespace tfrt
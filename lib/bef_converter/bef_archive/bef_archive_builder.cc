@@ -0,0 +1,438 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- bef_archive_builder.cc ---------------------------------------------===//
+//
+// This file implements BEFArchiveBuilder, which packs multiple BEF modules
+// into one BEF archive with a shared, content-deduplicated attribute pool.
+// Each module is rewritten so its kernels reference the pool instead of the
+// module's own (dropped) Attributes section.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/bef_converter/bef_archive_builder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/MathExtras.h"
+#include "tfrt/support/bef_encoding.h"
+#include "tfrt/support/byte_order.h"
+
+namespace tfrt {
+namespace {
+
+// The filler used for alignment padding, matching the BEF emitter.
+constexpr uint8_t kDummyByte = 0xCC;
+
+// A cursor over module bytes that tracks its module-relative offset. The
+// BEF emitter computes alignment padding relative to the start of the file,
+// so the builder must decode with module-relative offsets too (BEFReader
+// aligns on memory addresses instead, which only match once the module is
+// mapped with the guaranteed alignment).
+class ByteCursor {
+ public:
+  explicit ByteCursor(ArrayRef<uint8_t> data) : data_(data) {}
+
+  size_t position() const { return position_; }
+  bool Empty() const { return position_ >= data_.size(); }
+
+  bool ReadByte(uint8_t* value) {
+    if (Empty()) return true;
+    *value = data_[position_++];
+    return false;
+  }
+
+  bool ReadVbrInt(size_t* value) {
+    uint8_t next_byte;
+    if (ReadByte(&next_byte)) return true;
+    *value = (next_byte & 127);
+    while ((next_byte & 128) != 0) {
+      if (ReadByte(&next_byte)) return true;
+      *value = (*value << 7) | size_t(next_byte & 127);
+    }
+    return false;
+  }
+
+  bool ReadUint32(uint32_t* value) {
+    ASSERT_LITTLE_ENDIAN();
+    if (Align(sizeof(uint32_t)) || data_.size() - position_ < sizeof(uint32_t))
+      return true;
+    memcpy(value, data_.data() + position_, sizeof(uint32_t));
+    position_ += sizeof(uint32_t);
+    return false;
+  }
+
+  bool Align(size_t alignment) {
+    while (position_ % alignment) {
+      if (position_ >= data_.size()) return true;
+      ++position_;
+    }
+    return false;
+  }
+
+  bool Skip(size_t count) {
+    if (data_.size() - position_ < count) return true;
+    position_ += count;
+    return false;
+  }
+
+ private:
+  ArrayRef<uint8_t> data_;
+  size_t position_ = 0;
+};
+
+// One section of a module, as located by the initial scan.
+struct Section {
+  uint8_t id;
+  bool has_alignment;
+  uint8_t alignment;
+  ArrayRef<uint8_t> payload;
+};
+
+// A kernel attribute reference: the byte position of the uint32 entry
+// within the Functions section payload, and the attribute offset it holds.
+struct AttributeRef {
+  size_t position;
+  uint32_t offset;
+};
+
+// One entry of the FunctionIndex section (only the fields the builder
+// needs).
+struct FunctionRecord {
+  FunctionKind kind;
+  size_t offset;
+  size_t num_results;
+};
+
+// Emit a VBR encoded integer, high-order bytes first, matching BEFEmitter.
+void EmitVbrInt(size_t value, std::vector<uint8_t>* result) {
+  uint8_t bytes[16];
+  int count = 0;
+  do {
+    bytes[count++] = value & 127;
+    value >>= 7;
+  } while (value != 0);
+  while (count > 1) result->push_back(bytes[--count] | 128);
+  result->push_back(bytes[0]);
+}
+
+bool ScanSections(ArrayRef<uint8_t> module, std::vector<Section>* sections,
+                  uint8_t* format_version) {
+  ByteCursor cursor(module);
+  uint8_t header[2];
+  if (cursor.ReadByte(&header[0]) || cursor.ReadByte(&header[1]) ||
+      header[0] != kBEFMagic1 || header[1] != kBEFMagic2)
+    return false;
+
+  while (!cursor.Empty()) {
+    Section section;
+    size_t length;
+    if (cursor.ReadByte(&section.id) || cursor.ReadVbrInt(&length))
+      return false;
+    section.has_alignment = (length & 1) != 0;
+    length >>= 1;
+    section.alignment = 1;
+    if (section.has_alignment &&
+        (cursor.ReadByte(&section.alignment) ||
+         !llvm::isPowerOf2_32(section.alignment) ||
+         cursor.Align(section.alignment)))
+      return false;
+
+    size_t payload_start = cursor.position();
+    if (cursor.Skip(length)) return false;
+    section.payload = module.slice(payload_start, length);
+
+    if (static_cast<BEFSectionID>(section.id) == BEFSectionID::kFormatVersion)
+      *format_version = section.payload.empty() ? 0 : section.payload.front();
+    sections->push_back(section);
+  }
+  return true;
+}
+
+bool DecodeFunctionIndex(ArrayRef<uint8_t> function_index,
+                         std::vector<FunctionRecord>* records) {
+  ByteCursor cursor(function_index);
+  size_t num_functions;
+  if (cursor.ReadVbrInt(&num_functions)) return false;
+
+  records->reserve(num_functions);
+  while (num_functions--) {
+    FunctionRecord record;
+    uint8_t kind;
+    size_t name_offset, num_args;
+    if (cursor.ReadByte(&kind) || cursor.ReadVbrInt(&record.offset) ||
+        cursor.ReadVbrInt(&name_offset) || cursor.ReadVbrInt(&num_args))
+      return false;
+    record.kind = static_cast<FunctionKind>(kind);
+
+    size_t type_index;
+    while (num_args--)
+      if (cursor.ReadVbrInt(&type_index)) return false;
+    if (cursor.ReadVbrInt(&record.num_results)) return false;
+    for (size_t i = 0; i != record.num_results; ++i)
+      if (cursor.ReadVbrInt(&type_index)) return false;
+    records->push_back(record);
+  }
+  return true;
+}
+
+// Decode one function's header tables and kernel bodies, recording the
+// position and value of every attribute entry its kernels hold. Mirrors
+// BEFFileImpl::DecodeFunctionInfo for both the VBR (version 0) and the
+// fixed-width (version 1) header table encodings.
+bool CollectAttributeRefs(ArrayRef<uint8_t> functions,
+                          const FunctionRecord& record, bool fixed_width,
+                          std::vector<AttributeRef>* refs) {
+  ByteCursor cursor(functions);
+  if (cursor.Skip(record.offset)) return false;
+
+  auto read_table_int = [&](size_t* value) -> bool {
+    if (!fixed_width) return cursor.ReadVbrInt(value);
+    uint32_t fixed_value;
+    if (cursor.ReadUint32(&fixed_value)) return true;
+    *value = fixed_value;
+    return false;
+  };
+
+  size_t location_offset, num_registers, num_kernels;
+  if (read_table_int(&location_offset) || read_table_int(&num_registers))
+    return false;
+  size_t value;
+  for (size_t i = 0; i != num_registers; ++i)
+    if (read_table_int(&value)) return false;
+
+  if (read_table_int(&num_kernels)) return false;
+  std::vector<size_t> kernel_offsets;
+  kernel_offsets.reserve(num_kernels);
+  for (size_t i = 0; i != num_kernels; ++i) {
+    size_t offset, num_operands;
+    if (read_table_int(&offset) || read_table_int(&num_operands))
+      return false;
+    kernel_offsets.push_back(offset);
+  }
+  for (size_t i = 0; i != record.num_results; ++i)
+    if (read_table_int(&value)) return false;
+
+  if (cursor.Align(kKernelEntryAlignment)) return false;
+  size_t kernels_start = cursor.position();
+
+  // Walk each kernel's header to find its attribute entries. The layout is
+  // described in BEFKernel (bef_reader.h): a 28-byte header, a num_used_bys
+  // table with one uint32 per result, then the body entries, which list
+  // arguments first and attribute offsets second.
+  for (size_t kernel_offset : kernel_offsets) {
+    size_t header_start = kernels_start + kernel_offset;
+    auto read_header_field = [&](size_t index, uint32_t* field) -> bool {
+      size_t position = header_start + index * sizeof(uint32_t);
+      if (position + sizeof(uint32_t) > functions.size()) return true;
+      memcpy(field, functions.data() + position, sizeof(uint32_t));
+      return false;
+    };
+    uint32_t num_arguments, num_attributes, num_results;
+    if (read_header_field(2, &num_arguments) ||
+        read_header_field(3, &num_attributes) ||
+        read_header_field(5, &num_results))
+      return false;
+
+    size_t body_start =
+        header_start + 7 * sizeof(uint32_t) + num_results * sizeof(uint32_t);
+    for (size_t i = 0; i != num_attributes; ++i) {
+      AttributeRef ref;
+      ref.position = body_start + (num_arguments + i) * sizeof(uint32_t);
+      if (ref.position + sizeof(uint32_t) > functions.size()) return false;
+      memcpy(&ref.offset, functions.data() + ref.position, sizeof(uint32_t));
+      refs->push_back(ref);
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+size_t BEFArchiveBuilder::InternAttributeSpan(ArrayRef<uint8_t> data,
+                                              size_t phase) {
+  // Key the span on its alignment phase as well as its content: a span can
+  // only be reused at a pool offset congruent to its original offset modulo
+  // kAttributeTensorAlignment, or interior aligned fields would shift.
+  std::string key;
+  key.reserve(data.size() + 1);
+  key.push_back(static_cast<char>(phase));
+  key.append(reinterpret_cast<const char*>(data.data()), data.size());
+
+  auto it = attribute_pool_index_.find(key);
+  if (it != attribute_pool_index_.end()) return it->second;
+
+  while (attribute_pool_.size() % kAttributeTensorAlignment != phase)
+    attribute_pool_.push_back(kDummyByte);
+  size_t offset = attribute_pool_.size();
+  attribute_pool_.insert(attribute_pool_.end(), data.begin(), data.end());
+  attribute_pool_index_[key] = offset;
+  return offset;
+}
+
+bool BEFArchiveBuilder::AddModule(string_view name, ArrayRef<uint8_t> module) {
+  std::vector<Section> sections;
+  uint8_t format_version = 0;
+  if (!ScanSections(module, &sections, &format_version)) return false;
+
+  ArrayRef<uint8_t> attributes, functions, function_index;
+  for (const auto& section : sections) {
+    switch (static_cast<BEFSectionID>(section.id)) {
+      case BEFSectionID::kAttributes:
+        attributes = section.payload;
+        break;
+      case BEFSectionID::kFunctions:
+        functions = section.payload;
+        break;
+      case BEFSectionID::kFunctionIndex:
+        function_index = section.payload;
+        break;
+      default:
+        break;
+    }
+  }
+
+  std::vector<FunctionRecord> records;
+  if (!DecodeFunctionIndex(function_index, &records)) return false;
+
+  std::vector<AttributeRef> refs;
+  for (const auto& record : records) {
+    if (record.kind != FunctionKind::kBEFFunction) continue;
+    if (record.offset >= functions.size() && !functions.empty()) return false;
+    if (!CollectAttributeRefs(functions, record, format_version >= 1, &refs))
+      return false;
+  }
+
+  // Each referenced offset starts a span that extends to the next
+  // referenced offset (attributes are self-contained, so the gap - which
+  // may include alignment padding - covers the whole attribute). Intern
+  // every span into the shared pool.
+  std::vector<size_t> span_starts;
+  span_starts.reserve(refs.size());
+  for (const auto& ref : refs) span_starts.push_back(ref.offset);
+  std::sort(span_starts.begin(), span_starts.end());
+  span_starts.erase(std::unique(span_starts.begin(), span_starts.end()),
+                    span_starts.end());
+
+  llvm::DenseMap<size_t, uint32_t> pooled_offsets;
+  for (size_t i = 0, e = span_starts.size(); i != e; ++i) {
+    size_t start = span_starts[i];
+    size_t end = i + 1 != e ? span_starts[i + 1] : attributes.size();
+    if (end > attributes.size() || start > end) return false;
+    size_t pooled = InternAttributeSpan(attributes.slice(start, end - start),
+                                        start % kAttributeTensorAlignment);
+    if (pooled > std::numeric_limits<uint32_t>::max()) return false;
+    pooled_offsets[start] = static_cast<uint32_t>(pooled);
+  }
+
+  // Re-serialize the module: drop the Attributes section (and the optional
+  // sections whose attribute offsets are now stale) and redirect every
+  // kernel attribute entry into the pool.
+  Module rewritten;
+  rewritten.name = name.str();
+  auto& out = rewritten.bytes;
+  out.push_back(kBEFMagic1);
+  out.push_back(kBEFMagic2);
+  for (const auto& section : sections) {
+    auto id = static_cast<BEFSectionID>(section.id);
+    if (id == BEFSectionID::kAttributes ||
+        id == BEFSectionID::kAttributeTypes ||
+        id == BEFSectionID::kAttributeNames ||
+        id == BEFSectionID::kAlignmentPadding)
+      continue;
+
+    out.push_back(section.id);
+    EmitVbrInt((section.payload.size() << 1) | section.has_alignment, &out);
+    if (section.has_alignment) {
+      out.push_back(section.alignment);
+      while (out.size() % section.alignment) out.push_back(kDummyByte);
+    }
+    size_t payload_start = out.size();
+    out.insert(out.end(), section.payload.begin(), section.payload.end());
+
+    if (id == BEFSectionID::kFunctions) {
+      ASSERT_LITTLE_ENDIAN();
+      for (const auto& ref : refs) {
+        uint32_t pooled = pooled_offsets[ref.offset];
+        memcpy(out.data() + payload_start + ref.position, &pooled,
+               sizeof(uint32_t));
+      }
+    }
+  }
+
+  modules_.push_back(std::move(rewritten));
+  return true;
+}
+
+AlignedBuffer<8> BEFArchiveBuilder::TakeResult() {
+  ASSERT_LITTLE_ENDIAN();
+
+  // Lay out the header, module table and names, then the modules and the
+  // pool, each page aligned.
+  size_t names_offset = kBEFArchiveHeaderSize +
+                        modules_.size() * kBEFArchiveModuleEntrySize;
+  size_t cursor = names_offset;
+  std::vector<size_t> name_offsets, module_offsets;
+  for (const auto& module : modules_) {
+    name_offsets.push_back(cursor);
+    cursor += module.name.size();
+  }
+  for (const auto& module : modules_) {
+    cursor = llvm::alignTo(cursor, kBEFArchivePageAlignment);
+    module_offsets.push_back(cursor);
+    cursor += module.bytes.size();
+  }
+  size_t pool_offset = llvm::alignTo(cursor, kBEFArchivePageAlignment);
+
+  AlignedBuffer<8> result(pool_offset + attribute_pool_.size(), kDummyByte);
+  auto write32 = [&](size_t position, uint32_t value) {
+    memcpy(result.data() + position, &value, sizeof(value));
+  };
+  auto write64 = [&](size_t position, uint64_t value) {
+    memcpy(result.data() + position, &value, sizeof(value));
+  };
+
+  result[0] = kBEFArchiveMagic1;
+  result[1] = kBEFArchiveMagic2;
+  result[2] = kBEFArchiveVersion0;
+  result[3] = 0;
+  write32(4, static_cast<uint32_t>(modules_.size()));
+  write64(8, pool_offset);
+  write64(16, attribute_pool_.size());
+
+  for (size_t i = 0, e = modules_.size(); i != e; ++i) {
+    const auto& module = modules_[i];
+    size_t entry = kBEFArchiveHeaderSize + i * kBEFArchiveModuleEntrySize;
+    write64(entry, module_offsets[i]);
+    write64(entry + 8, module.bytes.size());
+    write64(entry + 16, name_offsets[i]);
+    write64(entry + 24, module.name.size());
+    std::copy(module.name.begin(), module.name.end(),
+              result.begin() + name_offsets[i]);
+    std::copy(module.bytes.begin(), module.bytes.end(),
+              result.begin() + module_offsets[i]);
+  }
+  std::copy(attribute_pool_.begin(), attribute_pool_.end(),
+            result.begin() + pool_offset);
+
+  modules_.clear();
+  attribute_pool_.clear();
+  attribute_pool_index_.clear();
+  return result;
+}
+
+}  // namespace tfrt
@@ -96,6 +96,10 @@ struct BEFFile {
 
   mlir::Location location;
 
+  // True for BEF version 1 files, whose function header tables are stored
+  // as 4-byte aligned fixed-width uint32 entries instead of VBR integers.
+  bool fixed_width_function_tables = false;
+
   SmallVector<string_view, 4> location_filenames;
 
   llvm::DenseMap<size_t, mlir::Location> location_positions;
@@ -367,6 +371,11 @@ class BEFTypedAttributeReader {
       return ReadDenseAttribute(reinterpret_cast<const BEFDenseAttr*>(base));
     }
 
+    if (IsFlatAggregateAttribute(base->type)) {
+      return ReadFlatAggregateAttribute(
+          reinterpret_cast<const BEFFlatAggregateAttr*>(base));
+    }
+
     if (base->type == BEFAttributeType::kAggregate) {
       return ReadAggregateAttribute(
           reinterpret_cast<const BEFAggregateAttr*>(base));
@@ -497,6 +506,29 @@ class BEFTypedAttributeReader {
     return builder_.getArrayAttr(elements);
   }
 
+  // Flat aggregates (see BEFFlatAggregateAttr) store their sub-arrays as one
+  // contiguous scalar payload; rebuild the nested array of arrays from it.
+  mlir::ArrayAttr ReadFlatAggregateAttribute(
+      const BEFFlatAggregateAttr* header) {
+    auto element_type = GetElementAttributeType(header->base.type);
+    size_t scalar_size = GetBEFAttributeSize(element_type);
+
+    const uint8_t* data =
+        reinterpret_cast<const uint8_t*>(header) + header->element_offset;
+
+    SmallVector<mlir::Attribute, 8> elements;
+    elements.reserve(header->num_elements);
+
+    for (size_t i = 0; i != header->num_elements; ++i) {
+      auto scalars = CreateAttrsFromDenseArray(
+          element_type, header->element_size,
+          data + i * header->element_size * scalar_size);
+      elements.push_back(builder_.getArrayAttr(scalars));
+    }
+
+    return builder_.getArrayAttr(elements);
+  }
+
   SmallVector<mlir::Attribute, 8> CreateAttrsFromDenseArray(
       BEFAttributeType element_type, size_t num_elements, const uint8_t* data);
 
@@ -608,6 +640,18 @@ class BEFFunctionReader {
     size_t num_operands;
   };
 
+  // Reads an integer of a function header table, using the encoding recorded
+  // in the format version: VBR for version 0 files, fixed-width uint32 for
+  // version 1 files.
+  bool ReadTableInt(size_t* value) {
+    if (!bef_file_.fixed_width_function_tables)
+      return function_reader_.ReadInt(value);
+    uint32_t fixed_value;
+    if (function_reader_.ReadInt4(&fixed_value)) return true;
+    *value = fixed_value;
+    return false;
+  }
+
   mlir::LogicalResult ReadRegisterTable(BEFReader* register_types);
   mlir::LogicalResult ReadKernelTable();
   mlir::LogicalResult ReadResultRegs();
@@ -688,8 +732,10 @@ mlir::LogicalResult BEFToMLIRConverter::ReadFormatVersion(
   // Read and check the version byte.
   BEFReader format_version_reader(format_version);
   uint8_t version;
-  if (format_version_reader.ReadByte(&version) || version != kBEFVersion0)
+  if (format_version_reader.ReadByte(&version) ||
+      (version != kBEFVersion0 && version != kBEFVersion1))
     return mlir::failure();
+  bef_file_.fixed_width_function_tables = version == kBEFVersion1;
   return mlir::success();
 }
 
@@ -1134,7 +1180,7 @@ BEFFunctionReader::ReadFunction(BEFReader* attribute_names,
 
   // Read function location.
   size_t location_position_offset;
-  if (function_reader_.ReadInt(&location_position_offset))
+  if (ReadTableInt(&location_position_offset))
     return emit_error("Failed to read function location");
   auto location = bef_file_.GetLocationPosition(location_position_offset);
   if (!location) return emit_error("Failed to read function location");
@@ -1174,8 +1220,14 @@ mlir::LogicalResult BEFFunctionReader::ReadRegisterTable(
     reg_type_indices.clear();
 
   std::vector<size_t> reg_uses;
-  if (mlir::failed(ReadIntArray(&function_reader_, &reg_uses)))
-    return mlir::failure();
+  size_t num_registers;
+  if (ReadTableInt(&num_registers)) return mlir::failure();
+  reg_uses.reserve(num_registers);
+  for (size_t i = 0; i != num_registers; ++i) {
+    size_t num_uses;
+    if (ReadTableInt(&num_uses)) return mlir::failure();
+    reg_uses.push_back(num_uses);
+  }
 
   assert(reg_type_indices.empty() ||
          reg_type_indices.size() == reg_uses.size());
@@ -1197,11 +1249,10 @@ mlir::LogicalResult BEFFunctionReader::ReadRegisterTable(
 
 mlir::LogicalResult BEFFunctionReader::ReadKernelTable() {
   size_t num_kernels;
-  if (function_reader_.ReadInt(&num_kernels)) return mlir::failure();
+  if (ReadTableInt(&num_kernels)) return mlir::failure();
   for (int i = 0; i < num_kernels; ++i) {
     KernelTableEntry entry;
-    if (function_reader_.ReadInt(&entry.offset) ||
-        function_reader_.ReadInt(&entry.num_operands))
+    if (ReadTableInt(&entry.offset) || ReadTableInt(&entry.num_operands))
       return mlir::failure();
     kernel_table_.push_back(entry);
   }
@@ -1211,7 +1262,7 @@ mlir::LogicalResult BEFFunctionReader::ReadKernelTable() {
 mlir::LogicalResult BEFFunctionReader::ReadResultRegs() {
   for (int i = 0; i < bef_function_.result_types.size(); ++i) {
     size_t register_index;
-    if (function_reader_.ReadInt(&register_index)) return mlir::failure();
+    if (ReadTableInt(&register_index)) return mlir::failure();
     result_regs_.push_back(register_index);
   }
   return mlir::success();
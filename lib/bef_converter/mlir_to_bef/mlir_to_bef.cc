@@ -28,12 +28,16 @@
 #include "tfrt/bef_converter/mlir_to_bef.h"
 
 #include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
 
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Block.h"
@@ -723,6 +727,8 @@ class BEFEmitter {
 
   size_t size() const { return result_.size(); }
 
+  llvm::ArrayRef<uint8_t> result() const { return result_; }
+
   void EmitByte(uint8_t byte) { result_.push_back(byte); }
 
   void EmitBytes(llvm::ArrayRef<uint8_t> bytes) {
@@ -785,6 +791,11 @@ class BEFEmitter {
 
   // Emit a vbr encoded integer of arbitrary width.
   void EmitInt(size_t value) { EmitIntImpl(value, false); }
+
+  // Return the number of bytes EmitInt uses to encode the specified value.
+  static size_t GetSizeOfVbrInt(size_t value) {
+    return value < 0x80 ? 1 : GetSizeOfVbrInt(value >> 7) + 1;
+  }
   // Emit a vbr encoded integer with low byte first
   void EmitIntLowByteFirst(size_t value) {
     EmitBEFArrayLength(value, &result_);
@@ -831,6 +842,49 @@ class BEFEmitter {
     EmitSection(section_id, emitter.result_, emitter.GetRequiredAlignment());
   }
 
+  // Emit a section whose payload starts on a page boundary in the file, so
+  // that a memory mapped BEF file exposes the payload page aligned and pages
+  // of it that are never touched are never read from disk. Page alignment
+  // cannot be expressed through the one-byte alignment field in the section
+  // header, so it is achieved by first emitting a kAlignmentPadding section -
+  // which readers skip - sized to land the payload on the boundary. Only
+  // meaningful on the top-level module emitter, whose buffer starts at file
+  // offset zero.
+  void EmitSectionPageAligned(BEFSectionID section_id,
+                              const BEFEmitter& emitter) {
+    constexpr size_t kPageAlignment = 4096;
+    assert(kPageAlignment % emitter.GetRequiredAlignment() == 0 &&
+           "page alignment must subsume the payload's alignment");
+
+    size_t section_length = emitter.result_.size();
+
+    // The section's header is the id byte plus the VBR length. The alignment
+    // bit is clear: the payload is page aligned by construction, which
+    // subsumes its own alignment requirement.
+    size_t header_size = 1 + GetSizeOfVbrInt(section_length << 1);
+
+    if ((size() + header_size) % kPageAlignment != 0) {
+      // Find the padding payload size that makes the section's payload land
+      // on a page boundary. The padding section's own header size depends on
+      // the padding size, so search rather than solve; the loop runs at most
+      // one page worth of iterations.
+      size_t pad = 0;
+      while ((size() + 1 + GetSizeOfVbrInt(pad << 1) + pad + header_size) %
+                 kPageAlignment !=
+             0)
+        ++pad;
+
+      EmitByte(static_cast<uint8_t>(BEFSectionID::kAlignmentPadding));
+      EmitInt(pad << 1);
+      while (pad--) EmitByte(kDummyByte);
+    }
+
+    EmitByte(static_cast<uint8_t>(section_id));
+    EmitInt(section_length << 1);
+    assert(size() % kPageAlignment == 0 && "section payload is not aligned");
+    EmitBytes(emitter.result_);
+  }
+
   std::vector<uint8_t> TakeResult() { return std::move(result_); }
 
   // Move size bytes in the result from src_offset to dst_offset.
@@ -873,7 +927,9 @@ void BEFEmitter::EmitIntImpl(size_t value, bool is_high_part) {
 // This is the emitter that builds a BEF into an std::vector.
 class BEFModuleEmitter : public BEFEmitter {
  public:
-  explicit BEFModuleEmitter(mlir::ModuleOp module) : module_(module) {}
+  BEFModuleEmitter(mlir::ModuleOp module, bool fixed_width_function_tables)
+      : module_(module),
+        fixed_width_function_tables_(fixed_width_function_tables) {}
 
   LogicalResult CollectEntities(bool collect_attribute_types_and_names) {
     return entities_.Collect(module_, collect_attribute_types_and_names);
@@ -893,12 +949,16 @@ class BEFModuleEmitter : public BEFEmitter {
 
  private:
   mlir::ModuleOp module_;
+  // See ConvertMLIRToBEF: emit the function header tables as fixed-width
+  // uint32 entries (a BEF version 1 file) instead of VBR integers.
+  bool fixed_width_function_tables_;
   EntityTable entities_;
   EntityIndex entity_index_;
 };
 
 void BEFModuleEmitter::EmitFormatVersion() {
-  uint8_t version = kBEFVersion0;
+  uint8_t version =
+      fixed_width_function_tables_ ? kBEFVersion1 : kBEFVersion0;
   EmitSection(BEFSectionID::kFormatVersion, version);
 }
 
@@ -1065,6 +1125,31 @@ void BEFAttributeEmitter::EmitArrayAttribute(mlir::ArrayAttr array_attr) {
   for (auto elt : array_attr) EmitAttribute(elt);
 }
 
+// If `aggregate_attr` is a homogeneous aggregate - every element an equally
+// sized, non-empty array of the same fixed-width scalar type - returns the
+// scalar type, so it can use the flattened encoding (BEFFlatAggregateAttr).
+// Returns kUnsupported otherwise.
+static BEFAttributeType GetFlatAggregateElementType(
+    mlir::ArrayAttr aggregate_attr) {
+  if (aggregate_attr.size() == 0) return BEFAttributeType::kUnsupported;
+
+  auto first = aggregate_attr[0].dyn_cast<mlir::ArrayAttr>();
+  if (!first || first.size() == 0) return BEFAttributeType::kUnsupported;
+  auto first_type = GetBEFAttributeType(first);
+  if (!IsArrayAttribute(first_type)) return BEFAttributeType::kUnsupported;
+
+  auto element_type = GetElementAttributeType(first_type);
+  if (!IsDataTypeAttribute(element_type)) return BEFAttributeType::kUnsupported;
+
+  for (auto element : aggregate_attr) {
+    auto array = element.dyn_cast<mlir::ArrayAttr>();
+    if (!array || array.size() != first.size() ||
+        GetBEFAttributeType(array) != first_type)
+      return BEFAttributeType::kUnsupported;
+  }
+  return element_type;
+}
+
 // This emits typed attributes that have BEFAttrBase as head.
 //
 // TODO(chky): Factor out this class to a standalone library as this should be
@@ -1080,6 +1165,8 @@ class BEFTypedAttributeEmitter : public BEFEmitter {
 
  private:
   void EmitAggregateAttribute(mlir::ArrayAttr aggregate_attr);
+  void EmitFlatAggregateAttribute(mlir::ArrayAttr aggregate_attr,
+                                  BEFAttributeType element_type);
   void EmitArrayAttribute(mlir::ArrayAttr array_attr);
   void EmitDenseElementsAttribute(mlir::DenseElementsAttr dense_elements_attr);
   void EmitShapeAttribute(tfrt::corert::ShapeAttr shape_attr);
@@ -1089,7 +1176,16 @@ void BEFTypedAttributeEmitter::EmitAttribute(mlir::Attribute attr) {
   auto attribute_type = GetBEFAttributeType(attr);
 
   if (attribute_type == BEFAttributeType::kAggregate) {
-    EmitAggregateAttribute(attr.cast<mlir::ArrayAttr>());
+    auto aggregate_attr = attr.cast<mlir::ArrayAttr>();
+    // Homogeneous aggregates (e.g. strides, paddings) get the flattened
+    // encoding: one header plus a contiguous typed payload, so readers cast
+    // a pointer instead of walking per-element offsets.
+    auto element_type = GetFlatAggregateElementType(aggregate_attr);
+    if (element_type != BEFAttributeType::kUnsupported) {
+      EmitFlatAggregateAttribute(aggregate_attr, element_type);
+    } else {
+      EmitAggregateAttribute(aggregate_attr);
+    }
     return;
   }
 
@@ -1165,6 +1261,33 @@ void BEFTypedAttributeEmitter::EmitAggregateAttribute(
                  sizeof(uint16_t) * offsets.size());
 }
 
+void BEFTypedAttributeEmitter::EmitFlatAggregateAttribute(
+    mlir::ArrayAttr aggregate_attr, BEFAttributeType element_type) {
+  size_t start_offset = size();
+
+  BEFFlatAggregateAttr header;
+  header.base.type = GetFlatAggregateAttributeType(element_type);
+  header.num_elements = AssertAttrFieldSize(aggregate_attr.size());
+  header.element_size =
+      AssertAttrFieldSize(aggregate_attr[0].cast<mlir::ArrayAttr>().size());
+
+  // Reserve space for header.
+  for (int i = 0; i < sizeof(header); ++i) EmitBytes(kDummyByte);
+
+  // The sub-arrays are all arrays of the same fixed-width scalar type, so
+  // emitting them back to back forms one contiguous scalar array.
+  BEFAttributeEmitter elements;
+  for (auto element : aggregate_attr)
+    elements.EmitArrayAttribute(element.cast<mlir::ArrayAttr>());
+
+  EmitAlignment(elements.GetRequiredAlignment());
+  header.element_offset = AssertAttrFieldSize(size() - start_offset);
+  EmitEmitter(elements);
+  header.base.byte_count = AssertAttrFieldSize(size() - start_offset);
+
+  OverwriteBytes(start_offset, &header, sizeof(header));
+}
+
 void BEFTypedAttributeEmitter::EmitArrayAttribute(mlir::ArrayAttr array_attr) {
   size_t start_offset = size();
 
@@ -1215,7 +1338,11 @@ void BEFTypedAttributeEmitter::EmitDenseElementsAttribute(
     elements.EmitAttribute(attr);
   }
 
-  EmitAlignment(elements.GetRequiredAlignment());
+  // Align the element payload so DenseHostTensors can alias it in place:
+  // kAttributeTensorAlignment meets the host alignment requirement of every
+  // dtype.
+  EmitAlignment(std::max<unsigned>(elements.GetRequiredAlignment(),
+                                   kAttributeTensorAlignment));
   header.element_offset = AssertAttrFieldSize(size() - start_offset);
   EmitEmitter(elements);
   header.base.byte_count = AssertAttrFieldSize(size() - start_offset);
@@ -1269,9 +1396,33 @@ class BEFAttributesEmitter : public BEFEmitter {
     attribute_type_emitter_.EmitInt(attr_tag.data);
   }
 
+  // Build the interning key for an encoded attribute payload. Two attributes
+  // may share one offset only if their payload bytes, alignment, attribute
+  // type and length prefix all match, since consumers decode all of these
+  // from the shared offset.
+  static std::string InternKey(const BEFEmitter& payload,
+                               BEFAttributeType attribute_type, bool typed,
+                               bool has_length_prefix, size_t prefix_len) {
+    std::string key;
+    llvm::raw_string_ostream os(key);
+    os << (typed ? 'T' : 'U') << static_cast<unsigned>(attribute_type) << ':'
+       << payload.GetRequiredAlignment() << ':'
+       << (has_length_prefix ? 'L' : 'N') << prefix_len << ':';
+    os.write(reinterpret_cast<const char*>(payload.result().data()),
+             payload.result().size());
+    os.flush();
+    return key;
+  }
+
   EntityIndex& entity_index_;
   BEFEmitter& attribute_type_emitter_;
 
+  // Content-hashed interning of emitted attribute payloads: identical
+  // payloads share one offset in the attribute section, so a file that
+  // repeats the same shape or dense attribute across many functions pays
+  // for it once.
+  llvm::StringMap<size_t> interned_attribute_offsets_;
+
   int num_attributes_ = 0;
 };
 
@@ -1292,9 +1443,18 @@ void BEFAttributesEmitter::EmitAttribute(mlir::Attribute attr, bool typed) {
     BEFTypedAttributeEmitter attribute_emitter;
     attribute_emitter.EmitAttribute(attr);
 
-    EmitAlignment(attribute_emitter.GetRequiredAlignment());
-    offset = size();
-    EmitEmitter(attribute_emitter);
+    std::string intern_key = InternKey(attribute_emitter, attribute_type,
+                                       typed, /*has_length_prefix=*/false,
+                                       /*prefix_len=*/0);
+    auto interned = interned_attribute_offsets_.find(intern_key);
+    if (interned != interned_attribute_offsets_.end()) {
+      offset = interned->second;
+    } else {
+      EmitAlignment(attribute_emitter.GetRequiredAlignment());
+      offset = size();
+      EmitEmitter(attribute_emitter);
+      interned_attribute_offsets_[intern_key] = offset;
+    }
 
     if (typed)
       entity_index_.AddTypedAttributeOffset(attr, offset);
@@ -1318,30 +1478,48 @@ void BEFAttributesEmitter::EmitAttribute(mlir::Attribute attr, bool typed) {
         len = attr.cast<mlir::StringAttr>().getValue().size();
       }
 
-      size_t size_start = size();
-      // Emit the number of elements first and then emit all of the attributes
-      // consecutively, returning the offset of the first element in the
-      // attribute array.
-      EmitIntLowByteFirst(len);
-      size_t size_end = size();
-
-      EmitAlignment(attribute_emitter.GetRequiredAlignment());
-      offset = size();
-      EmitEmitter(attribute_emitter);
-
-      // If there is a gap between the size and the first attribute value, we
-      // move the size to be immediately before the first attribute value to
-      // remove the gap.
-      if (size_end < offset) {
-        MoveResult(offset - (size_end - size_start), size_start,
-                   size_end - size_start);
-        // Set the unused bytes to the dummy byte
-        SetResult(size_start, kDummyByte, offset - size_end);
+      std::string intern_key = InternKey(attribute_emitter, attribute_type,
+                                         typed, /*has_length_prefix=*/true,
+                                         len);
+      auto interned = interned_attribute_offsets_.find(intern_key);
+      if (interned != interned_attribute_offsets_.end()) {
+        offset = interned->second;
+      } else {
+        size_t size_start = size();
+        // Emit the number of elements first and then emit all of the
+        // attributes consecutively, returning the offset of the first element
+        // in the attribute array.
+        EmitIntLowByteFirst(len);
+        size_t size_end = size();
+
+        EmitAlignment(attribute_emitter.GetRequiredAlignment());
+        offset = size();
+        EmitEmitter(attribute_emitter);
+
+        // If there is a gap between the size and the first attribute value,
+        // we move the size to be immediately before the first attribute value
+        // to remove the gap.
+        if (size_end < offset) {
+          MoveResult(offset - (size_end - size_start), size_start,
+                     size_end - size_start);
+          // Set the unused bytes to the dummy byte
+          SetResult(size_start, kDummyByte, offset - size_end);
+        }
+        interned_attribute_offsets_[intern_key] = offset;
       }
     } else {
-      EmitAlignment(attribute_emitter.GetRequiredAlignment());
-      offset = size();
-      EmitEmitter(attribute_emitter);
+      std::string intern_key = InternKey(attribute_emitter, attribute_type,
+                                         typed, /*has_length_prefix=*/false,
+                                         /*prefix_len=*/0);
+      auto interned = interned_attribute_offsets_.find(intern_key);
+      if (interned != interned_attribute_offsets_.end()) {
+        offset = interned->second;
+      } else {
+        EmitAlignment(attribute_emitter.GetRequiredAlignment());
+        offset = size();
+        EmitEmitter(attribute_emitter);
+        interned_attribute_offsets_[intern_key] = offset;
+      }
     }
     entity_index_.AddAttributeOffset(attr, offset);
   }
@@ -1369,7 +1547,11 @@ void BEFModuleEmitter::EmitAttributes(BEFEmitter* attribute_types) {
   attribute_types->EmitInt(attributes_section.GetNumAttributes());
   attribute_types->EmitEmitter(attribute_type_emitter);
 
-  EmitSection(BEFSectionID::kAttributes, attributes_section);
+  // The attributes section dominates the size of constant-heavy BEF files
+  // and is read sparsely, so page-align its payload: a memory mapped file
+  // then serves attribute data in place, and unreferenced constants are
+  // never paged in.
+  EmitSectionPageAligned(BEFSectionID::kAttributes, attributes_section);
 }
 
 void BEFModuleEmitter::EmitKernels() {
@@ -1411,8 +1593,11 @@ void BEFModuleEmitter::EmitTypes() {
 class BEFFunctionEmitter : public BEFEmitter {
  public:
   BEFFunctionEmitter(const EntityTable& entities,
-                     const EntityIndex& entity_index)
-      : entities_(entities), entity_index_(entity_index) {}
+                     const EntityIndex& entity_index,
+                     bool fixed_width_tables)
+      : entities_(entities),
+        entity_index_(entity_index),
+        fixed_width_tables_(fixed_width_tables) {}
 
   void EmitFunction(mlir::Region* region, BEFEmitter* attribute_names,
                     BEFEmitter* register_types);
@@ -1431,6 +1616,20 @@ class BEFFunctionEmitter : public BEFEmitter {
     return it->second;
   }
 
+  // Emit an integer of a function header table into `emitter`, using the
+  // encoding selected for this file: VBR for version 0 files, fixed-width
+  // uint32 for version 1 files.
+  void EmitTableInt(BEFEmitter* emitter, size_t value) const {
+    if (fixed_width_tables_) {
+      assert(value <= std::numeric_limits<uint32_t>::max());
+      emitter->EmitInt4(static_cast<uint32_t>(value));
+    } else {
+      emitter->EmitInt(value);
+    }
+  }
+
+  bool fixed_width_tables_;
+
   llvm::DenseMap<mlir::Value, unsigned> register_number_;
   llvm::DenseMap<mlir::Operation*, unsigned> kernel_index_;
 
@@ -1446,7 +1645,7 @@ void BEFFunctionEmitter::EmitFunction(mlir::Region* region,
 
   auto location_offset =
       entity_index_.GetLocationPositionOffset(region->getLoc(), entities_);
-  EmitInt(location_offset);
+  EmitTableInt(this, location_offset);
 
   // Emit the register table.
   EmitRegisterTable(&block, register_types);
@@ -1464,7 +1663,7 @@ void BEFFunctionEmitter::EmitFunction(mlir::Region* region,
 
   // Emit a count of kernels, then the offset of each kernel (from the
   // start of the kernel list) then each kernel is emitted in turn.
-  EmitInt(num_kernels);
+  EmitTableInt(this, num_kernels);
 
   mlir::Operation* return_op = nullptr;
 
@@ -1476,9 +1675,9 @@ void BEFFunctionEmitter::EmitFunction(mlir::Region* region,
   // registers on entry to the function.
   if (block.getNumArguments() != 0) {
     // Offset of the kernel in the list.
-    EmitInt(kernel_list.size());
+    EmitTableInt(this, kernel_list.size());
     // Pseudo has zero operands that need to be available.
-    EmitInt(0);
+    EmitTableInt(this, 0);
 
     EmitArgumentsPseudoOp(&block, &kernel_list);
 
@@ -1502,7 +1701,7 @@ void BEFFunctionEmitter::EmitFunction(mlir::Region* region,
       }
 
     // Offset of the kernel in the list.
-    EmitInt(kernel_list.size());
+    EmitTableInt(this, kernel_list.size());
     // Number of operands that need to be available before it is ready to go.
     auto num_operands_before_running = op.getNumOperands();
 
@@ -1512,7 +1711,7 @@ void BEFFunctionEmitter::EmitFunction(mlir::Region* region,
     if (is_non_strict && num_operands_before_running)
       num_operands_before_running = 1;
 
-    EmitInt(num_operands_before_running);
+    EmitTableInt(this, num_operands_before_running);
 
     if (is_non_strict) {
       attribute_names->EmitByte(
@@ -1528,7 +1727,7 @@ void BEFFunctionEmitter::EmitFunction(mlir::Region* region,
   // Emit the result registers list at the end of the KERNEL_TABLE if present.
   if (return_op) {
     for (auto operand : return_op->getOperands())
-      EmitInt(GetRegisterNumber(operand));
+      EmitTableInt(this, GetRegisterNumber(operand));
   }
 
   // Once we're done, we can emit the kernel data after the kernel index
@@ -1547,7 +1746,7 @@ void BEFFunctionEmitter::EmitRegisterTable(mlir::Block* block,
 
   auto emit_register = [&](mlir::Value reg) {
     // Then the use-count.
-    reg_table.EmitInt(std::distance(reg.use_begin(), reg.use_end()));
+    EmitTableInt(&reg_table, std::distance(reg.use_begin(), reg.use_end()));
 
     // Emit the type index into register types section.
     reg_type_table.EmitInt(entities_.GetTypeIndex(reg.getType()));
@@ -1561,7 +1760,7 @@ void BEFFunctionEmitter::EmitRegisterTable(mlir::Block* block,
     for (auto result : op.getResults()) emit_register(result);
 
   // Emit the number of registers, then the register table.
-  EmitInt(num_registers);
+  EmitTableInt(this, num_registers);
   EmitEmitter(reg_table);
 
   // Emit the number of registers, then the register type table in register
@@ -1703,17 +1902,61 @@ void BEFFunctionEmitter::EmitKernel(mlir::Operation* op,
 
 void BEFModuleEmitter::EmitFunctions(BEFEmitter* attribute_names,
                                      BEFEmitter* register_types) {
-  BEFFunctionEmitter functions_section(entities_, entity_index_);
-
   attribute_names->EmitInt(entities_.functions.size());
   register_types->EmitInt(entities_.functions.size());
+
+  // Function bodies only perform const lookups into the entity tables and
+  // the already-planned string/attribute indices, so they can be emitted
+  // independently. Emit each one into its own set of emitters in parallel,
+  // then concatenate the results in index order, which both keeps the
+  // output deterministic and gives a near-linear speedup on the function
+  // count for large modules.
+  struct FunctionEmission {
+    FunctionEmission(const EntityTable& entities,
+                     const EntityIndex& entity_index, bool fixed_width_tables)
+        : body(entities, entity_index, fixed_width_tables) {}
+
+    BEFFunctionEmitter body;
+    BEFEmitter attribute_names;
+    BEFEmitter register_types;
+  };
+
+  std::vector<std::unique_ptr<FunctionEmission>> emissions;
+  emissions.reserve(entities_.functions.size());
   for (auto function_entry : entities_.functions) {
+    // Native functions have no body.
+    emissions.push_back(function_entry.IsNative()
+                            ? nullptr
+                            : std::make_unique<FunctionEmission>(
+                                  entities_, entity_index_,
+                                  fixed_width_function_tables_));
+  }
+
+  llvm::parallelForEachN(0, emissions.size(), [&](size_t i) {
+    if (!emissions[i]) return;
+    emissions[i]->body.EmitFunction(entities_.functions[i].region,
+                                    &emissions[i]->attribute_names,
+                                    &emissions[i]->register_types);
+  });
+
+  BEFEmitter functions_section;
+  for (size_t i = 0, e = emissions.size(); i != e; ++i) {
+    const auto& function_entry = entities_.functions[i];
+    // Pad to the body's alignment first so the recorded offset is the
+    // aligned start of the body: the per-function emitter computed its
+    // internal padding relative to offset zero.
+    if (emissions[i])
+      functions_section.EmitAlignment(
+          emissions[i]->body.GetRequiredAlignment());
+
     // Remember that we emitted this region to this offset.
     entity_index_.AddFunction(function_entry.name, functions_section.size(),
                               function_entry.type, function_entry.kind);
-    if (!function_entry.IsNative()) {
-      functions_section.EmitFunction(function_entry.region, attribute_names,
-                                     register_types);
+
+    if (emissions[i]) {
+      functions_section.EmitEmitter(emissions[i]->body);
+      attribute_names->EmitEmitter(emissions[i]->attribute_names);
+      register_types->EmitEmitter(emissions[i]->register_types);
     }
   }
 
@@ -1766,8 +2009,9 @@ void BEFModuleEmitter::EmitRegisterTypes(const BEFEmitter& register_types) {
 // On error, this emits the error message through the MLIR error handler, and
 // returns an empty std:vector.
 std::vector<uint8_t> ConvertMLIRToBEF(mlir::ModuleOp module,
-                                      bool disable_optional_sections) {
-  BEFModuleEmitter emitter(module);
+                                      bool disable_optional_sections,
+                                      bool fixed_width_function_tables) {
+  BEFModuleEmitter emitter(module, fixed_width_function_tables);
 
   // Build the entities table.
   if (emitter.CollectEntities(!disable_optional_sections) ==
@@ -30,13 +30,20 @@ static llvm::cl::opt<bool> disable_optional_sections(  // NOLINT
                    "types and attribute names."),
     llvm::cl::init(false));
 
+static llvm::cl::opt<bool> fixed_width_function_tables(  // NOLINT
+    "fixed-width-function-tables",
+    llvm::cl::desc("Emit function header tables as fixed-width uint32 "
+                   "entries (BEF version 1) instead of VBR integers, "
+                   "trading file size for faster loading."),
+    llvm::cl::init(false));
+
 namespace tfrt {
 namespace {
 
 mlir::LogicalResult ConvertMLIRToBEFTranslation(mlir::ModuleOp module,
                                                 llvm::raw_ostream& output) {
-  std::vector<uint8_t> bef_file =
-      tfrt::ConvertMLIRToBEF(module, disable_optional_sections);
+  std::vector<uint8_t> bef_file = tfrt::ConvertMLIRToBEF(
+      module, disable_optional_sections, fixed_width_function_tables);
   if (bef_file.empty()) return mlir::failure();
 
   // Success!
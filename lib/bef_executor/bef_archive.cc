@@ -0,0 +1,155 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- bef_archive.cc - Loader for multi-module BEF archives --------------===//
+//
+// This file implements BEFArchive, which opens a BEF archive and serves its
+// modules as BEFFiles whose attribute references resolve into the archive's
+// shared, content-deduplicated attribute pool.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/bef_executor/bef_archive.h"
+
+#include <cstring>
+#include <string>
+
+#include "bef_file_impl.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "tfrt/host_context/location.h"
+#include "tfrt/support/bef_encoding.h"
+#include "tfrt/support/byte_order.h"
+
+namespace tfrt {
+
+BEFArchive::~BEFArchive() {}
+
+RCReference<BEFArchive> BEFArchive::Open(ArrayRef<uint8_t> archive,
+                                         BEFFile::ErrorHandler error_handler) {
+  auto format_error = [&]() -> RCReference<BEFArchive> {
+    error_handler(DecodedDiagnostic("invalid BEF archive"));
+    return {};
+  };
+
+  ASSERT_LITTLE_ENDIAN();
+  if (archive.size() < kBEFArchiveHeaderSize ||
+      archive[0] != kBEFArchiveMagic1 || archive[1] != kBEFArchiveMagic2 ||
+      archive[2] != kBEFArchiveVersion0)
+    return format_error();
+
+  auto read32 = [&](size_t position) {
+    uint32_t value;
+    memcpy(&value, archive.data() + position, sizeof(value));
+    return value;
+  };
+  auto read64 = [&](size_t position) {
+    uint64_t value;
+    memcpy(&value, archive.data() + position, sizeof(value));
+    return value;
+  };
+
+  size_t num_modules = read32(4);
+  uint64_t pool_offset = read64(8);
+  uint64_t pool_size = read64(16);
+  size_t table_end =
+      kBEFArchiveHeaderSize + num_modules * kBEFArchiveModuleEntrySize;
+  if (table_end > archive.size() || pool_offset > archive.size() ||
+      pool_size > archive.size() - pool_offset)
+    return format_error();
+
+  auto archive_rc = TakeRef(new BEFArchive());
+  archive_rc->attribute_pool_ = archive.slice(pool_offset, pool_size);
+
+  for (size_t i = 0; i != num_modules; ++i) {
+    size_t entry = kBEFArchiveHeaderSize + i * kBEFArchiveModuleEntrySize;
+    uint64_t module_offset = read64(entry);
+    uint64_t module_size = read64(entry + 8);
+    uint64_t name_offset = read64(entry + 16);
+    uint64_t name_size = read64(entry + 24);
+    if (module_offset > archive.size() ||
+        module_size > archive.size() - module_offset ||
+        name_offset > archive.size() ||
+        name_size > archive.size() - name_offset)
+      return format_error();
+
+    ModuleRecord record;
+    record.name = string_view(
+        reinterpret_cast<const char*>(archive.data() + name_offset),
+        name_size);
+    record.bytes = archive.slice(module_offset, module_size);
+    archive_rc->modules_.push_back(record);
+  }
+  return archive_rc;
+}
+
+RCReference<BEFArchive> BEFArchive::OpenFromFile(
+    string_view path, BEFFile::ErrorHandler error_handler) {
+  auto buffer_or_error = llvm::MemoryBuffer::getFile(
+      path, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+  if (!buffer_or_error) {
+    std::string message = "cannot open BEF archive '" + path.str() +
+                          "': " + buffer_or_error.getError().message();
+    error_handler(DecodedDiagnostic(message));
+    return {};
+  }
+
+  auto buffer = std::move(*buffer_or_error);
+  auto archive = Open(llvm::makeArrayRef(
+                          reinterpret_cast<const uint8_t*>(
+                              buffer->getBufferStart()),
+                          buffer->getBufferSize()),
+                      std::move(error_handler));
+  if (!archive) return archive;
+
+  archive->file_buffer_ = std::move(buffer);
+  return archive;
+}
+
+void BEFArchive::GetModuleList(SmallVectorImpl<string_view>* result) const {
+  result->reserve(result->size() + modules_.size());
+  for (const auto& record : modules_) result->push_back(record.name);
+}
+
+RCReference<BEFFile> BEFArchive::OpenModule(string_view name,
+                                            KernelRegistry* registry,
+                                            BEFFile::ErrorHandler error_handler,
+                                            HostAllocator* host_allocator,
+                                            BEFFile::LoadMode load_mode) {
+  const ModuleRecord* record = nullptr;
+  for (const auto& module : modules_)
+    if (module.name == name) {
+      record = &module;
+      break;
+    }
+  if (!record) {
+    error_handler(DecodedDiagnostic("module '" + name.str() +
+                                    "' not found in BEF archive"));
+    return {};
+  }
+
+  auto file = BEFFile::Open(record->bytes, registry, std::move(error_handler),
+                            host_allocator, load_mode);
+  if (!file) return file;
+
+  // Archived modules have no Attributes section of their own: their kernels
+  // reference the shared pool, which we patch in here. The file also keeps
+  // the archive alive, since every section it decoded aliases the archive's
+  // bytes.
+  auto* bef_impl = static_cast<BEFFileImpl*>(file.get());
+  bef_impl->attribute_section_ = attribute_pool_;
+  bef_impl->archive_ = FormRef(this);
+  return file;
+}
+
+}  // namespace tfrt
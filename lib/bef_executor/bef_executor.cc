@@ -18,20 +18,30 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <atomic>
 #include <cstdio>
+#include <memory>
 
 #include "bef_file_impl.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
+#include "tfrt/bef_executor/critical_path_analysis.h"
 #include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/async_value_profiler.h"
 #include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/execution_context.h"
 #include "tfrt/host_context/host_context.h"
 #include "tfrt/host_context/kernel_frame.h"
 #include "tfrt/host_context/location.h"
 #include "tfrt/support/bef_encoding.h"
 #include "tfrt/support/bef_reader.h"
+#include "tfrt/support/mutex.h"
 #include "tfrt/support/ref_count.h"
+#include "tfrt/support/thread_annotations.h"
+#include "tfrt/tracing/kernel_cycle_tracing.h"
+#include "tfrt/tracing/kernel_latency_stats.h"
+#include "tfrt/tracing/kernel_sampling_profiler.h"
 #include "tfrt/tracing/tracing.h"
 
 #ifdef DEBUG_BEF_EXECUTOR
@@ -49,11 +59,23 @@ namespace tfrt {
 namespace {
 
 AsyncValue* GetRegisterValue(const BEFFileImpl::RegisterInfo& reg) {
-  return reg.value.load(std::memory_order_acquire);
+  // Thread-local registers are written before their consumers are enqueued,
+  // so the executor's scheduling synchronization already orders this load
+  // (see RegisterInfo::is_shared).
+  return reg.value.load(reg.is_shared ? std::memory_order_acquire
+                                      : std::memory_order_relaxed);
 }
 
 AsyncValue* GetOrCreateRegisterValue(BEFFileImpl::RegisterInfo* reg,
                                      HostContext* host) {
+  // Thread-local registers are always written before their consumers run, so
+  // the value must be present and no IndirectAsyncValue is ever needed.
+  if (!reg->is_shared) {
+    AsyncValue* value = reg->value.load(std::memory_order_relaxed);
+    assert(value && "Thread-local register was read before it was set");
+    return value;
+  }
+
   // In the normal case, just load the pointer and return it.
   AsyncValue* value = reg->value.load(std::memory_order_acquire);
   if (value) return value;
@@ -106,11 +128,40 @@ void SetKernelsWithErrorInputReady(
   }
 }
 
+// Sentinel stored into KernelInfo::arguments_not_ready to claim a kernel for
+// the error sweep (see BEFExecutor::PropagateError). It is negative so that
+// neither concurrent decrements nor the accelerate-to-one loop in
+// SetKernelsWithErrorInputReady (which only touches counts above one) can
+// ever bring a claimed count back to the dispatch threshold.
+constexpr int kErrorSweepClaimed = -(1 << 30);
+
+// Claim `kernel_info` for the error sweep. Returns true if this call claimed
+// the kernel; false if it was already claimed - by a normal dispatch (its
+// ready count reached zero) or by a concurrent sweep.
+bool ClaimKernelForErrorSweep(BEFFileImpl::KernelInfo& kernel_info) {
+  return kernel_info.arguments_not_ready.exchange(
+             kErrorSweepClaimed, std::memory_order_acq_rel) > 0;
+}
+
 AsyncValue* SetRegisterValue(BEFFileImpl::RegisterInfo* reg,
                              AsyncValue* new_value,
                              bool* register_already_set) {
   assert(reg->user_count > 0 &&
          "No need to set register value if it is not being used by anyone.");
+
+  // Thread-local registers cannot have been observed by a consumer yet, so
+  // the cell is written with a plain store: there is no IndirectAsyncValue
+  // to forward to and no compare-and-swap to lose.
+  if (!reg->is_shared) {
+    assert(reg->value.load(std::memory_order_relaxed) == nullptr &&
+           "Thread-local register was set twice");
+    // Add user_count refs to new_value, as in the shared path below.
+    new_value->AddRef(reg->user_count - 1);
+    reg->value.store(new_value, std::memory_order_relaxed);
+    *register_already_set = false;
+    return new_value;
+  }
+
   // Atomically set reg->value to new_value.
   AsyncValue* existing = nullptr;
   // Speculatively set refcount in the expectation that compare_exchange
@@ -175,43 +226,139 @@ class BEFLocationHandler final : public LocationHandler,
 /// concurrent control flow constructs.
 class BEFExecutor final : public ReferenceCounted<BEFExecutor> {
  public:
-  static void Execute(const BEFFunction& fn, ArrayRef<AsyncValue*> arguments,
-                      MutableArrayRef<RCReference<AsyncValue>> results,
-                      HostContext* host);
-
-  /// When the last reference to the BEFExecutor is dropped, we deallocate
-  /// ourself.  The memory for this class is managed through the HostAllocator
-  /// managed by the HostContext.
-  void Destroy() {
-    auto host = this->GetHost();
-    this->~BEFExecutor();
-    host->Deallocate<BEFExecutor>(this);
-  }
+  static void Execute(const BEFFunction& fn, const ExecutionContext& exec_ctx,
+                      ArrayRef<AsyncValue*> arguments,
+                      MutableArrayRef<RCReference<AsyncValue>> results);
+
+  /// Execute `fn` once for each entry in `entries`, sharing the fixed
+  /// per-call setup across the batch and interleaving the entries' kernels
+  /// on the work queue. All result AsyncValues are populated before this
+  /// returns.
+  static void ExecuteBatch(const BEFFunction& fn,
+                           ArrayRef<Function::BatchEntry> entries,
+                           HostContext* host);
+
+  /// When the last reference to the BEFExecutor is dropped, we retire our
+  /// per-execution state and either park ourself in the function's executor
+  /// cache for reuse by the next invocation, or deallocate.  The memory for
+  /// this class is managed through the HostAllocator managed by the
+  /// HostContext.
+  void Destroy();
 
  private:
   BEFExecutor(BEFFileImpl* bef_file, HostContext* host,
-              ArrayRef<uint32_t> kernels,
+              const BEFFileImpl::FunctionInfo* function_info,
               HostArray<BEFFileImpl::KernelInfo> kernel_infos,
               HostArray<BEFFileImpl::RegisterInfo> register_infos,
               bool has_arguments_pseudo_kernel);
   ~BEFExecutor();
 
  private:
+  // Decode the function state and construct an executor for one invocation,
+  // with the argument registers initialized. The result registers of the
+  // invocation are stored into `result_regs`. No kernel runs until Start()
+  // is called. Returns a null reference if the function cannot be decoded.
+  static RCReference<BEFExecutor> CreateExecutor(
+      const BEFFunction& fn, ArrayRef<AsyncValue*> arguments,
+      SmallVectorImpl<size_t>* result_regs, HostContext* host);
+
+  // Kick off the kernels of this invocation that are ready to run.
+  void Start();
+
+  // Reinitialize a parked executor (see FunctionInfo::cached_executor) for a
+  // new invocation of the same function.
+  void Reuse(BEFFileImpl* bef_file, HostContext* host,
+             HostArray<BEFFileImpl::KernelInfo> kernel_infos,
+             HostArray<BEFFileImpl::RegisterInfo> register_infos,
+             bool has_arguments_pseudo_kernel);
+
+  // Deleter installed in FunctionInfo::cached_executor_deleter, so the BEF
+  // file can free a parked executor when the file itself is destroyed.
+  static void DeleteParked(void* executor);
+
+  // Populate the invocation's result AsyncValues from the result registers,
+  // creating IndirectAsyncValues for results that are not available yet.
+  void PopulateResults(MutableArrayRef<RCReference<AsyncValue>> results,
+                       ArrayRef<size_t> result_regs, HostContext* host);
+
+  // Take a KernelFrameBuilder out of the frame pool (creating one if the pool
+  // is empty). Pooled frames keep their grown argument/result storage, so in
+  // steady state setting up a kernel invocation does no allocation.
+  KernelFrameBuilder* AcquireKernelFrame();
+
+  // Return a KernelFrameBuilder to the frame pool for reuse.
+  void ReleaseKernelFrame(KernelFrameBuilder* frame);
+
   void DecrementArgumentsNotReadyCounts(SmallVectorImpl<unsigned>* kernel_ids);
+
+  // Waiter-free error propagation: when a strict kernel is dispatched with
+  // an error argument, forward the error to its results and walk the static
+  // used_by lists transitively, marking every downstream register errored in
+  // one sweep. The swept kernels are claimed but never dispatched - no
+  // kernel frame, no argument materialization beyond the reference
+  // bookkeeping. Non-strict kernels are not swept: they are made ready and
+  // dispatched normally so they can observe their error arguments. `kernel`
+  // is the claimed kernel being dispatched and `entry_offset` points at its
+  // result entries.
+  void PropagateError(const BEFKernel& kernel, int entry_offset,
+                      AsyncValue* error,
+                      SmallVectorImpl<unsigned>* kernel_ids);
+
+  // Forward `error` to the results of one claimed kernel and claim its
+  // strict users for the sweep (pushed to `swept`); non-strict users are
+  // made ready and pushed to the regular worklist `kernel_ids`.
+  void PropagateErrorToResults(const BEFKernel& kernel, int entry_offset,
+                               AsyncValue* error,
+                               SmallVectorImpl<unsigned>* swept,
+                               SmallVectorImpl<unsigned>* kernel_ids);
+
+  // The dispatch loop is compiled in two instantiations: the untraced one
+  // contains no tracing code at all - not even the is-tracing-on check - and
+  // the traced one records cycle-counter begin/end stamps per kernel into
+  // the calling thread's trace buffer. DecrementArgumentsNotReadyCounts
+  // selects an instantiation once per worklist drain.
+  template <bool kCycleTraced>
+  void DecrementArgumentsNotReadyCountsImpl(
+      SmallVectorImpl<unsigned>* kernel_ids);
+
+  // Append `used_bys` to the worklist ordered by criticality: the worklist
+  // is popped from the back, so the kernels feeding the longest dependency
+  // chains are placed last and processed first (see KernelTemplate::height).
+  void AppendByCriticality(ArrayRef<uint32_t> used_bys,
+                           SmallVectorImpl<unsigned>* kernel_ids);
   void ProcessArgumentsPseudoKernel(SmallVectorImpl<unsigned>* kernel_ids);
   void ProcessUsedBys(const BEFKernel& kernel, int result_number,
                       AsyncValue* result, int* entry_offset,
                       SmallVectorImpl<unsigned>* kernel_ids);
+  void ProcessSyncUsedBys(const BEFKernel& kernel, int result_number,
+                          AsyncValue* result, int* entry_offset,
+                          SmallVectorImpl<unsigned>* kernel_ids);
   void MaybeAddRefForResult(AsyncValue* result);
-  HostContext* GetHost() const { return location_handler_->GetHost(); }
+  HostContext* GetHost() const { return host_; }
+
+  // The cancellation error for the current invocation, merging host-wide
+  // cancellation with this invocation's token. Null when not cancelled.
+  AsyncValue* GetCancelAsyncValue() const {
+    if (AsyncValue* cancelled = host_->GetCancelAsyncValue()) return cancelled;
+    return cancel_token_ ? cancel_token_->GetCancelAsyncValue() : nullptr;
+  }
 
  private:
   friend class ReferenceCounted<BEFExecutor>;
 
+  /// The HostContext this executor runs on. The executor object may be parked
+  /// and reused across invocations, but always on the same HostContext.
+  HostContext* const host_;
+
   /// Make sure the BEF file doesn't get deallocated while we're asynchronously
   /// running stuff.
   RCReference<BEFFileImpl> bef_file_;
 
+  /// The cached dispatch template for this function: resolved kernel
+  /// implementations and static operand counts, decoded once per function in
+  /// the BEF file (see BEFFileImpl::GetFunctionInfo).
+  const BEFFileImpl::FunctionInfo* function_info_;
+
   // This ArrayRef contains kernel entries of all kernels of this function.
   ArrayRef<uint32_t> kernels_;
 
@@ -223,14 +370,54 @@ class BEFExecutor final : public ReferenceCounted<BEFExecutor> {
   /// register number.
   HostArray<BEFFileImpl::RegisterInfo> register_infos_;
 
+  /// True if the first kernel is the pseudo kernel providing the function
+  /// arguments, which gets special handling in Start().
+  bool has_arguments_pseudo_kernel_;
+
   // Make sure location handler is alive as long as there is pending execution.
   RCReference<BEFLocationHandler> location_handler_;
+
+  /// The cancellation token of the current invocation, or null if the
+  /// invocation is not cancellable through a token. Set by Execute() after
+  /// the executor is constructed (or resurrected from the parked-executor
+  /// slot) and released when the invocation retires.
+  RCReference<CancellationToken> cancel_token_;
+
+  /// Critical path recording for this invocation, set up only when the mode
+  /// is enabled (see critical_path_analysis.h). Shared with availability
+  /// callbacks that may outlive the executor. Null in the common case.
+  std::shared_ptr<CriticalPathRecorder> critical_path_recorder_;
+
+  /// Pool of KernelFrameBuilders reused across DecrementArgumentsNotReadyCounts
+  /// invocations (one frame is checked out per invocation, including the
+  /// asynchronous continuations that run on worker threads). The lock is taken
+  /// once per invocation, not once per kernel, so it is well amortized.
+  mutex frame_pool_mu_;
+  SmallVector<std::unique_ptr<KernelFrameBuilder>, 4> frame_pool_
+      TFRT_GUARDED_BY(frame_pool_mu_);
 };
 
 //===----------------------------------------------------------------------===//
 // Core executor logic
 //===----------------------------------------------------------------------===//
 
+void BEFExecutor::AppendByCriticality(ArrayRef<uint32_t> used_bys,
+                                      SmallVectorImpl<unsigned>* kernel_ids) {
+  if (used_bys.size() <= 1) {
+    kernel_ids->append(used_bys.begin(), used_bys.end());
+    return;
+  }
+
+  size_t start = kernel_ids->size();
+  kernel_ids->append(used_bys.begin(), used_bys.end());
+  const auto& kernel_templates = function_info_->kernel_templates;
+  std::stable_sort(kernel_ids->begin() + start, kernel_ids->end(),
+                   [&](unsigned a, unsigned b) {
+                     return kernel_templates[a].height <
+                            kernel_templates[b].height;
+                   });
+}
+
 // Enqueue the users of the result for later processing. If a result has no
 // users, it will be skipped. If the kernel immediately completed a result, then
 // we can mark all kernels using it as ready to go, otherwise we need to enqueue
@@ -268,7 +455,7 @@ void BEFExecutor::ProcessUsedBys(const BEFKernel& kernel, int result_number,
   // then we can immediately process any using kernel as part of our visit
   // here. Just add it to the worklist for processing, to avoid recursion.
   if (state.IsAvailable()) {
-    kernel_ids->append(used_bys.begin(), used_bys.end());
+    AppendByCriticality(used_bys, kernel_ids);
     return;
   }
 
@@ -310,7 +497,7 @@ void BEFExecutor::ProcessUsedBys(const BEFKernel& kernel, int result_number,
   // As in BEFExecutor's constructor, we reserve some extra space to
   // accommodate growth for users of results of these kernels.
   using_kernel_ids.reserve(used_bys.size() + 4);
-  using_kernel_ids.append(used_bys.begin(), used_bys.end());
+  AppendByCriticality(used_bys, &using_kernel_ids);
 
   // Process the whole batch when this result becomes available.
   result->AndThen(
@@ -320,6 +507,110 @@ void BEFExecutor::ProcessUsedBys(const BEFKernel& kernel, int result_number,
       });
 }
 
+// Enqueue the users of a result produced by a synchronous kernel. Synchronous
+// kernels complete all of their results before returning, so unlike
+// ProcessUsedBys there is no waiter-list machinery here: the using kernels
+// are appended to the worklist directly and run as part of this visit.
+void BEFExecutor::ProcessSyncUsedBys(const BEFKernel& kernel, int result_number,
+                                     AsyncValue* result, int* entry_offset,
+                                     SmallVectorImpl<unsigned>* kernel_ids) {
+  assert(result->IsAvailable() &&
+         "Synchronous kernels must complete their results before returning");
+
+  // Find used_by entries for this result.
+  auto num_used_bys = kernel.num_used_bys(result_number);
+  // Skip current result if there is no user.
+  if (num_used_bys == 0) return;
+
+  auto used_bys = kernel.GetKernelEntries(*entry_offset, num_used_bys);
+  // Move entry offset to used_bys for next result.
+  *entry_offset += num_used_bys;
+
+  // Accelerate error propagation, the same way ProcessUsedBys does.
+  if (result->IsError())
+    SetKernelsWithErrorInputReady(kernel_infos_.mutable_array(), used_bys);
+
+  AppendByCriticality(used_bys, kernel_ids);
+}
+
+// This is the error sweep: the downstream registers of a failed kernel are
+// all errored here in one pass, driven by the static used_by lists, instead
+// of dispatching each downstream kernel just so it can inspect its inputs
+// and forward the error. Kernels are claimed through their ready count (see
+// ClaimKernelForErrorSweep), so a sweep composes safely with concurrent
+// normal dispatch and with other sweeps. Out of line because this only runs
+// on failing executions.
+LLVM_ATTRIBUTE_NOINLINE
+void BEFExecutor::PropagateError(const BEFKernel& kernel, int entry_offset,
+                                 AsyncValue* error,
+                                 SmallVectorImpl<unsigned>* kernel_ids) {
+  // Kernels claimed for the sweep whose results are not yet errored.
+  SmallVector<unsigned, 16> swept;
+  PropagateErrorToResults(kernel, entry_offset, error, &swept, kernel_ids);
+
+  while (!swept.empty()) {
+    unsigned kernel_id = swept.pop_back_val();
+    assert(kernel_infos_[kernel_id].offset % kKernelEntryAlignment == 0);
+    BEFKernel swept_kernel(
+        kernels_.data() +
+        kernel_infos_[kernel_id].offset / kKernelEntryAlignment);
+
+    // The swept kernel never runs, but it still consumes one use of each
+    // argument register. Unavailable arguments get an IndirectAsyncValue
+    // here, exactly as a normal dispatch of an error-accelerated kernel
+    // would create; it is forwarded when the producer finishes.
+    for (auto reg_idx :
+         swept_kernel.GetKernelEntries(0, swept_kernel.num_arguments()))
+      GetOrCreateRegisterValue(&register_infos_[reg_idx], GetHost())
+          ->DropRef();
+
+    int swept_entry_offset = swept_kernel.num_arguments() +
+                             swept_kernel.num_attributes() +
+                             swept_kernel.num_functions();
+    PropagateErrorToResults(swept_kernel, swept_entry_offset, error, &swept,
+                            kernel_ids);
+  }
+}
+
+void BEFExecutor::PropagateErrorToResults(
+    const BEFKernel& kernel, int entry_offset, AsyncValue* error,
+    SmallVectorImpl<unsigned>* swept, SmallVectorImpl<unsigned>* kernel_ids) {
+  const auto& kernel_templates = function_info_->kernel_templates;
+  auto results = kernel.GetKernelEntries(entry_offset, kernel.num_results());
+  entry_offset += results.size();
+  for (int result_number = 0; result_number < results.size();
+       ++result_number) {
+    auto num_used_bys = kernel.num_used_bys(result_number);
+    auto used_bys = kernel.GetKernelEntries(entry_offset, num_used_bys);
+    entry_offset += num_used_bys;
+
+    auto& result_register = register_infos_[results[result_number]];
+    // An unused result was never going to be stored in its register.
+    if (result_register.user_count == 0) continue;
+
+    // Transfer a +1 reference on the error to SetRegisterValue, as the
+    // normal result path does for a kernel-produced result.
+    error->AddRef();
+    bool register_already_set;
+    AsyncValue* register_value =
+        SetRegisterValue(&result_register, error, &register_already_set);
+    // DropRef since we no longer need the IndirectAsyncValue in the register.
+    if (register_already_set) register_value->DropRef();
+
+    for (uint32_t user : used_bys) {
+      if (!kernel_templates[user].is_strict) {
+        // Non-strict kernels run with error arguments, so they take the
+        // normal dispatch - accelerated to ready, as before.
+        SetKernelsWithErrorInputReady(kernel_infos_.mutable_array(),
+                                      llvm::makeArrayRef(user));
+        kernel_ids->push_back(user);
+      } else if (ClaimKernelForErrorSweep(kernel_infos_[user])) {
+        swept->push_back(user);
+      }
+    }
+  }
+}
+
 // Process the arguments pseudo kernel and enqueue the users of these arguments.
 void BEFExecutor::ProcessArgumentsPseudoKernel(
     SmallVectorImpl<unsigned>* kernel_ids) {
@@ -363,13 +654,65 @@ void BEFExecutor::MaybeAddRefForResult(AsyncValue* result) {
   }
 }
 
+KernelFrameBuilder* BEFExecutor::AcquireKernelFrame() {
+  {
+    mutex_lock lock(frame_pool_mu_);
+    if (!frame_pool_.empty()) {
+      KernelFrameBuilder* frame = frame_pool_.back().release();
+      frame_pool_.pop_back();
+      // Long-running kernels poll the cancellation token through the frame's
+      // ExecutionContext.
+      frame->SetCancellationToken(cancel_token_.CopyRef());
+      return frame;
+    }
+  }
+  auto frame = std::make_unique<KernelFrameBuilder>(GetHost());
+  frame->SetAttributeSection(bef_file_->attribute_section_);
+  frame->SetCancellationToken(cancel_token_.CopyRef());
+  return frame.release();
+}
+
+void BEFExecutor::ReleaseKernelFrame(KernelFrameBuilder* frame) {
+  frame->Reset();
+  // Pooled frames may outlive the invocation (the executor can be parked),
+  // so they must not keep the token alive.
+  frame->SetCancellationToken(RCReference<CancellationToken>());
+  mutex_lock lock(frame_pool_mu_);
+  frame_pool_.push_back(std::unique_ptr<KernelFrameBuilder>(frame));
+}
+
 /// Decrement arguments_not_ready counters for the specified kernels by one,
 /// executing them if they are now ready to run. This processes the kernels
 /// from the end of the vector to the start - worklist style.
 void BEFExecutor::DecrementArgumentsNotReadyCounts(
     SmallVectorImpl<unsigned>* kernel_ids) {
-  KernelFrameBuilder kernel_frame(GetHost());
-  kernel_frame.SetAttributeSection(bef_file_->attribute_section_);
+  // Select the traced or untraced instantiation of the dispatch loop once
+  // per worklist drain, so steady-state dispatch pays nothing - not even a
+  // branch per kernel - for the ability to trace during incidents.
+  bool traced = tracing::IsKernelCycleTracingEnabled() ||
+                tracing::IsKernelLatencyAggregationEnabled() ||
+                IsAsyncValueProfilingEnabled() ||
+                critical_path_recorder_ != nullptr;
+#ifndef NO_TFRT_TRACING
+  traced |= internal::tracing::TracingApi::IsTracingOn();
+#endif
+  if (traced)
+    DecrementArgumentsNotReadyCountsImpl<true>(kernel_ids);
+  else
+    DecrementArgumentsNotReadyCountsImpl<false>(kernel_ids);
+}
+
+template <bool kCycleTraced>
+void BEFExecutor::DecrementArgumentsNotReadyCountsImpl(
+    SmallVectorImpl<unsigned>* kernel_ids) {
+  KernelFrameBuilder& kernel_frame = *AcquireKernelFrame();
+
+  // In the traced instantiation, fetch the calling thread's cycle trace
+  // buffer once for the whole drain.
+  tracing::KernelCycleTraceBuffer* cycle_trace_buffer =
+      kCycleTraced ? tracing::KernelCycleTraceBuffer::GetForCurrentThread()
+                   : nullptr;
+  (void)cycle_trace_buffer;
 
   MutableArrayRef<BEFFileImpl::KernelInfo>& kernel_infos =
       kernel_infos_.mutable_array();
@@ -380,7 +723,14 @@ void BEFExecutor::DecrementArgumentsNotReadyCounts(
 
     // Decrement the count and see if we're ready to run.  If not, then we're
     // done with the kernel.
-    if (kernel_infos[kernel_id].arguments_not_ready.fetch_sub(1) != 1) continue;
+    //
+    // Strand-interior kernels (single operand) are only ever enqueued by the
+    // one thread that made their operand available, so they are ready by
+    // construction and skip the ready count entirely (see
+    // KernelInfo::IsStrandInterior).
+    if (!kernel_infos[kernel_id].IsStrandInterior() &&
+        kernel_infos[kernel_id].arguments_not_ready.fetch_sub(1) != 1)
+      continue;
 
     assert(kernel_infos[kernel_id].offset % kKernelEntryAlignment == 0);
     BEFKernel kernel(kernels_.data() +
@@ -388,17 +738,25 @@ void BEFExecutor::DecrementArgumentsNotReadyCounts(
 
     // Keep track of whether we saw any error arguments. If so, we propagate the
     // error to the results automatically. Initialize it with the cancel async
-    // value if the execution has been canceled.
-    AsyncValue* any_error_argument = GetHost()->GetCancelAsyncValue();
+    // value if the execution has been canceled, either host-wide or through
+    // this invocation's cancellation token.
+    AsyncValue* any_error_argument = GetCancelAsyncValue();
 
     // Process the kernel record to get information about what argument
     // registers, result registers, and attributes should be passed.
     kernel_frame.Reset();
 
-    // Find the kernel implementation of this kernel.
-    KernelImplementation kernel_fn = bef_file_->kernels_[kernel.kernel_code()];
+    // Find the kernel implementation of this kernel. It was resolved at load
+    // time into the function's dispatch template, so this is a direct indexed
+    // call with no lookup of any kind.
+    const auto& kernel_template = function_info_->kernel_templates[kernel_id];
+    KernelImplementation kernel_fn = kernel_template.fn;
     assert(kernel_fn != nullptr);
 
+    // Synchronous kernels complete all of their results before returning, so
+    // their result processing below skips the waiter-list machinery.
+    const bool is_sync_kernel = kernel_template.is_sync;
+
     // Check the low bit of special_metadata, which indicates if the kernel
     // is non-strict.
     bool is_nonstrict_kernel =
@@ -427,25 +785,16 @@ void BEFExecutor::DecrementArgumentsNotReadyCounts(
     // TODO(b/142757465): remove arguments_and_results_ vector in KernelFrame.
     kernel_frame.SetNumResults(kernel.num_results());
 
-    // Set up attributes.
+    // Set up attributes and functions from the pointers resolved at decode
+    // time (see FunctionInfo::attribute_pointers): attribute payloads
+    // first, then the function attributes as Function pointers.
     entry_offset += arguments.size();
-    auto attributes =
-        kernel.GetKernelEntries(entry_offset, kernel.num_attributes());
-    for (auto attribute_offset : attributes) {
-      // We pass the pointer here because this attribute could be an array of
-      // size 0.
-      kernel_frame.AddAttribute(bef_file_->attribute_section_.data() +
-                                attribute_offset);
-    }
-
-    // Set up functions.
-    entry_offset += attributes.size();
-    auto functions =
-        kernel.GetKernelEntries(entry_offset, kernel.num_functions());
-    for (auto fn_idx : functions) {
-      // Functions are passed as their corresponding `Function`.
-      kernel_frame.AddAttribute(bef_file_->functions_[fn_idx].get());
-    }
+    for (const void* attribute :
+         llvm::makeArrayRef(function_info_->attribute_pointers)
+             .slice(kernel_template.attribute_offset,
+                    kernel.num_attributes() + kernel.num_functions()))
+      kernel_frame.AddAttribute(attribute);
+    entry_offset += kernel.num_attributes() + kernel.num_functions();
 
     // If all arguments are good or if the kernel is non-strict, run the
     // function.
@@ -455,17 +804,65 @@ void BEFExecutor::DecrementArgumentsNotReadyCounts(
       kernel_frame.SetLocation(
           {location_handler_.get(), kernel.kernel_location()});
 
+      // Publish the kernel identity for signal-based samplers: one relaxed
+      // store per kernel, maintained unconditionally so CPU profiles can
+      // always attribute samples to the running kernel.
+      tracing::SetCurrentKernelForSampling(
+          bef_file_->GetKernelName(kernel.kernel_code()));
+
       // kernel_fn should populate results in kernel_frame with pointers to
       // AsyncValue before it returns.
-      {
+      if (kCycleTraced) {
         TFRT_TRACE_KERNEL_SCOPE(bef_file_->GetKernelName(kernel.kernel_code()));
+        // Attribute AsyncValues created during this invocation (the kernel's
+        // results and any internal values) to this kernel.
+        if (IsAsyncValueProfilingEnabled()) {
+          SetCurrentKernelForAsyncValueProfiling(
+              bef_file_->GetKernelName(kernel.kernel_code()));
+        }
+        // The critical path walk needs wall-clock dispatch windows that are
+        // comparable with AsyncValue availability timestamps, so it uses the
+        // steady clock rather than the cycle counter.
+        uint64_t begin_wall_ns =
+            critical_path_recorder_ ? CriticalPathNowNs() : 0;
+        uint64_t begin_cycles = tracing::ReadCycleCounter();
+        kernel_fn(&kernel_frame);
+        uint64_t end_cycles = tracing::ReadCycleCounter();
+        if (critical_path_recorder_) {
+          critical_path_recorder_->RecordKernelDispatch(
+              kernel_id, bef_file_->GetKernelName(kernel.kernel_code()),
+              arguments, begin_wall_ns, CriticalPathNowNs());
+        }
+        if (IsAsyncValueProfilingEnabled()) {
+          SetCurrentKernelForAsyncValueProfiling(nullptr);
+        }
+        // The full per-execution trace and the bounded aggregation mode are
+        // enabled independently; only the former may grow without a drain.
+        if (tracing::IsKernelCycleTracingEnabled()) {
+          cycle_trace_buffer->Record(
+              bef_file_->GetKernelName(kernel.kernel_code()), begin_cycles,
+              end_cycles);
+        }
+        if (tracing::IsKernelLatencyAggregationEnabled()) {
+          tracing::RecordKernelLatency(
+              bef_file_->GetKernelName(kernel.kernel_code()),
+              end_cycles - begin_cycles);
+        }
+      } else {
         kernel_fn(&kernel_frame);
       }
+
+      // Clear the slot so time between kernels shows up as idle rather than
+      // being charged to the last kernel that ran.
+      tracing::SetCurrentKernelForSampling(nullptr);
     } else {
-      // Otherwise, automatically propagate errors to the result values.
-      for (size_t i = 0, e = kernel_frame.GetNumResults(); i != e; ++i) {
-        kernel_frame.SetResultAt(i, FormRef(any_error_argument));
-      }
+      // Strict kernel with an error argument: nothing runs. Sweep the error
+      // through every transitively dependent register in one pass (the
+      // sweep takes its own references on the error), then release the
+      // arguments and move on to the next worklist entry.
+      PropagateError(kernel, entry_offset, any_error_argument, kernel_ids);
+      for (auto* arg : kernel_frame.GetArguments()) arg->DropRef();
+      continue;
     }
 
     // Now that the kernel had a chance to look at the arguments, we're done
@@ -478,8 +875,7 @@ void BEFExecutor::DecrementArgumentsNotReadyCounts(
     // result, then we can mark all kernels using it as ready to go, otherwise
     // we need to enqueue them on their unavailable operands.
 
-    // Move entry offset to start of results.
-    entry_offset += functions.size();
+    // entry_offset already points at the start of the results.
     auto results = kernel.GetKernelEntries(entry_offset, kernel.num_results());
     // Move entry offset to start of all used_bys.
     entry_offset += results.size();
@@ -506,14 +902,30 @@ void BEFExecutor::DecrementArgumentsNotReadyCounts(
       bool register_already_set;
       auto* register_value =
           SetRegisterValue(&result_register, result, &register_already_set);
-      // Process users of this result.
-      ProcessUsedBys(kernel, result_number, register_value, &entry_offset,
-                     kernel_ids);
+      // Stamp the register's producer and availability for the critical
+      // path walk, before any waiter of the value runs.
+      if (kCycleTraced && critical_path_recorder_) {
+        CriticalPathRecorder::RecordResult(critical_path_recorder_,
+                                           results[result_number], kernel_id,
+                                           register_value);
+      }
+      // Process users of this result. Results of synchronous kernels are
+      // available by the time we get here (the error propagation path above
+      // also produces available values), so they take the streamlined path.
+      if (is_sync_kernel) {
+        ProcessSyncUsedBys(kernel, result_number, register_value, &entry_offset,
+                           kernel_ids);
+      } else {
+        ProcessUsedBys(kernel, result_number, register_value, &entry_offset,
+                       kernel_ids);
+      }
 
       // DropRef since we no longer need the IndirectAsyncValue in the register.
       if (register_already_set) register_value->DropRef();
     }
   }
+
+  ReleaseKernelFrame(&kernel_frame);
 }
 
 //===----------------------------------------------------------------------===//
@@ -521,19 +933,103 @@ void BEFExecutor::DecrementArgumentsNotReadyCounts(
 //===----------------------------------------------------------------------===//
 
 BEFExecutor::BEFExecutor(BEFFileImpl* bef_file, HostContext* host,
-                         ArrayRef<uint32_t> kernels,
+                         const BEFFileImpl::FunctionInfo* function_info,
                          HostArray<BEFFileImpl::KernelInfo> kernel_infos,
                          HostArray<BEFFileImpl::RegisterInfo> register_infos,
                          bool has_arguments_pseudo_kernel)
-    : bef_file_(FormRef(bef_file)),
-      kernels_(kernels),
+    : host_(host),
+      bef_file_(FormRef(bef_file)),
+      function_info_(function_info),
+      kernels_(function_info->kernels),
       kernel_infos_(std::move(kernel_infos)),
       register_infos_(std::move(register_infos)),
+      has_arguments_pseudo_kernel_(has_arguments_pseudo_kernel),
       location_handler_(
           TakeRef(host->Construct<BEFLocationHandler>(host, bef_file))) {
-  // Now that the executor object is all set up and ready to go, kick off the
-  // instructions that are ready.
+  if (IsCriticalPathAnalysisEnabled()) {
+    critical_path_recorder_ = std::make_shared<CriticalPathRecorder>(
+        register_infos_.size(), kernel_infos_.size());
+    PublishCriticalPathRecorder(critical_path_recorder_);
+  }
+}
+
+// Reinitialize a parked executor for a new invocation: it already points at
+// the right function template and keeps its warm kernel frame pool, so only
+// the per-invocation state needs to be set up again.
+void BEFExecutor::Reuse(BEFFileImpl* bef_file, HostContext* host,
+                        HostArray<BEFFileImpl::KernelInfo> kernel_infos,
+                        HostArray<BEFFileImpl::RegisterInfo> register_infos,
+                        bool has_arguments_pseudo_kernel) {
+  assert(host_ == host && "parked executor reused on a different HostContext");
+  bef_file_ = FormRef(bef_file);
+  kernel_infos_ = std::move(kernel_infos);
+  register_infos_ = std::move(register_infos);
+  has_arguments_pseudo_kernel_ = has_arguments_pseudo_kernel;
+  location_handler_ =
+      TakeRef(host->Construct<BEFLocationHandler>(host, bef_file));
+  assert(!critical_path_recorder_ && "recorder must be reset when parking");
+  if (IsCriticalPathAnalysisEnabled()) {
+    critical_path_recorder_ = std::make_shared<CriticalPathRecorder>(
+        register_infos_.size(), kernel_infos_.size());
+    PublishCriticalPathRecorder(critical_path_recorder_);
+  }
+}
 
+void BEFExecutor::DeleteParked(void* executor) {
+  auto* exec = static_cast<BEFExecutor*>(executor);
+  HostContext* host = exec->host_;
+  exec->~BEFExecutor();
+  host->Deallocate<BEFExecutor>(exec);
+}
+
+void BEFExecutor::Destroy() {
+  // Retire the register file and kernel bookkeeping arrays to the function's
+  // execution-state pool, so the next execution of this function reuses the
+  // warm memory instead of allocating and faulting in a fresh copy.
+  bef_file_->ReturnFunctionState(function_info_, std::move(register_infos_),
+                                 std::move(kernel_infos_));
+
+  const BEFFileImpl::FunctionInfo* info = function_info_;
+
+  // Drop the references that would otherwise keep the BEF file alive from
+  // inside its own cache: the file owns the cache slot, so a parked executor
+  // must not hold them. However, `info` points into the file, so the file
+  // reference is moved into a local that is released only after the parking
+  // CAS below: if this executor held the last reference, resetting it here
+  // would destroy the file and every FunctionInfo before the stores into
+  // `info`. Dropping the local last is safe even if it destroys the file:
+  // FunctionInfo's destructor frees a just-parked executor through the
+  // stored deleter. The location handler may be kept alive independently by
+  // pending asynchronous results, so it is released rather than reused.
+  RCReference<BEFFileImpl> file = std::move(bef_file_);
+  location_handler_.reset();
+  // The token belongs to the retiring invocation; the next invocation of
+  // this function installs its own (or none).
+  cancel_token_.reset();
+  // Per-invocation recording state must not survive into the next
+  // invocation; the global last-execution slot and any pending availability
+  // callbacks keep their own references.
+  critical_path_recorder_.reset();
+
+  // Try to park this object in the function's single-slot executor cache so
+  // the next invocation reuses the allocation and the warm kernel frame
+  // pool. Sequential re-invocation (e.g. a hex.repeat.i32 loop body) hits
+  // this slot on every iteration.
+  info->cached_executor_deleter.store(&BEFExecutor::DeleteParked,
+                                      std::memory_order_relaxed);
+  void* expected = nullptr;
+  if (info->cached_executor.compare_exchange_strong(
+          expected, this, std::memory_order_release,
+          std::memory_order_relaxed))
+    return;
+
+  // The slot already holds a parked executor; free this one for real.
+  DeleteParked(this);
+}
+
+// Now that the executor object is all set up and ready to go, kick off the
+// instructions that are ready.
+void BEFExecutor::Start() {
   // InitializeKernels initialized each KernelInfo::arguments_not_ready to one
   // plus the number of arguments. This means that as we walk the list to drop
   // the argument count, if we hit zero then it is time for us to trigger the
@@ -550,13 +1046,35 @@ BEFExecutor::BEFExecutor(BEFFileImpl* bef_file, HostContext* host,
   kernel_ids_to_visit.reserve(kernel_infos_.size() + 4);
   // Reverse indices in kernel_ids_to_visit because
   // DecrementArgumentsNotReadyCounts processes its argument from back to front.
+  //
+  // Strand-interior kernels are skipped: they are dispatched directly by the
+  // thread that produces their single operand, so visiting them here would
+  // only burn an atomic decrement that no other event balances.
   for (unsigned i = 0, e = kernel_infos_.size(); i != e; ++i) {
-    kernel_ids_to_visit.push_back(e - i - 1);
+    unsigned kernel_id = e - i - 1;
+    if (kernel_infos_[kernel_id].IsStrandInterior()) continue;
+    kernel_ids_to_visit.push_back(kernel_id);
   }
 
+  // Order the initial visit by criticality, so the kernels feeding the
+  // longest dependency chains are processed first (the worklist is popped
+  // from the back).
+  const auto& kernel_templates = function_info_->kernel_templates;
+  std::stable_sort(kernel_ids_to_visit.begin(), kernel_ids_to_visit.end(),
+                   [&](unsigned a, unsigned b) {
+                     return kernel_templates[a].height <
+                            kernel_templates[b].height;
+                   });
+
   // The first kernel can be a pseudo kernel provides the arguments, which gets
-  // special handling.
-  if (has_arguments_pseudo_kernel) {
+  // special handling: ProcessArgumentsPseudoKernel expects it at the back of
+  // the worklist, and it must run before everything else anyway since it
+  // supplies the function arguments.
+  if (has_arguments_pseudo_kernel_) {
+    auto it = std::find(kernel_ids_to_visit.begin(), kernel_ids_to_visit.end(),
+                        0u);
+    assert(it != kernel_ids_to_visit.end());
+    std::rotate(it, it + 1, kernel_ids_to_visit.end());
     ProcessArgumentsPseudoKernel(&kernel_ids_to_visit);
   }
 
@@ -580,62 +1098,333 @@ static void InitializeArgumentRegisters(
   }
 }
 
-void BEFExecutor::Execute(const BEFFunction& fn,
-                          ArrayRef<AsyncValue*> arguments,
-                          MutableArrayRef<RCReference<AsyncValue>> results,
-                          HostContext* host) {
-  DEBUG_PRINT("Execute function %s start\n",
-              fn.name().empty() ? "(unknown)" : fn.name().str().c_str());
-
+RCReference<BEFExecutor> BEFExecutor::CreateExecutor(
+    const BEFFunction& fn, ArrayRef<AsyncValue*> arguments,
+    SmallVectorImpl<size_t>* result_regs, HostContext* host) {
   BEFFileImpl* bef_file = fn.bef_file();
   assert(arguments.size() == fn.argument_types().size() &&
          "incorrect number of arguments passed to function call");
-  assert(results.size() == fn.result_types().size() &&
-         "incorrect number of results passed to function call");
 
   size_t location_offset;
   HostArray<BEFFileImpl::RegisterInfo> register_infos;
   HostArray<BEFFileImpl::KernelInfo> kernel_infos;
-  SmallVector<size_t, 4> result_regs;
 
-  auto kernels = bef_file->ReadFunction(
-      fn.function_offset(), fn.result_types(), &location_offset,
-      &register_infos, &kernel_infos, &result_regs, host->allocator());
-  if (kernels.empty()) return;
-  assert(result_regs.size() == fn.result_types().size());
+  const auto* function_info =
+      bef_file->ReadFunction(fn, &location_offset, &register_infos,
+                             &kernel_infos, result_regs, host->allocator());
+  if (!function_info) return {};
+  assert(result_regs->size() == fn.result_types().size());
+
+  InitializeArgumentRegisters(arguments, register_infos.mutable_array());
+
+  // Resurrect a parked executor for this function when there is one: a loop
+  // that re-invokes the same function (e.g. hex.repeat.i32) gets its
+  // executor object - and the warm kernel frame pool inside it - back on
+  // every iteration.
+  if (void* parked = function_info->cached_executor.exchange(
+          nullptr, std::memory_order_acquire)) {
+    auto* exec = static_cast<BEFExecutor*>(parked);
+    exec->Reuse(bef_file, host, std::move(kernel_infos),
+                std::move(register_infos), !arguments.empty());
+    // The parked executor's reference count dropped to zero when it was
+    // parked; take it back to one for this invocation.
+    exec->AddRef();
+    return TakeRef(exec);
+  }
 
-  MutableArrayRef<BEFFileImpl::RegisterInfo> register_array =
-      register_infos.mutable_array();
-  InitializeArgumentRegisters(arguments, register_array);
   auto* exec_ptr = host->Allocate<BEFExecutor>();
   auto* exec = new (exec_ptr)
-      BEFExecutor(bef_file, host, kernels, std::move(kernel_infos),
+      BEFExecutor(bef_file, host, function_info, std::move(kernel_infos),
                   std::move(register_infos), !arguments.empty());
+  return TakeRef(exec);
+}
 
-  // Populate the function result AsyncValues (results).
-  //
-  // Due to the presence of async kernels, the result registers may not contain
-  // an AsyncValue yet at this point. If a result register contains an
-  // AsyncValue, we use it as the result. Otherwise, we make a
-  // IndirectAsyncValue as the function result and store the IndirectAsyncValue
-  // in the result register. When the actual AsyncValue is available, we set the
-  // IndirectAsyncValue to point to the actual value.
+// Populate the function result AsyncValues (results).
+//
+// Due to the presence of async kernels, the result registers may not contain
+// an AsyncValue yet at this point. If a result register contains an
+// AsyncValue, we use it as the result. Otherwise, we make a
+// IndirectAsyncValue as the function result and store the IndirectAsyncValue
+// in the result register. When the actual AsyncValue is available, we set the
+// IndirectAsyncValue to point to the actual value.
+void BEFExecutor::PopulateResults(
+    MutableArrayRef<RCReference<AsyncValue>> results,
+    ArrayRef<size_t> result_regs, HostContext* host) {
+  assert(results.size() == result_regs.size());
+  MutableArrayRef<BEFFileImpl::RegisterInfo> register_array =
+      register_infos_.mutable_array();
   for (size_t i = 0, e = results.size(); i != e; ++i) {
     assert(!results[i] && "result AsyncValue is not nullptr");
     BEFFileImpl::RegisterInfo& result_reg = register_array[result_regs[i]];
     AsyncValue* value = GetOrCreateRegisterValue(&result_reg, host);
     results[i] = TakeRef(value);
   }
+}
 
-  // The executor is created with a refcount of 1 to keep it alive during its
-  // own execution. Now that we're done with it, drop our reference to allow it
-  // to be deleted whenever the last async results become available.
-  exec->DropRef();
+void BEFExecutor::Execute(const BEFFunction& fn,
+                          const ExecutionContext& exec_ctx,
+                          ArrayRef<AsyncValue*> arguments,
+                          MutableArrayRef<RCReference<AsyncValue>> results) {
+  DEBUG_PRINT("Execute function %s start\n",
+              fn.name().empty() ? "(unknown)" : fn.name().str().c_str());
+
+  assert(results.size() == fn.result_types().size() &&
+         "incorrect number of results passed to function call");
+
+  HostContext* host = exec_ctx.host();
+  SmallVector<size_t, 4> result_regs;
+  auto exec = CreateExecutor(fn, arguments, &result_regs, host);
+  if (!exec) return;
+
+  // Install the invocation's cancellation token. This covers both freshly
+  // constructed and resurrected parked executors.
+  if (auto* token = exec_ctx.cancellation_token())
+    exec->cancel_token_ = FormRef(token);
+
+  if (exec->critical_path_recorder_)
+    exec->critical_path_recorder_->SetResultRegs(result_regs);
+
+  // Run the ready kernels in the caller thread, then wire up the results.
+  // Any results that are still being computed asynchronously become
+  // IndirectAsyncValues here. The executor keeps itself alive as long as
+  // there is pending asynchronous work; our reference is dropped when `exec`
+  // goes out of scope.
+  exec->Start();
+  exec->PopulateResults(results, result_regs, host);
 
   DEBUG_PRINT("Execute function %s end\n",
               fn.name().empty() ? "(unknown)" : fn.name().str().c_str());
 }
 
+void BEFExecutor::ExecuteBatch(const BEFFunction& fn,
+                               ArrayRef<Function::BatchEntry> entries,
+                               HostContext* host) {
+  DEBUG_PRINT("Execute function %s batch of %zu start\n",
+              fn.name().empty() ? "(unknown)" : fn.name().str().c_str(),
+              entries.size());
+
+  // Construct one executor per entry and wire up all of the result
+  // AsyncValues before any kernel runs. The per-entry register files are
+  // independent, but the fixed per-call work - fetching the cached function
+  // decode, touching the file tables - is amortized while everything is hot
+  // in cache, and deferring Start() lets the entries' kernels interleave on
+  // the work queue instead of each entry running to completion in turn.
+  SmallVector<RCReference<BEFExecutor>, 8> executors;
+  executors.reserve(entries.size());
+  SmallVector<size_t, 4> result_regs;
+  for (const Function::BatchEntry& entry : entries) {
+    assert(entry.results.size() == fn.result_types().size() &&
+           "incorrect number of results passed to function call");
+    result_regs.clear();
+    auto exec = CreateExecutor(fn, entry.arguments, &result_regs, host);
+    // A decode failure was already reported; later entries would fail the
+    // same way, so give up on the whole batch.
+    if (!exec) return;
+    if (exec->critical_path_recorder_)
+      exec->critical_path_recorder_->SetResultRegs(result_regs);
+    exec->PopulateResults(entry.results, result_regs, host);
+    executors.push_back(std::move(exec));
+  }
+
+  // Kick off all but the first entry on the work queue, then run the first
+  // one in the caller thread.
+  for (size_t i = 1, e = executors.size(); i != e; ++i) {
+    host->EnqueueWork([exec = std::move(executors[i])] { exec->Start(); });
+  }
+  if (!executors.empty()) executors.front()->Start();
+
+  DEBUG_PRINT("Execute function %s batch of %zu end\n",
+              fn.name().empty() ? "(unknown)" : fn.name().str().c_str(),
+              entries.size());
+}
+
+//===----------------------------------------------------------------------===//
+// Inline execution of small synchronous function bodies
+//===----------------------------------------------------------------------===//
+
+// Execute a small all-synchronous function body directly in the calling
+// thread: straight-line over the kernel list with a plain register array and
+// a stack kernel frame - no executor object, no atomic ready counts, and no
+// waiter lists. Kernels are stored in program order, so every operand
+// register is written before its consumer runs, and synchronous kernels
+// complete all of their results before returning, so the function results
+// are available when the walk finishes. Small composite ops (a couple of
+// kernels) are the main beneficiary.
+//
+// Returns false without doing anything visible when the invocation does not
+// qualify - large or asynchronous body, unavailable argument, cancellation -
+// in which case the caller runs the general executor.
+static bool TryExecuteInline(const BEFFunction& fn,
+                             const ExecutionContext& exec_ctx,
+                             ArrayRef<AsyncValue*> arguments,
+                             MutableArrayRef<RCReference<AsyncValue>> results) {
+  HostContext* host = exec_ctx.host();
+  BEFFileImpl* bef_file = fn.bef_file();
+  const auto* info = bef_file->GetFunctionInfo(fn);
+  if (!info || !info->inline_executable) return false;
+
+  // Cancellation is handled per kernel by the general dispatch loop.
+  if (exec_ctx.IsCancelled()) return false;
+
+  // Every argument must be available (errors are available too, and flow
+  // through the strict error propagation below).
+  for (AsyncValue* arg : arguments)
+    if (!arg->IsAvailable()) return false;
+
+  // When the function has arguments, kernel 0 is the pseudo kernel that
+  // provides them and is skipped. Otherwise kernel 0 is a real kernel and
+  // must itself be synchronous.
+  const bool has_args = !arguments.empty();
+  if (!has_args && !(info->kernel_templates[0].fn &&
+                     info->kernel_templates[0].is_sync))
+    return false;
+
+  // The register file for this invocation. Produced values each carry the
+  // +1 reference returned by their kernel; argument registers borrow the
+  // caller's references.
+  SmallVector<AsyncValue*, 16> register_values(info->registers.size(),
+                                               nullptr);
+  for (size_t i = 0, e = arguments.size(); i != e; ++i)
+    register_values[i] = arguments[i];
+
+  // Every kernel completes before returning, so the location handler only
+  // needs to outlive the walk.
+  RCReference<BEFLocationHandler> location_handler =
+      TakeRef(host->Construct<BEFLocationHandler>(host, bef_file));
+
+  KernelFrameBuilder kernel_frame(host);
+  kernel_frame.SetAttributeSection(bef_file->attribute_section_);
+  if (auto* token = exec_ctx.cancellation_token())
+    kernel_frame.SetCancellationToken(FormRef(token));
+
+  for (size_t kernel_id = has_args ? 1 : 0,
+              num_kernels = info->kernel_templates.size();
+       kernel_id != num_kernels; ++kernel_id) {
+    const auto& kernel_template = info->kernel_templates[kernel_id];
+    assert(kernel_template.offset % kKernelEntryAlignment == 0);
+    BEFKernel kernel(info->kernels.data() +
+                     kernel_template.offset / kKernelEntryAlignment);
+
+    // Kernels with a direct-call variant skip the kernel frame entirely:
+    // arguments and attributes are passed as raw pointer arrays and the
+    // results come back as available AsyncValues. Function attributes have
+    // no direct representation, so those kernels use the frame below.
+    if (kernel_template.direct_fn && kernel.num_functions() == 0) {
+      int entry_offset = 0;
+      auto kernel_args =
+          kernel.GetKernelEntries(entry_offset, kernel.num_arguments());
+      SmallVector<AsyncValue*, 8> args;
+      args.reserve(kernel_args.size());
+      AsyncValue* any_error_argument = nullptr;
+      for (auto reg_idx : kernel_args) {
+        AsyncValue* value = register_values[reg_idx];
+        assert(value && "inline execution read a register before it was set");
+        if (value->IsError()) any_error_argument = value;
+        args.push_back(value);
+      }
+
+      // The attribute pointers were resolved at decode time, so the direct
+      // call reads them straight out of the function's pointer table.
+      const void* const* attrs = info->attribute_pointers.data() +
+                                 kernel_template.attribute_offset;
+
+      SmallVector<RCReference<AsyncValue>, 4> results;
+      results.resize(kernel.num_results());
+      if (any_error_argument == nullptr) {
+        // Direct-call kernels take their arguments as plain payloads, so an
+        // error argument always propagates; there is no non-strict direct
+        // dispatch.
+        SyncKernelInvocation inv{args.data(), attrs, results.data(), host};
+        kernel_template.direct_fn(inv);
+      } else {
+        for (auto& result : results) result = FormRef(any_error_argument);
+      }
+
+      entry_offset += kernel_args.size() + kernel.num_attributes();
+      auto kernel_results =
+          kernel.GetKernelEntries(entry_offset, kernel.num_results());
+      for (int result_number = 0; result_number < kernel_results.size();
+           ++result_number) {
+        assert(results[result_number] &&
+               "Kernel did not set result AsyncValue");
+        assert(results[result_number]->IsAvailable() &&
+               "synchronous kernel returned an unavailable result");
+        assert(register_values[kernel_results[result_number]] == nullptr &&
+               "inline execution set a register twice");
+        register_values[kernel_results[result_number]] =
+            results[result_number].release();
+      }
+      continue;
+    }
+
+    kernel_frame.Reset();
+
+    AsyncValue* any_error_argument = nullptr;
+
+    // Set up operands.
+    int entry_offset = 0;
+    auto kernel_args =
+        kernel.GetKernelEntries(entry_offset, kernel.num_arguments());
+    for (auto reg_idx : kernel_args) {
+      AsyncValue* value = register_values[reg_idx];
+      assert(value && "inline execution read a register before it was set");
+      kernel_frame.AddArg(value);
+      if (value->IsError()) any_error_argument = value;
+    }
+    kernel_frame.SetNumResults(kernel.num_results());
+
+    // Set up attributes and functions from the pointers resolved at decode
+    // time (see FunctionInfo::attribute_pointers).
+    entry_offset += kernel_args.size();
+    for (const void* attribute :
+         llvm::makeArrayRef(info->attribute_pointers)
+             .slice(kernel_template.attribute_offset,
+                    kernel.num_attributes() + kernel.num_functions()))
+      kernel_frame.AddAttribute(attribute);
+    entry_offset += kernel.num_attributes() + kernel.num_functions();
+
+    // Strict error propagation, as in the general dispatch loop: non-strict
+    // kernels get to see their error arguments.
+    bool is_nonstrict_kernel =
+        static_cast<bool>(kernel.special_metadata() &
+                          static_cast<uint32_t>(SpecialAttribute::kNonStrict));
+    if (any_error_argument == nullptr || is_nonstrict_kernel) {
+      kernel_frame.SetLocation(
+          {location_handler.get(), kernel.kernel_location()});
+      kernel_template.fn(&kernel_frame);
+    } else {
+      for (size_t i = 0, e = kernel_frame.GetNumResults(); i != e; ++i)
+        kernel_frame.SetResultAt(i, FormRef(any_error_argument));
+    }
+
+    // Store the results into the register file.
+    auto kernel_results =
+        kernel.GetKernelEntries(entry_offset, kernel.num_results());
+    for (int result_number = 0; result_number < kernel_results.size();
+         ++result_number) {
+      AsyncValue* result = kernel_frame.GetResultAt(result_number);
+      assert(result && "Kernel did not set result AsyncValue");
+      assert(result->IsAvailable() &&
+             "synchronous kernel returned an unavailable result");
+      assert(register_values[kernel_results[result_number]] == nullptr &&
+             "inline execution set a register twice");
+      register_values[kernel_results[result_number]] = result;
+    }
+  }
+
+  // Populate the function results, then release the references owned by the
+  // register file for the values the body produced.
+  for (size_t i = 0, e = results.size(); i != e; ++i) {
+    AsyncValue* value = register_values[info->result_regs[i]];
+    assert(value && "inline execution left a function result unset");
+    results[i] = FormRef(value);
+  }
+  for (size_t i = arguments.size(), e = register_values.size(); i != e; ++i)
+    if (register_values[i]) register_values[i]->DropRef();
+
+  return true;
+}
+
 //===----------------------------------------------------------------------===//
 // BEFFunction implementation
 //===----------------------------------------------------------------------===//
@@ -644,7 +1433,25 @@ void BEFExecutor::Execute(const BEFFunction& fn,
 void BEFFunction::Execute(ArrayRef<AsyncValue*> arguments,
                           MutableArrayRef<RCReference<AsyncValue>> results,
                           HostContext* host) const {
-  BEFExecutor::Execute(*this, arguments, results, host);
+  Execute(ExecutionContext(host), arguments, results);
+}
+
+void BEFFunction::Execute(
+    const ExecutionContext& exec_ctx, ArrayRef<AsyncValue*> arguments,
+    MutableArrayRef<RCReference<AsyncValue>> results) const {
+  // Small all-synchronous bodies run inline in the calling thread; the
+  // executor machinery is reserved for bodies that need it.
+  if (TryExecuteInline(*this, exec_ctx, arguments, results)) return;
+
+  BEFExecutor::Execute(*this, exec_ctx, arguments, results);
+}
+
+// Execute a batch of invocations of this function, amortizing the fixed
+// per-invocation setup and interleaving the invocations' kernels on the work
+// queue.
+void BEFFunction::ExecuteBatch(ArrayRef<BatchEntry> entries,
+                               HostContext* host) const {
+  BEFExecutor::ExecuteBatch(*this, entries, host);
 }
 
 // To keep this function alive, we have to keep the underlying BEF file alive.
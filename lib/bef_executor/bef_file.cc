@@ -21,13 +21,23 @@
 
 #include "tfrt/bef_executor/bef_file.h"
 
+#include <algorithm>
+#include <cstring>
+#include <string>
+
 #include "bef_file_impl.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/bef_executor/bef_archive.h"
 #include "tfrt/host_context/async_value.h"
 #include "tfrt/host_context/host_context.h"
 #include "tfrt/host_context/location.h"
 #include "tfrt/host_context/native_function.h"
 #include "tfrt/support/bef_encoding.h"
 #include "tfrt/support/bef_reader.h"
+#include "tfrt/support/byte_order.h"
 
 namespace tfrt {
 
@@ -35,15 +45,66 @@ namespace tfrt {
 
 namespace {
 
-// This struct is a simple representation of an entry in FunctionIndex section.
-struct FunctionIndex {
-  FunctionKind kind;
-  size_t function_offset;
-  size_t name_offset;
-  SmallVector<TypeName, 4> arguments;
-  SmallVector<TypeName, 4> results;
+// FNV-1a over raw bytes. The sidecar kernel id cache must be validated with
+// hashes that are stable across processes; llvm::hash_value makes no such
+// guarantee, so we roll our own here.
+uint64_t FnvHash(ArrayRef<uint8_t> data) {
+  uint64_t hash = 14695981039346656037u;
+  for (uint8_t byte : data) {
+    hash ^= byte;
+    hash *= 1099511628211u;
+  }
+  return hash;
+}
+
+// A parsed `<path>.kernel_ids` sidecar cache: the registry ids that the
+// kernel name table of a BEF file resolved to on an earlier load, plus the
+// fingerprints needed to prove the ids are still valid. See
+// BEFFile::OpenFromFile.
+struct KernelIdCache {
+  uint64_t registry_fingerprint;
+  uint64_t kernels_hash;
+  uint64_t strings_hash;
+  ArrayRef<uint32_t> kernel_ids;
 };
 
+const char kKernelIdCacheMagic[4] = {'B', 'K', 'C', '\x01'};
+const char kKernelIdCacheSuffix[] = ".kernel_ids";
+constexpr size_t kKernelIdCacheHeaderSize = 32;
+
+// Decode a sidecar cache file into `cache`. The ArrayRef in `cache` aliases
+// `data`. Returns false if the file is not a structurally valid cache, e.g.
+// it was written by an older binary or a write was interrupted mid-way.
+//
+// Layout (little-endian, naturally aligned):
+//   uint8_t  magic[4]
+//   uint32_t num_kernels
+//   uint64_t registry_fingerprint
+//   uint64_t kernels_hash     FNV-1a of the Kernels section bytes
+//   uint64_t strings_hash     FNV-1a of the Strings section bytes
+//   uint32_t kernel_ids[num_kernels]
+bool ParseKernelIdCache(ArrayRef<uint8_t> data, KernelIdCache* cache) {
+  ASSERT_LITTLE_ENDIAN();
+  if (data.size() < kKernelIdCacheHeaderSize ||
+      memcmp(data.data(), kKernelIdCacheMagic, sizeof(kKernelIdCacheMagic)))
+    return false;
+
+  uint32_t num_kernels = *reinterpret_cast<const uint32_t*>(data.data() + 4);
+  if (data.size() !=
+      kKernelIdCacheHeaderSize + size_t(num_kernels) * sizeof(uint32_t))
+    return false;
+
+  cache->registry_fingerprint =
+      *reinterpret_cast<const uint64_t*>(data.data() + 8);
+  cache->kernels_hash = *reinterpret_cast<const uint64_t*>(data.data() + 16);
+  cache->strings_hash = *reinterpret_cast<const uint64_t*>(data.data() + 24);
+  cache->kernel_ids = llvm::makeArrayRef(
+      reinterpret_cast<const uint32_t*>(data.data() +
+                                        kKernelIdCacheHeaderSize),
+      num_kernels);
+  return true;
+}
+
 // This class is a direct reflection of some of the BEF file contents in memory,
 // expressed with ranges and other helpers to decode them. The BEFFile
 // constructor uses these (combined with the kernel registry) to resolve and
@@ -54,18 +115,26 @@ struct FunctionIndex {
 class BEFFileReader : public BEFReader {
  public:
   BEFFileReader(ArrayRef<uint8_t> file, KernelRegistry* registry,
-                BEFFileImpl* bef_file)
-      : BEFReader(file), registry_(registry), bef_file_(bef_file) {}
+                BEFFileImpl* bef_file, const KernelIdCache* kernel_id_cache)
+      : BEFReader(file),
+        registry_(registry),
+        bef_file_(bef_file),
+        kernel_id_cache_(kernel_id_cache) {}
 
   bool ReadNextSection();
   bool ReadKernelsSection(HostAllocator* host_allocator);
   bool ReadTypesSection();
   bool ReadFunctionIndexSection();
 
+  // Return true if ReadKernelsSection resolved the kernels through the
+  // sidecar id cache instead of the registry's string map.
+  bool used_kernel_id_cache() const { return used_kernel_id_cache_; }
+
  private:
   bool ReadFunctionIndexSectionInternal(
       SmallVectorImpl<FunctionIndex>* function_indices);
   bool ReadFormatVersionSection();
+  bool ResolveKernelsFromIdCache(size_t num_kernels);
   bool DiagnoseUnknownKernel(size_t kernel_idx, const char* kernel_name,
                              HostAllocator* host_allocator);
 
@@ -74,6 +143,10 @@ class BEFFileReader : public BEFReader {
 
   // This is the file structure we're reading.
   BEFFileImpl* bef_file_;
+
+  // An optional sidecar cache of previously resolved kernel ids, or null.
+  const KernelIdCache* kernel_id_cache_;
+  bool used_kernel_id_cache_ = false;
 };
 }  // namespace
 
@@ -156,10 +229,15 @@ bool BEFFileReader::ReadFormatVersionSection() {
   // In the case of the FormatVersion section, we verify that we have a
   // supported version.
   uint8_t version;
-  if (ReadByte(&version) || version != kBEFVersion0)
+  if (ReadByte(&version) ||
+      (version != kBEFVersion0 && version != kBEFVersion1))
     return bef_file_->EmitFormatError("BEF file has unknown version number"),
            true;
 
+  // Version 1 files store the function header tables as fixed-width uint32
+  // entries; see DecodeFunctionInfo.
+  bef_file_->fixed_width_function_tables_ = version == kBEFVersion1;
+
   // TODO: Should have per-file location info in the header.
   return false;
 }
@@ -198,11 +276,12 @@ bool BEFFileReader::DiagnoseUnknownKernel(size_t kernel_idx,
     HostArray<BEFFileImpl::KernelInfo> kernel_infos;
     result_regs.clear();
     size_t location_offset;
-    auto kernels = bef_file_->ReadFunction(
+    const auto* function_info = bef_file_->ReadFunction(
         function_index.function_offset, function_index.results,
         &location_offset, &register_infos, &kernel_infos, &result_regs,
         host_allocator);
-    if (kernels.empty()) continue;
+    if (!function_info) continue;
+    ArrayRef<uint32_t> kernels = function_info->kernels;
 
     // Decode all of the kernels to see if any refers to our unknown kernel.
     MutableArrayRef<BEFFileImpl::KernelInfo>& kernel_infos_array =
@@ -243,15 +322,25 @@ bool BEFFileReader::ReadKernelsSection(HostAllocator* host_allocator) {
   if (reader.ReadInt(&num_kernels)) return format_error();
 
   bef_file_->kernels_.reserve(num_kernels);
+  bef_file_->sync_kernels_.reserve(num_kernels);
+  bef_file_->direct_sync_kernels_.reserve(num_kernels);
+  bef_file_->kernel_signatures_.reserve(num_kernels);
+
+  // A validated sidecar cache lets us resolve every kernel with an indexed
+  // load instead of hashing its name (see BEFFile::OpenFromFile).
+  if (ResolveKernelsFromIdCache(num_kernels)) return false;
+
   while (num_kernels--) {
     // Each kernel is encoded as an offset into the string table of the
     // kernel name.
     size_t kernel_name_offset;
+    if (reader.ReadInt(&kernel_name_offset)) return format_error();
 
     // Make sure the kernel name is valid.
-    if (reader.ReadInt(&kernel_name_offset) ||
+    if (!bef_file_->trusted_ &&
         kernel_name_offset >= bef_file_->string_section_.size())
       return format_error();
+    assert(kernel_name_offset < bef_file_->string_section_.size());
 
     // If this is an unknown kernel, bail out.
     const char* kernel_name = reinterpret_cast<const char*>(
@@ -263,13 +352,59 @@ bool BEFFileReader::ReadKernelsSection(HostAllocator* host_allocator) {
                                    host_allocator);
     }
 
-    // Otherwise remember it.
+    // Otherwise remember it, along with whether it is synchronous and its
+    // direct-call variant, if any.
     bef_file_->kernels_.push_back(kernel);
+    bef_file_->sync_kernels_.push_back(registry_->IsSyncKernel(kernel_name));
+    bef_file_->direct_sync_kernels_.push_back(
+        registry_->GetDirectSyncKernel(kernel_name));
+    bef_file_->kernel_signatures_.push_back(
+        registry_->GetKernelSignature(kernel_name));
   }
 
   return false;
 }
 
+// Resolve the kernels through the sidecar id cache, if one was supplied and
+// it provably matches both this file and this process's registry. Returns
+// true on success; on any mismatch the caller falls back to resolving names
+// through the registry's string map (and the cache gets rewritten).
+bool BEFFileReader::ResolveKernelsFromIdCache(size_t num_kernels) {
+  const KernelIdCache* cache = kernel_id_cache_;
+  if (!cache) return false;
+
+  // The registry fingerprint ties the cached ids to this binary's
+  // registration order, and the section hashes tie them to this exact file.
+  if (cache->kernel_ids.size() != num_kernels ||
+      cache->registry_fingerprint != registry_->GetFingerprint() ||
+      cache->kernels_hash != FnvHash(bef_file_->kernels_section_) ||
+      cache->strings_hash != FnvHash(bef_file_->string_section_))
+    return false;
+
+  for (uint32_t kernel_id : cache->kernel_ids) {
+    auto* kernel = registry_->GetKernelById(kernel_id);
+    if (!kernel) {
+      // Defensive: a matching registry fingerprint should make an out of
+      // range id impossible.
+      bef_file_->kernels_.clear();
+      bef_file_->sync_kernels_.clear();
+      bef_file_->direct_sync_kernels_.clear();
+      bef_file_->kernel_signatures_.clear();
+      return false;
+    }
+    bef_file_->kernels_.push_back(kernel);
+    bef_file_->sync_kernels_.push_back(
+        registry_->IsSyncKernelById(kernel_id));
+    bef_file_->direct_sync_kernels_.push_back(
+        registry_->GetDirectSyncKernelById(kernel_id));
+    bef_file_->kernel_signatures_.push_back(
+        registry_->GetKernelSignatureById(kernel_id));
+  }
+
+  used_kernel_id_cache_ = true;
+  return true;
+}
+
 // Read the Types section from a BEF file, resolving the types and returning
 // false on success.  Emit an error and return true on failure.
 bool BEFFileReader::ReadTypesSection() {
@@ -287,11 +422,13 @@ bool BEFFileReader::ReadTypesSection() {
   while (num_types--) {
     // Each type is encoded as an offset into the string table of the type name.
     size_t type_name_offset;
+    if (reader.ReadInt(&type_name_offset)) return format_error();
 
-    // Make sure the kernel name is valid.
-    if (reader.ReadInt(&type_name_offset) ||
+    // Make sure the type name is valid.
+    if (!bef_file_->trusted_ &&
         type_name_offset >= bef_file_->string_section_.size())
       return format_error();
+    assert(type_name_offset < bef_file_->string_section_.size());
 
     // If this is an unknown type, bail out.
     const char* type_name_str = reinterpret_cast<const char*>(
@@ -342,7 +479,9 @@ bool BEFFileReader::ReadFunctionIndexSectionInternal(
       size_t arg_type;
       if (reader.ReadInt(&arg_type)) return true;
 
-      if (arg_type >= bef_file_->type_names_.size()) return true;
+      if (!bef_file_->trusted_ && arg_type >= bef_file_->type_names_.size())
+        return true;
+      assert(arg_type < bef_file_->type_names_.size());
       function_index.arguments.push_back(bef_file_->type_names_[arg_type]);
     }
 
@@ -354,7 +493,10 @@ bool BEFFileReader::ReadFunctionIndexSectionInternal(
       size_t result_type;
       if (reader.ReadInt(&result_type)) return true;
 
-      if (result_type >= bef_file_->type_names_.size()) return true;
+      if (!bef_file_->trusted_ &&
+          result_type >= bef_file_->type_names_.size())
+        return true;
+      assert(result_type < bef_file_->type_names_.size());
       function_index.results.push_back(bef_file_->type_names_[result_type]);
     }
   }
@@ -362,51 +504,56 @@ bool BEFFileReader::ReadFunctionIndexSectionInternal(
   return false;
 }
 
-// Read the FunctionIndex section from a BEF file, building the functions_ table
-// and the function_symbol_table_, and returning false on success. Emit an error
-// and return true on failure.
+// Read the FunctionIndex section from a BEF file, building the
+// function_symbol_table_ and recording the decoded index entries, and
+// returning false on success. Emit an error and return true on failure.
+//
+// BEF function objects are materialized lazily on first lookup (see
+// BEFFileImpl::GetOrMaterializeFunction): a large BEF file can contain
+// hundreds of entry points of which only a handful are ever called, and
+// constructing all of them up front shows up in cold-start time. Native
+// functions are the exception: they are resolved here so that a native
+// function missing from the registry fails Open instead of first use.
 bool BEFFileReader::ReadFunctionIndexSection() {
   auto format_error = [&]() -> bool {
     bef_file_->EmitFormatError("invalid FunctionIndex section in BEF file");
     return true;
   };
 
-  SmallVector<FunctionIndex, 8> function_indices;
-  if (ReadFunctionIndexSectionInternal(&function_indices))
+  if (ReadFunctionIndexSectionInternal(&bef_file_->function_indices_))
     return format_error();
 
-  bef_file_->functions_.reserve(function_indices.size());
+  // Reserve the (initially null) slots for the lazily created functions.
+  mutex_lock lock(bef_file_->functions_mu_);
+  bef_file_->functions_.resize(bef_file_->function_indices_.size());
+
+  for (const auto& function_index : bef_file_->function_indices_) {
+    // Validate the function offsets eagerly, so a malformed file is
+    // diagnosed when it is opened rather than on first execution.
+    if (!bef_file_->trusted_ &&
+        function_index.kind == FunctionKind::kBEFFunction &&
+        function_index.function_offset >= bef_file_->function_section_.size())
+      return format_error();
 
-  for (const auto& function_index : function_indices) {
     // Put named functions in the function_symbol_table_.
     const char* name = reinterpret_cast<const char*>(
         &bef_file_->string_section_[function_index.name_offset]);
-    if (*name)
-      bef_file_->function_symbol_table_[name] = bef_file_->functions_.size();
-
-    // TODO(tf-runtime-team): Consider adding a factory for functions.
-    switch (function_index.kind) {
-      case FunctionKind::kBEFFunction: {
-        if (function_index.function_offset >=
-            bef_file_->function_section_.size())
-          return format_error();
-        auto bef_function = std::make_unique<BEFFunction>(
-            name, function_index.arguments, function_index.results,
-            function_index.function_offset, bef_file_);
-        bef_file_->functions_.push_back(std::move(bef_function));
-        break;
-      }
-      case FunctionKind::kNativeFunction: {
-        auto callable = NativeFunctionRegistry::GetGlobalRegistry().Get(name);
-        if (callable == nullptr) {
-          bef_file_->EmitFormatError(
-              "unable to find native function in global registry");
-          return true;
-        }
-        bef_file_->functions_.push_back(std::make_unique<NativeFunction>(
-            name, function_index.arguments, function_index.results, callable));
-        break;
+    size_t index = &function_index - bef_file_->function_indices_.data();
+    if (*name) bef_file_->function_symbol_table_[name] = index;
+
+    // Native functions are resolved against the global registry eagerly:
+    // the lookup needs no function body decode, and failing here keeps a
+    // missing native function a load-time error instead of a null Function
+    // handed to callers on first use.
+    if (function_index.kind == FunctionKind::kNativeFunction) {
+      auto callable = NativeFunctionRegistry::GetGlobalRegistry().Get(name);
+      if (callable == nullptr) {
+        bef_file_->EmitFormatError(
+            "unable to find native function in global registry");
+        return true;
       }
+      bef_file_->functions_[index] = std::make_unique<NativeFunction>(
+          name, function_index.arguments, function_index.results, callable);
     }
   }
 
@@ -417,14 +564,20 @@ bool BEFFileReader::ReadFunctionIndexSection() {
 
 BEFFile::~BEFFile() {}
 
-RCReference<BEFFile> BEFFile::Open(ArrayRef<uint8_t> file,
-                                   KernelRegistry* registry,
-                                   ErrorHandler error_handler,
-                                   tfrt::HostAllocator* host_allocator) {
+// Shared implementation of Open and OpenFromFile. `kernel_id_cache` is an
+// optional parsed sidecar cache (or null); `used_kernel_id_cache` reports
+// whether the cache actually got used.
+static RCReference<BEFFile> OpenImpl(
+    ArrayRef<uint8_t> file, KernelRegistry* registry,
+    BEFFile::ErrorHandler error_handler, tfrt::HostAllocator* host_allocator,
+    BEFFile::LoadMode load_mode, const KernelIdCache* kernel_id_cache,
+    bool* used_kernel_id_cache) {
   auto* bef_impl = new BEFFileImpl(error_handler);
   auto bef_rc = TakeRef(bef_impl);
 
-  BEFFileReader reader(file, registry, bef_impl);
+  bef_impl->trusted_ = load_mode == BEFFile::LoadMode::kTrusted;
+
+  BEFFileReader reader(file, registry, bef_impl, kernel_id_cache);
 
   uint8_t header[2];
 
@@ -445,10 +598,149 @@ RCReference<BEFFile> BEFFile::Open(ArrayRef<uint8_t> file,
       reader.ReadFunctionIndexSection())
     return {};
 
+  if (used_kernel_id_cache)
+    *used_kernel_id_cache = reader.used_kernel_id_cache();
+
   // Now that we decoded the whole thing, return the BEFFile to the caller.
   return bef_rc;
 }
 
+RCReference<BEFFile> BEFFile::Open(ArrayRef<uint8_t> file,
+                                   KernelRegistry* registry,
+                                   ErrorHandler error_handler,
+                                   tfrt::HostAllocator* host_allocator,
+                                   LoadMode load_mode) {
+  return OpenImpl(file, registry, std::move(error_handler), host_allocator,
+                  load_mode, /*kernel_id_cache=*/nullptr,
+                  /*used_kernel_id_cache=*/nullptr);
+}
+
+// Serialize the kernel ids that `bef` resolved into the sidecar cache file
+// at `cache_path`; see ParseKernelIdCache for the layout. The cache is a
+// pure optimization, so failures here are silently ignored, and a write
+// that is interrupted mid-way fails the size check in ParseKernelIdCache on
+// the next load.
+static void WriteKernelIdCache(const std::string& cache_path, BEFFileImpl* bef,
+                               KernelRegistry* registry) {
+  // Re-walk the kernel name table to recover the resolved ids. This only
+  // runs on the first (cold) load of a file.
+  BEFReader reader(bef->kernels_section_);
+  size_t num_kernels;
+  if (reader.ReadInt(&num_kernels)) return;
+
+  SmallVector<uint32_t, 16> kernel_ids;
+  kernel_ids.reserve(num_kernels);
+  while (num_kernels--) {
+    size_t kernel_name_offset;
+    if (reader.ReadInt(&kernel_name_offset)) return;
+    const char* kernel_name = reinterpret_cast<const char*>(
+        &bef->string_section_[kernel_name_offset]);
+    ssize_t kernel_id = registry->GetKernelId(kernel_name);
+    if (kernel_id < 0) return;
+    kernel_ids.push_back(static_cast<uint32_t>(kernel_id));
+  }
+
+  std::error_code error_code;
+  llvm::raw_fd_ostream os(cache_path, error_code, llvm::sys::fs::OF_None);
+  if (error_code) return;
+
+  auto write32 = [&](uint32_t value) {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+  auto write64 = [&](uint64_t value) {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+  ASSERT_LITTLE_ENDIAN();
+  os.write(kKernelIdCacheMagic, sizeof(kKernelIdCacheMagic));
+  write32(static_cast<uint32_t>(kernel_ids.size()));
+  write64(registry->GetFingerprint());
+  write64(FnvHash(bef->kernels_section_));
+  write64(FnvHash(bef->string_section_));
+  os.write(reinterpret_cast<const char*>(kernel_ids.data()),
+           kernel_ids.size() * sizeof(uint32_t));
+}
+
+RCReference<BEFFile> BEFFile::OpenFromFile(
+    string_view path, KernelRegistry* registry, ErrorHandler error_handler,
+    tfrt::HostAllocator* host_allocator, LoadMode load_mode,
+    bool use_kernel_id_cache) {
+  // Large files are memory mapped rather than read into an allocated buffer:
+  // no copy is made, the mapping is page aligned, and sections that are never
+  // touched are never paged in. We do not require a null terminator, which
+  // would force a copy whenever the file size is a multiple of the page size.
+  auto buffer_or_error = llvm::MemoryBuffer::getFile(
+      path, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+  if (!buffer_or_error) {
+    std::string message = "cannot open BEF file '" + path.str() +
+                          "': " + buffer_or_error.getError().message();
+    error_handler(DecodedDiagnostic(message));
+    return {};
+  }
+
+  auto buffer = std::move(*buffer_or_error);
+
+  // Try to load the kernel id sidecar cache. A missing or unparseable cache
+  // is not an error; we resolve kernels the slow way and then write one.
+  std::string cache_path;
+  std::unique_ptr<llvm::MemoryBuffer> cache_buffer;
+  KernelIdCache kernel_id_cache;
+  bool have_kernel_id_cache = false;
+  if (use_kernel_id_cache) {
+    cache_path = path.str() + kKernelIdCacheSuffix;
+    auto cache_or_error = llvm::MemoryBuffer::getFile(
+        cache_path, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+    if (cache_or_error) {
+      cache_buffer = std::move(*cache_or_error);
+      have_kernel_id_cache = ParseKernelIdCache(
+          llvm::makeArrayRef(
+              reinterpret_cast<const uint8_t*>(cache_buffer->getBufferStart()),
+              cache_buffer->getBufferSize()),
+          &kernel_id_cache);
+    }
+  }
+
+  bool used_kernel_id_cache = false;
+  auto file = OpenImpl(
+      llvm::makeArrayRef(
+          reinterpret_cast<const uint8_t*>(buffer->getBufferStart()),
+          buffer->getBufferSize()),
+      registry, std::move(error_handler), host_allocator, load_mode,
+      have_kernel_id_cache ? &kernel_id_cache : nullptr,
+      &used_kernel_id_cache);
+  if (!file) return file;
+
+  // The section ArrayRefs inside the file alias the mapping, so hand the
+  // mapping over to the file to keep it alive.
+  auto* bef_impl = static_cast<BEFFileImpl*>(file.get());
+  bef_impl->file_buffer_ = std::move(buffer);
+
+  // Write (or refresh) the sidecar cache so the next load of this file
+  // skips string resolution entirely.
+  if (use_kernel_id_cache && !used_kernel_id_cache)
+    WriteKernelIdCache(cache_path, bef_impl, registry);
+
+  return file;
+}
+
+bool BEFFile::Validate(ArrayRef<uint8_t> file, KernelRegistry* registry,
+                       ErrorHandler error_handler,
+                       tfrt::HostAllocator* host_allocator) {
+  auto bef = Open(file, registry, error_handler, host_allocator,
+                  LoadMode::kVerified);
+  if (!bef) return false;
+
+  // Open validates the sections and the function index; additionally decode
+  // every function body, which Open defers to first execution.
+  auto* bef_impl = static_cast<BEFFileImpl*>(bef.get());
+  for (const auto& function_index : bef_impl->function_indices_) {
+    if (function_index.kind != FunctionKind::kBEFFunction) continue;
+    if (!bef_impl->GetFunctionInfo(function_index.function_offset,
+                                   function_index.results.size()))
+      return false;
+  }
+  return true;
+}
+
 BEFFileImpl::BEFFileImpl(std::function<void(DecodedDiagnostic)> error_handler)
     : error_handler_(error_handler) {}
 
@@ -458,67 +750,386 @@ void BEFFileImpl::EmitFormatError(const char* message) {
   error_handler_(DecodedDiagnostic(message));
 }
 
-ArrayRef<uint32_t> BEFFileImpl::ReadFunction(
-    size_t function_offset, ArrayRef<TypeName> results, size_t* location_offset,
-    HostArray<RegisterInfo>* register_infos,
-    HostArray<KernelInfo>* kernel_infos, SmallVectorImpl<size_t>* result_regs,
-    HostAllocator* host_allocator) {
-  auto format_error = [&]() -> ArrayRef<uint32_t> {
+std::unique_ptr<BEFFileImpl::FunctionInfo> BEFFileImpl::DecodeFunctionInfo(
+    size_t function_offset, size_t num_results) {
+  auto format_error = [&]() -> std::unique_ptr<FunctionInfo> {
     EmitFormatError("invalid Function section in BEF file");
-    return {};
+    return nullptr;
   };
 
   if (function_offset >= function_section_.size()) return format_error();
 
+  auto info = std::make_unique<FunctionInfo>();
+
   BEFReader reader(function_section_.drop_front(function_offset));
 
-  // First we have the location info and register info table.
-  size_t num_registers;
-  if (reader.ReadInt(location_offset) || reader.ReadInt(&num_registers))
-    return format_error();
+  if (fixed_width_function_tables_) {
+    // Version 1 files store the header tables as 4-byte aligned uint32
+    // entries, so each table can be consumed with a bounds check and a bulk
+    // aligned read instead of the byte-at-a-time VBR loop.
+    auto read_fixed32_array = [&](size_t count) -> const uint32_t* {
+      if (reader.ReadAlignment(kKernelEntryAlignment) ||
+          reader.file().size() < count * sizeof(uint32_t))
+        return nullptr;
+      const uint32_t* data =
+          reinterpret_cast<const uint32_t*>(reader.file().data());
+      reader.SkipOffset(count * sizeof(uint32_t));
+      return data;
+    };
+
+    uint32_t value;
+    if (reader.ReadInt4(&value)) return format_error();
+    info->location_offset = value;
+
+    if (reader.ReadInt4(&value)) return format_error();
+    size_t num_registers = value;
+    const uint32_t* user_counts = read_fixed32_array(num_registers);
+    if (!user_counts) return format_error();
+    info->registers.reserve(num_registers);
+    for (size_t i = 0; i != num_registers; ++i)
+      info->registers.push_back({user_counts[i], /*is_shared=*/false});
+
+    if (reader.ReadInt4(&value)) return format_error();
+    size_t num_kernels = value;
+    const uint32_t* kernel_entries = read_fixed32_array(num_kernels * 2);
+    if (!kernel_entries) return format_error();
+    info->kernel_templates.reserve(num_kernels);
+    for (size_t i = 0; i != num_kernels; ++i)
+      info->kernel_templates.push_back({nullptr, nullptr, /*is_sync=*/false,
+                                        /*is_strict=*/false,
+                                        kernel_entries[2 * i],
+                                        kernel_entries[2 * i + 1], 0, 0});
+
+    const uint32_t* result_regs = read_fixed32_array(num_results);
+    if (!result_regs) return format_error();
+    info->result_regs.reserve(num_results);
+    for (size_t i = 0; i != num_results; ++i) {
+      if (!trusted_ && result_regs[i] >= info->registers.size())
+        return format_error();
+      assert(result_regs[i] < info->registers.size());
+      info->result_regs.push_back(result_regs[i]);
+    }
+  } else {
+    // First we have the location info and register info table.
+    size_t num_registers;
+    if (reader.ReadInt(&info->location_offset) ||
+        reader.ReadInt(&num_registers))
+      return format_error();
 
-  *register_infos = HostArray<RegisterInfo>(num_registers, host_allocator);
-  auto* register_info_ptr = register_infos->mutable_array().data();
-  unsigned register_idx = 0;
-  while (num_registers--) {
-    size_t user_count;
-    if (reader.ReadInt(&user_count)) return format_error();
-    new (register_info_ptr + register_idx) RegisterInfo(user_count);
-    ++register_idx;
-  }
+    info->registers.reserve(num_registers);
+    while (num_registers--) {
+      size_t user_count;
+      if (reader.ReadInt(&user_count)) return format_error();
+      info->registers.push_back({unsigned(user_count), /*is_shared=*/false});
+    }
 
-  // Next we have the kernel index table.
-  size_t num_kernels;
-  if (reader.ReadInt(&num_kernels)) return format_error();
+    // Next we have the kernel index table.
+    size_t num_kernels;
+    if (reader.ReadInt(&num_kernels)) return format_error();
 
-  *kernel_infos = HostArray<KernelInfo>(num_kernels, host_allocator);
-  auto* kernel_info_ptr = kernel_infos->mutable_array().data();
-  unsigned kernel_idx = 0;
-  while (num_kernels--) {
-    size_t offset, num_operands;
-    if (reader.ReadInt(&offset) || reader.ReadInt(&num_operands))
-      return format_error();
-    new (kernel_info_ptr + kernel_idx)
-        KernelInfo(unsigned(offset), unsigned(num_operands));
-    ++kernel_idx;
-  }
+    info->kernel_templates.reserve(num_kernels);
+    while (num_kernels--) {
+      size_t offset, num_operands;
+      if (reader.ReadInt(&offset) || reader.ReadInt(&num_operands))
+        return format_error();
+      info->kernel_templates.push_back(
+          {nullptr, nullptr, /*is_sync=*/false, /*is_strict=*/false,
+           unsigned(offset), unsigned(num_operands), 0, 0});
+    }
 
-  // Read the result registers.
-  result_regs->reserve(results.size());
-  for (unsigned i = 0, e = results.size(); i != e; ++i) {
-    size_t result_reg;
-    if (reader.ReadInt(&result_reg) || result_reg >= register_infos->size())
-      return format_error();
-    result_regs->push_back(result_reg);
+    // Read the result registers.
+    info->result_regs.reserve(num_results);
+    for (unsigned i = 0, e = num_results; i != e; ++i) {
+      size_t result_reg;
+      if (reader.ReadInt(&result_reg)) return format_error();
+      if (!trusted_ && result_reg >= info->registers.size())
+        return format_error();
+      assert(result_reg < info->registers.size());
+      info->result_regs.push_back(result_reg);
+    }
   }
 
   // Kernels are aligned to kKernelEntryAlignment.
   if (reader.ReadAlignment(kKernelEntryAlignment)) return format_error();
 
   // We found the start of our kernel section.
-  return llvm::makeArrayRef(
+  info->kernels = llvm::makeArrayRef(
       reinterpret_cast<const uint32_t*>(reader.file().begin()),
       reader.file().size() / kKernelEntryAlignment);
+
+  // Function result registers are shared because the caller creates their
+  // cells up front.
+  for (size_t result_reg : info->result_regs)
+    info->registers[result_reg].is_shared = true;
+
+  for (auto& kernel_template : info->kernel_templates) {
+    assert(kernel_template.offset % kKernelEntryAlignment == 0);
+    BEFKernel kernel(info->kernels.data() +
+                     kernel_template.offset / kKernelEntryAlignment);
+
+    // Resolve the kernel implementation so the executor's inner loop is a
+    // direct indexed call. When decoding runs during load-time diagnosis of
+    // an unknown kernel, the kernels_ table may not be fully populated yet;
+    // a null fn is fine because the file fails to open in that case.
+    if (kernel.kernel_code() < kernels_.size()) {
+      kernel_template.fn = kernels_[kernel.kernel_code()];
+      kernel_template.is_sync = sync_kernels_[kernel.kernel_code()];
+      kernel_template.direct_fn = direct_sync_kernels_[kernel.kernel_code()];
+    }
+
+    // Strictness is a property of the call site (see KernelTemplate's
+    // is_strict); decode it once so the executor's error sweep can test it
+    // without touching the kernel header.
+    kernel_template.is_strict =
+        !(kernel.special_metadata() &
+          static_cast<uint32_t>(SpecialAttribute::kNonStrict));
+
+    // Resolve the kernel's attribute payload pointers and function
+    // attributes once; executions copy this span instead of re-walking the
+    // kernel entries (see FunctionInfo::attribute_pointers).
+    kernel_template.attribute_offset = info->attribute_pointers.size();
+    int attr_entry_offset = kernel.num_arguments();
+    for (uint32_t attribute_offset : kernel.GetKernelEntries(
+             attr_entry_offset, kernel.num_attributes()))
+      info->attribute_pointers.push_back(attribute_section_.data() +
+                                         attribute_offset);
+    attr_entry_offset += kernel.num_attributes();
+    for (uint32_t fn_idx : kernel.GetKernelEntries(attr_entry_offset,
+                                                   kernel.num_functions())) {
+      // As with kernels_ above, the function index may not be populated yet
+      // when decoding runs during load-time diagnosis of a malformed file;
+      // a null entry is fine because the file fails to open in that case.
+      info->attribute_pointers.push_back(
+          fn_idx < function_indices_.size() ? GetOrMaterializeFunction(fn_idx)
+                                            : nullptr);
+    }
+
+    // Classify each register as thread-local or shared (see
+    // RegisterInfo::is_shared). A register cell is only contended if a
+    // consumer can look it up before the producer has written it, which
+    // requires the consumer to start before all of its arguments are
+    // available: that is possible only for kernels with more than one
+    // argument (error propagation can force them ready early, and
+    // non-strict kernels start early by design).
+    if (kernel.num_arguments() == 1) continue;
+    for (uint32_t reg_idx :
+         kernel.GetKernelEntries(0, kernel.num_arguments()))
+      info->registers[reg_idx].is_shared = true;
+  }
+
+  // Validate each call site against the signature its kernel registered
+  // (see KernelSignature). This runs once, when the function is decoded, so
+  // dispatch itself never checks argument, attribute or result counts -
+  // the per-invocation accessors stay as debug asserts. Kernel 0 is
+  // exempted: when the function has arguments it is the pseudo kernel,
+  // which is never dispatched. Trusted loads skip this like the other
+  // validation-only checks.
+  if (!trusted_) {
+    for (size_t i = 1, e = info->kernel_templates.size(); i < e; ++i) {
+      const auto& kernel_template = info->kernel_templates[i];
+      BEFKernel kernel(info->kernels.data() +
+                       kernel_template.offset / kKernelEntryAlignment);
+      size_t kernel_code = kernel.kernel_code();
+      if (kernel_code >= kernel_signatures_.size()) continue;
+      const KernelSignature& signature = kernel_signatures_[kernel_code];
+
+      // A call site may pass one extra trailing argument: a chain that
+      // sequences the kernel without being consumed by it. Function
+      // attributes travel in the attribute list of the call site.
+      bool arguments_ok =
+          signature.num_arguments == KernelSignature::kUnchecked ||
+          kernel.num_arguments() == signature.num_arguments ||
+          kernel.num_arguments() == signature.num_arguments + 1;
+      bool attributes_ok =
+          signature.num_attributes == KernelSignature::kUnchecked ||
+          kernel.num_attributes() + kernel.num_functions() ==
+              signature.num_attributes;
+      bool results_ok =
+          signature.num_results == KernelSignature::kUnchecked ||
+          kernel.num_results() == signature.num_results;
+      if (arguments_ok && attributes_ok && results_ok) continue;
+
+      std::string error_message =
+          "kernel '" + std::string(GetKernelName(kernel_code)) +
+          "' invoked with " + std::to_string(kernel.num_arguments()) +
+          " arguments, " +
+          std::to_string(kernel.num_attributes() + kernel.num_functions()) +
+          " attributes and " + std::to_string(kernel.num_results()) +
+          " results; it expects " +
+          std::to_string(signature.num_arguments) + ", " +
+          std::to_string(signature.num_attributes) + " and " +
+          std::to_string(signature.num_results);
+      error_handler_(DecodedDiagnostic(
+          DecodeLocation(kernel.kernel_location()), error_message));
+      return nullptr;
+    }
+  }
+
+  // Classify the function for inline execution (see
+  // FunctionInfo::inline_executable). Kernel 0 is exempted: when the
+  // function has arguments it is the pseudo kernel, which is never
+  // dispatched, and for argument-less functions it is checked at execution
+  // time.
+  info->inline_executable =
+      !info->kernel_templates.empty() &&
+      info->kernel_templates.size() <= FunctionInfo::kMaxInlineKernels;
+  for (size_t i = 1, e = info->kernel_templates.size(); i < e; ++i) {
+    const auto& t = info->kernel_templates[i];
+    if (!t.fn || !t.is_sync) {
+      info->inline_executable = false;
+      break;
+    }
+  }
+
+  // Compute each kernel's height - the length of the longest chain of
+  // dependent kernels downstream of it (see KernelTemplate::height).
+  // Kernels are emitted in program order, so every user appears after its
+  // producer and a single reverse pass suffices.
+  for (size_t i = info->kernel_templates.size(); i != 0;) {
+    auto& kernel_template = info->kernel_templates[--i];
+    BEFKernel kernel(info->kernels.data() +
+                     kernel_template.offset / kKernelEntryAlignment);
+
+    unsigned height = 0;
+    int entry_offset = kernel.num_arguments() + kernel.num_attributes() +
+                       kernel.num_functions() + kernel.num_results();
+    for (int result = 0, e = kernel.num_results(); result != e; ++result) {
+      auto num_used_bys = kernel.num_used_bys(result);
+      for (uint32_t user :
+           kernel.GetKernelEntries(entry_offset, num_used_bys)) {
+        height =
+            std::max(height, info->kernel_templates[user].height + 1);
+      }
+      entry_offset += num_used_bys;
+    }
+    kernel_template.height = height;
+  }
+
+  return info;
+}
+
+const BEFFileImpl::FunctionInfo* BEFFileImpl::GetFunctionInfo(
+    size_t function_offset, size_t num_results) {
+  mutex_lock lock(function_info_mu_);
+  auto& slot = function_infos_[function_offset];
+  // Decode failures are not cached, so a malformed function re-emits its
+  // error on every call; this only matters on broken files.
+  if (!slot) slot = DecodeFunctionInfo(function_offset, num_results);
+  return slot.get();
+}
+
+const BEFFileImpl::FunctionInfo* BEFFileImpl::GetFunctionInfo(
+    const BEFFunction& fn) {
+  // Fast path: the function caches its own decoded info, so concurrent
+  // invocations do not serialize on function_info_mu_. FunctionInfos are
+  // owned by function_infos_ and have stable addresses, and publication
+  // through the release store pairs with the acquire load.
+  if (const void* cached =
+          fn.cached_function_info_.load(std::memory_order_acquire))
+    return static_cast<const FunctionInfo*>(cached);
+
+  const FunctionInfo* info =
+      GetFunctionInfo(fn.function_offset(), fn.result_types().size());
+  if (info)
+    fn.cached_function_info_.store(info, std::memory_order_release);
+  return info;
+}
+
+const BEFFileImpl::FunctionInfo* BEFFileImpl::ReadFunction(
+    size_t function_offset, ArrayRef<TypeName> results, size_t* location_offset,
+    HostArray<RegisterInfo>* register_infos,
+    HostArray<KernelInfo>* kernel_infos, SmallVectorImpl<size_t>* result_regs,
+    HostAllocator* host_allocator) {
+  const FunctionInfo* info = GetFunctionInfo(function_offset, results.size());
+  return InitializeExecutionState(info, location_offset, register_infos,
+                                  kernel_infos, result_regs, host_allocator);
+}
+
+const BEFFileImpl::FunctionInfo* BEFFileImpl::ReadFunction(
+    const BEFFunction& fn, size_t* location_offset,
+    HostArray<RegisterInfo>* register_infos,
+    HostArray<KernelInfo>* kernel_infos, SmallVectorImpl<size_t>* result_regs,
+    HostAllocator* host_allocator) {
+  const FunctionInfo* info = GetFunctionInfo(fn);
+  return InitializeExecutionState(info, location_offset, register_infos,
+                                  kernel_infos, result_regs, host_allocator);
+}
+
+const BEFFileImpl::FunctionInfo* BEFFileImpl::InitializeExecutionState(
+    const FunctionInfo* info, size_t* location_offset,
+    HostArray<RegisterInfo>* register_infos,
+    HostArray<KernelInfo>* kernel_infos, SmallVectorImpl<size_t>* result_regs,
+    HostAllocator* host_allocator) {
+  if (!info) return nullptr;
+
+  *location_offset = info->location_offset;
+
+  // Reuse a retired execution state when one is pooled: the arrays have
+  // identical shape for every execution of the function, and reusing them
+  // skips the allocation and the first-touch page faults of a cold register
+  // file. The placement-news below fully reinitialize the reused elements.
+  bool reused_state = false;
+  {
+    mutex_lock lock(info->state_pool_mu);
+    if (!info->state_pool.empty()) {
+      auto state = std::move(info->state_pool.back());
+      info->state_pool.pop_back();
+      *register_infos = std::move(state.register_infos);
+      *kernel_infos = std::move(state.kernel_infos);
+      reused_state = true;
+    }
+  }
+  assert(!reused_state || (register_infos->size() == info->registers.size() &&
+                           kernel_infos->size() ==
+                               info->kernel_templates.size()));
+
+  // Initialize the mutable per-execution register cells and kernel ready
+  // counts from the cached template.
+  if (!reused_state)
+    *register_infos =
+        HostArray<RegisterInfo>(info->registers.size(), host_allocator);
+  auto* register_info_ptr = register_infos->mutable_array().data();
+  for (size_t i = 0, e = info->registers.size(); i != e; ++i) {
+    const auto& reg = info->registers[i];
+    auto* register_info = new (register_info_ptr + i)
+        RegisterInfo(reg.user_count);
+    register_info->is_shared = reg.is_shared;
+  }
+
+  if (!reused_state)
+    *kernel_infos =
+        HostArray<KernelInfo>(info->kernel_templates.size(), host_allocator);
+  auto* kernel_info_ptr = kernel_infos->mutable_array().data();
+  for (size_t i = 0, e = info->kernel_templates.size(); i != e; ++i) {
+    const auto& kernel_template = info->kernel_templates[i];
+    new (kernel_info_ptr + i)
+        KernelInfo(kernel_template.offset, kernel_template.num_operands);
+  }
+
+  result_regs->assign(info->result_regs.begin(), info->result_regs.end());
+
+  return info;
+}
+
+BEFFileImpl::FunctionInfo::~FunctionInfo() {
+  // Free a parked executor instance (see cached_executor). A parked executor
+  // holds no file references, so it cannot outlive the file and must be
+  // freed with it.
+  if (void* executor = cached_executor.load(std::memory_order_acquire))
+    cached_executor_deleter.load(std::memory_order_relaxed)(executor);
+}
+
+void BEFFileImpl::ReturnFunctionState(const FunctionInfo* info,
+                                      HostArray<RegisterInfo> register_infos,
+                                      HostArray<KernelInfo> kernel_infos) {
+  // Cap the pool so a burst of concurrent executions cannot pin an unbounded
+  // amount of memory; overflow states are simply freed.
+  constexpr size_t kStatePoolCapacity = 16;
+
+  mutex_lock lock(info->state_pool_mu);
+  if (info->state_pool.size() >= kStatePoolCapacity) return;
+  info->state_pool.push_back(
+      {std::move(register_infos), std::move(kernel_infos)});
 }
 
 // Given an offset into location_positions_section_, decode it and return
@@ -591,22 +1202,53 @@ const char* BEFFileImpl::GetKernelName(size_t kernel_id) {
   return kernel_names_[kernel_id];
 }
 
-// Read a list of function names out of the BEF file function index.
+Function* BEFFileImpl::GetOrMaterializeFunction(size_t index) {
+  assert(index < function_indices_.size() && "invalid function index");
+
+  mutex_lock lock(functions_mu_);
+  auto& slot = functions_[index];
+  if (slot) return slot.get();
+
+  const FunctionIndex& function_index = function_indices_[index];
+  const char* name = reinterpret_cast<const char*>(
+      &string_section_[function_index.name_offset]);
+
+  // TODO(tf-runtime-team): Consider adding a factory for functions.
+  switch (function_index.kind) {
+    case FunctionKind::kBEFFunction:
+      slot = std::make_unique<BEFFunction>(
+          name, function_index.arguments, function_index.results,
+          function_index.function_offset, this);
+      break;
+    case FunctionKind::kNativeFunction:
+      // Native functions are resolved against the global registry in
+      // ReadFunctionIndexSection, so their slots are filled before the file
+      // is handed to any caller.
+      llvm_unreachable("native functions are materialized at load time");
+  }
+
+  return slot.get();
+}
+
+// Read a list of function names out of the BEF file function index. This
+// materializes every function in the file; callers that only need specific
+// entry points should use GetFunction instead.
 void BEFFile::GetFunctionList(SmallVectorImpl<const Function*>* results) const {
-  auto* impl = static_cast<const BEFFileImpl*>(this);
+  auto* impl = static_cast<BEFFileImpl*>(const_cast<BEFFile*>(this));
 
-  results->reserve(impl->functions_.size());
-  for (auto& fn : impl->functions_) results->push_back(fn.get());
+  results->reserve(impl->function_indices_.size());
+  for (size_t i = 0, e = impl->function_indices_.size(); i != e; ++i)
+    results->push_back(impl->GetOrMaterializeFunction(i));
 }
 
 // Return the Function record with the specified name, or null if it isn't
 // found in this BEF file.
 const Function* BEFFile::GetFunction(string_view function_name) const {
-  auto* impl = static_cast<const BEFFileImpl*>(this);
+  auto* impl = static_cast<BEFFileImpl*>(const_cast<BEFFile*>(this));
 
   auto it = impl->function_symbol_table_.find(function_name);
   if (it == impl->function_symbol_table_.end()) return nullptr;
-  return impl->functions_[it->second].get();
+  return impl->GetOrMaterializeFunction(it->second);
 }
 
 }  // namespace tfrt
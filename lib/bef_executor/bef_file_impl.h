@@ -23,21 +23,39 @@
 #ifndef TFRT_LIB_BEF_EXECUTOR_BEF_FILE_IMPL_H_
 #define TFRT_LIB_BEF_EXECUTOR_BEF_FILE_IMPL_H_
 
+#include <atomic>
+
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "tfrt/bef_executor/bef_file.h"
 #include "tfrt/host_context/host_allocator.h"
 #include "tfrt/host_context/kernel_registry.h"
 #include "tfrt/host_context/native_function.h"
+#include "tfrt/host_context/type_name.h"
+#include "tfrt/support/bef_encoding.h"
 #include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
 
 namespace tfrt {
 
+class BEFArchive;
 class BEFFileImpl;
 class DecodedLocation;
 
+// This struct is a simple representation of an entry in FunctionIndex section.
+struct FunctionIndex {
+  FunctionKind kind;
+  size_t function_offset;
+  size_t name_offset;
+  SmallVector<TypeName, 4> arguments;
+  SmallVector<TypeName, 4> results;
+};
+
 // This class implements Function for BEF files.
 class BEFFunction final : public Function {
  public:
@@ -56,20 +74,52 @@ class BEFFunction final : public Function {
   size_t function_offset() const { return function_offset_; }
   BEFFileImpl* bef_file() const { return bef_file_; }
 
+  // Execute the function. Safe to call concurrently from any number of
+  // threads, for this and for other functions of the same BEFFile:
+  // invocations share only the immutable decoded program and internally
+  // synchronized caches (see the concurrency notes on BEFFileImpl).
   void Execute(ArrayRef<AsyncValue*> arguments,
                MutableArrayRef<RCReference<AsyncValue>> results,
                HostContext* host) const override;
+  // The ExecutionContext overload threads the cancellation token into the
+  // executor: cancelled invocations propagate the cancellation error through
+  // their remaining registers without dispatching further kernels.
+  void Execute(const ExecutionContext& exec_ctx,
+               ArrayRef<AsyncValue*> arguments,
+               MutableArrayRef<RCReference<AsyncValue>> results) const override;
+  void ExecuteBatch(ArrayRef<BatchEntry> entries,
+                    HostContext* host) const override;
   void AddRef() const override;
   void DropRef() const override;
 
  private:
+  friend class BEFFileImpl;
+
   size_t function_offset_;
   BEFFileImpl* bef_file_;
+  // Lock-free cache of this function's decoded dispatch information - a
+  // BEFFileImpl::FunctionInfo, stored type-erased because that type is
+  // declared further down this header. Written once, on the first
+  // execution; after that every invocation resolves the decode cache
+  // without taking the file-level map lock. The pointee is owned by the
+  // file and is stable for the file's lifetime, as is this BEFFunction.
+  mutable std::atomic<const void*> cached_function_info_{nullptr};
 };
 
 // This class is the implementation details behind the BEFFile::Open method,
 // which maintains all the state necessary for the BEFExecutor.  It is fully
 // public because it is a private implementation detail within this library.
+//
+// Concurrency: a BEFFile may be executed from many threads at once - any
+// number of concurrent BEFFunction::Execute calls on the same or different
+// functions are supported without external locking. The section ArrayRefs
+// and the FunctionInfo dispatch templates are immutable once published, and
+// the remaining shared mutable state is individually synchronized: the lazy
+// Function table behind functions_mu_, the decode cache behind
+// function_info_mu_, each function's execution-state pool behind its
+// state_pool_mu, and the parked-executor slot, which is handed off with
+// atomic exchanges. Everything else an invocation touches - register cells,
+// kernel ready counts, kernel frames - is private to that invocation.
 class BEFFileImpl : public BEFFile {
  public:
   ~BEFFileImpl() override;
@@ -84,6 +134,18 @@ class BEFFileImpl : public BEFFile {
     // This is the number of uses of the register in the program.  The value
     // may be deallocated when this number of uses are complete.
     const unsigned user_count;
+    // True if the register cell can be contended by multiple threads: a
+    // consumer may create the cell (as an IndirectAsyncValue) before the
+    // producer writes it. This happens only when some consumer can start
+    // before all of its arguments are available - i.e. it has more than one
+    // argument (error propagation can force it ready early, and non-strict
+    // kernels start early by design) - or when the register holds a
+    // function result, whose cell the caller creates up front. All other
+    // registers are provably written before any consumer reads them, and
+    // the executor uses plain loads and stores for them. Computed by the
+    // register classification pass in ReadFunction; the conservative
+    // default covers functions that skip that pass.
+    bool is_shared = true;
     // 'value' is not used by BEFFileImpl. BEFExecutor takes ownership of
     // RegisterInfo, and uses 'value' to track the register's contents as it
     // executes a function.
@@ -104,26 +166,181 @@ class BEFFileImpl : public BEFFile {
     unsigned offset;
     std::atomic<int> arguments_not_ready;
 
-    // We initialize the ready list to "num_operands + 1" so we can drop the
-    // last count in the executor constructor.
+    // A kernel with exactly one operand is the interior of a sequential
+    // strand: its readiness is triggered by a single event - the thread that
+    // makes its operand available - so the executor dispatches it directly
+    // from that thread and never touches the ready count. Long chains of
+    // such kernels therefore execute back to back with no per-kernel
+    // synchronization. Kernels with zero operands are started by the
+    // executor constructor, and kernels with two or more operands are true
+    // join points that keep the dynamic ready count. The schedule is
+    // derived from the static operand counts when the function is decoded;
+    // the dependency DAG of a BEF function is fixed, so no runtime
+    // discovery is needed.
+    bool IsStrandInterior() const { return is_strand_interior; }
+
+    // We initialize the ready count to "num_operands + 1" so we can drop the
+    // last count in the executor constructor. Strand-interior kernels are
+    // not visited by the constructor and never use the count; it is set to
+    // one so the error fast path (SetKernelsWithErrorInputReady) is a no-op
+    // for them.
     KernelInfo(unsigned offset, unsigned num_operands)
-        : offset(offset), arguments_not_ready(num_operands + 1) {}
+        : offset(offset),
+          arguments_not_ready(num_operands == 1 ? 1 : num_operands + 1),
+          is_strand_interior(num_operands == 1) {}
+
+   private:
+    const bool is_strand_interior;
   };
 
-  // Decode the specified BEFFunction, returning an ArrayRef of kernel entries
-  // for all kernels, decoded information about the registers used by the
-  // function, and a table of offsets to each kernel within the function.
-  // `host_allocator` is used for the heap-allocated buffer that backs
-  // `kernel_infos`.
+  // Immutable, per-function dispatch information. It is decoded once, on the
+  // first execution of the function, and shared by all subsequent executions:
+  // the BEF bytes are immutable, so the varint decoding, the register
+  // classification, and the kernel implementation resolution never change.
+  // The mutable per-execution state (register cells, ready counts) is
+  // initialized from this template in ReadFunction without touching the
+  // encoded bytes again, and pooled across executions (see state_pool).
+  struct FunctionInfo {
+    // Template for a RegisterInfo.
+    struct RegisterTemplate {
+      unsigned user_count;
+      bool is_shared;
+    };
+
+    // Template for a KernelInfo, together with the resolved kernel
+    // implementation so the executor's inner loop is a direct indexed call
+    // with no lookup of any kind.
+    struct KernelTemplate {
+      KernelImplementation fn;
+      // The direct-call variant of the kernel, or null if it has none. The
+      // inline execution path invokes it without building a kernel frame
+      // (see TryExecuteInline).
+      SyncKernelImplementation direct_fn;
+      bool is_sync;
+      // True unless the call site carries the non-strict special attribute.
+      // A strict kernel with an error argument never runs: the executor's
+      // error sweep forwards the error to its results and walks its used_by
+      // lists transitively without dispatching any of the skipped kernels
+      // (see BEFExecutor::PropagateError). Decoded here so the sweep never
+      // touches the encoded kernel headers to test skippability.
+      bool is_strict;
+      unsigned offset;
+      unsigned num_operands;
+      // Start of this kernel's resolved attribute pointers in the
+      // function's attribute_pointers table below. The span covers the
+      // kernel's attribute payloads followed by its function attributes.
+      unsigned attribute_offset;
+      // The length of the longest chain of dependent kernels downstream of
+      // this one - its criticality. The executor processes ready kernels
+      // most-critical-first so the critical path is not delayed behind
+      // trivial side branches. Computed at decode time from the dependency
+      // DAG that is already fully encoded in the kernel used_by lists.
+      unsigned height;
+    };
+
+    // Bodies of at most this many kernels qualify for inline execution
+    // (see inline_executable below); larger bodies amortize the executor
+    // setup well enough that the general path is used.
+    static constexpr size_t kMaxInlineKernels = 8;
+
+    size_t location_offset;
+    // Kernel entries of all kernels of the function.
+    ArrayRef<uint32_t> kernels;
+    SmallVector<size_t, 4> result_regs;
+    SmallVector<RegisterTemplate, 16> registers;
+    SmallVector<KernelTemplate, 16> kernel_templates;
+    // Resolved attribute pointers of all kernels, in kernel order: for each
+    // kernel, pointers to its attribute payloads in the attribute section,
+    // followed by its function attributes as materialized Function pointers
+    // (see KernelTemplate::attribute_offset). Resolved once at decode time,
+    // so per-execution setup copies pointers with no per-attribute offset
+    // arithmetic and the direct-call path passes the span through as is.
+    SmallVector<const void*, 8> attribute_pointers;
+
+    // True when the body is small (at most kMaxInlineKernels kernels) and
+    // every body kernel is synchronous, so an invocation with available
+    // arguments can run inline in the calling thread - straight-line over
+    // the kernel list with a plain register array, no executor object and
+    // no atomic ready counts (see TryExecuteInline in bef_executor.cc).
+    // Kernel 0 may be the arguments pseudo kernel, which is never
+    // dispatched; it is exempted here and checked at execution time when
+    // the function has no arguments.
+    bool inline_executable = false;
+
+    // The mutable per-execution state of one invocation. These arrays have
+    // identical shape for every execution of the function.
+    struct ExecutionState {
+      HostArray<RegisterInfo> register_infos;
+      HostArray<KernelInfo> kernel_infos;
+    };
+
+    // Pool of execution states retired by completed executions. ReadFunction
+    // reinitializes and reuses a pooled state instead of allocating a fresh
+    // one, so repeat executions run on warm memory and skip the first-touch
+    // page faults of a cold register file. Mutable because the dispatch
+    // template itself is immutable and shared via const pointers.
+    mutable mutex state_pool_mu;
+    mutable SmallVector<ExecutionState, 4> state_pool
+        TFRT_GUARDED_BY(state_pool_mu);
+
+    // Single-slot cache of a retired executor object for this function. The
+    // executor parks itself here on destruction (with its file references
+    // dropped - the file owns this slot, so a parked executor must not keep
+    // the file alive) instead of deallocating, and the next execution of the
+    // function resurrects it, reusing the allocation and its warm kernel
+    // frame pool. Sequential re-invocation - e.g. a hex.repeat.i32 loop body
+    // - hits this slot on every iteration. The deleter is installed by the
+    // executor so the file can free a parked instance without knowing its
+    // type.
+    mutable std::atomic<void*> cached_executor{nullptr};
+    mutable std::atomic<void (*)(void*)> cached_executor_deleter{nullptr};
+
+    FunctionInfo() = default;
+    ~FunctionInfo();
+  };
+
+  // Return the cached FunctionInfo for the function at `function_offset`,
+  // decoding it on the first call. `num_results` is the number of function
+  // results (from the function index). Thread-safe.
   //
-  // On error, an error is emitted and a null pointer is returned.
-  ArrayRef<uint32_t> ReadFunction(size_t function_offset,
-                                  ArrayRef<TypeName> results,
-                                  size_t* location_offset,
-                                  HostArray<RegisterInfo>* register_infos,
-                                  HostArray<KernelInfo>* kernel_infos,
-                                  SmallVectorImpl<size_t>* result_regs,
-                                  HostAllocator* host_allocator);
+  // On error, an error is emitted and nullptr is returned.
+  const FunctionInfo* GetFunctionInfo(size_t function_offset,
+                                      size_t num_results);
+
+  // As above, keyed by the function object: equivalent, but repeat calls
+  // are lock-free because the result is also cached in the BEFFunction
+  // itself. Prefer this overload on execution paths.
+  const FunctionInfo* GetFunctionInfo(const BEFFunction& fn);
+
+  // Decode the specified BEFFunction (cached after the first call, see
+  // GetFunctionInfo), and initialize the per-execution register and kernel
+  // state from the cached template. `host_allocator` is used for the
+  // heap-allocated buffers that back `register_infos` and `kernel_infos`.
+  //
+  // On error, an error is emitted and nullptr is returned.
+  const FunctionInfo* ReadFunction(size_t function_offset,
+                                   ArrayRef<TypeName> results,
+                                   size_t* location_offset,
+                                   HostArray<RegisterInfo>* register_infos,
+                                   HostArray<KernelInfo>* kernel_infos,
+                                   SmallVectorImpl<size_t>* result_regs,
+                                   HostAllocator* host_allocator);
+
+  // As above, for an invocation of `fn`. Repeat executions resolve the
+  // decode cache without taking the file-level map lock (see
+  // GetFunctionInfo(const BEFFunction&)).
+  const FunctionInfo* ReadFunction(const BEFFunction& fn,
+                                   size_t* location_offset,
+                                   HostArray<RegisterInfo>* register_infos,
+                                   HostArray<KernelInfo>* kernel_infos,
+                                   SmallVectorImpl<size_t>* result_regs,
+                                   HostAllocator* host_allocator);
+
+  // Return the per-execution state of a completed execution to the
+  // function's pool, to be reused by a later ReadFunction call.
+  void ReturnFunctionState(const FunctionInfo* info,
+                           HostArray<RegisterInfo> register_infos,
+                           HostArray<KernelInfo> kernel_infos);
 
   // Given an offset into the LocationPositions section, decode it and return
   // a DecodedDiagnostic.
@@ -133,8 +350,27 @@ class BEFFileImpl : public BEFFile {
   // slow.
   const char* GetKernelName(size_t kernel_id);
 
+  // Return the function at `index` in the function index, creating the
+  // Function object on first use. Function decoding is lazy: BEFFile::Open
+  // parses the function index eagerly, but Function objects (and, for native
+  // functions, the global registry lookup) are deferred until the function
+  // is actually requested, so opening a large BEF file with many unused
+  // entry points stays cheap. Returns nullptr and emits an error if the
+  // function cannot be materialized. Thread-safe.
+  Function* GetOrMaterializeFunction(size_t index);
+
   ErrorHandler error_handler_;
 
+  // When the file was opened with BEFFile::OpenFromFile, this owns the
+  // (possibly memory mapped) file contents that the section ArrayRefs below
+  // alias. Null when the caller owns the bytes.
+  std::unique_ptr<llvm::MemoryBuffer> file_buffer_;
+
+  // When the file was opened with BEFArchive::OpenModule, this keeps the
+  // archive - whose bytes attribute_section_ and the other section
+  // ArrayRefs alias - alive.
+  RCReference<BEFArchive> archive_;
+
   ArrayRef<uint8_t> location_filenames_section_;
   ArrayRef<uint8_t> location_positions_section_;
   ArrayRef<uint8_t> string_section_;
@@ -143,14 +379,61 @@ class BEFFileImpl : public BEFFile {
   ArrayRef<uint8_t> types_section_;
   ArrayRef<uint8_t> function_section_;
   ArrayRef<uint8_t> function_index_section_;
+  // True for BEF version 1 files, whose function header tables are stored
+  // as 4-byte aligned fixed-width uint32 entries instead of VBR integers.
+  bool fixed_width_function_tables_ = false;
+  // True when the file was opened with LoadMode::kTrusted: the file is
+  // assumed to be structurally valid and validation-only checks are skipped
+  // on the load path (they remain as asserts in debug builds).
+  bool trusted_ = false;
   SmallVector<KernelImplementation, 8> kernels_;
+  // Parallel to kernels_: true if the kernel was registered with
+  // KernelRegistry::AddSyncKernel, i.e. it completes all of its results
+  // before returning. The executor takes a streamlined result-processing
+  // path for these kernels.
+  SmallVector<bool, 8> sync_kernels_;
+  // Parallel to kernels_: the direct-call variant registered for the
+  // kernel, or null (see KernelRegistry::AddSyncKernel).
+  SmallVector<SyncKernelImplementation, 8> direct_sync_kernels_;
+  // Parallel to kernels_: the call-site shape the kernel was registered
+  // with. Every call site is validated against it once, when the calling
+  // function is decoded (see DecodeFunctionInfo), so dispatch never
+  // re-checks argument or result counts.
+  SmallVector<KernelSignature, 8> kernel_signatures_;
   SmallVector<TypeName, 8> type_names_;
   llvm::StringMap<size_t> function_symbol_table_;
-  SmallVector<std::unique_ptr<Function>, 8> functions_;
+  // The decoded function index, parsed eagerly when the file is opened.
+  SmallVector<FunctionIndex, 8> function_indices_;
+  // Lazily materialized Function objects, parallel to function_indices_.
+  // Entries are null until the function is first requested; use
+  // GetOrMaterializeFunction to access them.
+  mutex functions_mu_;
+  SmallVector<std::unique_ptr<Function>, 8> functions_
+      TFRT_GUARDED_BY(functions_mu_);
 
   // Maps from kernel_id to the name of the kernel. Only nonempty when
   // debugging.
   std::vector<const char*> kernel_names_;
+
+ private:
+  // Decode the function at `function_offset` into a FunctionInfo. Returns
+  // nullptr on a malformed function (after emitting an error).
+  std::unique_ptr<FunctionInfo> DecodeFunctionInfo(size_t function_offset,
+                                                   size_t num_results);
+
+  // Shared tail of the ReadFunction overloads: initialize the per-execution
+  // register and kernel state for one invocation of the function described
+  // by `info`, reusing a pooled execution state when one is available.
+  const FunctionInfo* InitializeExecutionState(
+      const FunctionInfo* info, size_t* location_offset,
+      HostArray<RegisterInfo>* register_infos,
+      HostArray<KernelInfo>* kernel_infos, SmallVectorImpl<size_t>* result_regs,
+      HostAllocator* host_allocator);
+
+  // Cache of decoded function information, keyed by function offset.
+  mutex function_info_mu_;
+  llvm::DenseMap<size_t, std::unique_ptr<FunctionInfo>> function_infos_
+      TFRT_GUARDED_BY(function_info_mu_);
 };
 
 }  // namespace tfrt
@@ -0,0 +1,252 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- critical_path_analysis.cc - Post-execution critical path -----------===//
+//
+// This file implements the critical path recorder and the backward walk over
+// its records. See critical_path_analysis.h for the model.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/bef_executor/critical_path_analysis.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+
+namespace {
+
+std::atomic<bool> critical_path_enabled{false};
+
+uint64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// The most recently created recorder, shared with any still-pending
+// availability callbacks. Guarded by a mutex: executions start rarely
+// relative to kernel dispatches, and the query side is offline anyway.
+struct LastRecorderSlot {
+  mutex mu;
+  std::shared_ptr<CriticalPathRecorder> recorder TFRT_GUARDED_BY(mu);
+};
+
+LastRecorderSlot* GetLastRecorderSlot() {
+  static auto* slot = new LastRecorderSlot();
+  return slot;
+}
+
+// Formats nanoseconds as fractional microseconds for trace-event output,
+// matching the ring buffer tracing sink.
+llvm::format_object<unsigned long long, unsigned long long> MicrosWithNanos(
+    uint64_t nanos) {
+  return llvm::format("%llu.%03llu",
+                      static_cast<unsigned long long>(nanos / 1000),
+                      static_cast<unsigned long long>(nanos % 1000));
+}
+
+void WriteJsonEscaped(raw_ostream& os, const std::string& text) {
+  for (char c : text) {
+    if (c == '"' || c == '\\') os << '\\';
+    os << c;
+  }
+}
+
+}  // namespace
+
+void SetCriticalPathAnalysisEnabled(bool enabled) {
+  critical_path_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool IsCriticalPathAnalysisEnabled() {
+  return critical_path_enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t CriticalPathNowNs() { return NowNs(); }
+
+CriticalPathRecorder::CriticalPathRecorder(size_t num_registers,
+                                           size_t num_kernels)
+    : execution_start_ns_(NowNs()),
+      kernels_(num_kernels),
+      registers_(num_registers) {}
+
+void CriticalPathRecorder::SetResultRegs(ArrayRef<size_t> result_regs) {
+  result_regs_.assign(result_regs.begin(), result_regs.end());
+}
+
+void CriticalPathRecorder::RecordKernelDispatch(unsigned kernel_id,
+                                                const char* name,
+                                                ArrayRef<uint32_t> arg_regs,
+                                                uint64_t start_ns,
+                                                uint64_t end_ns) {
+  assert(kernel_id < kernels_.size());
+  KernelRecord& record = kernels_[kernel_id];
+  record.name = name ? name : "<unknown>";
+  record.start_ns = start_ns;
+  record.end_ns = end_ns;
+  record.arg_regs.assign(arg_regs.begin(), arg_regs.end());
+}
+
+void CriticalPathRecorder::RecordResult(
+    std::shared_ptr<CriticalPathRecorder> recorder, uint32_t reg_index,
+    unsigned kernel_id, AsyncValue* value) {
+  assert(reg_index < recorder->registers_.size());
+  RegisterRecord& record = recorder->registers_[reg_index];
+  record.producer.store(static_cast<int>(kernel_id),
+                        std::memory_order_relaxed);
+  if (value->IsAvailable()) {
+    record.available_ns.store(NowNs(), std::memory_order_release);
+    return;
+  }
+  // Asynchronous result: stamp the register when the value resolves. The
+  // callback shares ownership of the recorder so a late resolution after the
+  // executor retired is safe.
+  value->AndThen([recorder = std::move(recorder), reg_index] {
+    recorder->registers_[reg_index].available_ns.store(
+        NowNs(), std::memory_order_release);
+  });
+}
+
+std::vector<CriticalPathStep> CriticalPathRecorder::ComputeCriticalPath()
+    const {
+  // Pick the result register that became available last; it bounds the
+  // function's latency. Unresolved registers are treated as available now so
+  // a still-running execution yields the path to its slowest pending result.
+  const uint64_t now = NowNs();
+  auto available_ns = [&](size_t reg) {
+    uint64_t ns = registers_[reg].available_ns.load(std::memory_order_acquire);
+    if (ns != 0) return ns;
+    // Unstamped registers with no producer record are function arguments (or
+    // error-propagated values the dispatch loop never timed): treat them as
+    // available at execution start. Unstamped registers whose producer did
+    // run are genuinely pending, i.e. available "now".
+    return registers_[reg].producer.load(std::memory_order_relaxed) < 0
+               ? execution_start_ns_
+               : now;
+  };
+
+  int reg = -1;
+  for (size_t result_reg : result_regs_) {
+    if (reg < 0 || available_ns(result_reg) > available_ns(reg))
+      reg = static_cast<int>(result_reg);
+  }
+
+  // Walk producer edges backward, at each kernel following the argument that
+  // resolved last. Steps come out result-first and are reversed at the end.
+  std::vector<CriticalPathStep> path;
+  while (reg >= 0 && path.size() < kernels_.size()) {
+    int producer = registers_[reg].producer.load(std::memory_order_relaxed);
+    // Function arguments and pseudo-kernel results have no recorded
+    // producer; error propagation also skips dispatch records. Either way
+    // the chain ends here.
+    if (producer < 0 || kernels_[producer].name.empty()) break;
+    const KernelRecord& kernel = kernels_[producer];
+
+    CriticalPathStep step;
+    step.kernel_name = kernel.name;
+    step.start_ns = kernel.start_ns;
+    step.available_ns = available_ns(reg);
+    step.ready_ns = execution_start_ns_;
+
+    int next_reg = -1;
+    for (uint32_t arg_reg : kernel.arg_regs) {
+      uint64_t arg_ns = available_ns(arg_reg);
+      if (next_reg < 0 || arg_ns > available_ns(next_reg))
+        next_reg = static_cast<int>(arg_reg);
+    }
+    if (next_reg >= 0) step.ready_ns = available_ns(next_reg);
+
+    path.push_back(std::move(step));
+    reg = next_reg;
+  }
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+void PublishCriticalPathRecorder(
+    std::shared_ptr<CriticalPathRecorder> recorder) {
+  LastRecorderSlot* slot = GetLastRecorderSlot();
+  mutex_lock lock(slot->mu);
+  slot->recorder = std::move(recorder);
+}
+
+std::vector<CriticalPathStep> ComputeLastCriticalPath() {
+  std::shared_ptr<CriticalPathRecorder> recorder;
+  {
+    LastRecorderSlot* slot = GetLastRecorderSlot();
+    mutex_lock lock(slot->mu);
+    recorder = slot->recorder;
+  }
+  if (!recorder) return {};
+  return recorder->ComputeCriticalPath();
+}
+
+void PrintCriticalPath(ArrayRef<CriticalPathStep> path, raw_ostream& os) {
+  if (path.empty()) {
+    os << "critical path: <empty>\n";
+    return;
+  }
+  os << "critical path (" << path.size() << " kernels):\n";
+  uint64_t total_wait_ns = 0, total_exec_ns = 0;
+  for (const CriticalPathStep& step : path) {
+    const uint64_t wait_ns =
+        step.start_ns > step.ready_ns ? step.start_ns - step.ready_ns : 0;
+    const uint64_t exec_ns = step.available_ns > step.start_ns
+                                 ? step.available_ns - step.start_ns
+                                 : 0;
+    total_wait_ns += wait_ns;
+    total_exec_ns += exec_ns;
+    os << "  " << step.kernel_name << "  wait " << MicrosWithNanos(wait_ns)
+       << " us  execute " << MicrosWithNanos(exec_ns) << " us\n";
+  }
+  os << "  total  wait " << MicrosWithNanos(total_wait_ns) << " us  execute "
+     << MicrosWithNanos(total_exec_ns) << " us  path "
+     << MicrosWithNanos(path.back().available_ns - path.front().ready_ns)
+     << " us\n";
+}
+
+void WriteCriticalPathTrace(ArrayRef<CriticalPathStep> path, raw_ostream& os) {
+  // Same trace-event format as the ring buffer sink: complete ("X") events
+  // with fractional-microsecond timestamps. The path is laid out on a single
+  // track with a wait slice and an execute slice per step.
+  os << "[";
+  bool first = true;
+  auto emit = [&](const std::string& name, uint64_t start_ns,
+                  uint64_t end_ns) {
+    if (end_ns <= start_ns) return;
+    if (!first) os << ",";
+    first = false;
+    os << "\n{\"name\":\"";
+    WriteJsonEscaped(os, name);
+    os << "\",\"pid\":1,\"tid\":0,\"ph\":\"X\",\"ts\":"
+       << MicrosWithNanos(start_ns) << ",\"dur\":"
+       << MicrosWithNanos(end_ns - start_ns) << "}";
+  };
+  for (const CriticalPathStep& step : path) {
+    emit("wait " + step.kernel_name, step.ready_ns, step.start_ns);
+    emit(step.kernel_name, step.start_ns, step.available_ns);
+  }
+  os << "\n]\n";
+}
+
+}  // namespace tfrt
@@ -20,7 +20,12 @@
 //===----------------------------------------------------------------------===//
 #include "tfrt/bef_executor_driver/bef_executor_driver.h"
 
+#include <algorithm>
+#include <chrono>
+#include <ctime>
 #include <limits>
+#include <numeric>
+#include <vector>
 
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/ScopeExit.h"
@@ -43,10 +48,84 @@
 #include "tfrt/support/mutex.h"
 #include "tfrt/support/ostream.h"
 #include "tfrt/support/string_util.h"
+#include "tfrt/tracing/kernel_latency_stats.h"
 #include "tfrt/tracing/tracing.h"
 
 namespace tfrt {
 
+namespace {
+
+// Returns the value at the given percentile of `sorted_ns`, which must be
+// sorted ascending and non-empty.
+uint64_t PercentileNs(const std::vector<uint64_t>& sorted_ns, int percentile) {
+  assert(!sorted_ns.empty());
+  return sorted_ns[(sorted_ns.size() - 1) * percentile / 100];
+}
+
+// Prints one "mean/p50/p99" line for the given nanosecond samples.
+void PrintStatsLine(string_view label, std::vector<uint64_t> samples_ns) {
+  uint64_t total_ns =
+      std::accumulate(samples_ns.begin(), samples_ns.end(), uint64_t{0});
+  std::sort(samples_ns.begin(), samples_ns.end());
+  tfrt::outs() << "  " << label << ": mean " << total_ns / samples_ns.size()
+               << " ns, p50 " << PercentileNs(samples_ns, 50) << " ns, p99 "
+               << PercentileNs(samples_ns, 99) << " ns\n";
+}
+
+// Runs `fn` for the configured warmup and measured iteration counts and
+// prints per-iteration wall/cpu statistics. Each timed iteration covers
+// Execute plus Await on the results; the Quiesce that drains unchained side
+// effects runs between iterations, outside the timed region, so the numbers
+// reflect function latency rather than cleanup.
+void BenchmarkFunction(const Function* fn, HostContext* host,
+                       const RunBefConfig& run_config) {
+  auto run_once = [&]() {
+    llvm::SmallVector<RCReference<AsyncValue>, 4> results;
+    results.resize(fn->result_types().size());
+    fn->Execute(/*arguments=*/{}, results, host);
+    host->Await(results);
+  };
+
+  for (int i = 0; i < run_config.benchmark_num_warmup_iterations; ++i) {
+    run_once();
+    host->Quiesce();
+    host->Restart();
+  }
+
+  std::vector<uint64_t> wall_ns;
+  std::vector<uint64_t> cpu_ns;
+  wall_ns.reserve(run_config.benchmark_num_iterations);
+  cpu_ns.reserve(run_config.benchmark_num_iterations);
+
+  for (int i = 0; i < run_config.benchmark_num_iterations; ++i) {
+    std::clock_t cpu_start = std::clock();
+    auto wall_start = std::chrono::steady_clock::now();
+    run_once();
+    auto wall_end = std::chrono::steady_clock::now();
+    std::clock_t cpu_end = std::clock();
+
+    wall_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          wall_end - wall_start)
+                          .count());
+    // std::clock measures cpu time summed over all threads of the process,
+    // so this can exceed the wall time on a multi-threaded work queue.
+    cpu_ns.push_back(static_cast<uint64_t>(cpu_end - cpu_start) *
+                     (uint64_t{1000000000} / CLOCKS_PER_SEC));
+
+    host->Quiesce();
+    host->Restart();
+  }
+
+  tfrt::outs() << "'" << fn->name() << "' benchmark: "
+               << run_config.benchmark_num_iterations << " iterations, "
+               << run_config.benchmark_num_warmup_iterations << " warmup\n";
+  PrintStatsLine("wall", std::move(wall_ns));
+  PrintStatsLine("cpu ", std::move(cpu_ns));
+  tfrt::outs().flush();
+}
+
+}  // namespace
+
 int RunBefExecutor(const RunBefConfig& run_config) {
   TFRT_TRACE_SCOPE("Bef Executor");
   static auto* version_metric =
@@ -264,6 +343,12 @@ int RunBefExecutor(const RunBefConfig& run_config) {
     // properly chained together (which is useful for testing).
     host->Quiesce();
 
+    // With the runtime quiesced, no dispatch loop is mid-drain, so this is
+    // the natural point to fold the per-thread kernel latency tables into
+    // the published aggregate.
+    if (tracing::IsKernelLatencyAggregationEnabled())
+      tracing::MergeKernelLatencyStats();
+
     // Always call Restart() to clear the cancel async value. The execution of
     // a BEF function may cause HostContext to enter the canceled state.
     host->Restart();
@@ -281,6 +366,11 @@ int RunBefExecutor(const RunBefConfig& run_config) {
         abort();
       }
     }
+
+    // In benchmark mode, re-run the function (which the single run above has
+    // already verified) with warmup and timed iterations.
+    if (run_config.benchmark_num_iterations > 0)
+      BenchmarkFunction(fn, host, run_config);
   }
 
   bef.reset();
@@ -87,6 +87,10 @@ struct FunctionOpHandlerTraits {
                        MutableArrayRef<RCReference<AsyncValue>> results,
                        AsyncValueRef<Chain>* chain,
                        const ExecutionContext& exec_ctx) {
+    // Small all-synchronous composite bodies (a couple of kernels) execute
+    // inline in the calling thread; only genuinely large or asynchronous
+    // bodies instantiate a BEFExecutor. See TryExecuteInline in
+    // bef_executor.cc.
     op_entry.dispatch_fn->Execute(inputs, results, exec_ctx.host());
   }
 };
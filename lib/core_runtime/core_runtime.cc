@@ -20,12 +20,16 @@
 
 #include "tfrt/core_runtime/core_runtime.h"
 
+#include <array>
+#include <atomic>
 #include <string>
 
+#include "llvm/ADT/Hashing.h"
 #include "tfrt/core_runtime/core_runtime_op.h"
 #include "tfrt/core_runtime/op_handler.h"
 #include "tfrt/core_runtime/op_handler_factory.h"
 #include "tfrt/core_runtime/op_invocation.h"
+#include "tfrt/core_runtime/op_stream.h"
 #include "tfrt/core_runtime/tensor_handle.h"
 #include "tfrt/host_context/chain.h"
 #include "tfrt/host_context/concurrent_work_queue.h"
@@ -66,6 +70,95 @@ class OpHandlerRegistry {
   std::vector<std::unique_ptr<OpHandler>> all_op_handlers_;
 };
 
+// A lock-free, append-only cache of resolved ops. Multi-threaded clients
+// call MakeOp with the same op names on every request, and each call walks
+// the op handler chain and builds a fresh CoreRuntimeOp. After the first
+// resolution of an (op name, op handler) pair the result is published here,
+// so later lookups are a single hash probe with no mutex.
+//
+// Entries are never removed or mutated after being published, so readers
+// only need an acquire load on a slot. Cached ops are stateless closures
+// over immutable registry entries and are safe to invoke concurrently.
+class OpResolutionCache {
+ public:
+  OpResolutionCache() {
+    for (auto& slot : slots_) slot.store(nullptr, std::memory_order_relaxed);
+  }
+  ~OpResolutionCache() {
+    for (auto& slot : slots_) delete slot.load(std::memory_order_relaxed);
+  }
+
+  // Return the cached op for the given key, or null if it has not been
+  // resolved yet.
+  CoreRuntimeOp* Find(string_view op_name, OpHandler* op_handler) {
+    size_t slot = HashKey(op_name, op_handler) & (kNumSlots - 1);
+    for (size_t i = 0; i != kNumSlots; ++i) {
+      Entry* entry = slots_[slot].load(std::memory_order_acquire);
+      if (!entry) return nullptr;
+      if (entry->op_handler == op_handler && op_name == entry->op_name)
+        return &entry->op;
+      slot = (slot + 1) & (kNumSlots - 1);
+    }
+    return nullptr;
+  }
+
+  // Publish the resolved op, moving it out of `op`, and return the cached
+  // instance. If another thread raced to publish the same key, its instance
+  // wins and ours is dropped. Returns null with `op` left intact if the
+  // table is full; the caller then just uses its own instance uncached.
+  CoreRuntimeOp* Insert(string_view op_name, OpHandler* op_handler,
+                        CoreRuntimeOp* op) {
+    auto entry = std::make_unique<Entry>();
+    entry->op_name = op_name.str();
+    entry->op_handler = op_handler;
+    entry->op = std::move(*op);
+
+    size_t slot = HashKey(op_name, op_handler) & (kNumSlots - 1);
+    for (size_t i = 0; i != kNumSlots; ++i) {
+      Entry* existing = slots_[slot].load(std::memory_order_acquire);
+      if (!existing &&
+          slots_[slot].compare_exchange_strong(existing, entry.get(),
+                                               std::memory_order_release,
+                                               std::memory_order_acquire)) {
+        return &entry.release()->op;
+      }
+      // The slot was (or just became) occupied; if it holds our key some
+      // other thread won the race and we defer to its instance.
+      if (existing->op_handler == op_handler && op_name == existing->op_name)
+        return &existing->op;
+      slot = (slot + 1) & (kNumSlots - 1);
+    }
+
+    *op = std::move(entry->op);
+    return nullptr;
+  }
+
+ private:
+  struct Entry {
+    std::string op_name;
+    OpHandler* op_handler;
+    CoreRuntimeOp op;
+  };
+
+  static size_t HashKey(string_view op_name, OpHandler* op_handler) {
+    return static_cast<size_t>(llvm::hash_combine(op_name, op_handler));
+  }
+
+  // Power of two. Op registries are fixed at setup time and modest in size;
+  // if the table ever fills, later resolutions simply go uncached.
+  static constexpr size_t kNumSlots = 1024;
+
+  std::array<std::atomic<Entry*>, kNumSlots> slots_;
+};
+
+// The cache retains the resolved op for the lifetime of the CoreRuntime;
+// callers get a thin forwarding wrapper that they own and may move freely.
+CoreRuntimeOp MakeForwardingOp(CoreRuntimeOp* cached) {
+  return CoreRuntimeOp(
+      [cached](const OpInvocation& invocation) { (*cached)(invocation); },
+      cached->IsFallback());
+}
+
 }  // namespace
 
 OpHandlerFactory& OpHandlerFactory::GetGlobalOpHandlerFactory() {
@@ -94,6 +187,10 @@ class CoreRuntime::Impl {
                MutableArrayRef<TensorHandle> results,
                AsyncValueRef<Chain>* chain);
 
+  void ExecuteBatch(OpHandler* op_handler,
+                    MutableArrayRef<CoreRuntime::BatchEntry> batch,
+                    AsyncValueRef<Chain>* chain);
+
  private:
   friend class CoreRuntime;
 
@@ -105,6 +202,14 @@ class CoreRuntime::Impl {
   HostContext context_;
 
   OpHandlerRegistry op_handler_registry_;
+
+  // Resolved ops shared across threads by MakeOp, see OpResolutionCache.
+  OpResolutionCache op_resolution_cache_;
+
+  // Named op streams, created on first use and owned by the runtime.
+  mutex stream_mu_;
+  llvm::StringMap<std::unique_ptr<OpStream>> streams_
+      TFRT_GUARDED_BY(stream_mu_);
 };
 
 void CoreRuntime::Impl::Execute(string_view op_name, OpHandler* op_handler,
@@ -132,6 +237,51 @@ void CoreRuntime::Impl::Execute(string_view op_name, OpHandler* op_handler,
   if (chain) *chain = std::move(err);
 }
 
+void CoreRuntime::Impl::ExecuteBatch(
+    OpHandler* op_handler, MutableArrayRef<CoreRuntime::BatchEntry> batch,
+    AsyncValueRef<Chain>* chain) {
+  // One execution context is shared by the whole batch; only the location
+  // changes per entry.
+  ExecutionContext exec_ctx{GetHostContext()};
+
+  // Resolve each distinct op name through the op handler chain only once.
+  // An invalid CoreRuntimeOp records a name the op handler does not know, so
+  // repeated unknown names don't retry the lookup either.
+  llvm::StringMap<CoreRuntimeOp> resolved_ops;
+
+  for (auto& entry : batch) {
+    assert(entry.attrs && "ExecuteBatch entries require attributes");
+    exec_ctx.set_location(entry.loc);
+
+    auto it = resolved_ops.find(entry.op_name);
+    if (it == resolved_ops.end()) {
+      auto op_handle = op_handler->MakeOp(entry.op_name);
+      if (op_handle) {
+        it = resolved_ops.try_emplace(entry.op_name, std::move(op_handle.get()))
+                 .first;
+      } else {
+        llvm::consumeError(op_handle.takeError());
+        it = resolved_ops.try_emplace(entry.op_name, CoreRuntimeOp()).first;
+      }
+    }
+
+    auto& op_handle = it->second;
+    if (!op_handle) {
+      // Fail this entry with an 'unknown op' error like Execute does, and let
+      // the rest of the batch proceed: later entries consuming its results
+      // see the error through their arguments.
+      auto err = EmitErrorAsync(
+          exec_ctx, "op '" + entry.op_name.str() + "' is not supported");
+      for (auto& result : entry.results)
+        result = TensorHandle(err.CopyRef(), err.CopyRef());
+      if (chain) *chain = std::move(err);
+      continue;
+    }
+
+    op_handle(exec_ctx, entry.arguments, *entry.attrs, entry.results, chain);
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // Constructor / Destructor Logic
 //===----------------------------------------------------------------------===//
@@ -276,16 +426,34 @@ void CoreRuntime::Execute(string_view op_name, OpHandler* op_handler,
   impl_->Execute(op_name, op_handler, loc, arguments, attrs, results, chain);
 }
 
+void CoreRuntime::ExecuteBatch(OpHandler* op_handler,
+                               MutableArrayRef<BatchEntry> batch,
+                               AsyncValueRef<Chain>* chain) {
+  impl_->ExecuteBatch(op_handler, batch, chain);
+}
+
+OpStream* CoreRuntime::GetStream(string_view name, OpHandler* op_handler) {
+  mutex_lock lock(impl_->stream_mu_);
+  auto& stream = impl_->streams_[name];
+  if (!stream) stream.reset(new OpStream(this, op_handler));
+  return stream.get();
+}
+
 Expected<CoreRuntimeOp> CoreRuntime::MakeOp(string_view op_name,
                                             OpHandler* op_handler) {
-#ifdef NO_TFRT_TRACING
-  return op_handler->MakeOp(op_name);
-#else  // NO_TFRT_TRACING is not set.
+  auto& cache = impl_->op_resolution_cache_;
+
+  // Fast path: the op was already resolved by some thread, so this is a
+  // single lock-free hash probe with no op handler chain walk.
+  if (auto* cached = cache.Find(op_name, op_handler))
+    return MakeForwardingOp(cached);
+
   auto op = op_handler->MakeOp(op_name);
   if (!op) return op;
+#ifndef NO_TFRT_TRACING
   bool is_fallback = op->IsFallback();
   // TODO(b/155801998): Avoid this string copy.
-  return CoreRuntimeOp(
+  op = CoreRuntimeOp(
       [op_name = op_name.str(), op = std::move(op.get()),
        op_handler](const OpInvocation& invocation) mutable {
         TFRT_TRACE_KERNEL_SCOPE(
@@ -293,7 +461,11 @@ Expected<CoreRuntimeOp> CoreRuntime::MakeOp(string_view op_name,
         op(invocation);
       },
       is_fallback);
-#endif
+#endif  // NO_TFRT_TRACING
+
+  if (auto* cached = cache.Insert(op_name, op_handler, &op.get()))
+    return MakeForwardingOp(cached);
+  return op;
 }
 
 }  // namespace tfrt
@@ -21,13 +21,51 @@
 
 #include "tfrt/core_runtime/dispatch_utils.h"
 
+#include <algorithm>
+
 #include "tfrt/host_context/host_context.h"
 
 namespace tfrt {
 namespace internal {
+
+bool MetadataFnCache::Lookup(
+    ArrayRef<TensorMetadata> argument_mds,
+    SmallVectorImpl<TensorMetadata>& result_mds) const {
+  mutex_lock lock(mu_);
+  for (auto& entry : entries_) {
+    if (entry.argument_mds.size() != argument_mds.size()) continue;
+    if (!std::equal(argument_mds.begin(), argument_mds.end(),
+                    entry.argument_mds.begin()))
+      continue;
+    result_mds.assign(entry.result_mds.begin(), entry.result_mds.end());
+    return true;
+  }
+  return false;
+}
+
+void MetadataFnCache::Insert(ArrayRef<TensorMetadata> argument_mds,
+                             ArrayRef<TensorMetadata> result_mds) {
+  mutex_lock lock(mu_);
+  if (entries_.size() >= kMaxEntries) return;
+
+  // Concurrent invocations may race to insert the same signature; keep the
+  // first one.
+  for (auto& entry : entries_) {
+    if (entry.argument_mds.size() == argument_mds.size() &&
+        std::equal(argument_mds.begin(), argument_mds.end(),
+                   entry.argument_mds.begin()))
+      return;
+  }
+
+  Entry entry;
+  entry.argument_mds.assign(argument_mds.begin(), argument_mds.end());
+  entry.result_mds.assign(result_mds.begin(), result_mds.end());
+  entries_.push_back(std::move(entry));
+}
+
 MDFunctionExecResult ExecuteMetadataFunction(
     const OpMetadataFn& metadata_fn, const OpInvocation& invocation,
-    SmallVectorImpl<TensorMetadata>& result_mds) {
+    SmallVectorImpl<TensorMetadata>& result_mds, MetadataFnCache* cache) {
   auto propagate_error = [&](RCReference<AsyncValue> error) {
     for (auto& result : invocation.results)
       result = TensorHandle::CreateError(error.CopyRef());
@@ -68,6 +106,11 @@ MDFunctionExecResult ExecuteMetadataFunction(
     argument_mds.push_back(arg_md_av.get());
   }
 
+  // Metadata functions are pure, so if the cache has already seen this
+  // argument signature we can reuse the results without running the function.
+  if (cache && cache->Lookup(argument_mds, result_mds))
+    return MDFunctionExecResult::kSuccess;
+
   // Okay, the shapes are available as we expect, get the result metadata.
   result_mds.resize(invocation.results.size());
 
@@ -81,6 +124,8 @@ MDFunctionExecResult ExecuteMetadataFunction(
     return MDFunctionExecResult::kError;
   }
 
+  if (cache) cache->Insert(argument_mds, result_mds);
+
   return MDFunctionExecResult::kSuccess;
 }
 
@@ -97,9 +142,13 @@ void ExecuteWhenMetadataIsReady(const OpInvocation& invocation,
   arguments_copy.reserve(arguments.size());
   for (size_t i = 0, e = arguments.size(); i != e; ++i) {
     // Collect the unavailable async metadata values that caused us to get into
-    // this slow path.  We hand these off to RunWhenReady.
-    const AsyncValueRef<TensorMetadata>& md = arguments[i].GetAsyncMetadata();
-    if (md.IsUnavailable()) async_mds.push_back(md.GetAsyncValue());
+    // this slow path.  We hand these off to RunWhenReady.  Arguments whose
+    // metadata is already available (e.g. stored inline in the handle) have
+    // nothing to wait for.
+    if (!arguments[i].IsMetadataAvailable()) {
+      const AsyncValueRef<TensorMetadata>& md = arguments[i].GetAsyncMetadata();
+      if (md.IsUnavailable()) async_mds.push_back(md.GetAsyncValue());
+    }
 
     // We need to take the arguments so they are guaranteed to live for the
     // duration of the RunWhenReady closure.
@@ -163,6 +212,12 @@ void ExecuteWhenMetadataIsReady(const OpInvocation& invocation,
         SmallVector<TensorMetadata, 4> argument_mds;
         argument_mds.reserve(arguments.size());
         for (size_t i = 0, e = arguments.size(); i != e; ++i) {
+          // Metadata stored inline in the handle is available by definition.
+          if (arguments[i].IsMetadataAvailable()) {
+            argument_mds.push_back(arguments[i].GetAvailableMetadata());
+            continue;
+          }
+
           const AsyncValueRef<TensorMetadata>& arg_md_av =
               arguments[i].GetAsyncMetadata();
 
@@ -143,19 +143,19 @@ static llvm::Expected<TensorHandle> ConstStringTensor(ArrayAttr shape,
                                                       AggregateAttr value,
                                                       HostContext *host) {
   TensorMetadata metadata(DType(DType::String), shape.GetValue<int64_t>());
+  assert(metadata.shape.GetNumElements() == value.GetNumElements());
 
-  auto tensor_ref =
-      StringHostTensor::MakeConstructedAsyncValueRef(metadata, host);
-  if (!tensor_ref)
-    return MakeStringError("failed to allocate string host tensor");
-
-  auto strings = tensor_ref.get().strings();
-  assert(strings.size() == value.GetNumElements());
-
-  for (int i = 0, e = strings.size(); i != e; ++i) {
-    strings[i] = value.GetAttributeOfType<StringAttr>(i).GetValue().str();
+  SmallVector<string_view, 8> values_sv;
+  values_sv.reserve(value.GetNumElements());
+  for (int i = 0, e = value.GetNumElements(); i != e; ++i) {
+    values_sv.push_back(value.GetAttributeOfType<StringAttr>(i).GetValue());
   }
 
+  auto tensor = StringHostTensor::CreateFromStrings(metadata, values_sv, host);
+  if (!tensor) return MakeStringError("failed to allocate string host tensor");
+
+  auto tensor_ref = host->MakeConstructedAsyncValueRef<StringHostTensor>(
+      std::move(*tensor));
   tensor_ref.SetStateConcrete();
 
   return TensorHandle(metadata, std::move(tensor_ref));
@@ -193,6 +193,15 @@ static void ExecuteOpImpl(CoreRuntime *core_rt, OpHandler *op_handler,
       auto array_attr = attr.cast<ArrayAttr>();
       op_attrs.SetRaw(key, array_attr.GetElements(),
                       array_attr.GetNumElements(), type);
+    } else if (IsFlatAggregateAttribute(attribute_type)) {
+      // Flat aggregates (e.g. strides, paddings) carry one contiguous scalar
+      // payload; forward it as a flat array.
+      auto type = GetOpAttrTypeFromBEFAttributeType(
+          GetElementAttributeType(attribute_type));
+      auto flat_attr = attr.cast<FlatAggregateAttr>();
+      op_attrs.SetRaw(key, flat_attr.GetElements(),
+                      flat_attr.GetNumElements() * flat_attr.GetElementSize(),
+                      type);
     } else if (IsDenseAttribute(attribute_type)) {
       auto r = op_attrs.Set(key, attr.cast<DenseAttr>());
       assert(r);
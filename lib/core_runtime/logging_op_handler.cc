@@ -20,8 +20,11 @@
 
 #include <unistd.h>
 
+#include <atomic>
 #include <system_error>
+#include <vector>
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
@@ -32,6 +35,7 @@
 #include "tfrt/core_runtime/op_handler_factory.h"
 #include "tfrt/core_runtime/op_invocation.h"
 #include "tfrt/core_runtime/tensor_handle.h"
+#include "tfrt/host_context/host_context.h"
 #include "tfrt/host_context/kernel_utils.h"
 #include "tfrt/support/error_util.h"
 #include "tfrt/support/mutex.h"
@@ -44,6 +48,107 @@ namespace tfrt {
 
 namespace {
 
+// A spool of formatted log records. Sampled dispatches append to a
+// per-thread buffer, so appends are uncontended in steady state (the same
+// pattern as tracing::KernelCycleTraceBuffer), and a task on the blocking
+// work queue drains all buffers to the output stream: the dispatch path
+// never writes to a file descriptor.
+class LogRecordSpool {
+ public:
+  explicit LogRecordSpool(llvm::raw_ostream& os) : os_(os) {}
+
+  ~LogRecordSpool() { Drain(); }
+
+  // Append `record` to the calling thread's buffer and make sure a drain
+  // task is scheduled.
+  void Append(HostContext* host, std::string record) {
+    ThreadBuffer* buffer = GetBufferForCurrentThread();
+    {
+      mutex_lock lock(buffer->mu);
+      buffer->records.push_back(std::move(record));
+    }
+
+    // Schedule at most one drain task at a time. Writing the records is
+    // file I/O, so it belongs on the blocking work queue; if that queue
+    // cannot take the task, drain inline rather than losing records.
+    if (drain_scheduled_.exchange(true)) return;
+    if (!host->EnqueueBlockingWork([this] {
+          Drain();
+          drain_scheduled_.store(false);
+        })) {
+      Drain();
+      drain_scheduled_.store(false);
+    }
+  }
+
+  // Write `record` to the stream immediately, bypassing the per-thread
+  // buffers. Used by the sync_logging handler, whose output must interleave
+  // deterministically with the ops it logs.
+  void WriteNow(std::string record) {
+    mutex_lock lock(os_mu_);
+    os_ << record;
+    os_.flush();
+  }
+
+  // Write out the records of all threads' buffers. One thread's records
+  // stay in order; records from different threads may interleave at record
+  // granularity, as they always could.
+  void Drain() {
+    std::vector<std::string> records;
+    mutex_lock os_lock(os_mu_);
+    mutex_lock registry_lock(registry_mu_);
+    for (auto& buffer : buffers_) {
+      {
+        mutex_lock lock(buffer->mu);
+        records.swap(buffer->records);
+      }
+      for (auto& record : records) os_ << record;
+      records.clear();
+    }
+    os_.flush();
+  }
+
+ private:
+  struct ThreadBuffer {
+    mutex mu;
+    std::vector<std::string> records TFRT_GUARDED_BY(mu);
+  };
+
+  ThreadBuffer* GetBufferForCurrentThread() {
+    // Cache the buffer per (spool, thread). The generation check keeps a
+    // stale cache entry from resurrecting the buffer of a destroyed spool
+    // whose address was reused by a newer one.
+    struct CacheEntry {
+      uint64_t generation;
+      ThreadBuffer* buffer;
+    };
+    thread_local llvm::SmallDenseMap<LogRecordSpool*, CacheEntry, 2> cache;
+    auto& entry = cache[this];
+    if (entry.buffer && entry.generation == generation_) return entry.buffer;
+
+    auto buffer = std::make_unique<ThreadBuffer>();
+    entry = {generation_, buffer.get()};
+    mutex_lock lock(registry_mu_);
+    buffers_.push_back(std::move(buffer));
+    return entry.buffer;
+  }
+
+  static std::atomic<uint64_t> next_generation_;
+  const uint64_t generation_ = next_generation_.fetch_add(1) + 1;
+
+  llvm::raw_ostream& os_;
+  mutex os_mu_;
+
+  // True while a drain task is scheduled or running.
+  std::atomic<bool> drain_scheduled_{false};
+
+  mutex registry_mu_;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_
+      TFRT_GUARDED_BY(registry_mu_);
+};
+
+std::atomic<uint64_t> LogRecordSpool::next_generation_{0};
+
 // TODO(tf-runtime-team): Rename it.
 class LoggingOpHandler : public OpHandler {
  public:
@@ -74,21 +179,51 @@ class LoggingOpHandler : public OpHandler {
       tensor_dump_prefix_str = tensor_dump_prefix;
     }
 
+    // Sampling configuration. The default interval of 1 logs every dispatch
+    // (the historical behavior); an interval of N logs one dispatch in N,
+    // and 0 disables logging. Per-op overrides are a comma separated list of
+    // op_name=interval pairs, e.g. "tfrt_test.matmul=100,tfrt_test.relu=0".
+    uint32_t sample_interval = 1;
+    if (auto sample_interval_env = std::getenv("LOGGING_SAMPLE_INTERVAL")) {
+      uint32_t value;
+      if (!string_view(sample_interval_env).getAsInteger(10, value))
+        sample_interval = value;
+    }
+
+    llvm::StringMap<uint32_t> sample_overrides;
+    if (auto sample_overrides_env = std::getenv("LOGGING_SAMPLE_OVERRIDES")) {
+      SmallVector<string_view, 4> entries;
+      string_view(sample_overrides_env)
+          .split(entries, ',', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+      for (auto entry : entries) {
+        auto name_and_interval = entry.split('=');
+        uint32_t value;
+        if (!name_and_interval.first.empty() &&
+            !name_and_interval.second.getAsInteger(10, value))
+          sample_overrides[name_and_interval.first] = value;
+      }
+    }
+
     auto op_handler = std::make_unique<LoggingOpHandler>(
         runtime, fallback, sync_log_results, std::move(tensor_dump_prefix_str),
-        std::move(metadata_ostream));
+        std::move(metadata_ostream), sample_interval,
+        std::move(sample_overrides));
     return op_handler;
   }
 
   explicit LoggingOpHandler(
       CoreRuntime *runtime, OpHandler *fallback, bool sync_log_results,
       std::string tensor_dump_prefix,
-      std::unique_ptr<llvm::raw_fd_ostream> metadata_ostream)
+      std::unique_ptr<llvm::raw_fd_ostream> metadata_ostream,
+      uint32_t sample_interval, llvm::StringMap<uint32_t> sample_overrides)
       : OpHandler((sync_log_results ? "sync_logging" : "logging"), runtime,
                   fallback),
         sync_log_results_(sync_log_results),
         tensor_dump_prefix_(std::move(tensor_dump_prefix)),
-        metadata_ostream_(std::move(metadata_ostream)) {}
+        metadata_ostream_(std::move(metadata_ostream)),
+        spool_(*metadata_ostream_),
+        sample_interval_(sample_interval),
+        sample_overrides_(std::move(sample_overrides)) {}
 
   Expected<CoreRuntimeOp> MakeOp(string_view op_name) override;
 
@@ -163,12 +298,38 @@ class LoggingOpHandler : public OpHandler {
     }
     os << "\n";
 
-    Print(os.str().c_str());
+    os.flush();
+    Print(std::move(message));
+  }
+
+  void Print(std::string contents) {
+    // The sync_logging handler keeps the historical synchronous write, so
+    // its output interleaves deterministically with the ops it logs; the
+    // logging handler spools records per thread and drains them on the
+    // blocking work queue, keeping file I/O off the dispatch path.
+    if (sync_log_results_)
+      spool_.WriteNow(std::move(contents));
+    else
+      spool_.Append(GetRuntime()->GetHostContext(), std::move(contents));
   }
 
-  void Print(string_view contents) {
-    mutex_lock lock(mu_);
-    *metadata_ostream_ << contents;
+  // Resolve the sampling interval for `op_name`: a per-op override when one
+  // is configured, the global interval otherwise.
+  uint32_t SampleIntervalForOp(string_view op_name) const {
+    auto it = sample_overrides_.find(op_name);
+    return it == sample_overrides_.end() ? sample_interval_ : it->second;
+  }
+
+  // Return the sampling countdown shared by every prepared instance of
+  // `op_name`, so they all draw from one decrement stream.
+  std::atomic<int32_t> *GetSampleCountdown(string_view op_name,
+                                           uint32_t interval) {
+    mutex_lock lock(sample_mu_);
+    auto &slot = sample_countdowns_[op_name];
+    if (!slot)
+      slot = std::make_unique<std::atomic<int32_t>>(
+          static_cast<int32_t>(interval));
+    return slot.get();
   }
 
   void FlattenTensorAndDumpToOStream(const DenseHostTensor &dht,
@@ -212,17 +373,52 @@ class LoggingOpHandler : public OpHandler {
   std::atomic<uint32_t> log_counter_{0};
   std::string tensor_dump_prefix_;
 
-  mutable mutex mu_;
-  std::unique_ptr<llvm::raw_fd_ostream> metadata_ostream_ TFRT_GUARDED_BY(mu_);
+  // The spool references *metadata_ostream_ and drains to it on
+  // destruction, so it must be declared after the stream.
+  std::unique_ptr<llvm::raw_fd_ostream> metadata_ostream_;
+  LogRecordSpool spool_;
+
+  // Log one dispatch in sample_interval_ (1 = every dispatch, 0 = none),
+  // unless sample_overrides_ has a per-op interval.
+  const uint32_t sample_interval_;
+  llvm::StringMap<uint32_t> sample_overrides_;
+
+  mutable mutex sample_mu_;
+  llvm::StringMap<std::unique_ptr<std::atomic<int32_t>>> sample_countdowns_
+      TFRT_GUARDED_BY(sample_mu_);
 };
 }  // namespace
 
 Expected<CoreRuntimeOp> LoggingOpHandler::MakeOp(string_view op_name) {
   auto fallback_handle = GetFallback()->MakeOp(op_name);
   if (!fallback_handle) return fallback_handle.takeError();
-  return CoreRuntimeOp([this, op_name = op_name.str(),
+
+  // Resolve the sampling decision state up front, so the not-sampled
+  // dispatch path below is a single decrement-and-branch. An interval of 1
+  // needs no countdown (every dispatch is logged), and an interval of 0
+  // disables logging for the op entirely.
+  const uint32_t interval = SampleIntervalForOp(op_name);
+  std::atomic<int32_t> *countdown =
+      interval > 1 ? GetSampleCountdown(op_name, interval) : nullptr;
+
+  return CoreRuntimeOp([this, op_name = op_name.str(), interval, countdown,
                         fallback_handle = std::move(fallback_handle.get())](
                            const OpInvocation &invocation) mutable {
+    if (interval == 0) {
+      fallback_handle(invocation);
+      return;
+    }
+    if (countdown != nullptr) {
+      if (countdown->fetch_sub(1, std::memory_order_relaxed) != 1) {
+        fallback_handle(invocation);
+        return;
+      }
+      // The reset may race with concurrent decrements and drop a tick or
+      // two; sampling is approximate by design.
+      countdown->store(static_cast<int32_t>(interval),
+                       std::memory_order_relaxed);
+    }
+
     // TODO(tf-runtime-team): Make this class thread safe.
     auto id_number = log_counter_.fetch_add(1);
 
@@ -248,7 +444,8 @@ Expected<CoreRuntimeOp> LoggingOpHandler::MakeOp(string_view op_name) {
         invocation.attrs.Print(os);
       }
 
-      Print(os.str());
+      os.flush();
+      Print(std::move(message));
     }
 
     {
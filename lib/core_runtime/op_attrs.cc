@@ -20,13 +20,15 @@
 
 #include "tfrt/core_runtime/op_attrs.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/STLExtras.h"
-#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Alignment.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include "tfrt/support/bef_encoding.h"
+#include "tfrt/support/string_interner.h"
 #include "tfrt/tensor/tensor_serialize_utils.h"
 
 namespace tfrt {
@@ -81,19 +83,54 @@ class ImmutableOpAttrs : public ReferenceCounted<ImmutableOpAttrs> {
   friend class ReferenceCounted<ImmutableOpAttrs>;
   friend class OpAttrs;
 
+  // Sets smaller than this are faster to scan linearly than to hash the
+  // name, so they don't get a hash index at all.
+  static constexpr size_t kMinEntriesForHashIndex = 5;
+
+  // Marks an unused slot in the hash index.
+  static constexpr uint32_t kEmptyBucket = ~0u;
+
+  // Return the number of buckets in the hash index for a set of
+  // `num_entries` attributes: zero for small sets, otherwise a power of two
+  // holding the entries at a load factor of at most 1/2.
+  static size_t GetNumHashBuckets(size_t num_entries) {
+    if (num_entries < kMinEntriesForHashIndex) return 0;
+    return llvm::PowerOf2Ceil(num_entries * 2);
+  }
+
   static RCReference<ImmutableOpAttrs> create(const OpAttrs &attrs);
-  explicit ImmutableOpAttrs(size_t num_entries) : num_entries_(num_entries) {}
+  ImmutableOpAttrs(size_t num_entries, size_t num_buckets)
+      : num_entries_(num_entries), num_buckets_(num_buckets) {}
 
   void Destroy();
 
+  // The hash index is tail allocated right after the entries.
+  uint32_t *buckets() {
+    return reinterpret_cast<uint32_t *>(&entries_[num_entries_]);
+  }
+  const uint32_t *buckets() const {
+    return reinterpret_cast<const uint32_t *>(&entries_[num_entries_]);
+  }
+
   // This is the number of entries in this set.
   size_t num_entries_;
 
-  // The entries_ array is tail allocated here, and followed by the payload
-  // data for the attributes.
+  // The number of buckets in the hash index, or zero if this set is small
+  // enough that lookups scan the entries directly.
+  size_t num_buckets_;
+
+  // The entries_ array is tail allocated here, and followed by the hash
+  // index (if any) and the payload data for the attributes.
   OpAttrsRawEntry entries_[];
 };
 
+// Hash an interned name pointer for the frozen hash index. Names are
+// canonical (one pointer per distinct string), so hashing the pointer value
+// stands in for hashing the string.
+static size_t HashInternedName(const char *name) {
+  return llvm::hash_value(static_cast<const void *>(name));
+}
+
 // Return the size and alignment of the specified attribute type.
 std::pair<size_t, size_t> GetHostSizeAndAlignment(const void *data,
                                                   OpAttrType type) {
@@ -114,6 +151,8 @@ std::pair<size_t, size_t> GetHostSizeAndAlignment(const void *data,
     }
     case OpAttrType::F16:
       return {sizeof(fp16), alignof(fp16)};
+    case OpAttrType::BF16:
+      return {sizeof(bf16), alignof(bf16)};
 #define OP_ATTR_TYPE(ENUM, CPP_TYPE) \
   case OpAttrType::ENUM:             \
     return {sizeof(CPP_TYPE), alignof(CPP_TYPE)};
@@ -134,6 +173,8 @@ const char *GetNameString(OpAttrType type) {
       return "SHAPE";
     case OpAttrType::F16:
       return "F16";
+    case OpAttrType::BF16:
+      return "BF16";
 #define OP_ATTR_TYPE(ENUM, CPP_TYPE) \
   case OpAttrType::ENUM:             \
     return #ENUM;
@@ -169,7 +210,12 @@ class OpAttrs::OutOfLineRepresentation {
   }
 
   const OpAttrsRawEntry *GetRaw(string_view attr_name) const {
-    auto it = entries_.find(attr_name);
+    // Entries are keyed by the canonical interned name, so a name that was
+    // never interned anywhere cannot be present, and a hit costs one
+    // integer-keyed probe.
+    InternedName name = StringInterner::Global().Find(attr_name);
+    if (!name) return nullptr;
+    auto it = entries_.find(name.c_str());
     return it == entries_.end() ? nullptr : &it->second;
   }
 
@@ -179,7 +225,7 @@ class OpAttrs::OutOfLineRepresentation {
   size_t GetNumEntries() const { return entries_.size(); }
 
  public:
-  llvm::StringMap<OpAttrsRawEntry> entries_;
+  llvm::DenseMap<const char *, OpAttrsRawEntry> entries_;
   llvm::BumpPtrAllocatorImpl<llvm::MallocAllocator, 256, 256> allocator_;
 };
 
@@ -199,9 +245,11 @@ bool OpAttrs::OutOfLineRepresentation::SetRaw(string_view attr_name,
                                               const void *data,
                                               ssize_t num_elements,
                                               OpAttrType type) {
-  // Figure out what entry we need to fill in.
+  // Figure out what entry we need to fill in, keyed by the canonical
+  // interned name.
+  InternedName name = StringInterner::Global().Intern(attr_name);
   auto entry_it_pair =
-      entries_.insert(std::make_pair(attr_name, OpAttrsRawEntry()));
+      entries_.insert(std::make_pair(name.c_str(), OpAttrsRawEntry()));
 
   // If it is already present, then return false to indicate a conflict.
   if (entry_it_pair.second == false) return false;
@@ -245,7 +293,7 @@ bool OpAttrs::OutOfLineRepresentation::SetRaw(string_view attr_name,
     memcpy(entry.buffer, data, bytes_to_copy);
   }
 
-  entry.name = entry_it_pair.first->first().data();
+  entry.name = name.c_str();
   entry.array_size = num_elements;
   entry.type = type;
   return true;
@@ -288,9 +336,13 @@ const OpAttrsRawEntry *OpAttrs::GetRaw(string_view attr_name) const {
   if (auto *out_of_line = out_of_line_representation_.get())
     return out_of_line->GetRaw(attr_name);
 
+  // All stored names are interned, so a name that was never interned cannot
+  // be present, and the scan is pointer comparisons instead of strcmps.
+  InternedName name = StringInterner::Global().Find(attr_name);
+  if (!name) return nullptr;
   for (size_t i = 0, e = num_inline_entries_; i != e; ++i) {
     auto &entry = inline_entries_[i];
-    if (strcmp(attr_name.data(), entry.name) == 0) return &entry;
+    if (entry.name == name.c_str()) return &entry;
   }
   return nullptr;
 }
@@ -312,11 +364,12 @@ bool OpAttrs::SetRaw(string_view attr_name, const void *data,
   if (auto *out_of_line = out_of_line_representation_.get())
     return out_of_line->SetRaw(attr_name, data, num_elements, type);
 
-  // Otherwise, we need to find out if this entry has already been installed.
-  // If so, we return failure.
+  // Names are stored as canonical interned pointers, so the duplicate check
+  // is pointer comparisons, and the name consumes no inline buffer space.
+  InternedName name = StringInterner::Global().Intern(attr_name);
   for (size_t i = 0, e = num_inline_entries_; i != e; ++i) {
     auto &entry = inline_entries_[i];
-    if (strcmp(attr_name.data(), entry.name) == 0) return false;
+    if (entry.name == name.c_str()) return false;
   }
 
   // Ok, we're going to do an insertion.  If we are out of space in
@@ -327,22 +380,6 @@ bool OpAttrs::SetRaw(string_view attr_name, const void *data,
                                                type);
   }
 
-  // We also need space in inline_buffer_.
-  auto *name_pointer = inline_buffer_ + inline_buffer_used_;
-  auto attr_name_size = attr_name.size();
-  inline_buffer_used_ += attr_name_size + 1;
-
-  // If we are out of space, then switch to an out-of-line representation.
-  if (inline_buffer_used_ > kInlineBufferSize) {
-    MoveOutOfLine();
-    return out_of_line_representation_->SetRaw(attr_name, data, num_elements,
-                                               type);
-  }
-
-  // Otherwise, we have space, so copy over the string.
-  memcpy(name_pointer, attr_name.data(), attr_name_size);
-  name_pointer[attr_name_size] = 0;  // Null terminate C string.
-
   auto type_size_and_alignment = GetHostSizeAndAlignment(data, type);
   auto type_size = type_size_and_alignment.first;
   auto type_alignment = type_size_and_alignment.second;
@@ -353,7 +390,7 @@ bool OpAttrs::SetRaw(string_view attr_name, const void *data,
       num_elements == OpAttrsRawEntry::kScalarSentinel) {
     // Fill in the attribute entry.
     auto &entry = inline_entries_[num_inline_entries_++];
-    entry.name = name_pointer;
+    entry.name = name.c_str();
 
     assert(type_alignment <= alignof(void *));
     memcpy(entry.buffer, data, type_size);
@@ -403,7 +440,7 @@ bool OpAttrs::SetRaw(string_view attr_name, const void *data,
 
   // Fill in the attribute entry.
   auto &entry = inline_entries_[num_inline_entries_++];
-  entry.name = name_pointer;
+  entry.name = name.c_str();
   entry.data = dest_pointer;
   entry.array_size = num_elements;
   entry.type = type;
@@ -435,20 +472,21 @@ RCReference<ImmutableOpAttrs> ImmutableOpAttrs::create(const OpAttrs &attrs) {
   SmallVector<const OpAttrsRawEntry *, 16> sorted_attrs;
   GetSortedAttrs(OpAttrsRef(attrs), &sorted_attrs);
 
-  // Figure out how much space we need to hold these attributes.
-  size_t alloc_size =
-      sizeof(ImmutableOpAttrs) + sizeof(OpAttrsRawEntry) * sorted_attrs.size();
+  // Figure out how much space we need to hold these attributes, including
+  // the hash index that makes GetRaw a single probe for large sets.
+  size_t num_buckets = GetNumHashBuckets(sorted_attrs.size());
+  size_t alloc_size = sizeof(ImmutableOpAttrs) +
+                      sizeof(OpAttrsRawEntry) * sorted_attrs.size() +
+                      sizeof(uint32_t) * num_buckets;
 
   // TODO(clattner): When coming from an inlined representation (the vastly most
   // common case, we should be able to memcpy over one big block of memory and
   // update pointers, instead of doing several small memcpy's.
 
-  // Figure out how much space we need for each entry, which is the space for
-  // the name and the payload together:
+  // Figure out how much space we need for each entry. Names are canonical
+  // interned pointers that live for the process, so only the payload is
+  // copied:
   for (auto *entry : sorted_attrs) {
-    // Space for the name and null terminator.
-    alloc_size += strlen(entry->name) + 1;
-
     // If this is an array attribute, then we need to emit the BEF array size.
     // It will have the same size as the array size in the source.
     if (entry->IsArray()) alloc_size += GetBEFArraySizeSize(entry->data);
@@ -465,26 +503,24 @@ RCReference<ImmutableOpAttrs> ImmutableOpAttrs::create(const OpAttrs &attrs) {
 
   // Now that we know the size, create the result.
   auto *raw_memory = malloc(alloc_size);
-  auto *result = new (raw_memory) ImmutableOpAttrs(sorted_attrs.size());
+  auto *result =
+      new (raw_memory) ImmutableOpAttrs(sorted_attrs.size(), num_buckets);
 
   char *data_ptr = static_cast<char *>(raw_memory) + sizeof(ImmutableOpAttrs) +
-                   sizeof(OpAttrsRawEntry) * sorted_attrs.size();
+                   sizeof(OpAttrsRawEntry) * sorted_attrs.size() +
+                   sizeof(uint32_t) * num_buckets;
 
   // Copy all of the attributes over.
   for (size_t i = 0, e = sorted_attrs.size(); i != e; ++i) {
     const auto &src_entry = *sorted_attrs[i];
     auto &result_entry = result->entries_[i];
 
-    // Copy simple properties.
+    // Copy simple properties. The name pointer is canonical and immortal,
+    // so it is shared rather than copied.
+    result_entry.name = src_entry.name;
     result_entry.array_size = src_entry.array_size;
     result_entry.type = src_entry.type;
 
-    // Copy the name over.
-    result_entry.name = data_ptr;
-    auto name_len = strlen(src_entry.name);
-    memcpy(data_ptr, src_entry.name, name_len + 1);
-    data_ptr += name_len + 1;
-
     auto size_and_alignment =
         GetHostSizeAndAlignment(src_entry.data, src_entry.type);
     auto type_size = size_and_alignment.first;
@@ -516,6 +552,22 @@ RCReference<ImmutableOpAttrs> ImmutableOpAttrs::create(const OpAttrs &attrs) {
     }
   }
 
+  // Build the hash index: an open addressed table over the canonical name
+  // pointers with linear probing. At a load factor of at most 1/2, lookups
+  // almost always hit on the first probe.
+  if (num_buckets != 0) {
+    uint32_t *buckets = result->buckets();
+    memset(buckets, 0xFF, sizeof(uint32_t) * num_buckets);
+
+    size_t bucket_mask = num_buckets - 1;
+    for (size_t i = 0, e = result->num_entries_; i != e; ++i) {
+      size_t bucket = HashInternedName(result->entries_[i].name) & bucket_mask;
+      while (buckets[bucket] != kEmptyBucket)
+        bucket = (bucket + 1) & bucket_mask;
+      buckets[bucket] = i;
+    }
+  }
+
   return TakeRef(result);
 }
 
@@ -533,12 +585,29 @@ void ImmutableOpAttrs::Destroy() {
 // Look up an attribute by name, regardless of its underlying type.
 // On lookup failure, the result is null.
 const OpAttrsRawEntry *ImmutableOpAttrs::GetRaw(string_view attr_name) const {
+  // All stored names are interned, so a name that was never interned cannot
+  // be present, and every comparison below is a pointer comparison.
+  InternedName name = StringInterner::Global().Find(attr_name);
+  if (!name) return nullptr;
+
   // If we only have a few entries, do a linear search for the name.
-  // TODO(tf_runtime_team): implement a binary search for more elements.
-  for (size_t i = 0, e = num_entries_; i != e; ++i) {
-    if (!strcmp(entries_[i].name, attr_name.data())) return &entries_[i];
+  if (num_buckets_ == 0) {
+    for (size_t i = 0, e = num_entries_; i != e; ++i) {
+      if (entries_[i].name == name.c_str()) return &entries_[i];
+    }
+    return nullptr;
+  }
+
+  // Otherwise probe the hash index, which almost always resolves the name
+  // with a single memory access.
+  const uint32_t *buckets = this->buckets();
+  size_t bucket_mask = num_buckets_ - 1;
+  for (size_t bucket = HashInternedName(name.c_str()) & bucket_mask;;
+       bucket = (bucket + 1) & bucket_mask) {
+    uint32_t index = buckets[bucket];
+    if (index == kEmptyBucket) return nullptr;
+    if (entries_[index].name == name.c_str()) return &entries_[index];
   }
-  return nullptr;
 }
 
 // Iterate over all of the entries in the attribute set, allowing dynamic
@@ -646,6 +715,9 @@ static void PrintElement(const void *ptr, OpAttrType type, raw_ostream &os) {
       // TODO(b/149063226): Support FP16.
       assert(0 && "cannot print fp16 yet.");
       break;
+    case OpAttrType::BF16:
+      assert(0 && "cannot print bf16 yet.");
+      break;
 #define OP_ATTR_TYPE(ENUM, CPP_TYPE)           \
   case OpAttrType::ENUM:                       \
     os << *static_cast<const CPP_TYPE *>(ptr); \
@@ -0,0 +1,157 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- op_stream.cc -------------------------------------------------------===//
+//
+// This file implements OpStream, an ordered op submission queue.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/core_runtime/op_stream.h"
+
+#include "tfrt/core_runtime/core_runtime.h"
+#include "tfrt/core_runtime/op_attrs.h"
+#include "tfrt/core_runtime/tensor_handle.h"
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/host_context.h"
+
+namespace tfrt {
+
+OpStream::OpStream(CoreRuntime* runtime, OpHandler* op_handler)
+    : runtime_(runtime),
+      op_handler_(op_handler),
+      last_event_(runtime->GetHostContext()->GetReadyChain()) {}
+
+OpStream::~OpStream() {}
+
+void OpStream::Execute(string_view op_name, Location loc,
+                       MutableArrayRef<TensorHandle> arguments,
+                       const OpAttrsRef& attrs,
+                       MutableArrayRef<TensorHandle> results) {
+  HostContext* host = runtime_->GetHostContext();
+
+  // Take the arguments so they are guaranteed to live until the stream
+  // reaches this op.
+  SmallVector<TensorHandle, 4> arguments_copy;
+  arguments_copy.reserve(arguments.size());
+  for (auto& argument : arguments)
+    arguments_copy.push_back(std::move(argument));
+
+  // Hand the caller placeholder results now; they are forwarded to the real
+  // results once the op is dispatched. Neither the result metadata nor the
+  // tensor subclass is known yet, so both sides are IndirectAsyncValue's.
+  SmallVector<RCReference<IndirectAsyncValue>, 8> result_avs;
+  result_avs.reserve(results.size() * 2);
+  for (auto& result : results) {
+    auto md = host->MakeIndirectAsyncValue();
+    auto tensor = host->MakeIndirectAsyncValue();
+    result_avs.push_back(md.CopyRef());
+    result_avs.push_back(tensor.CopyRef());
+    result = TensorHandle(AsyncValueRef<TensorMetadata>(std::move(md)),
+                          AsyncValueRef<Tensor>(std::move(tensor)));
+  }
+
+  // Append this op to the stream: it waits on the completion event of the
+  // previously enqueued work, and publishes its own completion event for the
+  // next op to wait on.
+  auto done = host->MakeUnconstructedAsyncValueRef<Chain>();
+  AsyncValueRef<Chain> prev;
+  {
+    mutex_lock lock(mu_);
+    prev = std::move(last_event_);
+    last_event_ = done.CopyRef();
+  }
+
+  SmallVector<AsyncValue*, 1> prev_av{prev.GetAsyncValue()};
+  host->RunWhenReady(
+      prev_av,
+      [this, host, op_name = op_name.str(), loc,
+       frozen_attrs = attrs.freeze(), prev = std::move(prev),
+       arguments = std::move(arguments_copy),
+       result_avs = std::move(result_avs), done = std::move(done)]() mutable {
+        size_t num_results = result_avs.size() / 2;
+        SmallVector<TensorHandle, 4> op_results;
+        op_results.resize(num_results);
+
+        // The stream's event doubles as the op's in chain, so side effecting
+        // ops are ordered behind everything the stream already ran and any
+        // error on the stream reaches them.
+        AsyncValueRef<Chain> op_chain = std::move(prev);
+        runtime_->Execute(op_name, op_handler_, loc, arguments, frozen_attrs,
+                          op_results, &op_chain);
+
+        // Fulfill the placeholders handed out at enqueue time.
+        for (size_t i = 0; i != num_results; ++i) {
+          auto& op_result = op_results[i];
+          assert(op_result.IsValid() && "Execute must fill all results");
+          // Available metadata may be stored inline in the handle with no
+          // async value to share, so republish it as an available value.
+          if (op_result.IsMetadataAvailable()) {
+            result_avs[i * 2]->ForwardTo(
+                host
+                    ->MakeAvailableAsyncValueRef<TensorMetadata>(
+                        op_result.GetAvailableMetadata())
+                    .ReleaseRCRef());
+          } else {
+            result_avs[i * 2]->ForwardTo(
+                op_result.GetAsyncMetadata().CopyRCRef());
+          }
+          result_avs[i * 2 + 1]->ForwardTo(FormRef(op_result.GetAsyncTensor()));
+        }
+
+        // The next op on the stream starts once this op's side effect chain
+        // and all of its result tensors have completed.
+        SmallVector<AsyncValue*, 8> completion;
+        completion.reserve(num_results + 1);
+        for (size_t i = 0; i != num_results; ++i)
+          completion.push_back(result_avs[i * 2 + 1].get());
+        completion.push_back(op_chain.GetAsyncValue());
+        host->RunWhenReady(completion,
+                           [op_chain = std::move(op_chain),
+                            result_avs = std::move(result_avs),
+                            done = std::move(done)] {
+                             if (op_chain.IsError())
+                               done.SetError(op_chain.GetError());
+                             else
+                               done.emplace();
+                           });
+      });
+}
+
+AsyncValueRef<Chain> OpStream::RecordEvent() {
+  mutex_lock lock(mu_);
+  return last_event_.CopyRef();
+}
+
+void OpStream::WaitFor(AsyncValueRef<Chain> event) {
+  HostContext* host = runtime_->GetHostContext();
+  mutex_lock lock(mu_);
+
+  auto merged = host->MakeUnconstructedAsyncValueRef<Chain>();
+  SmallVector<AsyncValue*, 2> deps{last_event_.GetAsyncValue(),
+                                   event.GetAsyncValue()};
+  host->RunWhenReady(deps, [prev = std::move(last_event_),
+                            event = std::move(event),
+                            merged = merged.CopyRef()] {
+    if (prev.IsError())
+      merged.SetError(prev.GetError());
+    else if (event.IsError())
+      merged.SetError(event.GetError());
+    else
+      merged.emplace();
+  });
+  last_event_ = std::move(merged);
+}
+
+}  // namespace tfrt
@@ -0,0 +1,593 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- remote_op_handler.cc -----------------------------------------------===//
+//
+// This file implements the remote op handler and its server loop.
+//
+// The wire protocol is a sequence of length-prefixed frames over a connected
+// stream socket between same-architecture peers (like BEF attributes, the
+// encoding is host-endian). A request carries a request id, the op name, the
+// raw OpAttrs entries and the argument tensors as dense-attr payloads; the
+// response carries the matching request id and either the serialized result
+// tensors or an error message. The client does not wait for a response
+// before sending the next request: result TensorHandles are handed out
+// immediately and resolved by a receiver thread as responses arrive, so
+// independent ops overlap their round trips.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/core_runtime/remote_op_handler.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "tfrt/core_runtime/core_runtime.h"
+#include "tfrt/core_runtime/op_attrs.h"
+#include "tfrt/core_runtime/op_handler.h"
+#include "tfrt/core_runtime/op_invocation.h"
+#include "tfrt/core_runtime/tensor_handle.h"
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/attribute_utils.h"
+#include "tfrt/host_context/chain.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/error_util.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+#include "tfrt/tensor/tensor.h"
+#include "tfrt/tensor/tensor_serialize_utils.h"
+
+namespace tfrt {
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Wire helpers
+//===----------------------------------------------------------------------===//
+
+// Writes all of `size` bytes to `fd`, looping over partial writes. Returns
+// false if the connection is gone.
+bool WriteFull(int fd, const void* data, size_t size) {
+  const char* pos = static_cast<const char*>(data);
+  while (size > 0) {
+    // MSG_NOSIGNAL: report a closed peer as an error instead of SIGPIPE.
+    ssize_t written = ::send(fd, pos, size, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    pos += written;
+    size -= written;
+  }
+  return true;
+}
+
+// Reads exactly `size` bytes from `fd`. Returns false on EOF or error.
+bool ReadFull(int fd, void* data, size_t size) {
+  char* pos = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t count = ::recv(fd, pos, size, 0);
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    if (count == 0) return false;
+    pos += count;
+    size -= count;
+  }
+  return true;
+}
+
+// Appends fixed-width values and byte ranges to a payload buffer.
+class WireWriter {
+ public:
+  template <typename T>
+  void Write(T value) {
+    static_assert(std::is_trivially_copyable<T>::value, "wire types are POD");
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer_.insert(buffer_.end(), bytes, bytes + sizeof(T));
+  }
+
+  void WriteBytes(const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + size);
+  }
+
+  void WriteString(string_view str) {
+    Write<uint32_t>(str.size());
+    WriteBytes(str.data(), str.size());
+  }
+
+  const std::vector<uint8_t>& buffer() const { return buffer_; }
+
+ private:
+  std::vector<uint8_t> buffer_;
+};
+
+// Bounds-checked reader over a received payload. After any failed read,
+// ok() is false and subsequent reads return zero values.
+class WireReader {
+ public:
+  explicit WireReader(ArrayRef<uint8_t> data) : data_(data) {}
+
+  template <typename T>
+  T Read() {
+    T value{};
+    static_assert(std::is_trivially_copyable<T>::value, "wire types are POD");
+    if (!ReadBytes(&value, sizeof(T))) value = T{};
+    return value;
+  }
+
+  bool ReadBytes(void* dest, size_t size) {
+    if (!ok_ || size > data_.size() - pos_) {
+      ok_ = false;
+      return false;
+    }
+    std::memcpy(dest, data_.data() + pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+  std::string ReadString() {
+    uint32_t size = Read<uint32_t>();
+    std::string str(size, '\0');
+    if (!ReadBytes(&str[0], size)) str.clear();
+    return str;
+  }
+
+  bool ok() const { return ok_; }
+
+ private:
+  ArrayRef<uint8_t> data_;
+  size_t pos_ = 0;
+  bool ok_ = true;
+};
+
+// Writes `payload` as one size-prefixed frame.
+bool WriteFrame(int fd, const std::vector<uint8_t>& payload) {
+  uint64_t size = payload.size();
+  return WriteFull(fd, &size, sizeof(size)) &&
+         WriteFull(fd, payload.data(), payload.size());
+}
+
+// Reads one size-prefixed frame into `payload`. Returns false when the
+// connection closes.
+bool ReadFrame(int fd, std::vector<uint8_t>* payload) {
+  uint64_t size;
+  if (!ReadFull(fd, &size, sizeof(size))) return false;
+  payload->resize(size);
+  return ReadFull(fd, payload->data(), size);
+}
+
+//===----------------------------------------------------------------------===//
+// Attribute and tensor serialization
+//===----------------------------------------------------------------------===//
+
+// Serializes the entries of `attrs` into `writer`. Returns false if any
+// entry has a variable-size type (AGGREGATE, DENSE, SHAPE) that the fixed
+// per-element wire encoding cannot carry.
+bool SerializeOpAttrs(const OpAttrsRef& attrs, WireWriter* writer) {
+  writer->Write<uint32_t>(attrs.GetNumEntries());
+  bool ok = true;
+  attrs.IterateEntries([&](const OpAttrsRawEntry& entry) {
+    switch (entry.type) {
+      case OpAttrType::AGGREGATE:
+      case OpAttrType::DENSE:
+      case OpAttrType::SHAPE:
+        ok = false;
+        return;
+      default:
+        break;
+    }
+    size_t element_size =
+        GetHostSizeAndAlignment(entry.GetData(), entry.type).first;
+    size_t num_elements = entry.IsArray() ? entry.array_size : 1;
+    writer->WriteString(entry.name);
+    writer->Write<int64_t>(entry.array_size);
+    writer->Write<uint8_t>(static_cast<uint8_t>(entry.type));
+    writer->Write<uint64_t>(element_size * num_elements);
+    writer->WriteBytes(entry.GetData(), element_size * num_elements);
+  });
+  return ok;
+}
+
+// Reconstructs an OpAttrs set written by SerializeOpAttrs.
+bool DeserializeOpAttrs(WireReader* reader, OpAttrs* attrs) {
+  uint32_t num_entries = reader->Read<uint32_t>();
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    std::string name = reader->ReadString();
+    auto array_size = static_cast<ssize_t>(reader->Read<int64_t>());
+    auto type = static_cast<OpAttrType>(reader->Read<uint8_t>());
+    uint64_t payload_size = reader->Read<uint64_t>();
+    std::vector<uint8_t> payload(payload_size);
+    if (!reader->ReadBytes(payload.data(), payload_size)) return false;
+    if (!attrs->SetRaw(name, payload.data(), array_size, type)) return false;
+  }
+  return reader->ok();
+}
+
+// Writes one dense host tensor as a size-prefixed dense-attr payload.
+void SerializeTensor(const DenseHostTensor& dht, WireWriter* writer) {
+  std::vector<uint8_t> data = SerializeDenseHostTensorToDenseAttr(dht);
+  writer->Write<uint64_t>(data.size());
+  writer->WriteBytes(data.data(), data.size());
+}
+
+// Reads one tensor written by SerializeTensor.
+Expected<DenseHostTensor> DeserializeTensor(WireReader* reader,
+                                            HostContext* host) {
+  uint64_t size = reader->Read<uint64_t>();
+  // Copy the payload out of the frame into a fresh allocation: DenseAttr
+  // requires its data to be aligned, which an offset into the frame buffer
+  // does not guarantee.
+  std::vector<uint8_t> data(size);
+  if (!reader->ReadBytes(data.data(), size))
+    return MakeStringError("malformed tensor payload");
+  return DeserializeDenseHostTensorFromDenseAttr(DenseAttr(data.data()), host);
+}
+
+//===----------------------------------------------------------------------===//
+// RemoteOpHandler
+//===----------------------------------------------------------------------===//
+
+class RemoteOpHandler : public OpHandler {
+ public:
+  RemoteOpHandler(CoreRuntime* runtime, int socket_fd)
+      : OpHandler("remote", runtime, /*fallback=*/nullptr), fd_(socket_fd) {
+    receiver_thread_ = std::thread([this] { ReceiveResponses(); });
+  }
+
+  ~RemoteOpHandler() override {
+    // Shut the socket down first so the receiver observes EOF, fails any
+    // requests still in flight and exits its loop.
+    ::shutdown(fd_, SHUT_RDWR);
+    receiver_thread_.join();
+    ::close(fd_);
+  }
+
+  Expected<CoreRuntimeOp> MakeOp(string_view op_name) override {
+    // Ops are resolved on the peer when the request executes, so every name
+    // makes a valid op here; unknown ops fail with the peer's error.
+    return CoreRuntimeOp(
+        [this](const OpInvocation& invocation) { Dispatch(invocation); });
+  }
+
+  AsyncValueRef<DenseHostTensor> CopyDeviceTensorToHost(
+      const Tensor& tensor) override {
+    auto* host = GetRuntime()->GetHostContext();
+    auto host_tensor = tensor.ConvertToHostTensor(
+        host, 1 << static_cast<uint32_t>(Tensor::Subclass::DenseHost));
+    return AsyncValueRef<DenseHostTensor>(host_tensor.ReleaseRCRef());
+  }
+
+  AsyncValueRef<Tensor> CopyHostTensorToDevice(
+      const DenseHostTensor& tensor) override {
+    // Remote op results live in host memory on this side of the connection.
+    return AsyncValueRef<Tensor>(
+        GetRuntime()->GetHostContext()->MakeAvailableAsyncValueRef<
+            DenseHostTensor>(tensor.CopyRef()));
+  }
+
+ private:
+  // One result TensorHandle waiting for its response.
+  struct PendingResult {
+    AsyncValueRef<TensorMetadata> metadata;
+    RCReference<IndirectAsyncValue> tensor;
+  };
+  using PendingOp = llvm::SmallVector<PendingResult, 4>;
+
+  void Dispatch(const OpInvocation& invocation);
+  void SendRequest(uint64_t request_id, const std::string& op_name,
+                   const OpAttrsRef& attrs,
+                   ArrayRef<RCReference<AsyncValue>> arg_tensors,
+                   size_t num_results);
+  void ReceiveResponses();
+
+  // Removes the pending op for `request_id` (if still present) and resolves
+  // all of its results to `message`.
+  void FailPending(uint64_t request_id, string_view message);
+  void FailAllPending(string_view message);
+  static void FailResults(PendingOp* pending, string_view message,
+                          HostContext* host);
+
+  int fd_;
+  mutex send_mu_;
+  std::atomic<uint64_t> next_request_id_{1};
+  mutex pending_mu_;
+  llvm::DenseMap<uint64_t, PendingOp> pending_ TFRT_GUARDED_BY(pending_mu_);
+  std::thread receiver_thread_;
+};
+
+void RemoteOpHandler::Dispatch(const OpInvocation& invocation) {
+  auto* host = GetRuntime()->GetHostContext();
+  uint64_t request_id =
+      next_request_id_.fetch_add(1, std::memory_order_relaxed);
+
+  // Hand out future result handles right away; the receiver thread resolves
+  // them when the response arrives. This is what lets the caller dispatch
+  // the next op without waiting for this round trip.
+  PendingOp pending;
+  pending.reserve(invocation.results.size());
+  for (auto& result : invocation.results) {
+    auto metadata = host->MakeUnconstructedAsyncValueRef<TensorMetadata>();
+    auto tensor = host->MakeIndirectAsyncValue();
+    result = TensorHandle(metadata.CopyRef(),
+                          AsyncValueRef<Tensor>(tensor.CopyRef()));
+    pending.push_back({std::move(metadata), std::move(tensor)});
+  }
+  size_t num_results = invocation.results.size();
+  {
+    mutex_lock lock(pending_mu_);
+    pending_[request_id] = std::move(pending);
+  }
+
+  // Keep the argument tensors alive past the invocation; the handles on the
+  // caller's stack may be destroyed before the arguments resolve.
+  llvm::SmallVector<RCReference<AsyncValue>, 4> arg_tensors;
+  llvm::SmallVector<AsyncValue*, 4> unavailable;
+  for (auto& argument : invocation.arguments) {
+    AsyncValue* tensor = argument.GetAsyncTensor();
+    arg_tensors.push_back(FormRef(tensor));
+    if (!tensor->IsAvailable()) unavailable.push_back(tensor);
+  }
+
+  // The request serializes argument contents, so it can only go on the wire
+  // once every argument has resolved. Responses are matched by request id,
+  // not arrival order, so a later op with ready arguments may overtake this
+  // one.
+  std::string op_name = invocation.op_name.str();
+  OpAttrsRef frozen_attrs = invocation.attrs.freeze();
+  if (unavailable.empty()) {
+    SendRequest(request_id, op_name, frozen_attrs, arg_tensors, num_results);
+    return;
+  }
+  host->RunWhenReady(
+      unavailable, [this, request_id, op_name = std::move(op_name),
+                    frozen_attrs = std::move(frozen_attrs),
+                    arg_tensors = std::move(arg_tensors), num_results] {
+        SendRequest(request_id, op_name, frozen_attrs, arg_tensors,
+                    num_results);
+      });
+}
+
+void RemoteOpHandler::SendRequest(uint64_t request_id,
+                                  const std::string& op_name,
+                                  const OpAttrsRef& attrs,
+                                  ArrayRef<RCReference<AsyncValue>> arg_tensors,
+                                  size_t num_results) {
+  WireWriter writer;
+  writer.Write<uint64_t>(request_id);
+  writer.WriteString(op_name);
+  if (!SerializeOpAttrs(attrs, &writer)) {
+    FailPending(request_id,
+                "remote op attributes must have fixed-size types");
+    return;
+  }
+  writer.Write<uint32_t>(arg_tensors.size());
+  for (const auto& arg : arg_tensors) {
+    if (arg->IsError()) {
+      FailPending(request_id, arg->GetError().message);
+      return;
+    }
+    auto* dht = llvm::dyn_cast<DenseHostTensor>(&arg->get<Tensor>());
+    if (!dht) {
+      FailPending(request_id, "remote op arguments must be DenseHostTensors");
+      return;
+    }
+    SerializeTensor(*dht, &writer);
+  }
+  writer.Write<uint32_t>(num_results);
+
+  bool written;
+  {
+    mutex_lock lock(send_mu_);
+    written = WriteFrame(fd_, writer.buffer());
+  }
+  if (!written) FailPending(request_id, "remote connection closed");
+}
+
+void RemoteOpHandler::ReceiveResponses() {
+  auto* host = GetRuntime()->GetHostContext();
+  std::vector<uint8_t> payload;
+  while (ReadFrame(fd_, &payload)) {
+    WireReader reader(payload);
+    uint64_t request_id = reader.Read<uint64_t>();
+    PendingOp pending;
+    {
+      mutex_lock lock(pending_mu_);
+      auto it = pending_.find(request_id);
+      if (it == pending_.end()) continue;
+      pending = std::move(it->second);
+      pending_.erase(it);
+    }
+
+    if (reader.Read<uint8_t>() == 0) {
+      FailResults(&pending, reader.ReadString(), host);
+      continue;
+    }
+    uint32_t num_results = reader.Read<uint32_t>();
+    if (!reader.ok() || num_results != pending.size()) {
+      FailResults(&pending, "malformed remote response", host);
+      continue;
+    }
+    for (auto& result : pending) {
+      auto dht = DeserializeTensor(&reader, host);
+      if (!dht) {
+        std::string message = StrCat(dht.takeError());
+        result.metadata.SetError(message);
+        result.tensor->ForwardTo(host->MakeErrorAsyncValueRef(message));
+        continue;
+      }
+      result.metadata.emplace(dht->metadata());
+      result.tensor->ForwardTo(
+          host->MakeAvailableAsyncValueRef<DenseHostTensor>(std::move(*dht))
+              .ReleaseRCRef());
+    }
+  }
+  FailAllPending("remote connection closed");
+}
+
+void RemoteOpHandler::FailResults(PendingOp* pending, string_view message,
+                                  HostContext* host) {
+  for (auto& result : *pending) {
+    result.metadata.SetError(message);
+    result.tensor->ForwardTo(host->MakeErrorAsyncValueRef(message));
+  }
+}
+
+void RemoteOpHandler::FailPending(uint64_t request_id, string_view message) {
+  PendingOp pending;
+  {
+    mutex_lock lock(pending_mu_);
+    auto it = pending_.find(request_id);
+    if (it == pending_.end()) return;
+    pending = std::move(it->second);
+    pending_.erase(it);
+  }
+  FailResults(&pending, message, GetRuntime()->GetHostContext());
+}
+
+void RemoteOpHandler::FailAllPending(string_view message) {
+  llvm::DenseMap<uint64_t, PendingOp> pending;
+  {
+    mutex_lock lock(pending_mu_);
+    pending = std::move(pending_);
+    pending_.clear();
+  }
+  auto* host = GetRuntime()->GetHostContext();
+  for (auto& entry : pending) FailResults(&entry.second, message, host);
+}
+
+}  // namespace
+
+llvm::Expected<std::unique_ptr<OpHandler>> CreateRemoteOpHandler(
+    CoreRuntime* runtime, int socket_fd) {
+  if (socket_fd < 0) return MakeStringError("invalid remote socket");
+  return std::unique_ptr<OpHandler>(new RemoteOpHandler(runtime, socket_fd));
+}
+
+//===----------------------------------------------------------------------===//
+// RemoteOpServer
+//===----------------------------------------------------------------------===//
+
+RemoteOpServer::RemoteOpServer(int socket_fd, CoreRuntime* runtime,
+                               OpHandler* op_handler)
+    : fd_(socket_fd), runtime_(runtime), op_handler_(op_handler) {
+  serving_thread_ = std::thread([this] { Serve(); });
+}
+
+RemoteOpServer::~RemoteOpServer() {
+  ::shutdown(fd_, SHUT_RDWR);
+  serving_thread_.join();
+  ::close(fd_);
+}
+
+void RemoteOpServer::Serve() {
+  auto* host = runtime_->GetHostContext();
+  auto chain = host->MakeAvailableAsyncValueRef<Chain>();
+  std::vector<uint8_t> payload;
+
+  // Requests execute in arrival order; the client overlaps its round trips
+  // against this loop by pipelining, so there is no need for concurrent
+  // execution here.
+  while (ReadFrame(fd_, &payload)) {
+    WireReader reader(payload);
+    uint64_t request_id = reader.Read<uint64_t>();
+    std::string op_name = reader.ReadString();
+
+    auto respond_with_error = [&](string_view message) {
+      WireWriter writer;
+      writer.Write<uint64_t>(request_id);
+      writer.Write<uint8_t>(0);
+      writer.WriteString(message);
+      return WriteFrame(fd_, writer.buffer());
+    };
+
+    OpAttrs attrs;
+    if (!DeserializeOpAttrs(&reader, &attrs)) {
+      if (!respond_with_error("malformed remote request")) return;
+      continue;
+    }
+
+    uint32_t num_arguments = reader.Read<uint32_t>();
+    llvm::SmallVector<TensorHandle, 4> arguments;
+    bool arguments_ok = true;
+    for (uint32_t i = 0; i < num_arguments && arguments_ok; ++i) {
+      auto dht = DeserializeTensor(&reader, host);
+      if (!dht) {
+        consumeError(dht.takeError());
+        arguments_ok = false;
+        break;
+      }
+      TensorMetadata metadata = dht->metadata();
+      arguments.push_back(TensorHandle(
+          metadata, host->MakeAvailableAsyncValueRef<DenseHostTensor>(
+                        std::move(*dht))));
+    }
+    uint32_t num_results = reader.Read<uint32_t>();
+    if (!arguments_ok || !reader.ok()) {
+      if (!respond_with_error("malformed remote request")) return;
+      continue;
+    }
+
+    llvm::SmallVector<TensorHandle, 4> results;
+    results.resize(num_results);
+    runtime_->Execute(op_name, op_handler_, Location(), arguments,
+                      attrs.freeze(), results, &chain);
+
+    // Block until every result resolves. A pipelining client keeps this
+    // loop busy; requests already received queue up behind this one.
+    llvm::SmallVector<RCReference<AsyncValue>, 4> result_tensors;
+    for (auto& result : results)
+      result_tensors.push_back(FormRef(result.GetAsyncTensor()));
+    host->Await(result_tensors);
+
+    WireWriter writer;
+    writer.Write<uint64_t>(request_id);
+    writer.Write<uint8_t>(1);
+    writer.Write<uint32_t>(num_results);
+    bool results_ok = true;
+    for (auto& result : result_tensors) {
+      if (result->IsError()) {
+        if (!respond_with_error(result->GetError().message)) return;
+        results_ok = false;
+        break;
+      }
+      auto* dht = llvm::dyn_cast<DenseHostTensor>(&result->get<Tensor>());
+      if (!dht) {
+        if (!respond_with_error(
+                "remote op results must be DenseHostTensors")) {
+          return;
+        }
+        results_ok = false;
+        break;
+      }
+      SerializeTensor(*dht, &writer);
+    }
+    if (results_ok && !WriteFrame(fd_, writer.buffer())) return;
+  }
+}
+
+}  // namespace tfrt
@@ -36,7 +36,7 @@ static void RegisterKernels(KernelRegistry *registry) {
   RegisterCompositeOpHandlerKernels(registry);
 }
 
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterKernels);
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterKernels, "corert,tfrt_test");
 
 static OpHandlerRegistration logging_registration("logging",
                                                   CreateLoggingOpHandler);
@@ -22,6 +22,8 @@
 
 #include "llvm/Support/raw_ostream.h"
 #include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/tensor/dense_host_tensor.h"
 #include "tfrt/tensor/tensor.h"
 
 namespace tfrt {
@@ -30,6 +32,17 @@ TensorHandle::TensorHandle(AsyncValueRef<TensorMetadata> async_metadata,
                            AsyncValueRef<Tensor> tensor) {
   assert(async_metadata.GetAsyncValue());
   assert(tensor.GetAsyncValue());
+
+  // If the metadata is already available, store it inline: this drops the
+  // metadata AsyncValue right away instead of carrying it for the lifetime
+  // of the handle, and makes every later metadata read a direct load. Most
+  // handles are created with their metadata available.
+  if (async_metadata.IsConcrete()) {
+    tensor_and_is_metadata_inline_.setPointerAndInt(tensor.release(), true);
+    new (&inlined_metadata_) TensorMetadata(async_metadata.get());
+    return;
+  }
+
   tensor_and_is_metadata_inline_.setPointerAndInt(tensor.release(), false);
   new (&async_metadata_)
       AsyncValueRef<TensorMetadata>(std::move(async_metadata));
@@ -49,6 +62,63 @@ TensorHandle TensorHandle::CreateError(RCReference<AsyncValue> error) {
   return TensorHandle(std::move(tensor_md), std::move(tensor));
 }
 
+// Wraps `tensor` in an AsyncValue owned by `host`. Dense host tensors share
+// their buffer (host memory is visible from every context); anything else
+// goes through its conversion path on the destination.
+static AsyncValueRef<Tensor> TransferTensor(const Tensor& tensor,
+                                            HostContext* host) {
+  if (auto* dht = llvm::dyn_cast<DenseHostTensor>(&tensor)) {
+    return host->MakeAvailableAsyncValueRef<DenseHostTensor>(dht->CopyRef());
+  }
+  return tensor.ConvertToHostTensor(
+      host, 1 << static_cast<uint32_t>(Tensor::Subclass::DenseHost));
+}
+
+TensorHandle TensorHandle::TransferTo(HostContext* host) const {
+  assert(IsValid());
+  AsyncValue* tensor = GetAsyncTensor();
+
+  AsyncValueRef<Tensor> transferred;
+  if (tensor->IsConcrete()) {
+    transferred = TransferTensor(tensor->get<Tensor>(), host);
+  } else if (tensor->IsError()) {
+    transferred = AsyncValueRef<Tensor>(
+        host->MakeErrorAsyncValueRef(DecodedDiagnostic(tensor->GetError())));
+  } else {
+    // The tensor has not resolved yet: hand out an IndirectAsyncValue owned
+    // by the destination and forward into it once the source resolves.
+    auto indirect = host->MakeIndirectAsyncValue();
+    transferred = AsyncValueRef<Tensor>(indirect.CopyRef());
+    tensor->AndThen([tensor = FormRef(tensor),
+                     indirect = std::move(indirect), host]() mutable {
+      if (tensor->IsError()) {
+        indirect->ForwardTo(std::move(tensor));
+        return;
+      }
+      indirect->ForwardTo(
+          TransferTensor(tensor->get<Tensor>(), host).ReleaseRCRef());
+    });
+  }
+
+  // Metadata is a plain value: inline it when available, otherwise mirror it
+  // into an AsyncValue on the destination.
+  if (IsMetadataInline())
+    return TensorHandle(inlined_metadata_, std::move(transferred));
+  if (async_metadata_.IsConcrete())
+    return TensorHandle(async_metadata_.get(), std::move(transferred));
+
+  auto metadata = host->MakeUnconstructedAsyncValueRef<TensorMetadata>();
+  async_metadata_.AndThen(
+      [source = async_metadata_.CopyRef(), metadata = metadata.CopyRef()] {
+        if (source.IsError()) {
+          metadata.SetError(source.GetError());
+        } else {
+          metadata.emplace(source.get());
+        }
+      });
+  return TensorHandle(std::move(metadata), std::move(transferred));
+}
+
 raw_ostream& operator<<(raw_ostream& os, const TensorHandle& handle) {
   auto tensor = handle.GetAsyncTensor();
   // Check for invalid states.  Both null could happen when in a moved-from
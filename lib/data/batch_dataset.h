@@ -28,7 +28,10 @@
 #include "dataset.h"
 #include "llvm/ADT/SmallVector.h"
 #include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/host_buffer.h"
+#include "tfrt/host_context/parallel_for.h"
 #include "tfrt/support/error_util.h"
+#include "tfrt/support/mutex.h"
 #include "tfrt/support/forward_decls.h"
 #include "tfrt/support/ref_count.h"
 #include "tfrt/support/string_util.h"
@@ -221,16 +224,19 @@ void CopyInputToOutputBuffer(
 // Allocate a std::tuple<DenseHotTensor, ...>. The DType of the i-th element of
 // the tuple should be same as the i-th element of `metadata`. The shape of the
 // i-th element of the tuple should
-// be `batch_size` X `shape_of_i_th_element_of_metadatas`.
+// be `batch_size` X `shape_of_i_th_element_of_metadatas`. The tensor buffers
+// come from `arena` so that steady-state batches reuse recycled memory.
 template <typename... T>
 AsyncValueRef<DHTTuple<sizeof...(T)>> AllocateOutputBuffer(
     AsyncValueRef<std::array<TensorMetadata, sizeof...(T)>> metadata,
-    int32_t batch_size, const ExecutionContext& exec_ctx) {
+    int32_t batch_size, RCReference<ElementBufferArena> arena,
+    const ExecutionContext& exec_ctx) {
   auto* host = exec_ctx.host();
   auto result =
       host->template MakeUnconstructedAsyncValueRef<DHTTuple<sizeof...(T)>>();
   metadata.AndThen([metadata = metadata.CopyRef(), result = result.CopyRef(),
-                    batch_size, host, exec_ctx]() mutable {
+                    batch_size, arena = std::move(arena),
+                    exec_ctx]() mutable {
     if (metadata.IsError()) {
       result.SetError(metadata.GetError());
       return;
@@ -244,13 +250,14 @@ AsyncValueRef<DHTTuple<sizeof...(T)>> AllocateOutputBuffer(
         output_dims[i] = element_metadata.shape.GetDimensionSize(i - 1);
       }
       TensorMetadata batched_metadata(element_metadata.dtype, output_dims);
-      auto dht = DenseHostTensor::CreateUninitialized(batched_metadata, host);
-      if (!dht) {
+      auto buffer = arena->Allocate(batched_metadata.GetHostSizeInBytes(),
+                                    batched_metadata.dtype.GetHostAlignment());
+      if (!buffer) {
         result.SetError(
             EmitError(exec_ctx, "failed to create uninitialized tensor"));
         return;
       }
-      tensors.push_back(std::move(*dht));
+      tensors.push_back(DenseHostTensor(batched_metadata, std::move(buffer)));
     }
     result.emplace(MakeTuple<sizeof...(T)>(tensors));
   });
@@ -277,7 +284,8 @@ class BatchDataset : public DHTDataset<sizeof...(T)> {
   BatchDataset(const BatchDataset&) = delete;
   BatchDataset& operator=(const BatchDataset&) = delete;
 
-  RCReference<DHTIterator<sizeof...(T)>> MakeIterator() override;
+  RCReference<DHTIterator<sizeof...(T)>> MakeIterator(
+      RCReference<IteratorContext> context) override;
 
  private:
   // Allow iterator to rely on private data members of this dataset.
@@ -296,10 +304,13 @@ class BatchDataset : public DHTDataset<sizeof...(T)> {
 template <typename... T>
 class BatchDatasetIterator : public DHTIterator<sizeof...(T)> {
  public:
-  explicit BatchDatasetIterator(RCReference<BatchDataset<T...>> parent_dataset)
+  explicit BatchDatasetIterator(RCReference<BatchDataset<T...>> parent_dataset,
+                                RCReference<IteratorContext> context)
       : DHTIterator<sizeof...(T)>(),
         parent_dataset_(std::move(parent_dataset)),
-        input_iterator_(parent_dataset_->input_dataset_->MakeIterator()) {}
+        context_(std::move(context)),
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator(
+            context_.CopyRef())) {}
 
   // This class is not copyable or movable.
   BatchDatasetIterator(const BatchDatasetIterator&) = delete;
@@ -315,12 +326,15 @@ class BatchDatasetIterator : public DHTIterator<sizeof...(T)> {
   }
 
   RCReference<BatchDataset<T...>> parent_dataset_;
+  RCReference<IteratorContext> context_;
   RCReference<Iterator<T...>> input_iterator_;
 };
 
 template <typename... T>
-RCReference<DHTIterator<sizeof...(T)>> BatchDataset<T...>::MakeIterator() {
-  return TakeRef(host_->Construct<BatchDatasetIterator<T...>>(FormRef(this)));
+RCReference<DHTIterator<sizeof...(T)>> BatchDataset<T...>::MakeIterator(
+    RCReference<IteratorContext> context) {
+  return TakeRef(host_->Construct<BatchDatasetIterator<T...>>(
+      FormRef(this), std::move(context)));
 }
 
 // IDEA(donglin): Consider scheduling the batch operation to the background
@@ -357,8 +371,9 @@ AsyncValueRef<DHTTuple<sizeof...(T)>> BatchDatasetIterator<T...>::GetNext(
   // function output to the temp_batched_value. After all data is copied to
   // temp_batched_value, move temp_batched_value to batched_value into
   // batched_value and make batched_value available.
-  auto temp_batched_value =
-      AllocateOutputBuffer<T...>(metadata.CopyRef(), values.size(), exec_ctx);
+  auto temp_batched_value = AllocateOutputBuffer<T...>(
+      metadata.CopyRef(), values.size(), context_->arena().CopyRef(),
+      exec_ctx);
   auto batched_value =
       host->template MakeUnconstructedAsyncValueRef<DHTTuple<sizeof...(T)>>();
 
@@ -374,12 +389,27 @@ AsyncValueRef<DHTTuple<sizeof...(T)>> BatchDatasetIterator<T...>::GetNext(
         // counter_and_error is used to keep track of 1) the count of remaining
         // values that have not been computed and 2) first error from any value.
         auto* counter_and_error = new CounterAndError(values.size());
-        for (int idx = 0; idx < values.size(); ++idx) {
-          CopyInputToOutputBuffer(std::move(values[idx]), metadata.CopyRef(),
-                                  temp_batched_value.CopyRef(),
-                                  batched_value.CopyRef(), idx,
-                                  counter_and_error, host);
-        }
+        // Partition the per-element copies across the work queue instead of
+        // issuing them serially: for batches whose inputs are already
+        // available the memcpys run inline, so chunking them parallelizes
+        // batch assembly and overlaps it with upstream production. Blocks
+        // touch disjoint values and disjoint output regions, so they run
+        // without synchronization.
+        const size_t num_values = values.size();
+        ParallelFor(host).Execute(
+            num_values, ParallelFor::BlockSizes::Min(32),
+            [values = std::move(values), metadata = std::move(metadata),
+             temp_batched_value = std::move(temp_batched_value),
+             batched_value = std::move(batched_value), counter_and_error,
+             host](size_t begin, size_t end) mutable {
+              for (size_t idx = begin; idx != end; ++idx) {
+                CopyInputToOutputBuffer(
+                    std::move(values[idx]), metadata.CopyRef(),
+                    temp_batched_value.CopyRef(), batched_value.CopyRef(), idx,
+                    counter_and_error, host);
+              }
+            },
+            [] {});
       });
   return batched_value;
 }
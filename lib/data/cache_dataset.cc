@@ -0,0 +1,125 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- cache_dataset.cc ---------------------------------------------------===//
+//
+// This file implements CacheDataset class which materializes its input into
+// a BTF file shared by every process on the host.
+//
+//===----------------------------------------------------------------------===//
+
+#include "cache_dataset.h"
+
+#include <cstdio>
+
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/error_util.h"
+#include "tfrt/support/string_util.h"
+#include "tfrt/tensor/btf_writer.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <unistd.h>
+#define TFRT_DATA_HAS_GETPID 1
+#endif
+
+namespace tfrt {
+namespace data {
+
+RCReference<Iterator<DenseHostTensor>> CacheDataset::MakeIterator(
+    RCReference<IteratorContext> context) {
+  return TakeRef(host_->Construct<CacheDatasetIterator>(FormRef(this),
+                                                        std::move(context)));
+}
+
+CacheDatasetIterator::CacheDatasetIterator(
+    RCReference<CacheDataset> parent_dataset,
+    RCReference<IteratorContext> context)
+    : Iterator<DenseHostTensor>(),
+      parent_dataset_(std::move(parent_dataset)),
+      context_(std::move(context)) {
+  // If some process on the host already materialized the cache, serve this
+  // pass from the shared mapping; otherwise fall back to the input and
+  // collect elements for materialization.
+  auto reader = BtfStreamingReader::Open(parent_dataset_->path_);
+  if (reader) {
+    reader_ = std::move(*reader);
+  } else {
+    llvm::consumeError(reader.takeError());
+    input_iterator_ =
+        parent_dataset_->input_dataset_->MakeIterator(context_.CopyRef());
+  }
+}
+
+AsyncValueRef<std::tuple<DenseHostTensor>> CacheDatasetIterator::GetNext(
+    const ExecutionContext& exec_ctx) {
+  if (reader_) {
+    if (next_index_ >= reader_->NumTensors()) return {};
+    // Tensors alias the read-only file mapping, so this only copies
+    // metadata. Page faults for cold data are absorbed by the reader's
+    // readahead; wrap the dataset in data.prefetch_dataset to move even
+    // those off the caller's thread.
+    auto dht = reader_->ReadDenseTensor(next_index_++, exec_ctx.host());
+    if (!dht) return EmitErrorAsync(exec_ctx, dht.takeError());
+    return exec_ctx.host()->MakeAvailableAsyncValueRef<
+        std::tuple<DenseHostTensor>>(std::make_tuple(std::move(*dht)));
+  }
+
+  auto value = input_iterator_->GetNext(exec_ctx);
+  if (!value) {
+    // Input exhausted: the pass is complete, materialize it.
+    MaybeWriteCacheFile(exec_ctx.host());
+    return value;
+  }
+  elements_.push_back(value.CopyRef());
+  return value;
+}
+
+void CacheDatasetIterator::MaybeWriteCacheFile(HostContext* host) {
+  if (finalized_) return;
+  finalized_ = true;
+
+  SmallVector<AsyncValue*, 16> element_avs;
+  element_avs.reserve(elements_.size());
+  for (auto& element : elements_)
+    element_avs.push_back(element.GetAsyncValue());
+
+  host->RunWhenReady(element_avs, [iterator = FormRef(this), host] {
+    // Only a fully successful pass is worth persisting; on any error the
+    // next iterator reads from the input again.
+    std::vector<DenseHostTensor> tensors;
+    tensors.reserve(iterator->elements_.size());
+    for (auto& element : iterator->elements_) {
+      if (element.IsError()) return;
+      tensors.push_back(std::get<0>(element.get()).CopyRef());
+    }
+
+    // Write to a temporary file and rename it into place, so concurrent
+    // readers (and concurrent writers in other processes, which produce
+    // identical content) only ever observe a complete cache file.
+    const std::string& path = iterator->parent_dataset_->path_;
+#ifdef TFRT_DATA_HAS_GETPID
+    std::string tmp_path = StrCat(path, ".tmp.", getpid());
+#else
+    std::string tmp_path = StrCat(path, ".tmp");
+#endif
+    auto chain = WriteTensorsToBTF(std::move(tensors), tmp_path, host);
+    chain.AndThen([chain = chain.CopyRef(), tmp_path, path] {
+      if (chain.IsError() || std::rename(tmp_path.c_str(), path.c_str()) != 0)
+        std::remove(tmp_path.c_str());
+    });
+  });
+}
+
+}  // namespace data
+}  // namespace tfrt
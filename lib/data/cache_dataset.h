@@ -0,0 +1,120 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- cache_dataset.h ------------------------------------------*- C++ -*-===//
+//
+// This file declares CacheDataset class which materializes its input into a
+// BTF file shared by every process on the host.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_LIB_DATA_CACHE_DATASET_H_
+#define TFRT_LIB_DATA_CACHE_DATASET_H_
+
+#include "dataset.h"
+#include "llvm/ADT/Optional.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/tensor/btf_streaming_reader.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+namespace data {
+
+// CacheDataset materializes the elements of its input dataset into a BTF
+// file at `path`. The first pass over the dataset reads from the input and,
+// once the input is exhausted, writes the collected elements to the file
+// (atomically, via a temporary file and rename, so readers never observe a
+// partially written cache). Later iterators - in this process or in any
+// other process on the host - find the file and serve elements from a
+// shared, read-only memory mapping via BtfStreamingReader. A validation
+// dataset re-read by N trainer processes on a host is thus read and decoded
+// once instead of N times, and its pages are shared between the processes
+// by the OS.
+//
+// Elements must be DenseHostTensors, the type BTF records can represent.
+// The cache is written only if the whole input pass completes without
+// errors; an interrupted pass leaves no file behind and the next iterator
+// simply reads from the input again.
+class CacheDataset : public Dataset<DenseHostTensor> {
+ public:
+  explicit CacheDataset(RCReference<Dataset<DenseHostTensor>> input_dataset,
+                        std::string path, HostContext* host)
+      : input_dataset_(std::move(input_dataset)),
+        path_(std::move(path)),
+        host_(host),
+        allocator_(host->allocator()) {}
+
+  // This class is not copyable or movable.
+  CacheDataset(const CacheDataset&) = delete;
+  CacheDataset& operator=(const CacheDataset&) = delete;
+
+  RCReference<Iterator<DenseHostTensor>> MakeIterator(
+      RCReference<IteratorContext> context) override;
+
+ private:
+  friend class CacheDatasetIterator;
+
+  void Destroy() override {
+    internal::DestroyImpl<CacheDataset>(this, allocator_);
+  }
+
+  RCReference<Dataset<DenseHostTensor>> input_dataset_;
+  const std::string path_;
+  HostContext* host_;
+  HostAllocator* allocator_;
+};
+
+class CacheDatasetIterator : public Iterator<DenseHostTensor> {
+ public:
+  explicit CacheDatasetIterator(RCReference<CacheDataset> parent_dataset,
+                                RCReference<IteratorContext> context);
+
+  // This class is not copyable or movable.
+  CacheDatasetIterator(const CacheDatasetIterator&) = delete;
+  CacheDatasetIterator& operator=(const CacheDatasetIterator&) = delete;
+
+  AsyncValueRef<std::tuple<DenseHostTensor>> GetNext(
+      const ExecutionContext& exec_ctx) override;
+
+ private:
+  void Destroy() override {
+    internal::DestroyImpl<CacheDatasetIterator>(this,
+                                                parent_dataset_->allocator_);
+  }
+
+  // Once the input is exhausted, waits for all collected elements and, if
+  // none failed, writes them to the cache file in the background.
+  void MaybeWriteCacheFile(HostContext* host);
+
+  RCReference<CacheDataset> parent_dataset_;
+  RCReference<IteratorContext> context_;
+
+  // Set when the cache file already existed when this iterator was created;
+  // elements are then served from the file mapping.
+  llvm::Optional<BtfStreamingReader> reader_;
+  size_t next_index_ = 0;
+
+  // First pass state: elements pass through from the input and are collected
+  // here until the input is exhausted.
+  RCReference<Iterator<DenseHostTensor>> input_iterator_;
+  SmallVector<AsyncValueRef<std::tuple<DenseHostTensor>>, 16> elements_;
+  bool finalized_ = false;
+};
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_LIB_DATA_CACHE_DATASET_H_
@@ -19,12 +19,17 @@
 //===----------------------------------------------------------------------===//
 
 #include "batch_dataset.h"
+#include "cache_dataset.h"
 #include "interleave_dataset.h"
+#include "map_and_batch_dataset.h"
 #include "map_dataset.h"
 #include "prefetch_dataset.h"
 #include "range_dataset.h"
 #include "repeat_dataset.h"
+#include "shard_dataset.h"
+#include "shuffle_dataset.h"
 #include "slice_dataset.h"
+#include "file_list_dataset.h"
 #include "tf_record_dataset.h"
 #include "tfrt/host_context/function.h"
 #include "tfrt/host_context/kernel_utils.h"
@@ -109,8 +114,8 @@ RCReference<MapDataset<std::tuple<T>, std::tuple<U...>>> MakeMapDataset(
 template <typename T, typename... U>
 RCReference<InterleaveDataset<std::tuple<T>, std::tuple<U...>>>
 MakeInterleaveDataset(RCReference<Dataset<T>>* dataset, int64_t cycle_length,
-                      int64_t block_length, Attribute<Function> fn,
-                      HostContext* host) {
+                      int64_t block_length, bool deterministic,
+                      Attribute<Function> fn, HostContext* host) {
   assert(fn->argument_types().size() == 1 &&
          "Interleave only supports functions with unary inputs.");
   assert(
@@ -119,8 +124,8 @@ MakeInterleaveDataset(RCReference<Dataset<T>>* dataset, int64_t cycle_length,
 
   return TakeRef(
       host->Construct<InterleaveDataset<std::tuple<T>, std::tuple<U...>>>(
-          (*dataset).CopyRef(), cycle_length, block_length, FormRef(&fn.get()),
-          host));
+          (*dataset).CopyRef(), cycle_length, block_length, deterministic,
+          FormRef(&fn.get()), host));
 }
 
 //===----------------------------------------------------------------------===//
@@ -132,6 +137,73 @@ RCReference<TFRecordDataset> MakeTFRecordDataset(std::string path,
   return TakeRef(host->Construct<TFRecordDataset>(std::move(path), host));
 }
 
+// Variant for TFRecord files produced by our own writers: the first record's
+// checksum is still verified to catch gross mistakes, after which the
+// per-record CRC32C work is skipped.
+RCReference<TFRecordDataset> MakeTFRecordDatasetVerifyFirst(std::string path,
+                                                            HostContext* host) {
+  return TakeRef(host->Construct<TFRecordDataset>(
+      std::move(path), host,
+      TFRecordDataset::ChecksumMode::kVerifyFirstRecord));
+}
+
+// Variant for gzip-compressed TFRecord files: records are parsed out of an
+// inflate stage that decodes ahead on the blocking work queue, so archived
+// datasets can be read directly instead of being pre-inflated to disk.
+RCReference<TFRecordDataset> MakeTFRecordDatasetGzip(std::string path,
+                                                     HostContext* host) {
+  return TakeRef(host->Construct<TFRecordDataset>(
+      std::move(path), host, TFRecordDataset::ChecksumMode::kVerifyAll,
+      TFRecordDataset::Compression::kGzip));
+}
+
+//===----------------------------------------------------------------------===//
+// FileListDataset
+//===----------------------------------------------------------------------===//
+
+// Streams the paths of the regular files under `directory` whose names end
+// with `suffix`, issuing the directory listing and the per-file stat calls
+// concurrently on the blocking work queue. Feed it into an interleave so a
+// large epoch starts as soon as the first file resolves.
+RCReference<FileListDataset> MakeFileListDataset(std::string directory,
+                                                 std::string suffix,
+                                                 HostContext* host) {
+  return TakeRef(host->Construct<FileListDataset>(std::move(directory),
+                                                  std::move(suffix), host));
+}
+
+//===----------------------------------------------------------------------===//
+// CacheDataset
+//===----------------------------------------------------------------------===//
+
+RCReference<CacheDataset> MakeCacheDataset(
+    RCReference<Dataset<DenseHostTensor>>* dataset, std::string path,
+    HostContext* host) {
+  return TakeRef(host->Construct<CacheDataset>((*dataset).CopyRef(),
+                                               std::move(path), host));
+}
+
+//===----------------------------------------------------------------------===//
+// MapAndBatchDataset
+//===----------------------------------------------------------------------===//
+
+// TODO(rachelim): Support variable number of arguments.
+template <typename T, typename... U>
+RCReference<MapAndBatchDataset<std::tuple<T>, std::tuple<U...>>>
+MakeMapAndBatchDataset(RCReference<Dataset<T>>* dataset,
+                       Attribute<int32_t> batch_size, RemainingArguments args,
+                       Attribute<Function> fn, HostContext* host) {
+  assert((args.size() + 1 == fn->argument_types().size()) &&
+         "MapAndBatchDataset only supports input dataset with unary output.");
+  assert(fn->result_types().size() == sizeof...(U) &&
+         "Map function output size does not match expexcted.");
+
+  return TakeRef(
+      host->Construct<MapAndBatchDataset<std::tuple<T>, std::tuple<U...>>>(
+          (*dataset).CopyRef(), batch_size.get(),
+          RCArray<AsyncValue>(args.values()), FormRef(&fn.get()), host));
+}
+
 //===----------------------------------------------------------------------===//
 // RepeatDataset
 //===----------------------------------------------------------------------===//
@@ -144,6 +216,30 @@ RCReference<RepeatDataset<T...>> MakeRepeatDataset(
                                                       count.get(), host));
 }
 
+//===----------------------------------------------------------------------===//
+// ShardDataset
+//===----------------------------------------------------------------------===//
+
+template <typename... T>
+RCReference<ShardDataset<T...>> MakeShardDataset(
+    RCReference<Dataset<T...>>* dataset, Attribute<int64_t> num_shards,
+    Attribute<int64_t> shard_index, HostContext* host) {
+  return TakeRef(host->Construct<ShardDataset<T...>>(
+      (*dataset).CopyRef(), num_shards.get(), shard_index.get(), host));
+}
+
+//===----------------------------------------------------------------------===//
+// ShuffleDataset
+//===----------------------------------------------------------------------===//
+
+template <typename... T>
+RCReference<ShuffleDataset<T...>> MakeShuffleDataset(
+    RCReference<Dataset<T...>>* dataset, Attribute<int64_t> buffer_size_bytes,
+    Attribute<int64_t> seed, HostContext* host) {
+  return TakeRef(host->Construct<ShuffleDataset<T...>>(
+      (*dataset).CopyRef(), buffer_size_bytes.get(), seed.get(), host));
+}
+
 //===----------------------------------------------------------------------===//
 // BatchDataset
 //===----------------------------------------------------------------------===//
@@ -165,19 +261,25 @@ RCReference<BatchDataset<T...>> MakeBatchDataset(
 template <typename... T>
 RCReference<PrefetchDataset<T...>> MakePrefetchDataset(
     RCReference<Dataset<T...>>* dataset, HostContext* host) {
+  // A negative prefetch_num enables autotuning: the iterator starts at the
+  // number of worker threads (the previous fixed value) and adapts the number
+  // of in-flight elements within [1, 4 * num_worker_threads].
   return TakeRef(host->Construct<PrefetchDataset<T...>>(
-      (*dataset).CopyRef(), host->GetNumWorkerThreads(), host));
+      (*dataset).CopyRef(), -4 * host->GetNumWorkerThreads(), host));
 }
 
 //===----------------------------------------------------------------------===//
 // Generic input pipeline kernels
 //===----------------------------------------------------------------------===//
 
-// Create an iterator that points to the first element in the dataset.
+// Create an iterator that points to the first element in the dataset. The
+// iterator tree created here shares one IteratorContext, so pooled resources
+// are recycled across all of its stages.
 template <typename... T>
 RCReference<Iterator<T...>> MakeIteratorFromDataset(
-    RCReference<Dataset<T...>>* dataset) {
-  return (*dataset)->MakeIterator();
+    RCReference<Dataset<T...>>* dataset, HostContext* host) {
+  auto context = TakeRef(host->Construct<IteratorContext>(host));
+  return (*dataset)->MakeIterator(std::move(context));
 }
 
 // Get the next element from the iterator and advance iterator.
@@ -325,6 +427,12 @@ void RegisterDataKernels(KernelRegistry* registry) {
 
   registry->AddKernel("data.tf_record_dataset",
                       TFRT_KERNEL(MakeTFRecordDataset));
+  registry->AddKernel("data.tf_record_dataset.verify_first",
+                      TFRT_KERNEL(MakeTFRecordDatasetVerifyFirst));
+  registry->AddKernel("data.tf_record_dataset.gzip",
+                      TFRT_KERNEL(MakeTFRecordDatasetGzip));
+  registry->AddKernel("data.file_list_dataset",
+                      TFRT_KERNEL(MakeFileListDataset));
 
   registry->AddKernel("data.map_dataset.i32.i32",
                       TFRT_KERNEL(MakeMapDataset<int32_t, int32_t>));
@@ -356,6 +464,26 @@ void RegisterDataKernels(KernelRegistry* registry) {
   registry->AddKernel("data.batch_dataset.tensor_and_i64",
                       TFRT_KERNEL(MakeBatchDataset<DenseHostTensor, int64_t>));
 
+  registry->AddKernel("data.map_and_batch_dataset.i32.i32",
+                      TFRT_KERNEL(MakeMapAndBatchDataset<int32_t, int32_t>));
+  registry->AddKernel(
+      "data.map_and_batch_dataset.i32.f32_and_i32",
+      TFRT_KERNEL(MakeMapAndBatchDataset<int32_t, float, int32_t>));
+
+  registry->AddKernel("data.shard_dataset.i32",
+                      TFRT_KERNEL(MakeShardDataset<int32_t>));
+  registry->AddKernel("data.shard_dataset.i64",
+                      TFRT_KERNEL(MakeShardDataset<int64_t>));
+  registry->AddKernel("data.shard_dataset.str",
+                      TFRT_KERNEL(MakeShardDataset<std::string>));
+
+  registry->AddKernel("data.shuffle_dataset.i32",
+                      TFRT_KERNEL(MakeShuffleDataset<int32_t>));
+  registry->AddKernel("data.shuffle_dataset.i64",
+                      TFRT_KERNEL(MakeShuffleDataset<int64_t>));
+  registry->AddKernel("data.shuffle_dataset.str",
+                      TFRT_KERNEL(MakeShuffleDataset<std::string>));
+
   registry->AddKernel("data.repeat_dataset.i32",
                       TFRT_KERNEL(MakeRepeatDataset<int32_t>));
   registry->AddKernel("data.repeat_dataset.i64",
@@ -363,6 +491,9 @@ void RegisterDataKernels(KernelRegistry* registry) {
   registry->AddKernel("data.repeat_dataset.str",
                       TFRT_KERNEL(MakeRepeatDataset<std::string>));
 
+  registry->AddKernel("data.cache_dataset.tensor",
+                      TFRT_KERNEL(MakeCacheDataset));
+
   registry->AddKernel(
       "data.prefetch_dataset.tensor_and_tensor",
       TFRT_KERNEL(MakePrefetchDataset<DenseHostTensor, DenseHostTensor>));
@@ -25,16 +25,28 @@
 
 #include <memory>
 
+#include "llvm/ADT/SmallVector.h"
 #include "tfrt/host_context/execution_context.h"
 #include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_buffer.h"
 #include "tfrt/host_context/host_context.h"
 #include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
 #include "tfrt/support/rc_array.h"
 #include "tfrt/support/ref_count.h"
 
 namespace tfrt {
 namespace data {
 
+// Default allocator watermarks for prefetch backpressure. Prefetching
+// iterators register these thresholds with the host allocator and stop
+// producing new elements while more than kPrefetchPauseBytes are in use,
+// resuming once usage drains below kPrefetchResumeBytes; graceful throttling
+// of the input pipeline beats the kernel OOM killer. Deployments with
+// different memory budgets tune these.
+constexpr size_t kPrefetchPauseBytes = size_t{8} << 30;
+constexpr size_t kPrefetchResumeBytes = size_t{6} << 30;
+
 namespace internal {
 
 template <typename SubClass>
@@ -70,6 +82,112 @@ static void EmplaceTupleResult(ArrayRef<AsyncValue*> results,
 
 }  // namespace internal
 
+// A recycling arena for element storage. Buffers of one pipeline almost
+// always share a byte size, so instead of going to the host allocator for
+// every element, buffers released downstream come back to a free list here
+// and are handed out again for later elements. The arena is reference counted
+// because the buffers it hands out can outlive the iterators that allocated
+// them.
+class ElementBufferArena : public ReferenceCounted<ElementBufferArena> {
+ public:
+  explicit ElementBufferArena(HostAllocator* allocator)
+      : allocator_(allocator) {}
+
+  ~ElementBufferArena() {
+    for (auto& block : free_list_) {
+      allocator_->DeallocateBytes(block.ptr, block.size);
+    }
+  }
+
+  // Returns a HostBuffer of `size` bytes that recycles its memory back into
+  // the arena when destroyed, or a null reference on allocation failure.
+  RCReference<HostBuffer> Allocate(size_t size, size_t alignment) {
+    void* ptr = nullptr;
+    {
+      mutex_lock lock(mu_);
+      for (size_t i = 0, e = free_list_.size(); i != e; ++i) {
+        if (free_list_[i].size == size &&
+            free_list_[i].alignment == alignment) {
+          ptr = free_list_[i].ptr;
+          free_list_.erase(free_list_.begin() + i);
+          break;
+        }
+      }
+    }
+    if (!ptr) {
+      ptr = allocator_->AllocateBytes(size, alignment);
+      if (!ptr) return {};
+    }
+    return HostBuffer::CreateFromExternal(
+        ptr, size,
+        [arena = FormRef(this), alignment](void* data, size_t data_size) {
+          arena->Recycle(data, data_size, alignment);
+        });
+  }
+
+ private:
+  // For access to Destroy().
+  friend class ReferenceCounted<ElementBufferArena>;
+
+  // An arena outlives its iterator tree only by however many elements are
+  // still in flight, so a few cached blocks cover the steady state.
+  static constexpr size_t kMaxFreeBlocks = 8;
+
+  struct Block {
+    void* ptr;
+    size_t size;
+    size_t alignment;
+  };
+
+  void Recycle(void* ptr, size_t size, size_t alignment) {
+    {
+      mutex_lock lock(mu_);
+      if (free_list_.size() < kMaxFreeBlocks) {
+        free_list_.push_back(Block{ptr, size, alignment});
+        return;
+      }
+    }
+    allocator_->DeallocateBytes(ptr, size);
+  }
+
+  void Destroy() {
+    internal::DestroyImpl<ElementBufferArena>(this, allocator_);
+  }
+
+  HostAllocator* allocator_;
+  mutex mu_;
+  SmallVector<Block, 8> free_list_ TFRT_GUARDED_BY(mu_);
+};
+
+// Shared state for one iterator tree. MakeIterator() threads the same context
+// through every stage of a pipeline, so pooled resources such as the element
+// buffer arena are recycled across the whole pipeline instead of being owned
+// by an individual dataset. Small AsyncValue wrappers are already recycled by
+// the per-thread slab allocator in HostContext; the context covers the larger
+// element payload buffers.
+class IteratorContext : public ReferenceCounted<IteratorContext> {
+ public:
+  explicit IteratorContext(HostContext* host)
+      : allocator_(host->allocator()),
+        arena_(TakeRef(
+            host->Construct<ElementBufferArena>(host->allocator()))) {}
+
+  // This class is not copyable or movable.
+  IteratorContext(const IteratorContext&) = delete;
+  IteratorContext& operator=(const IteratorContext&) = delete;
+
+  const RCReference<ElementBufferArena>& arena() const { return arena_; }
+
+ private:
+  // For access to Destroy().
+  friend class ReferenceCounted<IteratorContext>;
+
+  void Destroy() { internal::DestroyImpl<IteratorContext>(this, allocator_); }
+
+  HostAllocator* allocator_;
+  RCReference<ElementBufferArena> arena_;
+};
+
 // We separate the IteratorBase from the templatized Iterator so that
 // kernels can use IteratorBase::GetNextUntyped without being specialized for
 // the output type.
@@ -107,16 +225,19 @@ class Iterator : public IteratorBase {
       const ExecutionContext& exec_ctx) override;
 };
 
-// TODO(rachelim): Define `DatasetContext` and `IteratorContext` as a container
-// for common arguments to dataset and iterator constructors respectively.
+// TODO(rachelim): Define `DatasetContext` as a container for common arguments
+// to dataset constructors.
 template <typename... T>
 class Dataset : public ReferenceCounted<Dataset<T...>> {
  public:
   virtual ~Dataset() {}
 
   // Creates an iterator that points to the first element of the dataset.
-  // The iterator should keep +1 reference to the parent_dataset.
-  virtual RCReference<Iterator<T...>> MakeIterator() = 0;
+  // The iterator should keep +1 reference to the parent_dataset. Datasets
+  // that wrap an input dataset must pass `context` on to the input's
+  // MakeIterator() so that the whole iterator tree shares one context.
+  virtual RCReference<Iterator<T...>> MakeIterator(
+      RCReference<IteratorContext> context) = 0;
 
  private:
   // For access to Destroy().
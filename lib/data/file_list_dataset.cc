@@ -0,0 +1,164 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- file_list_dataset.cc -----------------------------------------------===//
+//
+// This file implements FileListDataset, an asynchronous file enumeration
+// source.
+//
+//===----------------------------------------------------------------------===//
+
+#include "file_list_dataset.h"
+
+#include <utility>
+
+#include "llvm/ADT/StringRef.h"
+#include "tfrt/host_context/execution_context.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/error_util.h"
+#include "tfrt/support/string_util.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define TFRT_DATA_HAS_DIRENT 1
+#endif
+
+namespace tfrt {
+namespace data {
+namespace {
+
+using EnumerationState = FileListDatasetIterator::EnumerationState;
+
+#ifdef TFRT_DATA_HAS_DIRENT
+
+// Stats one candidate path and publishes it if it is a regular file. Runs
+// on the blocking work queue, concurrently with the other stat tasks.
+void StatCandidate(const std::shared_ptr<EnumerationState>& state,
+                   std::string path) {
+  struct stat file_stat;
+  const bool is_regular_file =
+      stat(path.c_str(), &file_stat) == 0 && S_ISREG(file_stat.st_mode);
+
+  mutex_lock lock(state->mu);
+  if (is_regular_file) state->ready.push(std::move(path));
+  state->pending_stats--;
+  state->cv.notify_all();
+}
+
+// Lists `directory` and fans one StatCandidate task out per entry whose
+// name ends with `suffix`. Paths stream into state->ready as their stats
+// resolve, so consumers start before the listing finishes.
+void ListDirectory(std::shared_ptr<EnumerationState> state,
+                   const std::string& directory, const std::string& suffix,
+                   HostContext* host) {
+  DIR* dir = opendir(directory.c_str());
+  if (dir == nullptr) {
+    mutex_lock lock(state->mu);
+    state->error = StrCat("failed to open directory ", directory);
+    state->listing_done = true;
+    state->cv.notify_all();
+    return;
+  }
+
+  while (struct dirent* entry = readdir(dir)) {
+    llvm::StringRef name = entry->d_name;
+    if (name == "." || name == "..") continue;
+    if (!name.endswith(suffix)) continue;
+
+    std::string path = StrCat(directory, "/", name);
+    {
+      mutex_lock lock(state->mu);
+      state->pending_stats++;
+    }
+    auto stat_task = [state, path = std::move(path)]() mutable {
+      StatCandidate(state, std::move(path));
+    };
+    // If the blocking queue is saturated, stat inline on this task's thread
+    // rather than dropping the entry.
+    if (!host->EnqueueBlockingWork(std::move(stat_task)))
+      StatCandidate(state, StrCat(directory, "/", name));
+  }
+  closedir(dir);
+
+  mutex_lock lock(state->mu);
+  state->listing_done = true;
+  state->cv.notify_all();
+}
+
+#else  // !TFRT_DATA_HAS_DIRENT
+
+void ListDirectory(std::shared_ptr<EnumerationState> state,
+                   const std::string& directory, const std::string& suffix,
+                   HostContext* host) {
+  mutex_lock lock(state->mu);
+  state->error = "FileListDataset is not supported on this platform";
+  state->listing_done = true;
+  state->cv.notify_all();
+}
+
+#endif  // TFRT_DATA_HAS_DIRENT
+
+}  // namespace
+
+//===----------------------------------------------------------------------===//
+// Implementation for FileListDataset member functions
+//===----------------------------------------------------------------------===//
+
+RCReference<Iterator<std::string>> FileListDataset::MakeIterator(
+    RCReference<IteratorContext> context) {
+  return TakeRef(host_->Construct<FileListDatasetIterator>(FormRef(this)));
+}
+
+//===----------------------------------------------------------------------===//
+// Implementation for FileListDatasetIterator member functions
+//===----------------------------------------------------------------------===//
+
+FileListDatasetIterator::FileListDatasetIterator(
+    RCReference<FileListDataset> parent_dataset)
+    : io::PrefetchingIterator<std::string>(256, 64),
+      parent_dataset_(std::move(parent_dataset)),
+      state_(std::make_shared<EnumerationState>()) {
+  auto* host = parent_dataset_->host_;
+  auto list_task = [state = state_, directory = parent_dataset_->directory_,
+                    suffix = parent_dataset_->suffix_, host]() mutable {
+    ListDirectory(std::move(state), directory, suffix, host);
+  };
+  if (!host->EnqueueBlockingWork(std::move(list_task)))
+    ListDirectory(state_, parent_dataset_->directory_,
+                  parent_dataset_->suffix_, host);
+}
+
+AsyncValueRef<std::tuple<std::string>> FileListDatasetIterator::GetNextElement(
+    const ExecutionContext& exec_ctx) {
+  std::string path;
+  {
+    mutex_lock lock(state_->mu);
+    state_->cv.wait(lock, [this]() TFRT_REQUIRES(state_->mu) {
+      return !state_->ready.empty() || !state_->error.empty() ||
+             (state_->listing_done && state_->pending_stats == 0);
+    });
+    if (!state_->error.empty())
+      return EmitErrorAsync(exec_ctx, MakeStringError(state_->error));
+    if (state_->ready.empty()) return AsyncValueRef<std::tuple<std::string>>();
+    path = std::move(state_->ready.front());
+    state_->ready.pop();
+  }
+  return exec_ctx.host()->MakeAvailableAsyncValueRef<std::tuple<std::string>>(
+      std::move(path));
+}
+
+}  // namespace data
+}  // namespace tfrt
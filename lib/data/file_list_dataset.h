@@ -0,0 +1,124 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- file_list_dataset.h --------------------------------------*- C++ -*-===//
+//
+// This file declares FileListDataset, an asynchronous file enumeration
+// source.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_LIB_DATA_FILE_LIST_DATASET_H_
+#define TFRT_LIB_DATA_FILE_LIST_DATASET_H_
+
+#include <memory>
+#include <queue>
+#include <string>
+
+#include "dataset.h"
+#include "io.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+namespace data {
+
+// FileListDataset streams the paths of the regular files under a directory
+// whose names end with `suffix` (an empty suffix matches every file).
+//
+// Enumeration is asynchronous: making an iterator kicks a listing task off
+// on the blocking work queue, and that task fans one stat task out per
+// directory entry, so over a sharded store the stats are in flight
+// concurrently instead of being issued one round trip at a time. Each path
+// becomes an element as soon as its own stat resolves, so a downstream
+// dataset (e.g. an interleave into TFRecordDataset) starts consuming after
+// the first file is found, not after the last stat returns.
+//
+// Because elements stream out in stat completion order, the order is not
+// deterministic. Pipelines that need determinism should sort or shuffle
+// with a fixed seed downstream.
+class FileListDataset : public Dataset<std::string> {
+ public:
+  explicit FileListDataset(std::string directory, std::string suffix,
+                           HostContext* host)
+      : directory_(std::move(directory)),
+        suffix_(std::move(suffix)),
+        host_(host),
+        allocator_(host->allocator()) {}
+
+  // This class is not copyable or movable.
+  FileListDataset(const FileListDataset&) = delete;
+  FileListDataset& operator=(const FileListDataset&) = delete;
+
+  RCReference<Iterator<std::string>> MakeIterator(
+      RCReference<IteratorContext> context) override;
+
+ private:
+  friend class FileListDatasetIterator;
+
+  void Destroy() override {
+    internal::DestroyImpl<FileListDataset>(this, allocator_);
+  }
+
+  const std::string directory_;
+  const std::string suffix_;
+  HostContext* host_;
+  HostAllocator* allocator_;
+};
+
+class FileListDatasetIterator : public io::PrefetchingIterator<std::string> {
+ public:
+  explicit FileListDatasetIterator(RCReference<FileListDataset> parent_dataset);
+
+  // This class is not copyable or movable.
+  FileListDatasetIterator(const FileListDatasetIterator&) = delete;
+  FileListDatasetIterator& operator=(const FileListDatasetIterator&) = delete;
+
+  // State shared with the listing and stat tasks, which can outlive the
+  // iterator.
+  struct EnumerationState {
+    mutex mu;
+    condition_variable cv;
+    std::queue<std::string> ready TFRT_GUARDED_BY(mu);
+    // Stat tasks still in flight. The enumeration is complete once the
+    // listing is done and this drops to zero.
+    size_t pending_stats TFRT_GUARDED_BY(mu) = 0;
+    bool listing_done TFRT_GUARDED_BY(mu) = false;
+    std::string error TFRT_GUARDED_BY(mu);
+  };
+
+ protected:
+  // Pops the next resolved path, blocking until the enumeration produces one
+  // or finishes. PrefetchingIterator only calls this from blocking work
+  // queue tasks, so the wait never parks a kernel thread.
+  AsyncValueRef<std::tuple<std::string>> GetNextElement(
+      const ExecutionContext& exec_ctx) final;
+
+ private:
+  void Destroy() override {
+    internal::DestroyImpl<FileListDatasetIterator>(this,
+                                                   parent_dataset_->allocator_);
+  }
+
+  RCReference<FileListDataset> parent_dataset_;
+  std::shared_ptr<EnumerationState> state_;
+};
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_LIB_DATA_FILE_LIST_DATASET_H_
@@ -25,6 +25,9 @@
 #ifndef TFRT_LIB_DATA_INTERLEAVE_DATASET_H_
 #define TFRT_LIB_DATA_INTERLEAVE_DATASET_H_
 
+#include <algorithm>
+#include <queue>
+
 #include "dataset.h"
 #include "tfrt/host_context/function.h"
 #include "tfrt/support/forward_decls.h"
@@ -51,17 +54,27 @@ class InterleaveDatasetIterator;
 // returned Dataset objects, and cycle through them, producing `block_length`
 // consecutive elements from each iterator, and consuming the next input
 // element each time it reaches the end of an iterator.
+//
+// If `deterministic` is false, the iterator runs in work-stealing mode: every
+// open iterator keeps up to `block_length` elements in flight in a per-stream
+// buffer, and GetNext() returns an element from whichever stream already has
+// one available. Slow streams then no longer stall their cycle slot while
+// fast streams sit idle, at the cost of only best-effort ordering across
+// streams. Pass `deterministic` = true when the exact interleave order
+// matters.
 template <typename... InputTypes, typename... OutputTypes>
 class InterleaveDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>
     : public Dataset<OutputTypes...> {
  public:
   explicit InterleaveDataset(RCReference<Dataset<InputTypes...>> input_dataset,
                              int64_t cycle_length, int64_t block_length,
+                             bool deterministic,
                              RCReference<const Function> map_fn,
                              HostContext* host)
       : input_dataset_(std::move(input_dataset)),
         cycle_length_(cycle_length),
         block_length_(block_length),
+        deterministic_(deterministic),
         host_(host),
         allocator_(host->allocator()),
         map_fn_(std::move(map_fn)) {}
@@ -70,7 +83,8 @@ class InterleaveDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>
   InterleaveDataset(const InterleaveDataset&) = delete;
   InterleaveDataset& operator=(const InterleaveDataset&) = delete;
 
-  RCReference<Iterator<OutputTypes...>> MakeIterator() override;
+  RCReference<Iterator<OutputTypes...>> MakeIterator(
+      RCReference<IteratorContext> context) override;
 
  private:
   // Allow iterator to rely on private data members of this dataset.
@@ -86,6 +100,7 @@ class InterleaveDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>
   RCReference<Dataset<InputTypes...>> input_dataset_;
   int64_t cycle_length_;
   int64_t block_length_;
+  bool deterministic_;
   HostContext* host_;
   HostAllocator* allocator_;
   RCReference<const Function> map_fn_;
@@ -99,11 +114,15 @@ class InterleaveDatasetIterator<std::tuple<InputTypes...>,
   explicit InterleaveDatasetIterator(
       RCReference<InterleaveDataset<std::tuple<InputTypes...>,
                                     std::tuple<OutputTypes...>>>
-          parent_dataset)
+          parent_dataset,
+      RCReference<IteratorContext> context)
       : Iterator<OutputTypes...>(),
         parent_dataset_(std::move(parent_dataset)),
-        input_iterator_(parent_dataset_->input_dataset_->MakeIterator()),
-        cycle_iterators_(parent_dataset_->cycle_length_) {}
+        context_(std::move(context)),
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator(
+            context_.CopyRef())),
+        cycle_iterators_(parent_dataset_->cycle_length_),
+        buffers_(parent_dataset_->cycle_length_) {}
 
   // This class is not copyable or movable.
   InterleaveDatasetIterator(const InterleaveDatasetIterator&) = delete;
@@ -123,9 +142,14 @@ class InterleaveDatasetIterator<std::tuple<InputTypes...>,
   RCReference<
       InterleaveDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>>
       parent_dataset_;
+  RCReference<IteratorContext> context_;
   RCReference<Iterator<InputTypes...>> input_iterator_;
 
   std::vector<RCReference<Iterator<OutputTypes...>>> cycle_iterators_;
+  // Per-stream buffers of in-flight elements, used by the work-stealing
+  // mode. A stream's buffer keeps draining after its iterator is exhausted;
+  // the cycle slot is reused once the buffer is empty.
+  std::vector<std::queue<AsyncValueRef<std::tuple<OutputTypes...>>>> buffers_;
   size_t cycle_index_ = 0;
   size_t block_index_ = 0;
   bool end_of_input_ = false;
@@ -149,21 +173,52 @@ class InterleaveDatasetIterator<std::tuple<InputTypes...>,
   RCReference<Iterator<OutputTypes...>> MakeIteratorFromInputElement(
       AsyncValueRef<std::tuple<InputTypes...>> input_element,
       const ExecutionContext& exec_ctx);
+
+  // The original strict round-robin interleave.
+  AsyncValueRef<std::tuple<OutputTypes...>> GetNextDeterministic(
+      const ExecutionContext& exec_ctx);
+
+  // The work-stealing interleave with best-effort ordering.
+  AsyncValueRef<std::tuple<OutputTypes...>> GetNextWorkStealing(
+      const ExecutionContext& exec_ctx);
+
+  // Pops the front element of stream `idx` and advances the cycle and block
+  // bookkeeping as if the element had been produced at cycle_index_.
+  AsyncValueRef<std::tuple<OutputTypes...>> TakeFromStream(size_t idx) {
+    if (idx != cycle_index_) {
+      cycle_index_ = idx;
+      block_index_ = 0;
+    }
+    auto value = std::move(buffers_[idx].front());
+    buffers_[idx].pop();
+    AdvanceBlockIndex();
+    return value;
+  }
 };
 
 template <typename... InputTypes, typename... OutputTypes>
-RCReference<Iterator<OutputTypes...>> InterleaveDataset<
-    std::tuple<InputTypes...>, std::tuple<OutputTypes...>>::MakeIterator() {
+RCReference<Iterator<OutputTypes...>>
+InterleaveDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>::
+    MakeIterator(RCReference<IteratorContext> context) {
   return TakeRef(
       host_->Construct<InterleaveDatasetIterator<std::tuple<InputTypes...>,
                                                  std::tuple<OutputTypes...>>>(
-          FormRef(this)));
+          FormRef(this), std::move(context)));
 }
 
 template <typename... InputTypes, typename... OutputTypes>
 AsyncValueRef<std::tuple<OutputTypes...>> InterleaveDatasetIterator<
     std::tuple<InputTypes...>,
     std::tuple<OutputTypes...>>::GetNext(const ExecutionContext& exec_ctx) {
+  if (parent_dataset_->deterministic_) return GetNextDeterministic(exec_ctx);
+  return GetNextWorkStealing(exec_ctx);
+}
+
+template <typename... InputTypes, typename... OutputTypes>
+AsyncValueRef<std::tuple<OutputTypes...>>
+InterleaveDatasetIterator<std::tuple<InputTypes...>,
+                          std::tuple<OutputTypes...>>::
+    GetNextDeterministic(const ExecutionContext& exec_ctx) {
   while (!end_of_input_ || num_open_) {  // Not at end of input
 
     // Case 1: cycle_index_ has an open iterator. Get the next element from
@@ -228,6 +283,73 @@ AsyncValueRef<std::tuple<OutputTypes...>> InterleaveDatasetIterator<
   return AsyncValueRef<std::tuple<OutputTypes...>>();
 }
 
+// Every open stream keeps up to block_length elements in flight in its
+// buffer, and the output side takes the first buffered element that is
+// already available, scanning from the current cycle position. Slow streams
+// therefore never stall their slot: their in-flight elements stay buffered
+// while faster streams are drained.
+template <typename... InputTypes, typename... OutputTypes>
+AsyncValueRef<std::tuple<OutputTypes...>>
+InterleaveDatasetIterator<std::tuple<InputTypes...>,
+                          std::tuple<OutputTypes...>>::
+    GetNextWorkStealing(const ExecutionContext& exec_ctx) {
+  const size_t cycle_length = parent_dataset_->cycle_length_;
+  const size_t buffer_size =
+      std::max<int64_t>(1, parent_dataset_->block_length_);
+  while (true) {
+    // Open streams for free cycle slots and top up the per-stream buffers.
+    for (size_t idx = 0; idx < cycle_length; ++idx) {
+      if (!cycle_iterators_[idx] && buffers_[idx].empty() && !end_of_input_) {
+        auto input_element = input_iterator_->GetNext(exec_ctx);
+        if (!input_element) {
+          end_of_input_ = true;
+        } else if (!input_element.IsAvailable()) {
+          return EmitErrorAsync(
+              exec_ctx,
+              "interleave expects its inputs to be available synchronously");
+        } else if (input_element.IsError()) {
+          return AsyncValueRef<std::tuple<OutputTypes...>>(
+              input_element.ReleaseRCRef());
+        } else {
+          cycle_iterators_[idx] =
+              MakeIteratorFromInputElement(std::move(input_element), exec_ctx);
+          ++num_open_;
+        }
+      }
+      while (cycle_iterators_[idx] && buffers_[idx].size() < buffer_size) {
+        auto value = cycle_iterators_[idx]->GetNext(exec_ctx);
+        if (!value) {
+          // The stream is exhausted. Its buffered elements still drain
+          // before the slot is reused above.
+          cycle_iterators_[idx].reset();
+          --num_open_;
+          break;
+        }
+        buffers_[idx].push(std::move(value));
+      }
+    }
+
+    // Prefer an element that is already available, scanning from the current
+    // cycle position. If none is ready, fall back to the first non-empty
+    // buffer so the caller blocks on exactly one stream.
+    int64_t first_nonempty = -1;
+    for (size_t i = 0; i < cycle_length; ++i) {
+      const size_t idx = (cycle_index_ + i) % cycle_length;
+      auto& buffer = buffers_[idx];
+      if (buffer.empty()) continue;
+      if (first_nonempty < 0) first_nonempty = idx;
+      if (buffer.front().IsAvailable()) return TakeFromStream(idx);
+    }
+    if (first_nonempty >= 0) return TakeFromStream(first_nonempty);
+
+    // All buffers are empty. Either iteration is done, or cycle slots freed
+    // up and the next loop iteration opens new streams.
+    if (end_of_input_ && num_open_ == 0) {
+      return AsyncValueRef<std::tuple<OutputTypes...>>();
+    }
+  }
+}
+
 template <typename... InputTypes, typename... OutputTypes>
 RCReference<Iterator<OutputTypes...>> InterleaveDatasetIterator<
     std::tuple<InputTypes...>, std::tuple<OutputTypes...>>::
@@ -253,7 +375,7 @@ RCReference<Iterator<OutputTypes...>> InterleaveDatasetIterator<
 
   const auto& dataset =
       fn_results[0]->template get<RCReference<Dataset<OutputTypes...>>>();
-  return dataset->MakeIterator();
+  return dataset->MakeIterator(context_.CopyRef());
 }
 
 }  // namespace data
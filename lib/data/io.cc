@@ -0,0 +1,329 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- io.cc --------------------------------------------------------------===//
+//
+// This file implements BufferedFileStream and GzipInflateStream.
+//
+//===----------------------------------------------------------------------===//
+
+#include "io.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tfrt/host_context/host_context.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#define TFRT_DATA_HAS_PREAD 1
+#endif
+
+namespace tfrt {
+namespace data {
+namespace io {
+
+constexpr size_t BufferedFileStream::kBlockSize;
+constexpr size_t BufferedFileStream::kBlockAlignment;
+
+#ifdef TFRT_DATA_HAS_PREAD
+
+namespace {
+// Reads a full block (or whatever is left of the file) at `offset`. Returns
+// the number of bytes read, or -1 on a read error.
+int64_t ReadBlock(int fd, char* dst, size_t size, uint64_t offset) {
+  size_t total = 0;
+  while (total < size) {
+    ssize_t n = pread(fd, dst + total, size - total, offset + total);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    }
+    if (n == 0) break;
+    total += n;
+  }
+  return total;
+}
+}  // namespace
+
+BufferedFileStream::BufferedFileStream(const std::string& path,
+                                       HostContext* host)
+    : host_(host), allocator_(host->allocator()) {
+  int flags = O_RDONLY;
+#ifdef O_DIRECT
+  // Bypass the page cache when the platform allows it; the stream does its
+  // own buffering and the data is consumed exactly once.
+  fd_ = open(path.c_str(), flags | O_DIRECT);
+#endif
+  if (fd_ < 0) fd_ = open(path.c_str(), flags);
+  if (fd_ < 0) {
+    failed_ = true;
+    return;
+  }
+  for (auto& block : blocks_) {
+    block = static_cast<char*>(
+        allocator_->AllocateBytes(kBlockSize, kBlockAlignment));
+    if (!block) {
+      failed_ = true;
+      return;
+    }
+  }
+  // Start filling the first block right away, so the first Read() already
+  // finds data in flight.
+  pending_index_ = 1;
+  pending_ = IssueBlockRead(blocks_[pending_index_], 0);
+  next_offset_ = kBlockSize;
+}
+
+BufferedFileStream::~BufferedFileStream() {
+  // The in-flight read writes into blocks_, so it must finish before the
+  // blocks are freed.
+  if (pending_) host_->Await({pending_.CopyRCRef()});
+  for (auto& block : blocks_) {
+    if (block) allocator_->DeallocateBytes(block, kBlockSize);
+  }
+  if (fd_ >= 0) close(fd_);
+}
+
+AsyncValueRef<int64_t> BufferedFileStream::IssueBlockRead(char* dst,
+                                                          uint64_t offset) {
+  auto result = host_->MakeUnconstructedAsyncValueRef<int64_t>();
+  bool enqueued = host_->EnqueueBlockingWork(
+      [fd = fd_, dst, offset, result = result.CopyRef()] {
+        result.emplace(ReadBlock(fd, dst, kBlockSize, offset));
+      });
+  if (!enqueued) result.emplace(ReadBlock(fd_, dst, kBlockSize, offset));
+  return result;
+}
+
+bool BufferedFileStream::SwapInPendingBlock() {
+  if (!pending_) {
+    if (!failed_) eof_ = true;
+    return false;
+  }
+  host_->Await({pending_.CopyRCRef()});
+  const int64_t bytes_read = pending_.get();
+  if (bytes_read < 0) {
+    failed_ = true;
+    pending_ = AsyncValueRef<int64_t>();
+    return false;
+  }
+  current_ = pending_index_;
+  current_size_ = bytes_read;
+  current_pos_ = 0;
+  if (static_cast<size_t>(bytes_read) < kBlockSize) {
+    // A short read means the end of the file is inside this block; there is
+    // nothing left to prefetch.
+    pending_ = AsyncValueRef<int64_t>();
+  } else {
+    pending_index_ = 1 - current_;
+    pending_ = IssueBlockRead(blocks_[pending_index_], next_offset_);
+    next_offset_ += kBlockSize;
+  }
+  if (bytes_read == 0) {
+    eof_ = true;
+    return false;
+  }
+  return true;
+}
+
+size_t BufferedFileStream::Read(char* dst, size_t n) {
+  if (failed_) return 0;
+  size_t total = 0;
+  while (total < n) {
+    if (current_pos_ == current_size_) {
+      if (!SwapInPendingBlock()) break;
+    }
+    const size_t copied =
+        std::min(n - total, current_size_ - current_pos_);
+    std::memcpy(dst + total, blocks_[current_] + current_pos_, copied);
+    current_pos_ += copied;
+    total += copied;
+  }
+  return total;
+}
+
+#else  // !TFRT_DATA_HAS_PREAD
+
+BufferedFileStream::BufferedFileStream(const std::string& path,
+                                       HostContext* host)
+    : host_(host),
+      allocator_(host->allocator()),
+      fallback_stream_(path, std::ios_base::binary) {
+  if (!fallback_stream_) failed_ = true;
+}
+
+BufferedFileStream::~BufferedFileStream() = default;
+
+AsyncValueRef<int64_t> BufferedFileStream::IssueBlockRead(char* dst,
+                                                          uint64_t offset) {
+  return AsyncValueRef<int64_t>();
+}
+
+bool BufferedFileStream::SwapInPendingBlock() { return false; }
+
+size_t BufferedFileStream::Read(char* dst, size_t n) {
+  if (failed_) return 0;
+  fallback_stream_.read(dst, n);
+  const size_t bytes_read = fallback_stream_.gcount();
+  if (fallback_stream_.eof()) {
+    eof_ = true;
+  } else if (fallback_stream_.fail()) {
+    failed_ = true;
+  }
+  return bytes_read;
+}
+
+#endif  // TFRT_DATA_HAS_PREAD
+
+constexpr size_t GzipInflateStream::kBlockSize;
+constexpr size_t GzipInflateStream::kBlockAlignment;
+constexpr size_t GzipInflateStream::kInputChunkSize;
+constexpr int GzipInflateStream::kWindowBits;
+
+GzipInflateStream::GzipInflateStream(const std::string& path,
+                                     HostContext* host)
+    : host_(host), allocator_(host->allocator()), source_(path, host) {
+  if (source_.fail()) {
+    failed_ = true;
+    return;
+  }
+  for (auto& block : blocks_) {
+    block = static_cast<char*>(
+        allocator_->AllocateBytes(kBlockSize, kBlockAlignment));
+    if (!block) {
+      failed_ = true;
+      return;
+    }
+  }
+  input_ = static_cast<char*>(
+      allocator_->AllocateBytes(kInputChunkSize, kBlockAlignment));
+  if (!input_) {
+    failed_ = true;
+    return;
+  }
+  std::memset(&zstream_, 0, sizeof(zstream_));
+  if (inflateInit2(&zstream_, kWindowBits) != Z_OK) {
+    failed_ = true;
+    return;
+  }
+  zstream_initialized_ = true;
+  // Start decoding the first block right away, so the first Read() already
+  // finds a decode in flight.
+  pending_index_ = 1;
+  pending_ = IssueDecode(blocks_[pending_index_]);
+}
+
+GzipInflateStream::~GzipInflateStream() {
+  // The in-flight decode writes into blocks_ and uses zstream_, so it must
+  // finish before they are torn down.
+  if (pending_) host_->Await({pending_.CopyRCRef()});
+  if (zstream_initialized_) inflateEnd(&zstream_);
+  for (auto& block : blocks_) {
+    if (block) allocator_->DeallocateBytes(block, kBlockSize);
+  }
+  if (input_) allocator_->DeallocateBytes(input_, kInputChunkSize);
+}
+
+int64_t GzipInflateStream::DecodeBlock(char* dst) {
+  zstream_.next_out = reinterpret_cast<Bytef*>(dst);
+  zstream_.avail_out = kBlockSize;
+  while (zstream_.avail_out > 0) {
+    if (zstream_.avail_in == 0) {
+      if (!source_.eof()) {
+        const size_t n = source_.Read(input_, kInputChunkSize);
+        if (source_.fail()) return -1;
+        zstream_.next_in = reinterpret_cast<Bytef*>(input_);
+        zstream_.avail_in = n;
+      }
+      // Compressed input exhausted.
+      if (zstream_.avail_in == 0) break;
+    }
+    const int status = inflate(&zstream_, Z_NO_FLUSH);
+    if (status == Z_STREAM_END) {
+      at_member_boundary_ = true;
+      // A gzip file may hold several concatenated members; reset the
+      // decoder and keep inflating into the same block.
+      if (inflateReset2(&zstream_, kWindowBits) != Z_OK) return -1;
+      continue;
+    }
+    if (status != Z_OK) return -1;
+    at_member_boundary_ = false;
+  }
+  // Running out of compressed bytes in the middle of a member means the
+  // file is truncated.
+  if (zstream_.avail_out > 0 && !at_member_boundary_) return -1;
+  return kBlockSize - zstream_.avail_out;
+}
+
+AsyncValueRef<int64_t> GzipInflateStream::IssueDecode(char* dst) {
+  auto result = host_->MakeUnconstructedAsyncValueRef<int64_t>();
+  bool enqueued =
+      host_->EnqueueBlockingWork([this, dst, result = result.CopyRef()] {
+        result.emplace(DecodeBlock(dst));
+      });
+  if (!enqueued) result.emplace(DecodeBlock(dst));
+  return result;
+}
+
+bool GzipInflateStream::SwapInPendingBlock() {
+  if (!pending_) {
+    if (!failed_) eof_ = true;
+    return false;
+  }
+  host_->Await({pending_.CopyRCRef()});
+  const int64_t bytes_decoded = pending_.get();
+  if (bytes_decoded < 0) {
+    failed_ = true;
+    pending_ = AsyncValueRef<int64_t>();
+    return false;
+  }
+  current_ = pending_index_;
+  current_size_ = bytes_decoded;
+  current_pos_ = 0;
+  if (static_cast<size_t>(bytes_decoded) < kBlockSize) {
+    // A short decode means the compressed stream ended inside this block;
+    // there is nothing left to decode.
+    pending_ = AsyncValueRef<int64_t>();
+  } else {
+    pending_index_ = 1 - current_;
+    pending_ = IssueDecode(blocks_[pending_index_]);
+  }
+  if (bytes_decoded == 0) {
+    eof_ = true;
+    return false;
+  }
+  return true;
+}
+
+size_t GzipInflateStream::Read(char* dst, size_t n) {
+  if (failed_) return 0;
+  size_t total = 0;
+  while (total < n) {
+    if (current_pos_ == current_size_) {
+      if (!SwapInPendingBlock()) break;
+    }
+    const size_t copied = std::min(n - total, current_size_ - current_pos_);
+    std::memcpy(dst + total, blocks_[current_] + current_pos_, copied);
+    current_pos_ += copied;
+    total += copied;
+  }
+  return total;
+}
+
+}  // namespace io
+}  // namespace data
+}  // namespace tfrt
@@ -0,0 +1,380 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- map_and_batch_dataset.h ----------------------------------*- C++ -*-===//
+//
+// This file declares MapAndBatchDataset class which fuses MapDataset and
+// BatchDataset into a single stage: the map function output is copied
+// directly into its slot of the batch output tensor instead of being
+// materialized as a per-element tuple AsyncValue first.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_LIB_DATA_MAP_AND_BATCH_DATASET_H_
+#define TFRT_LIB_DATA_MAP_AND_BATCH_DATASET_H_
+
+#include "batch_dataset.h"
+#include "dataset.h"
+#include "tfrt/host_context/function.h"
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+namespace data {
+
+template <typename... T>
+class MapAndBatchDataset;
+
+template <typename... T>
+class MapAndBatchDatasetIterator;
+
+// Copy the map function's results into the `index`-th slot of each batch
+// output tensor. `results` holds one available AsyncValue per output of the
+// map function.
+template <typename... T, size_t... I>
+void CopyResultsToBatch(
+    SmallVector<RCReference<AsyncValue>, sizeof...(T)>& results,
+    DHTTuple<sizeof...(T)>& batch, int index, std::index_sequence<I...>) {
+  // Use std::initializer_list to call CopyDataHelper(...) for every result.
+  std::ignore = std::initializer_list<int>{
+      (CopyDataHelper(&results[I]->template get<T>(), &std::get<I>(batch),
+                      index),
+       0)...};
+}
+
+// Given the available results of one map function invocation, return an array
+// where the i-th element is the TensorMetadata of the i-th result.
+template <typename... T, size_t... I>
+std::array<TensorMetadata, sizeof...(T)> GetMetadatasFromResults(
+    SmallVector<RCReference<AsyncValue>, sizeof...(T)>& results,
+    std::index_sequence<I...>) {
+  std::array<TensorMetadata, sizeof...(T)> tensor_metadatas;
+  std::ignore = std::initializer_list<int>{
+      (tensor_metadatas[I] =
+           GetMetadataFromValue(results[I]->template get<T>()),
+       0)...};
+  return tensor_metadatas;
+}
+
+// MapAndBatchDataset applies a user-defined function over the elements in its
+// input dataset and batches up to `batch_size` consecutive function outputs
+// into one output element, as if a MapDataset were chained into a
+// BatchDataset. Unlike that chain, each function output is copied into its
+// batch slot directly from the function's result AsyncValues, so no
+// intermediate std::tuple AsyncValue is allocated or signaled per element.
+template <typename... InputTypes, typename... OutputTypes>
+class MapAndBatchDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>
+    : public DHTDataset<sizeof...(OutputTypes)> {
+ public:
+  explicit MapAndBatchDataset(RCReference<Dataset<InputTypes...>> input_dataset,
+                              int32_t batch_size,
+                              RCArray<AsyncValue> additional_fn_args,
+                              RCReference<const Function> map_fn,
+                              HostContext* host)
+      : input_dataset_(std::move(input_dataset)),
+        batch_size_(batch_size),
+        host_(host),
+        allocator_(host->allocator()),
+        additional_fn_args_(std::move(additional_fn_args)),
+        map_fn_(std::move(map_fn)) {}
+
+  // This class is not copyable or movable.
+  MapAndBatchDataset(const MapAndBatchDataset&) = delete;
+  MapAndBatchDataset& operator=(const MapAndBatchDataset&) = delete;
+
+  RCReference<DHTIterator<sizeof...(OutputTypes)>> MakeIterator(
+      RCReference<IteratorContext> context) override;
+
+ private:
+  // Allow iterator to rely on private data members of this dataset.
+  friend class MapAndBatchDatasetIterator<std::tuple<InputTypes...>,
+                                          std::tuple<OutputTypes...>>;
+
+  void Destroy() override {
+    internal::DestroyImpl<MapAndBatchDataset<std::tuple<InputTypes...>,
+                                             std::tuple<OutputTypes...>>>(
+        this, allocator_);
+  }
+
+  RCReference<Dataset<InputTypes...>> input_dataset_;
+  int32_t batch_size_;
+  HostContext* host_;
+  HostAllocator* allocator_;
+  RCArray<AsyncValue> additional_fn_args_;
+  RCReference<const Function> map_fn_;
+};
+
+template <typename... InputTypes, typename... OutputTypes>
+class MapAndBatchDatasetIterator<std::tuple<InputTypes...>,
+                                 std::tuple<OutputTypes...>>
+    : public DHTIterator<sizeof...(OutputTypes)> {
+  static constexpr size_t kNumOutputs = sizeof...(OutputTypes);
+
+ public:
+  explicit MapAndBatchDatasetIterator(
+      RCReference<MapAndBatchDataset<std::tuple<InputTypes...>,
+                                     std::tuple<OutputTypes...>>>
+          parent_dataset,
+      RCReference<IteratorContext> context)
+      : DHTIterator<kNumOutputs>(),
+        parent_dataset_(std::move(parent_dataset)),
+        context_(std::move(context)),
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator(
+            context_.CopyRef())) {}
+
+  // This class is not copyable or movable.
+  MapAndBatchDatasetIterator(const MapAndBatchDatasetIterator&) = delete;
+  MapAndBatchDatasetIterator& operator=(const MapAndBatchDatasetIterator&) =
+      delete;
+
+  AsyncValueRef<DHTTuple<kNumOutputs>> GetNext(
+      const ExecutionContext& exec_ctx) override {
+    llvm::SmallVector<AsyncValueRef<std::tuple<InputTypes...>>, 4> values;
+    // Get up to batch_size values from the underlying iterator.
+    for (int i = 0; i < parent_dataset_->batch_size_; ++i) {
+      auto value = input_iterator_->GetNext(exec_ctx);
+      if (!value) {
+        break;
+      }
+      if (value.IsError()) {
+        return AsyncValueRef<DHTTuple<kNumOutputs>>(value.ReleaseRCRef());
+      }
+      values.push_back(std::move(value));
+    }
+    if (values.empty()) {
+      return AsyncValueRef<DHTTuple<kNumOutputs>>();
+    }
+    auto* host = exec_ctx.host();
+    // The batch output tensors are allocated by the first element once its
+    // map function results are available, because only those results carry
+    // the per-element metadata. All other elements wait on
+    // temp_batched_value before copying into their slots.
+    auto temp_batched_value =
+        host->template MakeUnconstructedAsyncValueRef<DHTTuple<kNumOutputs>>();
+    auto batched_value =
+        host->template MakeUnconstructedAsyncValueRef<DHTTuple<kNumOutputs>>();
+    // counter_and_error is used to keep track of 1) the count of remaining
+    // elements that have not been copied and 2) first error from any element.
+    auto* counter_and_error = new CounterAndError(values.size());
+    const int32_t batch_size = values.size();
+    for (int32_t idx = 0; idx < batch_size; ++idx) {
+      LaunchMapAndCopy(std::move(values[idx]), idx, batch_size,
+                       temp_batched_value.CopyRef(), batched_value.CopyRef(),
+                       counter_and_error, exec_ctx);
+    }
+    return batched_value;
+  }
+
+ private:
+  void Destroy() override {
+    internal::DestroyImpl<MapAndBatchDatasetIterator>(
+        this, parent_dataset_->allocator_);
+  }
+
+  // Record `error` as the batch error unless another element got there first.
+  static void RecordError(CounterAndError* counter_and_error,
+                          RCReference<AsyncValue> error) {
+    AsyncValue* expected_value = nullptr;
+    AsyncValue* error_value = error.release();
+    // Use memory_order_release for the success case so that error_value is
+    // visible to other threads when they load with memory_order_acquire. For
+    // the failure case, we do not care about expected_value, so we can use
+    // memory_order_relaxed.
+    if (!counter_and_error->error.compare_exchange_strong(
+            expected_value, error_value, std::memory_order_release,
+            std::memory_order_relaxed)) {
+      error_value->DropRef();
+    }
+  }
+
+  // Mark one element of the batch as done. The last element to complete
+  // resolves `batched_value` from either the recorded error or the fully
+  // populated `temp_batched_value`.
+  static void CompleteElement(
+      AsyncValueRef<DHTTuple<kNumOutputs>> temp_batched_value,
+      AsyncValueRef<DHTTuple<kNumOutputs>> batched_value,
+      CounterAndError* counter_and_error) {
+    if (counter_and_error->counter.fetch_sub(1) == 1) {
+      // Use memory_order_consume so that writes to this atomic variable from
+      // other threads are visible to this thread.
+      auto* error_value =
+          counter_and_error->error.load(std::memory_order_consume);
+      if (error_value != nullptr) {
+        batched_value.SetError(error_value->GetError());
+        error_value->DropRef();
+      } else {
+        batched_value.emplace(std::move(temp_batched_value.get()));
+      }
+      delete counter_and_error;
+    }
+  }
+
+  // Run the map function on one input element and, once its results are
+  // available, copy them straight into the `index`-th slot of the batch
+  // output tensors. The element at index 0 additionally allocates the batch
+  // output from its results' metadata and resolves `temp_batched_value`, on
+  // both success and failure, so that the other elements always make
+  // progress.
+  void LaunchMapAndCopy(AsyncValueRef<std::tuple<InputTypes...>> args,
+                        int32_t index, int32_t batch_size,
+                        AsyncValueRef<DHTTuple<kNumOutputs>> temp_batched_value,
+                        AsyncValueRef<DHTTuple<kNumOutputs>> batched_value,
+                        CounterAndError* counter_and_error,
+                        const ExecutionContext& exec_ctx) {
+    auto* host = exec_ctx.host();
+    auto map_fn = FormRef(parent_dataset_->map_fn_.get());
+    auto additional_fn_args = parent_dataset_->additional_fn_args_.CopyRef();
+    auto arena = context_->arena().CopyRef();
+    // Enqueue the map function to the threadpool so that the functions of a
+    // batch run in parallel, as MapDataset does for individual elements.
+    host->EnqueueWork([host, map_fn = std::move(map_fn),
+                       additional_fn_args = std::move(additional_fn_args),
+                       args = std::move(args), index, batch_size,
+                       arena = std::move(arena),
+                       temp_batched_value = std::move(temp_batched_value),
+                       batched_value = std::move(batched_value),
+                       counter_and_error, exec_ctx]() mutable {
+      args.AndThen([host, map_fn = map_fn.CopyRef(),
+                    additional_fn_args = std::move(additional_fn_args),
+                    args = args.CopyRef(), index, batch_size,
+                    arena = std::move(arena),
+                    temp_batched_value = std::move(temp_batched_value),
+                    batched_value = std::move(batched_value),
+                    counter_and_error, exec_ctx]() mutable {
+        if (args.IsError()) {
+          RecordError(counter_and_error, args.CopyRCRef());
+          if (index == 0) temp_batched_value.SetError(args.GetError());
+          CompleteElement(std::move(temp_batched_value),
+                          std::move(batched_value), counter_and_error);
+          return;
+        }
+        // Construct arguments for function execution. The arguments consist
+        // of the 'additional_fn_args' from the MapAndBatchDataset constructor,
+        // followed by the values from the underlying iterator.
+        SmallVector<AsyncValue*, 4> arguments;
+        for (auto* additional_arg : additional_fn_args.values()) {
+          arguments.push_back(additional_arg);
+        }
+        auto arg = host->template MakeAvailableAsyncValueRef<InputTypes...>(
+            std::move(std::get<0>(args.get())));
+        arguments.push_back(arg.GetAsyncValue());
+
+        SmallVector<RCReference<AsyncValue>, kNumOutputs> results;
+        results.resize(map_fn->result_types().size());
+        map_fn->Execute(arguments, results, host);
+
+        // Translate RCReference<AsyncValue> to AsyncValue*.
+        SmallVector<AsyncValue*, 4> async_value_ptrs;
+        for (size_t i = 0; i < kNumOutputs; ++i) {
+          async_value_ptrs.push_back(results[i].get());
+        }
+        host->RunWhenReady(
+            async_value_ptrs,
+            [results = std::move(results), index, batch_size,
+             arena = std::move(arena),
+             temp_batched_value = std::move(temp_batched_value),
+             batched_value = std::move(batched_value), counter_and_error,
+             exec_ctx]() mutable {
+              for (auto& result : results) {
+                if (result->IsError()) {
+                  RecordError(counter_and_error, result.CopyRef());
+                  if (index == 0) {
+                    temp_batched_value.SetError(result->GetError());
+                  }
+                  CompleteElement(std::move(temp_batched_value),
+                                  std::move(batched_value), counter_and_error);
+                  return;
+                }
+              }
+              if (index == 0) {
+                AllocateBatchFromResults(results, batch_size, std::move(arena),
+                                         temp_batched_value, exec_ctx);
+              }
+              // Copy this element into its slot once the batch output
+              // tensors exist.
+              temp_batched_value.AndThen(
+                  [results = std::move(results), index,
+                   temp_batched_value = temp_batched_value.CopyRef(),
+                   batched_value = std::move(batched_value),
+                   counter_and_error]() mutable {
+                    if (temp_batched_value.IsError()) {
+                      RecordError(counter_and_error,
+                                  temp_batched_value.CopyRCRef());
+                    } else {
+                      CopyResultsToBatch<OutputTypes...>(
+                          results, temp_batched_value.get(), index,
+                          std::make_index_sequence<kNumOutputs>{});
+                    }
+                    CompleteElement(std::move(temp_batched_value),
+                                    std::move(batched_value),
+                                    counter_and_error);
+                  });
+            });
+      });
+    });
+  }
+
+  // Allocate the batch output tensors from the metadata of one element's map
+  // function results and resolve `temp_batched_value` with them. Resolves
+  // `temp_batched_value` to an error on allocation failure.
+  static void AllocateBatchFromResults(
+      SmallVector<RCReference<AsyncValue>, kNumOutputs>& results,
+      int32_t batch_size, RCReference<ElementBufferArena> arena,
+      AsyncValueRef<DHTTuple<kNumOutputs>>& temp_batched_value,
+      const ExecutionContext& exec_ctx) {
+    auto metadatas = GetMetadatasFromResults<OutputTypes...>(
+        results, std::make_index_sequence<kNumOutputs>{});
+    SmallVector<DenseHostTensor, 4> tensors;
+    for (auto& element_metadata : metadatas) {
+      SmallVector<ssize_t, 4> output_dims;
+      output_dims.resize(element_metadata.shape.GetRank() + 1);
+      output_dims[0] = batch_size;
+      for (int i = 1; i < output_dims.size(); ++i) {
+        output_dims[i] = element_metadata.shape.GetDimensionSize(i - 1);
+      }
+      TensorMetadata batched_metadata(element_metadata.dtype, output_dims);
+      auto buffer = arena->Allocate(batched_metadata.GetHostSizeInBytes(),
+                                    batched_metadata.dtype.GetHostAlignment());
+      if (!buffer) {
+        temp_batched_value.SetError(
+            EmitError(exec_ctx, "failed to create uninitialized tensor"));
+        return;
+      }
+      tensors.push_back(DenseHostTensor(batched_metadata, std::move(buffer)));
+    }
+    temp_batched_value.emplace(MakeTuple<kNumOutputs>(tensors));
+  }
+
+  RCReference<MapAndBatchDataset<std::tuple<InputTypes...>,
+                                 std::tuple<OutputTypes...>>>
+      parent_dataset_;
+  RCReference<IteratorContext> context_;
+  RCReference<Iterator<InputTypes...>> input_iterator_;
+};
+
+template <typename... InputTypes, typename... OutputTypes>
+RCReference<DHTIterator<sizeof...(OutputTypes)>>
+MapAndBatchDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>::
+    MakeIterator(RCReference<IteratorContext> context) {
+  return TakeRef(
+      host_->Construct<MapAndBatchDatasetIterator<std::tuple<InputTypes...>,
+                                                  std::tuple<OutputTypes...>>>(
+          FormRef(this), std::move(context)));
+}
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_LIB_DATA_MAP_AND_BATCH_DATASET_H_
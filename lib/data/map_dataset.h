@@ -81,7 +81,8 @@ class MapDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>
   MapDataset(const MapDataset&) = delete;
   MapDataset& operator=(const MapDataset&) = delete;
 
-  RCReference<Iterator<OutputTypes...>> MakeIterator() override;
+  RCReference<Iterator<OutputTypes...>> MakeIterator(
+      RCReference<IteratorContext> context) override;
 
  private:
   // Allow iterator to rely on private data members of this dataset.
@@ -108,10 +109,12 @@ class MapDatasetIterator<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>
   explicit MapDatasetIterator(
       RCReference<
           MapDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>>
-          parent_dataset)
+          parent_dataset,
+      RCReference<IteratorContext> context)
       : Iterator<OutputTypes...>(),
         parent_dataset_(std::move(parent_dataset)),
-        input_iterator_(parent_dataset_->input_dataset_->MakeIterator()) {}
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator(
+            std::move(context))) {}
 
   AsyncValueRef<std::tuple<OutputTypes...>> GetNext(
       const ExecutionContext& exec_ctx) override {
@@ -212,12 +215,13 @@ class MapDatasetIterator<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>
 };
 
 template <typename... InputTypes, typename... OutputTypes>
-RCReference<Iterator<OutputTypes...>> MapDataset<
-    std::tuple<InputTypes...>, std::tuple<OutputTypes...>>::MakeIterator() {
+RCReference<Iterator<OutputTypes...>>
+MapDataset<std::tuple<InputTypes...>, std::tuple<OutputTypes...>>::
+    MakeIterator(RCReference<IteratorContext> context) {
   return TakeRef(
       host_->Construct<MapDatasetIterator<std::tuple<InputTypes...>,
                                           std::tuple<OutputTypes...>>>(
-          FormRef(this)));
+          FormRef(this), std::move(context)));
 }
 
 }  // namespace data
@@ -0,0 +1,52 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- metrics.cc ---------------------------------------------------------===//
+//
+// This file implements the per-stage data pipeline telemetry registry.
+//
+//===----------------------------------------------------------------------===//
+
+#include "metrics.h"
+
+#include <map>
+
+#include "tfrt/support/mutex.h"
+
+namespace tfrt {
+namespace data {
+
+IteratorMetrics& GetIteratorMetrics(const std::string& stage) {
+  static mutex* mu = new mutex();
+  static auto* registry = new std::map<std::string, IteratorMetrics>();
+
+  mutex_lock lock(*mu);
+  auto it = registry->find(stage);
+  if (it != registry->end()) return it->second;
+
+  const std::string prefix = "/tfrt/data/" + stage;
+  IteratorMetrics metrics;
+  metrics.elements_produced =
+      metrics::NewCounter<int64_t>(prefix + "/elements_produced");
+  metrics.consumer_wait_us =
+      metrics::NewCounter<int64_t>(prefix + "/consumer_wait_us");
+  metrics.producer_wait_us =
+      metrics::NewCounter<int64_t>(prefix + "/producer_wait_us");
+  metrics.buffer_occupancy =
+      metrics::NewHistogram(prefix + "/buffer_occupancy");
+  return (*registry)[stage] = metrics;
+}
+
+}  // namespace data
+}  // namespace tfrt
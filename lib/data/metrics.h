@@ -0,0 +1,69 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- metrics.h ------------------------------------------------*- C++ -*-===//
+//
+// This file declares always-on telemetry counters for data pipeline stages,
+// used to attribute input pipeline bottlenecks to a stage without ad-hoc
+// instrumented builds.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_LIB_DATA_METRICS_H_
+#define TFRT_LIB_DATA_METRICS_H_
+
+#include <chrono>
+#include <string>
+
+#include "tfrt/metrics/metrics_api.h"
+
+namespace tfrt {
+namespace data {
+
+// Per-stage telemetry, aggregated across all iterators of the same stage
+// type. The streams are exported through the metrics API under
+// /tfrt/data/<stage>/<metric>. Updates are a single counter add or histogram
+// record per element, cheap enough to stay enabled in production.
+struct IteratorMetrics {
+  // Number of elements this stage has handed to its consumer.
+  metrics::Counter<int64_t>* elements_produced;
+  // Microseconds the consumer spent blocked on this stage, i.e. fetching an
+  // element that prefetching had not made resident yet.
+  metrics::Counter<int64_t>* consumer_wait_us;
+  // Microseconds the stage's own prefetch tasks spent in the underlying IO
+  // source.
+  metrics::Counter<int64_t>* producer_wait_us;
+  // Prefetch buffer occupancy observed at each GetNext call. A buffer that
+  // is always empty points at the producer; always full points downstream.
+  metrics::Histogram* buffer_occupancy;
+};
+
+// Returns the metrics of the given stage, creating them on first use. The
+// returned object lives for the duration of the process.
+IteratorMetrics& GetIteratorMetrics(const std::string& stage);
+
+// Returns the elapsed time since `start` in microseconds.
+inline int64_t ElapsedMicroseconds(
+    std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_LIB_DATA_METRICS_H_
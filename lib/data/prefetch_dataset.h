@@ -25,9 +25,12 @@
 #ifndef TFRT_LIB_DATA_PREFETCH_DATASET_H_
 #define TFRT_LIB_DATA_PREFETCH_DATASET_H_
 
+#include <algorithm>
+#include <atomic>
 #include <queue>
 
 #include "dataset.h"
+#include "metrics.h"
 #include "tfrt/support/forward_decls.h"
 
 namespace tfrt {
@@ -38,6 +41,13 @@ class PrefetchDatasetIterator;
 
 // PrefetchDataset class which wraps around another dataset instance and
 // prefetches elements from the underlying dataset in an internal buffer.
+//
+// A non-negative `prefetch_num` keeps exactly that many elements in flight. A
+// negative `prefetch_num` enables autotuning: the iterator adapts the number
+// of in-flight elements within [1, -prefetch_num] based on whether the
+// consumer waits on elements or the producer idles, so pipelines whose input
+// speed shifts (e.g. between cached and cold reads) do not need a hand-tuned
+// value.
 template <typename... T>
 class PrefetchDataset : public Dataset<T...> {
  public:
@@ -51,7 +61,8 @@ class PrefetchDataset : public Dataset<T...> {
   PrefetchDataset(const PrefetchDataset&) = delete;
   PrefetchDataset& operator=(const PrefetchDataset&) = delete;
 
-  RCReference<Iterator<T...>> MakeIterator() override;
+  RCReference<Iterator<T...>> MakeIterator(
+      RCReference<IteratorContext> context) override;
 
  private:
   // Allow iterator to rely on private data members of this dataset.
@@ -70,10 +81,34 @@ template <typename... T>
 class PrefetchDatasetIterator : public Iterator<T...> {
  public:
   explicit PrefetchDatasetIterator(
-      RCReference<PrefetchDataset<T...>> parent_dataset)
+      RCReference<PrefetchDataset<T...>> parent_dataset,
+      RCReference<IteratorContext> context)
       : Iterator<T...>(),
         parent_dataset_(std::move(parent_dataset)),
-        input_iterator_(parent_dataset_->input_dataset_->MakeIterator()) {}
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator(
+            std::move(context))) {
+    int32_t prefetch_num = parent_dataset_->prefetch_num_;
+    if (prefetch_num >= 0) {
+      prefetch_max_ = prefetch_num;
+      prefetch_target_ = prefetch_num;
+    } else {
+      // Autotuning mode: start at a quarter of the bound and adapt from
+      // there.
+      prefetch_max_ = -prefetch_num;
+      prefetch_target_ = std::max(1, prefetch_max_ / 4);
+    }
+    // Shrink the in-flight target to one element while the allocator is
+    // above its high watermark; the callbacks only flip an atomic flag.
+    watermark_id_ = parent_dataset_->host_->allocator()->RegisterWatermark(
+        kPrefetchResumeBytes, kPrefetchPauseBytes,
+        [this] { memory_paused_.store(true, std::memory_order_relaxed); },
+        [this] { memory_paused_.store(false, std::memory_order_relaxed); });
+  }
+
+  ~PrefetchDatasetIterator() override {
+    // Blocks until any in-flight watermark callback has returned.
+    parent_dataset_->host_->allocator()->UnregisterWatermark(watermark_id_);
+  }
 
   // This class is not copyable or movable.
   PrefetchDatasetIterator(const PrefetchDatasetIterator&) = delete;
@@ -81,11 +116,20 @@ class PrefetchDatasetIterator : public Iterator<T...> {
 
   AsyncValueRef<std::tuple<T...>> GetNext(
       const ExecutionContext& exec_ctx) override {
-    while (buffer_.size() < parent_dataset_->prefetch_num_) {
+    IteratorMetrics& metrics = GetIteratorMetrics("prefetch_dataset");
+    metrics.buffer_occupancy->Record(buffer_.size());
+    if (parent_dataset_->prefetch_num_ < 0) UpdatePrefetchTarget();
+    // Under memory pressure produce just the element being returned, so the
+    // buffer drains (and frees memory) instead of being topped up.
+    const size_t target = memory_paused_.load(std::memory_order_relaxed)
+                              ? 1
+                              : prefetch_target_;
+    while (buffer_.size() < target) {
       buffer_.push(input_iterator_->GetNext(exec_ctx));
     }
     auto result = std::move(buffer_.front());
     buffer_.pop();
+    metrics.elements_produced->Increment();
     return result;
   }
 
@@ -95,15 +139,50 @@ class PrefetchDatasetIterator : public Iterator<T...> {
         this, parent_dataset_->host_->allocator());
   }
 
+  // Adjusts prefetch_target_ based on how ready the buffer is. An element at
+  // the front that is not yet available means the consumer is about to wait
+  // on it, so the in-flight target grows right away. A newest element that is
+  // already available means the producer finished everything in flight and
+  // idles, so after a sustained streak of such observations the target
+  // shrinks again. This tracks the rate mismatch between producer and
+  // consumer as the input's speed shifts.
+  void UpdatePrefetchTarget() {
+    if (buffer_.empty()) return;
+    if (!buffer_.front().IsAvailable()) {
+      if (prefetch_target_ < prefetch_max_) ++prefetch_target_;
+      producer_idle_streak_ = 0;
+    } else if (buffer_.back().IsAvailable()) {
+      ++producer_idle_streak_;
+      if (producer_idle_streak_ >= kShrinkStreak && prefetch_target_ > 1) {
+        --prefetch_target_;
+        producer_idle_streak_ = 0;
+      }
+    }
+  }
+
+  // Number of consecutive producer-idle observations needed before the
+  // in-flight target shrinks. Growing is immediate because a consumer wait
+  // costs much more than a few extra buffered elements.
+  static constexpr int32_t kShrinkStreak = 32;
+
   RCReference<PrefetchDataset<T...>> parent_dataset_;
   RCReference<Iterator<T...>> input_iterator_;
   std::queue<AsyncValueRef<std::tuple<T...>>> buffer_;
+  int32_t prefetch_target_;
+  int32_t prefetch_max_;
+  int32_t producer_idle_streak_ = 0;
+
+  // Set and cleared by the allocator watermark callbacks registered in the
+  // constructor.
+  std::atomic<bool> memory_paused_{false};
+  int watermark_id_;
 };
 
 template <typename... T>
-RCReference<Iterator<T...>> PrefetchDataset<T...>::MakeIterator() {
-  return TakeRef(
-      host_->Construct<PrefetchDatasetIterator<T...>>(FormRef(this)));
+RCReference<Iterator<T...>> PrefetchDataset<T...>::MakeIterator(
+    RCReference<IteratorContext> context) {
+  return TakeRef(host_->Construct<PrefetchDatasetIterator<T...>>(
+      FormRef(this), std::move(context)));
 }
 
 }  // namespace data
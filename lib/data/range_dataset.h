@@ -49,7 +49,8 @@ class RangeDataset : public Dataset<T> {
   RangeDataset(const RangeDataset&) = delete;
   RangeDataset& operator=(const RangeDataset&) = delete;
 
-  RCReference<Iterator<T>> MakeIterator() override;
+  RCReference<Iterator<T>> MakeIterator(
+      RCReference<IteratorContext> context) override;
 
  private:
   friend class RangeDatasetIterator<T>;
@@ -98,7 +99,8 @@ class RangeDatasetIterator : public Iterator<T> {
 };
 
 template <typename T>
-RCReference<Iterator<T>> RangeDataset<T>::MakeIterator() {
+RCReference<Iterator<T>> RangeDataset<T>::MakeIterator(
+    RCReference<IteratorContext> context) {
   return TakeRef(host_->Construct<RangeDatasetIterator<T>>(FormRef(this)));
 }
 
@@ -0,0 +1,385 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- remote_io.cc -------------------------------------------------------===//
+//
+// This file implements HttpRangeStream.
+//
+//===----------------------------------------------------------------------===//
+
+#include "remote_io.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/string_util.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#define TFRT_DATA_HAS_SOCKETS 1
+#endif
+
+namespace tfrt {
+namespace data {
+namespace io {
+
+constexpr int HttpRangeStream::kDefaultMaxInflight;
+constexpr int HttpRangeStream::kDefaultMaxRetries;
+constexpr size_t HttpRangeStream::kBlockSize;
+constexpr size_t HttpRangeStream::kBlockAlignment;
+
+#ifdef TFRT_DATA_HAS_SOCKETS
+
+namespace {
+
+// First backoff delay; doubled on every failed attempt.
+constexpr int kInitialBackoffMs = 100;
+// Responses larger than this before the header terminator are rejected.
+constexpr size_t kMaxHeaderBytes = 64 << 10;
+
+// Splits "http://host[:port]/path" into its parts. Returns false if the url
+// does not have that shape.
+bool ParseHttpUrl(const std::string& url, std::string* server,
+                  std::string* port, std::string* path) {
+  const llvm::StringRef kScheme = "http://";
+  llvm::StringRef rest = url;
+  if (!rest.startswith(kScheme)) return false;
+  rest = rest.drop_front(kScheme.size());
+
+  const size_t slash = rest.find('/');
+  llvm::StringRef authority =
+      slash == llvm::StringRef::npos ? rest : rest.take_front(slash);
+  *path = slash == llvm::StringRef::npos ? "/" : rest.drop_front(slash).str();
+
+  const size_t colon = authority.find(':');
+  if (colon == llvm::StringRef::npos) {
+    *server = authority.str();
+    *port = "80";
+  } else {
+    *server = authority.take_front(colon).str();
+    *port = authority.drop_front(colon + 1).str();
+  }
+  return !server->empty() && !port->empty();
+}
+
+// Opens a connected stream socket to server:port. Returns -1 on failure.
+int OpenConnection(const std::string& server, const std::string& port) {
+  struct addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  struct addrinfo* addresses = nullptr;
+  if (getaddrinfo(server.c_str(), port.c_str(), &hints, &addresses) != 0)
+    return -1;
+
+  int fd = -1;
+  for (struct addrinfo* addr = addresses; addr; addr = addr->ai_next) {
+    fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    if (fd < 0) continue;
+    if (connect(fd, addr->ai_addr, addr->ai_addrlen) == 0) break;
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(addresses);
+  return fd;
+}
+
+// Writes all of `data` to the socket. Returns false on error.
+bool SendAll(int fd, llvm::StringRef data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent, 0);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    sent += n;
+  }
+  return true;
+}
+
+// Reads from the socket until the header terminator. The header text lands
+// in `header`; body bytes received along with it land in `body_start`.
+// Returns false on a read error or an oversized header.
+bool ReadResponseHeader(int fd, std::string* header, std::string* body_start) {
+  std::string received;
+  char chunk[4096];
+  while (received.size() < kMaxHeaderBytes) {
+    const size_t terminator = received.find("\r\n\r\n");
+    if (terminator != std::string::npos) {
+      *header = received.substr(0, terminator);
+      *body_start = received.substr(terminator + 4);
+      return true;
+    }
+    ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    received.append(chunk, n);
+  }
+  return false;
+}
+
+// Returns the status code of the response, or -1 if the status line does
+// not parse.
+int ParseStatusCode(llvm::StringRef header) {
+  // Status line: "HTTP/1.x NNN reason".
+  const size_t space = header.find(' ');
+  if (space == llvm::StringRef::npos) return -1;
+  int code = -1;
+  if (header.drop_front(space + 1).take_front(3).getAsInteger(10, code))
+    return -1;
+  return code;
+}
+
+// Returns the Content-Length of the response, or -1 if absent.
+int64_t ParseContentLength(llvm::StringRef header) {
+  llvm::StringRef rest = header;
+  while (!rest.empty()) {
+    llvm::StringRef line;
+    std::tie(line, rest) = rest.split("\r\n");
+    llvm::StringRef name, value;
+    std::tie(name, value) = line.split(':');
+    if (name.trim().lower() != "content-length") continue;
+    int64_t length = -1;
+    if (value.trim().getAsInteger(10, length)) return -1;
+    return length;
+  }
+  return -1;
+}
+
+// One fetch attempt: requests `size` bytes at `offset` over a fresh
+// connection. Returns the number of body bytes received, 0 past the end of
+// the object, -1 on a retryable failure (connection or server error) and -2
+// on a permanent one (e.g. the server does not honor range requests).
+int64_t FetchRangeOnce(const std::string& server, const std::string& port,
+                       const std::string& path, uint64_t offset, char* dst,
+                       size_t size) {
+  int fd = OpenConnection(server, port);
+  if (fd < 0) return -1;
+
+  // One connection per request keeps concurrent fetches and retries
+  // independent of each other.
+  const std::string request =
+      StrCat("GET ", path, " HTTP/1.1\r\nHost: ", server,
+             "\r\nRange: bytes=", offset, "-", offset + size - 1,
+             "\r\nConnection: close\r\n\r\n");
+  std::string header, body;
+  if (!SendAll(fd, request) || !ReadResponseHeader(fd, &header, &body)) {
+    close(fd);
+    return -1;
+  }
+
+  const int status = ParseStatusCode(header);
+  if (status == 416) {
+    // Requested range begins past the end of the object.
+    close(fd);
+    return 0;
+  }
+  if (status >= 500) {
+    close(fd);
+    return -1;
+  }
+  if (status != 206) {
+    // Includes 200: a server that ignores Range would make every fetch
+    // restart from the beginning, so treat it as unusable rather than
+    // retrying.
+    close(fd);
+    return -2;
+  }
+
+  int64_t content_length = ParseContentLength(header);
+  if (content_length < 0 || static_cast<size_t>(content_length) > size) {
+    close(fd);
+    return -2;
+  }
+
+  // Body bytes that arrived with the header, then the rest off the socket.
+  size_t received = std::min(body.size(), static_cast<size_t>(content_length));
+  std::memcpy(dst, body.data(), received);
+  while (received < static_cast<size_t>(content_length)) {
+    ssize_t n = recv(fd, dst + received, content_length - received, 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      close(fd);
+      return -1;
+    }
+    received += n;
+  }
+  close(fd);
+  return content_length;
+}
+
+// Fetches with retries: transient failures back off exponentially before
+// trying again. Returns body bytes received, 0 past the end of the object,
+// or -1 once the retry budget is exhausted or the failure is permanent.
+int64_t FetchRange(const std::string& server, const std::string& port,
+                   const std::string& path, uint64_t offset, char* dst,
+                   size_t size, int max_retries) {
+  int backoff_ms = kInitialBackoffMs;
+  for (int attempt = 0;; ++attempt) {
+    const int64_t result = FetchRangeOnce(server, port, path, offset, dst,
+                                          size);
+    if (result >= 0) return result;
+    if (result == -2 || attempt == max_retries) return -1;
+    std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+    backoff_ms *= 2;
+  }
+}
+
+}  // namespace
+
+HttpRangeStream::HttpRangeStream(const std::string& url, HostContext* host,
+                                 int max_inflight, int max_retries)
+    : host_(host),
+      allocator_(host->allocator()),
+      max_inflight_(max_inflight),
+      max_retries_(max_retries) {
+  assert(max_inflight >= 1);
+  if (!ParseHttpUrl(url, &server_, &port_, &path_)) {
+    failed_ = true;
+    return;
+  }
+  // One buffer per in-flight fetch plus one being consumed.
+  for (int i = 0; i != max_inflight_ + 1; ++i) {
+    char* block = static_cast<char*>(
+        allocator_->AllocateBytes(kBlockSize, kBlockAlignment));
+    if (!block) {
+      failed_ = true;
+      return;
+    }
+    blocks_.push_back(block);
+    free_blocks_.push_back(i);
+  }
+  // Start fetching right away, so the first Read() finds data in flight.
+  FillFetchWindow();
+}
+
+HttpRangeStream::~HttpRangeStream() {
+  // In-flight fetches write into blocks_, so they must finish before the
+  // blocks are freed.
+  for (auto& fetch : pending_) host_->Await({fetch.result.CopyRCRef()});
+  for (char* block : blocks_) {
+    if (block) allocator_->DeallocateBytes(block, kBlockSize);
+  }
+}
+
+AsyncValueRef<int64_t> HttpRangeStream::IssueRangeFetch(char* dst,
+                                                        uint64_t offset) {
+  auto result = host_->MakeUnconstructedAsyncValueRef<int64_t>();
+  auto fetch = [server = server_, port = port_, path = path_, offset, dst,
+                max_retries = max_retries_, result = result.CopyRef()] {
+    result.emplace(
+        FetchRange(server, port, path, offset, dst, kBlockSize, max_retries));
+  };
+  if (!host_->EnqueueBlockingWork(fetch)) fetch();
+  return result;
+}
+
+void HttpRangeStream::FillFetchWindow() {
+  while (!end_known_ && !free_blocks_.empty() &&
+         pending_.size() < static_cast<size_t>(max_inflight_)) {
+    const int block = free_blocks_.pop_back_val();
+    pending_.push_back(
+        PendingFetch{IssueRangeFetch(blocks_[block], next_offset_), block});
+    next_offset_ += kBlockSize;
+  }
+}
+
+bool HttpRangeStream::SwapInPendingBlock() {
+  if (current_ >= 0) {
+    free_blocks_.push_back(current_);
+    current_ = -1;
+  }
+  if (pending_.empty()) {
+    if (!failed_) eof_ = true;
+    return false;
+  }
+  auto fetch = std::move(pending_.front());
+  pending_.erase(pending_.begin());
+  host_->Await({fetch.result.CopyRCRef()});
+  const int64_t bytes_received = fetch.result.get();
+  if (bytes_received < 0) {
+    failed_ = true;
+    free_blocks_.push_back(fetch.block);
+    return false;
+  }
+  if (static_cast<size_t>(bytes_received) < kBlockSize) {
+    // A short block means the object ends inside it; fetches already in
+    // flight past it will come back empty.
+    end_known_ = true;
+  }
+  if (bytes_received == 0) {
+    free_blocks_.push_back(fetch.block);
+    eof_ = true;
+    return false;
+  }
+  current_ = fetch.block;
+  current_size_ = bytes_received;
+  current_pos_ = 0;
+  FillFetchWindow();
+  return true;
+}
+
+size_t HttpRangeStream::Read(char* dst, size_t n) {
+  if (failed_) return 0;
+  size_t total = 0;
+  while (total < n) {
+    if (current_pos_ == current_size_) {
+      if (!SwapInPendingBlock()) break;
+    }
+    const size_t copied = std::min(n - total, current_size_ - current_pos_);
+    std::memcpy(dst + total, blocks_[current_] + current_pos_, copied);
+    current_pos_ += copied;
+    total += copied;
+  }
+  return total;
+}
+
+#else  // !TFRT_DATA_HAS_SOCKETS
+
+HttpRangeStream::HttpRangeStream(const std::string& url, HostContext* host,
+                                 int max_inflight, int max_retries)
+    : host_(host),
+      allocator_(host->allocator()),
+      max_inflight_(max_inflight),
+      max_retries_(max_retries) {
+  failed_ = true;
+}
+
+HttpRangeStream::~HttpRangeStream() {}
+
+AsyncValueRef<int64_t> HttpRangeStream::IssueRangeFetch(char* dst,
+                                                        uint64_t offset) {
+  return host_->MakeAvailableAsyncValueRef<int64_t>(-1);
+}
+
+void HttpRangeStream::FillFetchWindow() {}
+
+bool HttpRangeStream::SwapInPendingBlock() { return false; }
+
+size_t HttpRangeStream::Read(char* dst, size_t n) { return 0; }
+
+#endif  // TFRT_DATA_HAS_SOCKETS
+
+}  // namespace io
+}  // namespace data
+}  // namespace tfrt
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- remote_io.h ----------------------------------------------*- C++ -*-===//
+//
+// Byte stream over HTTP range requests for remote object stores.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_LIB_DATA_REMOTE_IO_H_
+#define TFRT_LIB_DATA_REMOTE_IO_H_
+
+#include <string>
+
+#include "io.h"
+#include "llvm/ADT/SmallVector.h"
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+namespace data {
+namespace io {
+
+// HttpRangeStream reads an object from an HTTP server (e.g. an S3-compatible
+// store, or the gateway fronting one) as a contiguous byte stream, so record
+// parsers consume remote data directly instead of staging it to local disk
+// first.
+//
+// The object is fetched in fixed-size blocks through `Range:` requests, with
+// up to `max_inflight` blocks being fetched concurrently on the blocking
+// work queue - each over its own connection, since range requests are
+// independent. Read() consumes the blocks in offset order, so behind
+// PrefetchingIterator this forms the same pipeline as BufferedFileStream
+// with network fetches in place of disk reads. Failed fetches are retried
+// with exponential backoff before the stream reports an error.
+//
+// `url` has the form "http://host[:port]/path". TLS is not spoken here;
+// point the stream at the store's plaintext endpoint or a local gateway.
+//
+// This class is not thread safe (see BufferedFileStream).
+class HttpRangeStream : public InputStream {
+ public:
+  static constexpr int kDefaultMaxInflight = 4;
+  static constexpr int kDefaultMaxRetries = 3;
+
+  HttpRangeStream(const std::string& url, HostContext* host,
+                  int max_inflight = kDefaultMaxInflight,
+                  int max_retries = kDefaultMaxRetries);
+  ~HttpRangeStream() override;
+
+  // This class is not copyable or movable.
+  HttpRangeStream(const HttpRangeStream&) = delete;
+  HttpRangeStream& operator=(const HttpRangeStream&) = delete;
+
+  size_t Read(char* dst, size_t n) override;
+  bool eof() const override { return eof_; }
+  bool fail() const override { return failed_; }
+
+ private:
+  static constexpr size_t kBlockSize = 1 << 20;
+  static constexpr size_t kBlockAlignment = 64;
+
+  // Fetches the block at `offset` into `dst` on the blocking work queue,
+  // fetching inline if the queue rejects the task. The async value carries
+  // the number of body bytes received, 0 past the end of the object, or -1
+  // after the retry budget is exhausted.
+  AsyncValueRef<int64_t> IssueRangeFetch(char* dst, uint64_t offset);
+
+  // Keeps up to max_inflight_ fetches in flight behind the current block.
+  void FillFetchWindow();
+
+  // Waits for the oldest in-flight fetch, makes its block the current one
+  // and tops the fetch window back up. Returns false at end of stream or on
+  // error.
+  bool SwapInPendingBlock();
+
+  HostContext* host_;
+  HostAllocator* allocator_;
+  const int max_inflight_;
+  const int max_retries_;
+  // Parsed from the url; empty server_ means the url did not parse and the
+  // stream is failed.
+  std::string server_;
+  std::string port_;
+  std::string path_;
+  // One buffer for the current block plus one per in-flight fetch.
+  SmallVector<char*, 8> blocks_;
+  // Buffer indices not currently consumed or being fetched into.
+  SmallVector<int, 8> free_blocks_;
+  // In-flight fetches in offset order, pairing each result with the buffer
+  // it fills.
+  struct PendingFetch {
+    AsyncValueRef<int64_t> result;
+    int block;
+  };
+  SmallVector<PendingFetch, 8> pending_;
+  int current_ = -1;
+  size_t current_size_ = 0;
+  size_t current_pos_ = 0;
+  uint64_t next_offset_ = 0;
+  // Set once a fetch returns fewer bytes than a full block: the object ends
+  // there and no further fetches are issued.
+  bool end_known_ = false;
+  bool eof_ = false;
+  bool failed_ = false;
+};
+
+}  // namespace io
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_LIB_DATA_REMOTE_IO_H_
@@ -51,7 +51,8 @@ class RepeatDataset : public Dataset<T...> {
   RepeatDataset(const RepeatDataset&) = delete;
   RepeatDataset& operator=(const RepeatDataset&) = delete;
 
-  RCReference<Iterator<T...>> MakeIterator() override;
+  RCReference<Iterator<T...>> MakeIterator(
+      RCReference<IteratorContext> context) override;
 
  private:
   friend class RepeatDatasetIterator<T...>;
@@ -69,10 +70,13 @@ class RepeatDataset : public Dataset<T...> {
 template <typename... T>
 class RepeatDatasetIterator : public Iterator<T...> {
  public:
-  explicit RepeatDatasetIterator(RCReference<RepeatDataset<T...>> dataset)
+  explicit RepeatDatasetIterator(RCReference<RepeatDataset<T...>> dataset,
+                                 RCReference<IteratorContext> context)
       : Iterator<T...>(),
         parent_dataset_(std::move(dataset)),
-        input_iterator_(parent_dataset_->input_dataset_->MakeIterator()) {}
+        context_(std::move(context)),
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator(
+            context_.CopyRef())) {}
 
   // This class is not copyable or movable.
   RepeatDatasetIterator(const RepeatDatasetIterator&) = delete;
@@ -83,7 +87,8 @@ class RepeatDatasetIterator : public Iterator<T...> {
     auto value = input_iterator_->GetNext(exec_ctx);
     if (!value && epoch_ + 1 < parent_dataset_->epochs_) {
       epoch_++;
-      input_iterator_ = parent_dataset_->input_dataset_->MakeIterator();
+      input_iterator_ =
+          parent_dataset_->input_dataset_->MakeIterator(context_.CopyRef());
       return input_iterator_->GetNext(exec_ctx);
     }
 
@@ -97,6 +102,7 @@ class RepeatDatasetIterator : public Iterator<T...> {
   }
 
   RCReference<RepeatDataset<T...>> parent_dataset_;
+  RCReference<IteratorContext> context_;
   RCReference<Iterator<T...>> input_iterator_;
 
   // The current epoch number.
@@ -104,8 +110,10 @@ class RepeatDatasetIterator : public Iterator<T...> {
 };
 
 template <typename... T>
-RCReference<Iterator<T...>> RepeatDataset<T...>::MakeIterator() {
-  return TakeRef(host_->Construct<RepeatDatasetIterator<T...>>(FormRef(this)));
+RCReference<Iterator<T...>> RepeatDataset<T...>::MakeIterator(
+    RCReference<IteratorContext> context) {
+  return TakeRef(host_->Construct<RepeatDatasetIterator<T...>>(
+      FormRef(this), std::move(context)));
 }
 
 }  // namespace data
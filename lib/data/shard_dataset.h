@@ -0,0 +1,135 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- shard_dataset.h ------------------------------------------*- C++ -*-===//
+//
+// This file declares ShardDataset class which wraps around another Dataset
+// instance and yields the deterministic 1/num_shards subset of its elements
+// belonging to one shard.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_LIB_DATA_SHARD_DATASET_H_
+#define TFRT_LIB_DATA_SHARD_DATASET_H_
+
+#include "dataset.h"
+#include "tfrt/support/forward_decls.h"
+
+namespace tfrt {
+namespace data {
+
+template <typename... T>
+class ShardDatasetIterator;
+
+// ShardDataset yields every num_shards-th element of its input, starting at
+// shard_index, so num_shards workers iterating the same input with distinct
+// indices partition it deterministically with no overlap.
+//
+// For multi-worker input pipelines, shard the dataset of file paths before
+// any file-opening stage (e.g. before an interleave into TFRecordDataset):
+// the skipped elements are then just path strings, so files belonging to
+// other shards are never opened and each worker reads only its 1/num_shards
+// of the input bytes.
+template <typename... T>
+class ShardDataset : public Dataset<T...> {
+ public:
+  explicit ShardDataset(RCReference<Dataset<T...>> input_dataset,
+                        int64_t num_shards, int64_t shard_index,
+                        HostContext* host)
+      : input_dataset_(std::move(input_dataset)),
+        num_shards_(num_shards),
+        shard_index_(shard_index),
+        host_(host),
+        allocator_(host->allocator()) {
+    assert(num_shards > 0);
+    assert(shard_index >= 0 && shard_index < num_shards);
+  }
+
+  // This class is not copyable or movable.
+  ShardDataset(const ShardDataset&) = delete;
+  ShardDataset& operator=(const ShardDataset&) = delete;
+
+  RCReference<Iterator<T...>> MakeIterator(
+      RCReference<IteratorContext> context) override;
+
+ private:
+  // Allow iterator to rely on private data members of this dataset.
+  friend class ShardDatasetIterator<T...>;
+
+  void Destroy() override {
+    internal::DestroyImpl<ShardDataset<T...>>(this, allocator_);
+  }
+
+  RCReference<Dataset<T...>> input_dataset_;
+  int64_t num_shards_;
+  int64_t shard_index_;
+  HostContext* host_;
+  HostAllocator* allocator_;
+};
+
+template <typename... T>
+class ShardDatasetIterator : public Iterator<T...> {
+ public:
+  explicit ShardDatasetIterator(RCReference<ShardDataset<T...>> parent_dataset,
+                                RCReference<IteratorContext> context)
+      : Iterator<T...>(),
+        parent_dataset_(std::move(parent_dataset)),
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator(
+            std::move(context))) {}
+
+  // This class is not copyable or movable.
+  ShardDatasetIterator(const ShardDatasetIterator&) = delete;
+  ShardDatasetIterator& operator=(const ShardDatasetIterator&) = delete;
+
+  AsyncValueRef<std::tuple<T...>> GetNext(
+      const ExecutionContext& exec_ctx) override {
+    // Drop the elements belonging to other shards. The dropped AsyncValues
+    // are simply released; upstream stages that defer real work (such as
+    // file IO) to their consumers therefore never perform it for them.
+    int64_t num_to_skip = first_element_
+                              ? parent_dataset_->shard_index_
+                              : parent_dataset_->num_shards_ - 1;
+    first_element_ = false;
+    while (num_to_skip > 0) {
+      auto skipped = input_iterator_->GetNext(exec_ctx);
+      if (!skipped) return AsyncValueRef<std::tuple<T...>>();
+      --num_to_skip;
+    }
+    return input_iterator_->GetNext(exec_ctx);
+  }
+
+ private:
+  void Destroy() override {
+    internal::DestroyImpl<ShardDatasetIterator>(this,
+                                                parent_dataset_->allocator_);
+  }
+
+  RCReference<ShardDataset<T...>> parent_dataset_;
+  RCReference<Iterator<T...>> input_iterator_;
+  bool first_element_ = true;
+};
+
+template <typename... T>
+RCReference<Iterator<T...>> ShardDataset<T...>::MakeIterator(
+    RCReference<IteratorContext> context) {
+  return TakeRef(host_->Construct<ShardDatasetIterator<T...>>(
+      FormRef(this), std::move(context)));
+}
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_LIB_DATA_SHARD_DATASET_H_
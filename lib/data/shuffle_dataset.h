@@ -0,0 +1,224 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- shuffle_dataset.h ----------------------------------------*- C++ -*-===//
+//
+// This file declares ShuffleDataset class which wraps around another Dataset
+// instance and shuffles its elements through a fixed-size reservoir before
+// returning them via GetNext().
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TFRT_LIB_DATA_SHUFFLE_DATASET_H_
+#define TFRT_LIB_DATA_SHUFFLE_DATASET_H_
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dataset.h"
+#include "tfrt/support/forward_decls.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+namespace data {
+
+template <typename... T>
+class ShuffleDatasetIterator;
+
+// Estimate of the number of bytes one element occupies, used to translate the
+// reservoir's byte budget into an element capacity.
+template <typename T>
+size_t GetElementSizeInBytes(const T& element) {
+  return sizeof(T);
+}
+
+template <>
+inline size_t GetElementSizeInBytes(const std::string& element) {
+  return sizeof(std::string) + element.size();
+}
+
+template <>
+inline size_t GetElementSizeInBytes(const DenseHostTensor& element) {
+  return sizeof(DenseHostTensor) + element.DataSizeInBytes();
+}
+
+template <typename... T, size_t... I>
+size_t GetTupleSizeInBytes(const std::tuple<T...>& element,
+                           std::index_sequence<I...>) {
+  size_t size = 0;
+  std::ignore = std::initializer_list<int>{
+      (size += GetElementSizeInBytes(std::get<I>(element)), 0)...};
+  return size;
+}
+
+// ShuffleDataset wraps around another Dataset instance and shuffles its
+// elements within a bounded reservoir before returning them. The reservoir is
+// a contiguous vector of in-flight elements rather than a node-based queue,
+// so the replacement path touches one cache line of the slab per GetNext
+// instead of chasing pointers. Each GetNext returns a uniformly drawn element
+// of the reservoir and refills the vacated slot with the next input element,
+// so the reservoir stays full of in-flight values and refills overlap with
+// consumption.
+//
+// `buffer_size_bytes` bounds the reservoir by memory footprint rather than by
+// element count; the element capacity is derived from the size of the first
+// available element, so pipelines need not know their record size to pick a
+// sensible shuffle buffer. Two iterators created with the same `seed` over
+// the same input produce the same order.
+template <typename... T>
+class ShuffleDataset : public Dataset<T...> {
+ public:
+  explicit ShuffleDataset(RCReference<Dataset<T...>> input_dataset,
+                          int64_t buffer_size_bytes, int64_t seed,
+                          HostContext* host)
+      : input_dataset_(std::move(input_dataset)),
+        buffer_size_bytes_(buffer_size_bytes),
+        seed_(seed),
+        host_(host),
+        allocator_(host->allocator()) {
+    assert(buffer_size_bytes > 0);
+  }
+
+  // This class is not copyable or movable.
+  ShuffleDataset(const ShuffleDataset&) = delete;
+  ShuffleDataset& operator=(const ShuffleDataset&) = delete;
+
+  RCReference<Iterator<T...>> MakeIterator(
+      RCReference<IteratorContext> context) override;
+
+ private:
+  // Allow iterator to rely on private data members of this dataset.
+  friend class ShuffleDatasetIterator<T...>;
+
+  void Destroy() override {
+    internal::DestroyImpl<ShuffleDataset<T...>>(this, allocator_);
+  }
+
+  RCReference<Dataset<T...>> input_dataset_;
+  int64_t buffer_size_bytes_;
+  int64_t seed_;
+  HostContext* host_;
+  HostAllocator* allocator_;
+};
+
+template <typename... T>
+class ShuffleDatasetIterator : public Iterator<T...> {
+ public:
+  explicit ShuffleDatasetIterator(
+      RCReference<ShuffleDataset<T...>> parent_dataset,
+      RCReference<IteratorContext> context)
+      : Iterator<T...>(),
+        parent_dataset_(std::move(parent_dataset)),
+        input_iterator_(parent_dataset_->input_dataset_->MakeIterator(
+            std::move(context))),
+        rng_(parent_dataset_->seed_) {}
+
+  // This class is not copyable or movable.
+  ShuffleDatasetIterator(const ShuffleDatasetIterator&) = delete;
+  ShuffleDatasetIterator& operator=(const ShuffleDatasetIterator&) = delete;
+
+  AsyncValueRef<std::tuple<T...>> GetNext(
+      const ExecutionContext& exec_ctx) override {
+    FillBuffer(exec_ctx);
+    if (buffer_.empty()) {
+      return AsyncValueRef<std::tuple<T...>>();
+    }
+    UpdateCapacity();
+    // Draw a uniformly random slot and refill it with the next input element,
+    // or shrink the reservoir from the back once the input is exhausted.
+    std::uniform_int_distribution<size_t> dist(0, buffer_.size() - 1);
+    const size_t idx = dist(rng_);
+    auto result = std::move(buffer_[idx]);
+    // Refill the vacated slot, unless the reservoir shrank below its size
+    // after calibration, in which case popping brings it back to capacity.
+    if (!end_of_input_ && buffer_.size() <= capacity_) {
+      auto value = input_iterator_->GetNext(exec_ctx);
+      if (value) {
+        buffer_[idx] = std::move(value);
+        return result;
+      }
+      end_of_input_ = true;
+    }
+    buffer_[idx] = std::move(buffer_.back());
+    buffer_.pop_back();
+    return result;
+  }
+
+ private:
+  void Destroy() override {
+    internal::DestroyImpl<ShuffleDatasetIterator>(this,
+                                                  parent_dataset_->allocator_);
+  }
+
+  // Top up the reservoir to its current capacity. The buffered values are
+  // in-flight AsyncValues, so pulling them here overlaps upstream production
+  // with consumption of previously drawn elements.
+  void FillBuffer(const ExecutionContext& exec_ctx) {
+    while (!end_of_input_ && buffer_.size() < capacity_) {
+      auto value = input_iterator_->GetNext(exec_ctx);
+      if (!value) {
+        end_of_input_ = true;
+        return;
+      }
+      buffer_.push_back(std::move(value));
+    }
+  }
+
+  // Derive the element capacity from the byte budget once the size of an
+  // element can be observed. Until then the reservoir runs at the initial
+  // capacity, so a pipeline with slow-to-arrive first elements does not
+  // overcommit memory.
+  void UpdateCapacity() {
+    if (capacity_calibrated_) return;
+    for (auto& value : buffer_) {
+      if (!value.IsConcrete()) continue;
+      const size_t element_size = std::max<size_t>(
+          1, GetTupleSizeInBytes(value.get(),
+                                 std::make_index_sequence<sizeof...(T)>{}));
+      capacity_ = std::max<size_t>(
+          1, parent_dataset_->buffer_size_bytes_ / element_size);
+      capacity_calibrated_ = true;
+      return;
+    }
+  }
+
+  // Reservoir size used before the first element's size is known.
+  static constexpr size_t kInitialCapacity = 16;
+
+  RCReference<ShuffleDataset<T...>> parent_dataset_;
+  RCReference<Iterator<T...>> input_iterator_;
+
+  // The reservoir. Elements live contiguously and are replaced in place.
+  std::vector<AsyncValueRef<std::tuple<T...>>> buffer_;
+  size_t capacity_ = kInitialCapacity;
+  bool capacity_calibrated_ = false;
+  bool end_of_input_ = false;
+  std::mt19937_64 rng_;
+};
+
+template <typename... T>
+RCReference<Iterator<T...>> ShuffleDataset<T...>::MakeIterator(
+    RCReference<IteratorContext> context) {
+  return TakeRef(host_->Construct<ShuffleDatasetIterator<T...>>(
+      FormRef(this), std::move(context)));
+}
+
+}  // namespace data
+}  // namespace tfrt
+
+#endif  // TFRT_LIB_DATA_SHUFFLE_DATASET_H_
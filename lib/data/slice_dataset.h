@@ -46,7 +46,8 @@ class SliceDataset : public Dataset<T> {
   SliceDataset(const SliceDataset&) = delete;
   SliceDataset& operator=(const SliceDataset&) = delete;
 
-  RCReference<Iterator<T>> MakeIterator() override;
+  RCReference<Iterator<T>> MakeIterator(
+      RCReference<IteratorContext> context) override;
 
  private:
   friend class SliceDatasetIterator<T>;
@@ -117,7 +118,8 @@ SliceDatasetIterator<DenseHostTensor>::GetNext(
 }
 
 template <typename T>
-RCReference<Iterator<T>> SliceDataset<T>::MakeIterator() {
+RCReference<Iterator<T>> SliceDataset<T>::MakeIterator(
+    RCReference<IteratorContext> context) {
   return TakeRef(host_->Construct<SliceDatasetIterator<T>>(
       FormRef(this), data_.begin(), data_.end()));
 }
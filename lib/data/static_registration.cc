@@ -32,7 +32,7 @@ static void RegisterKernels(KernelRegistry* registry) {
   RegisterDataKernels(registry);
 }
 
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterKernels);
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(RegisterKernels, "data");
 
 }  // namespace data
 }  // namespace tfrt
@@ -21,6 +21,7 @@
 
 #include "tf_record_dataset.h"
 
+#include "tfrt/support/crc32c.h"
 #include "tfrt/support/error_util.h"
 
 namespace tfrt {
@@ -64,7 +65,8 @@ inline uint64_t DecodeFixed64(const char* ptr) {
 // Implementation for TFRecordDataset member functions
 //===----------------------------------------------------------------------===//
 
-RCReference<Iterator<std::string>> TFRecordDataset::MakeIterator() {
+RCReference<Iterator<std::string>> TFRecordDataset::MakeIterator(
+    RCReference<IteratorContext> context) {
   return TakeRef(host_->Construct<TFRecordDatasetIterator>(FormRef(this)));
 }
 
@@ -83,6 +85,26 @@ AsyncValueRef<std::tuple<std::string>> TFRecordDatasetIterator::GetNextElement(
       std::move(*result));
 }
 
+void TFRecordDatasetIterator::GetNextElements(
+    const ExecutionContext& exec_ctx, int32_t count,
+    SmallVectorImpl<AsyncValueRef<std::tuple<std::string>>>* out) {
+  for (int32_t i = 0; i < count; ++i) {
+    bool eof = false;
+    auto result = ReadRecord(&eof);
+    if (eof) {
+      out->push_back(AsyncValueRef<std::tuple<std::string>>());
+      return;
+    }
+    if (!result) {
+      out->push_back(EmitErrorAsync(exec_ctx, result.takeError()));
+      return;
+    }
+    out->push_back(
+        exec_ctx.host()->MakeAvailableAsyncValueRef<std::tuple<std::string>>(
+            std::move(*result)));
+  }
+}
+
 // Logic based on tensorflow/core/io/record_reader.*
 // Note: RecordReader maintains the offset. For now, we're relying on
 // ifstream reading sequentially.
@@ -96,23 +118,25 @@ llvm::Expected<std::string> TFRecordDatasetIterator::ReadChecksummed(
   result.resize(to_read);
 
   char* buffer = &result[0];
-  stream_.read(buffer, to_read);
-
-  if (stream_.eof()) {
-    if (stream_.gcount() == 0) {
-      // The previous record read was the final one. We're trying to read past
-      // the end of the file, but there's nothing left.
-      *eof = true;
-      return MakeStringError("end of file");
-    }
-    // Unable to read the full to_read number of bytes; this is
-    // a partial record.
+  const size_t bytes_read = stream_->Read(buffer, to_read);
+
+  if (bytes_read == 0 && stream_->eof()) {
+    // The previous record read was the final one. We're trying to read past
+    // the end of the file, but there's nothing left.
+    *eof = true;
+    return MakeStringError("end of file");
   }
-  if (stream_.fail()) {
+  if (bytes_read < to_read) {
+    // Either a read error or a partial record at the end of the file.
     return MakeStringError("failed to read data from stream");
   }
 
-  // TODO(rachelim): Check the checksum.
+  if (verify_checksums_) {
+    const uint32_t masked_crc = DecodeFixed32(buffer + n);
+    if (crc32c::Unmask(masked_crc) != crc32c::Value(buffer, n)) {
+      return MakeStringError("corrupted record in ", parent_dataset_->path_);
+    }
+  }
 
   result.resize(n);
   return result;
@@ -121,12 +145,12 @@ llvm::Expected<std::string> TFRecordDatasetIterator::ReadChecksummed(
 // TODO(rachelim): Instead of having a bool* eof, consider subclassing
 // ErrorInfo and returning a special error type for eof.
 llvm::Expected<std::string> TFRecordDatasetIterator::ReadRecord(bool* eof) {
-  if (stream_.eof() && stream_.gcount() == 0) {
+  if (stream_->eof()) {
     *eof = true;
     return MakeStringError("end of file");
   }
 
-  if (stream_.fail()) {
+  if (stream_->fail()) {
     return MakeStringError("failed to read file: ", parent_dataset_->path_);
   }
 
@@ -149,6 +173,12 @@ llvm::Expected<std::string> TFRecordDatasetIterator::ReadRecord(bool* eof) {
     *eof = false;
     return MakeStringError("failed to read body of TFRecord");
   }
+  // One record passed verification; in kVerifyFirstRecord mode that is all
+  // the evidence we want, so skip checksumming from here on.
+  if (body && parent_dataset_->checksum_mode_ ==
+                  TFRecordDataset::ChecksumMode::kVerifyFirstRecord) {
+    verify_checksums_ = false;
+  }
   return body;
 }
 
@@ -24,10 +24,12 @@
 #ifndef TFRT_LIB_DATA_TF_RECORD_DATASET_H_
 #define TFRT_LIB_DATA_TF_RECORD_DATASET_H_
 
-#include <fstream>
+#include <memory>
 
 #include "dataset.h"
 #include "io.h"
+#include "llvm/ADT/StringRef.h"
+#include "remote_io.h"
 #include "tfrt/support/forward_decls.h"
 
 namespace tfrt {
@@ -41,14 +43,34 @@ namespace data {
 // from the file onto the heap.
 class TFRecordDataset : public Dataset<std::string> {
  public:
-  explicit TFRecordDataset(std::string path, HostContext* host)
-      : path_(std::move(path)), host_(host), allocator_(host->allocator()) {}
+  // Controls how much of the per-record CRC32C framing is verified.
+  // kVerifyFirstRecord is meant for files produced by our own writers:
+  // the first record is verified, which catches pointing at the wrong or
+  // truncated file, and checksumming is skipped from then on.
+  enum class ChecksumMode { kVerifyAll, kVerifyFirstRecord };
+
+  // Compression of the file's bytes. kGzip parses records out of a
+  // pipelined inflate stage (see io::GzipInflateStream), so archived gzip
+  // TFRecord files can be read directly instead of being pre-inflated to
+  // disk.
+  enum class Compression { kNone, kGzip };
+
+  explicit TFRecordDataset(
+      std::string path, HostContext* host,
+      ChecksumMode checksum_mode = ChecksumMode::kVerifyAll,
+      Compression compression = Compression::kNone)
+      : path_(std::move(path)),
+        checksum_mode_(checksum_mode),
+        compression_(compression),
+        host_(host),
+        allocator_(host->allocator()) {}
 
   // This class is not copyable or movable.
   TFRecordDataset(const TFRecordDataset&) = delete;
   TFRecordDataset& operator=(const TFRecordDataset&) = delete;
 
-  RCReference<Iterator<std::string>> MakeIterator() override;
+  RCReference<Iterator<std::string>> MakeIterator(
+      RCReference<IteratorContext> context) override;
 
  private:
   friend class TFRecordDatasetIterator;
@@ -58,6 +80,8 @@ class TFRecordDataset : public Dataset<std::string> {
   }
 
   const std::string path_;
+  const ChecksumMode checksum_mode_;
+  const Compression compression_;
   HostContext* host_;
   HostAllocator* allocator_;
 };
@@ -67,7 +91,7 @@ class TFRecordDatasetIterator : public io::PrefetchingIterator<std::string> {
   explicit TFRecordDatasetIterator(RCReference<TFRecordDataset> parent_dataset)
       : io::PrefetchingIterator<std::string>(256, 64),
         parent_dataset_(std::move(parent_dataset)),
-        stream_(parent_dataset_->path_.c_str(), std::ios_base::binary) {}
+        stream_(MakeStream()) {}
 
   // This class is not copyable or movable.
   TFRecordDatasetIterator(const TFRecordDatasetIterator&) = delete;
@@ -80,6 +104,13 @@ class TFRecordDatasetIterator : public io::PrefetchingIterator<std::string> {
   AsyncValueRef<std::tuple<std::string>> GetNextElement(
       const ExecutionContext& exec_ctx) final;
 
+  // Batched variant: parses up to `count` records back to back out of the
+  // stream's resident block, so a prefetch quota is served by one pass over
+  // already-buffered bytes rather than `count` separate element calls.
+  void GetNextElements(
+      const ExecutionContext& exec_ctx, int32_t count,
+      SmallVectorImpl<AsyncValueRef<std::tuple<std::string>>>* out) final;
+
  private:
   void Destroy() override {
     internal::DestroyImpl<TFRecordDatasetIterator>(this,
@@ -102,8 +133,29 @@ class TFRecordDatasetIterator : public io::PrefetchingIterator<std::string> {
   // return value.
   llvm::Expected<std::string> ReadRecord(bool* eof);
 
+  // Builds the input stage: double-buffered block reads, with a pipelined
+  // inflate stage on top for compressed files. An "http://" path reads the
+  // records straight off a remote object store through concurrent range
+  // requests instead of a local file.
+  std::unique_ptr<io::InputStream> MakeStream() {
+    if (parent_dataset_->compression_ == TFRecordDataset::Compression::kGzip) {
+      return std::make_unique<io::GzipInflateStream>(parent_dataset_->path_,
+                                                     parent_dataset_->host_);
+    }
+    if (llvm::StringRef(parent_dataset_->path_).startswith("http://")) {
+      return std::make_unique<io::HttpRangeStream>(parent_dataset_->path_,
+                                                   parent_dataset_->host_);
+    }
+    return std::make_unique<io::BufferedFileStream>(parent_dataset_->path_,
+                                                    parent_dataset_->host_);
+  }
+
   RCReference<TFRecordDataset> parent_dataset_;
-  std::ifstream stream_;
+  // Double-buffered block reads (and, for compressed files, block decodes)
+  // keep record parsing running against an already-resident buffer.
+  std::unique_ptr<io::InputStream> stream_;
+  // Cleared after the first record in kVerifyFirstRecord mode.
+  bool verify_checksums_ = true;
 };
 
 }  // namespace data
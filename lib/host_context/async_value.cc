@@ -76,12 +76,27 @@ void AsyncValue::Destroy() {
     // explicit check and instead make ~IndirectAsyncValue go through the
     // GetTypeInfo().destructor case below.
     static_cast<IndirectAsyncValue*>(this)->~IndirectAsyncValue();
-    GetHostContext()->DeallocateBytes(this, sizeof(IndirectAsyncValue));
+    GetHostContext()->DeallocateAsyncValueBytes(this,
+                                                sizeof(IndirectAsyncValue));
+    return;
+  }
+
+  // Fast path: the payload needs no destructor and the value came from the
+  // slab allocator, so tearing it down is just poisoning the header and
+  // pushing the block back on the thread-local freelist. This avoids the
+  // indirect TypeInfo destructor dispatch for the types the executor churns
+  // through in bulk (Chain, scalars, etc.). Error state still owns a
+  // heap-allocated DecodedDiagnostic and must run the full destructor below.
+  if (trivial_destroy_ && state() != State::kError) {
+    this->~AsyncValue();
+    // All slab blocks have the same size, so kSlabBlockSize returns the block
+    // without needing the exact sizeof of the derived class.
+    GetHostContext()->DeallocateAsyncValueBytes(this, kSlabBlockSize);
     return;
   }
 
   auto size = GetTypeInfo().destructor(this);
-  GetHostContext()->DeallocateBytes(this, size);
+  GetHostContext()->DeallocateAsyncValueBytes(this, size);
 }
 
 // This is called when the value is set into the ConcreteAsyncValue buffer, or
@@ -102,6 +117,11 @@ void AsyncValue::NotifyAvailable(State available_state) {
   assert(old_value.getInt() == State::kUnconstructed ||
          old_value.getInt() == State::kConstructed);
 
+  // Timestamp availability before running waiters, so the profiled
+  // created-to-available gap does not include the waiters themselves.
+  if (IsAsyncValueProfilingEnabled())
+    internal::ProfileAsyncValueAvailable(this);
+
   RunWaiters(old_value.getPointer());
 }
 
@@ -113,7 +133,8 @@ void AsyncValue::RunWaiters(NotifierListNode* list) {
     // check atomic state again.
     node->notification_();
     list = node->next_;
-    host->Destruct(node);
+    node->~NotifierListNode();
+    host->DeallocateAsyncValueBytes(node, sizeof(NotifierListNode));
   }
 }
 
@@ -122,8 +143,13 @@ void AsyncValue::RunWaiters(NotifierListNode* list) {
 // called when the value becomes available.
 void AsyncValue::EnqueueWaiter(llvm::unique_function<void()>&& waiter,
                                WaitersAndState old_value) {
-  // Create the node for our waiter.
-  auto* node = GetHostContext()->Construct<NotifierListNode>(std::move(waiter));
+  // Create the node for our waiter. Nodes come from the same per-thread slab
+  // freelists as AsyncValues themselves: most values have only one or two
+  // waiters (the next kernels in the dataflow graph), so this avoids a
+  // malloc/free pair per graph edge.
+  auto* node = new (GetHostContext()->AllocateAsyncValueBytes(
+      sizeof(NotifierListNode), alignof(NotifierListNode)))
+      NotifierListNode(std::move(waiter));
   auto old_state = old_value.getInt();
 
   // Swap the next link in. old_value.getInt() must be unavailable when
@@ -0,0 +1,89 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- async_value_combinators.cc - AsyncValueRef combinators -------------===//
+//
+// This file implements the WhenAll combinator.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/async_value_combinators.h"
+
+#include <atomic>
+
+#include "tfrt/host_context/chain.h"
+
+namespace tfrt {
+
+namespace {
+
+// Completion frame shared by all waiters of one WhenAll call. It is allocated
+// from the per-thread AsyncValue slab, so the slow path of WhenAll does not
+// touch the heap either.
+struct WhenAllFrame {
+  WhenAllFrame(size_t count, RCArray<AsyncValue> values,
+               AsyncValueRef<Chain> chain)
+      : count(count), values(std::move(values)), chain(std::move(chain)) {}
+
+  std::atomic<size_t> count;
+  RCArray<AsyncValue> values;
+  AsyncValueRef<Chain> chain;
+};
+
+}  // namespace
+
+AsyncValueRef<Chain> WhenAll(HostContext* host,
+                             ArrayRef<RCReference<AsyncValue>> values) {
+  // Perform a quick scan of the inputs. Values that are already resolved do
+  // not need a waiter, and if everything is resolved we can complete without
+  // allocating anything.
+  SmallVector<AsyncValue*, 4> unavailable_values;
+  for (auto& value : values) {
+    if (value->IsError()) return AsyncValueRef<Chain>(value.CopyRef());
+    if (!value->IsAvailable()) unavailable_values.push_back(value.get());
+  }
+
+  if (unavailable_values.empty()) return host->GetReadyChain();
+
+  auto chain = host->MakeConstructedAsyncValueRef<Chain>();
+  auto* frame = new (host->AllocateAsyncValueBytes(sizeof(WhenAllFrame),
+                                                   alignof(WhenAllFrame)))
+      WhenAllFrame(unavailable_values.size(),
+                   RCArray<AsyncValue>(unavailable_values), chain.CopyRef());
+
+  for (auto* value : unavailable_values) {
+    value->AndThen([frame, host]() {
+      // Decrement the counter unless we are the last waiter to fire.
+      if (frame->count.fetch_sub(1) != 1) return;
+
+      // Complete the chain with the first error among the inputs, if any.
+      const DecodedDiagnostic* error = nullptr;
+      for (auto* value : frame->values.values()) {
+        if ((error = value->GetErrorIfPresent())) break;
+      }
+      if (error) {
+        frame->chain.SetError(*error);
+      } else {
+        frame->chain.SetStateConcrete();
+      }
+
+      frame->~WhenAllFrame();
+      host->DeallocateAsyncValueBytes(frame, sizeof(WhenAllFrame));
+    });
+  }
+
+  return chain;
+}
+
+}  // namespace tfrt
@@ -0,0 +1,172 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- async_value_profiler.cc - AsyncValue lifetime profiler -------------===//
+//
+// This file implements the opt-in AsyncValue lifetime profiler. Live values
+// are tracked in a set of sharded hash maps keyed by the value's address, so
+// concurrently created values on different threads mostly hit different
+// locks. Completed lifetimes go into a bounded min-heap ordered by stall, so
+// an arbitrarily long profiled run keeps only the worst offenders.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/async_value_profiler.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "llvm/ADT/DenseMap.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+
+namespace internal {
+std::atomic<bool> kAsyncValueProfilingEnabled{false};
+}  // namespace internal
+
+namespace {
+
+// Number of live-value map shards. Shards are picked by hashing the value's
+// address, so this bounds lock contention between threads creating values
+// concurrently rather than matching any thread count.
+constexpr int kNumShards = 16;
+
+// Maximum number of completed lifetimes retained between drains. When the
+// bound overflows, the record with the smallest stall is evicted.
+constexpr size_t kMaxCompletedRecords = 1024;
+
+uint64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// The kernel the calling thread is currently executing on behalf of, for
+// attributing created values. Set by the executor around kernel dispatch.
+thread_local const char* current_kernel_name = nullptr;
+
+// Tracking state of a value that has been created but not yet destroyed.
+struct LiveValue {
+  const char* kernel_name;
+  uint64_t created_ns;
+  uint64_t available_ns;  // Zero until the value becomes available.
+};
+
+struct alignas(64) LiveShard {
+  mutex mu;
+  llvm::DenseMap<const AsyncValue*, LiveValue> values TFRT_GUARDED_BY(mu);
+};
+
+LiveShard* GetLiveShard(const AsyncValue* value) {
+  static LiveShard* shards = new LiveShard[kNumShards];
+  // Drop the low bits: values from the slab allocator share alignment.
+  auto hash = reinterpret_cast<uintptr_t>(value) >> 7;
+  return &shards[hash % kNumShards];
+}
+
+bool StallGreater(const AsyncValueLifetime& a, const AsyncValueLifetime& b) {
+  return a.StallNs() > b.StallNs();
+}
+
+// Bounded collection of completed lifetimes, kept as a min-heap on StallNs so
+// eviction at the bound is O(log n).
+class CompletedRecords {
+ public:
+  static CompletedRecords& Get() {
+    static CompletedRecords* records = new CompletedRecords();
+    return *records;
+  }
+
+  void Add(const AsyncValueLifetime& lifetime) {
+    mutex_lock lock(mu_);
+    if (heap_.size() == kMaxCompletedRecords) {
+      if (!StallGreater(lifetime, heap_.front())) return;
+      std::pop_heap(heap_.begin(), heap_.end(), StallGreater);
+      heap_.pop_back();
+    }
+    heap_.push_back(lifetime);
+    std::push_heap(heap_.begin(), heap_.end(), StallGreater);
+  }
+
+  std::vector<AsyncValueLifetime> Take(int n) {
+    std::vector<AsyncValueLifetime> records;
+    {
+      mutex_lock lock(mu_);
+      records.swap(heap_);
+    }
+    std::sort(records.begin(), records.end(), StallGreater);
+    if (n >= 0 && records.size() > static_cast<size_t>(n))
+      records.resize(static_cast<size_t>(n));
+    return records;
+  }
+
+ private:
+  mutable mutex mu_;
+  std::vector<AsyncValueLifetime> heap_ TFRT_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+namespace internal {
+
+void ProfileAsyncValueCreated(const AsyncValue* value) {
+  LiveShard* shard = GetLiveShard(value);
+  LiveValue live{current_kernel_name, NowNs(), 0};
+  mutex_lock lock(shard->mu);
+  shard->values[value] = live;
+}
+
+void ProfileAsyncValueAvailable(const AsyncValue* value) {
+  uint64_t now = NowNs();
+  LiveShard* shard = GetLiveShard(value);
+  mutex_lock lock(shard->mu);
+  auto it = shard->values.find(value);
+  // The value may predate enabling the profiler; ignore it in that case.
+  if (it != shard->values.end()) it->second.available_ns = now;
+}
+
+void ProfileAsyncValueDestroyed(const AsyncValue* value) {
+  uint64_t now = NowNs();
+  LiveValue live;
+  {
+    LiveShard* shard = GetLiveShard(value);
+    mutex_lock lock(shard->mu);
+    auto it = shard->values.find(value);
+    if (it == shard->values.end()) return;
+    live = it->second;
+    shard->values.erase(it);
+  }
+  CompletedRecords::Get().Add(
+      AsyncValueLifetime{live.kernel_name, live.created_ns, live.available_ns,
+                         now});
+}
+
+}  // namespace internal
+
+void SetAsyncValueProfilingEnabled(bool enabled) {
+  internal::kAsyncValueProfilingEnabled.store(enabled,
+                                              std::memory_order_relaxed);
+}
+
+void SetCurrentKernelForAsyncValueProfiling(const char* kernel_name) {
+  current_kernel_name = kernel_name;
+}
+
+std::vector<AsyncValueLifetime> TakeTopAsyncValueStalls(int n) {
+  return CompletedRecords::Get().Take(n);
+}
+
+}  // namespace tfrt
@@ -42,6 +42,12 @@ WorkQueueFactoryMap* GetWorkQueueFactories() {
 
 ConcurrentWorkQueue::~ConcurrentWorkQueue() = default;
 
+// Implementations that can publish a batch of tasks with a single
+// synchronization episode should override this method.
+void ConcurrentWorkQueue::AddTasks(MutableArrayRef<TaskFunction> tasks) {
+  for (TaskFunction& task : tasks) AddTask(std::move(task));
+}
+
 void RegisterWorkQueueFactory(string_view name, WorkQueueFactory factory) {
   auto p = GetWorkQueueFactories()->try_emplace(name, std::move(factory));
   (void)p;
@@ -42,10 +42,17 @@ raw_ostream& operator<<(raw_ostream& os, const DecodedDiagnostic& diag) {
 
 DecodedDiagnostic EmitError(const ExecutionContext& exec_ctx,
                             string_view message) {
+  auto* host = exec_ctx.host();
+
+  // Decoding a location walks the BEF location section and builds filename
+  // strings, which is wasted work when no diagnostic handler is installed to
+  // observe it. In that case return the bare message; a location can still be
+  // attached later via AsyncValue::SetErrorLocationIfUnset if someone ends up
+  // caring about it.
+  if (!host->HasDiagHandler()) return DecodedDiagnostic(message);
+
   auto decoded_loc = exec_ctx.location().Decode();
   auto diag = DecodedDiagnostic(decoded_loc, message);
-
-  auto* host = exec_ctx.host();
   host->EmitError(diag);
 
   return diag;
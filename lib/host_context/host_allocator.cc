@@ -20,33 +20,275 @@
 
 #include "tfrt/host_context/host_allocator.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#endif
 
 #include "llvm/Support/MathExtras.h"
 #include "tfrt/support/alloc.h"
 
 namespace tfrt {
 
+namespace {
+
+// Allocations at least this large get their own anonymous mapping backed by
+// huge pages (policy permitting). Weight tensors are typically far above
+// this, while activation-sized allocations stay on the malloc path.
+constexpr size_t kHugePageThreshold = 16 << 20;
+
+// x86-64 and aarch64 transparent huge pages are 2MB.
+constexpr size_t kHugePageSize = 2 << 20;
+
+#if defined(__linux__)
+
+// CPU index to NUMA node table, built once from the sysfs node topology.
+// CPUs the topology does not mention map to -1.
+const std::vector<int>& CpuToNodeTable() {
+  static const std::vector<int>* table = [] {
+    auto* cpu_to_node = new std::vector<int>();
+    for (int node = 0;; ++node) {
+      std::ifstream cpu_list("/sys/devices/system/node/node" +
+                             std::to_string(node) + "/cpulist");
+      if (!cpu_list.good()) break;
+      // The cpulist file is a comma separated list of CPU ranges, e.g.
+      // "0-15,32-47".
+      std::string range;
+      while (std::getline(cpu_list, range, ',')) {
+        int lo, hi;
+        switch (sscanf(range.c_str(), "%d-%d", &lo, &hi)) {
+          case 1:
+            hi = lo;
+            break;
+          case 2:
+            break;
+          default:
+            continue;
+        }
+        if (static_cast<size_t>(hi) >= cpu_to_node->size())
+          cpu_to_node->resize(hi + 1, -1);
+        for (int cpu = lo; cpu <= hi; ++cpu) (*cpu_to_node)[cpu] = node;
+      }
+    }
+    return cpu_to_node;
+  }();
+  return *table;
+}
+
+// Tells the kernel to prefer NUMA node `numa_node` when faulting in pages of
+// [ptr, ptr+length). Issued as a raw syscall (with the MPOL_PREFERRED value
+// from linux/mempolicy.h spelled out) to avoid a libnuma dependency.
+void PreferNumaNode(void* ptr, size_t length, int numa_node) {
+#if defined(SYS_mbind)
+  if (numa_node < 0 || numa_node >= 64) return;
+  constexpr int kMpolPreferred = 1;
+  unsigned long nodemask = 1ul << numa_node;
+  syscall(SYS_mbind, ptr, length, kMpolPreferred, &nodemask,
+          sizeof(nodemask) * 8, /*flags=*/0);
+#endif
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
+
+int GetCurrentNumaNode() {
+#if defined(__linux__)
+  const std::vector<int>& cpu_to_node = CpuToNodeTable();
+  int cpu = sched_getcpu();
+  if (cpu >= 0 && static_cast<size_t>(cpu) < cpu_to_node.size())
+    return cpu_to_node[cpu];
+#endif
+  return HostAllocator::kAnyNumaNode;
+}
+
+int GetNumNumaNodes() {
+#if defined(__linux__)
+  int num_nodes = 0;
+  for (int node : CpuToNodeTable()) num_nodes = std::max(num_nodes, node + 1);
+  if (num_nodes > 0) return num_nodes;
+#endif
+  return 1;
+}
+
 class MallocAllocator : public HostAllocator {
+ public:
+  explicit MallocAllocator(HugePagePolicy huge_page_policy)
+      : huge_page_policy_(huge_page_policy) {}
+
   // Allocate the specified number of bytes with the specified alignment.
   void* AllocateBytes(size_t size, size_t alignment) override {
-    if (alignment <= 8) return malloc(size);
+    void* ptr;
+    if (UsesHugePages(size)) {
+      ptr = AllocateHugePages(size, alignment);
+    } else if (alignment <= 8) {
+      ptr = malloc(size);
+    } else {
+      // aligned_alloc requires the size to be a multiple of the alignment.
+      ptr = AlignedAlloc(alignment, llvm::alignTo(size, alignment, /*skew=*/0));
+    }
+    if (ptr) TrackAllocation(size);
+    return ptr;
+  }
 
-    // aligned_alloc requires the size to be a multiple of the alignment.
-    size = llvm::alignTo(size, alignment, /*skew=*/0);
-    return AlignedAlloc(alignment, size);
+  // Allocate with a NUMA node preference. Only the mapped large-allocation
+  // path can bind placement explicitly; small hinted allocations fall
+  // through to the regular path and get their locality from first touch by
+  // the (node-pinned) calling thread.
+  void* AllocateBytes(size_t size, size_t alignment, int numa_node) override {
+#if defined(__linux__)
+    if (numa_node != kAnyNumaNode && UsesHugePages(size)) {
+      void* ptr = AllocateHugePages(size, alignment);
+      if (ptr) {
+        PreferNumaNode(ptr, llvm::alignTo(size, kHugePageSize), numa_node);
+        TrackAllocation(size);
+      }
+      return ptr;
+    }
+#endif
+    return AllocateBytes(size, alignment);
   }
 
   // Deallocate the specified pointer that has the specified size.
-  void DeallocateBytes(void* ptr, size_t size) override { free(ptr); }
+  void DeallocateBytes(void* ptr, size_t size) override {
+    TrackDeallocation(size);
+#if defined(__linux__)
+    if (UsesHugePages(size)) {
+      munmap(ptr, llvm::alignTo(size, kHugePageSize));
+      return;
+    }
+#endif
+    free(ptr);
+  }
+
+ private:
+  // Whether an allocation of `size` takes the huge page path. This must be a
+  // function of the size alone so that DeallocateBytes makes the same
+  // decision as AllocateBytes.
+  bool UsesHugePages(size_t size) const {
+#if defined(__linux__)
+    return huge_page_policy_ != HugePagePolicy::kNone &&
+           size >= kHugePageThreshold;
+#else
+    return false;
+#endif
+  }
+
+#if defined(__linux__)
+  void* AllocateHugePages(size_t size, size_t alignment) {
+    const size_t length = llvm::alignTo(size, kHugePageSize);
+    // Aligning the region to a huge page boundary is what actually lets the
+    // kernel back it with huge pages, so over-map by one boundary and trim.
+    const size_t align_goal = std::max(alignment, kHugePageSize);
+    const size_t map_length = length + align_goal;
+
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_HUGETLB)
+    if (huge_page_policy_ == HugePagePolicy::kHugeTLB) flags |= MAP_HUGETLB;
+#endif
+    void* base =
+        mmap(nullptr, map_length, PROT_READ | PROT_WRITE, flags, -1, 0);
+#if defined(MAP_HUGETLB)
+    if (base == MAP_FAILED && (flags & MAP_HUGETLB)) {
+      // No hugetlb pool reserved: fall back to a transparent mapping.
+      flags &= ~MAP_HUGETLB;
+      base = mmap(nullptr, map_length, PROT_READ | PROT_WRITE, flags, -1, 0);
+    }
+#endif
+    if (base == MAP_FAILED) return nullptr;
+
+    uintptr_t aligned = llvm::alignTo(reinterpret_cast<uintptr_t>(base),
+                                      align_goal, /*skew=*/0);
+    uintptr_t map_end = reinterpret_cast<uintptr_t>(base) + map_length;
+    if (aligned != reinterpret_cast<uintptr_t>(base))
+      munmap(base, aligned - reinterpret_cast<uintptr_t>(base));
+    if (aligned + length != map_end)
+      munmap(reinterpret_cast<void*>(aligned + length),
+             map_end - (aligned + length));
+
+#if defined(MADV_HUGEPAGE)
+    // Advisory: the kernel promotes the region to huge pages when it can.
+    madvise(reinterpret_cast<void*>(aligned), length, MADV_HUGEPAGE);
+#endif
+    return reinterpret_cast<void*>(aligned);
+  }
+#else
+  void* AllocateHugePages(size_t size, size_t alignment) { return nullptr; }
+#endif
+
+  const HugePagePolicy huge_page_policy_;
 };
 
 void HostAllocator::VtableAnchor() {}
 
-std::unique_ptr<HostAllocator> CreateMallocAllocator() {
-  return std::make_unique<MallocAllocator>();
+int HostAllocator::RegisterWatermark(size_t low_bytes, size_t high_bytes,
+                                     llvm::unique_function<void()> on_high,
+                                     llvm::unique_function<void()> on_low) {
+  assert(low_bytes <= high_bytes);
+  mutex_lock lock(watermarks_mu_);
+  int id = next_watermark_id_++;
+  watermarks_.push_back(Watermark{id, low_bytes, high_bytes, /*above=*/false,
+                                  std::move(on_high), std::move(on_low)});
+  RearmLocked();
+  return id;
+}
+
+void HostAllocator::UnregisterWatermark(int id) {
+  mutex_lock lock(watermarks_mu_);
+  for (size_t i = 0, e = watermarks_.size(); i != e; ++i) {
+    if (watermarks_[i].id == id) {
+      watermarks_.erase(watermarks_.begin() + i);
+      break;
+    }
+  }
+  RearmLocked();
+}
+
+void HostAllocator::CheckWatermarksSlow(size_t bytes) {
+  mutex_lock lock(watermarks_mu_);
+  for (Watermark& watermark : watermarks_) {
+    if (!watermark.above && bytes >= watermark.high_bytes) {
+      watermark.above = true;
+      if (watermark.on_high) watermark.on_high();
+    } else if (watermark.above && bytes <= watermark.low_bytes) {
+      watermark.above = false;
+      if (watermark.on_low) watermark.on_low();
+    }
+  }
+  RearmLocked();
+}
+
+void HostAllocator::RearmLocked() {
+  size_t high = std::numeric_limits<size_t>::max();
+  size_t low = 0;
+  for (const Watermark& watermark : watermarks_) {
+    if (!watermark.above) {
+      high = std::min(high, watermark.high_bytes);
+    } else {
+      low = std::max(low, watermark.low_bytes);
+    }
+  }
+  armed_high_.store(high, std::memory_order_relaxed);
+  armed_low_.store(low, std::memory_order_relaxed);
+}
+
+std::unique_ptr<HostAllocator> CreateMallocAllocator(
+    HugePagePolicy huge_page_policy) {
+  return std::make_unique<MallocAllocator>(huge_page_policy);
 }
 
 }  // namespace tfrt
@@ -20,29 +20,176 @@
 
 #include "tfrt/host_context/host_buffer.h"
 
+#include <algorithm>
 #include <cstdint>
 
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "tfrt/host_context/host_allocator.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
 
 namespace tfrt {
+namespace {
+
+// Pool of memory blocks recycled from destroyed inlined HostBuffers. Serving
+// workloads allocate the same steady-state set of tensor sizes over and over,
+// so on final deref the block goes to a bounded per-size freelist instead of
+// back to the allocator, and the next CreateUninitialized of that size reuses
+// it. Besides skipping the allocator, reused blocks keep their pages mapped
+// and warm, avoiding first-touch faults on the fast path.
+//
+// Blocks are pooled under the exact requested payload size and the allocator
+// they came from. Alignment is not part of the key: every inlined HostBuffer
+// is allocated with alignof(HostBuffer) and aligns its payload to
+// max_align_t, the strongest alignment CreateUninitialized accepts.
+class HostBufferPool {
+ public:
+  static HostBufferPool &Get() {
+    static HostBufferPool *pool = new HostBufferPool();
+    return *pool;
+  }
+
+  // Returns a recycled block for the given payload size, or nullptr if the
+  // pool has none.
+  void *Acquire(size_t size, HostAllocator *allocator) {
+    mutex_lock lock(mu_);
+    for (Freelist &freelist : freelists_) {
+      if (freelist.size == size && freelist.allocator == allocator &&
+          !freelist.blocks.empty())
+        return freelist.blocks.pop_back_val();
+    }
+    return nullptr;
+  }
+
+  // Takes ownership of `block` if there is pool capacity for its size class.
+  // Returns false if the caller must deallocate the block itself.
+  bool Release(void *block, size_t size, HostAllocator *allocator) {
+    mutex_lock lock(mu_);
+    Freelist *unused = nullptr;
+    for (Freelist &freelist : freelists_) {
+      if (freelist.size == size && freelist.allocator == allocator) {
+        if (freelist.blocks.size() >= MaxBlocks(size)) return false;
+        freelist.blocks.push_back(block);
+        return true;
+      }
+      if (freelist.allocator == nullptr && unused == nullptr)
+        unused = &freelist;
+    }
+    // A size not seen before: claim a free slot for it if one is left. The
+    // slots fill up with the steady-state sizes and then stay put; one-off
+    // sizes past that point are simply not pooled.
+    if (unused == nullptr) return false;
+    unused->size = size;
+    unused->allocator = allocator;
+    unused->blocks.push_back(block);
+    return true;
+  }
+
+  // Returns all blocks pooled for `allocator` to it and frees up their slots.
+  // Must be called before the allocator is destroyed.
+  void Flush(HostAllocator *allocator) {
+    mutex_lock lock(mu_);
+    for (Freelist &freelist : freelists_) {
+      if (freelist.allocator != allocator) continue;
+      for (void *block : freelist.blocks)
+        allocator->DeallocateBytes(block, sizeof(HostBuffer) + freelist.size);
+      freelist.blocks.clear();
+      freelist.allocator = nullptr;
+      freelist.size = 0;
+    }
+  }
+
+ private:
+  // At most this many distinct (size, allocator) freelists are kept; a dozen
+  // steady-state tensor sizes fit comfortably.
+  static constexpr int kMaxFreelists = 16;
+  // Per-freelist bounds: at most kMaxBlocksPerFreelist blocks and at most
+  // kMaxBytesPerFreelist bytes, so freelists of large tensors hold fewer
+  // blocks.
+  static constexpr size_t kMaxBlocksPerFreelist = 8;
+  static constexpr size_t kMaxBytesPerFreelist = 16 << 20;
+
+  static size_t MaxBlocks(size_t size) {
+    if (size == 0) return kMaxBlocksPerFreelist;
+    return std::min(kMaxBlocksPerFreelist,
+                    std::max(size_t{1}, kMaxBytesPerFreelist / size));
+  }
+
+  struct Freelist {
+    size_t size = 0;
+    HostAllocator *allocator = nullptr;
+    llvm::SmallVector<void *, 8> blocks;
+  };
+
+  mutex mu_;
+  Freelist freelists_[kMaxFreelists] TFRT_GUARDED_BY(mu_);
+};
+
+}  // namespace
 
 RCReference<HostBuffer> HostBuffer::CreateUninitialized(
     size_t size, size_t alignment, HostAllocator *allocator) {
   assert(alignof(std::max_align_t) >= alignment && "Invalid alignment");
-  auto *buf =
-      allocator->AllocateBytes(sizeof(HostBuffer) + size, alignof(HostBuffer));
+  void *buf = HostBufferPool::Get().Acquire(size, allocator);
+  if (!buf)
+    buf = allocator->AllocateBytes(sizeof(HostBuffer) + size,
+                                   alignof(HostBuffer));
   if (!buf) return {};
 
   return TakeRef(new (buf) HostBuffer(size, allocator));
 }
 
+RCReference<HostBuffer> HostBuffer::CreateUninitialized(
+    size_t size, size_t alignment, HostAllocator *allocator, int numa_node) {
+  assert(alignof(std::max_align_t) >= alignment && "Invalid alignment");
+  if (numa_node == HostAllocator::kAnyNumaNode)
+    return CreateUninitialized(size, alignment, allocator);
+
+  // Do not consult the pool: a recycled block would live wherever it was
+  // first touched, which is exactly what the caller is trying to avoid.
+  void *buf = allocator->AllocateBytes(sizeof(HostBuffer) + size,
+                                       alignof(HostBuffer), numa_node);
+  if (!buf) return {};
+
+  return TakeRef(new (buf) HostBuffer(size, allocator));
+}
+
+void HostBuffer::FlushPool(HostAllocator *allocator) {
+  HostBufferPool::Get().Flush(allocator);
+}
+
 RCReference<HostBuffer> HostBuffer::CreateFromExternal(
     void *ptr, size_t size, Deallocator deallocator) {
   // Not allocated via HostAllocator as HostBuffer::CreateUninitialized.
   return TakeRef(new HostBuffer(ptr, size, std::move(deallocator)));
 }
 
+RCReference<HostBuffer> HostBuffer::CreateFromParent(
+    RCReference<HostBuffer> parent, size_t offset, size_t size) {
+  if (!parent) return {};
+  assert(offset + size <= parent->size() &&
+         "Sub-buffer range out of parent's bounds");
+  auto *ptr = static_cast<char *>(parent->data()) + offset;
+  // The deallocator only exists to hold a reference to the parent: the child
+  // does not own memory of its own.
+  return CreateFromExternal(
+      ptr, size, [parent = std::move(parent)](void *, size_t) {});
+}
+
+RCReference<HostBuffer> HostBuffer::CreateFromExternal(
+    std::unique_ptr<llvm::MemoryBuffer> buffer) {
+  if (!buffer) return {};
+  // The deallocator owns the MemoryBuffer and releases the underlying file
+  // mapping (or allocation) when the HostBuffer is destroyed.
+  auto *ptr = const_cast<char *>(buffer->getBufferStart());
+  size_t size = buffer->getBufferSize();
+  return CreateFromExternal(
+      ptr, size,
+      [buffer = std::move(buffer)](void *, size_t) mutable { buffer.reset(); });
+}
+
 HostBuffer::~HostBuffer() {
   if (!is_inlined_) {
     out_of_line_.deallocator(out_of_line_.ptr, size_);
@@ -52,8 +199,13 @@ HostBuffer::~HostBuffer() {
 
 void HostBuffer::Destroy() {
   if (is_inlined_) {
+    HostAllocator *allocator = inlined_.allocator;
+    size_t size = size_;
     this->~HostBuffer();
-    inlined_.allocator->DeallocateBytes(this, sizeof(HostBuffer) + size_);
+    // Recycle the block through the pool; only deallocate if the pool is
+    // already at capacity for this size.
+    if (!HostBufferPool::Get().Release(this, size, allocator))
+      allocator->DeallocateBytes(this, sizeof(HostBuffer) + size);
   } else {
     delete this;
   }
@@ -20,11 +20,15 @@
 
 #include "tfrt/host_context/host_context.h"
 
+#include <deque>
+
 #include "llvm/Support/Error.h"
 #include "tfrt/host_context/chain.h"
 #include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/execution_context.h"
 #include "tfrt/host_context/function.h"
 #include "tfrt/host_context/host_allocator.h"
+#include "tfrt/host_context/host_buffer.h"
 #include "tfrt/host_context/location.h"
 #include "tfrt/host_context/shared_context.h"
 #include "tfrt/support/mutex.h"
@@ -57,14 +61,22 @@ HostContext::~HostContext() {
   // We need to free the ready chain AsyncValue first, as the destructor of the
   // AsyncValue calls the HostContext to free its memory.
   ready_chain_.reset();
+  // Return pooled HostBuffer memory to the allocator before it goes away.
+  HostBuffer::FlushPool(allocator_.get());
   all_host_contexts_[instance_index()] = nullptr;
 }
 
 void Function::VtableAnchor() {}
 
+void Function::ExecuteBatch(ArrayRef<BatchEntry> entries,
+                            HostContext* host) const {
+  for (const BatchEntry& entry : entries)
+    Execute(entry.arguments, entry.results, host);
+}
+
 // Construct an empty IndirectAsyncValue, not forwarding to anything.
 RCReference<IndirectAsyncValue> HostContext::MakeIndirectAsyncValue() {
-  return TakeRef(Construct<IndirectAsyncValue>(instance_ptr_));
+  return TakeRef(ConstructAsyncValue<IndirectAsyncValue>(instance_ptr_));
 }
 
 //===----------------------------------------------------------------------===//
@@ -84,8 +96,8 @@ void HostContext::EmitError(const DecodedDiagnostic& diagnostic) {
 RCReference<ErrorAsyncValue> HostContext::MakeErrorAsyncValueRef(
     DecodedDiagnostic&& diagnostic) {
   // Create an AsyncValue for this error condition.
-  auto* error_value =
-      Construct<ErrorAsyncValue>(instance_ptr_, std::move(diagnostic));
+  auto* error_value = ConstructAsyncValue<ErrorAsyncValue>(
+      instance_ptr_, std::move(diagnostic));
 
   return TakeRef(error_value);
 }
@@ -147,14 +159,157 @@ void HostContext::Await(ArrayRef<RCReference<AsyncValue>> values) {
 }
 
 // Add some work to the workqueue managed by this CPU device.
-void HostContext::EnqueueWork(llvm::unique_function<void()> work) {
-  work_queue_->AddTask(TaskFunction(std::move(work)));
+void HostContext::EnqueueWork(TaskFunction work) {
+  work_queue_->AddTask(std::move(work));
+}
+
+// Add some work to the workqueue managed by this CPU device with an explicit
+// priority lane.
+void HostContext::EnqueueWork(TaskFunction work, TaskPriority priority) {
+  work_queue_->AddTask(std::move(work), priority);
+}
+
+// Add a batch of work to the workqueue managed by this CPU device with a
+// single synchronization episode.
+void HostContext::EnqueueWork(MutableArrayRef<TaskFunction> works) {
+  work_queue_->AddTasks(works);
+}
+
+static size_t AdmissionLaneIndex(TaskPriority priority) {
+  return static_cast<size_t>(priority);
+}
+
+void HostContext::SetWorkAdmissionBudget(TaskPriority priority,
+                                         size_t max_pending) {
+  mutex_lock lock(admission_mu_);
+  admission_budget_[AdmissionLaneIndex(priority)] = max_pending;
+  // Raising the budget may unblock EnqueueWorkWithBackpressure callers.
+  admission_cv_.notify_all();
+}
+
+bool HostContext::TryEnqueueWork(TaskFunction work, TaskPriority priority) {
+  size_t lane = AdmissionLaneIndex(priority);
+  {
+    mutex_lock lock(admission_mu_);
+    if (admission_budget_[lane] != 0 &&
+        admission_pending_[lane] >= admission_budget_[lane])
+      return false;
+    ++admission_pending_[lane];
+  }
+  EnqueueAdmittedWork(std::move(work), priority);
+  return true;
+}
+
+void HostContext::EnqueueWorkWithBackpressure(TaskFunction work,
+                                              TaskPriority priority) {
+  size_t lane = AdmissionLaneIndex(priority);
+  {
+    mutex_lock lock(admission_mu_);
+    admission_cv_.wait(lock, [&]() TFRT_REQUIRES(admission_mu_) {
+      return admission_budget_[lane] == 0 ||
+             admission_pending_[lane] < admission_budget_[lane];
+    });
+    ++admission_pending_[lane];
+  }
+  EnqueueAdmittedWork(std::move(work), priority);
+}
+
+// A lane slot is held from admission until the task finishes running, not
+// just until it is dequeued: the budget bounds work in the system, which is
+// what keeps queueing delay - and thus p99 latency - flat under overload.
+void HostContext::EnqueueAdmittedWork(TaskFunction work,
+                                      TaskPriority priority) {
+  EnqueueWork(
+      [this, priority, work = std::move(work)]() mutable {
+        work();
+        mutex_lock lock(admission_mu_);
+        --admission_pending_[AdmissionLaneIndex(priority)];
+        admission_cv_.notify_all();
+      },
+      priority);
+}
+
+// Per-tenant submission queue for weighted fair scheduling.
+struct HostContext::TenantQueue {
+  int weight = 1;
+  // Virtual finish time of the tenant's last dispatched task. The tenant
+  // with the smallest pass is always dispatched next, and each dispatch
+  // advances the pass by kTenantStrideScale / weight, so backlogged tenants
+  // receive dispatches in proportion to their weights.
+  uint64_t pass = 0;
+  std::deque<TaskFunction> tasks;
+};
+
+// Fixed-point scale for tenant strides, so integer weights divide evenly
+// enough to preserve their ratios.
+static constexpr uint64_t kTenantStrideScale = 1 << 16;
+
+void HostContext::SetTenantWeight(int tenant_id, int weight) {
+  mutex_lock lock(tenant_mu_);
+  auto& queue = tenant_queues_[tenant_id];
+  if (!queue) queue = std::make_unique<TenantQueue>();
+  queue->weight = std::max(weight, 1);
+}
+
+void HostContext::EnqueueWorkForTenant(int tenant_id, TaskFunction work) {
+  bool spawn_runner = false;
+  {
+    mutex_lock lock(tenant_mu_);
+    auto& queue = tenant_queues_[tenant_id];
+    if (!queue) queue = std::make_unique<TenantQueue>();
+    // A tenant that was idle starts at the current virtual time: unused
+    // share earns no credit, so a returning tenant cannot burst ahead of
+    // the others.
+    if (queue->tasks.empty() && queue->pass < tenant_virtual_time_)
+      queue->pass = tenant_virtual_time_;
+    queue->tasks.push_back(std::move(work));
+    if (tenant_runners_ < MaxTenantRunners()) {
+      ++tenant_runners_;
+      spawn_runner = true;
+    }
+  }
+  if (spawn_runner)
+    EnqueueWork([this] { RunOneTenantTask(); });
+}
+
+void HostContext::EnqueueWorkForTenant(const ExecutionContext& exec_ctx,
+                                       TaskFunction work) {
+  EnqueueWorkForTenant(exec_ctx.tenant_id(), std::move(work));
+}
+
+void HostContext::RunOneTenantTask() {
+  TaskFunction task;
+  {
+    mutex_lock lock(tenant_mu_);
+    TenantQueue* next = nullptr;
+    for (auto& entry : tenant_queues_) {
+      TenantQueue* queue = entry.second.get();
+      if (queue->tasks.empty()) continue;
+      if (!next || queue->pass < next->pass) next = queue;
+    }
+    if (!next) {
+      --tenant_runners_;
+      return;
+    }
+    task = std::move(next->tasks.front());
+    next->tasks.pop_front();
+    tenant_virtual_time_ = next->pass;
+    next->pass += kTenantStrideScale / static_cast<uint64_t>(next->weight);
+  }
+  task();
+  // Hand the worker back to the queue between tasks so tenant work
+  // interleaves fairly with non-tenant work instead of pinning a worker.
+  EnqueueWork([this] { RunOneTenantTask(); });
+}
+
+int HostContext::MaxTenantRunners() const {
+  return std::max(work_queue_->GetParallelismLevel(), 1);
 }
 
 // Add some work to the workqueue managed by this CPU device.
-bool HostContext::EnqueueBlockingWork(llvm::unique_function<void()> work) {
-  Optional<TaskFunction> task = work_queue_->AddBlockingTask(
-      TaskFunction(std::move(work)), /*allow_queuing=*/true);
+bool HostContext::EnqueueBlockingWork(TaskFunction work) {
+  Optional<TaskFunction> task =
+      work_queue_->AddBlockingTask(std::move(work), /*allow_queuing=*/true);
   return !task.hasValue();
 }
 
@@ -222,28 +377,50 @@ void HostContext::RunWhenReady(ArrayRef<RCReference<AsyncValue>> values,
 class HostContext::SharedContextManager {
  public:
   explicit SharedContextManager(HostContext* host) : host_{host} {}
+
+  ~SharedContextManager() {
+    for (auto& slot : shared_context_instances_) {
+      delete slot.load(std::memory_order_acquire);
+    }
+  }
+
   // Returns the shared context instance with the given shared_context_id.
   // Create one if the requested shared context instance does not exist yet.
+  //
+  // Shared contexts are looked up on hot paths (e.g. once per op dispatch),
+  // so the common case of an already-created context is a single atomic load
+  // with no locking. The mutex is only taken on the first request for each
+  // context type.
   SharedContext& GetOrCreateSharedContext(int shared_context_id,
                                           SharedContextFactory factory) {
     assert(shared_context_id < shared_context_instances_.size() &&
            "The requested SharedContext ID exceeds the maximum allowed");
 
-    auto& item = shared_context_instances_[shared_context_id];
+    auto& slot = shared_context_instances_[shared_context_id];
 
-    std::call_once(item.second, [&] {
-      assert(!item.first);
-      item.first = factory(host_);
-    });
+    // Fast path: the context already exists. The acquire load pairs with the
+    // release store below so the fully constructed context is visible.
+    if (SharedContext* context = slot.load(std::memory_order_acquire))
+      return *context;
+
+    mutex_lock lock(mu_);
+    // Re-check under the lock: another thread may have created the context
+    // while we were waiting.
+    if (SharedContext* context = slot.load(std::memory_order_relaxed))
+      return *context;
 
-    return *item.first;
+    SharedContext* context = factory(host_).release();
+    slot.store(context, std::memory_order_release);
+    return *context;
   }
 
  private:
   HostContext* const host_;
-  // We allow up to 256 ShareContext instances.
-  std::array<std::pair<std::unique_ptr<SharedContext>, std::once_flag>, 256>
-      shared_context_instances_{};
+  // Serializes creation; never taken on the read path.
+  mutex mu_;
+  // We allow up to 256 ShareContext instances. Slots are owned by this
+  // manager and deleted in the destructor.
+  std::array<std::atomic<SharedContext*>, 256> shared_context_instances_{};
 };
 
 SharedContext& HostContext::GetOrCreateSharedContext(
@@ -0,0 +1,58 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- host_context_pool.cc - Sharded HostContext pool --------------------===//
+//
+// This file implements HostContextPool. See host_context_pool.h.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/host_context_pool.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/host_context/host_allocator.h"
+
+namespace tfrt {
+
+HostContextPool::HostContextPool(const Options& options) {
+  const int num_nodes = GetNumNumaNodes();
+  const int num_contexts =
+      options.num_contexts > 0 ? options.num_contexts : num_nodes;
+
+  int num_threads = options.num_threads_per_context;
+  if (num_threads <= 0) {
+    const int hardware_threads =
+        static_cast<int>(std::thread::hardware_concurrency());
+    num_threads = std::max(1, hardware_threads / num_contexts);
+  }
+
+  contexts_.reserve(num_contexts);
+  for (int i = 0; i < num_contexts; ++i) {
+    // Shard i lives on node i (mod the machine size): its workers are pinned
+    // there, and first-touch plus the allocator's large-allocation NUMA path
+    // keeps the shard's tensor memory node-local. With more shards than
+    // nodes, shards share nodes but still have private queues and heaps.
+    const int numa_node = i % num_nodes;
+    auto work_queue = CreateNumaPinnedWorkQueue(
+        num_threads, options.num_blocking_threads_per_context,
+        /*max_spin_count=*/0, numa_node);
+    contexts_.push_back(std::make_unique<HostContext>(
+        options.diag_handler, CreateMallocAllocator(), std::move(work_queue)));
+  }
+}
+
+}  // namespace tfrt
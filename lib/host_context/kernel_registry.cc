@@ -20,59 +20,345 @@
 
 #include "tfrt/host_context/kernel_registry.h"
 
+#include <algorithm>
+#include <atomic>
 #include <vector>
 
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "tfrt/host_context/type_name.h"
 #include "tfrt/support/forward_decls.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
 
 namespace tfrt {
 
 using llvm::StringMap;
 using llvm::StringSet;
 
+// FNV-1a. The registration fingerprint must be stable across processes so
+// it can validate persisted kernel resolution caches; llvm::hash_value makes
+// no such guarantee, so we roll our own here.
+static uint64_t FnvExtend(uint64_t hash, string_view data) {
+  for (char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211u;
+  }
+  // Mix in a terminator so adjacent names cannot alias each other.
+  hash *= 1099511628211u;
+  return hash;
+}
+
+// Return the prefix of a kernel name: the part before the first '.', or the
+// whole name if there is none.
+static string_view KernelPrefix(string_view kernel_name) {
+  return kernel_name.split('.').first;
+}
+
+// Return true if `prefix` appears in the comma-separated `prefixes` list. An
+// empty list matches every prefix.
+static bool MatchesPrefix(string_view prefixes, string_view prefix) {
+  if (prefixes.empty()) return true;
+  while (!prefixes.empty()) {
+    auto split = prefixes.split(',');
+    if (split.first == prefix) return true;
+    prefixes = split.second;
+  }
+  return false;
+}
+
 struct KernelRegistry::Impl {
-  StringMap<KernelImplementation> implementations;
-  StringSet<> type_names;
+  // Registration functions attached but not run yet, with the kernel name
+  // prefixes they cover. Guarded by its own mutex so running a pending
+  // function - which re-enters the registry through AddKernel - never holds
+  // `mu`; the lock order is pending_mu before mu, and never the reverse.
+  mutex pending_mu;
+  struct PendingRegistration {
+    KernelRegistration fn;
+    const char* prefixes;
+  };
+  std::vector<PendingRegistration> pending TFRT_GUARDED_BY(pending_mu);
+
+  mutex mu;
+  // Maps each kernel name to its dense id in registration order. The
+  // implementations and sync bits themselves are stored by id below, so id
+  // based lookups never touch the string map.
+  StringMap<size_t> kernel_ids TFRT_GUARDED_BY(mu);
+  std::vector<KernelImplementation> kernels_by_id TFRT_GUARDED_BY(mu);
+  std::vector<bool> sync_kernels_by_id TFRT_GUARDED_BY(mu);
+  // Direct-call variants, null for kernels registered without one.
+  std::vector<SyncKernelImplementation> direct_kernels_by_id
+      TFRT_GUARDED_BY(mu);
+  // Registered call-site shapes, unchecked for kernels registered from a
+  // bare KernelImplementation.
+  std::vector<KernelSignature> signatures_by_id TFRT_GUARDED_BY(mu);
+  // Declared effects, KernelEffect::kIO for kernels registered without an
+  // annotation.
+  std::vector<KernelEffect> effects_by_id TFRT_GUARDED_BY(mu);
+  uint64_t fingerprint TFRT_GUARDED_BY(mu) =
+      14695981039346656037u;  // FNV offset basis.
+  StringSet<> type_names TFRT_GUARDED_BY(mu);
+
+  // Set by Freeze() with release ordering once registration is complete.
+  // Lookups that observe it read the tables above without taking `mu`: the
+  // tables are immutable from then on. Type name interning stays mutable
+  // (and locked) after a freeze.
+  std::atomic<bool> frozen{false};
+  // Built by Freeze(): every kernel name with its dense id, sorted by name,
+  // for hash-free and lock-free by-name lookup. The string_views point into
+  // kernel_ids, which owns the name storage.
+  std::vector<std::pair<string_view, size_t>> sorted_kernels;
+
+  void AddKernelLocked(string_view kernel_name, const KernelDescriptor& kernel,
+                       KernelEffect effect) TFRT_REQUIRES(mu);
+
+  // Run the pending registrations that cover `prefix` (or all of them when
+  // `prefix` is None). Returns true if any registration ran.
+  bool Materialize(llvm::Optional<string_view> prefix,
+                   KernelRegistry* registry);
 };
 
-KernelRegistry::KernelRegistry() : impl_(std::make_unique<Impl>()) {}
+namespace {
 
-KernelRegistry::~KernelRegistry() {}
+// Acquires `mu` unless `frozen` is set: a frozen registry's tables are
+// immutable, so reads need no lock (see KernelRegistry::Freeze). The
+// acquire annotation is unconditional because the thread safety analysis
+// cannot model the frozen case; the immutability argument is what makes
+// the unlocked reads sound.
+class TFRT_SCOPED_CAPABILITY LockUnlessFrozen {
+ public:
+  LockUnlessFrozen(const std::atomic<bool>& frozen, mutex& mu)
+      TFRT_ACQUIRE(mu)
+      : mu_(frozen.load(std::memory_order_acquire) ? nullptr : &mu) {
+    if (mu_) mu_->lock();
+  }
+  ~LockUnlessFrozen() TFRT_RELEASE() {
+    if (mu_) mu_->unlock();
+  }
+
+  LockUnlessFrozen(const LockUnlessFrozen&) = delete;
+  LockUnlessFrozen& operator=(const LockUnlessFrozen&) = delete;
 
-void KernelRegistry::AddKernel(string_view kernel_name,
-                               KernelImplementation fn) {
-  bool added = impl_->implementations.try_emplace(kernel_name, fn).second;
+ private:
+  mutex* mu_;
+};
+
+}  // namespace
+
+void KernelRegistry::Impl::AddKernelLocked(string_view kernel_name,
+                                           const KernelDescriptor& kernel,
+                                           KernelEffect effect) {
+  assert(!frozen.load(std::memory_order_relaxed) &&
+         "Registered a kernel into a frozen KernelRegistry");
+  bool added =
+      kernel_ids.try_emplace(kernel_name, kernels_by_id.size()).second;
   (void)added;
   assert(added && "Re-registered existing kernel_name");
+  kernels_by_id.push_back(kernel.fn);
+  sync_kernels_by_id.push_back(false);
+  direct_kernels_by_id.push_back(nullptr);
+  signatures_by_id.push_back(kernel.signature);
+  effects_by_id.push_back(effect);
+  fingerprint = FnvExtend(fingerprint, kernel_name);
+}
+
+bool KernelRegistry::Impl::Materialize(llvm::Optional<string_view> prefix,
+                                       KernelRegistry* registry) {
+  mutex_lock lock(pending_mu);
+  bool ran = false;
+  size_t kept = 0;
+  for (size_t i = 0, e = pending.size(); i != e; ++i) {
+    if (!prefix || MatchesPrefix(pending[i].prefixes, *prefix)) {
+      pending[i].fn(registry);
+      ran = true;
+    } else {
+      pending[kept++] = pending[i];
+    }
+  }
+  pending.resize(kept);
+  return ran;
+}
+
+KernelRegistry::KernelRegistry() : impl_(std::make_unique<Impl>()) {}
+
+KernelRegistry::~KernelRegistry() {}
+
+void KernelRegistry::AddKernel(string_view kernel_name, KernelDescriptor kernel,
+                               KernelEffect effect) {
+  mutex_lock lock(impl_->mu);
+  impl_->AddKernelLocked(kernel_name, kernel, effect);
+}
+
+void KernelRegistry::AddSyncKernel(string_view kernel_name,
+                                   KernelDescriptor kernel,
+                                   SyncKernelImplementation direct_fn,
+                                   KernelEffect effect) {
+  mutex_lock lock(impl_->mu);
+  impl_->AddKernelLocked(kernel_name, kernel, effect);
+  impl_->sync_kernels_by_id.back() = true;
+  impl_->direct_kernels_by_id.back() = direct_fn;
+}
+
+void KernelRegistry::AddKernelRegistration(KernelRegistration fn,
+                                           const char* prefixes) {
+  assert(!impl_->frozen.load(std::memory_order_relaxed) &&
+         "Attached a registration to a frozen KernelRegistry");
+  mutex_lock lock(impl_->pending_mu);
+  impl_->pending.push_back({fn, prefixes});
+}
+
+void KernelRegistry::Freeze() {
+  if (impl_->frozen.load(std::memory_order_acquire)) return;
+
+  // Pending lazy registrations are part of the registration set, so they
+  // must run before the tables are published.
+  impl_->Materialize(llvm::None, this);
+
+  mutex_lock lock(impl_->mu);
+  impl_->sorted_kernels.reserve(impl_->kernel_ids.size());
+  for (const auto& entry : impl_->kernel_ids)
+    impl_->sorted_kernels.push_back({entry.getKey(), entry.second});
+  std::sort(impl_->sorted_kernels.begin(), impl_->sorted_kernels.end(),
+            [](const std::pair<string_view, size_t>& a,
+               const std::pair<string_view, size_t>& b) {
+              return a.first < b.first;
+            });
+  impl_->frozen.store(true, std::memory_order_release);
+}
+
+bool KernelRegistry::IsFrozen() const {
+  return impl_->frozen.load(std::memory_order_acquire);
+}
+
+KernelEffect KernelRegistry::GetKernelEffect(string_view kernel_name) const {
+  ssize_t id = GetKernelId(kernel_name);
+  return id < 0 ? KernelEffect::kIO : GetKernelEffectById(id);
+}
+
+bool KernelRegistry::IsSyncKernel(string_view kernel_name) const {
+  ssize_t id = GetKernelId(kernel_name);
+  return id >= 0 && IsSyncKernelById(id);
+}
+
+SyncKernelImplementation KernelRegistry::GetDirectSyncKernel(
+    string_view kernel_name) const {
+  ssize_t id = GetKernelId(kernel_name);
+  return id < 0 ? SyncKernelImplementation() : GetDirectSyncKernelById(id);
+}
+
+KernelSignature KernelRegistry::GetKernelSignature(
+    string_view kernel_name) const {
+  ssize_t id = GetKernelId(kernel_name);
+  return id < 0 ? KernelSignature() : GetKernelSignatureById(id);
 }
 
 KernelImplementation KernelRegistry::GetKernel(string_view kernel_name) const {
-  auto it = impl_->implementations.find(kernel_name);
-  return it == impl_->implementations.end() ? KernelImplementation()
-                                            : it->second;
+  ssize_t id = GetKernelId(kernel_name);
+  return id < 0 ? KernelImplementation() : GetKernelById(id);
+}
+
+ssize_t KernelRegistry::GetKernelId(string_view kernel_name) const {
+  // Frozen registries resolve names by binary search over the sorted name
+  // table: no lock, no hashing, and no pending registrations to run.
+  if (impl_->frozen.load(std::memory_order_acquire)) {
+    const auto& sorted = impl_->sorted_kernels;
+    auto it = std::lower_bound(
+        sorted.begin(), sorted.end(), kernel_name,
+        [](const std::pair<string_view, size_t>& entry, string_view name) {
+          return entry.first < name;
+        });
+    return it != sorted.end() && it->first == kernel_name
+               ? static_cast<ssize_t>(it->second)
+               : -1;
+  }
+
+  {
+    mutex_lock lock(impl_->mu);
+    auto it = impl_->kernel_ids.find(kernel_name);
+    if (it != impl_->kernel_ids.end())
+      return static_cast<ssize_t>(it->second);
+  }
+  // Miss: run any lazy registrations covering this kernel's prefix, then
+  // look again.
+  if (!impl_->Materialize(KernelPrefix(kernel_name),
+                          const_cast<KernelRegistry*>(this)))
+    return -1;
+  mutex_lock lock(impl_->mu);
+  auto it = impl_->kernel_ids.find(kernel_name);
+  return it == impl_->kernel_ids.end() ? -1
+                                       : static_cast<ssize_t>(it->second);
+}
+
+KernelImplementation KernelRegistry::GetKernelById(size_t id) const {
+  LockUnlessFrozen lock(impl_->frozen, impl_->mu);
+  return id < impl_->kernels_by_id.size() ? impl_->kernels_by_id[id]
+                                          : KernelImplementation();
+}
+
+bool KernelRegistry::IsSyncKernelById(size_t id) const {
+  LockUnlessFrozen lock(impl_->frozen, impl_->mu);
+  return id < impl_->sync_kernels_by_id.size() &&
+         impl_->sync_kernels_by_id[id];
+}
+
+SyncKernelImplementation KernelRegistry::GetDirectSyncKernelById(
+    size_t id) const {
+  LockUnlessFrozen lock(impl_->frozen, impl_->mu);
+  return id < impl_->direct_kernels_by_id.size()
+             ? impl_->direct_kernels_by_id[id]
+             : SyncKernelImplementation();
+}
+
+KernelSignature KernelRegistry::GetKernelSignatureById(size_t id) const {
+  LockUnlessFrozen lock(impl_->frozen, impl_->mu);
+  return id < impl_->signatures_by_id.size() ? impl_->signatures_by_id[id]
+                                             : KernelSignature();
+}
+
+KernelEffect KernelRegistry::GetKernelEffectById(size_t id) const {
+  LockUnlessFrozen lock(impl_->frozen, impl_->mu);
+  return id < impl_->effects_by_id.size() ? impl_->effects_by_id[id]
+                                          : KernelEffect::kIO;
+}
+
+uint64_t KernelRegistry::GetFingerprint() const {
+  // The fingerprint describes the full registration set, so pending lazy
+  // registrations must run first; a frozen registry has none left.
+  if (!impl_->frozen.load(std::memory_order_acquire))
+    impl_->Materialize(llvm::None, const_cast<KernelRegistry*>(this));
+  LockUnlessFrozen lock(impl_->frozen, impl_->mu);
+  return impl_->fingerprint;
 }
 
 TypeName KernelRegistry::GetType(string_view type_name) const {
+  mutex_lock lock(impl_->mu);
   auto it = impl_->type_names.insert(type_name).first;
   return TypeName(it->getKeyData());
 }
 
-static std::vector<KernelRegistration>* GetStaticKernelRegistrations() {
-  static std::vector<KernelRegistration>* ret =
-      new std::vector<KernelRegistration>;
+namespace {
+struct StaticRegistration {
+  KernelRegistration fn;
+  const char* prefixes;
+};
+}  // namespace
+
+static std::vector<StaticRegistration>* GetStaticKernelRegistrations() {
+  static std::vector<StaticRegistration>* ret =
+      new std::vector<StaticRegistration>;
   return ret;
 }
 
-void AddStaticKernelRegistration(KernelRegistration func) {
-  GetStaticKernelRegistrations()->push_back(func);
+void AddStaticKernelRegistration(KernelRegistration func,
+                                 const char* prefixes) {
+  GetStaticKernelRegistrations()->push_back({func, prefixes});
 }
 
 void RegisterStaticKernels(KernelRegistry* kernel_reg) {
-  for (auto func : *GetStaticKernelRegistrations()) {
-    func(kernel_reg);
+  for (const auto& entry : *GetStaticKernelRegistrations()) {
+    kernel_reg->AddKernelRegistration(entry.fn, entry.prefixes);
   }
 }
 
@@ -22,7 +22,11 @@
 
 #include "tfrt/host_context/parallel_for.h"
 
+#include <chrono>
+
+#include "llvm/ADT/SmallVector.h"
 #include "tfrt/host_context/host_context.h"
+#include "tfrt/host_context/task_function.h"
 
 namespace tfrt {
 
@@ -41,6 +45,17 @@ BlockSizes ParallelFor::BlockSizes::Min(size_t min) {
       [min](size_t block_size) { return std::max(min, block_size); });
 }
 
+BlockSizes ParallelFor::BlockSizes::Adaptive(
+    std::chrono::nanoseconds min_task_duration) {
+  // The implementation function only sizes the calibration block; the block
+  // size for the remaining work is re-computed from the measured execution
+  // time in ParallelFor::Execute.
+  BlockSizes sizes(
+      [](size_t block_size) { return std::max(size_t{1}, block_size); });
+  sizes.min_task_duration_ = min_task_duration;
+  return sizes;
+}
+
 size_t ParallelFor::BlockSizes::GetBlockSize(size_t num_worker_threads,
                                              size_t total_size) const {
   // Do not create too many small blocks.
@@ -69,11 +84,11 @@ namespace {
 class ParallelForExecutionContext {
  public:
   static ParallelForExecutionContext* Allocate(
-      HostContext* host, size_t n, size_t block_size,
+      HostContext* host, size_t offset, size_t n, size_t block_size,
       llvm::unique_function<void(size_t, size_t)> compute,
       llvm::unique_function<void()> on_done) {
     return new ParallelForExecutionContext(
-        host, n, block_size, std::move(compute), std::move(on_done));
+        host, offset, n, block_size, std::move(compute), std::move(on_done));
   }
 
   // EvalBlocks() recursively splits the assigned block range and enqueues work
@@ -82,21 +97,31 @@ class ParallelForExecutionContext {
   // evaluates a single block in the caller thread. Blocks to evaluate are
   // specified by the half-open interval [start_block, end_block).
   void EvalBlocks(size_t start_block, size_t end_block) {
-    while (end_block - start_block > 1) {
-      const size_t mid_block = start_block + (end_block - start_block) / 2;
-
-      // Evaluate [mid_block, end_block) blocks.
-      host_->EnqueueWork(
-          [this, mid_block, end_block]() { EvalBlocks(mid_block, end_block); });
-
-      // Current range becomes [start_block, mid_block).
-      end_block = mid_block;
+    if (end_block - start_block > 1) {
+      // Split off the upper half of the range at each step and submit the
+      // halves as one batch, so the queue is synchronized once and parked
+      // workers are woken in proportion to the batch instead of one wakeup
+      // per split (see ConcurrentWorkQueue::AddTasks).
+      llvm::SmallVector<TaskFunction, 8> tasks;
+      while (end_block - start_block > 1) {
+        const size_t mid_block = start_block + (end_block - start_block) / 2;
+
+        // Evaluate [mid_block, end_block) blocks.
+        tasks.push_back(TaskFunction([this, mid_block, end_block]() {
+          EvalBlocks(mid_block, end_block);
+        }));
+
+        // Current range becomes [start_block, mid_block).
+        end_block = mid_block;
+      }
+      host_->EnqueueWork(tasks);
     }
 
     assert(end_block - start_block == 1);
 
     // Call `compute` for a single block.
-    compute_(start_block * block_size_, std::min(n_, end_block * block_size_));
+    compute_(offset_ + start_block * block_size_,
+             offset_ + std::min(n_, end_block * block_size_));
 
     // Delete this context if it was the last block.
     if (pending_blocks_.fetch_sub(1) == 1) delete this;
@@ -106,10 +131,11 @@ class ParallelForExecutionContext {
 
  private:
   ParallelForExecutionContext(
-      HostContext* host, size_t n, size_t block_size,
+      HostContext* host, size_t offset, size_t n, size_t block_size,
       llvm::unique_function<void(size_t, size_t)> compute,
       llvm::unique_function<void()> on_done)
       : host_(host),
+        offset_(offset),
         n_(n),
         block_size_(block_size),
         pending_blocks_(DivUp(n, block_size)),
@@ -126,6 +152,7 @@ class ParallelForExecutionContext {
 
   HostContext* host_;  // must stay alive before the `on_done` is called
 
+  size_t offset_;  // `compute` ranges are shifted by `offset_`
   size_t n_;
   size_t block_size_;
   std::atomic<size_t> pending_blocks_;
@@ -134,7 +161,24 @@ class ParallelForExecutionContext {
   llvm::unique_function<void()> on_done_;
 };
 
-}  // namespace
+// Given the measured execution time of a calibration block of
+// `measured_size` elements, returns a block size for the remaining work so
+// that each block runs for roughly `min_task_duration`.
+static size_t AdaptiveBlockSize(std::chrono::nanoseconds min_task_duration,
+                                std::chrono::nanoseconds measured_duration,
+                                size_t measured_size, size_t remaining_size) {
+  // The calibration block completed below the clock resolution, so elements
+  // are too cheap to justify any task scheduling overheads at all.
+  if (measured_duration.count() <= 0) return remaining_size;
+
+  // Scale the calibration block to the target duration.
+  const double scale = static_cast<double>(min_task_duration.count()) /
+                       static_cast<double>(measured_duration.count());
+  const size_t block_size =
+      static_cast<size_t>(static_cast<double>(measured_size) * scale);
+
+  return std::min(std::max(size_t{1}, block_size), remaining_size);
+}
 
 void ParallelFor::Execute(size_t total_size, const BlockSizes& block_sizes,
                           llvm::unique_function<void(size_t, size_t)> compute,
@@ -143,7 +187,7 @@ void ParallelFor::Execute(size_t total_size, const BlockSizes& block_sizes,
   if (total_size == 0) return on_done();
 
   // Compute a parallel block size for the non-empty range [0, total_size).
-  const size_t block_size =
+  size_t block_size =
       block_sizes.GetBlockSize(host_->GetNumWorkerThreads(), total_size);
   assert(block_size > 0 && "Illegal block size");
   assert(block_size <= total_size && "Illegal block size");
@@ -155,9 +199,33 @@ void ParallelFor::Execute(size_t total_size, const BlockSizes& block_sizes,
     return;
   }
 
+  // For the adaptive block sizes policy, execute the first block in the
+  // caller thread and measure its execution time to estimate the per-element
+  // cost of `compute`, then re-split the remaining work so that each block
+  // meets the requested task duration target.
+  size_t offset = 0;
+  if (block_sizes.IsAdaptive()) {
+    const auto start = std::chrono::steady_clock::now();
+    compute(0, block_size);
+    const auto measured = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    offset = block_size;
+    block_size = AdaptiveBlockSize(block_sizes.min_task_duration(), measured,
+                                   block_size, total_size - offset);
+
+    // Execute the remaining work as a single block in the caller thread.
+    if (total_size - offset <= block_size) {
+      compute(offset, total_size);
+      on_done();
+      return;
+    }
+  }
+
   // Allocate parallel for execution context on the heap.
   ParallelForExecutionContext* ctx = ParallelForExecutionContext::Allocate(
-      host_, total_size, block_size, std::move(compute), std::move(on_done));
+      host_, offset, total_size - offset, block_size, std::move(compute),
+      std::move(on_done));
   ctx->EvalBlocks(0, ctx->PendingBlocks());
 }
 
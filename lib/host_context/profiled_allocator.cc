@@ -15,15 +15,29 @@
 //===- profiled_allocator.cc - Profiled Memory Allocator ------------------===//
 //
 // This file implements a profiling host memory allocator that does a memory
-// leak check and prints allocation statistics when destroyed.
+// leak check and prints allocation statistics when destroyed. The statistics
+// include a per-size-class allocation histogram and sampled allocation
+// backtraces (one sample every kSampleIntervalBytes allocated bytes), cheap
+// enough to stay enabled on live jobs. Backtraces are dumped as raw addresses
+// for offline symbolization.
 //
 //===----------------------------------------------------------------------===//
 
 #include <atomic>
+#include <cinttypes>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#endif
 
 #include "tfrt/host_context/host_allocator.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
 
 namespace tfrt {
 
@@ -38,6 +52,19 @@ void AtomicUpdateMax(T const& value, std::atomic<T>* max_value) noexcept {
   }
 }
 
+// One allocation sample is taken per this many allocated bytes. Sampling by
+// bytes rather than by call makes the expected sample count of a call site
+// proportional to the bytes it allocates, which is what matters when chasing
+// resident-set regressions.
+constexpr int64_t kSampleIntervalBytes = 256 * 1024;
+
+// Sampled backtraces are truncated to this many frames.
+constexpr int kMaxSampleDepth = 16;
+
+// Allocation sizes 2^0 ... 2^31 and larger get one histogram bucket per
+// power of two.
+constexpr int kNumSizeClasses = 32;
+
 }  // namespace
 
 class ProfiledAllocator : public HostAllocator {
@@ -52,47 +79,198 @@ class ProfiledAllocator : public HostAllocator {
   }
 
   void* AllocateBytes(size_t size, size_t alignment) override {
-    ++curr_num_allocations_;
-    ++cum_num_allocations_;
-    curr_num_bytes_allocated_.fetch_add(size);
-    AtomicUpdateMax<int64_t>(curr_num_allocations_, &max_num_allocations_);
-    AtomicUpdateMax<int64_t>(curr_num_bytes_allocated_,
-                             &max_num_bytes_allocated_);
-
-    return allocator_->AllocateBytes(size, alignment);
+    return AllocateBytes(size, alignment, kAnyNumaNode);
+  }
+
+  void* AllocateBytes(size_t size, size_t alignment, int numa_node) override {
+    CounterStripe& stripe = GetStripe();
+    ++stripe.curr_num_allocations;
+    ++stripe.cum_num_allocations;
+    stripe.curr_num_bytes_allocated.fetch_add(size,
+                                              std::memory_order_relaxed);
+    ++size_class_histogram_[SizeClass(size)];
+
+    // Take a backtrace sample every kSampleIntervalBytes allocated bytes.
+    // The countdown is the only shared cache line the common path touches
+    // besides this thread's stripe, and it is written once per allocation.
+    if (bytes_until_sample_.fetch_sub(size, std::memory_order_relaxed) <=
+        static_cast<int64_t>(size)) {
+      bytes_until_sample_.fetch_add(kSampleIntervalBytes,
+                                    std::memory_order_relaxed);
+      RecordSample(size);
+      // Peaks are refreshed from the stripes only on the (rare) sampling
+      // path, so the reported maxima are lower bounds reached around sample
+      // points rather than exact peaks.
+      AtomicUpdateMax<int64_t>(TotalCurrNumAllocations(),
+                               &max_num_allocations_);
+      AtomicUpdateMax<int64_t>(TotalCurrNumBytesAllocated(),
+                               &max_num_bytes_allocated_);
+    }
+
+    void* ptr = allocator_->AllocateBytes(size, alignment, numa_node);
+    if (ptr) TrackAllocation(size);
+    return ptr;
   }
 
   void DeallocateBytes(void* ptr, size_t size) override {
-    --curr_num_allocations_;
-    curr_num_bytes_allocated_.fetch_sub(size);
+    TrackDeallocation(size);
+    CounterStripe& stripe = GetStripe();
+    --stripe.curr_num_allocations;
+    stripe.curr_num_bytes_allocated.fetch_sub(size,
+                                              std::memory_order_relaxed);
 
     allocator_->DeallocateBytes(ptr, size);
   }
 
  protected:
+  int64_t TotalCurrNumAllocations() const {
+    int64_t total = 0;
+    for (const CounterStripe& stripe : stripes_) {
+      total += stripe.curr_num_allocations.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  int64_t TotalCumNumAllocations() const {
+    int64_t total = 0;
+    for (const CounterStripe& stripe : stripes_) {
+      total += stripe.cum_num_allocations.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  int64_t TotalCurrNumBytesAllocated() const {
+    int64_t total = 0;
+    for (const CounterStripe& stripe : stripes_) {
+      total += stripe.curr_num_bytes_allocated.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
   void PrintStats() const {
     printf("HostAllocator profile:\n");
     printf("Current number of allocations = %" PRId64 "\n",
-           curr_num_allocations_.load());
+           TotalCurrNumAllocations());
     printf("Max number of allocations = %" PRId64 "\n",
            max_num_allocations_.load());
     printf("Total number of allocations = %" PRId64 "\n",
-           cum_num_allocations_.load());
+           TotalCumNumAllocations());
     printf("Current number of bytes allocated = %" PRId64 "\n",
-           curr_num_bytes_allocated_.load());
+           TotalCurrNumBytesAllocated());
     printf("Max number of bytes allocated = %" PRId64 "\n",
            max_num_bytes_allocated_.load());
+
+    printf("Allocation size histogram (allocations per power-of-two class):\n");
+    for (int c = 0; c < kNumSizeClasses; ++c) {
+      const int64_t count = size_class_histogram_[c].load();
+      if (count == 0) continue;
+      printf("  <= %" PRIu64 " bytes: %" PRId64 "\n", uint64_t{1} << c, count);
+    }
+
+    // One line per sampled backtrace:
+    //   <samples> samples, ~<bytes> bytes @ <pc> <pc> ...
+    // The addresses are raw program counters; symbolize offline against the
+    // unstripped binary (e.g. with addr2line or llvm-symbolizer).
+    mutex_lock lock(samples_mu_);
+    bool printed_header = false;
+    for (const Sample& sample : samples_) {
+      if (sample.num_hits == 0) continue;
+      if (!printed_header) {
+        printf("Sampled allocation backtraces (1 sample per %" PRId64
+               " bytes):\n",
+               kSampleIntervalBytes);
+        printed_header = true;
+      }
+      printf("  %" PRId64 " samples, ~%" PRId64 " bytes @", sample.num_hits,
+             sample.num_hits * kSampleIntervalBytes);
+      for (int i = 0; i < sample.depth; ++i) {
+        printf(" %p", sample.frames[i]);
+      }
+      printf("\n");
+    }
     fflush(stdout);
   }
 
   bool print_profile_ = true;
-  std::atomic<int64_t> curr_num_allocations_{0};
   std::atomic<int64_t> max_num_allocations_{0};
-  std::atomic<int64_t> cum_num_allocations_{0};
-  std::atomic<int64_t> curr_num_bytes_allocated_{0};
   std::atomic<int64_t> max_num_bytes_allocated_{0};
 
  private:
+  // Current/cumulative counters are striped so that concurrently allocating
+  // threads do not all bounce one shared cache line; each stripe is padded
+  // to a cache line of its own and totals are summed on the slow paths.
+  struct alignas(64) CounterStripe {
+    std::atomic<int64_t> curr_num_allocations{0};
+    std::atomic<int64_t> cum_num_allocations{0};
+    std::atomic<int64_t> curr_num_bytes_allocated{0};
+  };
+  static constexpr int kNumStripes = 8;
+
+  // A deduplicated sampled backtrace.
+  struct Sample {
+    int64_t num_hits = 0;
+    int depth = 0;
+    void* frames[kMaxSampleDepth];
+  };
+  static constexpr int kMaxSamples = 256;
+
+  CounterStripe& GetStripe() {
+    static std::atomic<unsigned> next_stripe{0};
+    static thread_local unsigned stripe_index =
+        next_stripe.fetch_add(1) % kNumStripes;
+    return stripes_[stripe_index];
+  }
+
+  static int SizeClass(size_t size) {
+    int size_class = 0;
+    while (size_class < kNumSizeClasses - 1 &&
+           (uint64_t{1} << size_class) < size) {
+      ++size_class;
+    }
+    return size_class;
+  }
+
+  // Captures the current backtrace and merges it into the sample table,
+  // deduplicating identical stacks. Runs once per kSampleIntervalBytes
+  // allocated bytes, so taking a lock here is fine.
+  void RecordSample(size_t size) {
+#if defined(__GLIBC__)
+    void* frames[kMaxSampleDepth + 2];
+    const int captured = backtrace(frames, kMaxSampleDepth + 2);
+    // Skip this function and AllocateBytes: the caller frames are the
+    // interesting ones.
+    constexpr int kSkippedFrames = 2;
+    if (captured <= kSkippedFrames) return;
+    void** stack = frames + kSkippedFrames;
+    const int depth = captured - kSkippedFrames;
+
+    mutex_lock lock(samples_mu_);
+    for (Sample& sample : samples_) {
+      if (sample.num_hits == 0) {
+        // First unused slot: the stack was not seen before, claim the slot.
+        sample.depth = depth;
+        memcpy(sample.frames, stack, depth * sizeof(void*));
+        sample.num_hits = 1;
+        return;
+      }
+      if (sample.depth == depth &&
+          memcmp(sample.frames, stack, depth * sizeof(void*)) == 0) {
+        ++sample.num_hits;
+        return;
+      }
+    }
+    // Table full: drop the sample. kMaxSamples distinct stacks is far more
+    // than a tensor workload has distinct allocation sites.
+#endif
+  }
+
+  CounterStripe stripes_[kNumStripes];
+  std::atomic<int64_t> size_class_histogram_[kNumSizeClasses] = {};
+  std::atomic<int64_t> bytes_until_sample_{kSampleIntervalBytes};
+
+  mutable mutex samples_mu_;
+  Sample samples_[kMaxSamples] TFRT_GUARDED_BY(samples_mu_);
+
   std::unique_ptr<HostAllocator> allocator_;
 };
 
@@ -105,11 +283,11 @@ class LeakCheckAllocator : public ProfiledAllocator {
 
   // Cause process to exit(1) when memory leak is detected.
   ~LeakCheckAllocator() override {
-    if (curr_num_bytes_allocated_.load() != 0) {
+    if (TotalCurrNumBytesAllocated() != 0) {
       PrintStats();
       printf("Memory leak detected: %" PRId64 " alive allocations, %" PRId64
              " alive bytes\n",
-             curr_num_allocations_.load(), curr_num_bytes_allocated_.load());
+             TotalCurrNumAllocations(), TotalCurrNumBytesAllocated());
       fflush(stdout);
       exit(1);
     }
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2020 The TensorFlow Runtime Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//===- resumable_task.cc ----------------------------------------*- C++ -*-===//
+//
+// Driver for suspension-capable work queue tasks.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/resumable_task.h"
+
+#include <memory>
+
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/host_context.h"
+
+namespace tfrt {
+namespace {
+
+// Heap-allocated state of a single resumable task, kept alive across
+// suspensions until the step function runs to completion.
+struct ResumableTaskState {
+  ResumableTaskState(llvm::unique_function<TaskResumption()> step,
+                     AsyncValueRef<Chain> chain)
+      : step(std::move(step)), chain(std::move(chain)) {}
+
+  llvm::unique_function<TaskResumption()> step;
+  AsyncValueRef<Chain> chain;
+};
+
+// Run resumption steps until the task completes or suspends. Must be called
+// from a work queue task (or the initial enqueue below).
+void Resume(HostContext* host, std::unique_ptr<ResumableTaskState> state) {
+  TaskResumption resumption = state->step();
+  if (!resumption.IsSuspended()) {
+    state->chain.emplace();
+    return;
+  }
+
+  // Re-enqueue the task when the awaited value becomes available, instead of
+  // resuming inline: the value is typically completed on an unrelated thread
+  // (e.g. an IO completion thread) that must not run compute work. The
+  // captured reference keeps the awaited value alive until then.
+  RCReference<AsyncValue> awaited = resumption.TakeAwaited();
+  AsyncValue* awaited_ptr = awaited.get();
+  awaited_ptr->AndThen([host, awaited = std::move(awaited),
+                        state = std::move(state)]() mutable {
+    host->EnqueueWork([host, state = std::move(state)]() mutable {
+      Resume(host, std::move(state));
+    });
+  });
+}
+
+}  // namespace
+
+AsyncValueRef<Chain> RunResumableTask(
+    HostContext* host, llvm::unique_function<TaskResumption()> step) {
+  AsyncValueRef<Chain> chain = host->MakeUnconstructedAsyncValueRef<Chain>();
+
+  auto state =
+      std::make_unique<ResumableTaskState>(std::move(step), chain.CopyRef());
+  host->EnqueueWork([host, state = std::move(state)]() mutable {
+    Resume(host, std::move(state));
+  });
+
+  return chain;
+}
+
+}  // namespace tfrt
@@ -0,0 +1,145 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- run_to_completion_work_queue.cc ------------------------------------===//
+//
+// This file implements a work queue that executes every task inline on the
+// caller thread, for latency-critical graphs that are too small to amortize
+// any queueing.
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/None.h"
+#include "tfrt/host_context/async_value.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+namespace {
+
+// This work queue spawns no threads and keeps no queue: AddTask runs the task
+// before returning. With every continuation executing inline, a BEF function
+// runs as a depth-first interpretation on the caller thread with no queue
+// hops, which removes all scheduling overhead for sub-100us graphs.
+//
+// Deeply chained continuations would turn inline execution into unbounded
+// recursion, so each thread bounds its inline depth: tasks submitted beyond
+// the bound are deferred and drained by the outermost AddTask frame before it
+// returns. The deferral is per-thread state, so there is still no
+// synchronization anywhere on the task path.
+class RunToCompletionWorkQueue : public ConcurrentWorkQueue {
+ public:
+  RunToCompletionWorkQueue() {}
+
+  std::string name() const override { return "run-to-completion"; }
+
+  void AddTask(TaskFunction work) override;
+  // Tasks complete before AddTask returns, so priority lanes do not apply.
+  using ConcurrentWorkQueue::AddTask;
+  Optional<TaskFunction> AddBlockingTask(TaskFunction work,
+                                         bool allow_queuing) override;
+  void Quiesce() override;
+  void Await(ArrayRef<RCReference<AsyncValue>> values) override;
+  int GetParallelismLevel() const override { return 1; }
+
+ private:
+  struct ThreadState {
+    int depth = 0;
+    std::vector<TaskFunction> deferred;
+  };
+
+  static ThreadState& GetThreadState() {
+    static thread_local ThreadState state;
+    return state;
+  }
+
+  // Beyond this inline call depth tasks are deferred to the outermost frame.
+  // Tasks can have deep call stacks of their own, so the bound is far below
+  // what the inline frames alone would allow.
+  static constexpr int kMaxInlineDepth = 64;
+};
+
+}  // namespace
+
+void RunToCompletionWorkQueue::AddTask(TaskFunction work) {
+  ThreadState& state = GetThreadState();
+  if (state.depth >= kMaxInlineDepth) {
+    state.deferred.push_back(std::move(work));
+    return;
+  }
+
+  ++state.depth;
+  work();
+  --state.depth;
+
+  // Only the outermost frame drains deferred tasks, so a task deferred at
+  // depth kMaxInlineDepth does not restart inline execution halfway down an
+  // already-deep stack.
+  if (state.depth > 0) return;
+  while (!state.deferred.empty()) {
+    std::vector<TaskFunction> local;
+    std::swap(local, state.deferred);
+    for (auto& task : local) {
+      ++state.depth;
+      task();
+      --state.depth;
+    }
+  }
+}
+
+// Blocking tasks also run inline: the caller thread is the only thread there
+// is, and running the task immediately is what guarantees it starts within a
+// finite amount of time even when queuing is not allowed.
+Optional<TaskFunction> RunToCompletionWorkQueue::AddBlockingTask(
+    TaskFunction work, bool allow_queuing) {
+  AddTask(std::move(work));
+  return llvm::None;
+}
+
+// Every task completes inside the AddTask call that submitted it, so there is
+// never pending or inflight work to wait for.
+void RunToCompletionWorkQueue::Quiesce() {}
+
+void RunToCompletionWorkQueue::Await(ArrayRef<RCReference<AsyncValue>> values) {
+  // Inline execution means any value produced by this queue's tasks is
+  // already available here. An unavailable value can only be resolved by
+  // another thread (e.g. an external event source), so block until its
+  // AndThen callback fires.
+  mutex mu;
+  condition_variable cv;
+  int values_remaining = values.size();
+
+  for (auto& value : values) {
+    value->AndThen([&]() {
+      // Notify while holding the lock: the callback must not touch `cv`
+      // after Await observes a zero count and destroys it.
+      mutex_lock l(mu);
+      --values_remaining;
+      cv.notify_all();
+    });
+  }
+
+  mutex_lock l(mu);
+  cv.wait(l, [&]() TFRT_REQUIRES(mu) { return values_remaining == 0; });
+}
+
+std::unique_ptr<ConcurrentWorkQueue> CreateRunToCompletionWorkQueue() {
+  return std::make_unique<RunToCompletionWorkQueue>();
+}
+
+}  // namespace tfrt
@@ -0,0 +1,103 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- scratch_arena.cc - Kernel-Scoped Scratch Arena ---------------------===//
+//
+// This file implements the slow path of ScratchArena: acquiring backing slabs
+// from a thread-local slab cache and handling oversized requests.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/scratch_arena.h"
+
+#include <cstdlib>
+
+namespace tfrt {
+namespace {
+
+// Each block starts with a pointer-sized link to the next block in its list;
+// the usable region follows the link.
+constexpr size_t kBlockHeaderSize = sizeof(void*);
+
+void*& NextOf(void* block) { return *static_cast<void**>(block); }
+
+// Standard slabs released by ScratchArena::Reset() are parked here and handed
+// to the next arena refill on the same thread. The cache is intentionally
+// small: it only needs to cover the handful of arenas alive on a thread at
+// once to make slab reuse the common case.
+struct SlabCache {
+  static constexpr int kMaxCachedSlabs = 8;
+
+  ~SlabCache() {
+    for (int i = 0; i < num_slabs; ++i) free(slabs[i]);
+  }
+
+  void* slabs[kMaxCachedSlabs];
+  int num_slabs = 0;
+};
+
+SlabCache& GetSlabCache() {
+  static thread_local SlabCache cache;
+  return cache;
+}
+
+}  // namespace
+
+void* ScratchArena::AllocateSlow(size_t size, size_t alignment) {
+  // Reserving `size + alignment` bytes lets the bump pointer satisfy the
+  // alignment wherever the usable region happens to start.
+  if (size + alignment <= kSlabSize - kBlockHeaderSize) {
+    SlabCache& cache = GetSlabCache();
+    void* slab = cache.num_slabs > 0 ? cache.slabs[--cache.num_slabs]
+                                     : malloc(kSlabSize);
+    NextOf(slab) = slabs_;
+    slabs_ = slab;
+    next_ = reinterpret_cast<uintptr_t>(slab) + kBlockHeaderSize;
+    end_ = reinterpret_cast<uintptr_t>(slab) + kSlabSize;
+    // Guaranteed to fit in the fresh slab.
+    return Allocate(size, alignment);
+  }
+
+  // Oversized request: give it a dedicated block. It does not become the
+  // bump region, so a large allocation does not waste the current slab.
+  void* block = malloc(kBlockHeaderSize + alignment + size);
+  NextOf(block) = large_blocks_;
+  large_blocks_ = block;
+  uintptr_t payload =
+      reinterpret_cast<uintptr_t>(block) + kBlockHeaderSize + alignment - 1;
+  payload &= ~uintptr_t{alignment - 1};
+  return reinterpret_cast<void*>(payload);
+}
+
+void ScratchArena::Reset() {
+  SlabCache& cache = GetSlabCache();
+  while (slabs_ != nullptr) {
+    void* slab = slabs_;
+    slabs_ = NextOf(slab);
+    if (cache.num_slabs < SlabCache::kMaxCachedSlabs) {
+      cache.slabs[cache.num_slabs++] = slab;
+    } else {
+      free(slab);
+    }
+  }
+  while (large_blocks_ != nullptr) {
+    void* block = large_blocks_;
+    large_blocks_ = NextOf(block);
+    free(block);
+  }
+  next_ = 0;
+  end_ = 0;
+}
+
+}  // namespace tfrt
@@ -0,0 +1,227 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- shared_memory_region.cc --------------------------------------------===//
+//
+// This file implements SharedMemoryRegion.
+//
+// Region layout: a RegionHeader at offset zero, then bump-allocated blocks.
+// Every block is preceded by a BlockHeader holding its size and a reference
+// count; the count lives in the mapped pages, so increments from any process
+// mapping the region coordinate reclamation. The arena offset rewinds to the
+// start once no block is live anywhere, which fits the transient handoff
+// pattern this region serves.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/shared_memory_region.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include "llvm/Support/MathExtras.h"
+#include "tfrt/host_context/host_buffer.h"
+#include "tfrt/support/error_util.h"
+
+namespace tfrt {
+namespace {
+
+constexpr uint64_t kRegionMagic = 0x7446725453686d52ull;  // "tFrTShmR"
+
+struct RegionHeader {
+  uint64_t magic;
+  // Offset of the next free byte. Allocations reserve space with a CAS loop;
+  // the offset rewinds to kDataStart when live_blocks drains to zero.
+  std::atomic<uint64_t> arena_offset;
+  // Number of blocks not yet released by every process.
+  std::atomic<uint64_t> live_blocks;
+};
+
+// Immediately precedes each block's data, inside the shared mapping.
+struct BlockHeader {
+  uint64_t size;
+  std::atomic<uint64_t> ref_count;
+};
+
+static_assert(sizeof(BlockHeader) % alignof(uint64_t) == 0,
+              "block data following the header must stay 8-byte aligned");
+
+// Keep the first block away from the header's contended atomics.
+constexpr uint64_t kDataStart = 64;
+static_assert(sizeof(RegionHeader) <= kDataStart, "header overlaps arena");
+
+RegionHeader* GetHeader(char* base) {
+  return reinterpret_cast<RegionHeader*>(base);
+}
+
+BlockHeader* GetBlockHeader(char* base, uint64_t data_offset) {
+  return reinterpret_cast<BlockHeader*>(base + data_offset -
+                                        sizeof(BlockHeader));
+}
+
+// Rewind the arena if no block is live. The arena offset is loaded before
+// live_blocks: an allocation racing with this check raises live_blocks
+// before bumping the arena, so it either fails the live check or makes the
+// CAS below fail. A failed CAS just postpones the rewind.
+void TryRewind(RegionHeader* header) {
+  uint64_t expected = header->arena_offset.load();
+  if (header->live_blocks.load() != 0 || expected == kDataStart) return;
+  header->arena_offset.compare_exchange_strong(expected, kDataStart);
+}
+
+}  // namespace
+
+SharedMemoryRegion::SharedMemoryRegion(std::string name, void* base,
+                                       size_t byte_size, bool owns_name)
+    : name_(std::move(name)),
+      base_(static_cast<char*>(base)),
+      byte_size_(byte_size),
+      owns_name_(owns_name) {}
+
+SharedMemoryRegion::~SharedMemoryRegion() {
+  ::munmap(base_, byte_size_);
+  if (owns_name_) ::shm_unlink(name_.c_str());
+}
+
+Expected<RCReference<SharedMemoryRegion>> SharedMemoryRegion::MapRegion(
+    const std::string& name, size_t byte_size, bool create) {
+  int flags = create ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR;
+  int fd = ::shm_open(name.c_str(), flags, 0600);
+  if (fd < 0)
+    return MakeStringError("shm_open(", name, "): ", strerror(errno));
+  if (create && ::ftruncate(fd, byte_size) != 0) {
+    int error = errno;
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+    return MakeStringError("ftruncate(", name, "): ", strerror(error));
+  }
+  void* base =
+      ::mmap(nullptr, byte_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  int error = errno;
+  ::close(fd);
+  if (base == MAP_FAILED) {
+    if (create) ::shm_unlink(name.c_str());
+    return MakeStringError("mmap(", name, "): ", strerror(error));
+  }
+
+  auto* header = GetHeader(static_cast<char*>(base));
+  if (create) {
+    header->magic = kRegionMagic;
+    header->arena_offset.store(kDataStart);
+    header->live_blocks.store(0);
+  } else if (header->magic != kRegionMagic) {
+    ::munmap(base, byte_size);
+    return MakeStringError(name, " is not a tensor transport region");
+  }
+  return TakeRef(new SharedMemoryRegion(name, base, byte_size, create));
+}
+
+Expected<RCReference<SharedMemoryRegion>> SharedMemoryRegion::Create(
+    size_t byte_size) {
+  if (byte_size <= kDataStart)
+    return MakeStringError("shared memory region too small");
+  static std::atomic<uint64_t> next_id{0};
+  std::string name = StrCat("/tfrt_shm_", getpid(), "_",
+                            next_id.fetch_add(1, std::memory_order_relaxed));
+  return MapRegion(name, byte_size, /*create=*/true);
+}
+
+Expected<RCReference<SharedMemoryRegion>> SharedMemoryRegion::Open(
+    string_view name, size_t byte_size) {
+  if (byte_size <= kDataStart)
+    return MakeStringError("shared memory region too small");
+  return MapRegion(name.str(), byte_size, /*create=*/false);
+}
+
+RCReference<HostBuffer> SharedMemoryRegion::AllocateBuffer(size_t size,
+                                                           size_t alignment) {
+  auto* header = GetHeader(base_);
+  // Raising live_blocks before touching the arena keeps TryRewind from
+  // resetting the offset underneath this reservation.
+  header->live_blocks.fetch_add(1);
+  TryRewind(header);
+
+  uint64_t data_offset;
+  uint64_t current = header->arena_offset.load();
+  do {
+    data_offset = llvm::alignTo(current + sizeof(BlockHeader),
+                                std::max<size_t>(alignment, alignof(uint64_t)));
+    if (data_offset + size > byte_size_) {
+      header->live_blocks.fetch_sub(1);
+      return {};
+    }
+  } while (
+      !header->arena_offset.compare_exchange_weak(current, data_offset + size));
+
+  auto* block = GetBlockHeader(base_, data_offset);
+  block->size = size;
+  block->ref_count.store(1);
+  return HostBuffer::CreateFromExternal(
+      base_ + data_offset, size,
+      [region = FormRef(this), data_offset](void*, size_t) {
+        ReleaseBlock(std::move(region), data_offset);
+      });
+}
+
+void SharedMemoryRegion::ReleaseBlock(RCReference<SharedMemoryRegion> region,
+                                      uint64_t offset) {
+  auto* block = GetBlockHeader(region->base_, offset);
+  if (block->ref_count.fetch_sub(1) != 1) return;
+  auto* header = GetHeader(region->base_);
+  header->live_blocks.fetch_sub(1);
+  TryRewind(header);
+}
+
+Expected<uint64_t> SharedMemoryRegion::ExportBuffer(const HostBuffer& buffer) {
+  const char* data = static_cast<const char*>(buffer.data());
+  if (data < base_ + kDataStart + sizeof(BlockHeader) ||
+      data + buffer.size() > base_ + byte_size_)
+    return MakeStringError("buffer does not belong to this region");
+  uint64_t offset = data - base_;
+  auto* block = GetBlockHeader(base_, offset);
+  if (block->size != buffer.size())
+    return MakeStringError("buffer does not start a region block");
+  // This reference travels with the offset and is taken over by the peer's
+  // ImportBuffer (or returned through DropExported).
+  block->ref_count.fetch_add(1);
+  return offset;
+}
+
+Expected<RCReference<HostBuffer>> SharedMemoryRegion::ImportBuffer(
+    uint64_t offset) {
+  if (offset < kDataStart + sizeof(BlockHeader) || offset >= byte_size_)
+    return MakeStringError("offset outside shared memory region");
+  auto* block = GetBlockHeader(base_, offset);
+  if (block->size > byte_size_ - offset || block->ref_count.load() == 0)
+    return MakeStringError("offset does not name a live region block");
+  return HostBuffer::CreateFromExternal(
+      base_ + offset, block->size,
+      [region = FormRef(this), offset](void*, size_t) {
+        ReleaseBlock(std::move(region), offset);
+      });
+}
+
+void SharedMemoryRegion::DropExported(uint64_t offset) {
+  ReleaseBlock(FormRef(this), offset);
+}
+
+}  // namespace tfrt
@@ -40,6 +40,8 @@ class SingleThreadedWorkQueue : public ConcurrentWorkQueue {
   std::string name() const override { return "single-threaded"; }
 
   void AddTask(TaskFunction work) override;
+  // There is only one worker thread, so priority lanes do not apply here.
+  using ConcurrentWorkQueue::AddTask;
   Optional<TaskFunction> AddBlockingTask(TaskFunction work,
                                          bool allow_queuing) override;
   void Quiesce() override;
@@ -0,0 +1,289 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- size_class_allocator.cc --------------------------------------------===//
+//
+// This file implements a size-class caching allocator: freed blocks are kept
+// in per-thread caches backed by central per-class freelists, so the steady
+// state of an allocate/deallocate-heavy tensor workload is served without
+// touching the process-global heap (and without contending with the rest of
+// the application on the malloc lock).
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MathExtras.h"
+#include "tfrt/host_context/host_allocator.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+
+// Sizes are rounded up to power-of-two classes between these bounds. Requests
+// outside the bounds go straight to the underlying allocator: tiny requests
+// are cheap everywhere, and for huge ones the cache would just pin memory.
+constexpr size_t kMinBlockSize = 64;
+constexpr size_t kMaxCachedSize = 1 << 20;
+constexpr int kNumClasses = 15;  // 64 B ... 1 MB, one class per power of two.
+
+// Number of blocks moved between a thread cache and a central freelist at
+// once. Batching amortizes the central list lock over many thread-local
+// operations.
+constexpr size_t kTransferBatchSize = 16;
+
+// A thread cache holds at most this many blocks of one class; the surplus is
+// flushed back to the central freelist where other threads can reuse it.
+constexpr size_t kMaxThreadCacheBlocks = 32;
+
+// A central freelist holds at most this many blocks of one class; the surplus
+// is returned to the underlying allocator, bounding how much memory an idle
+// pool keeps alive.
+constexpr size_t kMaxCentralBlocks = 256;
+
+class SizeClassAllocator;
+
+// The per-thread block cache. A cache binds to the first SizeClassAllocator
+// that allocates on this thread and serves that allocator without any
+// locking; other allocator instances on the same thread fall back to their
+// central freelists.
+struct SizeClassThreadCache {
+  ~SizeClassThreadCache();
+
+  SizeClassAllocator* owner = nullptr;
+  llvm::SmallVector<void*, 8> free_blocks[kNumClasses];
+};
+
+class SizeClassAllocator : public HostAllocator {
+ public:
+  explicit SizeClassAllocator(std::unique_ptr<HostAllocator> underlying)
+      : underlying_(std::move(underlying)) {}
+
+  ~SizeClassAllocator() override {
+    // No thread may be allocating through this allocator at this point.
+    // Unbind all thread caches that still point here and reclaim their
+    // blocks; a cache whose thread exits later sees the null owner and does
+    // nothing.
+    mutex_lock lock(caches_mu_);
+    for (SizeClassThreadCache* cache : caches_) {
+      for (int c = 0; c < kNumClasses; ++c) {
+        for (void* block : cache->free_blocks[c]) FreeBlock(block, c);
+        cache->free_blocks[c].clear();
+      }
+      cache->owner = nullptr;
+    }
+    for (int c = 0; c < kNumClasses; ++c) {
+      for (void* block : central_[c].blocks) FreeBlock(block, c);
+    }
+  }
+
+  void* AllocateBytes(size_t size, size_t alignment) override {
+    void* ptr = AllocateBytesImpl(size, alignment);
+    if (ptr) TrackAllocation(size);
+    return ptr;
+  }
+
+  void* AllocateBytesImpl(size_t size, size_t alignment) {
+    if (size > kMaxCachedSize || alignment > kMaxCachedSize) {
+      if (alignment <= 8) return underlying_->AllocateBytes(size, alignment);
+      return underlying_->AllocateBytes(llvm::alignTo(size, alignment),
+                                        alignment);
+    }
+
+    // Classifying by max(size, alignment) makes every block of the class
+    // large enough and sufficiently aligned for this request, since class
+    // blocks are aligned to their own power-of-two size.
+    const int size_class = SizeClass(std::max(size, alignment));
+
+    if (SizeClassThreadCache* cache = GetThreadCache()) {
+      auto& blocks = cache->free_blocks[size_class];
+      if (blocks.empty()) RefillThreadCache(cache, size_class);
+      if (!blocks.empty()) return blocks.pop_back_val();
+    } else {
+      CentralFreeList& central = central_[size_class];
+      mutex_lock lock(central.mu);
+      if (!central.blocks.empty()) {
+        void* block = central.blocks.back();
+        central.blocks.pop_back();
+        return block;
+      }
+    }
+    return AllocateBlock(size_class);
+  }
+
+  // Allocate with a NUMA node preference. Requests past the cache bounds
+  // forward the hint to the underlying allocator; cached blocks are recycled
+  // without regard to the node they came from, so small hinted allocations
+  // take the regular path and get their locality from first touch.
+  void* AllocateBytes(size_t size, size_t alignment, int numa_node) override {
+    if (size > kMaxCachedSize || alignment > kMaxCachedSize) {
+      void* ptr =
+          alignment <= 8
+              ? underlying_->AllocateBytes(size, alignment, numa_node)
+              : underlying_->AllocateBytes(llvm::alignTo(size, alignment),
+                                           alignment, numa_node);
+      if (ptr) TrackAllocation(size);
+      return ptr;
+    }
+    return AllocateBytes(size, alignment);
+  }
+
+  void DeallocateBytes(void* ptr, size_t size) override {
+    TrackDeallocation(size);
+    if (size > kMaxCachedSize) {
+      underlying_->DeallocateBytes(ptr, size);
+      return;
+    }
+
+    // The deallocation class is computed from the size alone, while the
+    // allocation class also considered the alignment. The allocation class
+    // is never smaller, so a block entering this pool is always at least as
+    // large and as aligned as the class it lands in.
+    const int size_class = SizeClass(size);
+
+    if (SizeClassThreadCache* cache = GetThreadCache()) {
+      auto& blocks = cache->free_blocks[size_class];
+      blocks.push_back(ptr);
+      if (blocks.size() > kMaxThreadCacheBlocks) {
+        FlushThreadCache(cache, size_class);
+      }
+      return;
+    }
+
+    CentralFreeList& central = central_[size_class];
+    {
+      mutex_lock lock(central.mu);
+      if (central.blocks.size() < kMaxCentralBlocks) {
+        central.blocks.push_back(ptr);
+        return;
+      }
+    }
+    FreeBlock(ptr, size_class);
+  }
+
+ private:
+  friend struct SizeClassThreadCache;
+
+  // Central freelist for one size class. Each class has its own lock so
+  // different classes never contend.
+  struct CentralFreeList {
+    mutex mu;
+    std::vector<void*> blocks TFRT_GUARDED_BY(mu);
+  };
+
+  static size_t BlockSize(int size_class) {
+    return kMinBlockSize << size_class;
+  }
+
+  static int SizeClass(size_t size) {
+    if (size <= kMinBlockSize) return 0;
+    return llvm::Log2_64_Ceil(size) - llvm::Log2_64(kMinBlockSize);
+  }
+
+  void* AllocateBlock(int size_class) {
+    const size_t block_size = BlockSize(size_class);
+    return underlying_->AllocateBytes(block_size, block_size);
+  }
+
+  void FreeBlock(void* block, int size_class) {
+    underlying_->DeallocateBytes(block, BlockSize(size_class));
+  }
+
+  // Returns this thread's cache if it serves this allocator, binding an
+  // unbound cache on first use. Returns nullptr if the cache is bound to a
+  // different allocator instance.
+  SizeClassThreadCache* GetThreadCache() {
+    static thread_local SizeClassThreadCache tls_cache;
+    if (tls_cache.owner == this) return &tls_cache;
+    if (tls_cache.owner != nullptr) return nullptr;
+    mutex_lock lock(caches_mu_);
+    tls_cache.owner = this;
+    caches_.push_back(&tls_cache);
+    return &tls_cache;
+  }
+
+  // Moves up to kTransferBatchSize blocks from the central freelist into the
+  // thread cache under a single central list lock.
+  void RefillThreadCache(SizeClassThreadCache* cache, int size_class) {
+    CentralFreeList& central = central_[size_class];
+    mutex_lock lock(central.mu);
+    const size_t count = std::min(central.blocks.size(), kTransferBatchSize);
+    auto& blocks = cache->free_blocks[size_class];
+    blocks.append(central.blocks.end() - count, central.blocks.end());
+    central.blocks.resize(central.blocks.size() - count);
+  }
+
+  // Moves a batch of blocks from an overfull thread cache back to the
+  // central freelist; blocks beyond the central capacity go back to the
+  // underlying allocator.
+  void FlushThreadCache(SizeClassThreadCache* cache, int size_class) {
+    auto& blocks = cache->free_blocks[size_class];
+    llvm::SmallVector<void*, kTransferBatchSize> overflow;
+    CentralFreeList& central = central_[size_class];
+    {
+      mutex_lock lock(central.mu);
+      for (size_t i = 0; i < kTransferBatchSize; ++i) {
+        void* block = blocks.pop_back_val();
+        if (central.blocks.size() < kMaxCentralBlocks) {
+          central.blocks.push_back(block);
+        } else {
+          overflow.push_back(block);
+        }
+      }
+    }
+    for (void* block : overflow) FreeBlock(block, size_class);
+  }
+
+  // Called from a thread cache destructor when its thread exits while this
+  // allocator is still alive.
+  void ReleaseThreadCache(SizeClassThreadCache* cache) {
+    mutex_lock lock(caches_mu_);
+    for (int c = 0; c < kNumClasses; ++c) {
+      CentralFreeList& central = central_[c];
+      mutex_lock central_lock(central.mu);
+      for (void* block : cache->free_blocks[c]) {
+        if (central.blocks.size() < kMaxCentralBlocks) {
+          central.blocks.push_back(block);
+        } else {
+          FreeBlock(block, c);
+        }
+      }
+      cache->free_blocks[c].clear();
+    }
+    caches_.erase(std::remove(caches_.begin(), caches_.end(), cache),
+                  caches_.end());
+  }
+
+  CentralFreeList central_[kNumClasses];
+
+  mutex caches_mu_;
+  std::vector<SizeClassThreadCache*> caches_ TFRT_GUARDED_BY(caches_mu_);
+
+  std::unique_ptr<HostAllocator> underlying_;
+};
+
+SizeClassThreadCache::~SizeClassThreadCache() {
+  if (owner != nullptr) owner->ReleaseThreadCache(this);
+}
+
+std::unique_ptr<HostAllocator> CreateSizeClassAllocator(
+    std::unique_ptr<HostAllocator> underlying) {
+  return std::make_unique<SizeClassAllocator>(std::move(underlying));
+}
+
+}  // namespace tfrt
@@ -43,6 +43,18 @@ std::unique_ptr<ConcurrentWorkQueue> SingleThreadedWorkQueueFactory(
   return CreateSingleThreadedWorkQueue();
 }
 
+// Factory function for the inline run-to-completion work queue. The argument
+// must be empty.
+std::unique_ptr<ConcurrentWorkQueue> RunToCompletionWorkQueueFactory(
+    string_view arg) {
+  if (!arg.empty()) {
+    TFRT_LOG(ERROR) << "Invalid argument for inline work queue: "
+                    << std::string(arg);
+    return nullptr;
+  }
+  return CreateRunToCompletionWorkQueue();
+}
+
 struct MakeMultiThreadedWorkQueue {
   static std::unique_ptr<ConcurrentWorkQueue> make(int num_threads,
                                                    int num_blocking_threads) {
@@ -107,6 +119,7 @@ std::unique_ptr<ConcurrentWorkQueue> MultiThreadedWorkQueueFactory(
 }  // namespace
 
 TFRT_WORK_QUEUE_FACTORY("s", SingleThreadedWorkQueueFactory);
+TFRT_WORK_QUEUE_FACTORY("inline", RunToCompletionWorkQueueFactory);
 TFRT_WORK_QUEUE_FACTORY(
     "mstd", MultiThreadedWorkQueueFactory<MakeMultiThreadedWorkQueue>);
 
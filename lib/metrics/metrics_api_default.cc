@@ -0,0 +1,260 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- metrics_api_default.cc ---------------------------------------------===//
+//
+// This file provides the default implementation of the metrics APIs, used if
+// ENABLE_TFRT_METRICS is not defined. Counter and histogram updates are a
+// single relaxed atomic add to a cache-line-padded shard selected by a
+// thread-local index, so hot-path instrumentation does not make concurrently
+// updating threads bounce a shared cache line; shards are summed when a
+// snapshot is taken.
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tfrt/metrics/metrics_api.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+namespace metrics {
+
+// If ENABLE_TFRT_METRICS is not defined, provide this default implementation
+// of the metrics APIs defined in metrics_api.h. Otherwise, we assume users
+// will provide their own implementation of all metrics APIs (including
+// SnapshotMetrics) as a library during TFRT compilation.
+
+#if !defined(ENABLE_TFRT_METRICS)
+
+namespace {
+
+// Number of cache-line-padded shards updates are striped over. Threads hash
+// onto shards by a thread-local index, so this does not need to match the
+// core count to keep concurrent updaters apart.
+constexpr int kNumShards = 8;
+
+// Histogram values 2^0 ... 2^31 and larger get one bucket per power of two.
+constexpr int kNumHistogramBuckets = 32;
+
+int ShardIndex() {
+  static std::atomic<unsigned> next_shard{0};
+  static thread_local unsigned shard = next_shard.fetch_add(1) % kNumShards;
+  return shard;
+}
+
+// Base class of all metric implementations: carries the name and knows how to
+// snapshot itself for export.
+class MetricBase {
+ public:
+  explicit MetricBase(std::string name) : name_(std::move(name)) {}
+  virtual ~MetricBase() {}
+
+  virtual MetricSnapshot Snapshot() const = 0;
+
+  const std::string& name() const { return name_; }
+
+ private:
+  std::string name_;
+};
+
+// Global registry of every metric created through the New* factories. The
+// factories hand out raw pointers that are never destroyed, so the registry
+// (intentionally leaked) can snapshot them at any time.
+class Registry {
+ public:
+  static Registry& Get() {
+    static Registry* registry = new Registry();
+    return *registry;
+  }
+
+  void Register(MetricBase* metric) {
+    mutex_lock lock(mu_);
+    metrics_.push_back(metric);
+  }
+
+  std::vector<MetricSnapshot> Snapshot() const {
+    mutex_lock lock(mu_);
+    std::vector<MetricSnapshot> snapshots;
+    snapshots.reserve(metrics_.size());
+    for (const MetricBase* metric : metrics_) {
+      snapshots.push_back(metric->Snapshot());
+    }
+    return snapshots;
+  }
+
+ private:
+  mutable mutex mu_;
+  std::vector<MetricBase*> metrics_ TFRT_GUARDED_BY(mu_);
+};
+
+template <typename T>
+class StripedCounter : public Counter<T>, public MetricBase {
+ public:
+  explicit StripedCounter(std::string name) : MetricBase(std::move(name)) {}
+
+  void Add(T value) override {
+    shards_[ShardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  MetricSnapshot Snapshot() const override {
+    MetricSnapshot snapshot;
+    snapshot.name = name();
+    snapshot.kind = MetricSnapshot::Kind::kCounter;
+    for (const Shard& shard : shards_) {
+      snapshot.int_value += shard.value.load(std::memory_order_relaxed);
+    }
+    return snapshot;
+  }
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<T> value{0};
+  };
+  Shard shards_[kNumShards];
+};
+
+// Gauges are last-writer-wins, so there is nothing to stripe: SetValue is one
+// relaxed store.
+template <typename T>
+class AtomicGauge : public Gauge<T>, public MetricBase {
+ public:
+  explicit AtomicGauge(std::string name) : MetricBase(std::move(name)) {}
+
+  void SetValue(T value) override {
+    value_.store(value, std::memory_order_relaxed);
+  }
+
+  MetricSnapshot Snapshot() const override {
+    MetricSnapshot snapshot;
+    snapshot.name = name();
+    snapshot.kind = MetricSnapshot::Kind::kGauge;
+    snapshot.int_value =
+        static_cast<int64_t>(value_.load(std::memory_order_relaxed));
+    return snapshot;
+  }
+
+ private:
+  std::atomic<T> value_{};
+};
+
+// String gauges are set rarely (version strings, mode flags) and cannot be
+// stored atomically, so a mutex is fine.
+class StringGauge : public Gauge<std::string>, public MetricBase {
+ public:
+  explicit StringGauge(std::string name) : MetricBase(std::move(name)) {}
+
+  void SetValue(std::string value) override {
+    mutex_lock lock(mu_);
+    value_ = std::move(value);
+  }
+
+  MetricSnapshot Snapshot() const override {
+    MetricSnapshot snapshot;
+    snapshot.name = name();
+    snapshot.kind = MetricSnapshot::Kind::kGauge;
+    mutex_lock lock(mu_);
+    snapshot.string_value = value_;
+    return snapshot;
+  }
+
+ private:
+  mutable mutex mu_;
+  std::string value_ TFRT_GUARDED_BY(mu_);
+};
+
+class StripedHistogram : public Histogram, public MetricBase {
+ public:
+  explicit StripedHistogram(std::string name) : MetricBase(std::move(name)) {}
+
+  void Record(int64_t value) override {
+    shards_[ShardIndex()].buckets[BucketIndex(value)].fetch_add(
+        1, std::memory_order_relaxed);
+  }
+
+  MetricSnapshot Snapshot() const override {
+    MetricSnapshot snapshot;
+    snapshot.name = name();
+    snapshot.kind = MetricSnapshot::Kind::kHistogram;
+    snapshot.histogram_buckets.assign(kNumHistogramBuckets, 0);
+    for (const Shard& shard : shards_) {
+      for (int b = 0; b < kNumHistogramBuckets; ++b) {
+        snapshot.histogram_buckets[b] +=
+            shard.buckets[b].load(std::memory_order_relaxed);
+      }
+    }
+    return snapshot;
+  }
+
+ private:
+  static int BucketIndex(int64_t value) {
+    int bucket = 0;
+    while (bucket < kNumHistogramBuckets - 1 &&
+           (int64_t{1} << bucket) < value) {
+      ++bucket;
+    }
+    return bucket;
+  }
+
+  struct alignas(64) Shard {
+    std::atomic<int64_t> buckets[kNumHistogramBuckets] = {};
+  };
+  Shard shards_[kNumShards];
+};
+
+template <typename MetricT>
+MetricT* NewRegistered(std::string name) {
+  auto* metric = new MetricT(std::move(name));
+  Registry::Get().Register(metric);
+  return metric;
+}
+
+}  // namespace
+
+template <typename T>
+Gauge<T>* NewGauge(std::string name) {
+  return NewRegistered<AtomicGauge<T>>(std::move(name));
+}
+
+template <>
+Gauge<std::string>* NewGauge<std::string>(std::string name) {
+  return NewRegistered<StringGauge>(std::move(name));
+}
+
+template Gauge<int64_t>* NewGauge<int64_t>(std::string name);
+
+template <typename T>
+Counter<T>* NewCounter(std::string name) {
+  return NewRegistered<StripedCounter<T>>(std::move(name));
+}
+
+template Counter<int64_t>* NewCounter<int64_t>(std::string name);
+
+Histogram* NewHistogram(std::string name) {
+  return NewRegistered<StripedHistogram>(std::move(name));
+}
+
+std::vector<MetricSnapshot> SnapshotMetrics() {
+  return Registry::Get().Snapshot();
+}
+
+#endif
+
+}  // namespace metrics
+}  // namespace tfrt
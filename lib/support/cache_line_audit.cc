@@ -0,0 +1,141 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- cache_line_audit.cc - Cache Line Contention Audit ------------------===//
+//
+// This file implements the opt-in cache line contention audit. The whole
+// translation unit is empty unless built with -DTFRT_CACHE_LINE_AUDIT.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/support/cache_line_audit.h"
+
+#if defined(TFRT_CACHE_LINE_AUDIT)
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace tfrt {
+namespace audit {
+namespace {
+
+constexpr uintptr_t kCacheLineSize = 64;
+
+// Fixed-size open-addressed table of observed cache lines. Lock-free so the
+// probe itself does not manufacture the very contention it measures; entries
+// are claimed once with a CAS and never freed. Power of two for cheap
+// masking.
+constexpr size_t kNumSlots = 1 << 14;
+constexpr int kMaxProbes = 8;
+
+struct LineSlot {
+  // Cache line address (low 6 bits zero); 0 means unclaimed.
+  std::atomic<uintptr_t> line{0};
+  // Hash of the thread that wrote the line last; 0 before the first write.
+  std::atomic<uint64_t> last_writer{0};
+  // Annotated site of the last write.
+  std::atomic<const char*> last_site{nullptr};
+  // Cross-thread write-write collisions observed on this line, and the site
+  // pair of the most recent one.
+  std::atomic<uint64_t> collisions{0};
+  std::atomic<const char*> collision_from{nullptr};
+  std::atomic<const char*> collision_to{nullptr};
+};
+
+LineSlot slots[kNumSlots];
+std::atomic<uint64_t> dropped_lines{0};
+
+uint64_t ThisThreadHash() {
+  // Never zero, so zero can mean "no writer yet".
+  return std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+}
+
+LineSlot* FindSlot(uintptr_t line) {
+  // Multiplicative hashing on the line address.
+  size_t index = (line * 0x9E3779B97F4A7C15ull) >> 40;
+  for (int probe = 0; probe < kMaxProbes; ++probe) {
+    LineSlot& slot = slots[(index + probe) & (kNumSlots - 1)];
+    uintptr_t seen = slot.line.load(std::memory_order_acquire);
+    if (seen == line) return &slot;
+    if (seen == 0) {
+      uintptr_t expected = 0;
+      if (slot.line.compare_exchange_strong(expected, line,
+                                            std::memory_order_acq_rel))
+        return &slot;
+      if (expected == line) return &slot;
+    }
+  }
+  // The table region is full; the audit stays best-effort rather than
+  // resizing under load.
+  dropped_lines.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+}
+
+void InstallReportAtExit() {
+  static bool installed = [] {
+    atexit(ReportCacheLineCollisions);
+    return true;
+  }();
+  (void)installed;
+}
+
+}  // namespace
+
+void RecordWrite(const void* address, const char* site) {
+  InstallReportAtExit();
+
+  uintptr_t line = reinterpret_cast<uintptr_t>(address) & ~(kCacheLineSize - 1);
+  LineSlot* slot = FindSlot(line);
+  if (!slot) return;
+
+  uint64_t self = ThisThreadHash();
+  const char* prev_site = slot->last_site.exchange(site);
+  uint64_t prev_writer = slot->last_writer.exchange(self);
+  if (prev_writer != 0 && prev_writer != self) {
+    slot->collisions.fetch_add(1, std::memory_order_relaxed);
+    slot->collision_from.store(prev_site, std::memory_order_relaxed);
+    slot->collision_to.store(site, std::memory_order_relaxed);
+  }
+}
+
+void ReportCacheLineCollisions() {
+  bool printed_header = false;
+  for (LineSlot& slot : slots) {
+    uint64_t collisions = slot.collisions.load();
+    if (collisions == 0) continue;
+    if (!printed_header) {
+      printf(
+          "Cache line contention audit (match addresses against perf c2c "
+          "data addresses):\n");
+      printed_header = true;
+    }
+    const char* from = slot.collision_from.load();
+    const char* to = slot.collision_to.load();
+    printf("TFRT_C2C line=0x%" PRIxPTR " collisions=%" PRIu64 " sites=%s->%s\n",
+           slot.line.load(), collisions, from ? from : "?", to ? to : "?");
+  }
+  uint64_t dropped = dropped_lines.load();
+  if (dropped != 0)
+    printf("TFRT_C2C dropped=%" PRIu64 " (slot table full)\n", dropped);
+  fflush(stdout);
+}
+
+}  // namespace audit
+}  // namespace tfrt
+
+#endif  // defined(TFRT_CACHE_LINE_AUDIT)
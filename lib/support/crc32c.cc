@@ -0,0 +1,130 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- crc32c.cc - CRC32C checksums ---------------------------------------===//
+//
+// This file implements CRC32C checksumming with three backends: the SSE4.2
+// crc32 instruction (selected at runtime via cpuid), the ARMv8 CRC extension
+// (selected at compile time, since targets that enable __ARM_FEATURE_CRC32
+// guarantee the instructions), and a portable table-driven fallback.
+//
+//===----------------------------------------------------------------------===//
+#include "tfrt/support/crc32c.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__clang__) || defined(__GNUC__))
+#define TFRT_CRC32C_HAS_SSE42 1
+#include <nmmintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define TFRT_CRC32C_HAS_ARM_CRC 1
+#include <arm_acle.h>
+#endif
+
+namespace tfrt {
+namespace crc32c {
+namespace {
+
+// CRC32C polynomial, reflected.
+constexpr uint32_t kPolynomial = 0x82f63b78u;
+
+struct Crc32cTable {
+  uint32_t entries[256];
+
+  Crc32cTable() {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t crc = i;
+      for (int j = 0; j < 8; ++j) {
+        crc = (crc >> 1) ^ (kPolynomial & (0u - (crc & 1)));
+      }
+      entries[i] = crc;
+    }
+  }
+};
+
+uint32_t ExtendPortable(uint32_t init_crc, const uint8_t* data, size_t n) {
+  static const Crc32cTable table;
+  uint32_t crc = ~init_crc;
+  for (size_t i = 0; i < n; ++i) {
+    crc = table.entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+#ifdef TFRT_CRC32C_HAS_SSE42
+__attribute__((target("sse4.2"))) uint32_t ExtendSse42(uint32_t init_crc,
+                                                       const uint8_t* data,
+                                                       size_t n) {
+  uint64_t crc = ~init_crc;
+  // Byte-step to 8 byte alignment, then consume 8 bytes per instruction.
+  while (n > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0) {
+    crc = _mm_crc32_u8(static_cast<uint32_t>(crc), *data++);
+    --n;
+  }
+  while (n >= 8) {
+    uint64_t chunk;
+    std::memcpy(&chunk, data, sizeof(chunk));
+    crc = _mm_crc32_u64(crc, chunk);
+    data += 8;
+    n -= 8;
+  }
+  while (n > 0) {
+    crc = _mm_crc32_u8(static_cast<uint32_t>(crc), *data++);
+    --n;
+  }
+  return ~static_cast<uint32_t>(crc);
+}
+#endif  // TFRT_CRC32C_HAS_SSE42
+
+#ifdef TFRT_CRC32C_HAS_ARM_CRC
+uint32_t ExtendArmCrc(uint32_t init_crc, const uint8_t* data, size_t n) {
+  uint32_t crc = ~init_crc;
+  while (n >= 8) {
+    uint64_t chunk;
+    std::memcpy(&chunk, data, sizeof(chunk));
+    crc = __crc32cd(crc, chunk);
+    data += 8;
+    n -= 8;
+  }
+  while (n > 0) {
+    crc = __crc32cb(crc, *data++);
+    --n;
+  }
+  return ~crc;
+}
+#endif  // TFRT_CRC32C_HAS_ARM_CRC
+
+using ExtendFn = uint32_t (*)(uint32_t, const uint8_t*, size_t);
+
+ExtendFn ResolveExtendFn() {
+#ifdef TFRT_CRC32C_HAS_SSE42
+  if (__builtin_cpu_supports("sse4.2")) return ExtendSse42;
+#endif
+#ifdef TFRT_CRC32C_HAS_ARM_CRC
+  return ExtendArmCrc;
+#endif
+  return ExtendPortable;
+}
+
+}  // namespace
+
+uint32_t Extend(uint32_t init_crc, const char* data, size_t n) {
+  static const ExtendFn extend_fn = ResolveExtendFn();
+  return extend_fn(init_crc, reinterpret_cast<const uint8_t*>(data), n);
+}
+
+}  // namespace crc32c
+}  // namespace tfrt
@@ -19,8 +19,14 @@
 //===----------------------------------------------------------------------===//
 #include "tfrt/support/hash_util.h"
 
+#include <cassert>
+
 #include "tfrt/support/byte_order.h"
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
 namespace tfrt {
 
 // 0xff is in case char is signed.
@@ -105,55 +111,236 @@ uint32_t Hash32(const char* data, size_t n, uint32_t seed) {
   return h;
 }
 
-// Murmur2 hash based algorithm. The algorithm is in public domain.
-uint64_t Hash64(const char* data, size_t n, uint64_t seed) {
-  const uint64_t m = 0xc6a4a7935bd1e995;
-  const int r = 47;
+//===----------------------------------------------------------------------===//
+// Hash64: an xxh3-class hash.
+//
+// Kernel, op and attribute names are mostly 8-32 bytes, so the short-key
+// paths below are branch-minimal: one or two folded 128-bit multiplies and
+// an avalanche, with no per-byte loop. Longer keys go through a striped
+// accumulator loop with an AVX2 variant selected at runtime on x86-64.
+//===----------------------------------------------------------------------===//
 
-  uint64_t h = seed ^ (n * m);
+namespace {
 
-  while (n >= 8) {
-    uint64_t k = DecodeFixed64(data);
-    data += 8;
-    n -= 8;
+// xxhash's mixing primes.
+constexpr uint64_t kPrime64_1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime64_3 = 0x165667B19E3779F9ull;
+constexpr uint32_t kPrime32_1 = 0x9E3779B1u;
 
-    k *= m;
-    k ^= k >> r;
-    k *= m;
+// Key material the striped loop xors into each 8-byte lane (from xxh3's
+// default secret).
+alignas(32) constexpr uint64_t kSecret[8] = {
+    0xbe4ba423396cfeb8ull, 0x1cad21f72c81017cull, 0xdb979083e96dd4deull,
+    0x1f67b3b7a4a44072ull, 0x78e5c0cc4ee679cbull, 0x2172ffcc7dd05a82ull,
+    0x8e2443f7744608b8ull, 0x4c263a81e69035e0ull,
+};
 
-    h ^= k;
-    h *= m;
+// Full 64x64->128 bit multiply folded back to 64 bits by xor. This is the
+// mixing core: every input bit influences the whole result in one multiply.
+inline uint64_t Mul128Fold64(uint64_t lhs, uint64_t rhs) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t product = static_cast<__uint128_t>(lhs) * rhs;
+  return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+  // Portable 32-bit limb multiplication.
+  uint64_t lo_lo = (lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF);
+  uint64_t hi_lo = (lhs >> 32) * (rhs & 0xFFFFFFFF);
+  uint64_t lo_hi = (lhs & 0xFFFFFFFF) * (rhs >> 32);
+  uint64_t hi_hi = (lhs >> 32) * (rhs >> 32);
+  uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+  uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+  uint64_t lower = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+  return lower ^ upper;
+#endif
+}
+
+inline uint64_t Avalanche(uint64_t h) {
+  h ^= h >> 37;
+  h *= kPrime64_3;
+  h ^= h >> 32;
+  return h;
+}
+
+// Mixes the 16 bytes at `data` against two lanes of key material.
+inline uint64_t Mix16(const char* data, uint64_t key_a, uint64_t key_b,
+                      uint64_t seed) {
+  return Mul128Fold64(DecodeFixed64(data) ^ (key_a + seed),
+                      DecodeFixed64(data + 8) ^ (key_b - seed));
+}
+
+// Accumulates one 64-byte stripe into eight lanes: per lane, xor with key
+// material, multiply the halves, and add the raw input to keep it lossless.
+// `tweak` varies per stripe so that the commutative accumulation cannot be
+// fooled by permuted stripes.
+inline void AccumulateStripeScalar(uint64_t* acc, const char* data,
+                                   uint64_t tweak) {
+  for (int lane = 0; lane < 8; ++lane) {
+    uint64_t input = DecodeFixed64(data + 8 * lane);
+    uint64_t mixed = input ^ (kSecret[lane] + tweak);
+    acc[lane ^ 1] += input;
+    acc[lane] += static_cast<uint32_t>(mixed) * (mixed >> 32);
   }
+}
 
-  switch (n) {
-    case 7:
-      h ^= ByteAs64(data[6]) << 48;
-      LLVM_FALLTHROUGH;
-    case 6:
-      h ^= ByteAs64(data[5]) << 40;
-      LLVM_FALLTHROUGH;
-    case 5:
-      h ^= ByteAs64(data[4]) << 32;
-      LLVM_FALLTHROUGH;
-    case 4:
-      h ^= ByteAs64(data[3]) << 24;
-      LLVM_FALLTHROUGH;
-    case 3:
-      h ^= ByteAs64(data[2]) << 16;
-      LLVM_FALLTHROUGH;
-    case 2:
-      h ^= ByteAs64(data[1]) << 8;
-      LLVM_FALLTHROUGH;
-    case 1:
-      h ^= ByteAs64(data[0]);
-      h *= m;
+uint64_t HashLongScalar(const char* data, size_t n, uint64_t seed) {
+  uint64_t acc[8] = {kPrime32_1,  kPrime64_1, kPrime64_2, kPrime64_3,
+                     0x27D4EB2Full ^ seed, kPrime64_1 + seed, seed,
+                     kPrime32_1 + seed};
+  uint64_t tweak = 0;
+  const char* stripe = data;
+  for (; stripe + 64 < data + n; stripe += 64) {
+    AccumulateStripeScalar(acc, stripe, tweak);
+    tweak += kPrime64_2;
   }
+  // The final, overlapping stripe covers the tail.
+  AccumulateStripeScalar(acc, data + n - 64, tweak);
 
-  h ^= h >> r;
-  h *= m;
-  h ^= h >> r;
+  uint64_t result = seed + n * kPrime64_1;
+  for (int lane = 0; lane < 8; lane += 2) {
+    result += Mul128Fold64(acc[lane] ^ kSecret[lane],
+                           acc[lane + 1] ^ kSecret[lane + 1]);
+  }
+  return Avalanche(result);
+}
 
-  return h;
+#if defined(__x86_64__) && defined(__GNUC__)
+#define TFRT_HASH_HAS_AVX2_PATH 1
+
+// One half (32 bytes, four lanes) of an AVX2 stripe accumulation: xor with
+// key material, vector mul_epu32 of the lane halves, plus the raw input
+// with its lane pairs swapped (the vector form of the `acc[lane ^ 1]`
+// feed in the scalar loop).
+__attribute__((target("avx2"))) inline __m256i Avx2AccumulateHalf(
+    __m256i acc, const char* stripe_half, __m256i secret, __m256i tweak) {
+  __m256i input =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(stripe_half));
+  __m256i mixed = _mm256_xor_si256(input, _mm256_add_epi64(secret, tweak));
+  __m256i halves_swapped = _mm256_shuffle_epi32(mixed, 0b10110001);
+  __m256i product = _mm256_mul_epu32(mixed, halves_swapped);
+  __m256i input_swapped = _mm256_shuffle_epi32(input, 0b01001110);
+  return _mm256_add_epi64(acc, _mm256_add_epi64(product, input_swapped));
+}
+
+// AVX2 variant of the stripe loop: two 4x64 accumulators cover a 64-byte
+// stripe. Lane for lane it computes the same accumulation as the scalar
+// loop, so the two paths hash identically.
+__attribute__((target("avx2"))) uint64_t HashLongAvx2(const char* data,
+                                                      size_t n,
+                                                      uint64_t seed) {
+  __m256i acc0 = _mm256_setr_epi64x(kPrime32_1, kPrime64_1, kPrime64_2,
+                                    kPrime64_3);
+  __m256i acc1 = _mm256_setr_epi64x(0x27D4EB2Full ^ seed, kPrime64_1 + seed,
+                                    seed, kPrime32_1 + seed);
+  const __m256i secret0 =
+      _mm256_load_si256(reinterpret_cast<const __m256i*>(kSecret));
+  const __m256i secret1 =
+      _mm256_load_si256(reinterpret_cast<const __m256i*>(kSecret + 4));
+
+  uint64_t tweak = 0;
+  const char* stripe = data;
+  for (; stripe + 64 < data + n; stripe += 64) {
+    __m256i tweak_vec = _mm256_set1_epi64x(tweak);
+    acc0 = Avx2AccumulateHalf(acc0, stripe, secret0, tweak_vec);
+    acc1 = Avx2AccumulateHalf(acc1, stripe + 32, secret1, tweak_vec);
+    tweak += kPrime64_2;
+  }
+  __m256i tweak_vec = _mm256_set1_epi64x(tweak);
+  acc0 = Avx2AccumulateHalf(acc0, data + n - 64, secret0, tweak_vec);
+  acc1 = Avx2AccumulateHalf(acc1, data + n - 64 + 32, secret1, tweak_vec);
+
+  alignas(32) uint64_t acc[8];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(acc), acc0);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(acc + 4), acc1);
+
+  uint64_t result = seed + n * kPrime64_1;
+  for (int lane = 0; lane < 8; lane += 2) {
+    result += Mul128Fold64(acc[lane] ^ kSecret[lane],
+                           acc[lane + 1] ^ kSecret[lane + 1]);
+  }
+  return Avalanche(result);
+}
+#endif  // TFRT_HASH_HAS_AVX2_PATH
+
+using LongHashFn = uint64_t (*)(const char*, size_t, uint64_t);
+
+// Picks the widest stripe loop the machine supports, once per process.
+LongHashFn ChooseLongHash() {
+#ifdef TFRT_HASH_HAS_AVX2_PATH
+  if (__builtin_cpu_supports("avx2")) return HashLongAvx2;
+#endif
+  return HashLongScalar;
 }
 
+uint64_t HashLong(const char* data, size_t n, uint64_t seed) {
+  static const LongHashFn long_hash = ChooseLongHash();
+  return long_hash(data, n, seed);
+}
+
+}  // namespace
+
+// An xxh3-class hash: folded 128-bit multiplies on short keys, a striped
+// SIMD-friendly accumulator loop on long ones. Not a stable on-disk format;
+// anything persisted must hash with an explicitly versioned function
+// instead.
+uint64_t Hash64(const char* data, size_t n, uint64_t seed) {
+  if (n <= 16) {
+    if (n >= 8) {
+      // Two (overlapping for n < 16) 8-byte loads cover the key.
+      uint64_t lo = DecodeFixed64(data) ^ (kSecret[0] + seed);
+      uint64_t hi = DecodeFixed64(data + n - 8) ^ (kSecret[1] - seed);
+      return Avalanche(n + Mul128Fold64(lo, hi));
+    }
+    if (n >= 4) {
+      // Two overlapping 4-byte loads cover the key.
+      uint64_t lo = DecodeFixed32(data);
+      uint64_t hi = DecodeFixed32(data + n - 4);
+      uint64_t combined = lo + (hi << 32);
+      return Avalanche((combined ^ (kSecret[2] + seed)) * kPrime64_1 + n);
+    }
+    if (n > 0) {
+      uint64_t combined = ByteAs64(data[0]) | (ByteAs64(data[n >> 1]) << 16) |
+                          (ByteAs64(data[n - 1]) << 32) | (n << 48);
+      return Avalanche((combined ^ (kSecret[3] + seed)) * kPrime64_2);
+    }
+    return Avalanche(seed ^ kSecret[0]);
+  }
+  if (n <= 32) {
+    // Two 16-byte mixes, overlapping for n < 32.
+    uint64_t h = n * kPrime64_1;
+    h += Mix16(data, kSecret[0], kSecret[1], seed);
+    h += Mix16(data + n - 16, kSecret[2], kSecret[3], seed);
+    return Avalanche(h);
+  }
+  if (n <= 128) {
+    // 16-byte mixes from both ends toward the middle.
+    uint64_t h = n * kPrime64_1;
+    for (size_t i = 0; 16 * i < n; i += 2) {
+      h += Mix16(data + 16 * (i / 2), kSecret[i % 8], kSecret[(i + 1) % 8],
+                 seed);
+      h += Mix16(data + n - 16 * (i / 2 + 1), kSecret[(i + 2) % 8],
+                 kSecret[(i + 3) % 8], seed);
+    }
+    return Avalanche(h);
+  }
+  return HashLong(data, n, seed);
+}
+
+namespace internal {
+
+uint64_t Hash64LongScalar(const char* data, size_t n, uint64_t seed) {
+  assert(n > 128 && "the long-input loop only runs for n > 128");
+  return HashLongScalar(data, n, seed);
+}
+
+bool Hash64LongUsesAvx2() {
+#ifdef TFRT_HASH_HAS_AVX2_PATH
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+}  // namespace internal
+
 }  // namespace tfrt
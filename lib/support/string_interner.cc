@@ -0,0 +1,74 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- string_interner.cc -------------------------------------------------===//
+//
+// This file implements the process-wide name intern table.
+//
+//===----------------------------------------------------------------------===//
+#include "tfrt/support/string_interner.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace tfrt {
+
+StringInterner& StringInterner::Global() {
+  static StringInterner* interner = new StringInterner();
+  return *interner;
+}
+
+InternedName StringInterner::Intern(string_view str) {
+  mutex_lock lock(mu_);
+  auto it = names_.find(str);
+  if (it != names_.end()) return it->second;
+
+  assert(str.size() <= ~uint32_t{0} && "name too long to intern");
+  assert(by_id_.size() < ~uint32_t{0} && "intern table id space exhausted");
+
+  // Lay out the header followed by the null terminated characters; the name
+  // handle points at the characters (see InternedName::header).
+  auto* header = static_cast<InternedName::Header*>(allocator_.Allocate(
+      sizeof(InternedName::Header) + str.size() + 1,
+      alignof(InternedName::Header)));
+  header->id = by_id_.size();
+  header->size = str.size();
+  char* chars = reinterpret_cast<char*>(header + 1);
+  memcpy(chars, str.data(), str.size());
+  chars[str.size()] = '\0';
+
+  InternedName name(chars);
+  names_.emplace(name.str(), name);
+  by_id_.push_back(name);
+  return name;
+}
+
+InternedName StringInterner::Find(string_view str) const {
+  mutex_lock lock(mu_);
+  auto it = names_.find(str);
+  return it == names_.end() ? InternedName() : it->second;
+}
+
+InternedName StringInterner::FromId(uint32_t id) const {
+  mutex_lock lock(mu_);
+  assert(id < by_id_.size() && "id was not produced by this interner");
+  return by_id_[id];
+}
+
+size_t StringInterner::size() const {
+  mutex_lock lock(mu_);
+  return by_id_.size();
+}
+
+}  // namespace tfrt
@@ -51,6 +51,8 @@ raw_ostream& operator<<(raw_ostream& os, const TensorLayout& layout) {
       return os << "Row-Major Dense tensor";
     case TensorLayout::kCOO_EXPERIMENTAL:
       return os << "COOrdinate list sparse tensor";
+    case TensorLayout::kRMD_DEFLATE:
+      return os << "Row-Major Dense tensor, deflate-compressed frames";
   }
   return os << "Unknown";
 }
@@ -0,0 +1,457 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- btf_streaming_reader.cc --------------------------------------------===//
+//
+// This file implements BtfStreamingReader.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/btf_streaming_reader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+#include "llvm/Support/MemoryBuffer.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/error_util.h"
+#include "tfrt/support/latch.h"
+#include "tfrt/support/mutex.h"
+#include "zlib.h"
+#include "tfrt/tensor/btf.h"
+#include "tfrt/tensor/tensor_metadata.h"
+#include "tfrt/tensor/tensor_shape.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define TFRT_BTF_HAS_MADVISE 1
+#endif
+
+namespace tfrt {
+namespace {
+
+#ifdef TFRT_BTF_HAS_MADVISE
+// How much file data is asked from the OS ahead of a sequential scan. Regions
+// more than one window behind the scan position are released again, so the
+// reader's resident set stays around twice this size regardless of file size.
+constexpr size_t kReadaheadBytes = 16 << 20;
+
+// Applies `advice` to the [begin, end) byte range of the mapping rooted at
+// `base`, widened to page boundaries. `base` is page aligned because it comes
+// from mmap.
+void MadviseRange(const void* base, size_t begin, size_t end, int advice) {
+  static const size_t kPageSize = sysconf(_SC_PAGESIZE);
+  begin = begin & ~(kPageSize - 1);
+  end = (end + kPageSize - 1) & ~(kPageSize - 1);
+  if (begin >= end) return;
+  auto* ptr = const_cast<char*>(static_cast<const char*>(base)) + begin;
+  // Readahead is best effort; a failure just loses the hint.
+  madvise(ptr, end - begin, advice);
+}
+#endif
+
+Expected<DType> ToDType(btf::TensorDType dtype) {
+  switch (dtype) {
+    case btf::TensorDType::kInt8:
+      return DType(DType::I8);
+    case btf::TensorDType::kInt16:
+      return DType(DType::I16);
+    case btf::TensorDType::kInt32:
+      return DType(DType::I32);
+    case btf::TensorDType::kInt64:
+      return DType(DType::I64);
+    case btf::TensorDType::kFloat32:
+      return DType(DType::F32);
+    case btf::TensorDType::kFloat64:
+      return DType(DType::F64);
+    case btf::TensorDType::kUInt8:
+      return DType(DType::UI8);
+  }
+  return MakeStringError("unknown tensor dtype in btf header");
+}
+
+}  // namespace
+
+// State shared between the reader and its background prefetch task. The task
+// holds its own reference to the file mapping, so the mapping stays valid
+// even if the reader is destroyed while the task is still running; Stop()
+// wakes the task so it retires promptly in that case.
+class BtfStreamingReader::PrefetchState {
+ public:
+  PrefetchState(RCReference<HostBuffer> file,
+                std::vector<std::pair<uint64_t, uint64_t>> plan)
+      : file_(std::move(file)), plan_(std::move(plan)) {}
+
+  // Called by ReadDenseTensor with the byte size of the record it handed
+  // out; actual consumption is what paces the prefetcher.
+  void OnConsumed(size_t bytes) {
+    {
+      mutex_lock lock(mu_);
+      consumed_bytes_ += bytes;
+    }
+    cv_.notify_one();
+  }
+
+  void Stop() {
+    {
+      mutex_lock lock(mu_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+  }
+
+  // The body of the background task: walk the plan in order, blocking
+  // whenever a full readahead window of prefetched-but-unconsumed bytes is
+  // already in flight.
+  void Run() {
+#ifdef TFRT_BTF_HAS_MADVISE
+    const void* data = file_->data();
+    uint64_t prefetched_bytes = 0;
+    for (const auto& range : plan_) {
+      {
+        mutex_lock lock(mu_);
+        cv_.wait(lock, [&] {
+          return stop_ || prefetched_bytes < consumed_bytes_ + kReadaheadBytes;
+        });
+        if (stop_) return;
+      }
+      MadviseRange(data, range.first, range.second, MADV_WILLNEED);
+      prefetched_bytes += range.second - range.first;
+    }
+#endif
+  }
+
+ private:
+  const RCReference<HostBuffer> file_;
+  // The planned records as [begin, end) byte ranges, in prefetch order.
+  const std::vector<std::pair<uint64_t, uint64_t>> plan_;
+
+  mutex mu_;
+  condition_variable cv_;
+  uint64_t consumed_bytes_ TFRT_GUARDED_BY(mu_) = 0;
+  bool stop_ TFRT_GUARDED_BY(mu_) = false;
+};
+
+Expected<BtfStreamingReader> BtfStreamingReader::Open(string_view path) {
+  auto buffer = llvm::MemoryBuffer::getFile(path, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!buffer) {
+    return MakeStringError("failed to open file ", path, " for reading");
+  }
+  auto file = HostBuffer::CreateFromExternal(std::move(*buffer));
+
+  const char* data = static_cast<const char*>(file->data());
+  const size_t file_size = file->size();
+
+  uint64_t num_tensors;
+  if (file_size < sizeof(uint64_t)) {
+    return MakeStringError("failed to read tensor num_tensors from path ",
+                           path);
+  }
+  std::memcpy(&num_tensors, data, sizeof(uint64_t));
+
+  // Files written in streaming append mode keep their index in a footer and
+  // start with a marker pointing at it (see kFooterIndexMarker in btf.h).
+  size_t index_begin = sizeof(uint64_t);
+  size_t records_end = file_size;
+  if (num_tensors == btf::kFooterIndexMarker) {
+    uint64_t footer_offset;
+    if (file_size < 2 * sizeof(uint64_t)) {
+      return MakeStringError("failed to read btf footer offset from path ",
+                             path);
+    }
+    std::memcpy(&footer_offset, data + sizeof(uint64_t), sizeof(uint64_t));
+    if (footer_offset < 2 * sizeof(uint64_t) ||
+        footer_offset > file_size - sizeof(uint64_t)) {
+      return MakeStringError("btf footer offset out of range in ", path);
+    }
+    std::memcpy(&num_tensors, data + footer_offset, sizeof(uint64_t));
+    index_begin = footer_offset + sizeof(uint64_t);
+    records_end = footer_offset;
+  }
+
+  if (num_tensors > (file_size - index_begin) / sizeof(uint64_t)) {
+    return MakeStringError("btf file ", path,
+                           " is too short for its offset table");
+  }
+  std::vector<uint64_t> offsets(num_tensors);
+  std::memcpy(offsets.data(), data + index_begin,
+              sizeof(uint64_t) * num_tensors);
+
+#ifdef TFRT_BTF_HAS_MADVISE
+  // A front to back scan is the common access pattern for data set files.
+  MadviseRange(data, 0, file_size, MADV_SEQUENTIAL);
+#endif
+
+  return BtfStreamingReader(std::move(file), std::move(offsets), records_end);
+}
+
+BtfStreamingReader& BtfStreamingReader::operator=(BtfStreamingReader&& other) {
+  if (this != &other) {
+    if (prefetch_state_) prefetch_state_->Stop();
+    file_ = std::move(other.file_);
+    offsets_ = std::move(other.offsets_);
+    records_end_ = other.records_end_;
+    released_end_ = other.released_end_;
+    prefetch_state_ = std::move(other.prefetch_state_);
+  }
+  return *this;
+}
+
+BtfStreamingReader::~BtfStreamingReader() {
+  // Wake a prefetch task that is waiting on consumption that will never
+  // come; it holds its own reference to the file mapping.
+  if (prefetch_state_) prefetch_state_->Stop();
+}
+
+void BtfStreamingReader::StartPrefetch(std::vector<size_t> order,
+                                       HostContext* host) {
+#ifdef TFRT_BTF_HAS_MADVISE
+  assert(!prefetch_state_ && "prefetch already started");
+
+  // Map each planned record to its byte range. Records are contiguous in
+  // file order, so a record ends where the next one (by offset) begins, and
+  // the last one ends at the index.
+  std::vector<uint64_t> ends(offsets_.begin(), offsets_.end());
+  std::sort(ends.begin(), ends.end());
+  std::vector<std::pair<uint64_t, uint64_t>> plan;
+  plan.reserve(order.size());
+  for (size_t index : order) {
+    if (index >= offsets_.size()) continue;
+    const uint64_t begin = offsets_[index];
+    auto next = std::upper_bound(ends.begin(), ends.end(), begin);
+    const uint64_t end = next != ends.end() ? *next : records_end_;
+    plan.emplace_back(begin, end);
+  }
+
+  auto state = std::make_shared<PrefetchState>(file_.CopyRef(),
+                                               std::move(plan));
+  // The task blocks while it is a full window ahead of the consumer, so it
+  // belongs on the blocking work queue, not a kernel thread.
+  if (host->EnqueueBlockingWork([state] { state->Run(); })) {
+    prefetch_state_ = std::move(state);
+  }
+#else
+  (void)order;
+  (void)host;
+#endif
+}
+
+Expected<DenseHostTensor> BtfStreamingReader::ReadDenseTensor(
+    size_t index, HostContext* host) {
+  if (index >= offsets_.size()) {
+    return MakeStringError("invalid tensor index ", index,
+                           " for btf file which contains ", offsets_.size(),
+                           " tensors");
+  }
+  const char* data = static_cast<const char*>(file_->data());
+  const size_t file_size = file_->size();
+  const size_t offset = offsets_[index];
+
+  if (offset > file_size || file_size - offset < sizeof(btf::TensorHeader)) {
+    return MakeStringError(
+        "failed to read tensor header from mapped file at offset ", offset);
+  }
+  btf::TensorHeader header;
+  std::memcpy(&header, data + offset, sizeof(header));
+
+  if (header.layout != btf::TensorLayout::kRMD &&
+      header.layout != btf::TensorLayout::kRMD_DEFLATE) {
+    return MakeStringError("unexpected tensor layout ", header.layout);
+  }
+  auto dtype = ToDType(header.dtype);
+  if (!dtype) return dtype.takeError();
+
+  const size_t dims_offset = offset + sizeof(btf::TensorHeader);
+  if (header.rank > (file_size - dims_offset) / sizeof(uint64_t)) {
+    return MakeStringError("failed to read tensor dims at offset ", offset);
+  }
+  SmallVector<ssize_t, 4> dims;
+  dims.reserve(header.rank);
+  for (uint64_t i = 0; i != header.rank; ++i) {
+    uint64_t dim;
+    std::memcpy(&dim, data + dims_offset + i * sizeof(uint64_t), sizeof(dim));
+    dims.push_back(dim);
+  }
+  TensorMetadata metadata(*dtype, TensorShape(dims));
+
+  const size_t data_offset = dims_offset + header.rank * sizeof(uint64_t);
+  if (header.layout == btf::TensorLayout::kRMD_DEFLATE) {
+    return ReadDeflateRecord(offset, data_offset, metadata, host);
+  }
+  const size_t data_size = metadata.GetHostSizeInBytes();
+  if (data_size > file_size - data_offset) {
+    return MakeStringError(
+        "failed to read tensor data from mapped file at offset ", offset);
+  }
+
+  if (prefetch_state_) {
+    // A planned prefetcher is pacing itself by actual consumption; the
+    // position-based readahead below assumes a sequential scan and would
+    // fight it.
+    prefetch_state_->OnConsumed(data_offset + data_size - offset);
+  } else {
+    IssueReadahead(offset, data_offset + data_size);
+  }
+
+  const char* tensor_data = data + data_offset;
+  if (reinterpret_cast<uintptr_t>(tensor_data) % dtype->GetHostAlignment() ==
+      0) {
+    return DenseHostTensor(
+        metadata,
+        HostBuffer::CreateFromParent(file_.CopyRef(), data_offset, data_size));
+  }
+
+  // The record's data is misaligned for its dtype, so aliasing the mapping
+  // would hand out a misaligned tensor. Fall back to copying.
+  auto dht = DenseHostTensor::CreateUninitialized(metadata, host);
+  if (!dht) {
+    return MakeStringError("cannot allocate result tensor");
+  }
+  std::memcpy(dht->data(), tensor_data, data_size);
+  return std::move(*dht);
+}
+
+Expected<DenseHostTensor> BtfStreamingReader::ReadDeflateRecord(
+    size_t record_begin, size_t index_offset, const TensorMetadata& metadata,
+    HostContext* host) {
+  const char* data = static_cast<const char*>(file_->data());
+  const size_t file_size = file_->size();
+
+  if (file_size - index_offset < 2 * sizeof(uint64_t)) {
+    return MakeStringError(
+        "failed to read compressed frame index at offset ", record_begin);
+  }
+  uint64_t num_frames;
+  uint64_t frame_bytes;
+  std::memcpy(&num_frames, data + index_offset, sizeof(uint64_t));
+  std::memcpy(&frame_bytes, data + index_offset + sizeof(uint64_t),
+              sizeof(uint64_t));
+
+  const size_t sizes_offset = index_offset + 2 * sizeof(uint64_t);
+  if (num_frames > (file_size - sizes_offset) / sizeof(uint64_t)) {
+    return MakeStringError(
+        "failed to read compressed frame sizes at offset ", record_begin);
+  }
+  std::vector<uint64_t> compressed_sizes(num_frames);
+  std::memcpy(compressed_sizes.data(), data + sizes_offset,
+              sizeof(uint64_t) * num_frames);
+
+  // The frame count must match the payload size the dims imply; a mismatch
+  // means a corrupted or truncated record.
+  const uint64_t payload_size = metadata.GetHostSizeInBytes();
+  const uint64_t expected_frames =
+      payload_size == 0 || frame_bytes == 0
+          ? 0
+          : (payload_size + frame_bytes - 1) / frame_bytes;
+  if (num_frames != expected_frames || (payload_size != 0 && num_frames == 0)) {
+    return MakeStringError("corrupted compressed tensor record at offset ",
+                           record_begin);
+  }
+
+  // Frames are stored back to back after the size table.
+  const size_t frames_begin = sizes_offset + sizeof(uint64_t) * num_frames;
+  std::vector<uint64_t> frame_offsets(num_frames);
+  uint64_t total_compressed = 0;
+  for (uint64_t i = 0; i != num_frames; ++i) {
+    frame_offsets[i] = frames_begin + total_compressed;
+    if (compressed_sizes[i] > file_size - frames_begin - total_compressed) {
+      return MakeStringError("compressed frame out of range at offset ",
+                             record_begin);
+    }
+    total_compressed += compressed_sizes[i];
+  }
+
+  if (prefetch_state_) {
+    prefetch_state_->OnConsumed(frames_begin + total_compressed -
+                                record_begin);
+  } else {
+    IssueReadahead(record_begin, frames_begin + total_compressed);
+  }
+
+  auto dht = DenseHostTensor::CreateUninitialized(metadata, host);
+  if (!dht) {
+    return MakeStringError("cannot allocate result tensor");
+  }
+  if (num_frames == 0) return std::move(*dht);
+
+  // Decompress the frames in parallel: frames 1..n-1 fan out to the blocking
+  // work queue while this thread takes frame 0, then everyone meets at the
+  // latch. Inflate is CPU bound, but the tasks also fault in cold file pages,
+  // so they belong on the blocking queue rather than kernel threads.
+  auto* dest = static_cast<char*>(dht->data());
+  std::atomic<bool> failed{false};
+  auto decompress_frame = [&](uint64_t i) {
+    const uint64_t begin = i * frame_bytes;
+    uLongf dest_len = std::min(frame_bytes, payload_size - begin);
+    const uLongf expected_len = dest_len;
+    if (uncompress(reinterpret_cast<Bytef*>(dest + begin), &dest_len,
+                   reinterpret_cast<const Bytef*>(data + frame_offsets[i]),
+                   compressed_sizes[i]) != Z_OK ||
+        dest_len != expected_len) {
+      failed.store(true, std::memory_order_relaxed);
+    }
+  };
+  latch done(num_frames - 1);
+  for (uint64_t i = 1; i != num_frames; ++i) {
+    bool enqueued = host->EnqueueBlockingWork([&, i] {
+      decompress_frame(i);
+      done.count_down();
+    });
+    if (!enqueued) {
+      // The blocking queue is saturated; do the frame here rather than fail.
+      decompress_frame(i);
+      done.count_down();
+    }
+  }
+  decompress_frame(0);
+  done.wait();
+
+  if (failed.load(std::memory_order_relaxed)) {
+    return MakeStringError("failed to decompress tensor record at offset ",
+                           record_begin);
+  }
+  return std::move(*dht);
+}
+
+void BtfStreamingReader::IssueReadahead(size_t record_begin,
+                                        size_t record_end) {
+#ifdef TFRT_BTF_HAS_MADVISE
+  const char* data = static_cast<const char*>(file_->data());
+  // Start faulting in the window after this record so a sequential scan
+  // overlaps disk reads with compute.
+  MadviseRange(data, record_end,
+               std::min(record_end + kReadaheadBytes, file_->size()),
+               MADV_WILLNEED);
+  // Release regions a full window behind the scan position so the resident
+  // set stays bounded. The pages are backed by the read-only file mapping, so
+  // this is safe even for tensors still aliasing a released region: the OS
+  // faults the pages back in from the file on the next access.
+  if (record_begin > kReadaheadBytes) {
+    size_t release_end = record_begin - kReadaheadBytes;
+    if (release_end > released_end_) {
+      MadviseRange(data, released_end_, release_end, MADV_DONTNEED);
+      released_end_ = release_end;
+    }
+  }
+#else
+  (void)record_begin;
+  (void)record_end;
+#endif
+}
+
+}  // namespace tfrt
@@ -0,0 +1,371 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- btf_writer.cc ------------------------------------------------------===//
+//
+// This file implements the parallel BTF writer.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/btf_writer.h"
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+#include "llvm/ADT/FunctionExtras.h"
+#include "llvm/Support/Error.h"
+#include "zlib.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/error_util.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/string_util.h"
+#include "tfrt/tensor/btf.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#define TFRT_BTF_HAS_PWRITE 1
+#endif
+
+namespace tfrt {
+namespace {
+
+Expected<btf::TensorDType> ToTensorDType(DType dtype) {
+  switch (dtype.kind()) {
+    case DType::I8:
+      return btf::TensorDType::kInt8;
+    case DType::I16:
+      return btf::TensorDType::kInt16;
+    case DType::I32:
+      return btf::TensorDType::kInt32;
+    case DType::I64:
+      return btf::TensorDType::kInt64;
+    case DType::F32:
+      return btf::TensorDType::kFloat32;
+    case DType::F64:
+      return btf::TensorDType::kFloat64;
+    case DType::UI8:
+      return btf::TensorDType::kUInt8;
+    default:
+      return MakeStringError("dtype ", dtype, " is not representable in btf");
+  }
+}
+
+btf::TensorHeader MakeHeader(const DenseHostTensor& dht,
+                             btf::TensorDType dtype) {
+  btf::TensorHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.rank = dht.shape().GetRank();
+  header.dtype = dtype;
+  header.layout = btf::TensorLayout::kRMD;
+  return header;
+}
+
+SmallVector<uint64_t, 4> GetDims(const DenseHostTensor& dht) {
+  SmallVector<uint64_t, 4> dims;
+  for (int i = 0, e = dht.shape().GetRank(); i != e; ++i) {
+    dims.push_back(dht.shape().GetDimensionSize(i));
+  }
+  return dims;
+}
+
+#ifdef TFRT_BTF_HAS_PWRITE
+
+// Writes all of [data, data + size) at `offset`, retrying partial writes.
+bool PwriteAll(int fd, const void* data, size_t size, uint64_t offset) {
+  const char* ptr = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t written = pwrite(fd, ptr, size, offset);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    ptr += written;
+    offset += written;
+    size -= written;
+  }
+  return true;
+}
+
+// State shared by the concurrent write tasks of one WriteTensorsToBTF call.
+struct ParallelWriteState {
+  int fd;
+  std::atomic<size_t> remaining;
+  AsyncValueRef<Chain> chain;
+  mutex mu;
+  std::string first_error TFRT_GUARDED_BY(mu);
+
+  void RecordError(std::string message) {
+    mutex_lock lock(mu);
+    if (first_error.empty()) first_error = std::move(message);
+  }
+
+  // Called once per write task; the last call closes the file and resolves
+  // the chain.
+  void CompleteOne() {
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    close(fd);
+    mutex_lock lock(mu);
+    if (first_error.empty()) {
+      chain.emplace();
+    } else {
+      chain.SetError(first_error);
+    }
+  }
+};
+
+#endif  // TFRT_BTF_HAS_PWRITE
+
+}  // namespace
+
+AsyncValueRef<Chain> WriteTensorsToBTF(std::vector<DenseHostTensor> tensors,
+                                       std::string path, HostContext* host) {
+  // Compute every record's position from metadata alone, so the payload
+  // writes below are independent of each other.
+  const uint64_t num_tensors = tensors.size();
+  std::vector<uint64_t> offsets(num_tensors);
+  std::vector<btf::TensorDType> dtypes(num_tensors);
+  uint64_t offset = sizeof(uint64_t) * (num_tensors + 1);
+  for (size_t i = 0; i != num_tensors; ++i) {
+    auto dtype = ToTensorDType(tensors[i].dtype());
+    if (!dtype) {
+      return host->MakeErrorAsyncValueRef(llvm::toString(dtype.takeError()));
+    }
+    dtypes[i] = *dtype;
+    offsets[i] = offset;
+    offset += sizeof(btf::TensorHeader) +
+              tensors[i].shape().GetRank() * sizeof(uint64_t) +
+              tensors[i].metadata().GetHostSizeInBytes();
+  }
+  const uint64_t file_size = offset;
+
+#ifdef TFRT_BTF_HAS_PWRITE
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return host->MakeErrorAsyncValueRef(
+        StrCat("failed to open file ", path, " for writing"));
+  }
+  if (ftruncate(fd, file_size) != 0) {
+    close(fd);
+    return host->MakeErrorAsyncValueRef(
+        StrCat("failed to size file ", path, " to ", file_size, " bytes"));
+  }
+
+  auto state = std::make_shared<ParallelWriteState>();
+  state->fd = fd;
+  state->remaining = num_tensors + 1;
+  state->chain = host->MakeUnconstructedAsyncValueRef<Chain>();
+  auto chain = state->chain.CopyRef();
+
+  auto enqueue = [&](llvm::unique_function<void()> work) {
+    if (!host->EnqueueBlockingWork(std::move(work))) {
+      state->RecordError("failed to enqueue blocking work");
+      state->CompleteOne();
+    }
+  };
+
+  // One task for the offset table, one per tensor payload.
+  {
+    std::vector<uint64_t> index;
+    index.reserve(num_tensors + 1);
+    index.push_back(num_tensors);
+    index.insert(index.end(), offsets.begin(), offsets.end());
+    enqueue([state, index = std::move(index)] {
+      if (!PwriteAll(state->fd, index.data(), index.size() * sizeof(uint64_t),
+                     0)) {
+        state->RecordError("failed to write btf offset table");
+      }
+      state->CompleteOne();
+    });
+  }
+
+  for (size_t i = 0; i != num_tensors; ++i) {
+    enqueue([state, tensor = std::move(tensors[i]), dtype = dtypes[i],
+             record_offset = offsets[i]] {
+      btf::TensorHeader header = MakeHeader(tensor, dtype);
+      SmallVector<uint64_t, 4> dims = GetDims(tensor);
+      const uint64_t dims_offset = record_offset + sizeof(header);
+      const uint64_t data_offset =
+          dims_offset + dims.size() * sizeof(uint64_t);
+      // The payload goes straight from the tensor's buffer into the file;
+      // there is no staging copy.
+      bool ok =
+          PwriteAll(state->fd, &header, sizeof(header), record_offset) &&
+          PwriteAll(state->fd, dims.data(), dims.size() * sizeof(uint64_t),
+                    dims_offset) &&
+          PwriteAll(state->fd, tensor.data(),
+                    tensor.metadata().GetHostSizeInBytes(), data_offset);
+      if (!ok) state->RecordError("failed to write tensor data");
+      state->CompleteOne();
+    });
+  }
+
+  return chain;
+#else
+  // This platform has no pwrite, so fall back to one sequential writer task.
+  (void)file_size;
+  return host->EnqueueBlockingWork(
+      [tensors = std::move(tensors), path = std::move(path),
+       offsets = std::move(offsets), dtypes = std::move(dtypes),
+       num_tensors]() -> Expected<Chain> {
+        std::ofstream out(path, std::ios_base::binary | std::ios_base::trunc);
+        if (!out) {
+          return MakeStringError("failed to open file ", path, " for writing");
+        }
+        auto write = [&](const void* data, size_t size) {
+          out.write(static_cast<const char*>(data), size);
+        };
+        write(&num_tensors, sizeof(uint64_t));
+        write(offsets.data(), offsets.size() * sizeof(uint64_t));
+        for (size_t i = 0; i != tensors.size(); ++i) {
+          btf::TensorHeader header = MakeHeader(tensors[i], dtypes[i]);
+          SmallVector<uint64_t, 4> dims = GetDims(tensors[i]);
+          write(&header, sizeof(header));
+          write(dims.data(), dims.size() * sizeof(uint64_t));
+          write(tensors[i].data(),
+                tensors[i].metadata().GetHostSizeInBytes());
+        }
+        out.flush();
+        if (!out) {
+          return MakeStringError("failed to write tensor data to ", path);
+        }
+        return Chain();
+      });
+#endif
+}
+
+Expected<BtfStreamWriter> BtfStreamWriter::Create(std::string path) {
+  std::ofstream out(path, std::ios_base::binary | std::ios_base::trunc);
+  if (!out) {
+    return MakeStringError("failed to open file ", path, " for writing");
+  }
+  // Reserve the two-word header: the marker now, the footer offset
+  // backpatched by Finish().
+  const uint64_t header[2] = {btf::kFooterIndexMarker, 0};
+  out.write(reinterpret_cast<const char*>(header), sizeof(header));
+  if (!out) {
+    return MakeStringError("failed to write btf header to ", path);
+  }
+  return BtfStreamWriter(std::move(out), std::move(path));
+}
+
+llvm::Error BtfStreamWriter::AppendTensor(const DenseHostTensor& dht) {
+  assert(!finished_ && "AppendTensor called after Finish");
+  auto dtype = ToTensorDType(dht.dtype());
+  if (!dtype) return dtype.takeError();
+
+  offsets_.push_back(static_cast<uint64_t>(out_.tellp()));
+  btf::TensorHeader header = MakeHeader(dht, *dtype);
+  SmallVector<uint64_t, 4> dims = GetDims(dht);
+  out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out_.write(reinterpret_cast<const char*>(dims.data()),
+             dims.size() * sizeof(uint64_t));
+  // The payload goes straight from the tensor's buffer into the stream;
+  // there is no staging copy.
+  out_.write(static_cast<const char*>(dht.data()),
+             dht.metadata().GetHostSizeInBytes());
+  if (!out_) {
+    return MakeStringError("failed to append tensor to ", path_);
+  }
+  return llvm::Error::success();
+}
+
+llvm::Error BtfStreamWriter::AppendTensorCompressed(
+    const DenseHostTensor& dht) {
+  assert(!finished_ && "AppendTensorCompressed called after Finish");
+  auto dtype = ToTensorDType(dht.dtype());
+  if (!dtype) return dtype.takeError();
+
+  const char* payload = static_cast<const char*>(dht.data());
+  const uint64_t payload_size = dht.metadata().GetHostSizeInBytes();
+  const uint64_t frame_bytes = btf::kCompressedFrameBytes;
+  const uint64_t num_frames =
+      payload_size == 0 ? 0 : (payload_size + frame_bytes - 1) / frame_bytes;
+
+  offsets_.push_back(static_cast<uint64_t>(out_.tellp()));
+  btf::TensorHeader header = MakeHeader(dht, *dtype);
+  header.layout = btf::TensorLayout::kRMD_DEFLATE;
+  SmallVector<uint64_t, 4> dims = GetDims(dht);
+  out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out_.write(reinterpret_cast<const char*>(dims.data()),
+             dims.size() * sizeof(uint64_t));
+  out_.write(reinterpret_cast<const char*>(&num_frames), sizeof(uint64_t));
+  out_.write(reinterpret_cast<const char*>(&frame_bytes), sizeof(uint64_t));
+
+  // The compressed sizes are not known until the frames are compressed, so
+  // reserve the size table now and backpatch it once the frames are out.
+  const uint64_t size_table_pos = static_cast<uint64_t>(out_.tellp());
+  std::vector<uint64_t> compressed_sizes(num_frames, 0);
+  out_.write(reinterpret_cast<const char*>(compressed_sizes.data()),
+             num_frames * sizeof(uint64_t));
+
+  // Frames compress one at a time through one frame-sized scratch buffer;
+  // the record's memory overhead does not grow with the tensor.
+  std::vector<unsigned char> scratch;
+  if (num_frames != 0) {
+    scratch.resize(compressBound(
+        static_cast<uLong>(std::min(payload_size, frame_bytes))));
+  }
+  for (uint64_t i = 0; i != num_frames; ++i) {
+    const uint64_t begin = i * frame_bytes;
+    const uLong src_len =
+        static_cast<uLong>(std::min(frame_bytes, payload_size - begin));
+    uLongf dest_len = scratch.size();
+    if (compress2(scratch.data(), &dest_len,
+                  reinterpret_cast<const Bytef*>(payload + begin), src_len,
+                  Z_DEFAULT_COMPRESSION) != Z_OK) {
+      return MakeStringError("failed to compress tensor frame for ", path_);
+    }
+    out_.write(reinterpret_cast<const char*>(scratch.data()), dest_len);
+    compressed_sizes[i] = dest_len;
+  }
+
+  const uint64_t record_end = static_cast<uint64_t>(out_.tellp());
+  out_.seekp(size_table_pos);
+  out_.write(reinterpret_cast<const char*>(compressed_sizes.data()),
+             num_frames * sizeof(uint64_t));
+  out_.seekp(record_end);
+  if (!out_) {
+    return MakeStringError("failed to append compressed tensor to ", path_);
+  }
+  return llvm::Error::success();
+}
+
+llvm::Error BtfStreamWriter::Finish() {
+  assert(!finished_ && "Finish called twice");
+  finished_ = true;
+
+  const uint64_t footer_offset = static_cast<uint64_t>(out_.tellp());
+  const uint64_t num_tensors = offsets_.size();
+  out_.write(reinterpret_cast<const char*>(&num_tensors), sizeof(uint64_t));
+  out_.write(reinterpret_cast<const char*>(offsets_.data()),
+             offsets_.size() * sizeof(uint64_t));
+
+  // Point the header at the footer index. Readers reject the file until
+  // this word is in place, so a crash mid-write never yields a file that
+  // parses as a truncated checkpoint.
+  out_.seekp(sizeof(uint64_t));
+  out_.write(reinterpret_cast<const char*>(&footer_offset), sizeof(uint64_t));
+  out_.flush();
+  if (!out_) {
+    return MakeStringError("failed to write btf footer index to ", path_);
+  }
+  out_.close();
+  return llvm::Error::success();
+}
+
+}  // namespace tfrt
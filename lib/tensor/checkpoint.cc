@@ -0,0 +1,334 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- checkpoint.cc ------------------------------------------------------===//
+//
+// This file implements parallel multi-file checkpoint save and restore.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/checkpoint.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+#include "llvm/ADT/Optional.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/error_util.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/string_util.h"
+#include "tfrt/tensor/btf.h"
+#include "tfrt/tensor/btf_writer.h"
+#include "tfrt/tensor/tensor_metadata.h"
+#include "tfrt/tensor/tensor_shape.h"
+
+namespace tfrt {
+namespace {
+
+// The manifest ties the shards together. Its on-disk format is
+//   <num_shards:u64><num_tensors:u64>
+// followed by a <shard:u64><record:u64> pair per tensor, in save order:
+// tensor i of the checkpoint is record `record` of shard `shard`.
+
+Expected<DType> ToDType(btf::TensorDType dtype) {
+  switch (dtype) {
+    case btf::TensorDType::kInt8:
+      return DType(DType::I8);
+    case btf::TensorDType::kInt16:
+      return DType(DType::I16);
+    case btf::TensorDType::kInt32:
+      return DType(DType::I32);
+    case btf::TensorDType::kInt64:
+      return DType(DType::I64);
+    case btf::TensorDType::kFloat32:
+      return DType(DType::F32);
+    case btf::TensorDType::kFloat64:
+      return DType(DType::F64);
+    case btf::TensorDType::kUInt8:
+      return DType(DType::UI8);
+  }
+  return MakeStringError("unknown tensor dtype in btf header");
+}
+
+// State shared by the concurrent shard read tasks of one RestoreCheckpoint
+// call. Every slot is written by exactly one task, so only the error string
+// needs a lock.
+struct RestoreState {
+  std::atomic<size_t> remaining;
+  AsyncValueRef<std::vector<DenseHostTensor>> result;
+  std::vector<llvm::Optional<DenseHostTensor>> slots;
+  mutex mu;
+  std::string first_error TFRT_GUARDED_BY(mu);
+
+  void RecordError(std::string message) {
+    mutex_lock lock(mu);
+    if (first_error.empty()) first_error = std::move(message);
+  }
+
+  // Called once per shard task; the last call resolves the result.
+  void CompleteOne() {
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    mutex_lock lock(mu);
+    if (!first_error.empty()) {
+      result.SetError(first_error);
+      return;
+    }
+    std::vector<DenseHostTensor> tensors;
+    tensors.reserve(slots.size());
+    for (auto& slot : slots) tensors.push_back(std::move(*slot));
+    result.emplace(std::move(tensors));
+  }
+};
+
+// Reads every record of the shard at `path` into the result slots named by
+// `original_indices` (record j of the shard is checkpoint tensor
+// original_indices[j]).
+llvm::Error ReadShardIntoSlots(
+    const std::string& path, const std::vector<size_t>& original_indices,
+    std::vector<llvm::Optional<DenseHostTensor>>* slots, HostContext* host) {
+  std::ifstream in(path, std::ios_base::binary);
+  if (!in) {
+    return MakeStringError("failed to open checkpoint shard ", path);
+  }
+  in.seekg(0, std::ios_base::end);
+  const uint64_t file_size = in.tellg();
+  in.seekg(0);
+  auto read = [&](void* dst, size_t size) {
+    return static_cast<bool>(in.read(static_cast<char*>(dst), size));
+  };
+
+  // Shards are written by WriteTensorsToBTF, so the index is at the head.
+  uint64_t num_tensors;
+  if (!read(&num_tensors, sizeof(uint64_t))) {
+    return MakeStringError("failed to read shard index from ", path);
+  }
+  if (num_tensors != original_indices.size()) {
+    return MakeStringError("checkpoint shard ", path, " holds ", num_tensors,
+                           " tensors but the manifest expects ",
+                           original_indices.size());
+  }
+  std::vector<uint64_t> offsets(num_tensors);
+  if (!read(offsets.data(), num_tensors * sizeof(uint64_t))) {
+    return MakeStringError("failed to read shard index from ", path);
+  }
+
+  for (uint64_t j = 0; j != num_tensors; ++j) {
+    in.seekg(offsets[j]);
+    btf::TensorHeader header;
+    if (!read(&header, sizeof(header))) {
+      return MakeStringError("failed to read tensor header from ", path);
+    }
+    if (header.layout != btf::TensorLayout::kRMD) {
+      return MakeStringError("unexpected tensor layout ", header.layout);
+    }
+    auto dtype = ToDType(header.dtype);
+    if (!dtype) return dtype.takeError();
+
+    if (header.rank > file_size / sizeof(uint64_t)) {
+      return MakeStringError("failed to read tensor dims from ", path);
+    }
+    SmallVector<uint64_t, 4> raw_dims(header.rank);
+    if (!read(raw_dims.data(), header.rank * sizeof(uint64_t))) {
+      return MakeStringError("failed to read tensor dims from ", path);
+    }
+    SmallVector<ssize_t, 4> dims(raw_dims.begin(), raw_dims.end());
+    TensorMetadata metadata(*dtype, TensorShape(dims));
+
+    auto dht = DenseHostTensor::CreateUninitialized(metadata, host);
+    if (!dht) {
+      return MakeStringError("cannot allocate result tensor");
+    }
+    // The payload reads straight into the tensor's final buffer; there is
+    // no staging copy.
+    if (!read(dht->data(), metadata.GetHostSizeInBytes())) {
+      return MakeStringError("failed to read tensor data from ", path);
+    }
+    (*slots)[original_indices[j]] = std::move(*dht);
+  }
+  return llvm::Error::success();
+}
+
+}  // namespace
+
+std::string CheckpointShardPath(const std::string& prefix, int shard,
+                                int num_shards) {
+  return StrCat(prefix, ".", shard, "-of-", num_shards, ".btf");
+}
+
+std::string CheckpointManifestPath(const std::string& prefix) {
+  return StrCat(prefix, ".manifest");
+}
+
+AsyncValueRef<Chain> SaveCheckpoint(std::vector<DenseHostTensor> tensors,
+                                    std::string prefix, int num_shards,
+                                    HostContext* host) {
+  const uint64_t num_tensors = tensors.size();
+  if (num_shards < 1) num_shards = 1;
+  if (num_tensors != 0 && static_cast<uint64_t>(num_shards) > num_tensors) {
+    num_shards = num_tensors;
+  }
+
+  // Balance the tensors across the shards by byte size: each tensor goes to
+  // the least loaded shard so far, so one huge weight does not serialize the
+  // save behind it.
+  std::vector<uint64_t> shard_bytes(num_shards, 0);
+  std::vector<std::vector<DenseHostTensor>> shard_tensors(num_shards);
+  std::vector<uint64_t> assignment;
+  assignment.reserve(2 * num_tensors);
+  for (auto& tensor : tensors) {
+    const int shard = static_cast<int>(
+        std::min_element(shard_bytes.begin(), shard_bytes.end()) -
+        shard_bytes.begin());
+    assignment.push_back(shard);
+    assignment.push_back(shard_tensors[shard].size());
+    shard_bytes[shard] += tensor.metadata().GetHostSizeInBytes();
+    shard_tensors[shard].push_back(std::move(tensor));
+  }
+
+  SmallVector<RCReference<AsyncValue>, 8> pending;
+
+  // The manifest is tiny; one task writes it while the shards write.
+  pending.push_back(
+      host->EnqueueBlockingWork([prefix, num_shards, num_tensors,
+                                 assignment = std::move(assignment)]()
+                                    -> Expected<Chain> {
+            const std::string path = CheckpointManifestPath(prefix);
+            std::ofstream out(path,
+                              std::ios_base::binary | std::ios_base::trunc);
+            if (!out) {
+              return MakeStringError("failed to open checkpoint manifest ",
+                                     path, " for writing");
+            }
+            const uint64_t header[2] = {static_cast<uint64_t>(num_shards),
+                                        num_tensors};
+            out.write(reinterpret_cast<const char*>(header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(assignment.data()),
+                      assignment.size() * sizeof(uint64_t));
+            out.flush();
+            if (!out) {
+              return MakeStringError("failed to write checkpoint manifest ",
+                                     path);
+            }
+            return Chain();
+          })
+          .ReleaseRCRef());
+
+  // Each shard is an ordinary parallel BTF write; the shard files proceed
+  // concurrently with each other and with the manifest.
+  for (int shard = 0; shard != num_shards; ++shard) {
+    pending.push_back(
+        WriteTensorsToBTF(std::move(shard_tensors[shard]),
+                          CheckpointShardPath(prefix, shard, num_shards), host)
+            .ReleaseRCRef());
+  }
+
+  auto chain = host->MakeUnconstructedAsyncValueRef<Chain>();
+  SmallVector<AsyncValue*, 8> pending_ptrs;
+  for (auto& value : pending) pending_ptrs.push_back(value.get());
+  host->RunWhenReady(pending_ptrs, [pending = std::move(pending),
+                                    chain = chain.CopyRef()] {
+    for (auto& value : pending) {
+      if (value->IsError()) {
+        chain.SetError(value->GetError());
+        return;
+      }
+    }
+    chain.emplace();
+  });
+  return chain;
+}
+
+AsyncValueRef<std::vector<DenseHostTensor>> RestoreCheckpoint(
+    std::string prefix, HostContext* host) {
+  auto result =
+      host->MakeUnconstructedAsyncValueRef<std::vector<DenseHostTensor>>();
+  bool enqueued = host->EnqueueBlockingWork([prefix = std::move(prefix), host,
+                                             result = result.CopyRef()] {
+    // Read the manifest, then fan one read task out per shard.
+    const std::string manifest_path = CheckpointManifestPath(prefix);
+    std::ifstream in(manifest_path, std::ios_base::binary);
+    if (!in) {
+      result.SetError(
+          StrCat("failed to open checkpoint manifest ", manifest_path));
+      return;
+    }
+    in.seekg(0, std::ios_base::end);
+    const uint64_t manifest_size = in.tellg();
+    in.seekg(0);
+    uint64_t header[2];
+    if (manifest_size < sizeof(header) ||
+        !in.read(reinterpret_cast<char*>(header), sizeof(header))) {
+      result.SetError(
+          StrCat("failed to read checkpoint manifest ", manifest_path));
+      return;
+    }
+    const uint64_t num_shards = header[0];
+    const uint64_t num_tensors = header[1];
+    if (num_shards == 0 ||
+        num_tensors != (manifest_size - sizeof(header)) /
+                           (2 * sizeof(uint64_t))) {
+      result.SetError(
+          StrCat("corrupted checkpoint manifest ", manifest_path));
+      return;
+    }
+    std::vector<uint64_t> assignment(2 * num_tensors);
+    if (!in.read(reinterpret_cast<char*>(assignment.data()),
+                 assignment.size() * sizeof(uint64_t))) {
+      result.SetError(
+          StrCat("failed to read checkpoint manifest ", manifest_path));
+      return;
+    }
+
+    // Invert the manifest: for each shard, the checkpoint index of every
+    // record in record order.
+    std::vector<std::vector<size_t>> shard_indices(num_shards);
+    for (uint64_t i = 0; i != num_tensors; ++i) {
+      const uint64_t shard = assignment[2 * i];
+      const uint64_t record = assignment[2 * i + 1];
+      if (shard >= num_shards || record != shard_indices[shard].size()) {
+        result.SetError(
+            StrCat("corrupted checkpoint manifest ", manifest_path));
+        return;
+      }
+      shard_indices[shard].push_back(i);
+    }
+
+    auto state = std::make_shared<RestoreState>();
+    state->remaining = num_shards;
+    state->result = result.CopyRef();
+    state->slots.resize(num_tensors);
+    for (uint64_t shard = 0; shard != num_shards; ++shard) {
+      auto task = [state, host,
+                   path = CheckpointShardPath(prefix, static_cast<int>(shard),
+                                              static_cast<int>(num_shards)),
+                   indices = std::move(shard_indices[shard])] {
+        if (auto error =
+                ReadShardIntoSlots(path, indices, &state->slots, host)) {
+          state->RecordError(llvm::toString(std::move(error)));
+        }
+        state->CompleteOne();
+      };
+      // This task already runs on the blocking queue, so running a shard
+      // inline when the queue is saturated still makes progress.
+      if (!host->EnqueueBlockingWork(task)) task();
+    }
+  });
+  if (!enqueued) result.SetError("failed to enqueue blocking work");
+  return result;
+}
+
+}  // namespace tfrt
@@ -0,0 +1,99 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- conversion_registry.cc ---------------------------------------------===//
+//
+// This file implements the tensor conversion function registry.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/conversion_registry.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+#include "tfrt/tensor/dense_host_tensor.h"
+
+namespace tfrt {
+
+namespace {
+
+// The registered functions, guarded by a mutex so subclasses may be
+// registered lazily from static initializers in any order.
+struct ConversionFnTable {
+  mutable mutex mu;
+  llvm::SmallDenseMap<uint32_t, TensorConversionFnRegistry::ConversionFn, 8>
+      fns TFRT_GUARDED_BY(mu);
+};
+
+ConversionFnTable* GetConversionFnTable() {
+  static ConversionFnTable* table = new ConversionFnTable;
+  return table;
+}
+
+// Converts a DenseHostTensor by sharing its HostBuffer: same-layout
+// conversions are a refcount bump instead of a memcpy. The aliasing result
+// is read-only per the registry contract.
+AsyncValueRef<HostTensor> ConvertDenseHostTensor(const Tensor& tensor,
+                                                 HostContext* host,
+                                                 uint32_t allowed_formats) {
+  if (allowed_formats &
+      (1 << static_cast<uint32_t>(Tensor::Subclass::DenseHost))) {
+    auto& dht = cast<DenseHostTensor>(tensor);
+    return host->MakeAvailableAsyncValueRef<DenseHostTensor>(dht.CopyRef());
+  }
+  // The destination layout differs, so there is nothing to alias; let the
+  // copying conversion handle it.
+  return tensor.ConvertToHostTensor(host, allowed_formats);
+}
+
+}  // namespace
+
+void TensorConversionFnRegistry::AddConversionFn(Tensor::Subclass subclass,
+                                                 ConversionFn fn) {
+  auto* table = GetConversionFnTable();
+  mutex_lock lock(table->mu);
+  table->fns[static_cast<uint32_t>(subclass)] = fn;
+}
+
+TensorConversionFnRegistry::ConversionFn
+TensorConversionFnRegistry::GetConversionFn(Tensor::Subclass subclass) const {
+  auto* table = GetConversionFnTable();
+  mutex_lock lock(table->mu);
+  auto it = table->fns.find(static_cast<uint32_t>(subclass));
+  return it == table->fns.end() ? nullptr : it->second;
+}
+
+TensorConversionFnRegistry* GetStaticTensorConversionFnRegistry() {
+  static TensorConversionFnRegistry* registry = [] {
+    auto* registry = new TensorConversionFnRegistry;
+    registry->AddConversionFn(Tensor::Subclass::DenseHost,
+                              ConvertDenseHostTensor);
+    return registry;
+  }();
+  return registry;
+}
+
+AsyncValueRef<HostTensor> ConvertTensorToHostTensor(const Tensor& tensor,
+                                                    HostContext* host,
+                                                    uint32_t allowed_formats) {
+  auto* registry = GetStaticTensorConversionFnRegistry();
+  if (auto fn = registry->GetConversionFn(tensor.subclass()))
+    return fn(tensor, host, allowed_formats);
+  return tensor.ConvertToHostTensor(host, allowed_formats);
+}
+
+}  // namespace tfrt
@@ -25,32 +25,36 @@
 #include "tfrt/host_context/async_value_ref.h"
 #include "tfrt/host_context/host_context.h"
 #include "tfrt/tensor/dense_host_tensor_view.h"
+#include "tfrt/tensor/dtype_dispatch.h"
 #include "tfrt/tensor/scalar_host_tensor.h"
 
 namespace tfrt {
 
 namespace {
-template <typename DType>
-void ConvertToDHTTensorHelper(const DenseHostTensor &indices,
-                              const DenseHostTensor &values,
-                              DenseHostTensor *result_tensor) {
-  auto result_tensor_view = MutableDHTArrayView<DType>(result_tensor);
-  const TensorMetadata &result_metadata = result_tensor->metadata();
-  const auto &result_shape = result_metadata.shape;
-  result_tensor_view.Fill(DType(0));
-  auto indices_view = DHTIndexableView<int64_t, 2>(&indices);
-  auto values_view = DHTIndexableView<DType, 1>(&values);
-  for (int i = 0, e = values_view.FixedShape().GetNumElements(); i != e; ++i) {
-    size_t offset = 0;
-    size_t stride = 1;
-    for (int j = result_shape.GetRank() - 1; j >= 0; --j) {
-      assert(indices_view.ElementAt(i, j) < result_shape.GetDimensionSize(j));
-      offset += stride * indices_view.ElementAt(i, j);
-      stride *= result_shape.GetDimensionSize(j);
+template <typename T>
+struct ConvertToDHTTensorHelper {
+  static void Invoke(const DenseHostTensor &indices,
+                     const DenseHostTensor &values,
+                     DenseHostTensor *result_tensor) {
+    auto result_tensor_view = MutableDHTArrayView<T>(result_tensor);
+    const TensorMetadata &result_metadata = result_tensor->metadata();
+    const auto &result_shape = result_metadata.shape;
+    result_tensor_view.Fill(T(0));
+    auto indices_view = DHTIndexableView<int64_t, 2>(&indices);
+    auto values_view = DHTIndexableView<T, 1>(&values);
+    for (int i = 0, e = values_view.FixedShape().GetNumElements(); i != e;
+         ++i) {
+      size_t offset = 0;
+      size_t stride = 1;
+      for (int j = result_shape.GetRank() - 1; j >= 0; --j) {
+        assert(indices_view.ElementAt(i, j) < result_shape.GetDimensionSize(j));
+        offset += stride * indices_view.ElementAt(i, j);
+        stride *= result_shape.GetDimensionSize(j);
+      }
+      result_tensor_view[offset] = values_view.ElementAt(i);
     }
-    result_tensor_view[offset] = values_view.ElementAt(i);
   }
-}
+};
 }  // namespace
 
 AsyncValueRef<HostTensor> CooHostTensor::ConvertToHostTensor(
@@ -91,16 +95,14 @@ AsyncValueRef<HostTensor> CooHostTensor::ConvertToHostTensor(
         "out of memory converting coo tensor to dht tensor");
   auto &result_tensor = result_alloc.getValue();
 
-  switch (dtype().kind()) {
-    default:
-      llvm_unreachable("can't happen");
-#define DTYPE_NUMERIC(ENUM)                                                    \
-  case DType::ENUM:                                                            \
-    ConvertToDHTTensorHelper<TypeForDTypeKind<DType::ENUM>>(indices_, values_, \
-                                                            &result_tensor);   \
-    break;
-#include "tfrt/tensor/dtype.def"  // NOLINT
-  }
+  auto *convert =
+      DTypeDispatch<ConvertToDHTTensorHelper, void, const DenseHostTensor &,
+                    const DenseHostTensor &,
+                    DenseHostTensor *>::Lookup(ShippedDTypeList(), dtype());
+  if (!convert)
+    return host->MakeErrorAsyncValueRef(
+        "unsupported dtype for coo tensor conversion");
+  convert(indices_, values_, &result_tensor);
 
   result.emplace(std::move(result_tensor));
   return result;
@@ -0,0 +1,104 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- csr_host_tensor.cc -------------------------------------------------===//
+//
+// This file implements the CsrHostTensor class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/csr_host_tensor.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/host_context/async_value_ref.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/tensor/dense_host_tensor_view.h"
+#include "tfrt/tensor/dtype_dispatch.h"
+
+namespace tfrt {
+
+namespace {
+template <typename T>
+struct ConvertToDHTTensorHelper {
+  static void Invoke(const DenseHostTensor &row_offsets,
+                     const DenseHostTensor &col_indices,
+                     const DenseHostTensor &values,
+                     DenseHostTensor *result_tensor) {
+    auto result_view = MutableDHTIndexableView<T, 2>(result_tensor);
+    result_view.Fill(T(0));
+    auto row_offsets_view = DHTIndexableView<int64_t, 1>(&row_offsets);
+    auto col_indices_view = DHTIndexableView<int64_t, 1>(&col_indices);
+    auto values_view = DHTIndexableView<T, 1>(&values);
+    for (ssize_t i = 0, e = row_offsets.NumElements() - 1; i != e; ++i) {
+      for (int64_t p = row_offsets_view.ElementAt(i),
+                   pe = row_offsets_view.ElementAt(i + 1);
+           p != pe; ++p) {
+        assert(col_indices_view.ElementAt(p) <
+               result_tensor->shape().GetDimensionSize(1));
+        result_view.ElementAt(i, col_indices_view.ElementAt(p)) =
+            values_view.ElementAt(p);
+      }
+    }
+  }
+};
+}  // namespace
+
+AsyncValueRef<HostTensor> CsrHostTensor::ConvertToHostTensor(
+    HostContext *host, uint32_t allowed_formats) const {
+  // CSR only represents matrices, so unlike CooHostTensor we always convert
+  // to a DenseHostTensor.
+  assert(allowed_formats &
+         (1 << static_cast<uint32_t>(Tensor::Subclass::DenseHost)));
+  auto result = host->MakeUnconstructedAsyncValueRef<DenseHostTensor>();
+  auto result_alloc = DenseHostTensor::CreateUninitialized(metadata(), host);
+  if (!result_alloc)
+    return host->MakeErrorAsyncValueRef(
+        "out of memory converting csr tensor to dht tensor");
+  auto &result_tensor = result_alloc.getValue();
+
+  auto *convert =
+      DTypeDispatch<ConvertToDHTTensorHelper, void, const DenseHostTensor &,
+                    const DenseHostTensor &, const DenseHostTensor &,
+                    DenseHostTensor *>::Lookup(ShippedDTypeList(), dtype());
+  if (!convert)
+    return host->MakeErrorAsyncValueRef(
+        "unsupported dtype for csr tensor conversion");
+  convert(row_offsets_, col_indices_, values_, &result_tensor);
+
+  result.emplace(std::move(result_tensor));
+  return result;
+}
+
+void CsrHostTensor::Print(raw_ostream &os) const {
+  // Just dumps the flat values for now.
+  os << "CsrHostTensor dtype = " << dtype() << ", shape = " << shape();
+  os << ", row_offsets = [";
+  llvm::interleaveComma(DHTIndexableView<int64_t, 1>(RowOffsets()).Elements(),
+                        os);
+  os << "], col_indices = [";
+  llvm::interleaveComma(DHTIndexableView<int64_t, 1>(ColIndices()).Elements(),
+                        os);
+  os << "], values = [";
+
+  auto element_size = dtype().GetHostSize();
+  auto *data_ptr = static_cast<const char *>(Values()->data());
+  for (ssize_t i = 0, e = Values()->NumElements(); i != e; ++i) {
+    if (i != 0) os << ", ";
+    dtype().Print(data_ptr + i * element_size, os);
+  }
+  os << "]\n";
+}
+
+}  // namespace tfrt
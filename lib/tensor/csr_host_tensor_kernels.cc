@@ -0,0 +1,143 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- csr_host_tensor_kernels.cc -------------------------------*- c++ -*-===//
+//
+// This file defines the kernels for CSR sparse host tensors.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/host_context/kernel_utils.h"
+#include "tfrt/tensor/coo_host_tensor.h"
+#include "tfrt/tensor/csr_host_tensor.h"
+#include "tfrt/tensor/dense_tensor_utils.h"
+
+namespace tfrt {
+
+// Returns true if two input tensors are equal, false otherwise.
+template <typename T>
+static void CsrTensorEqual(Argument<CsrHostTensor> t1,
+                           Argument<CsrHostTensor> t2, Argument<Chain> chain,
+                           Result<bool> output1, Result<Chain> output2) {
+  output1.Emplace((MutableDHTArrayView<T>(t1->Values()) ==
+                   MutableDHTArrayView<T>(t2->Values())) &&
+                  (MutableDHTArrayView<int64_t>(t1->RowOffsets()) ==
+                   MutableDHTArrayView<int64_t>(t2->RowOffsets())) &&
+                  (MutableDHTArrayView<int64_t>(t1->ColIndices()) ==
+                   MutableDHTArrayView<int64_t>(t2->ColIndices())));
+  // Reuse input chain.
+  output2.Set(chain);
+}
+
+// Converts a sparse tensor in CSR layout to a DenseHostTensor.
+template <typename T>
+static void ConvertToDHT(Argument<CsrHostTensor> in, Argument<Chain> in_chain,
+                         Result<DenseHostTensor> out, Result<Chain> out_chain,
+                         KernelErrorHandler handler, KernelFrame* frame) {
+  uint32_t allowed_formats =
+      1 << static_cast<uint32_t>(Tensor::Subclass::DenseHost);
+  auto host_tensor =
+      in.get().ConvertToHostTensor(frame->GetHostContext(), allowed_formats);
+  auto dht = AsyncValueRef<DenseHostTensor>(host_tensor.ReleaseRCRef());
+  out.Set(std::move(dht));
+  out_chain.Set(in_chain);
+}
+
+// Converts a rank-2 CooHostTensor into a CsrHostTensor with a counting sort
+// over the row indices. The sort is stable, so stored elements within a row
+// keep the order they have in the coordinate list.
+template <typename T>
+static void ConvertFromCoo(Argument<CooHostTensor> in, Argument<Chain> in_chain,
+                           Result<CsrHostTensor> out, Result<Chain> out_chain,
+                           KernelErrorHandler handler, KernelFrame* frame) {
+  if (in->shape().GetRank() != 2) {
+    handler.ReportError("CSR tensors must be matrices");
+    return;
+  }
+  HostContext* host = frame->GetHostContext();
+  const ssize_t num_rows = in->shape().GetDimensionSize(0);
+  const ssize_t num_values = in->Values()->NumElements();
+
+  auto row_offsets = DenseHostTensor::CreateUninitialized<int64_t>(
+      TensorShape(num_rows + 1), host);
+  if (!row_offsets.hasValue()) {
+    handler.ReportError("Cannot allocate row offsets tensor");
+    return;
+  }
+  auto col_indices = DenseHostTensor::CreateUninitialized<int64_t>(
+      TensorShape(num_values), host);
+  if (!col_indices.hasValue()) {
+    handler.ReportError("Cannot allocate column index tensor");
+    return;
+  }
+  auto values =
+      DenseHostTensor::CreateUninitialized<T>(TensorShape(num_values), host);
+  if (!values.hasValue()) {
+    handler.ReportError("Cannot allocate value tensor");
+    return;
+  }
+
+  auto in_indices = DHTIndexableView<int64_t, 2>(in->Indices());
+  auto in_values = DHTIndexableView<T, 1>(in->Values());
+  auto row_offsets_view =
+      MutableDHTIndexableView<int64_t, 1>(row_offsets.getPointer());
+  auto col_indices_view =
+      MutableDHTIndexableView<int64_t, 1>(col_indices.getPointer());
+  auto values_view = MutableDHTIndexableView<T, 1>(values.getPointer());
+
+  // Count the stored elements of each row, then turn the counts into offsets
+  // with an exclusive prefix sum.
+  row_offsets_view.Fill(0);
+  for (ssize_t i = 0; i < num_values; ++i) {
+    row_offsets_view.ElementAt(in_indices.ElementAt(i, 0) + 1) += 1;
+  }
+  for (ssize_t i = 0; i < num_rows; ++i) {
+    row_offsets_view.ElementAt(i + 1) += row_offsets_view.ElementAt(i);
+  }
+
+  // Scatter the column indices and values into their rows, using a running
+  // cursor per row.
+  SmallVector<int64_t, 16> cursor(num_rows);
+  for (ssize_t i = 0; i < num_rows; ++i)
+    cursor[i] = row_offsets_view.ElementAt(i);
+  for (ssize_t i = 0; i < num_values; ++i) {
+    const int64_t pos = cursor[in_indices.ElementAt(i, 0)]++;
+    col_indices_view.ElementAt(pos) = in_indices.ElementAt(i, 1);
+    values_view.ElementAt(pos) = in_values.ElementAt(i);
+  }
+
+  out.Emplace(CsrHostTensor(in->shape(), GetDType<T>(),
+                            std::move(*row_offsets), std::move(*col_indices),
+                            std::move(*values)));
+  out_chain.Set(in_chain);
+}
+
+template <typename T>
+void RegisterCsrHostTensorKernelsForType(KernelRegistry* registry,
+                                         const std::string& t_name) {
+  std::string suffix = t_name + ".2";
+  registry->AddKernel("csr.convert_csr_to_dht." + suffix,
+                      TFRT_KERNEL(ConvertToDHT<T>));
+  registry->AddKernel("csr.convert_coo_to_csr." + suffix,
+                      TFRT_KERNEL(ConvertFromCoo<T>));
+  registry->AddKernel("csr.tensor_equal." + suffix,
+                      TFRT_KERNEL(CsrTensorEqual<T>));
+}
+
+void RegisterCsrHostTensorKernels(KernelRegistry* registry) {
+  RegisterCsrHostTensorKernelsForType<float>(registry, "f32");
+  RegisterCsrHostTensorKernelsForType<int32_t>(registry, "i32");
+}
+
+}  // namespace tfrt
@@ -0,0 +1,88 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- dense_constant_pool.cc ---------------------------------------------===//
+//
+// This file implements DenseConstantPool.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tensor/dense_constant_pool.h"
+
+#include <cstring>
+
+#include "tfrt/host_context/host_buffer.h"
+#include "tfrt/host_context/host_context.h"
+#include "tfrt/support/error_util.h"
+#include "tfrt/support/hash_util.h"
+
+namespace tfrt {
+namespace {
+
+// Hashes the payload together with the metadata so that tensors with equal
+// bytes but different shapes or dtypes do not collide on purpose.
+uint64_t HashConstant(const TensorMetadata& metadata, const void* data,
+                      size_t size) {
+  uint64_t hash = Hash64(static_cast<const char*>(data), size);
+  hash = Hash64Combine(hash, static_cast<uint64_t>(metadata.dtype.kind()));
+  for (int i = 0, e = metadata.shape.GetRank(); i < e; ++i)
+    hash = Hash64Combine(hash, metadata.shape.GetDimensionSize(i));
+  return hash;
+}
+
+}  // namespace
+
+DenseConstantPool::DenseConstantPool(HostContext* host) : host_(host) {}
+
+DenseConstantPool::~DenseConstantPool() {}
+
+llvm::Expected<DenseHostTensor> DenseConstantPool::GetOrCreateConstant(
+    const TensorMetadata& metadata, const void* data) {
+  const size_t size = metadata.GetHostSizeInBytes();
+  const uint64_t hash = HashConstant(metadata, data, size);
+
+  mutex_lock lock(mu_);
+  auto range = constants_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    const Entry& entry = it->second;
+    if (entry.metadata == metadata &&
+        std::memcmp(entry.buffer->data(), data, size) == 0)
+      return DenseHostTensor(metadata, entry.buffer.CopyRef());
+  }
+
+  auto buffer = HostBuffer::CreateUninitialized(
+      size, metadata.dtype.GetHostAlignment(), host_->allocator());
+  if (!buffer) return MakeStringError("cannot allocate pooled constant");
+  std::memcpy(buffer->data(), data, size);
+  constants_.emplace(hash, Entry{metadata, buffer.CopyRef()});
+  return DenseHostTensor(metadata, std::move(buffer));
+}
+
+size_t DenseConstantPool::DropUnusedConstants() {
+  mutex_lock lock(mu_);
+  size_t dropped = 0;
+  for (auto it = constants_.begin(); it != constants_.end();) {
+    // The pool holds the only reference once every tensor sharing the
+    // buffer has been destroyed.
+    if (it->second.buffer->IsUnique()) {
+      it = constants_.erase(it);
+      ++dropped;
+    } else {
+      ++it;
+    }
+  }
+  return dropped;
+}
+
+}  // namespace tfrt
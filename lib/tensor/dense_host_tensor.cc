@@ -45,6 +45,24 @@ llvm::Optional<DenseHostTensor> DenseHostTensor::CreateUninitialized(
   return CreateUninitialized(metadata, host->allocator());
 }
 
+void* DenseHostTensor::MutableData(HostAllocator* allocator) {
+  assert(data_ && "dereferencing a null host tensor");
+  if (data_->IsUnique()) return data_->data();
+
+  // The buffer is shared with other tensors: clone it so the caller's writes
+  // are not observed through them.
+  auto copy = HostBuffer::CreateUninitialized(
+      data_->size(), metadata().dtype.GetHostAlignment(), allocator);
+  if (!copy) return nullptr;
+  memcpy(copy->data(), data_->data(), data_->size());
+  data_ = std::move(copy);
+  return data_->data();
+}
+
+void* DenseHostTensor::MutableData(HostContext* host) {
+  return MutableData(host->allocator());
+}
+
 AsyncValueRef<DenseHostTensor> DenseHostTensor::MakeConstructedAsyncValueRef(
     const TensorMetadata& metadata, HostContext* host) {
   auto dht = CreateUninitialized(metadata, host);
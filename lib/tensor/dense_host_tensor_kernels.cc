@@ -22,6 +22,7 @@
 
 #include <complex>
 
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include "tfrt/host_context/kernel_utils.h"
@@ -29,9 +30,12 @@
 #include "tfrt/support/ostream.h"
 #include "tfrt/support/ref_count.h"
 #include "tfrt/support/string_util.h"
+#include "tfrt/tensor/checkpoint.h"
+#include "tfrt/tensor/dense_constant_pool.h"
 #include "tfrt/tensor/dense_host_tensor.h"
 #include "tfrt/tensor/dense_host_tensor_view.h"
 #include "tfrt/tensor/dense_tensor_utils.h"
+#include "tfrt/tensor/tensor_serialize_utils.h"
 #include "tfrt/tensor/tensor_shape.h"
 
 namespace tfrt {
@@ -107,6 +111,192 @@ static llvm::Expected<Chain> SetDenseTensorWithValues(
   return Chain();
 }
 
+// Creates a tensor from a dense attribute through the host's constant
+// pool: identical constants across the loaded BEF files share one
+// HostBuffer, keyed by content hash. The first sighting copies the payload
+// out of the file - so the file's constant pages stay clean - and every
+// later sighting, from this file or another one, aliases the pooled copy.
+// The resulting tensor must be treated as read-only.
+static llvm::Expected<DenseHostTensor> ConstDenseTensor(DenseAttr src,
+                                                        HostContext* host) {
+  auto metadata = CreateTensorMetadata(src);
+  auto& pool = host->GetOrCreateSharedContext<DenseConstantPool>();
+  return pool.GetOrCreateConstant(metadata, src.GetElements());
+}
+
+// Returns an aliasing DenseHostTensor over a region of the input when the
+// region is contiguous; the alias shares the input's HostBuffer and must be
+// treated as read-only.  Returns None if the region is not contiguous and
+// has to be materialized by the caller instead.
+template <typename T, size_t Rank>
+static llvm::Optional<DenseHostTensor> TryAliasStridedView(
+    const DenseHostTensor& dht, const StridedDHTIndexableView<T, Rank>& view,
+    const TensorMetadata& result_md) {
+  if (!view.IsContiguous()) return llvm::None;
+  size_t offset_bytes =
+      (view.data() - static_cast<const T*>(dht.data())) * sizeof(T);
+  auto buffer = HostBuffer::CreateFromParent(
+      dht.buffer().CopyRef(), offset_bytes, result_md.GetHostSizeInBytes());
+  return DenseHostTensor(result_md, std::move(buffer));
+}
+
+// Returns a tensor of shape `sizes` viewing the region of the input that
+// starts at coordinate `begins`.  A contiguous region (e.g. a slice of the
+// outermost dimension) aliases the input's buffer without copying; only a
+// strided region is materialized.
+template <typename T, size_t Rank>
+static void SliceTensorView(Argument<DenseHostTensor> in,
+                            Argument<Chain> in_chain,
+                            Result<DenseHostTensor> out,
+                            Result<Chain> out_chain,
+                            ArrayAttribute<ssize_t> begins,
+                            ArrayAttribute<ssize_t> sizes,
+                            KernelErrorHandler handler, KernelFrame* frame) {
+  if (begins.size() != Rank || sizes.size() != Rank) {
+    handler.ReportError("dht.slice_view expects begins and sizes of rank ",
+                        Rank);
+    return;
+  }
+  FixedRankShape<Rank> in_shape(in->shape());
+  std::array<size_t, Rank> begin_coord;
+  FixedRankShape<Rank> result_shape;
+  for (size_t i = 0; i != Rank; ++i) {
+    if (begins[i] < 0 || sizes[i] < 0 ||
+        begins[i] + sizes[i] > in_shape[i]) {
+      handler.ReportError("dht.slice_view region is out of bounds");
+      return;
+    }
+    begin_coord[i] = begins[i];
+    result_shape[i] = sizes[i];
+  }
+
+  auto view =
+      StridedDHTIndexableView<T, Rank>::Slice(*in, begin_coord, result_shape);
+  TensorMetadata result_md(GetDType<T>(), result_shape.ToTensorShape());
+  if (auto alias = TryAliasStridedView(*in, view, result_md)) {
+    out.Emplace(std::move(*alias));
+    out_chain.Set(in_chain);
+    return;
+  }
+
+  auto result =
+      DenseHostTensor::CreateUninitialized(result_md, frame->GetHostContext());
+  if (!result.hasValue()) {
+    handler.ReportError("Cannot allocate tensor");
+    return;
+  }
+  view.CopyTo(MutableDHTIndexableView<T, Rank>(result.getPointer()));
+  out.Emplace(std::move(*result));
+  out_chain.Set(in_chain);
+}
+
+// Returns the input tensor with its dimensions reordered so that result
+// dimension i is input dimension permutation[i].  Degenerate permutations
+// that leave the data contiguous alias the input's buffer; a real transpose
+// is materialized through the strided view.
+template <typename T, size_t Rank>
+static void TransposeTensorView(Argument<DenseHostTensor> in,
+                                Argument<Chain> in_chain,
+                                Result<DenseHostTensor> out,
+                                Result<Chain> out_chain,
+                                ArrayAttribute<ssize_t> permutation,
+                                KernelErrorHandler handler,
+                                KernelFrame* frame) {
+  if (permutation.size() != Rank) {
+    handler.ReportError("dht.transpose_view expects a permutation of rank ",
+                        Rank);
+    return;
+  }
+  std::array<size_t, Rank> perm_coord;
+  std::array<bool, Rank> seen{};
+  for (size_t i = 0; i != Rank; ++i) {
+    if (permutation[i] < 0 || permutation[i] >= static_cast<ssize_t>(Rank) ||
+        seen[permutation[i]]) {
+      handler.ReportError("dht.transpose_view permutation is invalid");
+      return;
+    }
+    seen[permutation[i]] = true;
+    perm_coord[i] = permutation[i];
+  }
+
+  auto view = StridedDHTIndexableView<T, Rank>::Transpose(*in, perm_coord);
+  TensorMetadata result_md(GetDType<T>(),
+                           view.FixedShape().ToTensorShape());
+  if (auto alias = TryAliasStridedView(*in, view, result_md)) {
+    out.Emplace(std::move(*alias));
+    out_chain.Set(in_chain);
+    return;
+  }
+
+  auto result =
+      DenseHostTensor::CreateUninitialized(result_md, frame->GetHostContext());
+  if (!result.hasValue()) {
+    handler.ReportError("Cannot allocate tensor");
+    return;
+  }
+  view.CopyTo(MutableDHTIndexableView<T, Rank>(result.getPointer()));
+  out.Emplace(std::move(*result));
+  out_chain.Set(in_chain);
+}
+
+// Returns a tensor with the given shape aliasing the input's buffer.  A
+// reshape never moves data, so the result is always zero-copy.
+static void ReshapeTensorView(Argument<DenseHostTensor> in,
+                              Argument<Chain> in_chain,
+                              Result<DenseHostTensor> out,
+                              Result<Chain> out_chain,
+                              ArrayAttribute<ssize_t> shape,
+                              KernelErrorHandler handler) {
+  TensorShape new_shape(shape.data());
+  if (new_shape.GetNumElements() != in->shape().GetNumElements()) {
+    handler.ReportError("dht.reshape_view cannot reshape ", in->shape(),
+                        " to ", new_shape);
+    return;
+  }
+  out.Emplace(TensorMetadata(in->dtype(), new_shape), in->buffer().CopyRef());
+  out_chain.Set(in_chain);
+}
+
+// Splits the input tensor into as many equally sized tensors along the
+// outermost dimension as the kernel has tensor results.  Each piece aliases
+// its row range of the input's buffer through a sub-buffer, so splitting a
+// batch into per-request tensors copies nothing; like the other view kernels,
+// the results must be treated as read-only.
+static void SplitTensorView(Argument<DenseHostTensor> in,
+                            Argument<Chain> in_chain, Result<Chain> out_chain,
+                            RemainingResults results,
+                            KernelErrorHandler handler, KernelFrame* frame) {
+  const TensorShape& shape = in->shape();
+  const ssize_t num_splits = results.size();
+  if (shape.GetRank() < 1) {
+    handler.ReportError("dht.split_view requires a tensor of rank >= 1");
+    return;
+  }
+  if (num_splits == 0 || shape.GetDimensionSize(0) % num_splits != 0) {
+    handler.ReportError("dht.split_view cannot split outermost dimension ",
+                        shape.GetDimensionSize(0), " into ", num_splits,
+                        " equal pieces");
+    return;
+  }
+
+  SmallVector<ssize_t, 4> dims;
+  shape.GetDimensions(&dims);
+  dims[0] /= num_splits;
+  TensorMetadata result_md(in->dtype(), TensorShape(dims));
+  const size_t split_bytes = result_md.GetHostSizeInBytes();
+
+  HostContext* host = frame->GetHostContext();
+  for (ssize_t i = 0; i != num_splits; ++i) {
+    auto buffer = HostBuffer::CreateFromParent(in->buffer().CopyRef(),
+                                               i * split_bytes, split_bytes);
+    results[i] = host
+                     ->MakeAvailableAsyncValueRef<DenseHostTensor>(
+                         result_md, std::move(buffer))
+                     .ReleaseRCRef();
+  }
+  out_chain.Set(in_chain);
+}
+
 static Chain NoOpHostTensor(Argument<DenseHostTensor> in) { return Chain(); }
 
 static Chain PrintTensor(const Tensor& t) {
@@ -160,12 +350,69 @@ static void PrintBuffer(Argument<RCReference<HostBuffer>> buffer,
   chain_out.Set(chain_in);
 }
 
+// Saves the argument tensors as a multi-file checkpoint under the `path`
+// attribute, sharded across `num_shards` concurrently written files. The
+// returned chain resolves once every shard and the manifest are on disk.
+static AsyncValueRef<Chain> CheckpointSave(RemainingArguments tensors,
+                                           StringAttribute path,
+                                           Attribute<int32_t> num_shards,
+                                           const ExecutionContext& exec_ctx) {
+  std::vector<DenseHostTensor> copies;
+  copies.reserve(tensors.size());
+  // CopyRef shares the underlying buffers; no tensor data is copied.
+  for (size_t i = 0, e = tensors.size(); i != e; ++i) {
+    copies.push_back(tensors[i]->get<DenseHostTensor>().CopyRef());
+  }
+  return SaveCheckpoint(std::move(copies), path.str(), num_shards.get(),
+                        exec_ctx.host());
+}
+
+// Restores a checkpoint saved by dht.checkpoint.save. The program declares
+// as many results as tensors were saved; the shards are read concurrently
+// and every result resolves once the whole checkpoint is in memory.
+static void CheckpointRestore(RemainingResults results, StringAttribute path,
+                              const ExecutionContext& exec_ctx) {
+  HostContext* host = exec_ctx.host();
+  SmallVector<RCReference<IndirectAsyncValue>, 8> result_refs;
+  result_refs.reserve(results.size());
+  for (int i = 0, e = results.size(); i != e; ++i) {
+    result_refs.push_back(results.AllocateIndirectResultAt(i));
+  }
+  auto restored = RestoreCheckpoint(path.str(), host);
+  auto* restored_ptr = restored.GetAsyncValue();
+  restored_ptr->AndThen([restored = std::move(restored),
+                         result_refs = std::move(result_refs), host]() mutable {
+    if (restored.IsError()) {
+      for (auto& result : result_refs) result->ForwardTo(restored.CopyRCRef());
+      return;
+    }
+    auto& tensors = restored.get();
+    if (tensors.size() != result_refs.size()) {
+      auto error = host->MakeErrorAsyncValueRef(
+          StrCat("checkpoint holds ", tensors.size(), " tensors but ",
+                 result_refs.size(), " results were requested"));
+      for (auto& result : result_refs) result->ForwardTo(error.CopyRCRef());
+      return;
+    }
+    for (size_t i = 0, e = tensors.size(); i != e; ++i) {
+      result_refs[i]->ForwardTo(
+          host->MakeAvailableAsyncValueRef<DenseHostTensor>(
+                  std::move(tensors[i]))
+              .ReleaseRCRef());
+    }
+  });
+}
+
 template <typename T, size_t Rank>
 static void RegisterDenseHostTensorKernelsForTypeAndRank(
     KernelRegistry* registry, const std::string& t_name) {
   std::string suffix = t_name + "." + std::to_string(Rank);
   registry->AddKernel("dht.create_uninitialized_tensor." + suffix,
                       TFRT_KERNEL(CreateUninitializedDenseTensor<T, Rank>));
+  registry->AddKernel("dht.slice_view." + suffix,
+                      TFRT_KERNEL(SliceTensorView<T, Rank>));
+  registry->AddKernel("dht.transpose_view." + suffix,
+                      TFRT_KERNEL(TransposeTensorView<T, Rank>));
 }
 
 template <typename T>
@@ -202,6 +449,7 @@ static void RegisterDenseHostTensorKernelsForType(KernelRegistry* registry,
 
 void RegisterDenseHostTensorKernels(KernelRegistry* registry) {
   RegisterDenseHostTensorKernelsForType<uint8_t>(registry, "ui8");
+  RegisterDenseHostTensorKernelsForType<int8_t>(registry, "i8");
   RegisterDenseHostTensorKernelsForType<float>(registry, "f32");
   RegisterDenseHostTensorKernelsForType<int32_t>(registry, "i32");
   RegisterDenseHostTensorKernelsForType<int64_t>(registry, "i64");
@@ -212,9 +460,15 @@ void RegisterDenseHostTensorKernels(KernelRegistry* registry) {
   registry->AddKernel("dht.print_tensor_shape",
                       TFRT_KERNEL(PrintDenseTensorShape));
   registry->AddKernel("dht.get_tensor_shape", TFRT_KERNEL(GetDenseTensorShape));
+  registry->AddKernel("dht.reshape_view", TFRT_KERNEL(ReshapeTensorView));
+  registry->AddKernel("dht.split_view", TFRT_KERNEL(SplitTensorView));
+  registry->AddKernel("dht.const_tensor", TFRT_KERNEL(ConstDenseTensor));
   registry->AddKernel("dht.no_op_ht", TFRT_KERNEL(NoOpHostTensor));
   registry->AddKernel("dht.get_buffer", TFRT_KERNEL(GetBuffer));
   registry->AddKernel("dht.print_buffer", TFRT_KERNEL(PrintBuffer));
+  registry->AddKernel("dht.checkpoint.save", TFRT_KERNEL(CheckpointSave));
+  registry->AddKernel("dht.checkpoint.restore",
+                      TFRT_KERNEL(CheckpointRestore));
 }
 
 }  // namespace tfrt
@@ -37,6 +37,8 @@ size_t DType::GetHostSize() const {
       return ~size_t(0);
     case BOOL:
       return sizeof(TypeForDTypeKind<DType::BOOL>);
+    case BF16:
+      return sizeof(TypeForDTypeKind<DType::BF16>);
     case COMPLEX64:
       return sizeof(TypeForDTypeKind<DType::COMPLEX64>);
 #define DTYPE_NUMERIC(ENUM) \
@@ -59,6 +61,8 @@ size_t DType::GetHostAlignment() const {
       return ~size_t(0);
     case BOOL:
       return alignof(TypeForDTypeKind<DType::BOOL>);
+    case BF16:
+      return alignof(TypeForDTypeKind<DType::BF16>);
     case COMPLEX64:
       return alignof(TypeForDTypeKind<DType::COMPLEX64>);
 #define DTYPE_NUMERIC(ENUM) \
@@ -76,6 +80,9 @@ void DType::Print(const void *data, raw_ostream &os) const {
     case DType::F16:
       os << "Does not support printing fp16.";
       break;
+    case DType::BF16:
+      os << "Does not support printing bf16.";
+      break;
     case DType::String:
       os << *static_cast<const TypeForDTypeKind<DType::String> *>(data);
       break;
@@ -103,6 +110,9 @@ void DType::PrintFullPrecision(const void *data, raw_ostream &os) const {
     case DType::F16:
       os << "Does not support printing fp16.";
       break;
+    case DType::BF16:
+      os << "Does not support printing bf16.";
+      break;
     case DType::String:
       os << *static_cast<const TypeForDTypeKind<DType::String> *>(data);
       break;
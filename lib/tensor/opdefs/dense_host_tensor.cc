@@ -132,6 +132,96 @@ static void printSetTensorOp(OpAsmPrinter &p, SetTensorOp op) {
   p << " " << op.getAttr("values");
 }
 
+//===----------------------------------------------------------------------===//
+// SliceViewOp
+//===----------------------------------------------------------------------===//
+
+static ParseResult parseSliceViewOp(OpAsmParser &parser,
+                                    OperationState &result) {
+  SmallVector<OpAsmParser::OperandType, 2> operands;
+  if (parser.parseOperandList(operands, /*requiredOperandCount=*/2))
+    return failure();
+
+  auto tensorType = getTensorType(result.getContext());
+  auto chainType = getChainType(result.getContext());
+
+  Attribute beginsAttr, sizesAttr;
+  return failure(
+      parser.resolveOperand(operands[0], tensorType, result.operands) ||
+      parser.resolveOperand(operands[1], chainType, result.operands) ||
+      parser.parseAttribute(beginsAttr, "begins", result.attributes) ||
+      parser.parseComma() ||
+      parser.parseAttribute(sizesAttr, "sizes", result.attributes) ||
+      parser.addTypeToList(tensorType, result.types) ||
+      parser.addTypeToList(chainType, result.types));
+}
+
+template <typename SliceViewOp>
+static void printSliceViewOp(OpAsmPrinter &p, SliceViewOp op) {
+  p << SliceViewOp::getOperationName() << " ";
+  p.printOperands(op.getOperands());
+  p << " " << op.getAttr("begins") << ", " << op.getAttr("sizes");
+}
+
+//===----------------------------------------------------------------------===//
+// TransposeViewOp
+//===----------------------------------------------------------------------===//
+
+static ParseResult parseTransposeViewOp(OpAsmParser &parser,
+                                        OperationState &result) {
+  SmallVector<OpAsmParser::OperandType, 2> operands;
+  if (parser.parseOperandList(operands, /*requiredOperandCount=*/2))
+    return failure();
+
+  auto tensorType = getTensorType(result.getContext());
+  auto chainType = getChainType(result.getContext());
+
+  Attribute permutationAttr;
+  return failure(
+      parser.resolveOperand(operands[0], tensorType, result.operands) ||
+      parser.resolveOperand(operands[1], chainType, result.operands) ||
+      parser.parseAttribute(permutationAttr, "permutation",
+                            result.attributes) ||
+      parser.addTypeToList(tensorType, result.types) ||
+      parser.addTypeToList(chainType, result.types));
+}
+
+template <typename TransposeViewOp>
+static void printTransposeViewOp(OpAsmPrinter &p, TransposeViewOp op) {
+  p << TransposeViewOp::getOperationName() << " ";
+  p.printOperands(op.getOperands());
+  p << " " << op.getAttr("permutation");
+}
+
+//===----------------------------------------------------------------------===//
+// ReshapeViewOp
+//===----------------------------------------------------------------------===//
+
+static ParseResult parseReshapeViewOp(OpAsmParser &parser,
+                                      OperationState &result) {
+  SmallVector<OpAsmParser::OperandType, 2> operands;
+  if (parser.parseOperandList(operands, /*requiredOperandCount=*/2))
+    return failure();
+
+  auto tensorType = getTensorType(result.getContext());
+  auto chainType = getChainType(result.getContext());
+
+  Attribute shapeAttr;
+  return failure(
+      parser.resolveOperand(operands[0], tensorType, result.operands) ||
+      parser.resolveOperand(operands[1], chainType, result.operands) ||
+      parser.parseAttribute(shapeAttr, "shape", result.attributes) ||
+      parser.addTypeToList(tensorType, result.types) ||
+      parser.addTypeToList(chainType, result.types));
+}
+
+template <typename ReshapeViewOp>
+static void printReshapeViewOp(OpAsmPrinter &p, ReshapeViewOp op) {
+  p << ReshapeViewOp::getOperationName() << " ";
+  p.printOperands(op.getOperands());
+  p << " " << op.getAttr("shape");
+}
+
 //===----------------------------------------------------------------------===//
 // TableGen'd op method definitions
 //===----------------------------------------------------------------------===//
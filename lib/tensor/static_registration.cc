@@ -21,7 +21,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "tfrt/host_context/kernel_registry.h"
+#include "tfrt/tensor/collective_kernels.h"
 #include "tfrt/tensor/coo_host_tensor.h"
+#include "tfrt/tensor/csr_host_tensor.h"
 #include "tfrt/tensor/dense_host_tensor_kernels.h"
 #include "tfrt/tensor/dense_host_tensor_view.h"
 #include "tfrt/tensor/string_host_tensor_kernels.h"
@@ -33,10 +35,12 @@ namespace tfrt {
 static void Register(KernelRegistry* registry) {
   RegisterTensorShapeKernels(registry);
   RegisterDenseHostTensorKernels(registry);
+  RegisterCollectiveKernels(registry);
   RegisterCooHostTensorKernels(registry);
+  RegisterCsrHostTensorKernels(registry);
   RegisterStringHostTensorKernels(registry);
 }
 
-TFRT_STATIC_KERNEL_REGISTRATION(Register);
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(Register, "dht,coo,csr,sht,ts");
 
 }  // namespace tfrt
@@ -20,21 +20,54 @@
 
 #include "tfrt/tensor/string_host_tensor.h"
 
+#include <cstring>
+
 #include "llvm/Support/MD5.h"
 #include "llvm/Support/raw_ostream.h"
 #include "tfrt/host_context/host_context.h"
 
 namespace tfrt {
 
+llvm::Optional<StringHostTensor> StringHostTensor::CreateFromStrings(
+    const TensorMetadata& metadata, ArrayRef<string_view> values,
+    HostContext* host) {
+  auto num_elements = metadata.shape.GetNumElements();
+  if (static_cast<ssize_t>(values.size()) != num_elements) return llvm::None;
+
+  size_t arena_size = 0;
+  for (string_view value : values) arena_size += value.size();
+
+  HostArray<char> arena(arena_size, host->allocator());
+  HostArray<string_view> strings(num_elements, host->allocator());
+
+  char* data = arena.mutable_array().data();
+  size_t offset = 0;
+  for (ssize_t i = 0; i != num_elements; ++i) {
+    string_view value = values[i];
+    std::memcpy(data + offset, value.data(), value.size());
+    new (&strings.mutable_array()[i]) string_view(data + offset, value.size());
+    offset += value.size();
+  }
+
+  return StringHostTensor(metadata, std::move(arena), std::move(strings));
+}
+
 llvm::Optional<StringHostTensor> StringHostTensor::CreateUninitialized(
     const TensorMetadata& metadata, HostContext* host) {
   auto num_elements = metadata.shape.GetNumElements();
-  HostArray<std::string> strings(num_elements, host->allocator());
+  HostArray<string_view> strings(num_elements, host->allocator());
   for (auto& str : strings.mutable_array()) {
-    new (&str) std::string();
+    new (&str) string_view();
   }
 
-  return StringHostTensor(metadata, std::move(strings));
+  return StringHostTensor(metadata, HostArray<char>(), std::move(strings));
+}
+
+SmallVector<std::string, 8> StringHostTensor::CopyToStdStrings() const {
+  SmallVector<std::string, 8> result;
+  result.reserve(strings().size());
+  for (string_view str : strings()) result.push_back(str.str());
+  return result;
 }
 
 AsyncValueRef<StringHostTensor> StringHostTensor::MakeConstructedAsyncValueRef(
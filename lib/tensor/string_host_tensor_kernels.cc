@@ -29,18 +29,20 @@ namespace {
 
 llvm::Expected<StringHostTensor> CreateStringTensor(
     ArrayAttribute<ssize_t> shape, AggregateAttr values, HostContext* host) {
-  auto result = StringHostTensor::CreateUninitialized(
-      TensorMetadata(DType(DType::String), shape.data()), host);
-  if (!result) {
-    return MakeStringError("Failed to create SHT");
-  }
-
-  auto strings = result->strings();
-  if (strings.size() != values.GetNumElements()) {
+  TensorMetadata metadata(DType(DType::String), shape.data());
+  if (metadata.shape.GetNumElements() != values.GetNumElements()) {
     return MakeStringError("Shape mismatch");
   }
+
+  SmallVector<string_view, 8> values_sv;
+  values_sv.reserve(values.GetNumElements());
   for (int i = 0, e = values.GetNumElements(); i != e; ++i) {
-    strings[i] = values.GetAttributeOfType<StringAttr>(i).GetValue().str();
+    values_sv.push_back(values.GetAttributeOfType<StringAttr>(i).GetValue());
+  }
+
+  auto result = StringHostTensor::CreateFromStrings(metadata, values_sv, host);
+  if (!result) {
+    return MakeStringError("Failed to create SHT");
   }
 
   return std::move(result).getValue();
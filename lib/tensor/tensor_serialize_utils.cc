@@ -22,6 +22,8 @@
 #include "tfrt/tensor/tensor_serialize_utils.h"
 
 #include "tfrt/host_context/attribute_utils.h"
+#include "tfrt/host_context/host_buffer.h"
+#include "tfrt/host_context/shared_memory_region.h"
 #include "tfrt/support/byte_order.h"
 #include "tfrt/support/error_util.h"
 #include "tfrt/tensor/dense_host_tensor.h"
@@ -127,6 +129,142 @@ llvm::Expected<DenseHostTensor> DeserializeDenseHostTensorFromDenseAttr(
   return std::move(result_tensor);
 }
 
+DenseHostTensor CreateDenseHostTensorAliasingDenseAttr(DenseAttr attr) {
+  auto metadata = CreateTensorMetadata(attr);
+  void* data = const_cast<void*>(attr.GetElements());
+  assert(reinterpret_cast<uintptr_t>(data) %
+                 metadata.dtype.GetHostAlignment() ==
+             0 &&
+         "dense attribute payload is not aligned for aliasing");
+  size_t size = metadata.dtype.GetHostSize() * metadata.shape.GetNumElements();
+  // The buffer does not own the bytes: they live in the BEF file, whose
+  // lifetime the caller guarantees.
+  auto buffer =
+      HostBuffer::CreateFromExternal(data, size, [](void*, size_t) {});
+  return DenseHostTensor(metadata, std::move(buffer));
+}
+
+namespace {
+
+// Fixed-size prefix of a shared-memory tensor message; `rank` dimension
+// sizes (int64_t each) follow. The peers share an architecture, so the
+// encoding is host-endian like the dense-attr path above.
+struct ShmTensorMessage {
+  uint32_t dtype_kind;
+  uint32_t rank;
+  uint64_t buffer_offset;
+};
+
+}  // namespace
+
+llvm::Expected<std::vector<uint8_t>> SerializeDenseHostTensorToShmMessage(
+    const DenseHostTensor& dht, SharedMemoryRegion* region) {
+  auto offset = region->ExportBuffer(*dht.buffer());
+  if (!offset) return offset.takeError();
+
+  const auto& md = dht.metadata();
+  ShmTensorMessage header;
+  header.dtype_kind = static_cast<uint32_t>(md.dtype.kind());
+  header.rank = md.shape.GetRank();
+  header.buffer_offset = *offset;
+
+  std::vector<uint8_t> message(sizeof(ShmTensorMessage) +
+                               header.rank * sizeof(int64_t));
+  std::memcpy(message.data(), &header, sizeof(ShmTensorMessage));
+  auto* dims =
+      reinterpret_cast<int64_t*>(message.data() + sizeof(ShmTensorMessage));
+  for (uint32_t i = 0; i < header.rank; ++i)
+    dims[i] = md.shape.GetDimensionSize(i);
+  return message;
+}
+
+llvm::Expected<DenseHostTensor> DeserializeDenseHostTensorFromShmMessage(
+    llvm::ArrayRef<uint8_t> message, RCReference<SharedMemoryRegion> region) {
+  ShmTensorMessage header;
+  if (message.size() < sizeof(ShmTensorMessage))
+    return MakeStringError("truncated shared memory tensor message");
+  std::memcpy(&header, message.data(), sizeof(ShmTensorMessage));
+  if (message.size() !=
+      sizeof(ShmTensorMessage) + header.rank * sizeof(int64_t))
+    return MakeStringError("truncated shared memory tensor message");
+
+  DType dtype(static_cast<DType::Kind>(header.dtype_kind));
+  if (dtype.IsInvalid())
+    return MakeStringError("invalid dtype in shared memory tensor message");
+  SmallVector<ssize_t, 4> dims(header.rank);
+  std::memcpy(dims.data(), message.data() + sizeof(ShmTensorMessage),
+              header.rank * sizeof(int64_t));
+  TensorMetadata md(dtype, dims);
+
+  auto buffer = region->ImportBuffer(header.buffer_offset);
+  if (!buffer) return buffer.takeError();
+  size_t byte_size = md.GetHostSizeInBytes();
+  if ((*buffer)->size() < byte_size)
+    return MakeStringError("shared memory block smaller than tensor payload");
+  return DenseHostTensor(md, std::move(*buffer));
+}
+
+namespace {
+
+// Fixed-size prefix of a scatter-gather tensor message; `rank` dimension
+// sizes (int64_t each) follow, then the payload bytes.
+struct WireTensorHeader {
+  uint32_t dtype_kind;
+  uint32_t rank;
+};
+
+}  // namespace
+
+size_t SerializedTensorHeaderSize(int rank) {
+  return sizeof(WireTensorHeader) + rank * sizeof(int64_t);
+}
+
+llvm::Expected<size_t> SerializeDenseHostTensorScatterGather(
+    const DenseHostTensor& dht, llvm::MutableArrayRef<uint8_t> header,
+    SmallVectorImpl<TensorIoVec>* iovs) {
+  const auto& md = dht.metadata();
+  const int rank = md.shape.GetRank();
+  const size_t header_size = SerializedTensorHeaderSize(rank);
+  if (header.size() < header_size) {
+    return MakeStringError("tensor header buffer holds ", header.size(),
+                           " bytes; need ", header_size);
+  }
+
+  WireTensorHeader wire_header;
+  wire_header.dtype_kind = static_cast<uint32_t>(md.dtype.kind());
+  wire_header.rank = rank;
+  std::memcpy(header.data(), &wire_header, sizeof(WireTensorHeader));
+  auto* dims =
+      reinterpret_cast<int64_t*>(header.data() + sizeof(WireTensorHeader));
+  for (int i = 0; i < rank; ++i) dims[i] = md.shape.GetDimensionSize(i);
+
+  // The payload entry points at the tensor's own buffer; the transport
+  // gathers it in place and no payload copy is made.
+  const size_t payload_size = md.GetHostSizeInBytes();
+  iovs->push_back(TensorIoVec{header.data(), header_size});
+  iovs->push_back(TensorIoVec{dht.data(), payload_size});
+  return header_size + payload_size;
+}
+
+llvm::Expected<TensorMetadata> ParseSerializedTensorHeader(
+    llvm::ArrayRef<uint8_t> header) {
+  WireTensorHeader wire_header;
+  if (header.size() < sizeof(WireTensorHeader))
+    return MakeStringError("truncated serialized tensor header");
+  std::memcpy(&wire_header, header.data(), sizeof(WireTensorHeader));
+  if (header.size() <
+      sizeof(WireTensorHeader) + wire_header.rank * sizeof(int64_t))
+    return MakeStringError("truncated serialized tensor header");
+
+  DType dtype(static_cast<DType::Kind>(wire_header.dtype_kind));
+  if (dtype.IsInvalid())
+    return MakeStringError("invalid dtype in serialized tensor header");
+  SmallVector<ssize_t, 4> dims(wire_header.rank);
+  std::memcpy(dims.data(), header.data() + sizeof(WireTensorHeader),
+              wire_header.rank * sizeof(int64_t));
+  return TensorMetadata(dtype, dims);
+}
+
 TensorMetadata CreateTensorMetadata(const DenseAttr& attr) {
   return CreateDenseView(attr).metadata();
 }
@@ -21,11 +21,61 @@
 #include "tfrt/tensor/tensor_shape.h"
 
 #include <algorithm>
+#include <vector>
 
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/raw_ostream.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
 
 namespace tfrt {
+namespace {
+
+// Process-wide interning table for the out-of-line dimension arrays used by
+// the external representation of TensorShape.  Interning guarantees that
+// identical shapes share one canonical immutable array, so copying an
+// external shape is a plain 16-byte copy and comparing two external shapes
+// is a pointer compare.
+//
+// The table is append-only and entries are never freed: workloads see a small
+// number of distinct shapes, and only shapes with rank > 7 or very large
+// dimensions reach the external representation at all, so a linear scan under
+// a mutex is plenty fast for the construction path.
+class ExternalDimsTable {
+ public:
+  // Return the canonical dimension array for `dims`, creating it on first
+  // use.
+  const size_t* GetCanonicalDims(ArrayRef<ssize_t> dims) {
+    mutex_lock lock(mu_);
+    for (const auto& entry : entries_) {
+      if (entry.rank == dims.size() &&
+          memcmp(entry.dims, dims.data(), dims.size() * sizeof(size_t)) == 0)
+        return entry.dims;
+    }
+    auto* elts = new size_t[dims.size()];
+    memcpy(elts, dims.data(), sizeof(size_t) * dims.size());
+    entries_.push_back({elts, dims.size()});
+    return elts;
+  }
+
+ private:
+  struct Entry {
+    const size_t* dims;
+    size_t rank;
+  };
+
+  mutex mu_;
+  std::vector<Entry> entries_ TFRT_GUARDED_BY(mu_);
+};
+
+ExternalDimsTable* GetExternalDimsTable() {
+  // Intentionally leaked: the canonical arrays must outlive any TensorShape,
+  // including ones destroyed during static destruction.
+  static auto* table = new ExternalDimsTable();
+  return table;
+}
+
+}  // namespace
 
 raw_ostream& operator<<(raw_ostream& os, const TensorShape& value) {
   os << '[';
@@ -104,10 +154,11 @@ TensorShape::TensorShape(ArrayRef<ssize_t> dims) {
     ++next_dim;
   }
 
-  // Otherwise, nothing fits, use the most general representation.
-  auto* elts = new size_t[rank];
-  memcpy(elts, dims.data(), sizeof(size_t) * rank);
-  representation_.rep_external.dims = elts;
+  // Otherwise, nothing fits, use the most general representation.  The
+  // dimension array is interned so identical shapes share one canonical
+  // allocation.
+  representation_.rep_external.dims =
+      GetExternalDimsTable()->GetCanonicalDims(dims);
   representation_.rep_external.rank = rank;
   representation_.rep_external.kind = RepKind::kRepExternal;
 }
@@ -121,11 +172,10 @@ bool TensorShape::operator==(const TensorShape& other) const {
     return memcmp(&representation_, &other.representation_,
                   sizeof(representation_)) == 0;
   }
-  if (GetRank() != other.GetRank()) return false;
-  return std::equal(representation_.rep_external.dims,
-                    representation_.rep_external.dims + GetRank(),
-                    other.representation_.rep_external.dims);
-  return true;
+  // External dimension arrays are interned, so identical shapes share the
+  // same canonical array and equality is pointer equality.
+  return representation_.rep_external.dims ==
+         other.representation_.rep_external.dims;
 }
 
 bool TensorShape::operator!=(const TensorShape& other) const {
@@ -37,7 +37,8 @@ static void RegisterExampleKernels(KernelRegistry* registry) {
   RegisterTutorialKernels(registry);
 }
 
-TFRT_STATIC_KERNEL_REGISTRATION(RegisterExampleKernels);
+TFRT_STATIC_KERNEL_REGISTRATION_PREFIXED(
+    RegisterExampleKernels, "tfrt_test,hex,tfrt_tutorial,vt");
 
 static bool kRegisterTestNativeFunctions = []() {
   RegisterTestNativeFunctions(&NativeFunctionRegistry::GetGlobalRegistry());
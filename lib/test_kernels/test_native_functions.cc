@@ -25,16 +25,9 @@
 namespace tfrt {
 namespace {
 
-void NativeAdd(AsyncValue* const* arguments, int num_arguments,
-               RCReference<AsyncValue>* results, int num_results,
-               HostContext* host) {
-  assert(num_arguments == 2);
-  int32_t a = arguments[0]->get<int32_t>();
-  int32_t b = arguments[1]->get<int32_t>();
-
-  assert(num_results == 1);
-  results[0] = host->MakeAvailableAsyncValueRef<int32_t>(a + b);
-}
+// Written as an ordinary C++ function; the TFRT_NATIVE_FUNCTION trampoline
+// below unpacks the available arguments into registers and boxes the result.
+int32_t NativeAdd(int32_t a, int32_t b) { return a + b; }
 
 void NativeAsyncAdd(AsyncValue* const* arguments, int num_arguments,
                     RCReference<AsyncValue>* results, int num_results,
@@ -57,7 +50,7 @@ void NativeError(AsyncValue* const* arguments, int num_arguments,
 }  // namespace
 
 void RegisterTestNativeFunctions(NativeFunctionRegistry* registry) {
-  registry->Add("native_add", NativeAdd);
+  registry->Add("native_add", TFRT_NATIVE_FUNCTION(NativeAdd));
   registry->Add("native_async_add", NativeAsyncAdd);
   registry->Add("native_error", NativeError);
 }
@@ -0,0 +1,81 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- kernel_cycle_tracing.cc - Per-kernel cycle tracing -----------------===//
+//
+// This file implements the per-thread kernel cycle trace buffers.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tracing/kernel_cycle_tracing.h"
+
+#include "llvm/ADT/SmallVector.h"
+
+namespace tfrt {
+namespace tracing {
+
+namespace internal {
+std::atomic<bool> kKernelCycleTracingEnabled{false};
+}  // namespace internal
+
+// The registry of all threads' buffers. Buffers are registered once per
+// thread and are never removed: a thread's records must remain drainable
+// after the thread exits, and the buffers are small.
+static mutex* GetBufferRegistryMutex() {
+  static mutex* mu = new mutex;
+  return mu;
+}
+
+static std::vector<KernelCycleTraceBuffer*>* GetBufferRegistry() {
+  static auto* registry = new std::vector<KernelCycleTraceBuffer*>;
+  return registry;
+}
+
+KernelCycleTraceBuffer* KernelCycleTraceBuffer::GetForCurrentThread() {
+  thread_local KernelCycleTraceBuffer* buffer = [] {
+    auto* new_buffer = new KernelCycleTraceBuffer;
+    mutex_lock lock(*GetBufferRegistryMutex());
+    GetBufferRegistry()->push_back(new_buffer);
+    return new_buffer;
+  }();
+  return buffer;
+}
+
+void KernelCycleTraceBuffer::ConsumeAll(
+    llvm::function_ref<void(const KernelCycleRecord&)> consumer) {
+  // Snapshot the registry, then drain each buffer under its own lock so
+  // recording threads are blocked only for the swap of their own buffer.
+  llvm::SmallVector<KernelCycleTraceBuffer*, 16> buffers;
+  {
+    mutex_lock lock(*GetBufferRegistryMutex());
+    buffers.assign(GetBufferRegistry()->begin(), GetBufferRegistry()->end());
+  }
+
+  for (KernelCycleTraceBuffer* buffer : buffers) {
+    std::vector<KernelCycleRecord> records;
+    {
+      mutex_lock lock(buffer->mu_);
+      records.swap(buffer->records_);
+    }
+    for (const KernelCycleRecord& record : records) consumer(record);
+  }
+}
+
+void SetKernelCycleTracingEnabled(bool enabled) {
+  internal::kKernelCycleTracingEnabled.store(enabled,
+                                             std::memory_order_relaxed);
+}
+
+}  // namespace tracing
+}  // namespace tfrt
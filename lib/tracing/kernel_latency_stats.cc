@@ -0,0 +1,209 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- kernel_latency_stats.cc - Per-kernel latency aggregation -----------===//
+//
+// This file implements the per-thread kernel latency tables and their merge
+// into the global aggregate published through the metrics API.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tracing/kernel_latency_stats.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MathExtras.h"
+#include "tfrt/metrics/metrics_api.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+
+namespace tfrt {
+namespace tracing {
+
+namespace internal {
+std::atomic<bool> kKernelLatencyAggregationEnabled{false};
+}  // namespace internal
+
+namespace {
+
+// Per-invocation latencies 2^0 ... 2^31 cycles and larger get one histogram
+// bucket per power of two; the p99 estimate is the upper bound of the bucket
+// the 99th percentile invocation falls into.
+constexpr int kNumLatencyBuckets = 32;
+
+// Number of kernels published to the metrics gauge on merge.
+constexpr int kNumPublishedKernels = 10;
+
+struct KernelStats {
+  uint64_t invocations = 0;
+  uint64_t total_cycles = 0;
+  uint64_t buckets[kNumLatencyBuckets] = {};
+
+  void Account(uint64_t cycles) {
+    ++invocations;
+    total_cycles += cycles;
+    unsigned bucket = llvm::Log2_64(cycles | 1);
+    if (bucket >= kNumLatencyBuckets) bucket = kNumLatencyBuckets - 1;
+    ++buckets[bucket];
+  }
+
+  void Merge(const KernelStats& other) {
+    invocations += other.invocations;
+    total_cycles += other.total_cycles;
+    for (int b = 0; b < kNumLatencyBuckets; ++b) buckets[b] += other.buckets[b];
+  }
+
+  uint64_t P99Cycles() const {
+    const uint64_t rank = invocations - invocations / 100;
+    uint64_t seen = 0;
+    for (int b = 0; b < kNumLatencyBuckets; ++b) {
+      seen += buckets[b];
+      if (seen >= rank) return uint64_t{1} << (b + 1);
+    }
+    return 0;
+  }
+};
+
+// The table of one executing thread, keyed by the kernel name pointer (names
+// point into the BEF string section, so one kernel has one pointer). Only
+// the owning thread inserts; the mutex is uncontended in steady state and
+// synchronizes with the merge.
+class ThreadLatencyTable {
+ public:
+  // Return the table for the calling thread, creating and registering it on
+  // first use. Tables are never removed: like the cycle trace buffers, a
+  // thread's counts must remain mergeable after the thread exits.
+  static ThreadLatencyTable* GetForCurrentThread();
+
+  void Account(const char* kernel_name, uint64_t cycles) {
+    mutex_lock lock(mu_);
+    stats_[kernel_name].Account(cycles);
+  }
+
+  llvm::DenseMap<const char*, KernelStats> Take() {
+    mutex_lock lock(mu_);
+    llvm::DenseMap<const char*, KernelStats> taken;
+    taken.swap(stats_);
+    return taken;
+  }
+
+ private:
+  ThreadLatencyTable() = default;
+
+  mutex mu_;
+  llvm::DenseMap<const char*, KernelStats> stats_ TFRT_GUARDED_BY(mu_);
+};
+
+mutex* GetTableRegistryMutex() {
+  static mutex* mu = new mutex;
+  return mu;
+}
+
+std::vector<ThreadLatencyTable*>* GetTableRegistry() {
+  static auto* registry = new std::vector<ThreadLatencyTable*>;
+  return registry;
+}
+
+// The merged aggregate, keyed by kernel name contents so kernels keep their
+// identity across BEF files and reloads.
+mutex* GetAggregateMutex() {
+  static mutex* mu = new mutex;
+  return mu;
+}
+
+llvm::StringMap<KernelStats>* GetAggregate() {
+  static auto* aggregate = new llvm::StringMap<KernelStats>;
+  return aggregate;
+}
+
+}  // namespace
+
+ThreadLatencyTable* ThreadLatencyTable::GetForCurrentThread() {
+  thread_local ThreadLatencyTable* table = [] {
+    auto* new_table = new ThreadLatencyTable;
+    mutex_lock lock(*GetTableRegistryMutex());
+    GetTableRegistry()->push_back(new_table);
+    return new_table;
+  }();
+  return table;
+}
+
+void SetKernelLatencyAggregationEnabled(bool enabled) {
+  internal::kKernelLatencyAggregationEnabled.store(enabled,
+                                                   std::memory_order_relaxed);
+}
+
+void RecordKernelLatency(const char* kernel_name, uint64_t cycles) {
+  ThreadLatencyTable::GetForCurrentThread()->Account(kernel_name, cycles);
+}
+
+void MergeKernelLatencyStats() {
+  llvm::SmallVector<ThreadLatencyTable*, 16> tables;
+  {
+    mutex_lock lock(*GetTableRegistryMutex());
+    tables.assign(GetTableRegistry()->begin(), GetTableRegistry()->end());
+  }
+
+  {
+    mutex_lock lock(*GetAggregateMutex());
+    llvm::StringMap<KernelStats>& aggregate = *GetAggregate();
+    for (ThreadLatencyTable* table : tables) {
+      for (const auto& entry : table->Take()) {
+        aggregate[entry.first].Merge(entry.second);
+      }
+    }
+  }
+
+  // Refresh the published top-N summary. The gauge value is one line per
+  // kernel, ordered by total cycles.
+  static metrics::Gauge<std::string>* top_kernels_gauge =
+      metrics::NewGauge<std::string>("bef_executor.top_kernels_by_cycles");
+  std::string summary;
+  for (const KernelLatencySummary& kernel :
+       TopKernelsByTotalCycles(kNumPublishedKernels)) {
+    char line[256];
+    snprintf(line, sizeof(line),
+             "%s: total_cycles=%llu invocations=%llu p99_cycles=%llu\n",
+             kernel.name.c_str(),
+             static_cast<unsigned long long>(kernel.total_cycles),
+             static_cast<unsigned long long>(kernel.invocations),
+             static_cast<unsigned long long>(kernel.p99_cycles));
+    summary += line;
+  }
+  top_kernels_gauge->SetValue(std::move(summary));
+}
+
+std::vector<KernelLatencySummary> TopKernelsByTotalCycles(int n) {
+  std::vector<KernelLatencySummary> kernels;
+  {
+    mutex_lock lock(*GetAggregateMutex());
+    for (const auto& entry : *GetAggregate()) {
+      kernels.push_back({entry.first().str(), entry.second.invocations,
+                         entry.second.total_cycles, entry.second.P99Cycles()});
+    }
+  }
+  std::sort(kernels.begin(), kernels.end(),
+            [](const KernelLatencySummary& a, const KernelLatencySummary& b) {
+              return a.total_cycles > b.total_cycles;
+            });
+  if (kernels.size() > static_cast<size_t>(n)) kernels.resize(n);
+  return kernels;
+}
+
+}  // namespace tracing
+}  // namespace tfrt
@@ -0,0 +1,149 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- kernel_sampling_profiler.cc - Kernel-tagged CPU sampling -----------===//
+//
+// This file implements the SIGPROF-based kernel sampler. Everything the
+// signal handler touches is lock-free and allocation-free: samples land in a
+// fixed-size open-addressing table of (kernel name pointer, hit count) pairs
+// claimed with a compare-exchange, so taking a sample is async-signal-safe.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tfrt/tracing/kernel_sampling_profiler.h"
+
+#include <sys/time.h>
+
+#include <csignal>
+#include <cstdint>
+
+#include "llvm/Support/raw_ostream.h"
+
+namespace tfrt {
+namespace tracing {
+
+namespace internal {
+thread_local std::atomic<const char*> kCurrentKernelName{nullptr};
+}  // namespace internal
+
+namespace {
+
+// Fixed sample table size. Kernel names come from loaded BEF files, so the
+// number of distinct pointers is small; 1024 slots with linear probing keeps
+// the load factor low for any realistic program.
+constexpr int kTableSize = 1024;
+
+struct SampleSlot {
+  std::atomic<const char*> name{nullptr};
+  std::atomic<uint64_t> count{0};
+};
+
+SampleSlot sample_table[kTableSize];
+
+// Samples taken while the interrupted thread had no current kernel.
+std::atomic<uint64_t> idle_samples{0};
+
+// Samples dropped because the table was full (should not happen in
+// practice; reported so a truncated profile is never silent).
+std::atomic<uint64_t> dropped_samples{0};
+
+std::atomic<bool> sampler_running{false};
+struct sigaction previous_sigprof_action;
+
+// Charges one hit to `name`. Async-signal-safe: linear probing with a
+// compare-exchange to claim an empty slot, relaxed increments elsewhere.
+void RecordSample(const char* name) {
+  auto hash = reinterpret_cast<uintptr_t>(name);
+  hash ^= hash >> 33;
+  for (int probe = 0; probe < kTableSize; ++probe) {
+    SampleSlot& slot = sample_table[(hash + probe) % kTableSize];
+    const char* existing = slot.name.load(std::memory_order_relaxed);
+    if (existing == nullptr) {
+      if (!slot.name.compare_exchange_strong(existing, name,
+                                             std::memory_order_relaxed)) {
+        if (existing != name) continue;  // Lost the race to another kernel.
+      }
+      slot.count.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (existing == name) {
+      slot.count.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  }
+  dropped_samples.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SigprofHandler(int /*signum*/) {
+  const char* name = GetCurrentKernelForSampling();
+  if (name == nullptr) {
+    idle_samples.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    RecordSample(name);
+  }
+}
+
+}  // namespace
+
+bool StartKernelSampler(int samples_per_second) {
+  if (samples_per_second <= 0) return false;
+  bool expected = false;
+  if (!sampler_running.compare_exchange_strong(expected, true)) return false;
+
+  struct sigaction action;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  action.sa_handler = SigprofHandler;
+  if (sigaction(SIGPROF, &action, &previous_sigprof_action) != 0) {
+    sampler_running.store(false);
+    return false;
+  }
+
+  const long interval_us = 1000000 / samples_per_second;  // NOLINT
+  struct itimerval timer;
+  timer.it_interval.tv_sec = interval_us / 1000000;
+  timer.it_interval.tv_usec = interval_us % 1000000;
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    sigaction(SIGPROF, &previous_sigprof_action, nullptr);
+    sampler_running.store(false);
+    return false;
+  }
+  return true;
+}
+
+void StopKernelSampler() {
+  bool expected = true;
+  if (!sampler_running.compare_exchange_strong(expected, false)) return;
+
+  struct itimerval timer = {};
+  setitimer(ITIMER_PROF, &timer, nullptr);
+  sigaction(SIGPROF, &previous_sigprof_action, nullptr);
+}
+
+void WriteFoldedKernelSamples(raw_ostream& os) {
+  for (SampleSlot& slot : sample_table) {
+    const char* name = slot.name.load(std::memory_order_relaxed);
+    if (name == nullptr) continue;
+    uint64_t count = slot.count.exchange(0, std::memory_order_relaxed);
+    if (count != 0) os << "bef_executor;" << name << " " << count << "\n";
+  }
+  uint64_t idle = idle_samples.exchange(0, std::memory_order_relaxed);
+  if (idle != 0) os << "bef_executor;<no kernel> " << idle << "\n";
+  uint64_t dropped = dropped_samples.exchange(0, std::memory_order_relaxed);
+  if (dropped != 0) os << "bef_executor;<dropped> " << dropped << "\n";
+}
+
+}  // namespace tracing
+}  // namespace tfrt
@@ -0,0 +1,256 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- ring_buffer_tracing_sink.cc ----------------------------------------===//
+//
+// This file implements a tracing sink that appends fixed-size binary records
+// to per-thread ring buffers. Unlike the simple sink, recording takes no
+// process-wide lock and allocates nothing in the steady state: the name is
+// looked up in a thread-local intern cache and the record lands in a ring
+// only this thread writes, so tracing does not perturb the schedules being
+// observed. WriteChromeTrace() exports everything buffered as Chrome
+// trace-event JSON for chrome://tracing or Perfetto.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef NO_TFRT_TRACING
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include "tfrt/support/mutex.h"
+#include "tfrt/support/thread_annotations.h"
+#include "tfrt/tracing/ring_buffer_tracing_sink/ring_buffer_tracing_sink.h"
+#include "tfrt/tracing/tracing.h"
+
+namespace tfrt {
+namespace internal {
+namespace tracing {
+
+namespace {
+
+// Per-thread ring capacity. At 24 bytes per record a thread retains the last
+// 64K events in 1.5MB.
+constexpr size_t kRecordsPerThread = 1 << 16;
+
+static auto ring_process_start = CurrentSteadyClockTime();
+
+// One fixed-size binary trace record. Times are nanoseconds since process
+// start; end_ns is 0 for instant events.
+struct TraceRecord {
+  uint64_t start_ns;
+  uint64_t end_ns;
+  uint32_t name_id;
+};
+
+uint64_t ToNanos(SteadyTimePoint time_point) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             time_point - ring_process_start)
+      .count();
+}
+
+// Global activity-title intern table. Each recording thread keeps its own
+// name-to-id cache, so the table lock is only taken the first time a thread
+// sees a title.
+class NameTable {
+ public:
+  static NameTable& Get() {
+    static NameTable* table = new NameTable();
+    return *table;
+  }
+
+  uint32_t Intern(const std::string& name) {
+    mutex_lock lock(mu_);
+    auto it = ids_.try_emplace(name, names_.size());
+    if (it.second) names_.push_back(name);
+    return it.first->second;
+  }
+
+  std::string Name(uint32_t id) const {
+    mutex_lock lock(mu_);
+    return names_[id];
+  }
+
+ private:
+  mutable mutex mu_;
+  llvm::StringMap<uint32_t> ids_ TFRT_GUARDED_BY(mu_);
+  std::vector<std::string> names_ TFRT_GUARDED_BY(mu_);
+};
+
+class ThreadRing;
+
+// Global registry of live rings, plus the contents of rings whose threads
+// have exited; WriteChromeTrace() walks both.
+class RingRegistry {
+ public:
+  static RingRegistry& Get() {
+    static RingRegistry* registry = new RingRegistry();
+    return *registry;
+  }
+
+  int Register(ThreadRing* ring) {
+    mutex_lock lock(mu_);
+    rings_.push_back(ring);
+    return next_tid_++;
+  }
+
+  void Retire(ThreadRing* ring, int tid, std::vector<TraceRecord> records) {
+    mutex_lock lock(mu_);
+    rings_.erase(std::remove(rings_.begin(), rings_.end(), ring),
+                 rings_.end());
+    retired_.emplace_back(tid, std::move(records));
+  }
+
+  // Snapshots every live and retired ring as (tid, records) pairs, oldest
+  // record first.
+  std::vector<std::pair<int, std::vector<TraceRecord>>> Snapshot() const;
+
+ private:
+  mutable mutex mu_;
+  int next_tid_ TFRT_GUARDED_BY(mu_) = 0;
+  std::vector<ThreadRing*> rings_ TFRT_GUARDED_BY(mu_);
+  std::vector<std::pair<int, std::vector<TraceRecord>>> retired_
+      TFRT_GUARDED_BY(mu_);
+};
+
+// The ring buffer of one recording thread. Only its owner thread pushes, so
+// the per-ring mutex is uncontended except while an export snapshots it.
+class ThreadRing {
+ public:
+  ThreadRing() : tid_(RingRegistry::Get().Register(this)) {}
+
+  ~ThreadRing() {
+    RingRegistry::Get().Retire(this, tid_, Snapshot());
+  }
+
+  void Push(const TraceRecord& record) {
+    mutex_lock lock(mu_);
+    if (records_.size() < kRecordsPerThread) {
+      records_.push_back(record);
+    } else {
+      records_[next_ % kRecordsPerThread] = record;
+    }
+    ++next_;
+  }
+
+  int tid() const { return tid_; }
+
+  // Returns the buffered records, oldest first.
+  std::vector<TraceRecord> Snapshot() const {
+    mutex_lock lock(mu_);
+    if (records_.size() < kRecordsPerThread) return records_;
+    std::vector<TraceRecord> snapshot;
+    snapshot.reserve(kRecordsPerThread);
+    const size_t oldest = next_ % kRecordsPerThread;
+    snapshot.insert(snapshot.end(), records_.begin() + oldest, records_.end());
+    snapshot.insert(snapshot.end(), records_.begin(),
+                    records_.begin() + oldest);
+    return snapshot;
+  }
+
+ private:
+  const int tid_;
+  mutable mutex mu_;
+  std::vector<TraceRecord> records_ TFRT_GUARDED_BY(mu_);
+  uint64_t next_ TFRT_GUARDED_BY(mu_) = 0;
+};
+
+std::vector<std::pair<int, std::vector<TraceRecord>>> RingRegistry::Snapshot()
+    const {
+  mutex_lock lock(mu_);
+  std::vector<std::pair<int, std::vector<TraceRecord>>> snapshot = retired_;
+  for (const ThreadRing* ring : rings_) {
+    snapshot.emplace_back(ring->tid(), ring->Snapshot());
+  }
+  return snapshot;
+}
+
+// Thread-local id cache in front of the global intern table.
+uint32_t InternName(const std::string& name) {
+  static thread_local llvm::StringMap<uint32_t>* cache =
+      new llvm::StringMap<uint32_t>();
+  auto it = cache->find(name);
+  if (it != cache->end()) return it->second;
+  uint32_t id = NameTable::Get().Intern(name);
+  cache->try_emplace(name, id);
+  return id;
+}
+
+// Formats nanoseconds as fractional microseconds (the trace-event time
+// unit), keeping full nanosecond resolution.
+llvm::format_object<unsigned long long, unsigned long long> MicrosWithNanos(
+    uint64_t nanos) {
+  return llvm::format("%llu.%03llu",
+                      static_cast<unsigned long long>(nanos / 1000),
+                      static_cast<unsigned long long>(nanos % 1000));
+}
+
+void WriteJsonEscaped(raw_ostream& os, const std::string& text) {
+  for (char c : text) {
+    if (c == '"' || c == '\\') os << '\\';
+    os << c;
+  }
+}
+
+}  // namespace
+
+void RingBufferRecordActivity(TracingActivity& activity) {
+  static thread_local ThreadRing ring;
+  TraceRecord record;
+  record.start_ns = ToNanos(activity.start_time);
+  record.end_ns =
+      activity.end_time.hasValue() ? ToNanos(activity.end_time.getValue()) : 0;
+  record.name_id = InternName(activity.title);
+  ring.Push(record);
+}
+
+void WriteChromeTrace(raw_ostream& os) {
+  NameTable& names = NameTable::Get();
+  os << "[";
+  bool first = true;
+  for (const auto& ring : RingRegistry::Get().Snapshot()) {
+    for (const TraceRecord& record : ring.second) {
+      if (!first) os << ",";
+      first = false;
+      // Chrome trace-event timestamps and durations are in microseconds;
+      // emit fractional values to keep nanosecond resolution.
+      os << "\n{\"name\":\"";
+      WriteJsonEscaped(os, names.Name(record.name_id));
+      os << "\",\"pid\":1,\"tid\":" << ring.first;
+      if (record.end_ns != 0) {
+        const uint64_t duration_ns = record.end_ns - record.start_ns;
+        os << ",\"ph\":\"X\",\"ts\":" << MicrosWithNanos(record.start_ns)
+           << ",\"dur\":" << MicrosWithNanos(duration_ns);
+      } else {
+        os << ",\"ph\":\"i\",\"s\":\"t\",\"ts\":"
+           << MicrosWithNanos(record.start_ns);
+      }
+      os << "}";
+    }
+  }
+  os << "\n]\n";
+}
+
+}  // namespace tracing
+}  // namespace internal
+}  // namespace tfrt
+
+#endif  // NO_TFRT_TRACING
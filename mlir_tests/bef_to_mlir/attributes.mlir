@@ -93,6 +93,17 @@ func @aggregate.constant() -> i32 {
   hex.return %x : i32
 }
 
+// Homogeneous aggregates use the flattened encoding in BEF.
+// CHECK-LABEL: func @flat_aggregate.constant() -> i32
+func @flat_aggregate.constant() -> i32 {
+  // CHECK-NEXT: [[REG:%.*]] = "simple.op"()
+  // CHECK-SAME: {value = {{\[\[}}1 : i32, 2 : i32], [3 : i32, 4 : i32]]} : () -> i32
+  // CHECK-NEXT: hex.return [[REG]] : i32
+
+  %x = "simple.op"() {value = [[1: i32, 2: i32], [3: i32, 4: i32]]} : () -> i32
+  hex.return %x : i32
+}
+
 // CHECK-LABEL: func @type.attribute() -> (i32, i32, i32)
 func @type.attribute() -> (i32, i32, i32) {
   // CHECK-NEXT: [[REG0:%.*]] = "get_width"() {value = i32} : () -> i32
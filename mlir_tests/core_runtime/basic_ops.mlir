@@ -356,3 +356,38 @@ func @test_error_propagation() -> !hex.chain {
   hex.return %ch4 : !hex.chain
 }
 
+
+// CHECK-LABEL: --- Running 'broadcast_binary_ops'
+func @broadcast_binary_ops() -> !hex.chain {
+  %ch0 = hex.new.chain
+  %cpu = corert.get_device "cpu"
+
+  %a_handle = corert.executeop(%cpu)
+    "tfrt_test.create_dense_tensor"() { shape = [2, 3], values = [1 : i32, 2 : i32, 3 : i32, 4 : i32, 5 : i32, 6 : i32] } : 1
+
+  // Per-channel broadcast: [2, 3] + [3].
+  %bias_handle = corert.executeop(%cpu)
+    "tfrt_test.create_dense_tensor"() { shape = [3], values = [10 : i32, 20 : i32, 30 : i32] } : 1
+  %result1 = corert.executeop(%cpu) "tfrt_test.add"(%a_handle, %bias_handle) : 1
+
+  // CHECK: shape = [2, 3], values = [11, 22, 33, 14, 25, 36]
+  %ch1 = "corert.print_tensorhandle"(%result1, %ch0) : (!corert.tensorhandle, !hex.chain) -> !hex.chain
+
+  // Per-row broadcast: [2, 3] * [2, 1].
+  %scale_handle = corert.executeop(%cpu)
+    "tfrt_test.create_dense_tensor"() { shape = [2, 1], values = [2 : i32, 10 : i32] } : 1
+  %result2 = corert.executeop(%cpu) "tfrt_test.multiply"(%a_handle, %scale_handle) : 1
+
+  // CHECK: shape = [2, 3], values = [2, 4, 6, 40, 50, 60]
+  %ch2 = "corert.print_tensorhandle"(%result2, %ch0) : (!corert.tensorhandle, !hex.chain) -> !hex.chain
+
+  // Scalar broadcast: [1] + [2, 3], with the broadcast on the left.
+  %one_handle = corert.executeop(%cpu)
+    "tfrt_test.create_dense_tensor"() { shape = [1], values = [100 : i32] } : 1
+  %result3 = corert.executeop(%cpu) "tfrt_test.add"(%one_handle, %a_handle) : 1
+
+  // CHECK: shape = [2, 3], values = [101, 102, 103, 104, 105, 106]
+  %ch3 = "corert.print_tensorhandle"(%result3, %ch0) : (!corert.tensorhandle, !hex.chain) -> !hex.chain
+
+  hex.return %ch3 : !hex.chain
+}
@@ -0,0 +1,80 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RUN: tfrt_translate -mlir-to-bef %s | bef_executor | FileCheck %s --dump-input=fail
+// RUN: tfrt_opt %s | tfrt_opt
+
+// CHECK-LABEL: --- Running 'allreduce'
+func @allreduce() {
+  %c0 = hex.new.chain
+
+  %a = dht.create_uninitialized_tensor.i32.1 [4 : i64]
+  %c1 = dht.fill_tensor_with_constant.i32 %a, %c0 1 : i32
+  %b = dht.create_uninitialized_tensor.i32.1 [4 : i64]
+  %c2 = dht.fill_tensor_with_constant.i32 %b, %c1 2 : i32
+  %c = dht.create_uninitialized_tensor.i32.1 [4 : i64]
+  %c3 = dht.fill_tensor_with_constant.i32 %c, %c2 3 : i32
+
+  %c4 = dht.allreduce.i32 %c3, %a, %b, %c
+
+  // Every shard holds the sum.
+  // CHECK: shape = [4], values = [6, 6, 6, 6]
+  %c5 = dht.print_tensor %a, %c4
+  // CHECK: shape = [4], values = [6, 6, 6, 6]
+  %c6 = dht.print_tensor %b, %c5
+  // CHECK: shape = [4], values = [6, 6, 6, 6]
+  %c7 = dht.print_tensor %c, %c6
+
+  hex.return
+}
+
+// CHECK-LABEL: --- Running 'broadcast'
+func @broadcast() {
+  %c0 = hex.new.chain
+
+  %a = dht.create_uninitialized_tensor.f32.1 [2 : i64]
+  %c1 = dht.fill_tensor_with_constant.f32 %a, %c0 5.0 : f32
+  %b = dht.create_uninitialized_tensor.f32.1 [2 : i64]
+  %c2 = dht.fill_tensor_with_constant.f32 %b, %c1 0.0 : f32
+
+  %c3 = dht.broadcast.f32 %c2, %a, %b
+
+  // CHECK: shape = [2], values = [5.000000e+00, 5.000000e+00]
+  %c4 = dht.print_tensor %b, %c3
+
+  hex.return
+}
+
+// CHECK-LABEL: --- Running 'allgather'
+func @allgather() {
+  %c0 = hex.new.chain
+
+  %a = dht.create_uninitialized_tensor.i32.1 [2 : i64]
+  %c1 = dht.fill_tensor_with_constant.i32 %a, %c0 1 : i32
+  %b = dht.create_uninitialized_tensor.i32.1 [2 : i64]
+  %c2 = dht.fill_tensor_with_constant.i32 %b, %c1 2 : i32
+
+  %out0 = dht.create_uninitialized_tensor.i32.1 [4 : i64]
+  %out1 = dht.create_uninitialized_tensor.i32.1 [4 : i64]
+
+  %c3 = dht.allgather.i32 %c2, %a, %b, %out0, %out1
+
+  // Each participant receives the concatenation of all shards.
+  // CHECK: shape = [4], values = [1, 1, 2, 2]
+  %c4 = dht.print_tensor %out0, %c3
+  // CHECK: shape = [4], values = [1, 1, 2, 2]
+  %c5 = dht.print_tensor %out1, %c4
+
+  hex.return
+}
@@ -0,0 +1,63 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// RUN: tfrt_translate -mlir-to-bef %s | bef_executor | FileCheck %s --dump-input=fail
+// RUN: tfrt_opt %s | tfrt_opt
+
+// CHECK-LABEL: --- Running 'basic_csr'
+func @basic_csr() {
+  %c0 = hex.new.chain
+
+  %a = dht.create_uninitialized_tensor.i32.2 [2 : i64, 3 : i64]
+  %c1 = dht.set_tensor_with_constant_values.i32 %a, %c0
+    [0 : i32, 5 : i32, 0 : i32, 7 : i32, 0 : i32, 8 : i32]
+  %coo, %c2 = coo.convert_dht_to_coo.i32.2 %a, %c1
+  %csr, %c3 = csr.convert_coo_to_csr.i32.2 %coo, %c2
+
+  // CHECK: CsrHostTensor dtype = I32, shape = [2, 3], row_offsets = [0, 1, 3], col_indices = [1, 0, 2], values = [5, 7, 8]
+  %c4 = dht.print_tensor %csr, %c3
+
+  %d, %c5 = csr.convert_csr_to_dht.i32.2 %csr, %c4
+  %cmp, %c6 = dht.tensor_equal.i32 %a, %d, %c5
+
+  // CHECK: int1 = 1
+  hex.print.i1 %cmp, %c6
+
+  hex.return
+}
+
+// CHECK-LABEL: --- Running 'tensor_roundtrip'
+func @tensor_roundtrip() {
+  %c1 = hex.new.chain
+
+  // Keep tensor uninitialized. This means we'll be getting random values in
+  // there.
+  %a = dht.create_uninitialized_tensor.i32.2 [10 : i64, 10 : i64]
+  %coo, %c2 = coo.convert_dht_to_coo.i32.2 %a, %c1
+  %s, %c3 = csr.convert_coo_to_csr.i32.2 %coo, %c2
+  %d, %c4 = csr.convert_csr_to_dht.i32.2 %s, %c3
+  %coo2, %c5 = coo.convert_dht_to_coo.i32.2 %d, %c4
+  %f, %c6 = csr.convert_coo_to_csr.i32.2 %coo2, %c5
+
+  %cmp, %c7 = dht.tensor_equal.i32 %a, %d, %c4
+  %cmp2, %c8 = csr.tensor_equal.i32.2 %s, %f, %c6
+
+  // CHECK: int1 = 1
+  "hex.print.i1"(%cmp, %c7) : (i1, !hex.chain) -> (!hex.chain)
+
+  // CHECK: int1 = 1
+  "hex.print.i1"(%cmp2, %c8) : (i1, !hex.chain) -> (!hex.chain)
+
+  hex.return
+}
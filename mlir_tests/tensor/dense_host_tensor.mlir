@@ -156,3 +156,76 @@ func @dense_attr() {
 
   hex.return
 }
+
+// CHECK-LABEL: --- Running 'const_tensor'
+func @const_tensor() {
+  %c0 = hex.new.chain
+
+  // The result aliases the attribute payload in the BEF file; no copy is
+  // made.
+  %a = "dht.const_tensor"() {value = dense<[[1.0, 2.0], [3.0, 4.0]]> : tensor<2x2xf32>} : () -> !t.tensor
+
+  // CHECK: shape = [2, 2], values = [1.000000e+00, 2.000000e+00, 3.000000e+00, 4.000000e+00]
+  %c1 = dht.print_tensor %a, %c0
+
+  hex.return
+}
+
+// CHECK-LABEL: --- Running 'tensor_views'
+func @tensor_views() {
+  %c0 = hex.new.chain
+
+  %a = dht.create_uninitialized_tensor.i32.2 [3 : i64, 4 : i64]
+  %c1 = dht.set_tensor_with_constant_values.i32 %a, %c0
+    [0 : i32, 1 : i32, 2 : i32, 3 : i32, 4 : i32, 5 : i32,
+     6 : i32, 7 : i32, 8 : i32, 9 : i32, 10 : i32, 11 : i32]
+
+  // A slice of the outermost dimension is contiguous and aliases the input's
+  // buffer.
+  %rows, %c2 = dht.slice_view.i32.2 %a, %c1 [1 : i64, 0 : i64],
+    [2 : i64, 4 : i64]
+
+  // CHECK: shape = [2, 4], values = [4, 5, 6, 7, 8, 9, 10, 11]
+  %c3 = dht.print_tensor %rows, %c2
+
+  // An interior slice is strided, so it is materialized.
+  %mid, %c4 = dht.slice_view.i32.2 %a, %c3 [0 : i64, 1 : i64],
+    [3 : i64, 2 : i64]
+
+  // CHECK: shape = [3, 2], values = [1, 2, 5, 6, 9, 10]
+  %c5 = dht.print_tensor %mid, %c4
+
+  %t, %c6 = dht.transpose_view.i32.2 %a, %c5 [1 : i64, 0 : i64]
+
+  // CHECK: shape = [4, 3], values = [0, 4, 8, 1, 5, 9, 2, 6, 10, 3, 7, 11]
+  %c7 = dht.print_tensor %t, %c6
+
+  // A reshape always aliases.
+  %r, %c8 = dht.reshape_view %a, %c7 [2 : i64, 6 : i64]
+
+  // CHECK: shape = [2, 6], values = [0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11]
+  %c9 = dht.print_tensor %r, %c8
+
+  hex.return
+}
+
+// CHECK-LABEL: --- Running 'tensor_split_view'
+func @tensor_split_view() {
+  %c0 = hex.new.chain
+
+  %a = dht.create_uninitialized_tensor.i32.2 [4 : i64, 2 : i64]
+  %c1 = dht.set_tensor_with_constant_values.i32 %a, %c0
+    [0 : i32, 1 : i32, 2 : i32, 3 : i32, 4 : i32, 5 : i32, 6 : i32, 7 : i32]
+
+  // Each piece aliases its row range of the input.
+  %c2, %s0, %s1 = "dht.split_view"(%a, %c1)
+    : (!t.tensor, !hex.chain) -> (!hex.chain, !t.tensor, !t.tensor)
+
+  // CHECK: shape = [2, 2], values = [0, 1, 2, 3]
+  %c3 = dht.print_tensor %s0, %c2
+
+  // CHECK: shape = [2, 2], values = [4, 5, 6, 7]
+  %c4 = dht.print_tensor %s1, %c3
+
+  hex.return
+}
@@ -0,0 +1,128 @@
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+//===- event_count_test.cc --------------------------------------*- C++ -*-===//
+//
+// Unit tests for EventCount park/unpark and the prewait/commit protocol.
+//
+//===----------------------------------------------------------------------===//
+
+#include "event_count.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace tfrt {
+namespace {
+
+using EventCount = ::tfrt::internal::EventCount;
+
+TEST(EventCountTest, PredicateBeforeCommitCancelsWait) {
+  EventCount ec(1);
+
+  std::atomic<bool> predicate(false);
+  predicate = true;
+
+  ec.Prewait();
+  if (predicate.load()) {
+    ec.CancelWait();
+  } else {
+    ec.CommitWait(ec.waiter(0));
+  }
+}
+
+TEST(EventCountTest, NotifyWakesCommittedWaiter) {
+  EventCount ec(1);
+
+  std::atomic<bool> predicate(false);
+  std::atomic<bool> woke_up(false);
+
+  std::thread waiter([&]() {
+    for (;;) {
+      if (predicate.load()) break;
+      ec.Prewait();
+      if (predicate.load()) {
+        ec.CancelWait();
+        break;
+      }
+      ec.CommitWait(ec.waiter(0));
+    }
+    woke_up = true;
+  });
+
+  predicate = true;
+  while (!woke_up.load()) ec.Notify(false);
+
+  waiter.join();
+}
+
+TEST(EventCountTest, NotifyAllWakesAllWaiters) {
+  constexpr int kNumWaiters = 8;
+  constexpr int kNumRounds = 100;
+
+  EventCount ec(kNumWaiters);
+
+  for (int round = 0; round < kNumRounds; ++round) {
+    std::atomic<bool> predicate(false);
+    std::atomic<int> num_woken(0);
+
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < kNumWaiters; ++i) {
+      waiters.emplace_back([&, i]() {
+        for (;;) {
+          if (predicate.load()) break;
+          ec.Prewait();
+          if (predicate.load()) {
+            ec.CancelWait();
+            break;
+          }
+          ec.CommitWait(ec.waiter(i));
+        }
+        num_woken.fetch_add(1);
+      });
+    }
+
+    predicate = true;
+    while (num_woken.load() != kNumWaiters) ec.Notify(true);
+
+    for (auto& thread : waiters) thread.join();
+  }
+}
+
+TEST(EventCountTest, RepeatedProducerConsumerHandoff) {
+  constexpr int kNumItems = 10000;
+
+  EventCount ec(1);
+  std::atomic<int> available(0);
+  std::atomic<int> consumed(0);
+
+  std::thread consumer([&]() {
+    while (consumed.load() < kNumItems) {
+      if (available.load() > consumed.load()) {
+        consumed.fetch_add(1);
+        continue;
+      }
+      ec.Prewait();
+      if (available.load() > consumed.load()) {
+        ec.CancelWait();
+        continue;
+      }
+      ec.CommitWait(ec.waiter(0));
+    }
+  });
+
+  for (int i = 0; i < kNumItems; ++i) {
+    available.fetch_add(1);
+    ec.Notify(false);
+  }
+
+  consumer.join();
+  ASSERT_EQ(consumed.load(), kNumItems);
+}
+
+}  // namespace
+}  // namespace tfrt
@@ -15,6 +15,7 @@
 #include "tfrt/host_context/diagnostic.h"
 #include "tfrt/host_context/host_allocator.h"
 #include "tfrt/host_context/host_context.h"
+#include "tfrt/metrics/metrics_api.h"
 
 namespace tfrt {
 namespace {
@@ -52,5 +53,70 @@ TEST(MultiThreadedWorkQueueTest, PingPong) {
   ASSERT_EQ(last_executed_task, num_tasks - 1);
 }
 
+TEST(MultiThreadedWorkQueueTest, AddTasksBatch) {
+  auto host = CreateTestHostContext(4);
+
+  std::atomic<int64_t> num_executed_tasks = 0;
+  const int64_t num_tasks = 1000;
+
+  llvm::SmallVector<TaskFunction, 8> tasks;
+  for (int64_t i = 0; i < num_tasks; ++i) {
+    tasks.push_back(TaskFunction([&]() { num_executed_tasks++; }));
+  }
+  host->EnqueueWork(tasks);
+
+  host->Quiesce();
+  ASSERT_EQ(num_executed_tasks, num_tasks);
+}
+
+TEST(MultiThreadedWorkQueueTest, PriorityLanes) {
+  auto host = CreateTestHostContext(4);
+
+  std::atomic<int64_t> num_executed_tasks = 0;
+  const int64_t num_tasks = 1000;
+
+  // Mix both lanes; all tasks must run regardless of priority.
+  for (int64_t i = 0; i < num_tasks; ++i) {
+    host->EnqueueWork([&]() { num_executed_tasks++; },
+                      i % 2 == 0 ? TaskPriority::kHigh
+                                 : TaskPriority::kDefault);
+  }
+
+  host->Quiesce();
+  ASSERT_EQ(num_executed_tasks, num_tasks);
+}
+
+// Returns the snapshotted int value of the named metric, or -1 if the metric
+// does not exist.
+int64_t MetricValue(const char* name) {
+  for (const metrics::MetricSnapshot& snapshot : metrics::SnapshotMetrics()) {
+    if (snapshot.name == name) return snapshot.int_value;
+  }
+  return -1;
+}
+
+TEST(MultiThreadedWorkQueueTest, ExportsTelemetry) {
+  const int64_t tasks_before = MetricValue("work_queue.tasks_executed");
+
+  auto host = CreateTestHostContext(4);
+
+  std::atomic<int64_t> num_executed_tasks = 0;
+  const int64_t num_tasks = 1000;
+
+  for (int64_t i = 0; i < num_tasks; ++i) {
+    host->EnqueueWork([&]() { num_executed_tasks++; });
+  }
+
+  host->Quiesce();
+  ASSERT_EQ(num_executed_tasks, num_tasks);
+
+  // Quiesce may run some tasks in the caller thread, so the worker-side
+  // counter can lag the total, but it must have moved.
+  ASSERT_GT(MetricValue("work_queue.tasks_executed"), tasks_before);
+  ASSERT_GE(MetricValue("work_queue.steal_attempts"),
+            MetricValue("work_queue.steal_successes"));
+  ASSERT_GE(MetricValue("work_queue.max_queue_depth"), 0);
+}
+
 }  // namespace
 }  // namespace tfrt
@@ -91,13 +91,19 @@ TEST(TaskDequeTest, PushFrontToOverflow) {
     ASSERT_EQ(queue.PushFront(fn.Next(i)), llvm::None);
   }
 
-  auto overflow = queue.PushFront(fn.Next(12345));
-  ASSERT_TRUE(overflow.hasValue());
-  ASSERT_EQ(fn.Run(std::move(overflow)), 12345);
+  // Tasks beyond the ring buffer capacity are absorbed by the overflow FIFO
+  // instead of being handed back to the caller.
+  const int num_overflow = 100;
+  for (int i = 0; i < num_overflow; ++i) {
+    ASSERT_EQ(queue.PushFront(fn.Next(TaskDeque::kCapacity + i)), llvm::None);
+  }
+  ASSERT_EQ(queue.Size(), TaskDeque::kCapacity + num_overflow);
 
-  for (int i = 0; i < TaskDeque::kCapacity; ++i) {
+  // The ring buffer drains first, then the overflowed tasks in FIFO order.
+  for (int i = 0; i < TaskDeque::kCapacity + num_overflow; ++i) {
     ASSERT_EQ(fn.Run(queue.PopBack()), i);
   }
+  ASSERT_TRUE(queue.Empty());
 }
 
 TEST(TaskDequeTest, PushBackToOverflow) {
@@ -108,13 +114,16 @@ TEST(TaskDequeTest, PushBackToOverflow) {
     ASSERT_EQ(queue.PushBack(fn.Next(i)), llvm::None);
   }
 
-  auto overflow = queue.PushFront(fn.Next(12345));
-  ASSERT_TRUE(overflow.hasValue());
-  ASSERT_EQ(fn.Run(std::move(overflow)), 12345);
+  const int num_overflow = 100;
+  for (int i = 0; i < num_overflow; ++i) {
+    ASSERT_EQ(queue.PushBack(fn.Next(TaskDeque::kCapacity + i)), llvm::None);
+  }
+  ASSERT_EQ(queue.Size(), TaskDeque::kCapacity + num_overflow);
 
-  for (int i = 0; i < TaskDeque::kCapacity; ++i) {
+  for (int i = 0; i < TaskDeque::kCapacity + num_overflow; ++i) {
     ASSERT_EQ(fn.Run(queue.PopFront()), i);
   }
+  ASSERT_TRUE(queue.Empty());
 }
 
 TEST(TaskDequeTest, PopBackHalf) {
@@ -147,6 +156,43 @@ TEST(TaskDequeTest, PopBackHalf) {
   }
 }
 
+TEST(TaskDequeTest, PopBackHalfWithOverflow) {
+  TaskFunctions fn;
+  TaskDeque queue;
+
+  for (int i = 0; i < TaskDeque::kCapacity; ++i) {
+    ASSERT_EQ(queue.PushBack(fn.Next(i)), llvm::None);
+  }
+
+  // Push enough extra tasks that the total size exceeds twice the ring
+  // buffer capacity: a steal midpoint computed from the total size would
+  // wrap past the front of the ring and alias back into occupied slots.
+  const int num_overflow = 2 * TaskDeque::kCapacity;
+  for (int i = 0; i < num_overflow; ++i) {
+    ASSERT_EQ(queue.PushBack(fn.Next(TaskDeque::kCapacity + i)), llvm::None);
+  }
+  ASSERT_EQ(queue.Size(), TaskDeque::kCapacity + num_overflow);
+
+  // Steals half of the ring buffer, not half of the total size: overflowed
+  // tasks occupy no ring slots.
+  std::vector<TaskFunction> half;
+  ASSERT_EQ(queue.PopBackHalf(&half), TaskDeque::kCapacity / 2);
+  for (int i = 0; i < half.size(); ++i) {
+    ASSERT_EQ(fn.Run({std::move(half[i])}), TaskDeque::kCapacity / 2 + i);
+  }
+
+  // The untouched half of the ring buffer drains first, then the overflow
+  // FIFO in insertion order.
+  ASSERT_EQ(queue.Size(), TaskDeque::kCapacity / 2 + num_overflow);
+  for (int i = 0; i < TaskDeque::kCapacity / 2; ++i) {
+    ASSERT_EQ(fn.Run(queue.PopFront()), i);
+  }
+  for (int i = 0; i < num_overflow; ++i) {
+    ASSERT_EQ(fn.Run(queue.PopFront()), TaskDeque::kCapacity + i);
+  }
+  ASSERT_TRUE(queue.Empty());
+}
+
 // Check that queue correctly reports its emptyness status under contention.
 // Worker thread constantly push and pop one task to/from the queue, that
 // initially was added a single task.
@@ -93,6 +93,16 @@ class BlockingWorkQueue
   // not found.
   Optional<TaskFunction> WaitNextTask(mutex_lock* lock) TFRT_REQUIRES(mutex_);
 
+  // Hands `task` to an idle dynamic thread, or starts a new dynamic thread
+  // for it if we are below the thread limit. Returns the task back to the
+  // caller if there are no idle threads and the limit is reached. If
+  // `attach_pending_task_counter` is true and quiescing mode is on, the task
+  // is wrapped in a pending task counter before it is handed over (accepted
+  // tasks only: it is unsafe to return a counted task to the caller).
+  Optional<TaskFunction> ScheduleDynamicTask(TaskFunction task,
+                                             bool attach_pending_task_counter)
+      TFRT_REQUIRES(mutex_);
+
   // Maximum number of dynamically started threads.
   const int max_num_dynamic_threads_;
 
@@ -159,6 +169,18 @@ BlockingWorkQueue<ThreadingEnvironment>::EnqueueBlockingTask(
 
   // Failed to push task into one of the worker threads queues.
   if (inline_task.hasValue()) {
+    // Queue pressure: all statically allocated worker queues are full. Spill
+    // the task to the dynamically sized part of the pool, which starts new
+    // threads up to the configured limit and reaps them again after
+    // `idle_wait_time_` of inactivity, so IO spikes (e.g. checkpoints) get
+    // temporary capacity without permanently provisioning peak thread counts.
+    {
+      mutex_lock lock(mutex_);
+      inline_task = ScheduleDynamicTask(std::move(*inline_task),
+                                        /*attach_pending_task_counter=*/false);
+    }
+    if (!inline_task.hasValue()) return llvm::None;
+
     // If we are in quiescing mode, we can always execute the submitted task in
     // the caller thread, because the system is anyway going to shutdown soon,
     // and even if we are running inside a non-blocking work queue, a single
@@ -188,14 +210,23 @@ template <typename ThreadingEnvironment>
 Optional<TaskFunction> BlockingWorkQueue<ThreadingEnvironment>::RunBlockingTask(
     TaskFunction task) {
   mutex_lock lock(mutex_);
+  return ScheduleDynamicTask(std::move(task),
+                             /*attach_pending_task_counter=*/true);
+}
 
+template <typename ThreadingEnvironment>
+Optional<TaskFunction>
+BlockingWorkQueue<ThreadingEnvironment>::ScheduleDynamicTask(
+    TaskFunction task, bool attach_pending_task_counter) {
   // Attach a PendingTask counter only if we were able to submit the task
   // to one of the worker threads. It's unsafe to return the task with
   // a counter to the caller, because we don't know when/if it will be
-  // destructed and the counter decremented.
+  // destructed and the counter decremented. Tasks spilled from the static
+  // part of the pool already carry their counter.
   auto wrap = [&](TaskFunction task) -> TaskFunction {
-    return IsQuiescing() ? WithPendingTaskCounter(std::move(task))
-                         : std::move(task);
+    return attach_pending_task_counter && IsQuiescing()
+               ? WithPendingTaskCounter(std::move(task))
+               : std::move(task);
   };
 
   // There are idle threads. We enqueue the task to the queue and then notify
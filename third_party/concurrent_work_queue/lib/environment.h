@@ -14,6 +14,14 @@
 
 #include <thread>
 
+#if defined(__linux__)
+#include <sched.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#endif
+
 namespace tfrt {
 namespace internal {
 
@@ -33,6 +41,62 @@ struct StdThreadingEnvironment {
   static uint64_t ThisThreadIdHash() {
     return std::hash<std::thread::id>()(std::this_thread::get_id());
   }
+
+  // Returns the number of NUMA nodes on this machine, or 1 if the topology
+  // cannot be determined. Work queues use this to partition worker threads
+  // into node-local steal domains.
+  static int NumNumaNodes() {
+#if defined(__linux__)
+    // Nodes are numbered contiguously from zero in the Linux sysfs topology.
+    int num_nodes = 0;
+    while (std::ifstream(NumaNodeCpuListPath(num_nodes)).good()) ++num_nodes;
+    return num_nodes > 0 ? num_nodes : 1;
+#else
+    return 1;
+#endif
+  }
+
+  // Pins the calling thread to the CPUs of NUMA node `node`. No-op on
+  // platforms without affinity support or if the topology cannot be read.
+  static void PinCurrentThreadToNumaNode(int node) {
+#if defined(__linux__)
+    std::ifstream cpu_list(NumaNodeCpuListPath(node));
+    if (!cpu_list.good()) return;
+
+    // The cpulist file is a comma separated list of CPU ranges, e.g.
+    // "0-15,32-47" for the first node of a dual-socket machine with SMT.
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    int num_cpus = 0;
+    std::string range;
+    while (std::getline(cpu_list, range, ',')) {
+      int lo, hi;
+      switch (std::sscanf(range.c_str(), "%d-%d", &lo, &hi)) {
+        case 1:
+          hi = lo;
+          break;
+        case 2:
+          break;
+        default:
+          return;
+      }
+      for (int cpu = lo; cpu <= hi && cpu < CPU_SETSIZE; ++cpu) {
+        CPU_SET(cpu, &cpus);
+        ++num_cpus;
+      }
+    }
+    if (num_cpus > 0) sched_setaffinity(/*pid=*/0, sizeof(cpus), &cpus);
+#else
+    (void)node;
+#endif
+  }
+
+#if defined(__linux__)
+ private:
+  static std::string NumaNodeCpuListPath(int node) {
+    return "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+  }
+#endif
 };
 
 }  // namespace internal
@@ -59,6 +59,7 @@
 #include <vector>
 
 #include "tfrt/support/mutex.h"
+#include "tfrt/support/sync_primitives.h"
 
 namespace tfrt {
 namespace internal {
@@ -191,18 +192,24 @@ class EventCount {
 
   struct Waiter {
     friend class EventCount;
+    enum : uint32_t {
+      kNotSignaled,
+      kWaiting,
+      kSignaled,
+    };
     // Align to 128 byte boundary to prevent false sharing with other Waiter
     // objects in the same vector.
     alignas(128) std::atomic<uint64_t> next;
+#if defined(TFRT_HAS_FUTEX)
+    // Park/Unpark run the whole protocol on this single word with a futex,
+    // avoiding the mutex+condition variable round trip of the portable path.
+    std::atomic<uint32_t> state{kNotSignaled};
+#else
     mutex mu;
     condition_variable cv;
-    uint64_t epoch = 0;
     unsigned state = kNotSignaled;
-    enum {
-      kNotSignaled,
-      kWaiting,
-      kSignaled,
-    };
+#endif
+    uint64_t epoch = 0;
   };
 
  private:
@@ -237,6 +244,33 @@ class EventCount {
   std::atomic<uint64_t> state_;
   std::vector<Waiter> waiters_;
 
+#if defined(TFRT_HAS_FUTEX)
+  void Park(Waiter* w) {
+    uint32_t state = w->state.load(std::memory_order_acquire);
+    for (;;) {
+      if (state == Waiter::kSignaled) return;
+      // Publish that we are about to block; the kernel re-checks the word
+      // under its internal lock, so a concurrent Unpark can't be lost.
+      if (state == Waiter::kNotSignaled &&
+          !w->state.compare_exchange_weak(state, Waiter::kWaiting,
+                                          std::memory_order_acq_rel))
+        continue;
+      FutexWait(&w->state, Waiter::kWaiting);
+      state = w->state.load(std::memory_order_acquire);
+    }
+  }
+
+  void Unpark(Waiter* w) {
+    for (Waiter* next; w; w = next) {
+      uint64_t wnext = w->next.load(std::memory_order_relaxed) & kStackMask;
+      next = wnext == kStackMask ? nullptr : &waiters_[wnext];
+      uint32_t state =
+          w->state.exchange(Waiter::kSignaled, std::memory_order_acq_rel);
+      // Pay for the wake syscall only if the waiter actually parked.
+      if (state == Waiter::kWaiting) FutexWake(&w->state, 1);
+    }
+  }
+#else
   void Park(Waiter* w) {
     mutex_lock lock(w->mu);
     while (w->state != Waiter::kSignaled) {
@@ -259,6 +293,7 @@ class EventCount {
       if (state == Waiter::kWaiting) w->cv.notify_one();
     }
   }
+#endif  // defined(TFRT_HAS_FUTEX)
 
   static void CheckState(uint64_t state, bool waiter = false) {
     static_assert(kEpochBits >= 20, "not enough bits to prevent ABA problem");
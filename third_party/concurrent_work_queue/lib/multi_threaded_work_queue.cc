@@ -29,7 +29,8 @@ class MultiThreadedWorkQueue : public ConcurrentWorkQueue {
   using ThreadingEnvironment = ::tfrt::internal::StdThreadingEnvironment;
 
  public:
-  MultiThreadedWorkQueue(int num_threads, int max_blocking_work_queue_threads);
+  MultiThreadedWorkQueue(int num_threads, int max_blocking_work_queue_threads,
+                         int max_spin_count, int numa_node = -1);
   ~MultiThreadedWorkQueue() override;
 
   std::string name() const override {
@@ -39,6 +40,8 @@ class MultiThreadedWorkQueue : public ConcurrentWorkQueue {
   int GetParallelismLevel() const final { return num_threads_; }
 
   void AddTask(TaskFunction task) final;
+  void AddTask(TaskFunction task, TaskPriority priority) final;
+  void AddTasks(MutableArrayRef<TaskFunction> tasks) final;
   Optional<TaskFunction> AddBlockingTask(TaskFunction task,
                                          bool allow_queuing) final;
   void Quiesce() final;
@@ -53,10 +56,12 @@ class MultiThreadedWorkQueue : public ConcurrentWorkQueue {
 };
 
 MultiThreadedWorkQueue::MultiThreadedWorkQueue(
-    int num_threads, int max_blocking_work_queue_threads)
+    int num_threads, int max_blocking_work_queue_threads, int max_spin_count,
+    int numa_node)
     : num_threads_(num_threads),
       quiescing_state_(std::make_unique<internal::QuiescingState>()),
-      non_blocking_work_queue_(quiescing_state_.get(), num_threads),
+      non_blocking_work_queue_(quiescing_state_.get(), num_threads,
+                               max_spin_count, numa_node),
       blocking_work_queue_(quiescing_state_.get(),
                            max_blocking_work_queue_threads) {}
 
@@ -70,6 +75,14 @@ void MultiThreadedWorkQueue::AddTask(TaskFunction task) {
   non_blocking_work_queue_.AddTask(std::move(task));
 }
 
+void MultiThreadedWorkQueue::AddTask(TaskFunction task, TaskPriority priority) {
+  non_blocking_work_queue_.AddTask(std::move(task), priority);
+}
+
+void MultiThreadedWorkQueue::AddTasks(MutableArrayRef<TaskFunction> tasks) {
+  non_blocking_work_queue_.AddTasks(tasks);
+}
+
 Optional<TaskFunction> MultiThreadedWorkQueue::AddBlockingTask(
     TaskFunction task, bool allow_queuing) {
   if (allow_queuing) {
@@ -90,13 +103,12 @@ void MultiThreadedWorkQueue::Quiesce() {
   // Wait for completion of all blocking tasks.
   blocking_work_queue_.Quiesce();
 
-  // At this point we might still have tasks in the work queues, but because we
-  // enabled quiescing mode earlier, we can rely on empty check as a loop
-  // condition.
-  while (quiescing.HasPendingTasks()) {
-    non_blocking_work_queue_.Quiesce();
-    blocking_work_queue_.Quiesce();
-  }
+  // At this point we might still have tasks in the work queues (e.g. tasks
+  // submitted by other tasks while we were draining the queues above). Worker
+  // threads were notified when those tasks were added, so instead of polling
+  // the queues for emptiness we block until the last pending task retires and
+  // wakes us.
+  quiescing.WaitForPendingTasks();
 }
 
 void MultiThreadedWorkQueue::Await(ArrayRef<RCReference<AsyncValue>> values) {
@@ -130,9 +142,23 @@ void MultiThreadedWorkQueue::Await(ArrayRef<RCReference<AsyncValue>> values) {
 
 std::unique_ptr<ConcurrentWorkQueue> CreateMultiThreadedWorkQueue(
     int num_threads, int num_blocking_threads) {
+  return CreateMultiThreadedWorkQueue(num_threads, num_blocking_threads,
+                                      /*max_spin_count=*/0);
+}
+
+std::unique_ptr<ConcurrentWorkQueue> CreateMultiThreadedWorkQueue(
+    int num_threads, int num_blocking_threads, int max_spin_count) {
   assert(num_threads > 0 && num_blocking_threads > 0);
-  return std::make_unique<MultiThreadedWorkQueue>(num_threads,
-                                                  num_blocking_threads);
+  return std::make_unique<MultiThreadedWorkQueue>(
+      num_threads, num_blocking_threads, max_spin_count);
+}
+
+std::unique_ptr<ConcurrentWorkQueue> CreateNumaPinnedWorkQueue(
+    int num_threads, int num_blocking_threads, int max_spin_count,
+    int numa_node) {
+  assert(num_threads > 0 && num_blocking_threads > 0 && numa_node >= 0);
+  return std::make_unique<MultiThreadedWorkQueue>(
+      num_threads, num_blocking_threads, max_spin_count, numa_node);
 }
 
 }  // namespace tfrt
@@ -28,8 +28,12 @@
 #ifndef TFRT_THIRD_PARTY_CONCURRENT_WORK_QUEUE_NON_BLOCKING_WORK_QUEUE_H_
 #define TFRT_THIRD_PARTY_CONCURRENT_WORK_QUEUE_NON_BLOCKING_WORK_QUEUE_H_
 
+#include <vector>
+
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Compiler.h"
 #include "task_deque.h"
+#include "tfrt/host_context/concurrent_work_queue.h"
 #include "tfrt/host_context/task_function.h"
 #include "work_queue_base.h"
 
@@ -39,11 +43,31 @@ namespace internal {
 template <typename ThreadingEnvironment>
 class NonBlockingWorkQueue;
 
+// Pending tasks of a single worker thread, split into a high and a default
+// priority lane. Both the owning thread and stealers drain the high lane
+// first, so latency-critical tasks are never stuck behind bulk background
+// work sharing the same pool.
+struct PriorityTaskDeque {
+  TaskDeque& lane(TaskPriority priority) {
+    return priority == TaskPriority::kHigh ? high_lane : default_lane;
+  }
+
+  bool Empty() const { return high_lane.Empty() && default_lane.Empty(); }
+
+  void Flush() {
+    high_lane.Flush();
+    default_lane.Flush();
+  }
+
+  TaskDeque high_lane;
+  TaskDeque default_lane;
+};
+
 template <typename ThreadingEnvironmentTy>
 struct WorkQueueTraits<NonBlockingWorkQueue<ThreadingEnvironmentTy>> {
   using ThreadingEnvironment = ThreadingEnvironmentTy;
   using Thread = typename ThreadingEnvironment::Thread;
-  using Queue = ::tfrt::internal::TaskDeque;
+  using Queue = ::tfrt::internal::PriorityTaskDeque;
 };
 
 template <typename ThreadingEnvironment>
@@ -57,11 +81,22 @@ class NonBlockingWorkQueue
   using ThreadData = typename Base::ThreadData;
 
  public:
+  // `max_spin_count` bounds how long a worker may spin in the steal loop
+  // before parking; see WorkQueueBase. Non-positive values fall back to the
+  // built-in default.
   explicit NonBlockingWorkQueue(QuiescingState* quiescing_state,
-                                int num_threads);
+                                int num_threads, int max_spin_count = 0,
+                                int numa_node = -1);
   ~NonBlockingWorkQueue() = default;
 
-  void AddTask(TaskFunction task);
+  // Add a task to the queue. High priority tasks are drained by workers
+  // before default priority tasks.
+  void AddTask(TaskFunction task,
+               TaskPriority priority = TaskPriority::kDefault);
+
+  // Add a batch of tasks, notifying parked worker threads only once for the
+  // whole batch.
+  void AddTasks(MutableArrayRef<TaskFunction> tasks);
 
   using Base::Steal;
 
@@ -86,15 +121,21 @@ class NonBlockingWorkQueue
 
 template <typename ThreadingEnvironment>
 NonBlockingWorkQueue<ThreadingEnvironment>::NonBlockingWorkQueue(
-    QuiescingState* quiescing_state, int num_threads)
-    : WorkQueueBase<NonBlockingWorkQueue>(quiescing_state, num_threads) {}
+    QuiescingState* quiescing_state, int num_threads, int max_spin_count,
+    int numa_node)
+    : WorkQueueBase<NonBlockingWorkQueue>(
+          quiescing_state, num_threads,
+          max_spin_count > 0 ? max_spin_count : Base::kSpinCount, numa_node) {}
 
 template <typename ThreadingEnvironment>
-void NonBlockingWorkQueue<ThreadingEnvironment>::AddTask(TaskFunction task) {
+void NonBlockingWorkQueue<ThreadingEnvironment>::AddTask(TaskFunction task,
+                                                         TaskPriority priority) {
   // Keep track of the number of pending tasks.
   if (IsQuiescing()) task = WithPendingTaskCounter(std::move(task));
 
-  // If the worker queue is full, we will execute `task` in the current thread.
+  // TaskDeque absorbs bursts beyond its ring buffer capacity into an overflow
+  // FIFO, so pushes no longer fail in practice; the inline execution fallback
+  // is kept for queue implementations with strictly bounded storage.
   llvm::Optional<TaskFunction> inline_task;
 
   // If a caller thread is managed by `this` we push the new task into the front
@@ -109,12 +150,12 @@ void NonBlockingWorkQueue<ThreadingEnvironment>::AddTask(TaskFunction task) {
   PerThread* pt = GetPerThread();
   if (pt->parent == this) {
     // Worker thread of this pool, push onto the thread's queue.
-    Queue& q = thread_data_[pt->thread_id].queue;
+    TaskDeque& q = thread_data_[pt->thread_id].queue.lane(priority);
     inline_task = q.PushFront(std::move(task));
   } else {
     // A free-standing thread (or worker of another pool).
     unsigned rnd = FastReduce(pt->rng(), num_threads_);
-    Queue& q = thread_data_[rnd].queue;
+    TaskDeque& q = thread_data_[rnd].queue.lane(priority);
     inline_task = q.PushBack(std::move(task));
   }
   // Note: below we touch `*this` after making `task` available to worker
@@ -133,16 +174,89 @@ void NonBlockingWorkQueue<ThreadingEnvironment>::AddTask(TaskFunction task) {
   }
 }
 
+template <typename ThreadingEnvironment>
+void NonBlockingWorkQueue<ThreadingEnvironment>::AddTasks(
+    MutableArrayRef<TaskFunction> tasks) {
+  if (tasks.empty()) return;
+
+  const bool is_quiescing = IsQuiescing();
+
+  // Tasks that could not be queued because the target queues were full; they
+  // are executed in the caller thread after the rest of the batch has been
+  // published.
+  llvm::SmallVector<TaskFunction, 4> inline_tasks;
+
+  PerThread* pt = GetPerThread();
+  for (TaskFunction& task : tasks) {
+    if (is_quiescing) task = WithPendingTaskCounter(std::move(task));
+
+    // Use the same queue selection policy as AddTask: thread-local queue for
+    // worker threads of this pool, a random queue otherwise. Batch elements
+    // submitted from an external thread are spread over random queues, which
+    // lets multiple workers pick up parts of the batch concurrently.
+    llvm::Optional<TaskFunction> inline_task;
+    if (pt->parent == this) {
+      TaskDeque& q =
+          thread_data_[pt->thread_id].queue.lane(TaskPriority::kDefault);
+      inline_task = q.PushFront(std::move(task));
+    } else {
+      unsigned rnd = FastReduce(pt->rng(), num_threads_);
+      TaskDeque& q = thread_data_[rnd].queue.lane(TaskPriority::kDefault);
+      inline_task = q.PushBack(std::move(task));
+    }
+    if (inline_task.hasValue())
+      inline_tasks.push_back(std::move(*inline_task));
+  }
+
+  // Notify parked threads once for the whole batch. Waking all parked threads
+  // is only profitable when the batch is wide enough to keep them busy.
+  if (inline_tasks.size() < tasks.size() && IsNotifyParkedThreadRequired())
+    event_count_.Notify(/*notify_all=*/tasks.size() > 1);
+
+  // Execute the overflow tasks directly, the same way AddTask does.
+  for (TaskFunction& task : inline_tasks) task();
+}
+
 template <typename ThreadingEnvironment>
 LLVM_NODISCARD Optional<TaskFunction>
 NonBlockingWorkQueue<ThreadingEnvironment>::NextTask(Queue* queue) {
-  return queue->PopFront();
+  Optional<TaskFunction> task = queue->high_lane.PopFront();
+  if (!task.hasValue()) task = queue->default_lane.PopFront();
+  return task;
 }
 
 template <typename ThreadingEnvironment>
 LLVM_NODISCARD Optional<TaskFunction>
 NonBlockingWorkQueue<ThreadingEnvironment>::Steal(Queue* queue) {
-  return queue->PopBack();
+  // The high priority lane is drained first, one task at a time: it holds
+  // latency-critical tasks that should spread across workers quickly.
+  Optional<TaskFunction> task = queue->high_lane.PopBack();
+  if (task.hasValue()) return task;
+
+  // When the caller is a worker of this pool, grab half of the victim's
+  // pending tasks in a single synchronization episode and stash all but one
+  // in the caller's own queue. A burst producer is otherwise hammered by
+  // every idle worker one CAS at a time; batching the transfer cuts the
+  // contention on the victim's deque at graph fan-out points.
+  PerThread* pt = GetPerThread();
+  if (pt->parent == this &&
+      &thread_data_[pt->thread_id].queue != queue) {
+    std::vector<TaskFunction> stolen;
+    if (queue->default_lane.PopBackHalf(&stolen) == 0) return llvm::None;
+
+    // Keep the first task for the caller and requeue the rest locally.
+    // PushFront cannot fail: overflow is absorbed by the deque's FIFO.
+    TaskDeque& own = thread_data_[pt->thread_id].queue.default_lane;
+    for (size_t i = 1; i < stolen.size(); ++i) {
+      llvm::Optional<TaskFunction> inline_task =
+          own.PushFront(std::move(stolen[i]));
+      assert(!inline_task.hasValue());
+      (void)inline_task;
+    }
+    return llvm::Optional<TaskFunction>(std::move(stolen[0]));
+  }
+
+  return queue->default_lane.PopBack();
 }
 
 template <typename ThreadingEnvironment>
@@ -9,7 +9,9 @@
 
 //===- task_deque.h ---------------------------------------------*- C++ -*-===//
 //
-// TaskDeque is a fixed-size, partially non-blocking deque of Task items.
+// TaskDeque is a partially non-blocking deque of Task items, backed by a
+// fixed-size ring buffer plus a mutex-protected overflow FIFO that absorbs
+// bursts larger than the ring capacity.
 // Operations on front of the queue must be done by a single thread (owner),
 // operations on back of the queue can be done by multiple threads concurrently.
 //
@@ -43,12 +45,14 @@
 #include <array>
 #include <atomic>
 #include <cstdint>
+#include <deque>
 
 #include "llvm/ADT/FunctionExtras.h"
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/Support/Compiler.h"
 #include "tfrt/host_context/task_function.h"
+#include "tfrt/support/cache_line_audit.h"
 #include "tfrt/support/mutex.h"
 
 namespace tfrt {
@@ -75,16 +79,21 @@ class TaskDeque {
 
   // PushFront() inserts task at the beginning of the queue.
   //
-  // If the queue is full, returns passed in task wrapped in optional, otherwise
-  // returns empty optional.
+  // If the fixed-size ring buffer is full, the task is moved into the
+  // unbounded overflow FIFO instead of being handed back to the caller, so
+  // wide fan-out bursts beyond kCapacity tasks do not degrade into inline
+  // execution. Always returns an empty optional; the return type is kept so
+  // callers written against a bounded queue continue to compile.
   LLVM_NODISCARD llvm::Optional<TaskFunction> PushFront(TaskFunction task) {
     unsigned front = front_.load(std::memory_order_relaxed);
     Elem* e = &array_[front & kMask];
     uint8_t s = e->state.load(std::memory_order_relaxed);
     if (s != kEmpty || !e->state.compare_exchange_strong(
                            s, kBusy, std::memory_order_acquire)) {
-      return llvm::Optional<TaskFunction>(std::move(task));
+      PushOverflow(std::move(task));
+      return llvm::None;
     }
+    TFRT_AUDIT_CACHE_LINE_WRITE(&front_, "TaskDeque::front_");
     front_.store(front + kIncrement, std::memory_order_relaxed);
     e->task = std::move(task);
     e->state.store(kReady, std::memory_order_release);
@@ -100,6 +109,9 @@ class TaskDeque {
     uint8_t s = e->state.load(std::memory_order_relaxed);
     if (s != kReady || !e->state.compare_exchange_strong(
                            s, kBusy, std::memory_order_acquire)) {
+      // The ring buffer has nothing to pop; drain overflowed tasks, if any.
+      if (overflow_size_.load(std::memory_order_acquire) != 0)
+        return PopOverflow();
       return llvm::None;
     }
     TaskFunction task = std::move(e->task);
@@ -111,8 +123,8 @@ class TaskDeque {
 
   // PushBack() inserts task `w` at the end of the queue.
   //
-  // If the queue is full, returns passed in task wrapped in optional, otherwise
-  // returns empty optional.
+  // Like PushFront, a task that does not fit into the ring buffer is moved
+  // into the overflow FIFO and an empty optional is always returned.
   LLVM_NODISCARD llvm::Optional<TaskFunction> PushBack(TaskFunction task) {
     mutex_lock lock(mutex_);
     unsigned back = back_.load(std::memory_order_relaxed);
@@ -120,9 +132,13 @@ class TaskDeque {
     uint8_t s = e->state.load(std::memory_order_relaxed);
     if (s != kEmpty || !e->state.compare_exchange_strong(
                            s, kBusy, std::memory_order_acquire)) {
-      return llvm::Optional<TaskFunction>(std::move(task));
+      // Already holding the lock, so push to the overflow FIFO directly.
+      overflow_.push_back(std::move(task));
+      overflow_size_.store(overflow_.size(), std::memory_order_release);
+      return llvm::None;
     }
     back = ((back - 1) & kMask2) | (back & ~kMask2);
+    TFRT_AUDIT_CACHE_LINE_WRITE(&back_, "TaskDeque::back_");
     back_.store(back, std::memory_order_relaxed);
     e->task = std::move(task);
     e->state.store(kReady, std::memory_order_release);
@@ -141,6 +157,13 @@ class TaskDeque {
     uint8_t s = e->state.load(std::memory_order_relaxed);
     if (s != kReady || !e->state.compare_exchange_strong(
                            s, kBusy, std::memory_order_acquire)) {
+      // The ring buffer has nothing to steal; drain overflowed tasks, if any.
+      if (!overflow_.empty()) {
+        TaskFunction task = std::move(overflow_.front());
+        overflow_.pop_front();
+        overflow_size_.store(overflow_.size(), std::memory_order_release);
+        return llvm::Optional<TaskFunction>(std::move(task));
+      }
       return llvm::None;
     }
     TaskFunction task = std::move(e->task);
@@ -156,7 +179,17 @@ class TaskDeque {
 
     mutex_lock lock(mutex_);
     unsigned back = back_.load(std::memory_order_relaxed);
-    unsigned size = Size();
+    // Compute the midpoint from the ring buffer occupancy only. Tasks parked
+    // in the overflow FIFO occupy no ring slots: counting them (as Size()
+    // does) would place `mid` at or past the front position, so the scan
+    // would drain the whole ring instead of half of it, and once the
+    // combined size exceeds the rolling index period the scan would alias
+    // back into occupied slots. Deriving `mid` from a single front/back pair
+    // also clamps the scan strictly below the front position that the owner
+    // thread operates on: `mid - back` is at most `size - 1`, so
+    // `mid - front_` stays negative.
+    unsigned front = front_.load(std::memory_order_acquire);
+    unsigned size = CalculateSize(front, back);
     unsigned mid = back;
     if (size > 1) mid = back + (size - 1) / 2;
     unsigned n = 0;
@@ -182,13 +215,19 @@ class TaskDeque {
     return n;
   }
 
-  // Size returns current queue size.
+  // Size returns current queue size, including overflowed tasks.
   // Can be called by any thread at any time.
-  unsigned Size() const { return SizeOrNotEmpty<true>(); }
+  unsigned Size() const {
+    return SizeOrNotEmpty<true>() +
+           overflow_size_.load(std::memory_order_acquire);
+  }
 
   // Empty tests whether container is empty.
   // Can be called by any thread at any time.
-  bool Empty() const { return SizeOrNotEmpty<false>() == 0; }
+  bool Empty() const {
+    return SizeOrNotEmpty<false>() == 0 &&
+           overflow_size_.load(std::memory_order_acquire) == 0;
+  }
 
   // Delete all the elements from the queue.
   void Flush() {
@@ -216,8 +255,34 @@ class TaskDeque {
     TaskFunction task;
   };
 
+  // Move an overflowed task into the FIFO. Called from PushFront when the
+  // ring buffer is full (PushBack pushes under its already-held lock).
+  void PushOverflow(TaskFunction task) {
+    mutex_lock lock(mutex_);
+    overflow_.push_back(std::move(task));
+    overflow_size_.store(overflow_.size(), std::memory_order_release);
+  }
+
+  // Pop the oldest overflowed task, or an empty optional if there is none.
+  LLVM_NODISCARD llvm::Optional<TaskFunction> PopOverflow() {
+    mutex_lock lock(mutex_);
+    if (overflow_.empty()) return llvm::None;
+    TaskFunction task = std::move(overflow_.front());
+    overflow_.pop_front();
+    overflow_size_.store(overflow_.size(), std::memory_order_release);
+    return llvm::Optional<TaskFunction>(std::move(task));
+  }
+
   mutex mutex_;
 
+  // Tasks that did not fit into the fixed-size ring buffer, in FIFO order.
+  // Guarded by mutex_; overflow is rare enough (wide fan-out bursts) that
+  // taking the lock is much cheaper than the previous fallback of executing
+  // the task inline in the submitting thread. The size is mirrored in an
+  // atomic so that the emptiness checks stay lock free.
+  std::deque<TaskFunction> overflow_;
+  std::atomic<unsigned> overflow_size_{0};
+
   // Low log(kCapacity) + 1 bits in front_ and back_ contain rolling index of
   // front/back, respectively. The remaining bits contain modification counters
   // that are incremented on Push operations. This allows us to
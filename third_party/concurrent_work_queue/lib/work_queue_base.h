@@ -51,6 +51,15 @@
 //    // good hash function and generate uniformly distributed values. Values
 //    // are used as an initial seed for per-thread random number generation.
 //    static uint64_t ThisThreadIdHash() {... }
+//
+//    // Returns the number of NUMA nodes (1 if unknown). When worker threads
+//    // divide evenly among nodes, the work queue partitions them into
+//    // node-local steal domains and pins each worker to its node.
+//    static int NumNumaNodes() { ... }
+//
+//    // Pins the calling thread to the CPUs of the given NUMA node (no-op if
+//    // unsupported).
+//    static void PinCurrentThreadToNumaNode(int node) { ... }
 //  }
 //
 //===----------------------------------------------------------------------===//
@@ -58,7 +67,9 @@
 #ifndef TFRT_THIRD_PARTY_CONCURRENT_WORK_QUEUE_WORK_QUEUE_BASE_H_
 #define TFRT_THIRD_PARTY_CONCURRENT_WORK_QUEUE_WORK_QUEUE_BASE_H_
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <thread>
@@ -67,6 +78,7 @@
 #include "llvm/Support/Compiler.h"
 #include "task_queue.h"
 #include "tfrt/host_context/task_function.h"
+#include "tfrt/metrics/metrics_api.h"
 #include "tfrt/support/forward_decls.h"
 #include "tfrt/support/logging.h"
 #include "tfrt/support/mutex.h"
@@ -99,6 +111,56 @@ inline uint32_t FastReduce(uint32_t x, uint32_t size) {
 template <typename Derived>
 struct WorkQueueTraits;
 
+//===----------------------------------------------------------------------===//
+// Process-wide work queue telemetry, exported through the metrics backend.
+// All queue instances contribute to one set of metrics: counter increments
+// are a single relaxed atomic add to a core-local shard (see the striped
+// metrics backend), so instrumenting the worker loop and the steal path does
+// not add shared cache line traffic.
+//===----------------------------------------------------------------------===//
+struct WorkQueueMetrics {
+  static WorkQueueMetrics& Get() {
+    static auto* metrics = new WorkQueueMetrics();
+    return *metrics;
+  }
+
+  // Tracks the deepest pending-task queue ever observed. Worker threads
+  // sample their own queue depth once per executed task; a new maximum is
+  // rare by definition, so the gauge update stays off the hot path.
+  void SampleQueueDepth(int64_t depth) {
+    int64_t seen = observed_max_depth.load(std::memory_order_relaxed);
+    while (depth > seen) {
+      if (observed_max_depth.compare_exchange_weak(seen, depth,
+                                                   std::memory_order_relaxed)) {
+        max_queue_depth->SetValue(depth);
+        break;
+      }
+    }
+  }
+
+  metrics::Counter<int64_t>* tasks_executed;
+  metrics::Counter<int64_t>* steal_attempts;
+  metrics::Counter<int64_t>* steal_successes;
+  metrics::Counter<int64_t>* parks;
+  metrics::Counter<int64_t>* parked_us;
+  metrics::Gauge<int64_t>* max_queue_depth;
+
+ private:
+  WorkQueueMetrics()
+      : tasks_executed(
+            metrics::NewCounter<int64_t>("work_queue.tasks_executed")),
+        steal_attempts(
+            metrics::NewCounter<int64_t>("work_queue.steal_attempts")),
+        steal_successes(
+            metrics::NewCounter<int64_t>("work_queue.steal_successes")),
+        parks(metrics::NewCounter<int64_t>("work_queue.parks")),
+        parked_us(metrics::NewCounter<int64_t>("work_queue.parked_us")),
+        max_queue_depth(
+            metrics::NewGauge<int64_t>("work_queue.max_queue_depth")) {}
+
+  std::atomic<int64_t> observed_max_depth{0};
+};
+
 //===----------------------------------------------------------------------===//
 // Quiescing enables pending tasks counter to implement strong work queue
 // emptiness check in the MultiThreadedWorkQueue::Quiesce() implementation.
@@ -106,6 +168,11 @@ struct WorkQueueTraits;
 struct QuiescingState {
   std::atomic<int64_t> num_quiescing;
   std::atomic<int64_t> num_pending_tasks;
+
+  // Wakes quiescing threads blocked in Quiescing::WaitForPendingTasks() when
+  // the last pending task retires.
+  mutex all_tasks_completed_mu;
+  condition_variable all_tasks_completed_cv;
 };
 
 //===----------------------------------------------------------------------===//
@@ -141,6 +208,16 @@ class Quiescing {
     return state_->num_pending_tasks.load(std::memory_order_relaxed) != 0;
   }
 
+  // WaitForPendingTasks() blocks the caller until all pending tasks have
+  // completed. The last retiring task wakes us (see ~PendingTask), so there is
+  // no polling interval; the wait returns as soon as the counter hits zero.
+  void WaitForPendingTasks() {
+    if (!HasPendingTasks()) return;
+    mutex_lock lock(state_->all_tasks_completed_mu);
+    state_->all_tasks_completed_cv.wait(
+        lock, [this]() { return !HasPendingTasks(); });
+  }
+
  private:
   explicit Quiescing(QuiescingState* state) : state_(state) {
     assert(state != nullptr);
@@ -162,7 +239,14 @@ class PendingTask {
 
   ~PendingTask() {
     if (state_ == nullptr) return;  // in moved-out state
-    state_->num_pending_tasks.fetch_sub(1, std::memory_order_relaxed);
+    if (state_->num_pending_tasks.fetch_sub(1, std::memory_order_acq_rel) ==
+        1) {
+      // We retired the last pending task; wake quiescing threads. Taking the
+      // lock before notifying avoids a missed wakeup racing with the
+      // predicate check in WaitForPendingTasks().
+      mutex_lock lock(state_->all_tasks_completed_mu);
+      state_->all_tasks_completed_cv.notify_all();
+    }
   }
 
   PendingTask(PendingTask&& other) : state_(other.state_) {
@@ -227,8 +311,11 @@ class WorkQueueBase {
   // all worker threads are in the parked state.
   void Quiesce();
 
-  // Steal() tries to steal task from any worker managed by this queue. Returns
-  // llvm::None if it was not able to find task to steal.
+  // Steal() tries to steal task from any worker managed by this queue. When
+  // workers are partitioned into NUMA-node-local steal domains, queues on the
+  // caller's own node are tried first, and remote nodes are only visited when
+  // the whole local partition is empty. Returns llvm::None if it was not able
+  // to find task to steal.
   LLVM_NODISCARD llvm::Optional<TaskFunction> Steal();
 
   // Returns `true` if all worker threads are parked. This is a weak signal of
@@ -277,8 +364,10 @@ class WorkQueueBase {
   // to reduce latency at the cost of wasted CPU cycles.
   static constexpr int kMaxSpinningThreads = 1;
 
-  // The number of steal loop spin iterations before parking (this number is
-  // divided by the number of threads, to get spin count for each thread).
+  // The default upper bound on the number of steal loop spin iterations
+  // before parking (this number is divided by the number of threads, to get
+  // the spin bound for each thread). Workers adapt their actual spin duration
+  // between zero and this bound; see WorkerLoop.
   static constexpr int kSpinCount = 5000;
 
   // If there are enough active threads with an empty pending task queues, there
@@ -291,7 +380,16 @@ class WorkQueueBase {
   // will be unparked, however this should be very rare in practice.
   static constexpr int kMinActiveThreadsToStartSpinning = 4;
 
-  explicit WorkQueueBase(QuiescingState* quiescing_state, int num_threads);
+  // `max_spin_count` bounds the number of steal iterations a worker may spin
+  // before parking when it runs out of work; it trades burned CPU cycles for
+  // wakeup latency.
+  //
+  // `numa_node` >= 0 pins every worker to the CPUs of that NUMA node and
+  // keeps the pool flat (no internal steal partitioning - the whole pool is
+  // already node-local). The default of -1 leaves placement to
+  // ComputeNumStealPartitions.
+  explicit WorkQueueBase(QuiescingState* quiescing_state, int num_threads,
+                         int max_spin_count = kSpinCount, int numa_node = -1);
   ~WorkQueueBase();
 
   // Main worker thread loop.
@@ -332,6 +430,22 @@ class WorkQueueBase {
   // if all queues are empty.
   LLVM_NODISCARD int NonEmptyQueueIndex();
 
+  // StealInRange() tries to steal a task from worker queues in the
+  // [begin, end) index range, starting from a random victim. `coprimes` must
+  // be the coprimes of `end - begin`.
+  LLVM_NODISCARD llvm::Optional<TaskFunction> StealInRange(
+      unsigned begin, unsigned end, ArrayRef<unsigned> coprimes);
+
+  // Returns the number of node-local steal partitions for a pool of
+  // `num_threads` workers. Workers are only partitioned when they divide
+  // evenly among NUMA nodes; otherwise the pool stays flat and stealing is
+  // machine-wide.
+  LLVM_NODISCARD static int ComputeNumStealPartitions(int num_threads) {
+    const int num_nodes = ThreadingEnvironment::NumNumaNodes();
+    if (num_nodes <= 1 || num_threads % num_nodes != 0) return 1;
+    return num_nodes;
+  }
+
   LLVM_NODISCARD static PerThread* GetPerThread() {
     static thread_local PerThread per_thread_;
     PerThread* pt = &per_thread_;
@@ -342,10 +456,24 @@ class WorkQueueBase {
   unsigned NumActiveThreads() const { return num_threads_ - blocked_.load(); }
 
   const int num_threads_;
+  const int max_spin_count_;
+
+  // Worker threads are partitioned into `num_partitions_` equally sized
+  // NUMA-node-local steal domains of `partition_size_` threads each; worker
+  // `i` belongs to partition `i / partition_size_`. A single partition means
+  // the pool is flat and no pinning is done.
+  const int num_partitions_;
+  const int partition_size_;
+
+  // When >= 0, the whole pool is pinned to this NUMA node (and
+  // num_partitions_ is 1). See the constructor comment.
+  const int numa_node_;
+
   ThreadingEnvironment threading_environment_;
 
   std::vector<ThreadData> thread_data_;
   std::vector<unsigned> coprimes_;
+  std::vector<unsigned> partition_coprimes_;
 
   std::atomic<unsigned> blocked_;
   std::atomic<bool> done_;
@@ -429,10 +557,18 @@ inline std::vector<unsigned> ComputeCoprimes(int n) {
 
 template <typename Derived>
 WorkQueueBase<Derived>::WorkQueueBase(QuiescingState* quiescing_state,
-                                      int num_threads)
+                                      int num_threads, int max_spin_count,
+                                      int numa_node)
     : num_threads_(num_threads),
+      max_spin_count_(max_spin_count),
+      num_partitions_(numa_node >= 0
+                          ? 1
+                          : ComputeNumStealPartitions(num_threads)),
+      partition_size_(num_threads / num_partitions_),
+      numa_node_(numa_node),
       thread_data_(num_threads),
       coprimes_(ComputeCoprimes(num_threads)),
+      partition_coprimes_(ComputeCoprimes(partition_size_)),
       blocked_(0),
       done_(false),
       cancelled_(false),
@@ -506,25 +642,51 @@ void WorkQueueBase<Derived>::Quiesce() {
 }
 
 template <typename Derived>
-LLVM_NODISCARD llvm::Optional<TaskFunction> WorkQueueBase<Derived>::Steal() {
+LLVM_NODISCARD llvm::Optional<TaskFunction> WorkQueueBase<Derived>::StealInRange(
+    unsigned begin, unsigned end, ArrayRef<unsigned> coprimes) {
   PerThread* pt = GetPerThread();
+  unsigned size = end - begin;
   unsigned r = pt->rng();
-  unsigned victim = FastReduce(r, num_threads_);
-  unsigned inc = coprimes_[FastReduce(r, coprimes_.size())];
+  unsigned victim = begin + FastReduce(r, size);
+  unsigned inc = coprimes[FastReduce(r, coprimes.size())];
 
-  for (unsigned i = 0; i < num_threads_; i++) {
+  for (unsigned i = 0; i < size; i++) {
     llvm::Optional<TaskFunction> t =
         derived_.Steal(&(thread_data_[victim].queue));
     if (t.hasValue()) return t;
 
     victim += inc;
-    if (victim >= num_threads_) {
-      victim -= num_threads_;
+    if (victim >= end) {
+      victim -= size;
     }
   }
   return llvm::None;
 }
 
+template <typename Derived>
+LLVM_NODISCARD llvm::Optional<TaskFunction> WorkQueueBase<Derived>::Steal() {
+  // Prefer victims on the caller's own NUMA node: tasks tend to touch data
+  // produced on the node that spawned them, and a same-node steal keeps that
+  // data local instead of dragging it across the interconnect. Remote nodes
+  // are only visited when the whole local partition is out of work.
+  WorkQueueMetrics& metrics = WorkQueueMetrics::Get();
+  metrics.steal_attempts->Increment();
+
+  const int thread_id = CurrentThreadId();
+  if (num_partitions_ > 1 && thread_id >= 0) {
+    const unsigned begin = (thread_id / partition_size_) * partition_size_;
+    llvm::Optional<TaskFunction> t =
+        StealInRange(begin, begin + partition_size_, partition_coprimes_);
+    if (t.hasValue()) {
+      metrics.steal_successes->Increment();
+      return t;
+    }
+  }
+  llvm::Optional<TaskFunction> t = StealInRange(0, num_threads_, coprimes_);
+  if (t.hasValue()) metrics.steal_successes->Increment();
+  return t;
+}
+
 template <typename Derived>
 void WorkQueueBase<Derived>::WorkerLoop(int thread_id) {
   PerThread* pt = GetPerThread();
@@ -532,14 +694,34 @@ void WorkQueueBase<Derived>::WorkerLoop(int thread_id) {
   pt->rng = FastRng(ThreadingEnvironment::ThisThreadIdHash());
   pt->thread_id = thread_id;
 
+  // Pin workers to their NUMA node: either the node the whole pool was
+  // pinned to at construction, or, when the pool is partitioned, the node of
+  // this worker's steal domain - so the node-local steal domain actually
+  // corresponds to node-local memory.
+  if (numa_node_ >= 0) {
+    ThreadingEnvironment::PinCurrentThreadToNumaNode(numa_node_);
+  } else if (num_partitions_ > 1) {
+    ThreadingEnvironment::PinCurrentThreadToNumaNode(thread_id /
+                                                     partition_size_);
+  }
+
   Queue* q = &(thread_data_[thread_id].queue);
   EventCount::Waiter* waiter = event_count_.waiter(thread_id);
 
   // TODO(dvyukov,rmlarsen): The time spent in NonEmptyQueueIndex() is
   // proportional to num_threads_ and we assume that new work is scheduled at
-  // a constant rate, so we set spin_count to 5000 / num_threads_. The
+  // a constant rate, so we divide the spin bound by num_threads_. The
   // constant was picked based on a fair dice roll, tune it.
-  const int spin_count = num_threads_ > 0 ? kSpinCount / num_threads_ : 0;
+  const int max_spin = num_threads_ > 0 ? max_spin_count_ / num_threads_ : 0;
+
+  // Adaptive spin budget: spinning is only worth its CPU when new work keeps
+  // arriving. Every spin loop that finds a task grows the budget towards
+  // `max_spin`, every spin loop that expires without work shrinks it towards
+  // zero, so bursty phases spin near the configured bound while idle phases
+  // park almost immediately.
+  int spin_budget = max_spin;
+
+  WorkQueueMetrics& metrics = WorkQueueMetrics::Get();
 
   while (!cancelled_) {
     Optional<TaskFunction> t = derived_.NextTask(q);
@@ -549,9 +731,11 @@ void WorkQueueBase<Derived>::WorkerLoop(int thread_id) {
         // Maybe leave thread spinning. This reduces latency.
         const bool start_spinning = StartSpinning();
         if (start_spinning) {
-          for (int i = 0; i < spin_count && !t.hasValue(); ++i) {
+          for (int i = 0; i < spin_budget && !t.hasValue(); ++i) {
             t = Steal();
           }
+          spin_budget = t.hasValue() ? std::min(2 * spin_budget + 1, max_spin)
+                                     : spin_budget / 2;
 
           const bool stopped_spinning = StopSpinning();
           // If a task was submitted to the queue without a call to
@@ -572,7 +756,9 @@ void WorkQueueBase<Derived>::WorkerLoop(int thread_id) {
       }
     }
     if (t.hasValue()) {
+      metrics.SampleQueueDepth(q->Size());
       (*t)();  // Execute a task.
+      metrics.tasks_executed->Increment();
     }
   }
 }
@@ -629,7 +815,15 @@ bool WorkQueueBase<Derived>::WaitForWork(EventCount::Waiter* waiter,
     return false;
   }
 
+  // Time spent parked is the pool's idle time: a high parked share means the
+  // pool is oversized for its load, a near-zero one that it is saturated.
+  WorkQueueMetrics& metrics = WorkQueueMetrics::Get();
+  metrics.parks->Increment();
+  const auto park_start = std::chrono::steady_clock::now();
   event_count_.CommitWait(waiter);
+  metrics.parked_us->Add(std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - park_start)
+                             .count());
   blocked_.fetch_sub(1);
   return true;
 }
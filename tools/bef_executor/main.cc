@@ -61,6 +61,21 @@ static llvm::cl::opt<tfrt::HostAllocatorType> cl_host_allocator_type(  // NOLINT
                    "leak_check_allocator", "Malloc with memory leak check.")),
     llvm::cl::init(tfrt::HostAllocatorType::kLeakCheckMalloc));
 
+// Benchmark mode: non-zero runs each function this many timed iterations
+// after the single verification run and prints mean/p50/p99 wall and cpu
+// times, making a .mlir file plus this driver a complete perf reproducer.
+static llvm::cl::opt<int> cl_benchmark_iterations(  // NOLINT
+    "benchmark_iterations",
+    llvm::cl::desc("Number of timed benchmark iterations per function "
+                   "(0 disables benchmark mode)"),
+    llvm::cl::init(0));
+
+static llvm::cl::opt<int> cl_benchmark_warmup_iterations(  // NOLINT
+    "benchmark_warmup_iterations",
+    llvm::cl::desc("Number of untimed warmup iterations per function in "
+                   "benchmark mode"),
+    llvm::cl::init(10));
+
 // Enable aggregate op handler types to be specified on the command line.
 static llvm::cl::opt<bool> cl_enable_tracing(  // NOLINT
     "enable_tracing", llvm::cl::desc("Enable Performance Tracing"),
@@ -81,6 +96,8 @@ int main(int argc, char** argv) {
   run_config.devices = cl_devices;
   run_config.work_queue_type = cl_work_queue_type;
   run_config.host_allocator_type = cl_host_allocator_type;
+  run_config.benchmark_num_warmup_iterations = cl_benchmark_warmup_iterations;
+  run_config.benchmark_num_iterations = cl_benchmark_iterations;
 
   if (cl_enable_tracing) {
     TFRT_TRACE_ON();
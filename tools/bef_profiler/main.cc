@@ -0,0 +1,425 @@
+// Copyright 2020 The TensorFlow Runtime Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//===- BEF Size and Load-Cost Profiler ------------------------------------===//
+//
+// This tool walks a BEF file with BEFReader and reports where the bytes and
+// the load-time decode work go: per-section and per-function byte counts,
+// attribute duplication statistics, and measured decode time per section.
+// Use it to decide what to shrink before reaching for a hexdump.
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "tfrt/support/bef_encoding.h"
+#include "tfrt/support/bef_reader.h"
+
+using llvm::ArrayRef;
+using tfrt::BEFKernel;
+using tfrt::BEFReader;
+using tfrt::BEFSectionID;
+using tfrt::FunctionKind;
+using tfrt::kKernelEntryAlignment;
+
+static llvm::cl::opt<std::string> cl_input_filename(  // NOLINT
+    llvm::cl::Positional, llvm::cl::desc("<input bef file>"),
+    llvm::cl::Required);
+
+static llvm::cl::opt<unsigned> cl_top_n(  // NOLINT
+    "top", llvm::cl::desc("Number of entries in the top-N listings"),
+    llvm::cl::init(10));
+
+namespace {
+
+const char* GetSectionName(uint8_t section_id) {
+  switch (static_cast<BEFSectionID>(section_id)) {
+    case BEFSectionID::kFormatVersion:
+      return "FormatVersion";
+    case BEFSectionID::kLocationFilenames:
+      return "LocationFilenames";
+    case BEFSectionID::kLocationPositions:
+      return "LocationPositions";
+    case BEFSectionID::kStrings:
+      return "Strings";
+    case BEFSectionID::kAttributes:
+      return "Attributes";
+    case BEFSectionID::kKernels:
+      return "Kernels";
+    case BEFSectionID::kTypes:
+      return "Types";
+    case BEFSectionID::kFunctionIndex:
+      return "FunctionIndex";
+    case BEFSectionID::kFunctions:
+      return "Functions";
+    case BEFSectionID::kAttributeTypes:
+      return "AttributeTypes";
+    case BEFSectionID::kAttributeNames:
+      return "AttributeNames";
+    case BEFSectionID::kRegisterTypes:
+      return "RegisterTypes";
+    case BEFSectionID::kAlignmentPadding:
+      return "AlignmentPadding";
+    default:
+      return "(unknown)";
+  }
+}
+
+// Byte accounting for one section occurrence: the header includes the id
+// byte, the length, and any alignment byte plus fill.
+struct SectionStats {
+  uint8_t id;
+  size_t header_bytes;
+  size_t payload_bytes;
+};
+
+// One entry of the FunctionIndex section, plus the body size computed from
+// the offset of the next function in the Functions section.
+struct FunctionRecord {
+  std::string name;
+  FunctionKind kind;
+  size_t offset;
+  size_t num_results;
+  size_t size = 0;
+};
+
+// The sections this tool decodes, located by the initial section walk.
+struct BEFSections {
+  ArrayRef<uint8_t> strings;
+  ArrayRef<uint8_t> attributes;
+  ArrayRef<uint8_t> kernels;
+  ArrayRef<uint8_t> types;
+  ArrayRef<uint8_t> function_index;
+  ArrayRef<uint8_t> functions;
+  uint8_t format_version = 0;
+};
+
+// Run `fn` and return its wall time in microseconds.
+template <typename Fn>
+double TimeMicros(Fn&& fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+const char* GetString(ArrayRef<uint8_t> strings, size_t offset) {
+  if (offset >= strings.size()) return "(invalid)";
+  return reinterpret_cast<const char*>(&strings[offset]);
+}
+
+// Decode the Kernels or Types section: a count followed by one string offset
+// per entry. Returns the number of entries.
+size_t DecodeNameTable(ArrayRef<uint8_t> section) {
+  BEFReader reader(section);
+  size_t num_entries;
+  if (reader.ReadInt(&num_entries)) return 0;
+  for (size_t i = 0; i != num_entries; ++i) {
+    size_t name_offset;
+    if (reader.ReadInt(&name_offset)) return i;
+  }
+  return num_entries;
+}
+
+bool DecodeFunctionIndex(const BEFSections& sections,
+                         std::vector<FunctionRecord>* records) {
+  BEFReader reader(sections.function_index);
+  size_t num_functions;
+  if (reader.ReadInt(&num_functions)) return false;
+
+  records->reserve(num_functions);
+  while (num_functions--) {
+    FunctionRecord record;
+    uint8_t kind;
+    size_t name_offset, num_args;
+    if (reader.ReadByte(&kind) || reader.ReadInt(&record.offset) ||
+        reader.ReadInt(&name_offset) || reader.ReadInt(&num_args))
+      return false;
+    record.kind = static_cast<FunctionKind>(kind);
+    record.name = GetString(sections.strings, name_offset);
+
+    while (num_args--) {
+      size_t arg_type;
+      if (reader.ReadInt(&arg_type)) return false;
+    }
+
+    if (reader.ReadInt(&record.num_results)) return false;
+    for (size_t i = 0; i != record.num_results; ++i) {
+      size_t result_type;
+      if (reader.ReadInt(&result_type)) return false;
+    }
+    records->push_back(std::move(record));
+  }
+  return true;
+}
+
+// Compute each BEF function's body size as the distance to the next function
+// offset (functions are laid out back to back in the Functions section).
+void ComputeFunctionSizes(const BEFSections& sections,
+                          std::vector<FunctionRecord>* records) {
+  std::vector<FunctionRecord*> bef_functions;
+  for (auto& record : *records)
+    if (record.kind == FunctionKind::kBEFFunction)
+      bef_functions.push_back(&record);
+  std::sort(bef_functions.begin(), bef_functions.end(),
+            [](const FunctionRecord* a, const FunctionRecord* b) {
+              return a->offset < b->offset;
+            });
+  for (size_t i = 0, e = bef_functions.size(); i != e; ++i) {
+    size_t end = i + 1 != e ? bef_functions[i + 1]->offset
+                            : sections.functions.size();
+    bef_functions[i]->size = end - bef_functions[i]->offset;
+  }
+}
+
+// Decode one function's header tables and kernel bodies, recording a
+// reference count for every attribute offset the kernels use. Mirrors
+// BEFFileImpl::DecodeFunctionInfo for both the VBR (version 0) and the
+// fixed-width (version 1) header table encodings.
+bool WalkFunction(const BEFSections& sections, const FunctionRecord& record,
+                  std::map<size_t, size_t>* attribute_refs) {
+  BEFReader reader(sections.functions.drop_front(record.offset));
+  bool fixed_width = sections.format_version >= 1;
+
+  auto read_table_int = [&](size_t* value) -> bool {
+    if (!fixed_width) return reader.ReadInt(value);
+    uint32_t fixed_value;
+    if (reader.ReadInt4(&fixed_value)) return true;
+    *value = fixed_value;
+    return false;
+  };
+
+  size_t location_offset, num_registers, num_kernels;
+  if (read_table_int(&location_offset) || read_table_int(&num_registers))
+    return false;
+  for (size_t i = 0; i != num_registers; ++i) {
+    size_t user_count;
+    if (read_table_int(&user_count)) return false;
+  }
+
+  if (read_table_int(&num_kernels)) return false;
+  std::vector<size_t> kernel_offsets;
+  kernel_offsets.reserve(num_kernels);
+  for (size_t i = 0; i != num_kernels; ++i) {
+    size_t offset, num_operands;
+    if (read_table_int(&offset) || read_table_int(&num_operands))
+      return false;
+    kernel_offsets.push_back(offset);
+  }
+
+  for (size_t i = 0; i != record.num_results; ++i) {
+    size_t result_reg;
+    if (read_table_int(&result_reg)) return false;
+  }
+
+  if (reader.ReadAlignment(kKernelEntryAlignment)) return false;
+  ArrayRef<uint32_t> kernels = llvm::makeArrayRef(
+      reinterpret_cast<const uint32_t*>(reader.file().begin()),
+      reader.file().size() / kKernelEntryAlignment);
+
+  for (size_t kernel_offset : kernel_offsets) {
+    if (kernel_offset % kKernelEntryAlignment != 0 ||
+        kernel_offset / kKernelEntryAlignment >= kernels.size())
+      return false;
+    BEFKernel kernel(kernels.data() + kernel_offset / kKernelEntryAlignment);
+
+    // The kernel body lists arguments first, then attribute offsets.
+    for (uint32_t attribute_offset : kernel.GetKernelEntries(
+             kernel.num_arguments(), kernel.num_attributes()))
+      ++(*attribute_refs)[attribute_offset];
+  }
+  return true;
+}
+
+void PrintAttributeStats(const BEFSections& sections,
+                         const std::map<size_t, size_t>& attribute_refs) {
+  size_t total_refs = 0;
+  for (const auto& ref : attribute_refs) total_refs += ref.second;
+
+  printf("\nAttributes: %zu bytes, %zu unique referenced, %zu references\n",
+         sections.attributes.size(), attribute_refs.size(), total_refs);
+  if (attribute_refs.empty()) return;
+
+  // Estimate each attribute's size as the gap to the next referenced offset
+  // (an upper bound that includes padding and unreferenced data).
+  std::vector<std::pair<size_t, size_t>> by_offset(attribute_refs.begin(),
+                                                   attribute_refs.end());
+  std::vector<std::pair<size_t, size_t>> sizes;  // (size, refs)
+  size_t duplicated_bytes = 0;
+  for (size_t i = 0, e = by_offset.size(); i != e; ++i) {
+    size_t end = i + 1 != e ? by_offset[i + 1].first
+                            : sections.attributes.size();
+    size_t size = end - by_offset[i].first;
+    size_t refs = by_offset[i].second;
+    sizes.push_back({size, refs});
+    duplicated_bytes += (refs - 1) * size;
+  }
+  printf("  est. bytes saved by interning (vs one copy per reference): %zu\n",
+         duplicated_bytes);
+
+  std::sort(sizes.begin(), sizes.end(),
+            [](const std::pair<size_t, size_t>& a,
+               const std::pair<size_t, size_t>& b) {
+              return a.first * a.second > b.first * b.second;
+            });
+  printf("  top attributes by bytes * references:\n");
+  for (size_t i = 0, e = std::min<size_t>(cl_top_n, sizes.size()); i != e;
+       ++i)
+    printf("    ~%8zu bytes  x%4zu refs\n", sizes[i].first, sizes[i].second);
+}
+
+int ProfileBEFFile(ArrayRef<uint8_t> file) {
+  BEFReader reader(file);
+
+  uint8_t header[2];
+  if (reader.ReadByte(&header[0]) || reader.ReadByte(&header[1]) ||
+      header[0] != tfrt::kBEFMagic1 || header[1] != tfrt::kBEFMagic2) {
+    fprintf(stderr, "error: invalid BEF file header\n");
+    return 1;
+  }
+
+  // Pass 1: walk the section headers and record byte counts.
+  BEFSections sections;
+  std::vector<SectionStats> section_stats;
+  while (!reader.Empty()) {
+    size_t begin_offset = file.size() - reader.file().size();
+    uint8_t section_id;
+    ArrayRef<uint8_t> data;
+    if (reader.ReadSection(&section_id, &data)) {
+      fprintf(stderr, "error: corrupted section header at offset %zu\n",
+              begin_offset);
+      return 1;
+    }
+    reader.SkipPast(data);
+
+    size_t payload_offset = data.begin() - file.begin();
+    section_stats.push_back(
+        {section_id, payload_offset - begin_offset, data.size()});
+
+    switch (static_cast<BEFSectionID>(section_id)) {
+      case BEFSectionID::kFormatVersion:
+        if (!data.empty()) sections.format_version = data.front();
+        break;
+      case BEFSectionID::kStrings:
+        sections.strings = data;
+        break;
+      case BEFSectionID::kAttributes:
+        sections.attributes = data;
+        break;
+      case BEFSectionID::kKernels:
+        sections.kernels = data;
+        break;
+      case BEFSectionID::kTypes:
+        sections.types = data;
+        break;
+      case BEFSectionID::kFunctionIndex:
+        sections.function_index = data;
+        break;
+      case BEFSectionID::kFunctions:
+        sections.functions = data;
+        break;
+      default:
+        break;
+    }
+  }
+
+  printf("BEF file: %zu bytes, format version %d\n\n", file.size(),
+         sections.format_version);
+  printf("%-18s %10s %8s %7s\n", "Section", "payload", "header", "%file");
+  for (const auto& stats : section_stats) {
+    double percent =
+        100.0 * (stats.payload_bytes + stats.header_bytes) / file.size();
+    printf("%-18s %10zu %8zu %6.2f%%\n", GetSectionName(stats.id),
+           stats.payload_bytes, stats.header_bytes, percent);
+  }
+
+  // Pass 2: decode the sections the executor decodes at load time, and
+  // measure how long each takes.
+  size_t num_kernels = 0, num_types = 0;
+  double kernels_micros =
+      TimeMicros([&] { num_kernels = DecodeNameTable(sections.kernels); });
+  double types_micros =
+      TimeMicros([&] { num_types = DecodeNameTable(sections.types); });
+
+  std::vector<FunctionRecord> records;
+  bool index_ok = false;
+  double index_micros = TimeMicros(
+      [&] { index_ok = DecodeFunctionIndex(sections, &records); });
+  if (!index_ok) {
+    fprintf(stderr, "error: corrupted FunctionIndex section\n");
+    return 1;
+  }
+  ComputeFunctionSizes(sections, &records);
+
+  std::map<size_t, size_t> attribute_refs;
+  size_t num_walked = 0;
+  double functions_micros = TimeMicros([&] {
+    for (const auto& record : records)
+      if (record.kind == FunctionKind::kBEFFunction &&
+          WalkFunction(sections, record, &attribute_refs))
+        ++num_walked;
+  });
+
+  printf("\nDecode time (single threaded, this run):\n");
+  printf("  Kernels       %8.1f us  (%zu kernels)\n", kernels_micros,
+         num_kernels);
+  printf("  Types         %8.1f us  (%zu types)\n", types_micros, num_types);
+  printf("  FunctionIndex %8.1f us  (%zu functions)\n", index_micros,
+         records.size());
+  printf("  Functions     %8.1f us  (%zu bodies decoded)\n", functions_micros,
+         num_walked);
+
+  std::sort(records.begin(), records.end(),
+            [](const FunctionRecord& a, const FunctionRecord& b) {
+              return a.size > b.size;
+            });
+  printf("\nTop functions by size:\n");
+  for (size_t i = 0, e = std::min<size_t>(cl_top_n, records.size()); i != e;
+       ++i) {
+    if (records[i].kind != FunctionKind::kBEFFunction) continue;
+    printf("  %10zu bytes  %s\n", records[i].size,
+           records[i].name.empty() ? "(anonymous)" : records[i].name.c_str());
+  }
+
+  PrintAttributeStats(sections, attribute_refs);
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  llvm::cl::ParseCommandLineOptions(argc, argv, "BEF size profiler\n");
+
+  auto buffer_or_error = llvm::MemoryBuffer::getFileOrSTDIN(cl_input_filename);
+  if (!buffer_or_error) {
+    fprintf(stderr, "error: cannot open '%s': %s\n",
+            cl_input_filename.c_str(),
+            buffer_or_error.getError().message().c_str());
+    return 1;
+  }
+  auto& buffer = *buffer_or_error;
+
+  return ProfileBEFFile(llvm::makeArrayRef(
+      reinterpret_cast<const uint8_t*>(buffer->getBufferStart()),
+      buffer->getBufferSize()));
+}